@@ -0,0 +1,197 @@
+/*
+ * Micro benchmark for the backend liveness.
+ *
+ * Builds a loop around a long chain of if diamonds which update a few
+ * hundred variables, so many values live across many blocks. Prints the
+ * time in ms to compute the live sets with the sorted arrays (sets), the
+ * bitsets and the liveness checker (lv_chk) and the time per query in ns of
+ * asking every block for every value. The sum of the answers is printed as a
+ * checksum, all representations must agree on it. The values get no register
+ * requirements, so they all share the class of the values without a register
+ * class.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bearch.h"
+#include "beinfo.h"
+#include "beirg.h"
+#include "belive.h"
+#include "firm.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "obst.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#define N_VARS     200
+#define N_DIAMONDS 500
+#define N_ROUNDS   3
+
+static ir_graph *build_graph(void)
+{
+	ir_type *int_type    = new_type_primitive(mode_Is);
+	ir_type *method_type = new_type_method(1, 1);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_res_type(method_type, 0, int_type);
+	ir_entity *entity = new_entity(get_glob_type(), new_id_from_str("live"),
+	                               method_type);
+	ir_graph  *irg    = new_ir_graph(entity, N_VARS);
+	set_current_ir_graph(irg);
+
+	ir_node *param = new_Proj(get_irg_args(irg), mode_Is, 0);
+	for (int v = 0; v < N_VARS; ++v)
+		set_value(v, new_Add(param, new_Const_long(mode_Is, v), mode_Is));
+
+	ir_node *header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+
+	for (int d = 0; d < N_DIAMONDS; ++d) {
+		ir_node *cmp  = new_Cmp(get_value(d % N_VARS, mode_Is),
+		                        new_Const_long(mode_Is, d), ir_relation_less);
+		ir_node *cond = new_Cond(cmp);
+		ir_node *then = new_immBlock();
+		add_immBlock_pred(then, new_Proj(cond, mode_X, pn_Cond_true));
+		mature_immBlock(then);
+		ir_node *join = new_immBlock();
+		add_immBlock_pred(join, new_Proj(cond, mode_X, pn_Cond_false));
+
+		set_cur_block(then);
+		int const v = d * 7 % N_VARS;
+		set_value(v, new_Add(get_value(v, mode_Is),
+		                     new_Const_long(mode_Is, 1), mode_Is));
+		add_immBlock_pred(join, new_Jmp());
+		mature_immBlock(join);
+		set_cur_block(join);
+	}
+
+	/* loop back while the first variable is positive */
+	ir_node *cmp  = new_Cmp(get_value(0, mode_Is), new_Const_long(mode_Is, 0),
+	                        ir_relation_greater);
+	ir_node *cond = new_Cond(cmp);
+	add_immBlock_pred(header, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(header);
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+
+	ir_node *sum = get_value(0, mode_Is);
+	for (int v = 1; v < N_VARS; ++v)
+		sum = new_Add(sum, get_value(v, mode_Is), mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &sum);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+/** Gives every node the backend info of a value without a register. */
+static void init_backend_info(ir_node *node, void *env)
+{
+	struct obstack *obst = (struct obstack*)env;
+	if (is_Proj(node))
+		return;
+	node->backend_info = OALLOCZ(obst, backend_info_t);
+	/* a result for each Proj, the Projs of Start and Cond are small */
+	unsigned const n_res = get_irn_mode(node) == mode_T ? 8 : 1;
+	be_info_init_irn(node, arch_irn_flags_none, NULL, n_res);
+	for (unsigned i = 0; i < n_res; ++i)
+		arch_set_irn_register_req_out(node, i, arch_no_register_req);
+}
+
+static void collect_node(ir_node *node, void *env)
+{
+	ir_node ***nodes = (ir_node***)env;
+	if (is_liveness_node(node) && get_irn_mode(node) != mode_T)
+		ARR_APP1(ir_node*, *nodes, node);
+}
+
+static void collect_block(ir_node *block, void *env)
+{
+	ir_node ***blocks = (ir_node***)env;
+	ARR_APP1(ir_node*, *blocks, block);
+}
+
+static double time_compute(be_lv_t *lv, int chk)
+{
+	clock_t start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		be_liveness_invalidate_chk(lv);
+		if (chk)
+			be_liveness_compute_chk(lv);
+		else
+			be_liveness_compute_sets(lv);
+	}
+	return (double)(clock() - start) * 1e3 / (CLOCKS_PER_SEC * N_ROUNDS);
+}
+
+static double time_queries(be_lv_t *lv, ir_node **blocks, ir_node **nodes,
+                           unsigned long *checksum)
+{
+	size_t const n_blocks = ARR_LEN(blocks);
+	size_t const n_nodes  = ARR_LEN(nodes);
+	unsigned long sum = 0;
+	clock_t start = clock();
+	for (size_t b = 0; b < n_blocks; ++b) {
+		for (size_t n = 0; n < n_nodes; ++n)
+			sum += be_get_live_state(lv, blocks[b], nodes[n]);
+	}
+	double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	*checksum = sum;
+	return secs * 1e9 / (n_blocks * n_nodes);
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the graph as built */
+	set_optimize(0);
+
+	ir_graph *irg = build_graph();
+	assure_edges(irg);
+
+	be_irg_t birg;
+	memset(&birg, 0, sizeof(birg));
+	obstack_init(&birg.obst);
+	irg->be_data = &birg;
+	irg_walk_graph(irg, NULL, init_backend_info, &birg.obst);
+
+	ir_node **blocks = NEW_ARR_F(ir_node*, 0);
+	ir_node **nodes  = NEW_ARR_F(ir_node*, 0);
+	irg_block_walk_graph(irg, NULL, collect_block, &blocks);
+	irg_walk_graph(irg, NULL, collect_node, &nodes);
+	printf("%zu blocks, %zu values\n", ARR_LEN(blocks), ARR_LEN(nodes));
+
+	printf("%-8s %12s %12s  %s\n", "", "compute ms", "query ns", "checksum");
+	static const struct {
+		const char *name;
+		const char *option;
+	} variants[] = {
+		{ "sets",    "liveness=sets" },
+		{ "bitsets", "liveness=bitsets" },
+		{ "lv_chk",  NULL },
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(variants); ++i) {
+		int const chk = variants[i].option == NULL;
+		if (!chk)
+			be_parse_arg(variants[i].option);
+		be_lv_t      *lv = be_liveness_new(irg);
+		unsigned long checksum;
+		double const compute = time_compute(lv, chk);
+		double const query   = time_queries(lv, blocks, nodes, &checksum);
+		printf("%-8s %12.1f %12.1f  %lx\n", variants[i].name, compute, query,
+		       checksum);
+		be_liveness_free(lv);
+	}
+
+	DEL_ARR_F(nodes);
+	DEL_ARR_F(blocks);
+	irg->be_data = NULL;
+	obstack_free(&birg.obst, NULL);
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Micro benchmark for the value table of the CSE.
+ *
+ * Builds large graphs with optimizations switched off, where many
+ * expressions are computed several times, and times optimize_graph_df() on
+ * them, which puts every node through the value table. The number of nodes
+ * left in the optimized graphs is printed as a checksum. The program only
+ * uses the public interface, so building it against the libfirm.a of an older
+ * revision gives the numbers to compare against.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "firm.h"
+#include "xmalloc.h"
+
+#define N_PARAMS  8
+#define N_LEAVES  256
+#define N_ROUNDS  3
+
+static unsigned long n_nodes;
+
+static void count_node(ir_node *node, void *env)
+{
+	(void)node;
+	(void)env;
+	++n_nodes;
+}
+
+/** A simple deterministic pseudo random number generator. */
+static unsigned next_random(unsigned *state)
+{
+	*state = *state * 1103515245 + 12345;
+	return *state >> 8;
+}
+
+static ir_graph *build_graph(ir_type *method_type, int nr, int n_exprs)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "f%d", nr);
+	ir_entity *entity = new_entity(get_glob_type(), new_id_from_str(name),
+	                               method_type);
+	ir_graph  *irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *args = get_irg_args(irg);
+	ir_node *leaves[N_LEAVES];
+	for (int i = 0; i < N_LEAVES; ++i) {
+		ir_node *l = new_Proj(args, mode_Is, i % N_PARAMS);
+		ir_node *r = new_Proj(args, mode_Is, i / N_PARAMS % N_PARAMS);
+		leaves[i] = new_Sub(l, r, mode_Is);
+	}
+
+	/* expressions of two leaves, the same ones appear several times */
+	ir_node **exprs = XMALLOCN(ir_node*, n_exprs);
+	unsigned  state = nr;
+	for (int i = 0; i < n_exprs; ++i) {
+		ir_node *l = leaves[next_random(&state) % N_LEAVES];
+		ir_node *r = leaves[next_random(&state) % N_LEAVES];
+		switch (next_random(&state) % 4) {
+		case 0: exprs[i] = new_Add(l, r, mode_Is); break;
+		case 1: exprs[i] = new_Eor(l, r, mode_Is); break;
+		case 2: exprs[i] = new_And(l, r, mode_Is); break;
+		case 3: exprs[i] = new_Or(l, r, mode_Is); break;
+		}
+	}
+	/* combine them in a balanced tree */
+	for (int n = n_exprs; n > 1; n = (n + 1) / 2) {
+		for (int i = 0; i < n / 2; ++i)
+			exprs[i] = new_Eor(exprs[2*i], exprs[2*i + 1], mode_Is);
+		if (n % 2 != 0)
+			exprs[n / 2] = exprs[n - 1];
+	}
+	ir_node *value = exprs[0];
+	free(exprs);
+
+	ir_node *ret = new_Return(get_store(), 1, &value);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+int main(void)
+{
+	ir_init();
+
+	ir_type *int_type    = new_type_primitive(mode_Is);
+	ir_type *method_type = new_type_method(N_PARAMS, 1);
+	for (int i = 0; i < N_PARAMS; ++i)
+		set_method_param_type(method_type, i, int_type);
+	set_method_res_type(method_type, 0, int_type);
+
+	printf("%8s %9s %9s  %s\n", "exprs", "ms", "ns/node", "nodes");
+	static const int sizes[] = { 1000, 10000, 100000, 1000000 };
+	int nr = 0;
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		ir_graph *irgs[N_ROUNDS];
+		/* keep the graphs as built */
+		set_optimize(0);
+		unsigned long n_built = 0;
+		for (unsigned r = 0; r < N_ROUNDS; ++r) {
+			irgs[r] = build_graph(method_type, nr++, sizes[s]);
+			n_built += get_irg_last_idx(irgs[r]);
+		}
+
+		set_optimize(1);
+		clock_t start = clock();
+		for (unsigned r = 0; r < N_ROUNDS; ++r)
+			optimize_graph_df(irgs[r]);
+		double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		n_nodes = 0;
+		for (unsigned r = 0; r < N_ROUNDS; ++r) {
+			irg_walk_graph(irgs[r], count_node, NULL, NULL);
+			free_ir_graph(irgs[r]);
+		}
+		printf("%8d %9.2f %9.1f  %lu\n", sizes[s], secs * 1e3 / N_ROUNDS,
+		       secs * 1e9 / n_built, n_nodes / N_ROUNDS);
+	}
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Micro benchmark for the graph walkers.
+ *
+ * Builds a deep graph (one long chain of Adds) and a wide graph (a balanced
+ * tree of Adds) and prints the time per node for walks with a pre, a post and
+ * both callbacks as well as for the block walker. The callbacks compute an
+ * order dependent checksum, so differing visit orders show up as differing
+ * checksums. The program only uses the public interface, so building it
+ * against the libfirm.a of an older revision gives the numbers to compare
+ * against (the recursive walkers need a big stack for the deep graph).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "firm.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#define N_NODES   200000
+#define N_BLOCKS  1000
+#define N_ROUNDS  20
+
+static unsigned long checksum;
+
+static void pre_walker(ir_node *node, void *env)
+{
+	(void)env;
+	checksum = checksum * 31 + get_irn_node_nr(node);
+}
+
+static void post_walker(ir_node *node, void *env)
+{
+	(void)env;
+	checksum ^= checksum * 17 + get_irn_node_nr(node);
+}
+
+static ir_node *build_deep(ir_node *value)
+{
+	for (int i = 0; i < N_NODES; ++i)
+		value = new_Add(value, new_Const_long(mode_Is, i & 7), mode_Is);
+	return value;
+}
+
+static ir_node *build_wide(ir_node *value)
+{
+	ir_node **level = XMALLOCN(ir_node*, N_NODES);
+	for (int i = 0; i < N_NODES; ++i)
+		level[i] = new_Add(value, new_Const_long(mode_Is, i), mode_Is);
+	for (int n = N_NODES; n > 1; n = (n + 1) / 2) {
+		for (int i = 0; i < n / 2; ++i)
+			level[i] = new_Add(level[2*i], level[2*i + 1], mode_Is);
+		if (n % 2 != 0)
+			level[n / 2] = level[n - 1];
+	}
+	ir_node *res = level[0];
+	free(level);
+	return res;
+}
+
+static ir_graph *build_graph(const char *name, ir_node *(*build)(ir_node*))
+{
+	ir_type *int_type    = new_type_primitive(mode_Is);
+	ir_type *method_type = new_type_method(1, 1);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_res_type(method_type, 0, int_type);
+	ir_entity *entity = new_entity(get_glob_type(), new_id_from_str(name),
+	                               method_type);
+	ir_graph  *irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *value = build(new_Proj(get_irg_args(irg), mode_Is, 0));
+	/* a chain of blocks for the block walker */
+	for (int i = 0; i < N_BLOCKS; ++i) {
+		ir_node *jmp   = new_Jmp();
+		ir_node *block = new_immBlock();
+		add_immBlock_pred(block, jmp);
+		mature_immBlock(block);
+		set_cur_block(block);
+	}
+	ir_node *ret = new_Return(get_store(), 1, &value);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static double time_walk(ir_graph *irg, irg_walk_func *pre, irg_walk_func *post,
+                        int blocks)
+{
+	clock_t start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		if (blocks)
+			irg_block_walk_graph(irg, pre, post, NULL);
+		else
+			irg_walk_graph(irg, pre, post, NULL);
+	}
+	double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	return secs * 1e9 / (N_ROUNDS * get_irg_last_idx(irg));
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the graphs as built */
+	set_optimize(0);
+
+	printf("%-6s %9s %9s %9s %9s  %s\n", "ns/op", "pre", "post", "both",
+	       "blocks", "checksum");
+	static const struct {
+		const char *name;
+		ir_node  *(*build)(ir_node*);
+	} graphs[] = {
+		{ "deep", build_deep },
+		{ "wide", build_wide },
+	};
+	for (size_t g = 0; g < ARRAY_SIZE(graphs); ++g) {
+		ir_graph *irg = build_graph(graphs[g].name, graphs[g].build);
+		checksum = 0;
+		printf("%-6s", graphs[g].name);
+		printf(" %9.1f", time_walk(irg, pre_walker, NULL, 0));
+		printf(" %9.1f", time_walk(irg, NULL, post_walker, 0));
+		printf(" %9.1f", time_walk(irg, pre_walker, post_walker, 0));
+		printf(" %9.1f", time_walk(irg, pre_walker, post_walker, 1));
+		printf("  %lx\n", checksum);
+	}
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Micro benchmark for the textual and the binary IR file formats.
+ *
+ * Builds a program with many small graphs, writes it in both formats and
+ * reads it back. Prints the file sizes, the time for writing and reading and
+ * the time for opening the binary file and loading a single graph. The node
+ * counts of the read graphs are printed as a checksum, they must be the same
+ * for both formats.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "firm.h"
+
+#define N_GRAPHS  500
+#define N_ADDS    200
+#define N_ROUNDS  5
+
+static const char text_name[]   = "bench_irio.ir";
+static const char binary_name[] = "bench_irio.irb";
+
+static void build_graph(ir_type *method_type, int nr)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "f%d", nr);
+	ir_entity *entity = new_entity(get_glob_type(), new_id_from_str(name),
+	                               method_type);
+	ir_graph  *irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *value = new_Proj(get_irg_args(irg), mode_Is, 0);
+	for (int i = 0; i < N_ADDS; ++i) {
+		ir_node *cnst = new_Const_long(mode_Is, i * nr);
+		value = new_Add(value, new_Mul(value, cnst, mode_Is), mode_Is);
+	}
+	ir_node *ret = new_Return(get_store(), 1, &value);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static long file_size(const char *name)
+{
+	FILE *file = fopen(name, "rb");
+	if (file == NULL)
+		return -1;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fclose(file);
+	return size;
+}
+
+/** Sums the node counts of the graphs from position @p first on. */
+static unsigned long count_nodes(size_t first)
+{
+	unsigned long sum = 0;
+	for (size_t i = first, n = get_irp_n_irgs(); i < n; ++i)
+		sum += get_irg_last_idx(get_irp_irg(i));
+	return sum;
+}
+
+static double ms_per_round(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC * 1e3 / N_ROUNDS;
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the graphs as built */
+	set_optimize(0);
+
+	ir_type *int_type    = new_type_primitive(mode_Is);
+	ir_type *method_type = new_type_method(1, 1);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_res_type(method_type, 0, int_type);
+	for (int i = 0; i < N_GRAPHS; ++i)
+		build_graph(method_type, i);
+
+	clock_t start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r)
+		ir_export(text_name);
+	double text_write = ms_per_round(start);
+
+	start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r)
+		ir_export_binary(binary_name);
+	double binary_write = ms_per_round(start);
+
+	/* every import adds a copy of the program */
+	size_t first = get_irp_n_irgs();
+	start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		if (ir_import(text_name) != 0)
+			return 1;
+	}
+	double text_read = ms_per_round(start);
+	unsigned long text_nodes = count_nodes(first);
+
+	first = get_irp_n_irgs();
+	start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		if (ir_import_binary(binary_name) != 0)
+			return 1;
+	}
+	double binary_read = ms_per_round(start);
+	unsigned long binary_nodes = count_nodes(first);
+
+	start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		ir_binary_file_t *file = ir_binary_open(binary_name);
+		if (file == NULL)
+			return 1;
+		ir_binary_load_irg(file, ir_binary_get_n_irgs(file) / 2);
+		if (ir_binary_close(file) != 0)
+			return 1;
+	}
+	double binary_lazy = ms_per_round(start);
+
+	printf("%-7s %10s %9s %9s %9s  %s\n", "format", "bytes", "write ms",
+	       "read ms", "lazy ms", "nodes");
+	printf("%-7s %10ld %9.2f %9.2f %9s  %lu\n", "text", file_size(text_name),
+	       text_write, text_read, "-", text_nodes);
+	printf("%-7s %10ld %9.2f %9.2f %9.2f  %lu\n", "binary",
+	       file_size(binary_name), binary_write, binary_read, binary_lazy,
+	       binary_nodes);
+
+	remove(text_name);
+	remove(binary_name);
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Micro benchmark for the memory layout of the nodes.
+ *
+ * Builds graphs of Add and Const nodes and prints the time per node for
+ * constructing them, for walking them and for computing and walking their
+ * def-use edges (outs). The node count is printed as a checksum. The program
+ * only uses the public interface, so building it against the libfirm.a of an
+ * older revision gives the numbers to compare against.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "firm.h"
+#include "xmalloc.h"
+
+#define N_NODES   200000
+#define N_GRAPHS  10
+#define N_ROUNDS  10
+
+static unsigned long n_visited;
+
+static void count_node(ir_node *node, void *env)
+{
+	(void)node;
+	(void)env;
+	++n_visited;
+}
+
+static void count_outs(ir_node *node, void *env)
+{
+	(void)env;
+	n_visited += get_irn_n_outs(node);
+}
+
+static ir_graph *build_graph(ir_type *method_type, int nr)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "f%d", nr);
+	ir_entity *entity = new_entity(get_glob_type(), new_id_from_str(name),
+	                               method_type);
+	ir_graph  *irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	/* a balanced tree, so the recursive walkers need no big stack */
+	ir_node **level = XMALLOCN(ir_node*, N_NODES);
+	ir_node  *arg   = new_Proj(get_irg_args(irg), mode_Is, 0);
+	for (int i = 0; i < N_NODES; ++i)
+		level[i] = new_Add(arg, new_Const_long(mode_Is, i), mode_Is);
+	for (int n = N_NODES; n > 1; n = (n + 1) / 2) {
+		for (int i = 0; i < n / 2; ++i)
+			level[i] = new_Add(level[2*i], level[2*i + 1], mode_Is);
+		if (n % 2 != 0)
+			level[n / 2] = level[n - 1];
+	}
+	ir_node *value = level[0];
+	free(level);
+
+	ir_node *ret = new_Return(get_store(), 1, &value);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static double ns_per_node(clock_t start, unsigned long n_nodes)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / n_nodes;
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the graphs as built */
+	set_optimize(0);
+
+	ir_type *int_type    = new_type_primitive(mode_Is);
+	ir_type *method_type = new_type_method(1, 1);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_res_type(method_type, 0, int_type);
+
+	ir_graph     *irgs[N_GRAPHS];
+	unsigned long n_nodes = 0;
+	clock_t       start   = clock();
+	for (int g = 0; g < N_GRAPHS; ++g) {
+		irgs[g]  = build_graph(method_type, g);
+		n_nodes += get_irg_last_idx(irgs[g]);
+	}
+	double construct = ns_per_node(start, n_nodes);
+
+	n_visited = 0;
+	start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		for (int g = 0; g < N_GRAPHS; ++g)
+			irg_walk_graph(irgs[g], count_node, NULL, NULL);
+	}
+	double walk = ns_per_node(start, n_nodes * N_ROUNDS);
+	unsigned long walked = n_visited / N_ROUNDS;
+
+	start = clock();
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		for (int g = 0; g < N_GRAPHS; ++g) {
+			compute_irg_outs(irgs[g]);
+			irg_walk_graph(irgs[g], count_outs, NULL, NULL);
+		}
+	}
+	double outs = ns_per_node(start, n_nodes * N_ROUNDS);
+
+	printf("%-7s %9s %9s %9s  %s\n", "ns/node", "construct", "walk", "outs",
+	       "nodes");
+	printf("%-7s %9.1f %9.1f %9.1f  %lu\n", "", construct, walk, outs, walked);
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Benchmark for the overhead of the profile instrumentation.
+ *
+ * Builds a program with a loop nest whose innermost loop contains an if
+ * diamond, compiles it for amd64 without instrumentation, with plain and with
+ * atomic counters, links it with libfirmprof and runs it. Prints the run time
+ * of each variant and, from the profile, the number of counters and counter
+ * increments compared to what a counter in every block would need. Needs a C
+ * compiler for the host.
+ */
+#define _XOPEN_SOURCE 700
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "firm.h"
+#include "irprofile.h"
+
+#define N_OUTER  3000
+#define N_INNER  10000
+#define N_ROUNDS 3
+
+static char dir[] = "/tmp/bench_irprofile.XXXXXX";
+
+/** Adds a counting loop to n around the code of @p body. */
+static void build_loop(int const var, ir_node *const n,
+                       void (*const body)(void))
+{
+	set_value(var, new_Const_long(mode_Is, 0));
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const cmp  = new_Cmp(get_value(var, mode_Is), n,
+	                              ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+	ir_node *const loop = new_immBlock();
+	add_immBlock_pred(loop, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(loop);
+	set_cur_block(loop);
+	body();
+	set_value(var, new_Add(get_value(var, mode_Is),
+	                       new_Const_long(mode_Is, 1), mode_Is));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+}
+
+/** if ((j & 3) == 0) s += j; else s ^= j; */
+static void build_diamond(void)
+{
+	ir_node *const j    = get_value(2, mode_Is);
+	ir_node *const low  = new_And(j, new_Const_long(mode_Is, 3), mode_Is);
+	ir_node *const cmp  = new_Cmp(low, new_Const_long(mode_Is, 0),
+	                              ir_relation_equal);
+	ir_node *const cond = new_Cond(cmp);
+	ir_node *const join = new_immBlock();
+
+	ir_node *const then = new_immBlock();
+	add_immBlock_pred(then, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(then);
+	set_cur_block(then);
+	set_value(0, new_Add(get_value(0, mode_Is), j, mode_Is));
+	add_immBlock_pred(join, new_Jmp());
+
+	ir_node *const otherwise = new_immBlock();
+	add_immBlock_pred(otherwise, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(otherwise);
+	set_cur_block(otherwise);
+	set_value(0, new_Eor(get_value(0, mode_Is), j, mode_Is));
+	add_immBlock_pred(join, new_Jmp());
+
+	mature_immBlock(join);
+	set_cur_block(join);
+}
+
+static void build_inner(void)
+{
+	build_loop(2, new_Const_long(mode_Is, N_INNER), build_diamond);
+}
+
+/** int main(void): runs the loop nest and returns its result & 0 */
+static void build_program(void)
+{
+	ir_type   *const int_type = new_type_primitive(mode_Is);
+	ir_type   *const type     = new_type_method(0, 1);
+	set_method_res_type(type, 0, int_type);
+	ir_entity *const entity   = new_entity(get_glob_type(),
+	                                       new_id_from_str("main"), type);
+	ir_graph  *const irg      = new_ir_graph(entity, 3);
+	set_current_ir_graph(irg);
+
+	set_optimize(0);
+	set_value(0, new_Const_long(mode_Is, 0));
+	build_loop(1, new_Const_long(mode_Is, N_OUTER), build_inner);
+	ir_node *res = new_And(get_value(0, mode_Is), new_Const_long(mode_Is, 0),
+	                       mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	set_optimize(1);
+}
+
+static void init_backend(void)
+{
+	ir_init();
+	be_parse_arg("isa=amd64");
+	build_program();
+}
+
+typedef struct variant_t {
+	char const *name;
+	bool        generate;
+	bool        atomic;
+} variant_t;
+
+static void compile(variant_t const *const variant)
+{
+	init_backend();
+	be_parse_arg(variant->generate ? "profilegenerate=1"
+	                               : "profilegenerate=0");
+	be_parse_arg(variant->atomic ? "profileatomic=1" : "profileatomic=0");
+	FILE *const out = fopen("prog.s", "w");
+	be_main(out, "prog");
+	fclose(out);
+	ir_finish();
+}
+
+/** Prints the counter increments the profile shows. */
+static void print_increments(variant_t const *const variant)
+{
+	(void)variant;
+	init_backend();
+	be_lower_for_target();
+	if (!ir_profile_read("prog.prof")) {
+		printf("could not read the profile\n");
+		return;
+	}
+
+	/* a counter in every block counts each block execution */
+	ir_graph *const irg      = get_irp_irg(0);
+	uint64_t        blocks   = 0;
+	unsigned        n_blocks = 0;
+	for (unsigned i = 0, n = get_irg_last_idx(irg); i < n; ++i) {
+		ir_node *const node = get_idx_irn(irg, i);
+		if (node == NULL || !is_Block(node) || is_Bad(node))
+			continue;
+		blocks += ir_profile_get_block_execcount(node);
+		++n_blocks;
+	}
+	ir_profile_free();
+
+	/* the counters are the last part of the profile */
+	FILE *const in = fopen("prog.prof", "rb");
+	unsigned char header[32];
+	uint64_t      edges      = 0;
+	uint64_t      n_counters = 0;
+	if (fread(header, 1, sizeof(header), in) == sizeof(header)) {
+		for (unsigned i = 8; i-- > 0;)
+			n_counters = n_counters << 8 | header[24 + i];
+		fseek(in, -(long)(n_counters * 8), SEEK_END);
+		for (uint64_t c = 0; c < n_counters; ++c) {
+			unsigned char bytes[8];
+			if (fread(bytes, 1, sizeof(bytes), in) != sizeof(bytes))
+				break;
+			uint64_t count = 0;
+			for (unsigned i = 8; i-- > 0;)
+				count = count << 8 | bytes[i];
+			edges += count;
+		}
+	}
+	fclose(in);
+
+	printf("%-12s %8s %14s\n", "counters in", "number", "increments");
+	printf("%-12s %8u %14llu\n", "blocks", n_blocks,
+	       (unsigned long long)blocks);
+	printf("%-12s %8llu %14llu\n", "edges", (unsigned long long)n_counters,
+	       (unsigned long long)edges);
+	ir_finish();
+}
+
+static void run(void (*const step)(variant_t const*),
+                variant_t const *const variant)
+{
+	fflush(stdout);
+	pid_t const pid = fork();
+	if (pid == 0) {
+		step(variant);
+		exit(0);
+	}
+	int status;
+	waitpid(pid, &status, 0);
+}
+
+static double time_program(void)
+{
+	double best = 0;
+	for (unsigned r = 0; r < N_ROUNDS; ++r) {
+		struct timespec start;
+		struct timespec end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (system("./prog") != 0)
+			return -1;
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		double const ms = (end.tv_sec - start.tv_sec) * 1e3
+		                + (end.tv_nsec - start.tv_nsec) * 1e-6;
+		if (r == 0 || ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+int main(void)
+{
+	char support[1024];
+	if (realpath(__FILE__, support) == NULL) {
+		perror(__FILE__);
+		return 1;
+	}
+	*strrchr(support, '/') = '\0';
+	strncat(support, "/../support/libfirmprof",
+	        sizeof(support) - strlen(support) - 1);
+	if (mkdtemp(dir) == NULL || chdir(dir) != 0) {
+		perror(dir);
+		return 1;
+	}
+	char link[3072];
+	snprintf(link, sizeof(link), "cc -no-pie -Wl,-z,noexecstack -o prog"
+	         " prog.s %s/instrument.c %s/profdata.c", support, support);
+
+	static variant_t const variants[] = {
+		{ "plain",  false, false },
+		{ "edges",  true,  false },
+		{ "atomic", true,  true  },
+	};
+	printf("%d x %d iterations\n", N_OUTER, N_INNER);
+	printf("%-8s %8s\n", "", "run ms");
+	for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); ++i) {
+		run(compile, &variants[i]);
+		if (system(link) != 0)
+			return 1;
+		printf("%-8s %8.1f\n", variants[i].name, time_program());
+	}
+	/* the profile of the last run */
+	run(print_increments, NULL);
+
+	if (system("rm -f prog prog.s prog.prof") != 0)
+		return 1;
+	return rmdir(dir) != 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Micro benchmark for the cost kernels of the PBQP solver.
+ *
+ * Prints the time per call in ns of the vector and matrix operations of the
+ * reductions on register class sized costs (8 to 32 alternatives) and the
+ * time per instance of the heuristic solver on random instances of the same
+ * sizes. About every eighth cost is infinite, like the costs of registers a
+ * value must not be assigned to. The sum of the solutions is printed as a
+ * checksum. Only the kaps interface is used, so building it against the
+ * libfirm.a of an older revision gives the numbers to compare against.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "heuristical.h"
+#include "kaps.h"
+#include "matrix.h"
+#include "vector.h"
+
+#define N_CALLS   200000
+#define N_NODES   200
+#define N_PBQPS   20
+
+static unsigned next_random(unsigned *state)
+{
+	*state = *state * 1103515245 + 12345;
+	return *state >> 8;
+}
+
+/** A random cost below @p limit or, once in a while, an infinite one. */
+static num random_cost(unsigned *state, unsigned limit)
+{
+	unsigned r = next_random(state);
+	return r % 8 == 0 ? INF_COSTS : (r >> 3) % limit;
+}
+
+static vector_t *random_vector(pbqp_t *pbqp, unsigned len, unsigned *state,
+                               unsigned limit)
+{
+	vector_t *vec = vector_alloc(pbqp, len);
+	for (unsigned i = 0; i < len; ++i)
+		vector_set(vec, i, random_cost(state, limit));
+	return vec;
+}
+
+static pbqp_matrix_t *random_matrix(pbqp_t *pbqp, unsigned len,
+                                    unsigned *state, unsigned limit)
+{
+	pbqp_matrix_t *mat = pbqp_matrix_alloc(pbqp, len, len);
+	for (unsigned r = 0; r < len; ++r) {
+		for (unsigned c = 0; c < len; ++c)
+			pbqp_matrix_set(mat, r, c, random_cost(state, limit));
+	}
+	return mat;
+}
+
+static double ns_per_call(clock_t start, unsigned long n_calls)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / n_calls;
+}
+
+static unsigned long bench_kernels(unsigned len)
+{
+	pbqp_t        *pbqp     = alloc_pbqp(1);
+	unsigned       state    = len;
+	/* small costs, so the sums of all calls stay finite */
+	vector_t      *sum      = random_vector(pbqp, len, &state, 4);
+	vector_t      *summand  = random_vector(pbqp, len, &state, 4);
+	vector_t      *flags    = random_vector(pbqp, len, &state, 4);
+	pbqp_matrix_t *mat      = random_matrix(pbqp, len, &state, 4);
+	/* large costs, so subtracting from them stays positive */
+	pbqp_matrix_t *sub      = random_matrix(pbqp, len, &state, 4);
+	for (unsigned r = 0; r < len; ++r) {
+		for (unsigned c = 0; c < len; ++c) {
+			num cost = sub->entries[r * len + c];
+			if (cost != INF_COSTS)
+				pbqp_matrix_set(sub, r, c, cost + 16 * N_CALLS);
+		}
+	}
+	unsigned long checksum = 0;
+
+	clock_t start = clock();
+	for (unsigned i = 0; i < N_CALLS; ++i)
+		vector_add(sum, summand);
+	double add = ns_per_call(start, N_CALLS);
+
+	start = clock();
+	for (unsigned i = 0; i < N_CALLS; ++i) {
+		vector_set(sum, i % len, i % 5);
+		checksum += vector_get_min(sum);
+	}
+	double min = ns_per_call(start, N_CALLS);
+
+	start = clock();
+	for (unsigned i = 0; i < N_CALLS; ++i) {
+		vector_set(sum, i % len, i % 5);
+		checksum += vector_get_min_index(sum);
+	}
+	double min_index = ns_per_call(start, N_CALLS);
+
+	start = clock();
+	for (unsigned i = 0; i < N_CALLS; ++i)
+		checksum += pbqp_matrix_get_row_min(mat, i % len, flags);
+	double row_min = ns_per_call(start, N_CALLS);
+
+	start = clock();
+	for (unsigned i = 0; i < N_CALLS; ++i)
+		checksum += pbqp_matrix_get_col_min(mat, i % len, flags);
+	double col_min = ns_per_call(start, N_CALLS);
+
+	start = clock();
+	for (unsigned i = 0; i < N_CALLS; ++i)
+		vector_add_matrix_col(sum, mat, i % len);
+	double add_col = ns_per_call(start, N_CALLS);
+
+	start = clock();
+	for (unsigned i = 0; i < N_CALLS / len; ++i) {
+		pbqp_matrix_add_to_all_rows(mat, summand);
+		pbqp_matrix_add_to_all_cols(mat, summand);
+	}
+	double add_all = ns_per_call(start, N_CALLS / len * 2);
+
+	start = clock();
+	for (unsigned i = 0; i < N_CALLS; ++i) {
+		pbqp_matrix_sub_row_value(sub, i % len, flags, 1);
+		pbqp_matrix_sub_col_value(sub, i % len, flags, 1);
+	}
+	double sub_value = ns_per_call(start, N_CALLS * 2);
+
+	for (unsigned i = 0; i < len; ++i) {
+		checksum += sum->entries[i].data;
+		for (unsigned j = 0; j < len; ++j)
+			checksum += mat->entries[i * len + j] + sub->entries[i * len + j];
+	}
+	free_pbqp(pbqp);
+
+	printf("%5u %7.1f %7.1f %7.1f %7.1f %7.1f %7.1f %7.1f %7.1f", len, add, min,
+	       min_index, row_min, col_min, add_col, add_all, sub_value);
+	return checksum;
+}
+
+static pbqp_t *random_pbqp(unsigned len, unsigned *state)
+{
+	pbqp_t *pbqp = alloc_pbqp(N_NODES);
+	for (unsigned n = 0; n < N_NODES; ++n) {
+		vector_t *costs = random_vector(pbqp, len, state, 16);
+		/* keep at least one alternative allowed */
+		vector_set(costs, n % len, n % 16);
+		add_node_costs(pbqp, n, costs);
+	}
+	for (unsigned e = 0; e < 3 * N_NODES; ++e) {
+		unsigned src = next_random(state) % N_NODES;
+		unsigned tgt = next_random(state) % N_NODES;
+		if (src == tgt)
+			continue;
+		/* interference like costs: infinite on the diagonal */
+		pbqp_matrix_t *costs = pbqp_matrix_alloc(pbqp, len, len);
+		for (unsigned r = 0; r < len; ++r)
+			pbqp_matrix_set(costs, r, r, INF_COSTS);
+		if (next_random(state) % 4 == 0)
+			costs = random_matrix(pbqp, len, state, 16);
+		add_edge_costs(pbqp, src, tgt, costs);
+	}
+	return pbqp;
+}
+
+static unsigned long bench_solve(unsigned len)
+{
+	unsigned      state    = len;
+	unsigned long checksum = 0;
+	double        secs     = 0;
+	for (unsigned i = 0; i < N_PBQPS; ++i) {
+		pbqp_t *pbqp  = random_pbqp(len, &state);
+		clock_t start = clock();
+		solve_pbqp_heuristical(pbqp);
+		secs     += (double)(clock() - start) / CLOCKS_PER_SEC;
+		checksum += get_solution(pbqp);
+		free_pbqp(pbqp);
+	}
+	printf(" %9.2f", secs * 1e3 / N_PBQPS);
+	return checksum;
+}
+
+int main(void)
+{
+	printf("%5s %7s %7s %7s %7s %7s %7s %7s %7s %9s  %s\n", "alts", "add",
+	       "min", "minidx", "rowmin", "colmin", "addcol", "addall", "sub",
+	       "solve ms", "checksum");
+	static const unsigned lens[] = { 8, 16, 24, 32 };
+	for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); ++l) {
+		unsigned long checksum = bench_kernels(lens[l]);
+		checksum += bench_solve(lens[l]);
+		printf("  %lu\n", checksum);
+	}
+	return 0;
+}
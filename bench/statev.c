@@ -0,0 +1,66 @@
+/*
+ * Micro benchmark for the statistic events.
+ *
+ * Emits the same stream of context pushes, pops and events to a text log
+ * and to a binary log, once without and once with a filter, and prints the
+ * time per event and the size of the logs. The logs are written to the
+ * current directory and removed afterwards.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "firm.h"
+#include "statev.h"
+
+#define N_FUNCTIONS 2000
+#define N_EVENTS    100
+
+static void emit_events(void)
+{
+	for (int f = 0; f < N_FUNCTIONS; ++f) {
+		stat_ev_ctx_push_fmt("irg", "function_%d", f);
+		for (int e = 0; e < N_EVENTS; ++e) {
+			stat_ev_int("bench_nodes", e);
+			stat_ev_dbl("bench_freq", e * 0.25);
+			stat_ev_ull("bench_time", (unsigned long long)f * e);
+		}
+		stat_ev_ctx_pop("irg");
+	}
+}
+
+static void run(char const *mode, char const *filter, bool binary)
+{
+	clock_t start = clock();
+	if (binary) {
+		stat_ev_begin_binary("bench_statev", filter);
+	} else {
+		stat_ev_begin("bench_statev", filter);
+	}
+	emit_events();
+	stat_ev_end();
+	double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	char const *file = binary ? "bench_statev.evb" : "bench_statev.ev";
+	struct stat st;
+	long size = stat(file, &st) == 0 ? (long)st.st_size : -1;
+	remove(file);
+
+	double n_events = (double)N_FUNCTIONS * (N_EVENTS * 3 + 2);
+	printf("%-7s %-9s %9.2f %9.1f %10ld\n", mode, filter != NULL ? filter : "-",
+	       secs * 1e3, secs * 1e9 / n_events, size);
+}
+
+int main(void)
+{
+	ir_init();
+	printf("%-7s %-9s %9s %9s %10s\n", "mode", "filter", "ms", "ns/event",
+	       "bytes");
+	run("text",   NULL,      false);
+	run("binary", NULL,      true);
+	run("text",   "^bench_n", false);
+	run("binary", "^bench_n", true);
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Micro benchmark for the strcalc arithmetic.
+ *
+ * Runs the operations constant folding needs most on values sign extended
+ * from 32, 64 and 128 bits and prints the time per operation. The program
+ * only uses the sc_* interface, so building it against the libfirm.a of an
+ * older revision gives the numbers to compare against.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "strcalc.h"
+#include "xmalloc.h"
+#include "util.h"
+
+#define N_VALUES  256
+#define N_ROUNDS  200
+
+static unsigned value_length;
+
+typedef void (*bench_func)(const sc_word *v0, const sc_word *v1,
+                           sc_word *dest);
+
+static void bench_add(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	sc_add(v0, v1, dest);
+}
+
+static void bench_sub(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	sc_sub(v0, v1, dest);
+}
+
+static void bench_mul(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	sc_mul(v0, v1, dest);
+}
+
+static void bench_div(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	sc_word *rem = ALLOCAN(sc_word, value_length);
+	sc_divmod(v0, v1, dest, rem);
+}
+
+static void bench_shl(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	sc_shlI(v0, v1[0] & 31, dest);
+}
+
+static void bench_shrs(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	sc_shrsI(v0, v1[0] & 31, 128, dest);
+}
+
+static void bench_comp(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	dest[0] = sc_comp(v0, v1);
+}
+
+static void bench_print(const sc_word *v0, const sc_word *v1, sc_word *dest)
+{
+	(void)v1;
+	char buf[160];
+	dest[0] = *sc_print_buf(buf, sizeof(buf), v0, 128, SC_DEC, true);
+}
+
+static const struct {
+	const char *name;
+	bench_func  func;
+} benchs[] = {
+	{ "add",   bench_add   },
+	{ "sub",   bench_sub   },
+	{ "mul",   bench_mul   },
+	{ "div",   bench_div   },
+	{ "shl",   bench_shl   },
+	{ "shrs",  bench_shrs  },
+	{ "comp",  bench_comp  },
+	{ "print", bench_print },
+};
+
+static unsigned long long rnd_state = 88172645463325252ULL;
+
+static unsigned long rnd_ulong(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 7;
+	rnd_state ^= rnd_state << 17;
+	return (unsigned long)rnd_state;
+}
+
+/** Creates random values sign extended from @p bits. None of them is zero. */
+static sc_word **make_values(unsigned bits)
+{
+	sc_word **values = XMALLOCN(sc_word*, N_VALUES);
+	sc_word  *part   = XMALLOCN(sc_word, value_length);
+	for (unsigned i = 0; i < N_VALUES; ++i) {
+		sc_word *value = XMALLOCN(sc_word, value_length);
+		sc_val_from_ulong(rnd_ulong() | 1, value);
+		for (unsigned b = 32; b < bits; b += 32) {
+			sc_val_from_ulong(rnd_ulong() & 0xFFFFFFFFul, part);
+			sc_shlI(part, b, part);
+			sc_or(value, part, value);
+		}
+		sc_sign_extend(value, bits);
+		values[i] = value;
+	}
+	free(part);
+	return values;
+}
+
+int main(void)
+{
+	/* the tarval module uses the same precision */
+	init_strcalc(128 + 4);
+	value_length = sc_get_value_length();
+
+	static const unsigned widths[] = { 32, 64, 128 };
+	sc_word **values[ARRAY_SIZE(widths)];
+	for (unsigned w = 0; w < ARRAY_SIZE(widths); ++w)
+		values[w] = make_values(widths[w]);
+	sc_word *dest = XMALLOCN(sc_word, value_length);
+
+	printf("%-6s", "ns/op");
+	for (unsigned w = 0; w < ARRAY_SIZE(widths); ++w)
+		printf(" %9u", widths[w]);
+	printf(" %9s\n", "mixed");
+
+	for (unsigned b = 0; b < ARRAY_SIZE(benchs); ++b) {
+		printf("%-6s", benchs[b].name);
+		/* the last column mixes the widths of the operands */
+		for (unsigned w = 0; w <= ARRAY_SIZE(widths); ++w) {
+			clock_t start = clock();
+			for (unsigned r = 0; r < N_ROUNDS; ++r) {
+				for (unsigned i = 0; i < N_VALUES; ++i) {
+					unsigned w0 = w < ARRAY_SIZE(widths) ? w : i % 3;
+					unsigned w1 = w < ARRAY_SIZE(widths) ? w : (i+r) % 3;
+					const sc_word *v0 = values[w0][i];
+					const sc_word *v1 = values[w1][(i*7 + r) % N_VALUES];
+					benchs[b].func(v0, v1, dest);
+				}
+			}
+			double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+			printf(" %9.1f", secs * 1e9 / (N_ROUNDS * N_VALUES));
+		}
+		printf("\n");
+	}
+	return 0;
+}
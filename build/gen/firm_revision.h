@@ -0,0 +1 @@
+#define libfirm_VERSION_REVISION "dev"
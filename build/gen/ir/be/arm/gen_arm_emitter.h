@@ -0,0 +1,14 @@
+/**
+ * @file
+ * @brief Function prototypes for the emitter functions.
+ * @note  DO NOT EDIT THIS FILE, your changes will be lost.
+ *         Edit ir/be/arm/arm_spec.pl instead.
+ *         created by: ./ir/be/scripts/generate_emitter.pl ir/be/arm/arm_spec.pl build/gen/ir/be/arm
+ * @date  Sat Oct 17 03:24:45 2026
+ */
+#ifndef FIRM_BE_ARM_GEN_ARM_EMITTER_H
+#define FIRM_BE_ARM_GEN_ARM_EMITTER_H
+
+void arm_register_spec_emitters(void);
+
+#endif
@@ -0,0 +1,14 @@
+/**
+ * @file
+ * @brief Function prototypes for the emitter functions.
+ * @note  DO NOT EDIT THIS FILE, your changes will be lost.
+ *         Edit ir/be/ia32/ia32_spec.pl instead.
+ *         created by: ./ir/be/scripts/generate_emitter.pl ir/be/ia32/ia32_spec.pl build/gen/ir/be/ia32
+ * @date  Sat Oct 17 03:24:47 2026
+ */
+#ifndef FIRM_BE_IA32_GEN_IA32_EMITTER_H
+#define FIRM_BE_IA32_GEN_IA32_EMITTER_H
+
+void ia32_register_spec_emitters(void);
+
+#endif
@@ -157,8 +157,9 @@ typedef struct backend_params {
 /**
  * Parse one backend argument. This is intended to provide commandline options
  * to various backend parameters that might be changing.
- * Returns -1 if 'help' was found, 0 if the argument could not be parsed,
- * 1 if the option could be set.
+ * Returns -1 if 'help' was found, 0 if the argument could not be parsed or
+ * asks for an object file from a backend which cannot write one, 1 if the
+ * option could be set.
  */
 FIRM_API int be_parse_arg(const char *arg);
 
@@ -79,6 +79,13 @@ FIRM_API int has_irg_callee_backedge(const ir_graph *irg);
 /** Returns the maximal loop depth of call nodes that call along this edge. */
 FIRM_API size_t get_irg_callee_loop_depth(const ir_graph *irg, size_t pos);
 
+/** Returns the number of Call nodes calling the callee at position pos. */
+FIRM_API size_t get_irg_callee_n_calls(const ir_graph *irg, size_t pos);
+
+/** Returns the Call node number call calling the callee at position pos. */
+FIRM_API ir_node *get_irg_callee_call(const ir_graph *irg, size_t pos,
+                                      size_t call);
+
 /** Returns the method execution frequency of a graph. */
 FIRM_API double get_irg_method_execution_frequency(const ir_graph *irg);
 
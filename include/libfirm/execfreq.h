@@ -36,6 +36,35 @@ FIRM_API void ir_estimate_execfreq(ir_graph *irg);
 /** Returns execution frequency of block @p block. */
 FIRM_API double get_block_execfreq(const ir_node *block);
 
+/**
+ * Reads how often the functions were entered and how often they called each
+ * other from the profile @p filename, which a program compiled with the
+ * backend option profilegenerate wrote. The counts are kept by the names of
+ * the functions, so unlike the block counts used by the backend they can be
+ * read before the graphs are optimized. The inliner uses them.
+ * @returns 1 if the profile was read, 0 otherwise
+ */
+FIRM_API int ir_profile_read_calls(const char *filename);
+
+/** Frees the counts read by ir_profile_read_calls(). */
+FIRM_API void ir_profile_free_calls(void);
+
+/**
+ * Returns how often @p function was entered in the profiled runs, 0 if the
+ * profile has no data for it.
+ */
+FIRM_API unsigned long long ir_profile_get_entry_count(const ir_entity *function);
+
+/**
+ * Returns how often the call @p call of the function @p caller ran in the
+ * profiled runs, 0 if the profile has no data for it. Calls are told apart
+ * by their callee and by the source position of their debug info. Calls of
+ * the same callee at the same position, e.g. calls without debug info, get
+ * the average of their counts.
+ */
+FIRM_API unsigned long long ir_profile_get_call_count(const ir_entity *caller,
+                                                      const ir_node *call);
+
 /** @} */
 
 #include "end.h"
@@ -524,6 +524,8 @@ FIRM_API ir_node *new_ASM(ir_node *mem, int arity, ir_node *in[],
 
 /**
  * Global variable holding the graph which is currently constructed.
+ * Only the construction interface uses it; analyses and optimizations get
+ * their graph passed explicitly and never read or change current_ir_graph.
  */
 FIRM_API ir_graph *current_ir_graph;
 
@@ -77,7 +77,7 @@
  * - n_loc           An int giving the number of local variables in this
  *                   procedure.  This is needed for ir construction.
  *
- * - value_table     This hash table (pset) is used for global value numbering
+ * - value_table     This hash table is used for global value numbering
  *                   for optimizing use in iropt.c.
  *
  * - visited         A int used as flag to traverse the ir_graph.
@@ -5,7 +5,7 @@
 
 /**
  * @file
- * @brief   Input/Output textual representation of firm.
+ * @brief   Input/Output textual or binary representation of firm.
  * @author  Moritz Kroll
  */
 #ifndef FIRM_IR_IRIO_H
@@ -52,6 +52,70 @@ FIRM_API int ir_import(const char *filename);
  */
 FIRM_API int ir_import_file(FILE *input, const char *inputname);
 
+/**
+ * Exports the whole irp to the given file in a compact binary form.
+ * The binary form contains the same information as the textual one, but is
+ * faster to write and read and allows loading single graphs on demand.
+ *
+ * @param filename  the name of the resulting file
+ * @return  0 if no errors occured, other values in case of errors
+ */
+FIRM_API int ir_export_binary(const char *filename);
+
+/**
+ * same as ir_export_binary but writes to a FILE*
+ * @note As with any FILE* errors are indicated by ferror(output)
+ */
+FIRM_API void ir_export_binary_file(FILE *output);
+
+/**
+ * Imports everything stored in the given binary file.
+ * This is the same as opening the file with ir_binary_open(), loading all
+ * graphs and closing it.
+ *
+ * @param filename  the name of the file
+ * @returns 0 if no errors occured, other values in case of errors
+ */
+FIRM_API int ir_import_binary(const char *filename);
+
+/** An opened binary firm file. */
+typedef struct ir_binary_file_t ir_binary_file_t;
+
+/**
+ * Opens a binary firm file and imports its modes, types, entities, the
+ * constant graph and the program information. The graphs of the file are
+ * not constructed until they are loaded with ir_binary_load_irg().
+ *
+ * @param filename  the name of the file
+ * @returns the opened file or NULL if it could not be opened
+ */
+FIRM_API ir_binary_file_t *ir_binary_open(const char *filename);
+
+/**
+ * Returns the number of graphs stored in a binary firm file.
+ */
+FIRM_API size_t ir_binary_get_n_irgs(const ir_binary_file_t *file);
+
+/**
+ * Returns the entity of the graph at position @p pos of a binary firm file.
+ * The entity is available without loading the graph.
+ */
+FIRM_API ir_entity *ir_binary_get_irg_entity(const ir_binary_file_t *file,
+                                             size_t pos);
+
+/**
+ * Constructs the graph at position @p pos of a binary firm file, if this has
+ * not happened before, and returns it.
+ */
+FIRM_API ir_graph *ir_binary_load_irg(ir_binary_file_t *file, size_t pos);
+
+/**
+ * Closes a binary firm file. Graphs which were not loaded are dropped.
+ *
+ * @returns 0 if no errors occured while reading, other values otherwise
+ */
+FIRM_API int ir_binary_close(ir_binary_file_t *file);
+
 /** @} */
 
 #include "end.h"
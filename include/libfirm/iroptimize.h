@@ -404,6 +404,10 @@ typedef void (*opt_ptr)(ir_graph *irg);
  * Heuristic inliner. Calculates a benefice value for every call and inlines
  * those calls with a value higher than the threshold.
  *
+ * If call counts were read with ir_profile_read_calls() before, calls are
+ * prioritized by their profiled frequency, rarely executed calls are not
+ * inlined and frequently executed ones get a size budget of their own.
+ *
  * @param maxsize             Do not inline any calls if a method has more than
  *                            maxsize firm nodes.  It may reach this limit by
  *                            inlining.
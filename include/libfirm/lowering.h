@@ -81,6 +81,12 @@ FIRM_API void lower_CopyB(ir_graph *irg, unsigned max_small_size,
 /**
  * Lowers all Switches (Cond nodes with non-boolean mode) depending on spare_size.
  * They will either remain the same or be converted into if-cascades.
+ * An if-cascade may contain smaller Switches for dense ranges of cases and
+ * bit mask tests for cases with few different targets. If the graph has
+ * block execution frequencies, the cascade is balanced by them and a case
+ * taken in most executions is tested first, else it is balanced by the
+ * number of cases. The backends lower switches before the frequencies are
+ * estimated or read from a profile, so there the number of cases is used.
  *
  * @param irg        The ir graph to be lowered.
  * @param small_switch  If switch has <= cases then change it to an if-cascade.
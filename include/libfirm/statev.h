@@ -61,7 +61,24 @@ FIRM_API void stat_ev(const char *name);
 FIRM_API void stat_ev_begin(const char *filename_prefix, const char *filter);
 
 /**
- * Shuts down stat ev machinery
+ * Initialize the stat ev machinery to write a binary event log.
+ *
+ * Works like stat_ev_begin() but writes @p filename_prefix.evb. Keys are
+ * interned and events are fixed size records, which are collected in per
+ * thread buffers and written by a background thread. If libfirm is built
+ * without thread support (FIRM_THREADS), the emitting thread writes a buffer
+ * when it is full and only one thread may emit events. Use
+ * support/statev_decode.py to turn the log into the text format, or pass it
+ * to support/statev_sql.py directly.
+ * @param filename_prefix  The name of the file (.evb will be appended).
+ * @param filter           Filter for the keys, see stat_ev_begin().
+ */
+FIRM_API void stat_ev_begin_binary(const char *filename_prefix,
+                                   const char *filter);
+
+/**
+ * Shuts down stat ev machinery. When writing a binary log, no other thread
+ * may emit events while this runs.
  */
 FIRM_API void stat_ev_end(void);
 
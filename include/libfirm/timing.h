@@ -10,13 +10,16 @@
 #ifndef FIRM_TIMING_H
 #define FIRM_TIMING_H
 
+#include <stdio.h>
+
 #include "begin.h"
 
 /**
  * A timer
  *
  * A timer can be started/stopped multiple times and measures the (wallclock)
- * time spent between start and stop calls.
+ * time spent between start and stop calls. Where available the monotonic
+ * clock with nano second resolution is used.
  */
 typedef struct ir_timer_t ir_timer_t;
 
@@ -109,11 +112,51 @@ FIRM_API unsigned long ir_timer_elapsed_msec(const ir_timer_t *timer);
  */
 FIRM_API unsigned long ir_timer_elapsed_usec(const ir_timer_t *timer);
 
+/**
+ * Returns the number of nanoseconds, the timer has elapsed.
+ * @param timer The timer.
+ * @return The number of nanoseconds the timer is (was) running.
+ */
+FIRM_API unsigned long long ir_timer_elapsed_nsec(const ir_timer_t *timer);
+
 /**
  * Returns the number of seconds, the timer has elapsed.
  */
 FIRM_API double ir_timer_elapsed_sec(const ir_timer_t *timer);
 
+/**
+ * Enables the timing of passes. From now on the time spent in every
+ * optimization pass, every analysis computed on demand and every backend
+ * step is accumulated per function and pass.
+ * @note The pass timing is not thread safe.
+ * @param hw_counters  if non-zero, the processor cycles, instructions, cache
+ *                     misses and branch misses of every pass are counted as
+ *                     well (Linux perf events; a warning is printed if they
+ *                     are unavailable)
+ */
+FIRM_API void ir_pass_timing_enable(int hw_counters);
+
+/**
+ * Disables the timing of passes. The collected data is kept.
+ */
+FIRM_API void ir_pass_timing_disable(void);
+
+/**
+ * Discards the collected pass timing data.
+ */
+FIRM_API void ir_pass_timing_reset(void);
+
+/**
+ * Writes the collected pass timing data to @p out. Every function and pass
+ * gets a line with the number of calls, the time spent in the pass itself
+ * (self) and including nested passes (total) and the hardware counters of
+ * the pass itself. Passes running outside of a function are listed under
+ * "<program>".
+ * @param out   the output file
+ * @param json  if non-zero, write a JSON array of objects instead of a table
+ */
+FIRM_API void ir_pass_timing_dump(FILE *out, int json);
+
 #include "end.h"
 
 #endif
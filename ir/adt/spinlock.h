@@ -0,0 +1,74 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Spin locks and atomic counters for short critical sections.
+ *
+ * These only need compiler support, so the tables shared by all threads
+ * (idents, tarvals) can be protected without linking a thread library.
+ * Compilers without the atomic builtins of GCC, clang or MSVC get locks and
+ * counters which do nothing, libFirm may then only be used by one thread.
+ */
+#ifndef FIRM_ADT_SPINLOCK_H
+#define FIRM_ADT_SPINLOCK_H
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif !defined(__GNUC__) && defined(FIRM_THREADS)
+#error "FIRM_THREADS needs the atomic builtins of GCC, clang or MSVC"
+#endif
+
+typedef struct spinlock_t {
+	char locked;
+} spinlock_t;
+
+#define SPINLOCK_INIT { 0 }
+
+static inline void spinlock_lock(spinlock_t *lock)
+{
+#if defined(__GNUC__)
+	while (__atomic_test_and_set(&lock->locked, __ATOMIC_ACQUIRE)) {
+		/* wait without writing to the cache line */
+		while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED)) {
+		}
+	}
+#elif defined(_MSC_VER)
+	while (_InterlockedExchange8(&lock->locked, 1) != 0) {
+		while (*(volatile char*)&lock->locked) {
+		}
+	}
+#else
+	/* single threaded */
+	lock->locked = 1;
+#endif
+}
+
+static inline void spinlock_unlock(spinlock_t *lock)
+{
+#if defined(__GNUC__)
+	__atomic_clear(&lock->locked, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+	_InterlockedExchange8(&lock->locked, 0);
+#else
+	lock->locked = 0;
+#endif
+}
+
+/**
+ * Increments @p *counter atomically and returns its previous value.
+ */
+static inline unsigned atomic_post_inc(unsigned *counter)
+{
+#if defined(__GNUC__)
+	return __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+	return (unsigned)_InterlockedIncrement((long volatile*)counter) - 1;
+#else
+	return (*counter)++;
+#endif
+}
+
+#endif
@@ -158,6 +158,18 @@ size_t get_irg_callee_loop_depth(const ir_graph *irg, size_t pos)
 	return irg->callees ? irg->callees[pos]->max_depth : 0;
 }
 
+size_t get_irg_callee_n_calls(const ir_graph *irg, size_t pos)
+{
+	assert(pos < get_irg_n_callees(irg));
+	return ARR_LEN(irg->callees[pos]->call_list);
+}
+
+ir_node *get_irg_callee_call(const ir_graph *irg, size_t pos, size_t call)
+{
+	assert(call < get_irg_callee_n_calls(irg, pos));
+	return irg->callees[pos]->call_list[call];
+}
+
 
 /**
  * Pre-Walker called by compute_callgraph(), analyses all Call nodes.
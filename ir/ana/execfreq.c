@@ -24,13 +24,20 @@
  * no path to the end node, which produces undesired results (0, infinite
  * execution frequencies). We alleviate that by adding artificial edges from
  * kept blocks with a path to end.
+ *
+ * The system is never built as a dense matrix. For reducible control flow it
+ * is solved directly: Walking the blocks in reverse postorder a block's
+ * frequency is the sum of its incoming forward edges, loop headers are
+ * additionally scaled by 1/(1-p) where p is the probability that the loop
+ * is entered again from its own back edges (see Wu, Larus: "Static Branch
+ * Frequency and Program Profile Analysis"). Irreducible loops have no single
+ * header to summarize them, they are solved together with their enclosing
+ * loop by a Gauss-Seidel iteration on the remaining back edges.
  */
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
-#include "gaussjordan.h"
-
 #include "set.h"
 #include "hashptr.h"
 #include "dfs_t.h"
@@ -56,124 +63,10 @@
 
 #define MAX_INT_FREQ 1000000
 
-static hook_entry_t hook;
-
-typedef struct {
-	unsigned size;
-	double   entries[];
-} square_matrix;
-
-static square_matrix *mat_create(int n)
-{
-	square_matrix *result = xmalloc(sizeof(square_matrix) + n * n * sizeof(double));
-	result->size = n;
-	return result;
-}
-
-/*
- * Algorithm for QR decomposition taken from JAMA/C++ Linear Algebra
- * Library.
- * See http://math.nist.gov/tnt/jama_doxygen/jama_qr_h-source.html.
- * License: Public domain (U.S. government work).
- */
-static inline void setm(square_matrix *a, unsigned row, unsigned col, double val)
-{
-	a->entries[row * a->size + col] = val;
-}
-
-static inline double getm(const square_matrix *a, unsigned row, unsigned col)
-{
-	return a->entries[row * a->size + col];
-}
-
-/**
- * Use QR decomposition to find the nullspace of a (size n * n). This
- * function assumes that rank(a) = n-1.
- */
-static void nullspace(square_matrix *a, double *result)
-{
-	// The nullspace of a is the n-th column of q, where q * r is
-	// the QR decomposition of transpose(a).
-
-	unsigned       n  = a->size;
-	square_matrix *qr = mat_create(n);
-
-	// Transpose a
-	for (unsigned x = 0; x < n; x++) {
-		for (unsigned y = 0; y < n; y++) {
-			double val = getm(a, y, x);
-			setm(qr, x, y, val);
-		}
-	}
-
-	// In-place computation of qr.
-	for (unsigned k = 0; k < n; k++) {
-		// Compute 2-norm of k-th column without under/overflow.
-		double nrm = 0;
-		for (unsigned i = k; i < n; i++) {
-			nrm = hypot(nrm, getm(qr, i, k));
-		}
-
-		if (nrm == 0.0)
-			continue;
-		// Form k-th Householder vector.
-		if (getm(qr, k, k) < 0)
-			nrm = -nrm;
-		for (unsigned i = k; i < n; i++) {
-			double val = getm(qr, i, k);
-			val /= nrm;
-			setm(qr, i, k, val);
-		}
-		double val = getm(qr, k, k);
-		val += 1.0;
-		setm(qr, k, k, val);
-
-		// Apply transformation to remaining columns.
-		for (unsigned j = k+1; j < n; j++) {
-			double s = 0.0;
-			for (unsigned i = k; i < n; i++) {
-				s += getm(qr, i, k) * getm(qr, i, j);
-			}
-			s = -s / getm(qr, k, k);
-			for (unsigned i = k; i < n; i++) {
-				double val = getm(qr, i, j);
-				val += s * getm(qr, i, k);
-				setm(qr, i, j, val);
-			}
-		}
-	}
-
-	square_matrix *q = mat_create(n);
+#define SEIDEL_TOLERANCE      1e-12
+#define MAX_SEIDEL_ITERATIONS 10000
 
-	// Computation of Q from QR.
-	for (unsigned k = n; k-- > 0; ) {
-		for (unsigned i = 0; i < n; i++) {
-			setm(q, i, k, 0.0);
-		}
-		setm(q, k, k, 1.0);
-		for (unsigned j = k; j < n; j++) {
-			if (getm(qr, k, k) == 0)
-				continue;
-			double s = 0.0;
-			for (unsigned i = k; i < n; i++) {
-				s += getm(qr, i, k) * getm(q, i, j);
-			}
-			s = -s / getm(qr, k, k);
-			for (unsigned i = k; i < n; i++) {
-				double val = getm(q, i, j);
-				val += s * getm(qr, i, k);
-				setm(q, i, j, val);
-			}
-		}
-	}
-
-	// Fill nullspace with required information
-	for (unsigned i = 0; i < n; i++) {
-		result[i] = getm(q, i, n-1);
-	}
-	free(qr);
-	free(q);
-}
+static hook_entry_t hook;
 
 double get_block_execfreq(const ir_node *block)
 {
@@ -362,35 +255,267 @@ static void block_walk_no_keeps(ir_node *block)
 }
 
 /**
- * Computes (matrix row r_acc) += (matrix row r_x) * weight.
+ * The control flow graph with the edge probabilities, blocks are numbered in
+ * reverse postorder.
  */
-static void add_weighted(square_matrix *mat, unsigned r_acc, unsigned r_x,
-                         double weight)
+typedef struct freq_cfg_t {
+	unsigned  n_blocks;
+	ir_node **blocks;     /**< the blocks in reverse postorder */
+	unsigned *pred_begin; /**< in-edges of block i are pred_begin[i] up to
+	                           pred_begin[i+1] */
+	unsigned *pred_idx;   /**< the source block of an in-edge */
+	double   *pred_prob;  /**< probability that the source takes the edge */
+	unsigned  start_idx;
+	unsigned  end_idx;
+} freq_cfg_t;
+
+static unsigned get_block_idx(const ir_node *block)
+{
+	return PTR_TO_INT(get_irn_link(block));
+}
+
+static bool is_retreating_edge(unsigned pred_idx, unsigned idx)
 {
-	for (unsigned c = 0; c < mat->size; c++) {
-		double val = getm(mat, r_acc, c);
-		val += getm(mat, r_x, c) * weight;
-		setm(mat, r_acc, c, val);
+	return pred_idx >= idx;
+}
+
+static void build_freq_cfg(freq_cfg_t *cfg, ir_graph *irg, dfs_t *dfs,
+                           double inv_loop_weight)
+{
+	unsigned const n_blocks = dfs_get_n_nodes(dfs);
+	cfg->n_blocks   = n_blocks;
+	cfg->blocks     = XMALLOCN(ir_node*, n_blocks);
+	cfg->pred_begin = XMALLOCN(unsigned, n_blocks + 1);
+	for (unsigned idx = 0; idx < n_blocks; ++idx) {
+		ir_node *const bb = dfs_get_post_num_node(dfs, n_blocks - idx - 1);
+		cfg->blocks[idx] = bb;
+		set_irn_link(bb, INT_TO_PTR(idx));
 	}
+
+	ir_node *const end_block = get_irg_end_block(irg);
+	cfg->start_idx = get_block_idx(get_irg_start_block(irg));
+	cfg->end_idx   = get_block_idx(end_block);
+
+	cfg->pred_idx  = NEW_ARR_F(unsigned, 0);
+	cfg->pred_prob = NEW_ARR_F(double, 0);
+	for (unsigned idx = 0; idx < n_blocks; ++idx) {
+		ir_node *const bb = cfg->blocks[idx];
+		cfg->pred_begin[idx] = ARR_LEN(cfg->pred_idx);
+		for (int i = 0, n = get_Block_n_cfgpreds(bb); i < n; ++i) {
+			ir_node *const pred = get_Block_cfgpred_block(bb, i);
+			if (pred == NULL)
+				continue;
+			double const prob = get_cf_probability(bb, i, inv_loop_weight);
+			ARR_APP1(unsigned, cfg->pred_idx, get_block_idx(pred));
+			ARR_APP1(double, cfg->pred_prob, prob);
+		}
+		if (bb != end_block)
+			continue;
+
+		/* add artifical edges from "kept blocks without a path to end"
+		 * to end */
+		const ir_node *end = get_irg_end(irg);
+		for (int k = get_End_n_keepalives(end); k-- > 0; ) {
+			ir_node *keep = get_End_keepalive(end, k);
+			if (!is_Block(keep) || has_path_to_end(keep))
+				continue;
+
+			double sum = get_sum_succ_factors(keep, inv_loop_weight);
+			ARR_APP1(unsigned, cfg->pred_idx, get_block_idx(keep));
+			ARR_APP1(double, cfg->pred_prob, KEEP_FAC/sum);
+		}
+	}
+	cfg->pred_begin[n_blocks] = ARR_LEN(cfg->pred_idx);
+}
+
+static void free_freq_cfg(freq_cfg_t *cfg)
+{
+	free(cfg->blocks);
+	free(cfg->pred_begin);
+	DEL_ARR_F(cfg->pred_idx);
+	DEL_ARR_F(cfg->pred_prob);
+}
+
+/** Returns the sum of the frequencies flowing into block @p idx. */
+static double get_in_freq(const freq_cfg_t *cfg, const double *freqs,
+                          unsigned idx)
+{
+	double sum = 0.0;
+	for (unsigned e = cfg->pred_begin[idx]; e < cfg->pred_begin[idx+1]; ++e)
+		sum += cfg->pred_prob[e] * freqs[cfg->pred_idx[e]];
+	return sum;
+}
+
+static int cmp_unsigned(const void *p1, const void *p2)
+{
+	unsigned const u1 = *(const unsigned*)p1;
+	unsigned const u2 = *(const unsigned*)p2;
+	return (u1 > u2) - (u1 < u2);
 }
 
 /**
- * Computes the row-th entry of mat . vec.
- *
- * The elements in vec must be finite unless mat has a 0 at the
- * corresponding position.
+ * Collects the natural loop of the header @p header into @p body (sorted in
+ * reverse postorder, starting with the header).
+ * @returns false if the retreating edges into @p header do not form a natural
+ *          loop, i.e. the control flow is irreducible.
  */
-static double mat_dot_vec_entry(square_matrix *mat, double *vec, int row)
+static bool collect_loop_body(const freq_cfg_t *cfg, unsigned header,
+                              unsigned *mark, unsigned **body)
 {
-	double acc = 0.0;
-	for (unsigned i = 0; i < mat->size; i++) {
-		double val = getm(mat, row, i);
-		if (val == 0)
+	/* every block which reaches a back edge without passing the header is
+	 * part of the loop. If we reach a block before the header in reverse
+	 * postorder the header does not dominate the loop. */
+	unsigned const stamp = header + 1;
+	ARR_RESIZE(unsigned, *body, 0);
+	ARR_APP1(unsigned, *body, header);
+	mark[header] = stamp;
+	for (unsigned e = cfg->pred_begin[header];
+	     e < cfg->pred_begin[header+1]; ++e) {
+		unsigned const pred_idx = cfg->pred_idx[e];
+		if (!is_retreating_edge(pred_idx, header) || mark[pred_idx] == stamp)
 			continue;
-		assert(isfinite(vec[i]));
-		acc += val * vec[i];
+		mark[pred_idx] = stamp;
+		ARR_APP1(unsigned, *body, pred_idx);
 	}
-	return acc;
+	for (size_t i = 1; i < ARR_LEN(*body); ++i) {
+		unsigned const idx = (*body)[i];
+		for (unsigned e = cfg->pred_begin[idx]; e < cfg->pred_begin[idx+1];
+		     ++e) {
+			unsigned const pred_idx = cfg->pred_idx[e];
+			if (mark[pred_idx] == stamp)
+				continue;
+			if (pred_idx < header || pred_idx == cfg->start_idx)
+				return false;
+			mark[pred_idx] = stamp;
+			ARR_APP1(unsigned, *body, pred_idx);
+		}
+	}
+	qsort(*body, ARR_LEN(*body), sizeof((*body)[0]), cmp_unsigned);
+	return true;
+}
+
+/**
+ * Computes the frequencies of the blocks in @p region (sorted in reverse
+ * postorder) relative to its first block, which gets frequency 1. Loops which
+ * are already solved only contribute their cyclic probability. The retreating
+ * edges into irreducible loops are kept in the system, which is then solved
+ * by repeating the sweep (a Gauss-Seidel iteration) until it converges.
+ * @returns false if the iteration did not converge
+ */
+static bool propagate_freqs(const freq_cfg_t *cfg, const double *cyclic_prob,
+                            const bool *irreducible, const unsigned *region,
+                            size_t n_region, double *freqs)
+{
+	bool iterate = false;
+	for (size_t i = 0; i < n_region; ++i) {
+		unsigned const idx = region[i];
+		freqs[idx] = 0.0;
+		iterate   |= irreducible[idx];
+	}
+	freqs[region[0]] = 1.0;
+
+	for (unsigned iter = 0; iter < MAX_SEIDEL_ITERATIONS; ++iter) {
+		bool changed = false;
+		for (size_t i = 1; i < n_region; ++i) {
+			unsigned const idx = region[i];
+			double         sum = 0.0;
+			for (unsigned e = cfg->pred_begin[idx];
+			     e < cfg->pred_begin[idx+1]; ++e) {
+				unsigned const pred_idx = cfg->pred_idx[e];
+				if (!is_retreating_edge(pred_idx, idx) || irreducible[idx])
+					sum += cfg->pred_prob[e] * freqs[pred_idx];
+			}
+			double const freq = sum / (1.0 - cyclic_prob[idx]);
+			if (fabs(freq - freqs[idx]) > SEIDEL_TOLERANCE * freq)
+				changed = true;
+			freqs[idx] = freq;
+		}
+		if (!iterate || !changed)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Solves the frequencies loop by loop, starting with the innermost loops.
+ * Each loop is solved relative to its header and then summarized as the
+ * probability that the header is entered again over its back edges.
+ * @returns false if the frequencies could not be determined
+ */
+static bool solve_freqs(const freq_cfg_t *cfg, double *freqs)
+{
+	unsigned const n_blocks = cfg->n_blocks;
+	/* probability to come back to a loop header when it is entered */
+	double   *const cyclic_prob = XMALLOCNZ(double, n_blocks);
+	/* headers whose retreating edges do not form a natural loop */
+	bool     *const irreducible = XMALLOCNZ(bool, n_blocks);
+	unsigned *const mark        = XMALLOCNZ(unsigned, n_blocks);
+	unsigned       *body        = NEW_ARR_F(unsigned, 0);
+	bool            valid       = true;
+
+	/* handle inner loops first: they come later in reverse postorder */
+	for (unsigned header = n_blocks; header-- > 0; ) {
+		if (header == cfg->end_idx)
+			continue;
+		bool is_header = false;
+		for (unsigned e = cfg->pred_begin[header];
+		     e < cfg->pred_begin[header+1]; ++e) {
+			if (is_retreating_edge(cfg->pred_idx[e], header))
+				is_header = true;
+		}
+		if (!is_header)
+			continue;
+		/* an irreducible loop is solved together with the enclosing loop */
+		if (!collect_loop_body(cfg, header, mark, &body)) {
+			irreducible[header] = true;
+			continue;
+		}
+
+		/* frequencies inside the loop relative to the header */
+		if (!propagate_freqs(cfg, cyclic_prob, irreducible, body,
+		                     ARR_LEN(body), freqs)) {
+			valid = false;
+			goto out;
+		}
+		double back_freq = 0.0;
+		for (unsigned e = cfg->pred_begin[header];
+		     e < cfg->pred_begin[header+1]; ++e) {
+			unsigned const pred_idx = cfg->pred_idx[e];
+			if (is_retreating_edge(pred_idx, header))
+				back_freq += cfg->pred_prob[e] * freqs[pred_idx];
+		}
+		cyclic_prob[header] = back_freq;
+	}
+
+	/* the whole graph relative to the start block */
+	ARR_RESIZE(unsigned, body, 0);
+	ARR_APP1(unsigned, body, cfg->start_idx);
+	for (unsigned idx = 0; idx < n_blocks; ++idx) {
+		if (idx != cfg->start_idx && idx != cfg->end_idx)
+			ARR_APP1(unsigned, body, idx);
+	}
+	if (!propagate_freqs(cfg, cyclic_prob, irreducible, body, ARR_LEN(body),
+	                     freqs)) {
+		valid = false;
+		goto out;
+	}
+	/* the end block is last as kept blocks may come after it */
+	double const end_freq = get_in_freq(cfg, freqs, cfg->end_idx);
+	freqs[cfg->end_idx] = end_freq;
+
+	/* like the artificial keep edges, the frequencies are relative to one
+	 * execution of the end block */
+	if (end_freq > 0.0) {
+		for (unsigned idx = 0; idx < n_blocks; ++idx)
+			freqs[idx] /= end_freq;
+	}
+
+out:
+	DEL_ARR_F(body);
+	free(mark);
+	free(irreducible);
+	free(cyclic_prob);
+	return valid;
 }
 
 void ir_estimate_execfreq(ir_graph *irg)
@@ -404,24 +529,10 @@ void ir_estimate_execfreq(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE);
 
 	/* compute a DFS.
-	 * using a toposort on the CFG (without back edges) will propagate
-	 * the values better for the gauss/seidel iteration.
-	 * => they can "flow" from start to end. */
+	 * using a toposort on the CFG (without back edges) lets the frequencies
+	 * "flow" from start to end. */
 	dfs_t *const dfs = dfs_new(irg);
 
-	unsigned       size   = dfs_get_n_nodes(dfs);
-	square_matrix *in_fac = mat_create(size);
-	for (unsigned r = 0; r < size; r++) {
-		for (unsigned c = 0; c < size; c++) {
-			setm(in_fac, r, c, 0.0);
-		}
-	}
-
-
-	ir_node *const start_block = get_irg_start_block(irg);
-	ir_node *const end_block   = get_irg_end_block(irg);
-	const int      end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
-
 	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED
 	                          | IR_RESOURCE_IRN_VISITED
 	                          | IR_RESOURCE_IRN_LINK);
@@ -430,7 +541,7 @@ void ir_estimate_execfreq(ir_graph *irg)
 	/* mark all blocks reachable from end_block as (block)visited
 	 * (so we can detect places like endless-loops/noreturn calls which
 	 *  do not reach the End block) */
-	block_walk_no_keeps(end_block);
+	block_walk_no_keeps(get_irg_end_block(irg));
 	/* mark all kept blocks as (node)visited */
 	inc_irg_visited(irg);
 	const ir_node *end          = get_irg_end(irg);
@@ -443,155 +554,36 @@ void ir_estimate_execfreq(ir_graph *irg)
 	}
 
 	double const inv_loop_weight = 1.0 / loop_weight;
-	/* lgs_to_mat[i] is the index of the block represented by the
-	 * i-th row/column in the LGS matrix. */
-	int *lgs_to_mat = NEW_ARR_F(int, 0);
-
-	for (unsigned idx = 0; idx < size; ++idx) {
-		ir_node const *const bb = dfs_get_post_num_node(dfs, size-idx-1);
-		/* The end block is handled properly later, when all the kept blocks
-		 * are done. */
-		if (bb == end_block)
-			continue;
-
-		for (int i = get_Block_n_cfgpreds(bb) - 1; i >= 0; --i) {
-			ir_node *const pred           = get_Block_cfgpred_block(bb, i);
-			unsigned const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
-			double   const cf_probability = get_cf_probability(bb, i, inv_loop_weight);
-			bool     const pred_visited   = pred_idx < idx;
-
-			if (pred_visited) {
-				add_weighted(in_fac, idx, pred_idx, cf_probability);
-			} else {
-				ARR_APP1(int, lgs_to_mat, pred_idx);
-				setm(in_fac, idx, pred_idx, cf_probability);
-			}
-		}
-
-		if (bb == start_block)
-			setm(in_fac, idx, end_idx, 1.0);
-	}
-
-	/* handle end block */
-	ARR_APP1(int, lgs_to_mat, end_idx);
-	for (int i = get_Block_n_cfgpreds(end_block) - 1; i >= 0; --i) {
-		ir_node *const pred           = get_Block_cfgpred_block(end_block, i);
-		int      const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
-		double   const cf_probability = get_cf_probability(end_block, i, inv_loop_weight);
-		add_weighted(in_fac, end_idx, pred_idx, cf_probability);
-	}
+	freq_cfg_t   cfg;
+	build_freq_cfg(&cfg, irg, dfs, inv_loop_weight);
 
-	/* add artifical edges from "kept blocks without a path to end"
-	 * to end */
-	for (unsigned k = n_keepalives; k-- > 0; ) {
-		ir_node *keep = get_End_keepalive(end, k);
-		if (!is_Block(keep) || has_path_to_end(keep))
-			continue;
+	unsigned const size       = cfg.n_blocks;
+	double  *const freqs      = XMALLOCN(double, size);
+	bool           valid_freq = solve_freqs(&cfg, freqs);
 
-		double sum      = get_sum_succ_factors(keep, inv_loop_weight);
-		double fac      = KEEP_FAC/sum;
-		int    keep_idx = size - dfs_get_post_num(dfs, keep)-1;
-		add_weighted(in_fac, end_idx, keep_idx, fac);
-	}
-
-	/* mat_to_lgs[i] is the index of node i in the LGS matrix, or
-	 * -1 if the node can be solved by simple substitution. */
-	int *mat_to_lgs = NEW_ARR_F(int, size);
-	for (unsigned x = 0; x < size; x++) {
-		mat_to_lgs[x] = -1;
-	}
-	for (unsigned b = 0; b < ARR_LEN(lgs_to_mat); b++) {
-		mat_to_lgs[lgs_to_mat[b]] = b;
-	}
-
-#ifdef DEBUG
-	/* Check that all values in in_fac are only given in terms of nodes with backedges */
-	for (int y = 0; y < size; y++) {
-		if (mat_to_lgs[y] == -1)
-			continue;
-		for (int x = 0; x < size; x++) {
-			if (getm(in_fac, x, y) != 0)
-				panic("expect entry at (%d, %d) to be 0", x, y);
-		}
-	}
-#endif
-
-	/* Build the LGS matrix with only the indices in lgs_to_mat. */
-	unsigned lgs_size = ARR_LEN(lgs_to_mat);
-	square_matrix *lgs_matrix = mat_create(lgs_size);
-	double *lgs_x = NEW_ARR_F(double, size);
-
-	for (unsigned x = 0; x < lgs_size; x++) {
-		int bx = lgs_to_mat[x];
-		for (unsigned y = 0; y < lgs_size; y++) {
-			int by = lgs_to_mat[y];
-			double val = getm(in_fac, bx, by);
-			setm(lgs_matrix, x, y, val);
-		}
-		/* RHS of the equation */
-		double val = getm(lgs_matrix, x, x);
-		val -= 1.0;
-		setm(lgs_matrix, x, x, val);
-	}
-
-	if (lgs_size == 1) {
-		lgs_x[0] = 1.0;
-	} else {
-		nullspace(lgs_matrix, lgs_x);
-	}
-
-	/* compute the normalization factor.
-	 * 1.0 / exec freq of end block.
-	 */
-	double  end_freq   = lgs_x[mat_to_lgs[end_idx]];
-	double  norm       = end_freq != 0.0 ? 1.0 / end_freq : 1.0;
-	double *freqs      = NEW_ARR_F(double, size);
-	bool    valid_freq = true;
-
-	/* First get the frequency for the nodes which were
-	 * explicitly computed. */
-	for (unsigned idx = size; idx-- > 0; ) {
-		ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
-
-		if (mat_to_lgs[idx] != -1) {
-			double freq = lgs_x[mat_to_lgs[idx]] * norm;
+	if (valid_freq) {
+		for (unsigned idx = 0; idx < size; ++idx) {
+			double const freq = freqs[idx];
 			/* Check for inf, nan and negative values. */
 			if (isinf(freq) || !(freq >= 0)) {
 				valid_freq = false;
 				break;
 			}
-			set_block_execfreq(bb, freq);
-			freqs[idx] = freq;
-		} else {
-			freqs[idx] = nan("");
 		}
 	}
-
 	if (valid_freq) {
-		/* Now get the rest of the frequencies using the factors in in_fac */
-		for (unsigned idx = size; idx-- > 0; ) {
-			ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
-
-			if (mat_to_lgs[idx] == -1) {
-				double freq = mat_dot_vec_entry(in_fac, freqs, idx);
-				/* Check for inf, nan and negative values. */
-				if (isinf(freq) || !(freq >= 0)) {
-					valid_freq = false;
-					break;
-				}
-				set_block_execfreq(bb, freq);
-			}
-		}
+		for (unsigned idx = 0; idx < size; ++idx)
+			set_block_execfreq(cfg.blocks[idx], freqs[idx]);
 	}
 
-	DEL_ARR_F(freqs);
+	free(freqs);
 
 	/* Fallback solution: Use loop weight. */
 	if (!valid_freq) {
 		valid_freq = true;
 
-		for (int idx = size; idx-- > 0; ) {
-			ir_node       *bb    = dfs_get_post_num_node(dfs, size - idx - 1);
+		for (unsigned idx = size; idx-- > 0; ) {
+			ir_node       *bb    = cfg.blocks[idx];
 			const ir_loop *loop  = get_irn_loop(bb);
 			const int      depth = get_loop_depth(loop);
 			double         freq  = 1.0;
@@ -611,9 +603,8 @@ void ir_estimate_execfreq(ir_graph *irg)
 
 	/* Fallback solution: All blocks have the same execution frequency. */
 	if (!valid_freq) {
-		for (int idx = size; idx-- > 0; ) {
-			ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
-			set_block_execfreq(bb, 1.0);
+		for (unsigned idx = size; idx-- > 0; ) {
+			set_block_execfreq(cfg.blocks[idx], 1.0);
 		}
 	}
 
@@ -621,10 +612,6 @@ void ir_estimate_execfreq(ir_graph *irg)
 	                       | IR_RESOURCE_IRN_VISITED
 	                       | IR_RESOURCE_IRN_LINK);
 
+	free_freq_cfg(&cfg);
 	dfs_free(dfs);
-	DEL_ARR_F(lgs_to_mat);
-	DEL_ARR_F(mat_to_lgs);
-	free(in_fac);
-	free(lgs_matrix);
-	DEL_ARR_F(lgs_x);
 }
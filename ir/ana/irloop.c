@@ -79,7 +79,11 @@ loop_element get_loop_element(const ir_loop *loop, size_t pos)
 
 void set_irn_loop(ir_node *n, ir_loop *loop)
 {
-	n->loop = loop;
+	if (is_Block(n)) {
+		n->attr.block.loop = loop;
+	} else {
+		assert(loop == NULL);
+	}
 }
 
 ir_loop *(get_irn_loop)(const ir_node *n)
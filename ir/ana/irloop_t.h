@@ -104,10 +104,11 @@ static inline unsigned _get_loop_depth(const ir_loop *loop)
 	return loop->depth;
 }
 
-/* Uses temporary information to get the loop */
+/* Uses temporary information to get the loop, only blocks are part of the
+ * loop tree */
 static inline ir_loop *_get_irn_loop(const ir_node *n)
 {
-	return n->loop;
+	return is_Block(n) ? n->attr.block.loop : NULL;
 }
 
 #endif
@@ -9,6 +9,8 @@
  * @author   Goetz Lindenmaier, Michael Beck
  * @date     1.2002
  */
+#include <string.h>
+
 #include "xmalloc.h"
 #include "irouts_t.h"
 #include "irnode_t.h"
@@ -19,20 +21,34 @@
 
 unsigned get_irn_n_outs(const ir_node *node)
 {
-	return node->o.out->n_edges;
+	return get_irn_outs(node)->n_edges;
 }
 
 ir_node *get_irn_out(const ir_node *def, unsigned pos)
 {
 	assert(pos < get_irn_n_outs(def));
-	return def->o.out->edges[pos].use;
+	return get_irn_outs(def)->edges[pos].use;
 }
 
 ir_node *get_irn_out_ex(const ir_node *def, unsigned pos, int *in_pos)
 {
 	assert(pos < get_irn_n_outs(def));
-	*in_pos = def->o.out->edges[pos].pos;
-	return def->o.out->edges[pos].use;
+	ir_def_use_edge const *const edge = &get_irn_outs(def)->edges[pos];
+	*in_pos = edge->pos;
+	return edge->use;
+}
+
+void set_irn_outs(ir_node *node, ir_def_use_edges *outs)
+{
+	ir_graph *const irg = get_irn_irg(node);
+	unsigned  const idx = get_irn_idx(node);
+	assert(irg->outs != NULL);
+	size_t const len = ARR_LEN(irg->outs);
+	if (idx >= len) {
+		ARR_RESIZE(ir_def_use_edges*, irg->outs, idx + 1);
+		memset(&irg->outs[len], 0, (idx + 1 - len) * sizeof(*irg->outs));
+	}
+	irg->outs[idx] = outs;
 }
 
 unsigned get_Block_n_cfg_outs(const ir_node *bl)
@@ -210,62 +226,54 @@ void irg_out_block_walk(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
 /*--------------------------------------------------------------------*/
 /** Building and Removing the out datastructure                      **/
 /**                                                                  **/
-/** The outs of a graph are allocated in a single, large array.      **/
-/** This allows to allocate and deallocate the memory for the outs   **/
-/** on demand.  The large array is separated into many small ones    **/
-/** for each node.  Only a single field to reference the out array   **/
-/** is stored in each node and a field referencing the large out     **/
-/** array in irgraph.  The 0 field of each out array contains the    **/
-/** size of this array.  This saves memory in the irnodes themselves.**/
+/** The out arrays of a graph are allocated on an obstack of the     **/
+/** graph.  This allows to allocate and deallocate the memory for    **/
+/** the outs on demand.  The nodes do not reference their out array, **/
+/** the graph has a table of the out arrays indexed by node index.   **/
+/** This saves memory in the irnodes themselves.                     **/
 /** The construction does two passes over the graph.  The first pass **/
-/** counts the overall number of outs and the outs of each node.  It **/
-/** stores the outs of each node in the out reference of the node.   **/
-/** Then the large array is allocated.  The second iteration chops   **/
-/** the large array into smaller parts, sets the out edges and       **/
-/** recounts the out edges.                                          **/
+/** counts the outs of each node.  The second pass allocates the out **/
+/** arrays, sets the out edges and recounts the out edges.           **/
 /*--------------------------------------------------------------------*/
 
 
-/** Returns the amount of out edges for not yet visited successors. */
-static void count_outs_node(ir_node *n)
+/** Counts the out edges of not yet visited nodes in @p n_outs. */
+static void count_outs_node(ir_node *n, unsigned *n_outs)
 {
 	if (irn_visited_else_mark(n))
 		return;
 
-	/* initialize our counter */
-	n->o.n_outs = 0;
-
 	int start = is_Block(n) ? 0 : -1;
 	for (int i = start, irn_arity = get_irn_arity(n); i < irn_arity; ++i) {
 		ir_node *def = get_irn_n(n, i);
-		count_outs_node(def);
-		++def->o.n_outs;
+		count_outs_node(def, n_outs);
+		++n_outs[get_irn_idx(def)];
 	}
 }
 
-
-/** Returns the amount of out edges for not yet visited successors.
+/** Counts the out edges of all nodes of a graph.
  *  This version handles some special nodes like irg_frame, irg_args etc. */
-static void count_outs(ir_graph *irg)
+static unsigned *count_outs(ir_graph *irg)
 {
+	unsigned *const n_outs = XMALLOCNZ(unsigned, get_irg_last_idx(irg));
 	inc_irg_visited(irg);
-	count_outs_node(get_irg_end(irg));
-	foreach_irn_in(get_irg_anchor(irg), i, n) {
-		if (irn_visited_else_mark(n))
-			continue;
-		n->o.n_outs = 0;
-	}
+	count_outs_node(get_irg_end(irg), n_outs);
+	return n_outs;
 }
 
-static void set_out_edges_node(ir_node *node, struct obstack *obst)
+static void set_out_edges_node(ir_node *node, struct obstack *obst,
+                               unsigned const *n_outs)
 {
 	if (irn_visited_else_mark(node))
 		return;
 
 	/* Allocate my array */
-	unsigned n_outs = node->o.n_outs;
-	node->o.out          = OALLOCF(obst, ir_def_use_edges, edges, n_outs);
-	node->o.out->n_edges = 0;
+	ir_graph         *const irg  = get_irn_irg(node);
+	unsigned          const idx  = get_irn_idx(node);
+	ir_def_use_edges *const outs = OALLOCF(obst, ir_def_use_edges, edges,
+	                                       n_outs[idx]);
+	outs->n_edges  = 0;
+	irg->outs[idx] = outs;
 
 	/* add def->use edges from my predecessors to me */
 	int start = is_Block(node) ? 0 : -1;
@@ -273,28 +281,31 @@ static void set_out_edges_node(ir_node *node, struct obstack *obst)
 		ir_node *def = get_irn_n(node, i);
 
 		/* recurse, ensures that out array of pred is already allocated */
-		set_out_edges_node(def, obst);
+		set_out_edges_node(def, obst, n_outs);
 
 		/* Remember this Def-Use edge */
-		unsigned pos = def->o.out->n_edges++;
-		def->o.out->edges[pos].use = node;
-		def->o.out->edges[pos].pos = i;
+		ir_def_use_edges *const def_outs = irg->outs[get_irn_idx(def)];
+		unsigned          const pos      = def_outs->n_edges++;
+		def_outs->edges[pos].use = node;
+		def_outs->edges[pos].pos = i;
 	}
 }
 
-static void set_out_edges(ir_graph *irg)
+static void set_out_edges(ir_graph *irg, unsigned const *n_outs)
 {
 	struct obstack *obst = &irg->out_obst;
 	obstack_init(obst);
 	irg->out_obst_allocated = true;
+	irg->outs = NEW_ARR_FZ(ir_def_use_edges*, get_irg_last_idx(irg));
 
 	inc_irg_visited(irg);
-	set_out_edges_node(get_irg_end(irg), obst);
+	set_out_edges_node(get_irg_end(irg), obst, n_outs);
 	foreach_irn_in(get_irg_anchor(irg), i, n) {
 		if (irn_visited_else_mark(n))
 			continue;
-		n->o.out          = OALLOCF(obst, ir_def_use_edges, edges, 0);
-		n->o.out->n_edges = 0;
+		ir_def_use_edges *const outs = OALLOCF(obst, ir_def_use_edges, edges, 0);
+		outs->n_edges = 0;
+		irg->outs[get_irn_idx(n)] = outs;
 	}
 }
 
@@ -302,13 +313,13 @@ void compute_irg_outs(ir_graph *irg)
 {
 	free_irg_outs(irg);
 
-	/* This first iteration counts the overall number of out edges and the
-	   number of out edges for each node. */
-	count_outs(irg);
+	/* This first iteration counts the number of out edges for each node. */
+	unsigned *const n_outs = count_outs(irg);
 
-	/* The second iteration splits the irg->outs array into smaller arrays
-	   for each node and writes the back edges into this array. */
-	set_out_edges(irg);
+	/* The second iteration allocates the out arrays of the nodes and writes
+	   the back edges into them. */
+	set_out_edges(irg, n_outs);
+	free(n_outs);
 
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 }
@@ -319,25 +330,14 @@ void assure_irg_outs(ir_graph *irg)
 		compute_irg_outs(irg);
 }
 
-#ifdef DEBUG_libfirm
-/** Clear the outs of a node */
-static void reset_outs(ir_node *node, void *unused)
-{
-	(void)unused;
-	node->o.out = NULL;
-}
-#endif
-
 void free_irg_outs(ir_graph *irg)
 {
 	if (irg->out_obst_allocated) {
 		obstack_free(&irg->out_obst, NULL);
 		irg->out_obst_allocated = false;
 	}
-
-#ifdef DEBUG_libfirm
-	/* when debugging, *always* reset all nodes' outs!  irg->outs might
-	   have been lying to us */
-	irg_walk_graph(irg, reset_outs, NULL, NULL);
-#endif
+	if (irg->outs != NULL) {
+		DEL_ARR_F(irg->outs);
+		irg->outs = NULL;
+	}
 }
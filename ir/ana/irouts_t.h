@@ -6,6 +6,9 @@
 #ifndef FIRM_ANA_IROUTS_T_H
 #define FIRM_ANA_IROUTS_T_H
 
+#include "array.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
 #include "irouts.h"
 
 #define foreach_irn_out(irn, idx, succ) \
@@ -20,4 +23,19 @@
 			for (unsigned idx = get_irn_n_outs(succ##__irn); succ##__b && idx-- != 0;) \
 				for (ir_node *const succ = (succ##__b = false, get_irn_out(succ##__irn, idx)); !succ##__b; succ##__b = true)
 
+/**
+ * Returns the def-use edges of a node.
+ */
+static inline ir_def_use_edges *get_irn_outs(const ir_node *node)
+{
+	ir_graph const *const irg = get_irn_irg(node);
+	assert(irg->outs != NULL && get_irn_idx(node) < ARR_LEN(irg->outs));
+	return irg->outs[get_irn_idx(node)];
+}
+
+/**
+ * Sets the def-use edges of a node.
+ */
+void set_irn_outs(ir_node *node, ir_def_use_edges *outs);
+
 #endif
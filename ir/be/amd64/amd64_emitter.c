@@ -7,14 +7,16 @@
  * @file
  * @brief   emit assembler for a backend graph
  */
-#include <inttypes.h>
+#include <stdlib.h>
 
 #include "amd64_emitter.h"
+#include "amd64_encode.h"
 #include "amd64_new_nodes.h"
 #include "amd64_nodes_attr.h"
 #include "be_t.h"
 #include "beasm.h"
 #include "beblocksched.h"
+#include "beemitter_binary.h"
 #include "bediagnostic.h"
 #include "begnuas.h"
 #include "beirg.h"
@@ -25,6 +27,8 @@
 #include "iredges_t.h"
 #include "irgwalk.h"
 #include "panic.h"
+#include "pmap.h"
+#include "util.h"
 
 static be_stack_layout_t *layout;
 
@@ -227,12 +231,15 @@ static void amd64_emit_immediate64(const amd64_imm64_t *const imm)
 {
 	if (imm->kind == X86_IMM_VALUE) {
 		assert(imm->entity == NULL);
-		be_emit_irprintf("0x%" PRIX64, imm->offset);
+		be_emit_cstring("0x");
+		be_emit_hex(imm->offset);
 		return;
 	}
 	emit_relocation_no_offset(imm->kind, imm->entity);
+	if (imm->offset > 0)
+		be_emit_char('+');
 	if (imm->offset != 0)
-		be_emit_irprintf("%+" PRId64, imm->offset);
+		be_emit_int(imm->offset);
 }
 
 static void amd64_emit_immediate32(bool const prefix,
@@ -242,12 +249,14 @@ static void amd64_emit_immediate32(bool const prefix,
 		be_emit_char('$');
 	if (imm->kind == X86_IMM_VALUE) {
 		assert(imm->entity == NULL);
-		be_emit_irprintf("%" PRId32, imm->offset);
+		be_emit_int(imm->offset);
 		return;
 	}
 	emit_relocation_no_offset(imm->kind, imm->entity);
+	if (imm->offset > 0)
+		be_emit_char('+');
 	if (imm->offset != 0)
-		be_emit_irprintf("%+" PRId32, imm->offset);
+		be_emit_int(imm->offset);
 }
 
 #ifndef NDEBUG
@@ -270,11 +279,13 @@ static void amd64_emit_addr(const ir_node *const node,
 		assert(addr->immediate.kind != X86_IMM_VALUE);
 		assert(!is_fp_relative(entity));
 		emit_relocation_no_offset(addr->immediate.kind, entity);
+		if (offset > 0)
+			be_emit_char('+');
 		if (offset != 0)
-			be_emit_irprintf("%+" PRId32, offset);
+			be_emit_int(offset);
 	} else if (offset != 0 || variant == X86_ADDR_JUST_IMM) {
 		assert(addr->immediate.kind == X86_IMM_VALUE);
-		be_emit_irprintf("%" PRId32, offset);
+		be_emit_int(offset);
 	}
 
 	if (variant != X86_ADDR_JUST_IMM) {
@@ -296,8 +307,10 @@ static void amd64_emit_addr(const ir_node *const node,
 				emit_register(reg);
 
 				unsigned scale = addr->log_scale;
-				if (scale > 0)
-					be_emit_irprintf(",%u", 1 << scale);
+				if (scale > 0) {
+					be_emit_char(',');
+					be_emit_uint(1 << scale);
+				}
 			}
 		}
 		be_emit_char(')');
@@ -383,7 +396,9 @@ static void emit_shiftop(const ir_node *const node)
 
 	switch (attr->base.op_mode) {
 	case AMD64_OP_SHIFT_IMM: {
-		be_emit_irprintf("$0x%X, ", attr->immediate);
+		be_emit_cstring("$0x");
+		be_emit_hex(attr->immediate);
+		be_emit_cstring(", ");
 		const arch_register_t *reg = arch_get_irn_register_in(node, 0);
 		emit_register_mode(reg, attr->insn_mode);
 		return;
@@ -617,7 +632,7 @@ emit_R:
 
 			case 'd': {
 				int const num = va_arg(ap, int);
-				be_emit_irprintf("%d", num);
+				be_emit_int(num);
 				break;
 			}
 
@@ -629,7 +644,7 @@ emit_R:
 
 			case 'u': {
 				unsigned const num = va_arg(ap, unsigned);
-				be_emit_irprintf("%u", num);
+				be_emit_uint(num);
 				break;
 			}
 
@@ -724,7 +739,9 @@ static void emit_amd64_asm_operand(ir_node const *const node, char const modifie
 
 	case ASM_OP_MEMORY: {
 		arch_register_t const *const reg = arch_get_irn_register_in(node, op->inout_pos);
-		be_emit_irprintf("(%%%s)", reg->name);
+		be_emit_cstring("(%");
+		be_emit_string(reg->name);
+		be_emit_char(')');
 		return;
 	}
 
@@ -977,33 +994,47 @@ static void amd64_gen_labels(ir_node *block, void *env)
 	}
 }
 
-void amd64_emit_function(ir_graph *irg)
+/**
+ * Links control flow nodes to their target blocks and blocks to their
+ * successor in the block schedule.
+ */
+static void amd64_link_blocks(ir_graph *irg, ir_node **blk_sched)
 {
-	ir_entity *entity = get_irg_entity(irg);
-	ir_node  **blk_sched;
-	size_t i, n;
-
-	layout = be_get_irg_stack_layout(irg);
-
-	/* register all emitter functions */
-	amd64_register_emitters();
-
-	blk_sched = be_create_block_schedule(irg);
-
-	be_gas_emit_function_prolog(entity, 4, NULL);
-
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 	irg_block_walk_graph(irg, amd64_gen_labels, NULL, NULL);
 
-	n = ARR_LEN(blk_sched);
-	for (i = 0; i < n; i++) {
+	size_t n = ARR_LEN(blk_sched);
+	for (size_t i = 0; i < n; i++) {
 		ir_node *block = blk_sched[i];
 		ir_node *next  = (i + 1) < n ? blk_sched[i+1] : NULL;
 
 		set_irn_link(block, next);
 	}
+}
+
+static void amd64_emit_function_text(ir_graph *irg, ir_node **blk_sched)
+{
+	ir_entity *entity = get_irg_entity(irg);
+
+	/* register all emitter functions */
+	amd64_register_emitters();
 
-	for (i = 0; i < n; ++i) {
+	be_gas_emit_function_prolog(entity, 4, NULL);
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	amd64_link_blocks(irg, blk_sched);
+
+	/* cold blocks go to a separate section, so the last hot block must not
+	 * fall through */
+	size_t const n     = ARR_LEN(blk_sched);
+	size_t const n_hot = be_get_n_hot_blocks(blk_sched);
+	bool   const split = n_hot > 0 && n_hot < n
+	                  && be_gas_can_split_function(entity);
+	if (split)
+		set_irn_link(blk_sched[n_hot - 1], NULL);
+
+	for (size_t i = 0; i < n; ++i) {
+		if (split && i == n_hot)
+			be_gas_begin_cold_part(entity);
 		ir_node *block = blk_sched[i];
 		amd64_gen_block(block);
 	}
@@ -1011,3 +1042,1449 @@ void amd64_emit_function(ir_graph *irg)
 
 	be_gas_emit_function_epilog(entity);
 }
+
+/* ==== Binary emitter ==== */
+
+/** Jumps at the end of a code fragment. */
+enum amd64_jump_type_t {
+	AMD64_JUMP_NONE = 0,
+	AMD64_JUMP_JMP  = 1,
+	AMD64_JUMP_JCC  = 0x100, /**< the condition code is in the low bits */
+};
+
+#define JUMP_SHORT_SIZE 2
+#define JMP_NEAR_SIZE   5
+#define JCC_NEAR_SIZE   6
+
+static pmap     *block_fragments; /**< maps blocks to fragment numbers */
+static ir_node **switch_jmps;     /**< jmp_switch nodes of the function */
+
+static const be_elf_reloc_info_t amd64_relocs[AMD64_RELOC_LAST + 1] = {
+	[AMD64_RELOC_64]            = { 8, false, true  },
+	[AMD64_RELOC_PC32]          = { 4, true,  true  },
+	[AMD64_RELOC_PLT32]         = { 4, true,  true  },
+	[AMD64_RELOC_GOTPCREL]      = { 4, true,  false },
+	[AMD64_RELOC_32]            = { 4, false, true  },
+	[AMD64_RELOC_32S]           = { 4, false, true  },
+	[AMD64_RELOC_GOTPCRELX]     = { 4, true,  false },
+	[AMD64_RELOC_REX_GOTPCRELX] = { 4, true,  false },
+};
+
+const be_elf_target_t amd64_elf_target = {
+	.machine     = 62, /* EM_X86_64 */
+	.n_relocs    = ARRAY_SIZE(amd64_relocs),
+	.relocs      = amd64_relocs,
+	.reloc_abs32 = AMD64_RELOC_32,
+	.reloc_abs64 = AMD64_RELOC_64,
+};
+
+static bool is_int8(int64_t const value)
+{
+	return -128 <= value && value < 128;
+}
+
+static bool is_int32(int64_t const value)
+{
+	return INT32_MIN <= value && value <= INT32_MAX;
+}
+
+static unsigned get_in_encoding(ir_node const *const node, int const pos)
+{
+	return arch_get_irn_register_in(node, pos)->encoding;
+}
+
+static unsigned get_out_encoding(ir_node const *const node, unsigned const pos)
+{
+	return arch_get_irn_register_out(node, pos)->encoding;
+}
+
+static uint8_t get_segment_prefix(amd64_segment_selector_t const segment)
+{
+	switch (segment) {
+	case AMD64_SEGMENT_DEFAULT: return 0;
+	case AMD64_SEGMENT_CS:      return 0x2E;
+	case AMD64_SEGMENT_SS:      return 0x36;
+	case AMD64_SEGMENT_DS:      return 0x3E;
+	case AMD64_SEGMENT_ES:      return 0x26;
+	case AMD64_SEGMENT_FS:      return 0x64;
+	case AMD64_SEGMENT_GS:      return 0x65;
+	}
+	panic("invalid segment");
+}
+
+/** Returns the relocation for the displacement of an address. */
+static amd64_reloc_t get_addr_reloc(x86_imm32_t const *const imm)
+{
+	if (imm->entity == NULL) {
+		assert(imm->kind == X86_IMM_VALUE);
+		return AMD64_RELOC_NONE;
+	}
+	assert(!is_fp_relative(imm->entity));
+	switch (imm->kind) {
+	case X86_IMM_ADDR:     return AMD64_RELOC_32S;
+	case X86_IMM_PCREL:    return AMD64_RELOC_PC32;
+	case X86_IMM_GOTPCREL: return AMD64_RELOC_GOTPCREL;
+	case X86_IMM_VALUE:
+	case X86_IMM_TLS_IE:
+	case X86_IMM_TLS_LE:
+	case X86_IMM_PICBASE_REL:
+	case X86_IMM_FRAMEOFFSET:
+	case X86_IMM_GOT:
+	case X86_IMM_GOTOFF:
+	case X86_IMM_PLT:
+		break;
+	}
+	panic("unexpected or invalid immediate kind");
+}
+
+/** Returns the relocation for an immediate operand. */
+static amd64_reloc_t get_imm_reloc(x86_immediate_kind_t const kind,
+                                   ir_entity const *const entity,
+                                   amd64_insn_mode_t const insn_mode)
+{
+	if (entity == NULL) {
+		assert(kind == X86_IMM_VALUE);
+		return AMD64_RELOC_NONE;
+	}
+	if (kind == X86_IMM_ADDR) {
+		if (insn_mode == INSN_MODE_64)
+			return AMD64_RELOC_32S;
+		if (insn_mode == INSN_MODE_32)
+			return AMD64_RELOC_32;
+	}
+	panic("unexpected immediate kind for object file output");
+}
+
+static void bemit_insn(amd64_insn_t const *const insn)
+{
+	uint8_t       buffer[AMD64_MAX_INSN_SIZE];
+	amd64_fixup_t fixups[2];
+	unsigned      n_fixups;
+	unsigned const len = amd64_insn_encode(insn, buffer, fixups, &n_fixups);
+	for (unsigned i = 0; i < n_fixups; ++i) {
+		amd64_fixup_t const *const fixup = &fixups[i];
+		be_emit_reloc(fixup->offset, fixup->type, fixup->entity,
+		              fixup->addend);
+	}
+	obstack_grow(&code_fragment_obst, buffer, len);
+}
+
+/** Starts an instruction with the operand size prefixes of @p insn_mode. */
+static void bemit_init(amd64_insn_t *const insn,
+                       amd64_insn_mode_t const insn_mode)
+{
+	amd64_insn_init(insn);
+	if (insn_mode == INSN_MODE_16)
+		amd64_insn_prefix(insn, 0x66);
+	else if (insn_mode == INSN_MODE_64)
+		amd64_insn_rex_w(insn);
+}
+
+static void bemit_mod_addr(amd64_insn_t *const insn, ir_node const *const node,
+                           unsigned const reg, amd64_addr_t const *const addr)
+{
+	x86_addr_variant_t const variant = addr->variant;
+	assert(variant != X86_ADDR_INVALID);
+
+	amd64_enc_addr_t enc = {
+		.base      = AMD64_NO_REG,
+		.index     = AMD64_NO_REG,
+		.log_scale = addr->log_scale,
+		.segment   = get_segment_prefix(addr->segment),
+		.rip       = variant == X86_ADDR_RIP,
+		.disp      = addr->immediate.offset,
+		.entity    = addr->immediate.entity,
+		.reloc     = get_addr_reloc(&addr->immediate),
+	};
+	if (x86_addr_variant_has_base(variant))
+		enc.base = get_in_encoding(node, addr->base_input);
+	if (x86_addr_variant_has_index(variant))
+		enc.index = get_in_encoding(node, addr->index_input);
+	amd64_insn_modrm_mem(insn, reg, &enc);
+}
+
+/**
+ * Adds the operand which %AM prints for the op modes REG and ADDR as r/m
+ * operand.
+ */
+static void bemit_mod_am(amd64_insn_t *const insn, ir_node const *const node,
+                         unsigned const reg, bool const byte)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	switch ((amd64_op_mode_t)attr->base.op_mode) {
+	case AMD64_OP_REG: {
+		unsigned const rm = get_in_encoding(node, 0);
+		if (byte)
+			amd64_insn_byte_reg(insn, rm);
+		amd64_insn_modrm_reg(insn, reg, rm);
+		return;
+	}
+	case AMD64_OP_ADDR:
+	case AMD64_OP_X87_ADDR:
+	case AMD64_OP_X87_ADDR_REG:
+		bemit_mod_addr(insn, node, reg, &attr->addr);
+		return;
+	default:
+		break;
+	}
+	panic("invalid op_mode");
+}
+
+/**
+ * Sets opcode and immediate of an arithmetic instruction with an immediate
+ * operand.
+ *
+ * @return true if the short form for the accumulator was used, which has no
+ *         ModRM byte
+ */
+static bool bemit_alu_imm(amd64_insn_t *const insn, unsigned const code,
+                          amd64_insn_mode_t const insn_mode,
+                          x86_imm32_t const *const imm, bool const rax)
+{
+	amd64_reloc_t const reloc
+		= get_imm_reloc(imm->kind, imm->entity, insn_mode);
+	if (insn_mode == INSN_MODE_8) {
+		amd64_insn_imm(insn, 1, imm->offset, imm->entity, reloc);
+		amd64_insn_opcode(insn, rax ? code << 3 | 0x04 : 0x80);
+		return rax;
+	}
+	if (imm->entity == NULL && is_int8(imm->offset)) {
+		amd64_insn_imm(insn, 1, imm->offset, NULL, reloc);
+		amd64_insn_opcode(insn, 0x83);
+		return false;
+	}
+	unsigned const size = insn_mode == INSN_MODE_16 ? 2 : 4;
+	amd64_insn_imm(insn, size, imm->offset, imm->entity, reloc);
+	amd64_insn_opcode(insn, rax ? code << 3 | 0x05 : 0x81);
+	return rax;
+}
+
+static void bemit_binop_mode(ir_node const *const node, unsigned const code,
+                             amd64_insn_mode_t const insn_mode)
+{
+	amd64_binop_addr_attr_t const *const attr
+		= get_amd64_binop_addr_attr_const(node);
+	bool    const byte = insn_mode == INSN_MODE_8;
+	uint8_t const w    = !byte;
+
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	switch ((amd64_op_mode_t)attr->base.base.op_mode) {
+	case AMD64_OP_REG_IMM: {
+		unsigned const reg = get_in_encoding(node, 0);
+		if (byte)
+			amd64_insn_byte_reg(&insn, reg);
+		if (!bemit_alu_imm(&insn, code, insn_mode, &attr->u.immediate,
+		                   reg == 0))
+			amd64_insn_modrm_reg(&insn, code, reg);
+		break;
+	}
+	case AMD64_OP_REG_REG: {
+		unsigned const reg0 = get_in_encoding(node, 0);
+		unsigned const reg1 = get_in_encoding(node, 1);
+		if (byte) {
+			amd64_insn_byte_reg(&insn, reg0);
+			amd64_insn_byte_reg(&insn, reg1);
+		}
+		amd64_insn_opcode(&insn, code << 3 | w);
+		amd64_insn_modrm_reg(&insn, reg1, reg0);
+		break;
+	}
+	case AMD64_OP_REG_ADDR: {
+		unsigned const reg = get_in_encoding(node, attr->u.reg_input);
+		if (byte)
+			amd64_insn_byte_reg(&insn, reg);
+		amd64_insn_opcode(&insn, code << 3 | 0x02 | w);
+		bemit_mod_addr(&insn, node, reg, &attr->base.addr);
+		break;
+	}
+	case AMD64_OP_ADDR_IMM:
+		bemit_alu_imm(&insn, code, insn_mode, &attr->u.immediate, false);
+		bemit_mod_addr(&insn, node, code, &attr->base.addr);
+		break;
+	case AMD64_OP_ADDR_REG: {
+		unsigned const reg = get_in_encoding(node, attr->u.reg_input);
+		if (byte)
+			amd64_insn_byte_reg(&insn, reg);
+		amd64_insn_opcode(&insn, code << 3 | w);
+		bemit_mod_addr(&insn, node, reg, &attr->base.addr);
+		break;
+	}
+	default:
+		panic("invalid op_mode for binop %+F", node);
+	}
+	bemit_insn(&insn);
+}
+
+static void bemit_binop(ir_node const *const node, unsigned const code)
+{
+	amd64_insn_mode_t const insn_mode = get_amd64_insn_mode(node);
+	bemit_binop_mode(node, code, insn_mode);
+}
+
+static void bemit_add(const ir_node *node) { bemit_binop(node, 0); }
+static void bemit_or (const ir_node *node) { bemit_binop(node, 1); }
+static void bemit_sbb(const ir_node *node) { bemit_binop(node, 3); }
+static void bemit_and(const ir_node *node) { bemit_binop(node, 4); }
+static void bemit_sub(const ir_node *node) { bemit_binop(node, 5); }
+static void bemit_xor(const ir_node *node) { bemit_binop(node, 6); }
+static void bemit_cmp(const ir_node *node) { bemit_binop(node, 7); }
+
+static void bemit_sub_sp(const ir_node *node)
+{
+	bemit_binop_mode(node, 5, INSN_MODE_64);
+	/* movq %rsp, %D1 */
+	amd64_insn_t insn;
+	bemit_init(&insn, INSN_MODE_64);
+	amd64_insn_opcode(&insn, 0x89);
+	amd64_insn_modrm_reg(&insn, amd64_registers[REG_RSP].encoding,
+	                     get_out_encoding(node, 1));
+	bemit_insn(&insn);
+}
+
+static void bemit_imul(const ir_node *node)
+{
+	amd64_binop_addr_attr_t const *const attr
+		= get_amd64_binop_addr_attr_const(node);
+	amd64_insn_mode_t const insn_mode = attr->base.insn_mode;
+	assert(insn_mode != INSN_MODE_8);
+
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	switch ((amd64_op_mode_t)attr->base.base.op_mode) {
+	case AMD64_OP_REG_IMM: {
+		x86_imm32_t const *const imm = &attr->u.immediate;
+		amd64_reloc_t const reloc
+			= get_imm_reloc(imm->kind, imm->entity, insn_mode);
+		if (imm->entity == NULL && is_int8(imm->offset)) {
+			amd64_insn_opcode(&insn, 0x6B);
+			amd64_insn_imm(&insn, 1, imm->offset, NULL, reloc);
+		} else {
+			unsigned const size = insn_mode == INSN_MODE_16 ? 2 : 4;
+			amd64_insn_opcode(&insn, 0x69);
+			amd64_insn_imm(&insn, size, imm->offset, imm->entity, reloc);
+		}
+		unsigned const reg = get_in_encoding(node, 0);
+		amd64_insn_modrm_reg(&insn, reg, reg);
+		break;
+	}
+	case AMD64_OP_REG_REG:
+		amd64_insn_opcode(&insn, 0x0F);
+		amd64_insn_opcode(&insn, 0xAF);
+		amd64_insn_modrm_reg(&insn, get_in_encoding(node, 0),
+		                     get_in_encoding(node, 1));
+		break;
+	case AMD64_OP_REG_ADDR:
+		amd64_insn_opcode(&insn, 0x0F);
+		amd64_insn_opcode(&insn, 0xAF);
+		bemit_mod_addr(&insn, node, get_in_encoding(node, attr->u.reg_input),
+		               &attr->base.addr);
+		break;
+	default:
+		panic("invalid op_mode for imul %+F", node);
+	}
+	bemit_insn(&insn);
+}
+
+/** Emits an instruction of the group F6/F7 with the operand %AM. */
+static void bemit_unop(ir_node const *const node, unsigned const code)
+{
+	amd64_insn_mode_t const insn_mode = get_amd64_insn_mode(node);
+	bool              const byte      = insn_mode == INSN_MODE_8;
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	amd64_insn_opcode(&insn, byte ? 0xF6 : 0xF7);
+	bemit_mod_am(&insn, node, code, byte);
+	bemit_insn(&insn);
+}
+
+static void bemit_not     (const ir_node *node) { bemit_unop(node, 2); }
+static void bemit_neg     (const ir_node *node) { bemit_unop(node, 3); }
+static void bemit_mul     (const ir_node *node) { bemit_unop(node, 4); }
+static void bemit_imul_1op(const ir_node *node) { bemit_unop(node, 5); }
+static void bemit_div     (const ir_node *node) { bemit_unop(node, 6); }
+static void bemit_idiv    (const ir_node *node) { bemit_unop(node, 7); }
+
+/** Emits an instruction "op %AM, %D0" with a gp result. */
+static void bemit_0f_load(ir_node const *const node, uint8_t const opcode,
+                          amd64_insn_mode_t const insn_mode)
+{
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, opcode);
+	bemit_mod_am(&insn, node, get_out_encoding(node, 0), false);
+	bemit_insn(&insn);
+}
+
+static void bemit_bsf(const ir_node *node)
+{
+	bemit_0f_load(node, 0xBC, get_amd64_insn_mode(node));
+}
+
+static void bemit_bsr(const ir_node *node)
+{
+	bemit_0f_load(node, 0xBD, get_amd64_insn_mode(node));
+}
+
+static void bemit_shift(ir_node const *const node, unsigned const code)
+{
+	amd64_shift_attr_t const *const attr = get_amd64_shift_attr_const(node);
+	amd64_insn_mode_t  const        insn_mode = attr->insn_mode;
+	uint8_t            const        w         = insn_mode != INSN_MODE_8;
+	unsigned           const        reg       = get_in_encoding(node, 0);
+
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	if (!w)
+		amd64_insn_byte_reg(&insn, reg);
+	switch (attr->base.op_mode) {
+	case AMD64_OP_SHIFT_IMM:
+		if (attr->immediate == 1) {
+			amd64_insn_opcode(&insn, 0xD0 | w);
+		} else {
+			amd64_insn_opcode(&insn, 0xC0 | w);
+			amd64_insn_imm(&insn, 1, attr->immediate, NULL, AMD64_RELOC_NONE);
+		}
+		break;
+	case AMD64_OP_SHIFT_REG:
+		amd64_insn_opcode(&insn, 0xD2 | w);
+		break;
+	default:
+		panic("invalid op_mode for shiftop");
+	}
+	amd64_insn_modrm_reg(&insn, code, reg);
+	bemit_insn(&insn);
+}
+
+static void bemit_shl(const ir_node *node) { bemit_shift(node, 4); }
+static void bemit_shr(const ir_node *node) { bemit_shift(node, 5); }
+static void bemit_sar(const ir_node *node) { bemit_shift(node, 7); }
+
+static void bemit_xor_0(const ir_node *node)
+{
+	unsigned const reg = get_out_encoding(node, 0);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x31);
+	amd64_insn_modrm_reg(&insn, reg, reg);
+	bemit_insn(&insn);
+}
+
+static void bemit_mov_imm(const ir_node *node)
+{
+	amd64_movimm_attr_t const *const attr = get_amd64_movimm_attr_const(node);
+	amd64_insn_mode_t   const        insn_mode = attr->insn_mode;
+	amd64_imm64_t       const *const imm       = &attr->immediate;
+	unsigned            const        reg       = get_out_encoding(node, 0);
+	amd64_reloc_t       const        reloc
+		= get_imm_reloc(imm->kind, imm->entity, insn_mode);
+
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	switch (insn_mode) {
+	case INSN_MODE_8:
+		amd64_insn_byte_reg(&insn, reg);
+		amd64_insn_opcode(&insn, 0xB0);
+		amd64_insn_opcode_reg(&insn, reg);
+		amd64_insn_imm(&insn, 1, imm->offset, NULL, reloc);
+		break;
+	case INSN_MODE_16:
+	case INSN_MODE_32:
+		amd64_insn_opcode(&insn, 0xB8);
+		amd64_insn_opcode_reg(&insn, reg);
+		amd64_insn_imm(&insn, insn_mode == INSN_MODE_16 ? 2 : 4, imm->offset,
+		               imm->entity, reloc);
+		break;
+	case INSN_MODE_64:
+		if (imm->entity != NULL || is_int32(imm->offset)) {
+			/* sign extended 32bit immediate */
+			amd64_insn_opcode(&insn, 0xC7);
+			amd64_insn_modrm_reg(&insn, 0, reg);
+			amd64_insn_imm(&insn, 4, imm->offset, imm->entity, reloc);
+		} else {
+			amd64_insn_opcode(&insn, 0xB8);
+			amd64_insn_opcode_reg(&insn, reg);
+			amd64_insn_imm(&insn, 8, imm->offset, NULL, reloc);
+		}
+		break;
+	case INSN_MODE_128:
+	case INSN_MODE_INVALID:
+		panic("invalid insn mode");
+	}
+	bemit_insn(&insn);
+}
+
+static void bemit_movs(const ir_node *node)
+{
+	amd64_insn_mode_t const insn_mode = get_amd64_insn_mode(node);
+	amd64_insn_t insn;
+	bemit_init(&insn, INSN_MODE_64);
+	switch (insn_mode) {
+	case INSN_MODE_8:
+		amd64_insn_opcode(&insn, 0x0F);
+		amd64_insn_opcode(&insn, 0xBE);
+		break;
+	case INSN_MODE_16:
+		amd64_insn_opcode(&insn, 0x0F);
+		amd64_insn_opcode(&insn, 0xBF);
+		break;
+	case INSN_MODE_32:
+		amd64_insn_opcode(&insn, 0x63);
+		break;
+	default:
+		panic("invalid insn mode");
+	}
+	bemit_mod_am(&insn, node, get_out_encoding(node, 0), false);
+	bemit_insn(&insn);
+}
+
+/** Emits "mov %S0, %D0", gas uses the store form for register moves. */
+static void bemit_mov_reg(unsigned const src, unsigned const dst,
+                          amd64_insn_mode_t const insn_mode)
+{
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	amd64_insn_opcode(&insn, 0x89);
+	amd64_insn_modrm_reg(&insn, src, dst);
+	bemit_insn(&insn);
+}
+
+static void bemit_mov_gp(const ir_node *node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	switch (attr->insn_mode) {
+	case INSN_MODE_8:
+		bemit_0f_load(node, 0xB6, INSN_MODE_64);
+		return;
+	case INSN_MODE_16:
+		bemit_0f_load(node, 0xB7, INSN_MODE_64);
+		return;
+	case INSN_MODE_32:
+	case INSN_MODE_64: {
+		unsigned const dst = get_out_encoding(node, 0);
+		if (attr->base.op_mode == AMD64_OP_REG) {
+			bemit_mov_reg(get_in_encoding(node, 0), dst, attr->insn_mode);
+			return;
+		}
+		amd64_insn_t insn;
+		bemit_init(&insn, attr->insn_mode);
+		amd64_insn_opcode(&insn, 0x8B);
+		bemit_mod_am(&insn, node, dst, false);
+		bemit_insn(&insn);
+		return;
+	}
+	case INSN_MODE_128:
+	case INSN_MODE_INVALID:
+		break;
+	}
+	panic("invalid insn mode");
+}
+
+static void bemit_mov_store(const ir_node *node)
+{
+	amd64_binop_addr_attr_t const *const attr
+		= get_amd64_binop_addr_attr_const(node);
+	amd64_insn_mode_t const insn_mode = attr->base.insn_mode;
+	uint8_t           const w         = insn_mode != INSN_MODE_8;
+
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	switch ((amd64_op_mode_t)attr->base.base.op_mode) {
+	case AMD64_OP_ADDR_REG: {
+		unsigned const reg = get_in_encoding(node, attr->u.reg_input);
+		if (!w)
+			amd64_insn_byte_reg(&insn, reg);
+		amd64_insn_opcode(&insn, 0x88 | w);
+		bemit_mod_addr(&insn, node, reg, &attr->base.addr);
+		break;
+	}
+	case AMD64_OP_ADDR_IMM: {
+		x86_imm32_t const *const imm  = &attr->u.immediate;
+		unsigned           const size = insn_mode == INSN_MODE_8  ? 1
+		                              : insn_mode == INSN_MODE_16 ? 2 : 4;
+		amd64_insn_opcode(&insn, 0xC6 | w);
+		amd64_insn_imm(&insn, size, imm->offset, imm->entity,
+		               get_imm_reloc(imm->kind, imm->entity, insn_mode));
+		bemit_mod_addr(&insn, node, 0, &attr->base.addr);
+		break;
+	}
+	default:
+		panic("invalid op_mode for store %+F", node);
+	}
+	bemit_insn(&insn);
+}
+
+static void bemit_cmpxchg(const ir_node *node)
+{
+	amd64_binop_addr_attr_t const *const attr
+		= get_amd64_binop_addr_attr_const(node);
+	amd64_insn_mode_t const insn_mode = attr->base.insn_mode;
+	uint8_t           const w         = insn_mode != INSN_MODE_8;
+	unsigned          const reg = get_in_encoding(node, attr->u.reg_input);
+	assert(attr->base.base.op_mode == AMD64_OP_ADDR_REG);
+
+	amd64_insn_t insn;
+	bemit_init(&insn, insn_mode);
+	amd64_insn_prefix(&insn, 0xF0); /* lock */
+	if (!w)
+		amd64_insn_byte_reg(&insn, reg);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, 0xB0 | w);
+	bemit_mod_addr(&insn, node, reg, &attr->base.addr);
+	bemit_insn(&insn);
+}
+
+static void bemit_lea(const ir_node *node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	amd64_insn_t insn;
+	bemit_init(&insn, attr->insn_mode);
+	amd64_insn_opcode(&insn, 0x8D);
+	bemit_mod_addr(&insn, node, get_out_encoding(node, 0), &attr->addr);
+	bemit_insn(&insn);
+}
+
+static void bemit_setcc(const ir_node *node)
+{
+	amd64_cc_attr_t const *const attr = get_amd64_cc_attr_const(node);
+	unsigned          const        reg  = get_out_encoding(node, 0);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_byte_reg(&insn, reg);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, 0x90 | (attr->cc & 0x0F));
+	amd64_insn_modrm_reg(&insn, 0, reg);
+	bemit_insn(&insn);
+}
+
+static void bemit_push_am(const ir_node *node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	if (attr->insn_mode == INSN_MODE_16)
+		amd64_insn_prefix(&insn, 0x66);
+	amd64_insn_opcode(&insn, 0xFF);
+	bemit_mod_addr(&insn, node, 6, &attr->addr);
+	bemit_insn(&insn);
+}
+
+static void bemit_pop_am(const ir_node *node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	if (attr->insn_mode == INSN_MODE_16)
+		amd64_insn_prefix(&insn, 0x66);
+	amd64_insn_opcode(&insn, 0x8F);
+	bemit_mod_addr(&insn, node, 0, &attr->addr);
+	bemit_insn(&insn);
+}
+
+static void bemit_push_reg(const ir_node *node)
+{
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x50);
+	amd64_insn_opcode_reg(&insn, get_in_encoding(node, 2));
+	bemit_insn(&insn);
+}
+
+static void bemit_leave(const ir_node *node)
+{
+	(void)node;
+	be_emit8(0xC9);
+}
+
+static void bemit_ret(const ir_node *node)
+{
+	(void)node;
+	be_emit8(0xC3);
+}
+
+/** Emits a call or jump through %AM. */
+static void bemit_indirect(ir_node const *const node, uint8_t const opcode,
+                           unsigned const code)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	if (attr->base.op_mode == AMD64_OP_IMM32) {
+		x86_imm32_t const *const imm = &attr->addr.immediate;
+		if (imm->entity == NULL)
+			panic("absolute call targets not supported in object files");
+		amd64_insn_opcode(&insn, opcode);
+		amd64_insn_imm(&insn, 4, imm->offset, imm->entity,
+		               AMD64_RELOC_PLT32);
+	} else {
+		amd64_insn_opcode(&insn, 0xFF);
+		bemit_mod_am(&insn, node, code, false);
+	}
+	bemit_insn(&insn);
+}
+
+static void bemit_call(const ir_node *node)
+{
+	bemit_indirect(node, 0xE8, 2);
+}
+
+static void bemit_ijmp(const ir_node *node)
+{
+	bemit_indirect(node, 0xE9, 4);
+}
+
+/** Emits an SSE instruction "op %AM, %D0". */
+static void bemit_sse_load(ir_node const *const node, uint8_t const prefix,
+                           uint8_t const opcode, bool const rex_w)
+{
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	if (prefix != 0)
+		amd64_insn_prefix(&insn, prefix);
+	if (rex_w)
+		amd64_insn_rex_w(&insn);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, opcode);
+	bemit_mod_am(&insn, node, get_out_encoding(node, 0), false);
+	bemit_insn(&insn);
+}
+
+/** Emits an SSE instruction "op %S0, %A". */
+static void bemit_sse_store(ir_node const *const node, uint8_t const prefix,
+                            uint8_t const opcode)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_prefix(&insn, prefix);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, opcode);
+	bemit_mod_addr(&insn, node, get_in_encoding(node, 0), &attr->addr);
+	bemit_insn(&insn);
+}
+
+/** Emits an SSE instruction "op %AM" with the result in the first input. */
+static void bemit_sse_binop(ir_node const *const node, uint8_t const prefix,
+                            uint8_t const opcode)
+{
+	amd64_binop_addr_attr_t const *const attr
+		= get_amd64_binop_addr_attr_const(node);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	if (prefix != 0)
+		amd64_insn_prefix(&insn, prefix);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, opcode);
+	switch ((amd64_op_mode_t)attr->base.base.op_mode) {
+	case AMD64_OP_REG_REG:
+		amd64_insn_modrm_reg(&insn, get_in_encoding(node, 0),
+		                     get_in_encoding(node, 1));
+		break;
+	case AMD64_OP_REG_ADDR:
+		bemit_mod_addr(&insn, node, get_in_encoding(node, attr->u.reg_input),
+		               &attr->base.addr);
+		break;
+	default:
+		panic("invalid op_mode for %+F", node);
+	}
+	bemit_insn(&insn);
+}
+
+/** Returns the mandatory prefix for scalar single/double operations. */
+static uint8_t get_sse_scalar_prefix(ir_node const *const node)
+{
+	return get_amd64_insn_mode(node) == INSN_MODE_32 ? 0xF3 : 0xF2;
+}
+
+/** Returns the prefix for packed single/double operations. */
+static uint8_t get_sse_packed_prefix(ir_node const *const node)
+{
+	return get_amd64_insn_mode(node) == INSN_MODE_32 ? 0 : 0x66;
+}
+
+static void bemit_adds(const ir_node *node)
+{
+	bemit_sse_binop(node, get_sse_scalar_prefix(node), 0x58);
+}
+
+static void bemit_muls(const ir_node *node)
+{
+	bemit_sse_binop(node, get_sse_scalar_prefix(node), 0x59);
+}
+
+static void bemit_subs(const ir_node *node)
+{
+	bemit_sse_binop(node, get_sse_scalar_prefix(node), 0x5C);
+}
+
+static void bemit_divs(const ir_node *node)
+{
+	bemit_sse_binop(node, get_sse_scalar_prefix(node), 0x5E);
+}
+
+static void bemit_ucomis(const ir_node *node)
+{
+	bemit_sse_binop(node, get_sse_packed_prefix(node), 0x2E);
+}
+
+static void bemit_xorp(const ir_node *node)
+{
+	bemit_sse_binop(node, get_sse_packed_prefix(node), 0x57);
+}
+
+static void bemit_punpckldq(const ir_node *node)
+{
+	bemit_sse_binop(node, 0x66, 0x62);
+}
+
+static void bemit_subpd(const ir_node *node)
+{
+	bemit_sse_binop(node, 0x66, 0x5C);
+}
+
+static void bemit_haddpd(const ir_node *node)
+{
+	bemit_sse_binop(node, 0x66, 0x7C);
+}
+
+static void bemit_xorpd_0(const ir_node *node)
+{
+	unsigned const reg = get_out_encoding(node, 0);
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_prefix(&insn, 0x66);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, 0x57);
+	amd64_insn_modrm_reg(&insn, reg, reg);
+	bemit_insn(&insn);
+}
+
+static void bemit_movs_xmm(const ir_node *node)
+{
+	bemit_sse_load(node, get_sse_scalar_prefix(node), 0x10, false);
+}
+
+static void bemit_movs_store_xmm(const ir_node *node)
+{
+	bemit_sse_store(node, get_sse_scalar_prefix(node), 0x11);
+}
+
+static void bemit_movdqa(const ir_node *node)
+{
+	bemit_sse_load(node, 0x66, 0x6F, false);
+}
+
+static void bemit_movdqu(const ir_node *node)
+{
+	bemit_sse_load(node, 0xF3, 0x6F, false);
+}
+
+static void bemit_movdqu_store(const ir_node *node)
+{
+	bemit_sse_store(node, 0xF3, 0x7F);
+}
+
+static void bemit_cvtss2sd(const ir_node *node)
+{
+	bemit_sse_load(node, 0xF3, 0x5A, false);
+}
+
+static void bemit_cvtsd2ss(const ir_node *node)
+{
+	bemit_sse_load(node, 0xF2, 0x5A, false);
+}
+
+static void bemit_cvttss2si(const ir_node *node)
+{
+	bool const rex_w = get_amd64_insn_mode(node) == INSN_MODE_64;
+	bemit_sse_load(node, 0xF3, 0x2C, rex_w);
+}
+
+static void bemit_cvttsd2si(const ir_node *node)
+{
+	bool const rex_w = get_amd64_insn_mode(node) == INSN_MODE_64;
+	bemit_sse_load(node, 0xF2, 0x2C, rex_w);
+}
+
+static void bemit_cvtsi2ss(const ir_node *node)
+{
+	bool const rex_w = get_amd64_insn_mode(node) == INSN_MODE_64;
+	bemit_sse_load(node, 0xF3, 0x2A, rex_w);
+}
+
+static void bemit_cvtsi2sd(const ir_node *node)
+{
+	bool const rex_w = get_amd64_insn_mode(node) == INSN_MODE_64;
+	bemit_sse_load(node, 0xF2, 0x2A, rex_w);
+}
+
+static void bemit_movq(const ir_node *node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	if (attr->base.op_mode == AMD64_OP_REG
+	 && arch_get_irn_register_in(node, 0)->cls
+	    == &amd64_reg_classes[CLASS_amd64_gp]) {
+		bemit_sse_load(node, 0x66, 0x6E, true);
+	} else {
+		bemit_sse_load(node, 0xF3, 0x7E, false);
+	}
+}
+
+static void bemit_movd_gp_xmm(const ir_node *node)
+{
+	bool const rex_w = get_amd64_insn_mode(node) == INSN_MODE_64;
+	bemit_sse_load(node, 0x66, 0x6E, rex_w);
+}
+
+static void bemit_movd_xmm_gp(const ir_node *node)
+{
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_prefix(&insn, 0x66);
+	if (get_amd64_insn_mode(node) == INSN_MODE_64)
+		amd64_insn_rex_w(&insn);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, 0x7E);
+	amd64_insn_modrm_reg(&insn, get_in_encoding(node, 0),
+	                     get_out_encoding(node, 0));
+	bemit_insn(&insn);
+}
+
+static void bemit_x87_reg(uint8_t const opcode, uint8_t const modrm,
+                          arch_register_t const *const reg)
+{
+	be_emit8(opcode);
+	be_emit8(modrm + reg->encoding);
+}
+
+/** Emits an x87 load or store with the memory operand %AM. */
+static void bemit_x87_mem(ir_node const *const node, uint8_t const opcode,
+                          unsigned const code)
+{
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, opcode);
+	bemit_mod_am(&insn, node, code, false);
+	bemit_insn(&insn);
+}
+
+static void bemit_fld(const ir_node *node)
+{
+	switch (get_amd64_insn_mode(node)) {
+	case INSN_MODE_32:  bemit_x87_mem(node, 0xD9, 0); return;
+	case INSN_MODE_64:  bemit_x87_mem(node, 0xDD, 0); return;
+	case INSN_MODE_128: bemit_x87_mem(node, 0xDB, 5); return;
+	default:
+		break;
+	}
+	panic("invalid insn mode");
+}
+
+static void bemit_fstp(const ir_node *node)
+{
+	switch (get_amd64_insn_mode(node)) {
+	case INSN_MODE_32:  bemit_x87_mem(node, 0xD9, 3); return;
+	case INSN_MODE_64:  bemit_x87_mem(node, 0xDD, 3); return;
+	case INSN_MODE_128: bemit_x87_mem(node, 0xDB, 7); return;
+	default:
+		break;
+	}
+	panic("invalid insn mode");
+}
+
+static void bemit_fst(const ir_node *node)
+{
+	if (amd64_get_x87_attr_const(node)->pop) {
+		bemit_fstp(node);
+		return;
+	}
+	switch (get_amd64_insn_mode(node)) {
+	case INSN_MODE_32: bemit_x87_mem(node, 0xD9, 2); return;
+	case INSN_MODE_64: bemit_x87_mem(node, 0xDD, 2); return;
+	default:
+		break;
+	}
+	panic("invalid insn mode");
+}
+
+/** Emits an x87 arithmetic instruction with the operands %AF. */
+static void bemit_x87_binop(ir_node const *const node, unsigned code)
+{
+	x87_attr_t const *const attr = amd64_get_x87_attr_const(node);
+	if (attr->reverse)
+		++code;
+	uint8_t opcode;
+	if (attr->res_in_reg) {
+		opcode = attr->pop ? 0xDE : 0xDC;
+	} else {
+		assert(!attr->pop);
+		opcode = 0xD8;
+	}
+	bemit_x87_reg(opcode, 0xC0 | code << 3, attr->reg);
+}
+
+static void bemit_fadd(const ir_node *node) { bemit_x87_binop(node, 0); }
+static void bemit_fmul(const ir_node *node) { bemit_x87_binop(node, 1); }
+static void bemit_fsub(const ir_node *node) { bemit_x87_binop(node, 4); }
+static void bemit_fdiv(const ir_node *node) { bemit_x87_binop(node, 6); }
+
+static void bemit_fucomi(const ir_node *node)
+{
+	x87_attr_t const *const attr = amd64_get_x87_attr_const(node);
+	bemit_x87_reg(attr->pop ? 0xDF : 0xDB, 0xE8, attr->reg);
+}
+
+static void bemit_fdup(const ir_node *node)
+{
+	bemit_x87_reg(0xD9, 0xC0, amd64_get_x87_attr_const(node)->reg);
+}
+
+static void bemit_fxch(const ir_node *node)
+{
+	bemit_x87_reg(0xD9, 0xC8, amd64_get_x87_attr_const(node)->reg);
+}
+
+static void bemit_fpop(const ir_node *node)
+{
+	bemit_x87_reg(0xDD, 0xD8, amd64_get_x87_attr_const(node)->reg);
+}
+
+static void bemit_fchs(const ir_node *node)
+{
+	(void)node;
+	be_emit8(0xD9);
+	be_emit8(0xE0);
+}
+
+static void bemit_fld1(const ir_node *node)
+{
+	(void)node;
+	be_emit8(0xD9);
+	be_emit8(0xE8);
+}
+
+static void bemit_fldz(const ir_node *node)
+{
+	(void)node;
+	be_emit8(0xD9);
+	be_emit8(0xEE);
+}
+
+/**
+ * Ends the current fragment with a jump to the target of the control flow
+ * node @p cfop.
+ */
+static void bemit_jump(ir_node const *const cfop, int const jump_type)
+{
+	code_fragment_t *const fragment = be_get_current_fragment();
+	fragment->jump_type = jump_type;
+	fragment->jump_data = get_cfop_target_block(cfop);
+	be_start_new_fragment();
+}
+
+static void bemit_jmp(const ir_node *node)
+{
+	ir_node const *const block = get_nodes_block(node);
+	if (get_cfop_target_block(node) != sched_next_block(block))
+		bemit_jump(node, AMD64_JUMP_JMP);
+}
+
+static void bemit_jcc(const ir_node *node)
+{
+	const ir_node         *proj_true  = NULL;
+	const ir_node         *proj_false = NULL;
+	const ir_node         *flags = get_irn_n(node, n_amd64_jcc_eflags);
+	const amd64_cc_attr_t *attr  = get_amd64_cc_attr_const(node);
+	x86_condition_code_t   cc    = determine_final_cc(flags, attr->cc);
+
+	foreach_out_edge(node, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		unsigned nr = get_Proj_num(proj);
+		if (nr == pn_Cond_true) {
+			proj_true = proj;
+		} else {
+			proj_false = proj;
+		}
+	}
+
+	ir_node const *const next_block = sched_next_block(get_nodes_block(node));
+	if (get_cfop_target_block(proj_true) == next_block) {
+		/* exchange both proj's so the second one can be omitted */
+		const ir_node *t = proj_true;
+
+		proj_true  = proj_false;
+		proj_false = t;
+		cc         = x86_negate_condition_code(cc);
+	}
+
+	if (cc & x86_cc_float_parity_cases) {
+		/* Some floating point comparisons require a test of the parity flag,
+		 * which indicates that the result is unordered */
+		ir_node const *const target
+			= cc & x86_cc_negated ? proj_true : proj_false;
+		bemit_jump(target, AMD64_JUMP_JCC | x86_cc_parity);
+	}
+
+	bemit_jump(proj_true, AMD64_JUMP_JCC | (cc & 0x0F));
+
+	if (get_cfop_target_block(proj_false) != next_block)
+		bemit_jump(proj_false, AMD64_JUMP_JMP);
+}
+
+static void bemit_jmp_switch(const ir_node *node)
+{
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0xFF);
+	bemit_mod_am(&insn, node, 4, false);
+	bemit_insn(&insn);
+	/* the table is written once the block offsets are known */
+	ARR_APP1(ir_node*, switch_jmps, (ir_node*)node);
+}
+
+static void bemit_be_Copy(const ir_node *node)
+{
+	arch_register_t const *const in  = arch_get_irn_register_in(node, 0);
+	arch_register_t const *const out = arch_get_irn_register_out(node, 0);
+	if (in == out)
+		return;
+
+	arch_register_class_t const *const cls = out->cls;
+	if (cls == &amd64_reg_classes[CLASS_amd64_gp]) {
+		bemit_mov_reg(in->encoding, out->encoding, INSN_MODE_64);
+	} else if (cls == &amd64_reg_classes[CLASS_amd64_xmm]) {
+		/* movapd */
+		amd64_insn_t insn;
+		amd64_insn_init(&insn);
+		amd64_insn_prefix(&insn, 0x66);
+		amd64_insn_opcode(&insn, 0x0F);
+		amd64_insn_opcode(&insn, 0x28);
+		amd64_insn_modrm_reg(&insn, out->encoding, in->encoding);
+		bemit_insn(&insn);
+	} else if (cls == &amd64_reg_classes[CLASS_amd64_x87]) {
+		/* nothing to do */
+	} else {
+		panic("move not supported for this register class");
+	}
+}
+
+static void bemit_pxor(unsigned const src, unsigned const dst)
+{
+	amd64_insn_t insn;
+	amd64_insn_init(&insn);
+	amd64_insn_prefix(&insn, 0x66);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, 0xEF);
+	amd64_insn_modrm_reg(&insn, dst, src);
+	bemit_insn(&insn);
+}
+
+static void bemit_be_Perm(const ir_node *node)
+{
+	arch_register_t const *const reg0 = arch_get_irn_register_out(node, 0);
+	arch_register_t const *const reg1 = arch_get_irn_register_out(node, 1);
+
+	arch_register_class_t const* const cls = reg0->cls;
+	assert(cls == reg1->cls && "Register class mismatch at Perm");
+
+	unsigned const enc0 = reg0->encoding;
+	unsigned const enc1 = reg1->encoding;
+	if (cls == &amd64_reg_classes[CLASS_amd64_gp]) {
+		amd64_insn_t insn;
+		bemit_init(&insn, INSN_MODE_64);
+		if (enc0 == 0 || enc1 == 0) {
+			/* short form with rax */
+			amd64_insn_opcode(&insn, 0x90);
+			amd64_insn_opcode_reg(&insn, enc0 == 0 ? enc1 : enc0);
+		} else {
+			amd64_insn_opcode(&insn, 0x87);
+			amd64_insn_modrm_reg(&insn, enc0, enc1);
+		}
+		bemit_insn(&insn);
+	} else if (cls == &amd64_reg_classes[CLASS_amd64_xmm]) {
+		bemit_pxor(enc0, enc1);
+		bemit_pxor(enc1, enc0);
+		bemit_pxor(enc0, enc1);
+	} else {
+		panic("unexpected register class in be_Perm (%+F)", node);
+	}
+}
+
+static void bemit_be_IncSP(const ir_node *node)
+{
+	int offs = be_get_IncSP_offset(node);
+	if (offs == 0)
+		return;
+
+	/* subq/addq $offs, %rsp */
+	unsigned const code = offs > 0 ? 5 : 0;
+	if (offs < 0)
+		offs = -offs;
+	amd64_insn_t insn;
+	bemit_init(&insn, INSN_MODE_64);
+	if (is_int8(offs)) {
+		amd64_insn_opcode(&insn, 0x83);
+		amd64_insn_imm(&insn, 1, offs, NULL, AMD64_RELOC_NONE);
+	} else {
+		amd64_insn_opcode(&insn, 0x81);
+		amd64_insn_imm(&insn, 4, offs, NULL, AMD64_RELOC_NONE);
+	}
+	amd64_insn_modrm_reg(&insn, code, get_out_encoding(node, 0));
+	bemit_insn(&insn);
+}
+
+static void bemit_be_Asm(const ir_node *node)
+{
+	panic("inline assembler not supported in object file output (%+F)",
+	      node);
+}
+
+static void amd64_register_binary_emitters(void)
+{
+	be_init_emitters();
+
+	be_set_emitter(op_amd64_add,            bemit_add);
+	be_set_emitter(op_amd64_adds,           bemit_adds);
+	be_set_emitter(op_amd64_and,            bemit_and);
+	be_set_emitter(op_amd64_bsf,            bemit_bsf);
+	be_set_emitter(op_amd64_bsr,            bemit_bsr);
+	be_set_emitter(op_amd64_call,           bemit_call);
+	be_set_emitter(op_amd64_cmp,            bemit_cmp);
+	be_set_emitter(op_amd64_cmpxchg,        bemit_cmpxchg);
+	be_set_emitter(op_amd64_cvtsd2ss,       bemit_cvtsd2ss);
+	be_set_emitter(op_amd64_cvtsi2sd,       bemit_cvtsi2sd);
+	be_set_emitter(op_amd64_cvtsi2ss,       bemit_cvtsi2ss);
+	be_set_emitter(op_amd64_cvtss2sd,       bemit_cvtss2sd);
+	be_set_emitter(op_amd64_cvttsd2si,      bemit_cvttsd2si);
+	be_set_emitter(op_amd64_cvttss2si,      bemit_cvttss2si);
+	be_set_emitter(op_amd64_div,            bemit_div);
+	be_set_emitter(op_amd64_divs,           bemit_divs);
+	be_set_emitter(op_amd64_fadd,           bemit_fadd);
+	be_set_emitter(op_amd64_fchs,           bemit_fchs);
+	be_set_emitter(op_amd64_fdiv,           bemit_fdiv);
+	be_set_emitter(op_amd64_fdup,           bemit_fdup);
+	be_set_emitter(op_amd64_fld,            bemit_fld);
+	be_set_emitter(op_amd64_fld1,           bemit_fld1);
+	be_set_emitter(op_amd64_fldz,           bemit_fldz);
+	be_set_emitter(op_amd64_fmul,           bemit_fmul);
+	be_set_emitter(op_amd64_fpop,           bemit_fpop);
+	be_set_emitter(op_amd64_fst,            bemit_fst);
+	be_set_emitter(op_amd64_fstp,           bemit_fstp);
+	be_set_emitter(op_amd64_fsub,           bemit_fsub);
+	be_set_emitter(op_amd64_fucomi,         bemit_fucomi);
+	be_set_emitter(op_amd64_fxch,           bemit_fxch);
+	be_set_emitter(op_amd64_haddpd,         bemit_haddpd);
+	be_set_emitter(op_amd64_idiv,           bemit_idiv);
+	be_set_emitter(op_amd64_ijmp,           bemit_ijmp);
+	be_set_emitter(op_amd64_imul,           bemit_imul);
+	be_set_emitter(op_amd64_imul_1op,       bemit_imul_1op);
+	be_set_emitter(op_amd64_jcc,            bemit_jcc);
+	be_set_emitter(op_amd64_jmp,            bemit_jmp);
+	be_set_emitter(op_amd64_jmp_switch,     bemit_jmp_switch);
+	be_set_emitter(op_amd64_lea,            bemit_lea);
+	be_set_emitter(op_amd64_leave,          bemit_leave);
+	be_set_emitter(op_amd64_mov_gp,         bemit_mov_gp);
+	be_set_emitter(op_amd64_mov_imm,        bemit_mov_imm);
+	be_set_emitter(op_amd64_mov_store,      bemit_mov_store);
+	be_set_emitter(op_amd64_movd_gp_xmm,    bemit_movd_gp_xmm);
+	be_set_emitter(op_amd64_movd_xmm_gp,    bemit_movd_xmm_gp);
+	be_set_emitter(op_amd64_movdqa,         bemit_movdqa);
+	be_set_emitter(op_amd64_movdqu,         bemit_movdqu);
+	be_set_emitter(op_amd64_movdqu_store,   bemit_movdqu_store);
+	be_set_emitter(op_amd64_movq,           bemit_movq);
+	be_set_emitter(op_amd64_movs,           bemit_movs);
+	be_set_emitter(op_amd64_movs_store_xmm, bemit_movs_store_xmm);
+	be_set_emitter(op_amd64_movs_xmm,       bemit_movs_xmm);
+	be_set_emitter(op_amd64_mul,            bemit_mul);
+	be_set_emitter(op_amd64_muls,           bemit_muls);
+	be_set_emitter(op_amd64_neg,            bemit_neg);
+	be_set_emitter(op_amd64_not,            bemit_not);
+	be_set_emitter(op_amd64_or,             bemit_or);
+	be_set_emitter(op_amd64_pop_am,         bemit_pop_am);
+	be_set_emitter(op_amd64_punpckldq,      bemit_punpckldq);
+	be_set_emitter(op_amd64_push_am,        bemit_push_am);
+	be_set_emitter(op_amd64_push_reg,       bemit_push_reg);
+	be_set_emitter(op_amd64_ret,            bemit_ret);
+	be_set_emitter(op_amd64_sar,            bemit_sar);
+	be_set_emitter(op_amd64_sbb,            bemit_sbb);
+	be_set_emitter(op_amd64_setcc,          bemit_setcc);
+	be_set_emitter(op_amd64_shl,            bemit_shl);
+	be_set_emitter(op_amd64_shr,            bemit_shr);
+	be_set_emitter(op_amd64_sub,            bemit_sub);
+	be_set_emitter(op_amd64_sub_sp,         bemit_sub_sp);
+	be_set_emitter(op_amd64_subpd,          bemit_subpd);
+	be_set_emitter(op_amd64_subs,           bemit_subs);
+	be_set_emitter(op_amd64_ucomis,         bemit_ucomis);
+	be_set_emitter(op_amd64_xor,            bemit_xor);
+	be_set_emitter(op_amd64_xor_0,          bemit_xor_0);
+	be_set_emitter(op_amd64_xorp,           bemit_xorp);
+	be_set_emitter(op_amd64_xorpd_0,        bemit_xorpd_0);
+	be_set_emitter(op_be_Asm,               bemit_be_Asm);
+	be_set_emitter(op_be_Copy,              bemit_be_Copy);
+	be_set_emitter(op_be_CopyKeep,          bemit_be_Copy);
+	be_set_emitter(op_be_IncSP,             bemit_be_IncSP);
+	be_set_emitter(op_be_Perm,              bemit_be_Perm);
+}
+
+static code_fragment_t *get_block_fragment(ir_node const *const block)
+{
+	void *const nr = pmap_get(void, block_fragments, block);
+	assert(nr != NULL);
+	return be_get_fragment(PTR_TO_INT(nr));
+}
+
+static void amd64_determine_jumpsize(code_fragment_t *const fragment)
+{
+	if (fragment->jump_type == AMD64_JUMP_NONE)
+		return;
+
+	/* start optimistic, jumps which turn out to be too far stay long */
+	if (fragment->destination == NULL) {
+		fragment->destination  = get_block_fragment(fragment->jump_data);
+		fragment->jumpsize_min = JUMP_SHORT_SIZE;
+		fragment->jumpsize_max = JUMP_SHORT_SIZE;
+		return;
+	}
+	if (fragment->jumpsize_min != JUMP_SHORT_SIZE)
+		return;
+
+	int64_t const disp = (int64_t)fragment->destination->offset
+		- (fragment->offset + fragment->len + JUMP_SHORT_SIZE);
+	if (!is_int8(disp)) {
+		unsigned short const size = fragment->jump_type == AMD64_JUMP_JMP
+		                          ? JMP_NEAR_SIZE : JCC_NEAR_SIZE;
+		fragment->jumpsize_min = size;
+		fragment->jumpsize_max = size;
+	}
+}
+
+static void amd64_emit_jump(code_fragment_t *const fragment,
+                            unsigned char *buffer)
+{
+	if (fragment->jump_type == AMD64_JUMP_NONE)
+		return;
+
+	unsigned const size = fragment->jumpsize_min;
+	int32_t  const disp = (int32_t)(fragment->destination->offset
+		- (fragment->offset + fragment->len + size));
+	unsigned const cc   = fragment->jump_type & 0x0F;
+	if (size == JUMP_SHORT_SIZE) {
+		assert(is_int8(disp));
+		*buffer++ = fragment->jump_type == AMD64_JUMP_JMP ? 0xEB : 0x70 | cc;
+		*buffer   = (unsigned char)disp;
+		return;
+	}
+	if (fragment->jump_type == AMD64_JUMP_JMP) {
+		*buffer++ = 0xE9;
+	} else {
+		*buffer++ = 0x0F;
+		*buffer++ = 0x80 | cc;
+	}
+	for (unsigned i = 0; i < 4; ++i)
+		*buffer++ = (unsigned char)((uint32_t)disp >> (8 * i));
+}
+
+static const binary_emiter_interface_t amd64_binary_interface = {
+	.create_nops        = amd64_create_nops,
+	.emit_jump          = amd64_emit_jump,
+	.determine_jumpsize = amd64_determine_jumpsize,
+};
+
+static void emit_jump_table_binary(ir_node const *const node,
+                                   be_elf_section_t *const text,
+                                   unsigned const code_start)
+{
+	amd64_switch_jmp_attr_t const *const attr
+		= get_amd64_switch_jmp_attr_const(node);
+	unsigned long         length;
+	ir_node const **const labels
+		= be_get_jump_table_targets(node, attr->table, &length);
+
+	unsigned          const entry_size = be_options.pic ? 4 : 8;
+	be_elf_section_t *const rodata = be_elf_get_section(GAS_SECTION_RODATA);
+	be_elf_align(rodata, entry_size, NULL);
+	unsigned const table = be_elf_get_size(rodata);
+	be_elf_define_entity(attr->table_entity, rodata, table, 0, BE_ELF_NOTYPE);
+	be_elf_grow(rodata, length * entry_size);
+
+	for (unsigned long i = 0; i < length; ++i) {
+		ir_node const *const block  = get_cfop_target_block(labels[i]);
+		unsigned       const target
+			= code_start + get_block_fragment(block)->offset;
+		unsigned       const entry  = table + i * entry_size;
+		if (be_options.pic) {
+			/* block - table */
+			be_elf_add_section_reloc(rodata, entry, AMD64_RELOC_PC32, text,
+			                         target + (entry - table));
+		} else {
+			be_elf_add_section_reloc(rodata, entry, AMD64_RELOC_64, text,
+			                         target);
+		}
+	}
+	free(labels);
+}
+
+static void amd64_emit_function_binary(ir_graph *irg, ir_node **blk_sched)
+{
+	ir_entity *entity = get_irg_entity(irg);
+
+	amd64_register_binary_emitters();
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	amd64_link_blocks(irg, blk_sched);
+
+	block_fragments = pmap_create();
+	switch_jmps     = NEW_ARR_F(ir_node*, 0);
+	be_start_code_emitter();
+
+	/* every block starts a fragment, so fragment 0 stays empty */
+	size_t const n = ARR_LEN(blk_sched);
+	for (size_t i = 0; i < n; ++i) {
+		ir_node *block = blk_sched[i];
+		unsigned nr    = be_start_new_fragment();
+		pmap_insert(block_fragments, block, INT_TO_PTR(nr));
+		sched_foreach(block, node) {
+			be_emit_node(node);
+		}
+	}
+
+	be_elf_section_t *const text = be_elf_get_entity_section(entity);
+	be_elf_align(text, 16, amd64_create_nops);
+	unsigned const start = be_emit_code(text, &amd64_binary_interface);
+	be_elf_define_entity(entity, text, start, be_elf_get_size(text) - start,
+	                     BE_ELF_FUNC);
+
+	/* labels of blocks whose address is taken */
+	for (size_t i = 0; i < n; ++i) {
+		ir_node   const *const block = blk_sched[i];
+		ir_entity const *const label = get_Block_entity(block);
+		if (label != NULL) {
+			unsigned const offset = get_block_fragment(block)->offset;
+			be_elf_define_entity(label, text, start + offset, 0,
+			                     BE_ELF_NOTYPE);
+		}
+	}
+
+	for (size_t i = 0, n_switches = ARR_LEN(switch_jmps); i < n_switches;
+	     ++i) {
+		emit_jump_table_binary(switch_jmps[i], text, start);
+	}
+
+	be_end_code_emitter();
+	DEL_ARR_F(switch_jmps);
+	pmap_destroy(block_fragments);
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+}
+
+void amd64_emit_function(ir_graph *irg)
+{
+	layout = be_get_irg_stack_layout(irg);
+
+	ir_node **const blk_sched = be_create_block_schedule(irg);
+	if (be_options.emit_object) {
+		amd64_emit_function_binary(irg, blk_sched);
+	} else {
+		amd64_emit_function_text(irg, blk_sched);
+	}
+}
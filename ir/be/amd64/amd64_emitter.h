@@ -10,6 +10,7 @@
 #ifndef FIRM_BE_AMD64_AMD64_EMITTER_H
 #define FIRM_BE_AMD64_AMD64_EMITTER_H
 
+#include "beelf.h"
 #include "firm_types.h"
 
 /**
@@ -31,6 +32,9 @@
  */
 void amd64_emitf(ir_node const *node, char const *fmt, ...);
 
+/** Relocation types and machine of amd64 ELF object files. */
+extern const be_elf_target_t amd64_elf_target;
+
 void amd64_emit_function(ir_graph *irg);
 
 #endif
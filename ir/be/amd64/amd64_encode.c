@@ -0,0 +1,300 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   x86-64 instruction encoder
+ */
+#include "amd64_encode.h"
+
+#include <assert.h>
+#include <string.h>
+#include "panic.h"
+
+#define REX_BASE 0x40
+#define REX_W    0x08
+#define REX_R    0x04
+#define REX_X    0x02
+#define REX_B    0x01
+
+/** r/m and base value which means "SIB byte follows" */
+#define RM_SIB   0x04
+/** r/m value which means "disp32" (RIP relative without SIB) */
+#define RM_DISP  0x05
+
+static bool is_int8(int64_t value)
+{
+	return -128 <= value && value < 128;
+}
+
+void amd64_insn_init(amd64_insn_t *insn)
+{
+	memset(insn, 0, sizeof(*insn));
+}
+
+void amd64_insn_prefix(amd64_insn_t *insn, uint8_t prefix)
+{
+	assert(insn->n_prefixes < sizeof(insn->prefixes));
+	assert(insn->n_opcode == 0);
+	insn->prefixes[insn->n_prefixes++] = prefix;
+}
+
+void amd64_insn_opcode(amd64_insn_t *insn, uint8_t opcode)
+{
+	assert(insn->n_opcode < sizeof(insn->opcode));
+	insn->opcode[insn->n_opcode++] = opcode;
+}
+
+void amd64_insn_rex_w(amd64_insn_t *insn)
+{
+	insn->rex |= REX_W;
+}
+
+void amd64_insn_byte_reg(amd64_insn_t *insn, unsigned reg)
+{
+	/* without REX encodings 4-7 mean ah, ch, dh and bh */
+	if (reg >= 4 && reg < 8)
+		insn->force_rex = true;
+}
+
+void amd64_insn_opcode_reg(amd64_insn_t *insn, unsigned reg)
+{
+	assert(insn->n_opcode > 0);
+	insn->opcode[insn->n_opcode - 1] += reg & 7;
+	if (reg & 8)
+		insn->rex |= REX_B;
+}
+
+static uint8_t make_modrm(unsigned mod, unsigned reg, unsigned rm)
+{
+	return (uint8_t)(mod << 6 | (reg & 7) << 3 | (rm & 7));
+}
+
+void amd64_insn_modrm_reg(amd64_insn_t *insn, unsigned reg, unsigned rm)
+{
+	assert(!insn->has_modrm);
+	insn->has_modrm = true;
+	insn->modrm     = make_modrm(3, reg, rm);
+	if (reg & 8)
+		insn->rex |= REX_R;
+	if (rm & 8)
+		insn->rex |= REX_B;
+}
+
+static void set_disp(amd64_insn_t *insn, unsigned size,
+                     amd64_enc_addr_t const *addr)
+{
+	insn->disp.size   = (uint8_t)size;
+	insn->disp.value  = addr->disp;
+	insn->disp.entity = addr->entity;
+	insn->disp.reloc  = addr->entity != NULL ? addr->reloc : AMD64_RELOC_NONE;
+}
+
+void amd64_insn_modrm_mem(amd64_insn_t *insn, unsigned reg,
+                          amd64_enc_addr_t const *addr)
+{
+	assert(!insn->has_modrm);
+	insn->has_modrm = true;
+	insn->segment   = addr->segment;
+	if (reg & 8)
+		insn->rex |= REX_R;
+
+	unsigned const index = addr->index;
+	unsigned const base  = addr->base;
+	if (addr->rip) {
+		assert(base == AMD64_NO_REG && index == AMD64_NO_REG);
+		insn->modrm = make_modrm(0, reg, RM_DISP);
+		set_disp(insn, 4, addr);
+		return;
+	}
+
+	unsigned index_bits = RM_SIB;
+	if (index != AMD64_NO_REG) {
+		assert(index != RM_SIB);
+		index_bits = index;
+		if (index & 8)
+			insn->rex |= REX_X;
+	}
+
+	if (base == AMD64_NO_REG) {
+		/* mod 0 with SIB base 5 is an absolute disp32 (plus index) */
+		insn->modrm   = make_modrm(0, reg, RM_SIB);
+		insn->has_sib = true;
+		insn->sib     = make_modrm(addr->log_scale, index_bits, RM_DISP);
+		set_disp(insn, 4, addr);
+		return;
+	}
+
+	if (base & 8)
+		insn->rex |= REX_B;
+
+	/* rbp and r13 have no encoding without displacement */
+	unsigned mod;
+	unsigned disp_size;
+	if (addr->entity != NULL) {
+		mod       = 2;
+		disp_size = 4;
+	} else if (addr->disp == 0 && (base & 7) != RM_DISP) {
+		mod       = 0;
+		disp_size = 0;
+	} else if (is_int8(addr->disp)) {
+		mod       = 1;
+		disp_size = 1;
+	} else {
+		mod       = 2;
+		disp_size = 4;
+	}
+
+	/* rsp and r12 as base need a SIB byte */
+	if (index != AMD64_NO_REG || (base & 7) == RM_SIB) {
+		insn->modrm   = make_modrm(mod, reg, RM_SIB);
+		insn->has_sib = true;
+		insn->sib     = make_modrm(addr->log_scale, index_bits, base);
+	} else {
+		insn->modrm = make_modrm(mod, reg, base);
+	}
+	set_disp(insn, disp_size, addr);
+}
+
+void amd64_insn_imm(amd64_insn_t *insn, unsigned size, int64_t value,
+                    ir_entity const *entity, amd64_reloc_t reloc)
+{
+	assert(insn->imm.size == 0);
+	assert(size == 1 || size == 2 || size == 4 || size == 8);
+	insn->imm.size   = (uint8_t)size;
+	insn->imm.value  = value;
+	insn->imm.entity = entity;
+	insn->imm.reloc  = entity != NULL ? reloc : AMD64_RELOC_NONE;
+}
+
+bool amd64_reloc_is_pc_relative(amd64_reloc_t reloc)
+{
+	switch (reloc) {
+	case AMD64_RELOC_PC32:
+	case AMD64_RELOC_PLT32:
+	case AMD64_RELOC_GOTPCREL:
+	case AMD64_RELOC_GOTPCRELX:
+	case AMD64_RELOC_REX_GOTPCRELX:
+		return true;
+	case AMD64_RELOC_NONE:
+	case AMD64_RELOC_64:
+	case AMD64_RELOC_32:
+	case AMD64_RELOC_32S:
+		return false;
+	}
+	panic("invalid relocation type %d", (int)reloc);
+}
+
+/**
+ * Loads through the GOT may be relaxed by the linker if the instruction is
+ * one it knows how to rewrite. Mark them like gas does.
+ */
+static amd64_reloc_t relax_gotpcrel(amd64_insn_t const *insn, bool has_rex)
+{
+	if (insn->n_opcode != 1)
+		return AMD64_RELOC_GOTPCREL;
+	unsigned const reg = (insn->modrm >> 3) & 7;
+	switch (insn->opcode[0]) {
+	case 0xFF:
+		/* only call and jmp */
+		if (reg != 2 && reg != 4)
+			return AMD64_RELOC_GOTPCREL;
+		return AMD64_RELOC_GOTPCRELX;
+	case 0x8B:
+	case 0x85:
+	case 0x03:
+	case 0x0B:
+	case 0x13:
+	case 0x1B:
+	case 0x23:
+	case 0x2B:
+	case 0x33:
+	case 0x3B:
+		return has_rex ? AMD64_RELOC_REX_GOTPCRELX : AMD64_RELOC_GOTPCRELX;
+	default:
+		return AMD64_RELOC_GOTPCREL;
+	}
+}
+
+static unsigned encode_field(uint8_t *buffer, unsigned pos,
+                             amd64_enc_field_t const *field,
+                             amd64_fixup_t *fixups, unsigned *n_fixups,
+                             amd64_reloc_t reloc)
+{
+	int64_t value = field->value;
+	if (field->entity != NULL) {
+		amd64_fixup_t *fixup = &fixups[(*n_fixups)++];
+		fixup->offset = pos;
+		fixup->type   = reloc;
+		fixup->entity = field->entity;
+		fixup->addend = value;
+		/* the addend is completed once the instruction length is known */
+		value = 0;
+	}
+	for (unsigned i = 0; i < field->size; ++i)
+		buffer[pos + i] = (uint8_t)((uint64_t)value >> (8 * i));
+	return pos + field->size;
+}
+
+unsigned amd64_insn_encode(amd64_insn_t const *insn, uint8_t *buffer,
+                           amd64_fixup_t *fixups, unsigned *n_fixups)
+{
+	assert(insn->n_opcode > 0);
+	unsigned pos = 0;
+	if (insn->segment != 0)
+		buffer[pos++] = insn->segment;
+	for (unsigned i = 0; i < insn->n_prefixes; ++i)
+		buffer[pos++] = insn->prefixes[i];
+	bool const has_rex = insn->rex != 0 || insn->force_rex;
+	if (has_rex)
+		buffer[pos++] = REX_BASE | insn->rex;
+	for (unsigned i = 0; i < insn->n_opcode; ++i)
+		buffer[pos++] = insn->opcode[i];
+	if (insn->has_modrm)
+		buffer[pos++] = insn->modrm;
+	if (insn->has_sib)
+		buffer[pos++] = insn->sib;
+
+	*n_fixups = 0;
+	amd64_reloc_t disp_reloc = insn->disp.reloc;
+	if (disp_reloc == AMD64_RELOC_GOTPCREL)
+		disp_reloc = relax_gotpcrel(insn, has_rex);
+	pos = encode_field(buffer, pos, &insn->disp, fixups, n_fixups,
+	                   disp_reloc);
+	pos = encode_field(buffer, pos, &insn->imm, fixups, n_fixups,
+	                   insn->imm.reloc);
+	assert(pos <= AMD64_MAX_INSN_SIZE);
+
+	/* pc relative fields are relative to the end of the instruction */
+	for (unsigned i = 0; i < *n_fixups; ++i) {
+		amd64_fixup_t *fixup = &fixups[i];
+		if (amd64_reloc_is_pc_relative(fixup->type))
+			fixup->addend -= pos - fixup->offset;
+	}
+	return pos;
+}
+
+void amd64_create_nops(unsigned char *buffer, unsigned size)
+{
+	static const unsigned char nops[11][11] = {
+		{ 0x90 },
+		{ 0x66, 0x90 },
+		{ 0x0F, 0x1F, 0x00 },
+		{ 0x0F, 0x1F, 0x40, 0x00 },
+		{ 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+		{ 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+		{ 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },
+		{ 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+		{ 0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+		{ 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+		{ 0x66, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+	};
+	while (size > 0) {
+		unsigned const len = size < 11 ? size : 11;
+		memcpy(buffer, nops[len - 1], len);
+		buffer += len;
+		size   -= len;
+	}
+}
@@ -0,0 +1,128 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   x86-64 instruction encoder
+ *
+ * An instruction is described by its prefixes, opcode bytes, ModRM operands
+ * and immediate and then encoded in one go. The encoder picks the shortest
+ * displacement and the prefixes the same way GNU as does, so the result is
+ * byte for byte what the assembler produces for the textual instruction.
+ */
+#ifndef FIRM_BE_AMD64_AMD64_ENCODE_H
+#define FIRM_BE_AMD64_AMD64_ENCODE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "firm_types.h"
+
+/** The x86-64 ELF relocation types we produce. */
+typedef enum amd64_reloc_t {
+	AMD64_RELOC_NONE          = 0,
+	AMD64_RELOC_64            = 1,
+	AMD64_RELOC_PC32          = 2,
+	AMD64_RELOC_PLT32         = 4,
+	AMD64_RELOC_GOTPCREL      = 9,
+	AMD64_RELOC_32            = 10,
+	AMD64_RELOC_32S           = 11,
+	AMD64_RELOC_GOTPCRELX     = 41,
+	AMD64_RELOC_REX_GOTPCRELX = 42,
+	AMD64_RELOC_LAST          = AMD64_RELOC_REX_GOTPCRELX,
+} amd64_reloc_t;
+
+#define AMD64_NO_REG        0xFF
+#define AMD64_MAX_INSN_SIZE 15
+
+/** A memory operand. */
+typedef struct amd64_enc_addr_t {
+	uint8_t          base;      /**< base register or AMD64_NO_REG */
+	uint8_t          index;     /**< index register or AMD64_NO_REG */
+	uint8_t          log_scale;
+	uint8_t          segment;   /**< segment override prefix or 0 */
+	bool             rip;       /**< relative to the instruction pointer */
+	int32_t          disp;
+	ir_entity const *entity;    /**< symbol added to the displacement */
+	amd64_reloc_t    reloc;     /**< relocation type if entity is set */
+} amd64_enc_addr_t;
+
+/** An immediate or displacement field of an instruction. */
+typedef struct amd64_enc_field_t {
+	uint8_t          size;      /**< size in bytes, 0 if not present */
+	int64_t          value;
+	ir_entity const *entity;
+	amd64_reloc_t    reloc;
+} amd64_enc_field_t;
+
+/** An instruction under construction. */
+typedef struct amd64_insn_t {
+	uint8_t           segment;
+	uint8_t           n_prefixes;
+	uint8_t           prefixes[3];
+	uint8_t           rex;        /**< REX bits, 0 if no REX is needed */
+	bool              force_rex;  /**< access to spl, bpl, sil or dil */
+	uint8_t           n_opcode;
+	uint8_t           opcode[3];
+	bool              has_modrm;
+	uint8_t           modrm;
+	bool              has_sib;
+	uint8_t           sib;
+	amd64_enc_field_t disp;
+	amd64_enc_field_t imm;
+} amd64_insn_t;
+
+/** A relocation in an encoded instruction. */
+typedef struct amd64_fixup_t {
+	unsigned         offset;  /**< offset of the field in the instruction */
+	amd64_reloc_t    type;
+	ir_entity const *entity;
+	int64_t          addend;
+} amd64_fixup_t;
+
+void amd64_insn_init(amd64_insn_t *insn);
+
+/** Appends a legacy prefix (0x66, 0xF0, 0xF2, 0xF3). */
+void amd64_insn_prefix(amd64_insn_t *insn, uint8_t prefix);
+
+/** Appends an opcode byte. */
+void amd64_insn_opcode(amd64_insn_t *insn, uint8_t opcode);
+
+/** Sets REX.W for a 64bit operand size. */
+void amd64_insn_rex_w(amd64_insn_t *insn);
+
+/** Notes that the register @p reg is accessed as byte register. */
+void amd64_insn_byte_reg(amd64_insn_t *insn, unsigned reg);
+
+/** Adds @p reg to the low bits of the last opcode byte (like push %reg). */
+void amd64_insn_opcode_reg(amd64_insn_t *insn, unsigned reg);
+
+/** Adds a ModRM byte for the register operands @p reg and @p rm. */
+void amd64_insn_modrm_reg(amd64_insn_t *insn, unsigned reg, unsigned rm);
+
+/** Adds ModRM, SIB and displacement for the memory operand @p addr. */
+void amd64_insn_modrm_mem(amd64_insn_t *insn, unsigned reg,
+                          amd64_enc_addr_t const *addr);
+
+/** Adds an immediate of @p size bytes. */
+void amd64_insn_imm(amd64_insn_t *insn, unsigned size, int64_t value,
+                    ir_entity const *entity, amd64_reloc_t reloc);
+
+/**
+ * Encodes an instruction into @p buffer, which must have room for
+ * AMD64_MAX_INSN_SIZE bytes. The relocations are stored in @p fixups, which
+ * must have room for two entries.
+ *
+ * @return the length of the instruction
+ */
+unsigned amd64_insn_encode(amd64_insn_t const *insn, uint8_t *buffer,
+                           amd64_fixup_t *fixups, unsigned *n_fixups);
+
+/** Returns true if the relocation type is relative to the field address. */
+bool amd64_reloc_is_pc_relative(amd64_reloc_t reloc);
+
+/** Fills @p size bytes with the NOP instructions gas uses for padding. */
+void amd64_create_nops(unsigned char *buffer, unsigned size);
+
+#endif
@@ -7,22 +7,22 @@ $mode_x87   = "x86_mode_E";
 
 %reg_classes = (
 	gp => [
-		{ name => "rax", dwarf => 0 },
-		{ name => "rcx", dwarf => 2 },
-		{ name => "rdx", dwarf => 1 },
-		{ name => "rsi", dwarf => 4 },
-		{ name => "rdi", dwarf => 5 },
-		{ name => "rbx", dwarf => 3 },
-		{ name => "rbp", dwarf => 6 },
-		{ name => "rsp", dwarf => 7 },
-		{ name => "r8",  dwarf => 8 },
-		{ name => "r9",  dwarf => 9 },
-		{ name => "r10", dwarf => 10 },
-		{ name => "r11", dwarf => 11 },
-		{ name => "r12", dwarf => 12 },
-		{ name => "r13", dwarf => 13 },
-		{ name => "r14", dwarf => 14 },
-		{ name => "r15", dwarf => 15 },
+		{ name => "rax", encoding =>  0, dwarf => 0 },
+		{ name => "rcx", encoding =>  1, dwarf => 2 },
+		{ name => "rdx", encoding =>  2, dwarf => 1 },
+		{ name => "rsi", encoding =>  6, dwarf => 4 },
+		{ name => "rdi", encoding =>  7, dwarf => 5 },
+		{ name => "rbx", encoding =>  3, dwarf => 3 },
+		{ name => "rbp", encoding =>  5, dwarf => 6 },
+		{ name => "rsp", encoding =>  4, dwarf => 7 },
+		{ name => "r8",  encoding =>  8, dwarf => 8 },
+		{ name => "r9",  encoding =>  9, dwarf => 9 },
+		{ name => "r10", encoding => 10, dwarf => 10 },
+		{ name => "r11", encoding => 11, dwarf => 11 },
+		{ name => "r12", encoding => 12, dwarf => 12 },
+		{ name => "r13", encoding => 13, dwarf => 13 },
+		{ name => "r14", encoding => 14, dwarf => 14 },
+		{ name => "r15", encoding => 15, dwarf => 15 },
 		{ mode => $mode_gp }
 	],
 	flags => [
@@ -814,7 +814,7 @@ fmul => {
 
 fsub => {
 	template => $x87binop,
-	emit     => "fadd%FR%FP %AF",
+	emit     => "fsub%FR%FP %AF",
 },
 
 fchs => {
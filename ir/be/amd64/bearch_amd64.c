@@ -662,6 +662,8 @@ static void amd64_generate_code(FILE *output, const char *cup_name)
 {
 	amd64_constants = pmap_create();
 	be_begin(output, cup_name);
+	if (be_options.emit_object)
+		be_elf_begin(output, cup_name, &amd64_elf_target);
 	unsigned *const sp_is_non_ssa = rbitset_malloc(N_AMD64_REGISTERS);
 	rbitset_set(sp_is_non_ssa, REG_RSP);
 
@@ -686,6 +688,8 @@ static void amd64_generate_code(FILE *output, const char *cup_name)
 		be_step_last(irg);
 	}
 
+	if (be_options.emit_object)
+		be_elf_finish();
 	be_finish();
 	pmap_destroy(amd64_constants);
 }
@@ -823,6 +827,7 @@ static arch_isa_if_t const amd64_isa_if = {
 	.is_valid_clobber      = amd64_is_valid_clobber,
 	.handle_intrinsics     = amd64_handle_intrinsics,
 	.get_op_estimated_cost = amd64_get_op_estimated_cost,
+	.can_emit_object       = true,
 };
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_amd64)
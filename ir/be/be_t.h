@@ -18,7 +18,7 @@
 #include "be_types.h"
 #include "firm_types.h"
 #include "pmap.h"
-#include "timing.h"
+#include "timing_t.h"
 #include "irdump.h"
 
 extern arch_isa_if_t const *isa_if;
@@ -39,11 +39,15 @@ struct be_options_t {
 	bool timing;               /**< time the backend phases */
 	bool opt_profile_generate; /**< instrument code for profiling */
 	bool opt_profile_use;      /**< use existing profile data */
+	bool opt_profile_atomic;   /**< increment profile counters atomically */
+	bool opt_split_cold;       /**< emit rarely executed blocks separately */
+	bool opt_order_functions;  /**< order functions by call affinity */
 	bool omit_fp;              /**< try to omit the frame pointer */
 	bool pic;                  /**< create position independent code */
 	bool do_verify;            /**< backend verify option */
 	char ilp_solver[128];      /**< the ilp solver name */
 	bool verbose_asm;          /**< dump verbose assembler */
+	bool emit_object;          /**< write an object file instead of assembler */
 };
 extern be_options_t be_options;
 
@@ -107,9 +111,14 @@ typedef enum {
 ENUM_COUNTABLE(be_timer_id_t)
 extern ir_timer_t *be_timers[T_LAST+1];
 
+/** Returns the name of a backend timer, which is also its pass name. */
+const char *be_get_timer_name(be_timer_id_t id);
+
 static inline void be_timer_push(be_timer_id_t id)
 {
 	assert(id <= T_LAST);
+	if (ir_pass_timing_enabled)
+		do_ir_pass_begin(NULL, be_get_timer_name(id));
 	if (!be_timing)
 		return;
 	ir_timer_push(be_timers[id]);
@@ -118,6 +127,8 @@ static inline void be_timer_push(be_timer_id_t id)
 static inline void be_timer_pop(be_timer_id_t id)
 {
 	assert(id <= T_LAST);
+	if (ir_pass_timing_enabled)
+		do_ir_pass_end(be_get_timer_name(id));
 	if (!be_timing)
 		return;
 	ir_timer_pop(be_timers[id]);
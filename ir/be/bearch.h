@@ -311,6 +311,12 @@ struct arch_isa_if_t {
 	 * number of cycles necessary to execute the instruction.
 	 */
 	unsigned (*get_op_estimated_cost)(const ir_node *irn);
+
+	/**
+	 * True if generate_code() can write an object file instead of assembler,
+	 * see be_options_t.emit_object.
+	 */
+	bool can_emit_object;
 };
 
 static inline bool arch_irn_is_ignore(const ir_node *irn)
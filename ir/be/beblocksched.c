@@ -18,6 +18,10 @@
  * to change as many edges to fallthroughs as possible, this is done by setting
  * a next and prev pointers on blocks. The greedy algorithm sorts the edges by
  * execution frequencies and tries to transform them to fallthroughs in this order
+ *
+ * With be_options.opt_split_cold, rarely executed blocks are moved behind all
+ * other blocks afterwards, so the emitter can put them into a separate
+ * section.
  */
 #include "beblocksched.h"
 
@@ -41,8 +45,12 @@
 #include "bemodule.h"
 #include "besched.h"
 #include "be.h"
+#include "be_t.h"
 #include "panic.h"
 
+/** Blocks executed less often than this per function call are cold. */
+#define COLD_EXECFREQ 0.0001
+
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
 static bool blocks_removed;
@@ -551,6 +559,43 @@ static ir_node **create_blocksched_array(blocksched_env_t *const env)
 	return block_list;
 }
 
+bool be_is_cold_block(const ir_node *block)
+{
+	return be_options.opt_split_cold
+	    && block != get_irg_start_block(get_irn_irg(block))
+	    && get_block_execfreq(block) < COLD_EXECFREQ;
+}
+
+size_t be_get_n_hot_blocks(ir_node *const *block_list)
+{
+	size_t n = ARR_LEN(block_list);
+	while (n > 0 && be_is_cold_block(block_list[n - 1]))
+		--n;
+	return n;
+}
+
+/**
+ * Moves the cold blocks behind the others, keeping the order of the hot and
+ * of the cold blocks.
+ */
+static void move_cold_blocks(ir_node **block_list, struct obstack *obst)
+{
+	size_t    const n    = ARR_LEN(block_list);
+	ir_node **const cold = OALLOCN(obst, ir_node*, n);
+	size_t          n_hot  = 0;
+	size_t          n_cold = 0;
+	for (size_t i = 0; i < n; ++i) {
+		ir_node *const block = block_list[i];
+		if (be_is_cold_block(block)) {
+			cold[n_cold++] = block;
+		} else {
+			block_list[n_hot++] = block;
+		}
+	}
+	MEMCPY(block_list + n_hot, cold, n_cold);
+	DB((dbg, LEVEL_1, "%zu cold blocks\n", n_cold));
+}
+
 ir_node **be_create_block_schedule(ir_graph *irg)
 {
 	blocksched_env_t env;
@@ -572,6 +617,8 @@ ir_node **be_create_block_schedule(ir_graph *irg)
 
 	ir_node **const block_list = create_blocksched_array(&env);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	if (be_options.opt_split_cold)
+		move_cold_blocks(block_list, &env.obst);
 
 	DEL_ARR_F(env.edges);
 	obstack_free(&env.obst, NULL);
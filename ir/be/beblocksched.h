@@ -12,8 +12,23 @@
 #ifndef FIRM_BE_BEBLOCKSCHED_H
 #define FIRM_BE_BEBLOCKSCHED_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "firm_types.h"
 
 ir_node **be_create_block_schedule(ir_graph *irg);
 
+/**
+ * Returns whether @p block is executed so rarely that it is placed behind
+ * all other blocks of the schedule (only with be_options.opt_split_cold).
+ */
+bool be_is_cold_block(const ir_node *block);
+
+/**
+ * Returns the number of blocks at the start of a block schedule, which are
+ * not cold. The remaining blocks are cold.
+ */
+size_t be_get_n_hot_blocks(ir_node *const *block_list);
+
 #endif
@@ -68,11 +68,16 @@ enum {
 	/* lower perm options */
 	BE_CH_LOWER_PERM_SWAP   = 1,
 	BE_CH_LOWER_PERM_COPY   = 2,
+
+	/* interference graph flavors */
+	BE_CH_IFG_IMPLICIT      = 1,
+	BE_CH_IFG_EXPLICIT      = 2,
 };
 
 struct be_ra_chordal_opts_t {
 	unsigned dump_flags;
 	int      lower_perm_opt;
+	int      ifg_flavor;
 };
 
 void be_chordal_dump(unsigned mask, ir_graph *irg, arch_register_class_t const *cls, char const *suffix);
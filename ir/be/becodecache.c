@@ -0,0 +1,267 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Persistent cache for the assembler code of graphs.
+ */
+#ifndef _WIN32
+/* getpid() */
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "be_t.h"
+#include "becodecache.h"
+#include "bediagnostic.h"
+#include "bedwarf.h"
+#include "beemitter.h"
+#include "begnuas.h"
+#include "firm_common.h"
+#include "bemodule.h"
+#include "irio_t.h"
+#include "irprog_t.h"
+#include "irtools.h"
+#include "lc_opts.h"
+#include "obst.h"
+#include "statev_t.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
+
+/** Start of each cache entry, change it when the format changes. */
+#define CACHE_MAGIC       "FIRMCC1\n"
+#define CACHE_MAGIC_SIZE  8
+
+typedef struct cache_hash_t {
+	uint64_t h1;
+	uint64_t h2;
+} cache_hash_t;
+
+static char            cache_dir[1024];
+static char           *options;     /**< all backend options so far */
+static size_t          options_len;
+static bool            enabled;     /**< cache used for the current unit */
+static bool            recording;   /**< current graph is recorded */
+static long            first_backend_nr;
+static cache_hash_t    unit_hash;   /**< hash of options and version */
+static char            key[33];     /**< key of the current graph */
+static char            prefix[20];  /**< label prefix of the current graph */
+static unsigned        n_hits;
+static unsigned        n_misses;
+static unsigned        n_uncacheable;
+
+/**
+ * Adds bytes to a hash. The two lanes are FNV-1a and a multiplicative hash
+ * with a different prime, together they make collisions unlikely enough for
+ * a cache shared by many builds.
+ */
+static void hash_bytes(cache_hash_t *hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char*)data;
+	uint64_t             h1    = hash->h1;
+	uint64_t             h2    = hash->h2;
+	for (size_t i = 0; i < size; ++i) {
+		h1  = (h1 ^ bytes[i]) * UINT64_C(0x100000001B3);
+		h2  = (h2 + bytes[i]) * UINT64_C(0xFF51AFD7ED558CCD);
+		h2 ^= h2 >> 29;
+	}
+	hash->h1 = h1;
+	hash->h2 = h2;
+}
+
+static void hash_string(cache_hash_t *hash, const char *str)
+{
+	/* include the '\0' to separate the strings */
+	hash_bytes(hash, str, strlen(str) + 1);
+}
+
+void be_code_cache_add_option(const char *arg)
+{
+	/* keep the '\0' to separate the options */
+	size_t const len = strlen(arg) + 1;
+	options = XREALLOC(options, char, options_len + len);
+	memcpy(options + options_len, arg, len);
+	options_len += len;
+}
+
+void be_code_cache_begin(void)
+{
+	enabled = cache_dir[0] != '\0'
+	       /* objects files are written without the gas emitter */
+	       && !be_options.emit_object
+	       /* debug information and profiles are shared by the whole unit */
+	       && !be_dwarf_enabled()
+	       && !be_options.opt_profile_generate
+	       && !be_options.opt_profile_use;
+	if (!enabled)
+		return;
+
+	/* everything created from now on was created by the backend */
+	first_backend_nr = irp->max_node_nr;
+	n_hits           = 0;
+	n_misses         = 0;
+	n_uncacheable    = 0;
+
+	unit_hash.h1 = UINT64_C(0xCBF29CE484222325);
+	unit_hash.h2 = UINT64_C(0x9E3779B97F4A7C15);
+	hash_string(&unit_hash, CACHE_MAGIC);
+	hash_string(&unit_hash, ir_get_version_revision());
+	hash_string(&unit_hash, ir_get_version_build());
+	unsigned const version[] = {
+		ir_get_version_major(), ir_get_version_minor(),
+	};
+	hash_bytes(&unit_hash, version, sizeof(version));
+	hash_bytes(&unit_hash, options, options_len);
+}
+
+void be_code_cache_end(void)
+{
+	if (!enabled)
+		return;
+	assert(!recording);
+	if (stat_ev_enabled) {
+		stat_ev_ull("bemain_code_cache_hits",        n_hits);
+		stat_ev_ull("bemain_code_cache_misses",      n_misses);
+		stat_ev_ull("bemain_code_cache_uncacheable", n_uncacheable);
+	}
+	enabled = false;
+}
+
+static char *get_entry_path(const char *suffix)
+{
+	size_t const len  = strlen(cache_dir) + 1 + sizeof(key) + strlen(suffix)
+	                  + 16;
+	char  *const path = XMALLOCN(char, len);
+	snprintf(path, len, "%s/%s%s", cache_dir, key, suffix);
+	return path;
+}
+
+/**
+ * Reads the cache entry of the current key and emits its code.
+ */
+static bool emit_entry(void)
+{
+	char *const path = get_entry_path("");
+	FILE *const file = fopen(path, "rb");
+	free(path);
+	if (file == NULL)
+		return false;
+
+	bool  res  = false;
+	char *data = NULL;
+	if (fseek(file, 0, SEEK_END) != 0)
+		goto end;
+	long const size = ftell(file);
+	if (size < CACHE_MAGIC_SIZE || fseek(file, 0, SEEK_SET) != 0)
+		goto end;
+	data = XMALLOCN(char, size);
+	if (fread(data, 1, size, file) != (size_t)size
+	    || memcmp(data, CACHE_MAGIC, CACHE_MAGIC_SIZE) != 0)
+		goto end;
+
+	be_emit_string_len(data + CACHE_MAGIC_SIZE, size - CACHE_MAGIC_SIZE);
+	be_emit_write_line();
+	res = true;
+end:
+	free(data);
+	fclose(file);
+	return res;
+}
+
+bool be_code_cache_lookup(ir_graph *irg)
+{
+	if (!enabled)
+		return false;
+
+	struct obstack obst;
+	obstack_init(&obst);
+	ir_write_canonical_irg(&obst, irg);
+	cache_hash_t hash = unit_hash;
+	hash_bytes(&hash, obstack_base(&obst), obstack_object_size(&obst));
+	obstack_free(&obst, NULL);
+
+	snprintf(key, sizeof(key), "%016" PRIx64 "%016" PRIx64, hash.h1, hash.h2);
+	if (emit_entry()) {
+		++n_hits;
+		return true;
+	}
+
+	++n_misses;
+	recording = true;
+	/* the graph is part of the hash, so the prefix is unique in the unit */
+	snprintf(prefix, sizeof(prefix), "F%016" PRIx64 "_", hash.h1);
+	be_gas_begin_standalone(prefix, first_backend_nr);
+	return false;
+}
+
+static void write_piece(const char *data, size_t len, void *env)
+{
+	fwrite(data, 1, len, (FILE*)env);
+}
+
+void be_code_cache_store(void)
+{
+	if (!recording)
+		return;
+	recording = false;
+	if (!be_gas_end_standalone()) {
+		++n_uncacheable;
+		return;
+	}
+
+	/* write a temporary file first, so concurrent compilations never see a
+	 * partial entry */
+	char  suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%ld.tmp", (long)getpid());
+	char *const tmp_path = get_entry_path(suffix);
+	char *const path     = get_entry_path("");
+	FILE *const file     = fopen(tmp_path, "wb");
+	if (file == NULL) {
+		be_warningf(NULL, "cannot write code cache entry \"%s\": %s",
+		            tmp_path, strerror(errno));
+		/* do not try again for every graph */
+		enabled = false;
+		goto end;
+	}
+	fwrite(CACHE_MAGIC, 1, CACHE_MAGIC_SIZE, file);
+	be_emit_walk_buffer(write_piece, file);
+	bool const failed = ferror(file);
+	if (fclose(file) != 0 || failed || rename(tmp_path, path) != 0)
+		remove(tmp_path);
+end:
+	free(path);
+	free(tmp_path);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_codecache)
+void be_init_codecache(void)
+{
+	static const lc_opt_table_entry_t codecache_options[] = {
+		LC_OPT_ENT_STR("codecache", "directory of the code cache", &cache_dir),
+		LC_OPT_LAST
+	};
+	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_add_table(be_grp, codecache_options);
+}
+
+BE_REGISTER_MODULE_DESTRUCTOR(be_quit_codecache)
+void be_quit_codecache(void)
+{
+	free(options);
+	options     = NULL;
+	options_len = 0;
+}
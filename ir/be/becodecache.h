@@ -0,0 +1,53 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Persistent cache for the assembler code of graphs.
+ *
+ * The code emitted for a graph is stored in a directory (option
+ * -b codecache=DIR). An entry is keyed by a hash of the canonical form of
+ * the graph (see ir_write_canonical_irg()), the backend options and the
+ * libFirm version. When the same graph is compiled again, its code is copied
+ * from the cache instead of running instruction selection, scheduling and
+ * register allocation.
+ */
+#ifndef FIRM_BE_BECODECACHE_H
+#define FIRM_BE_BECODECACHE_H
+
+#include <stdbool.h>
+
+#include "firm_types.h"
+
+/**
+ * Records a backend option, all options are part of the cache keys.
+ */
+void be_code_cache_add_option(const char *arg);
+
+/**
+ * Starts using the code cache for a compilation unit. Has to be called after
+ * the graphs were prepared for the backend.
+ */
+void be_code_cache_begin(void);
+
+/**
+ * Ends using the code cache for a compilation unit.
+ */
+void be_code_cache_end(void);
+
+/**
+ * Looks up the code of @p irg in the cache. On a hit the code is emitted and
+ * true is returned. Otherwise the code produced for the graph is recorded and
+ * stored by be_code_cache_store().
+ */
+bool be_code_cache_lookup(ir_graph *irg);
+
+/**
+ * Stores the code emitted for the graph of the last be_code_cache_lookup()
+ * miss. Has to be called before the output buffer of the graph is flushed.
+ */
+void be_code_cache_store(void);
+
+#endif
@@ -84,7 +84,7 @@ static inline bool sr_is_simplicial(ilp_env_t *const ienv, ir_node const *const
 
 		/* Check whether the current node forms a clique with all previous nodes. */
 		for (size_t i = ARR_LEN(all); i-- != 0;) {
-			if (!be_values_interfere(curr, all[i])) {
+			if (!be_ifg_interferes(ienv->co->cenv->ifg, curr, all[i])) {
 				res = false;
 				goto end;
 			}
@@ -222,6 +222,8 @@ lpp_sol_state_t ilp_go(ilp_env_t *const ienv)
 	//stat_ev_dbl("co_ilp_best_bound", ienv->lp->best_bound);
 	stat_ev_int("co_ilp_iter",       lpp_get_iter_cnt(ienv->lp));
 	stat_ev_dbl("co_ilp_sol_time",   lpp_get_sol_time(ienv->lp));
+	if (lpp_is_sol_valid(ienv->lp))
+		stat_ev_dbl("co_ilp_gap",    lpp_get_mip_gap(ienv->lp));
 
 	ienv->apply(ienv);
 
@@ -265,8 +265,9 @@ static int co_get_costs_all_one(const ir_node *root, int pos)
  * Determines a maximum weighted independent set with respect to
  * the interference and conflict edges of all nodes in a qnode.
  */
-static int ou_max_ind_set_costs(unit_t *const ou)
+static int ou_max_ind_set_costs(copy_opt_t const *const co, unit_t *const ou)
 {
+	be_ifg_t const *const ifg = co->cenv->ifg;
 	/* assign the nodes into two groups.
 	 * safe: node has no interference, hence it is in every max stable set.
 	 * unsafe: node has an interference */
@@ -283,7 +284,7 @@ static int ou_max_ind_set_costs(unit_t *const ou)
 			ir_node *o_node = ou->nodes[o];
 			if (i_node == o_node)
 				continue;
-			if (be_values_interfere(i_node, o_node)) {
+			if (be_ifg_interferes(ifg, i_node, o_node)) {
 				unsafe_costs[unsafe_count] = ou->costs[i];
 				unsafe[unsafe_count] = i_node;
 				++unsafe_count;
@@ -306,7 +307,7 @@ static int ou_max_ind_set_costs(unit_t *const ou)
 			bitset_set(best, i);
 			/* check if it is a stable set */
 			for (int o=bitset_next_set(best, 0); o!=-1 && o<i; o=bitset_next_set(best, o+1))
-				if (be_values_interfere(unsafe[i], unsafe[o])) {
+				if (be_ifg_interferes(ifg, unsafe[i], unsafe[o])) {
 					bitset_clear(best, i); /* clear the bit and try next one */
 					break;
 				}
@@ -322,7 +323,7 @@ static int ou_max_ind_set_costs(unit_t *const ou)
 			/* check if curr is a stable set */
 			for (int i=bitset_next_set(curr, 0); i!=-1; i=bitset_next_set(curr, i+1))
 				for (int o=bitset_next_set(curr, i+1); o!=-1; o=bitset_next_set(curr, o+1)) /* !!!!! difference to qnode_max_ind_set(): NOT (curr, i) */
-						if (be_values_interfere(unsafe[i], unsafe[o]))
+						if (be_ifg_interferes(ifg, unsafe[i], unsafe[o]))
 							goto no_stable_set;
 
 			/* if we arrive here, we have a stable set */
@@ -373,7 +374,7 @@ static void co_collect_units(ir_node *irn, void *env)
 			assert(arch_get_irn_register_req(arg)->cls == co->cls && "Argument not in same register class.");
 			if (arg == irn)
 				continue;
-			if (be_values_interfere(irn, arg)) {
+			if (be_ifg_interferes(co->cenv->ifg, irn, arg)) {
 				unit->inevitable_costs += co->get_costs(irn, i);
 				continue;
 			}
@@ -424,7 +425,7 @@ static void co_collect_units(ir_node *irn, void *env)
 				ir_node *o = get_irn_n(skip_Proj(irn), i);
 				if (arch_irn_is_ignore(o))
 					continue;
-				if (be_values_interfere(irn, o))
+				if (be_ifg_interferes(co->cenv->ifg, irn, o))
 					continue;
 				++count;
 			}
@@ -442,7 +443,7 @@ static void co_collect_units(ir_node *irn, void *env)
 				if (other & (1U << i)) {
 					ir_node *o = get_irn_n(skip_Proj(irn), i);
 					if (!arch_irn_is_ignore(o) &&
-							!be_values_interfere(irn, o)) {
+							!be_ifg_interferes(co->cenv->ifg, irn, o)) {
 						unit->nodes[k] = o;
 						unit->costs[k] = co->get_costs(irn, -1);
 						++k;
@@ -463,7 +464,7 @@ static void co_collect_units(ir_node *irn, void *env)
 		}
 
 		/* Determine the minimal costs this unit will cause: min_nodes_costs */
-		unit->min_nodes_costs += unit->all_nodes_costs - ou_max_ind_set_costs(unit);
+		unit->min_nodes_costs += unit->all_nodes_costs - ou_max_ind_set_costs(co, unit);
 		/* Insert the new ou according to its sort_key */
 		struct list_head *tmp = &co->units;
 		while (tmp->next != &co->units
@@ -534,7 +535,7 @@ static void co_complete_stats(const copy_opt_t *co, co_complete_stats_t *stat)
 					stat->unsatisfied_edges += 1;
 				}
 
-				if (be_values_interfere(an->irn, neigh->irn)) {
+				if (be_ifg_interferes(co->cenv->ifg, an->irn, neigh->irn)) {
 					stat->aff_int += 1;
 					stat->inevit_costs += neigh->costs;
 				}
@@ -586,7 +587,7 @@ static void add_edge(copy_opt_t *co, ir_node *n1, ir_node *n2, int costs)
 
 static inline void add_edges(copy_opt_t *co, ir_node *n1, ir_node *n2, int costs)
 {
-	if (n1 != n2 && !be_values_interfere(n1, n2)) {
+	if (n1 != n2 && !be_ifg_interferes(co->cenv->ifg, n1, n2)) {
 		add_edge(co, n1, n2, costs);
 		add_edge(co, n2, n1, costs);
 	}
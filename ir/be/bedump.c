@@ -113,14 +113,12 @@ static const char *lv_flags_to_str(unsigned flags)
 
 void be_dump_liveness_block(be_lv_t *lv, FILE *F, const ir_node *bl)
 {
-	be_lv_info_t *info = ir_nodehashmap_get(be_lv_info_t, &lv->map, bl);
+	be_lv_state_t const all = be_lv_state_in | be_lv_state_end | be_lv_state_out;
 
 	fprintf(F, "liveness:\n");
-	if (info != NULL) {
-		for (unsigned i = 0, n = info->n_members; i < n; ++i) {
-			be_lv_info_node_t *const n = &info->nodes[i];
-			ir_fprintf(F, "%s %+F\n", lv_flags_to_str(n->flags), n->node);
-		}
+	be_lv_foreach(lv, bl, all, node) {
+		be_lv_state_t const flags = be_get_live_state(lv, bl, node);
+		ir_fprintf(F, "%s %+F\n", lv_flags_to_str(flags), node);
 	}
 }
 
@@ -11,6 +11,8 @@
 #ifndef FIRM_BE_BEDWARF_H
 #define FIRM_BE_BEDWARF_H
 
+#include <stdbool.h>
+
 #include "be_types.h"
 
 typedef struct parameter_dbg_info_t {
@@ -18,6 +20,11 @@ typedef struct parameter_dbg_info_t {
 	const arch_register_t *reg;
 } parameter_dbg_info_t;
 
+/**
+ * Returns true if debug information is emitted.
+ */
+bool be_dwarf_enabled(void);
+
 /** initialize and open debug handle */
 void be_dwarf_open(void);
 
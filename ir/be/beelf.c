@@ -0,0 +1,1001 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes relocatable ELF64 object files.
+ */
+#include <string.h>
+
+#include "array.h"
+#include "be_t.h"
+#include "bearch.h"
+#include "beelf.h"
+#include "entity_t.h"
+#include "irnode_t.h"
+#include "irprog_t.h"
+#include "obst.h"
+#include "panic.h"
+#include "pmap.h"
+#include "tv.h"
+#include "util.h"
+#include "xmalloc.h"
+
+/* the parts of the ELF specification we need */
+#define ELF_EHDR_SIZE   64
+#define ELF_SHDR_SIZE   64
+#define ELF_SYM_SIZE    24
+#define ELF_RELA_SIZE   24
+
+#define SHT_PROGBITS    1
+#define SHT_SYMTAB      2
+#define SHT_STRTAB      3
+#define SHT_RELA        4
+#define SHT_NOBITS      8
+
+#define SHF_WRITE       0x1
+#define SHF_ALLOC       0x2
+#define SHF_EXECINSTR   0x4
+#define SHF_INFO_LINK   0x40
+
+#define SHN_ABS         0xfff1
+#define SHN_COMMON      0xfff2
+
+#define STB_LOCAL       0
+#define STB_GLOBAL      1
+#define STB_WEAK        2
+
+#define STT_SECTION     3
+#define STT_FILE        4
+
+#define STV_DEFAULT     0
+#define STV_HIDDEN      2
+#define STV_PROTECTED   3
+
+typedef struct elf_symbol_t elf_symbol_t;
+
+typedef struct elf_reloc_t {
+	uint64_t          offset;
+	unsigned          type;
+	elf_symbol_t     *symbol;  /**< the target symbol or NULL */
+	be_elf_section_t *section; /**< the target section if symbol is NULL */
+	int64_t           addend;
+} elf_reloc_t;
+
+struct be_elf_section_t {
+	char const    *name;
+	uint32_t       type;
+	uint32_t       flags;
+	unsigned       alignment;
+	unsigned       size;
+	unsigned char *data;       /**< the contents, NULL for SHT_NOBITS */
+	elf_reloc_t   *relocs;     /**< flexible array of relocations */
+	unsigned       index;      /**< section header index */
+	unsigned       symbol;     /**< symbol table index of the section symbol */
+};
+
+struct elf_symbol_t {
+	ir_entity const      *entity;
+	be_elf_section_t     *section;  /**< NULL while undefined */
+	elf_symbol_t const   *alias;    /**< the aliased symbol or NULL */
+	uint64_t              value;
+	uint64_t              size;
+	be_elf_symbol_type_t  type;
+	bool                  common;
+	bool                  needed;   /**< private, but referenced by name */
+	unsigned              index;    /**< symbol table index */
+};
+
+typedef struct elf_section_info_t {
+	char const *name;
+	uint32_t    type;
+	uint32_t    flags;
+} elf_section_info_t;
+
+static elf_section_info_t const section_infos[] = {
+	[GAS_SECTION_TEXT]         = { ".text",   SHT_PROGBITS,   SHF_ALLOC|SHF_EXECINSTR },
+	[GAS_SECTION_DATA]         = { ".data",   SHT_PROGBITS,   SHF_ALLOC|SHF_WRITE     },
+	[GAS_SECTION_RODATA]       = { ".rodata", SHT_PROGBITS,   SHF_ALLOC               },
+	[GAS_SECTION_REL_RO]       = { ".data.rel.ro", SHT_PROGBITS, SHF_ALLOC|SHF_WRITE  },
+	[GAS_SECTION_REL_RO_LOCAL] = { ".data.rel.ro.local", SHT_PROGBITS, SHF_ALLOC|SHF_WRITE },
+	[GAS_SECTION_BSS]          = { ".bss",    SHT_NOBITS,     SHF_ALLOC|SHF_WRITE     },
+	[GAS_SECTION_CONSTRUCTORS] = { ".ctors",  SHT_PROGBITS,   SHF_ALLOC|SHF_WRITE     },
+	[GAS_SECTION_DESTRUCTORS]  = { ".dtors",  SHT_PROGBITS,   SHF_ALLOC|SHF_WRITE     },
+	[GAS_SECTION_JCR]          = { ".jcr",    SHT_PROGBITS,   SHF_ALLOC|SHF_WRITE     },
+};
+
+static FILE                  *output;
+static char const            *unit_name;
+static be_elf_target_t const *target;
+static struct obstack         obst;
+static be_elf_section_t      *sections[ARRAY_SIZE(section_infos)];
+static be_elf_section_t     **section_order;
+static pmap                  *entity_symbols;
+static elf_symbol_t         **symbols;
+
+void be_elf_begin(FILE *const file, char const *const cup_name,
+                  be_elf_target_t const *const elf_target)
+{
+	if (be_get_backend_param()->byte_order_big_endian)
+		panic("object file output only supports little endian targets");
+
+	output         = file;
+	unit_name      = cup_name;
+	target         = elf_target;
+	obstack_init(&obst);
+	memset(sections, 0, sizeof(sections));
+	section_order  = NEW_ARR_F(be_elf_section_t*, 0);
+	entity_symbols = pmap_create();
+	symbols        = NEW_ARR_F(elf_symbol_t*, 0);
+
+	if (get_irp_n_asms() > 0)
+		panic("global asm statements not supported in object file output");
+
+	/* like gas we always have these */
+	be_elf_get_section(GAS_SECTION_TEXT);
+	be_elf_get_section(GAS_SECTION_DATA);
+	be_elf_get_section(GAS_SECTION_BSS);
+}
+
+be_elf_section_t *be_elf_get_section(be_gas_section_t const kind)
+{
+	if (kind & ~GAS_SECTION_TYPE_MASK)
+		panic("TLS and COMDAT sections not supported in object file output");
+	if (kind >= ARRAY_SIZE(section_infos) || section_infos[kind].name == NULL)
+		panic("section %d not supported in object file output", (int)kind);
+
+	be_elf_section_t *section = sections[kind];
+	if (section == NULL) {
+		elf_section_info_t const *const info = &section_infos[kind];
+		section = OALLOCZ(&obst, be_elf_section_t);
+		section->name      = info->name;
+		section->type      = info->type;
+		section->flags     = info->flags;
+		section->alignment = 1;
+		section->relocs    = NEW_ARR_F(elf_reloc_t, 0);
+		if (info->type != SHT_NOBITS)
+			section->data = NEW_ARR_F(unsigned char, 0);
+		sections[kind] = section;
+		ARR_APP1(be_elf_section_t*, section_order, section);
+	}
+	return section;
+}
+
+be_elf_section_t *be_elf_get_entity_section(ir_entity const *const entity)
+{
+	return be_elf_get_section(be_gas_determine_section(NULL, entity));
+}
+
+unsigned be_elf_get_size(be_elf_section_t const *const section)
+{
+	return section->size;
+}
+
+unsigned char *be_elf_grow(be_elf_section_t *const section,
+                           unsigned const size)
+{
+	unsigned const offset = section->size;
+	section->size += size;
+	if (section->data == NULL)
+		return NULL;
+	ARR_RESIZE(unsigned char, section->data, section->size);
+	memset(section->data + offset, 0, size);
+	return section->data + offset;
+}
+
+void be_elf_align(be_elf_section_t *const section, unsigned const alignment,
+                  be_elf_fill_func const fill)
+{
+	assert(is_po2(alignment));
+	if (alignment > section->alignment)
+		section->alignment = alignment;
+
+	unsigned const misalign = section->size & (alignment - 1);
+	if (misalign == 0)
+		return;
+	unsigned       const padding = alignment - misalign;
+	unsigned char *const buffer  = be_elf_grow(section, padding);
+	if (fill != NULL && buffer != NULL)
+		fill(buffer, padding);
+}
+
+static elf_symbol_t *get_symbol(ir_entity const *const entity)
+{
+	elf_symbol_t *symbol = pmap_get(elf_symbol_t, entity_symbols, entity);
+	if (symbol == NULL) {
+		symbol = OALLOCZ(&obst, elf_symbol_t);
+		symbol->entity = entity;
+		pmap_insert(entity_symbols, entity, symbol);
+		ARR_APP1(elf_symbol_t*, symbols, symbol);
+	}
+	return symbol;
+}
+
+void be_elf_define_entity(ir_entity const *const entity,
+                          be_elf_section_t *const section,
+                          unsigned const offset, unsigned const size,
+                          be_elf_symbol_type_t const type)
+{
+	elf_symbol_t *const symbol = get_symbol(entity);
+	if (symbol->section != NULL || symbol->common || symbol->alias != NULL)
+		panic("entity %+F defined twice", entity);
+	symbol->section = section;
+	symbol->value   = offset;
+	symbol->size    = size;
+	symbol->type    = type;
+}
+
+static elf_reloc_t *new_reloc(be_elf_section_t *const section,
+                              unsigned const offset, unsigned const type,
+                              int64_t const addend)
+{
+	assert(type < target->n_relocs && target->relocs[type].size != 0);
+	assert(offset + target->relocs[type].size <= section->size);
+	elf_reloc_t const reloc = {
+		.offset = offset,
+		.type   = type,
+		.addend = addend,
+	};
+	ARR_APP1(elf_reloc_t, section->relocs, reloc);
+	return &section->relocs[ARR_LEN(section->relocs) - 1];
+}
+
+void be_elf_add_reloc(be_elf_section_t *const section, unsigned const offset,
+                      unsigned const type, ir_entity const *const entity,
+                      int64_t const addend)
+{
+	elf_reloc_t *const reloc = new_reloc(section, offset, type, addend);
+	reloc->symbol = get_symbol(entity);
+}
+
+void be_elf_add_section_reloc(be_elf_section_t *const section,
+                              unsigned const offset, unsigned const type,
+                              be_elf_section_t *const target_section,
+                              int64_t const addend)
+{
+	elf_reloc_t *const reloc = new_reloc(section, offset, type, addend);
+	reloc->section = target_section;
+}
+
+static bool is_private(ir_entity const *const entity)
+{
+	return get_entity_kind(entity) == IR_ENTITY_LABEL
+	    || get_entity_visibility(entity) == ir_visibility_private;
+}
+
+static unsigned char get_binding(ir_entity const *const entity)
+{
+	if (is_private(entity))
+		return STB_LOCAL;
+	if (get_entity_visibility(entity) == ir_visibility_local
+	    && entity_has_definition(entity))
+		return STB_LOCAL;
+	if (get_entity_linkage(entity) & IR_LINKAGE_WEAK)
+		return STB_WEAK;
+	return STB_GLOBAL;
+}
+
+static unsigned char get_visibility(ir_entity const *const entity)
+{
+	if (get_entity_kind(entity) == IR_ENTITY_LABEL)
+		return STV_DEFAULT;
+	switch (get_entity_visibility(entity)) {
+	case ir_visibility_external_private:   return STV_HIDDEN;
+	case ir_visibility_external_protected: return STV_PROTECTED;
+	case ir_visibility_external:
+	case ir_visibility_local:
+	case ir_visibility_private:
+		return STV_DEFAULT;
+	}
+	panic("invalid visibility");
+}
+
+/**
+ * Follows aliases to the symbol which determines the address.
+ */
+static elf_symbol_t const *get_address_symbol(elf_symbol_t const *symbol)
+{
+	while (symbol->alias != NULL)
+		symbol = symbol->alias;
+	return symbol;
+}
+
+/*
+ * Global variables.
+ */
+
+static void write_le(unsigned char *const buffer, uint64_t value,
+                     unsigned const size)
+{
+	for (unsigned i = 0; i < size; ++i) {
+		buffer[i] = value & 0xFF;
+		value >>= 8;
+	}
+}
+
+static uint64_t get_tarval_bits(ir_tarval *const tv)
+{
+	unsigned const size  = get_mode_size_bytes(get_tarval_mode(tv));
+	uint64_t       value = 0;
+	for (unsigned i = MIN(size, 8); i-- != 0;) {
+		value = (value << 8) | get_tarval_sub_bits(tv, i);
+	}
+	return value;
+}
+
+/**
+ * Evaluates an initializer expression to @p entity + @p value.
+ */
+static void eval_init_expression(ir_node const *const init,
+                                 ir_entity const **const entity,
+                                 int64_t *const value)
+{
+	switch (get_irn_opcode(init)) {
+	case iro_Conv:
+		eval_init_expression(get_Conv_op(init), entity, value);
+		return;
+
+	case iro_Const:
+		*entity = NULL;
+		*value  = (int64_t)get_tarval_bits(get_Const_tarval(init));
+		return;
+
+	case iro_Address:
+		*entity = get_Address_entity(init);
+		*value  = 0;
+		return;
+
+	case iro_Offset:
+		*entity = NULL;
+		*value  = get_entity_offset(get_Offset_entity(init));
+		return;
+
+	case iro_Align:
+		*entity = NULL;
+		*value  = get_type_alignment_bytes(get_Align_type(init));
+		return;
+
+	case iro_Size:
+		*entity = NULL;
+		*value  = get_type_size_bytes(get_Size_type(init));
+		return;
+
+	case iro_Add:
+	case iro_Sub:
+	case iro_Mul: {
+		ir_entity const *left_entity;
+		ir_entity const *right_entity;
+		int64_t          left;
+		int64_t          right;
+		eval_init_expression(get_binop_left(init), &left_entity, &left);
+		eval_init_expression(get_binop_right(init), &right_entity, &right);
+		if (is_Add(init) && (left_entity == NULL || right_entity == NULL)) {
+			*entity = left_entity != NULL ? left_entity : right_entity;
+			*value  = (int64_t)((uint64_t)left + (uint64_t)right);
+			return;
+		} else if (is_Sub(init) && right_entity == NULL) {
+			*entity = left_entity;
+			*value  = (int64_t)((uint64_t)left - (uint64_t)right);
+			return;
+		} else if (is_Mul(init) && left_entity == NULL
+		           && right_entity == NULL) {
+			*entity = NULL;
+			*value  = (int64_t)((uint64_t)left * (uint64_t)right);
+			return;
+		}
+		panic("initializer %+F not supported in object file output", init);
+	}
+
+	case iro_Unknown:
+		*entity = NULL;
+		*value  = 0;
+		return;
+
+	default:
+		panic("unsupported IR-node %+F", init);
+	}
+}
+
+static void write_tarval(be_elf_section_t *const section,
+                         unsigned const offset, ir_tarval *const tv,
+                         unsigned const size)
+{
+	unsigned char *const buffer = section->data + offset;
+	for (unsigned i = 0; i < size; ++i) {
+		buffer[i] = get_tarval_sub_bits(tv, i);
+	}
+}
+
+static void write_node_data(be_elf_section_t *const section,
+                            unsigned const offset, ir_node const *const init,
+                            ir_type *const type)
+{
+	unsigned const size = get_type_size_bytes(type);
+	if (size > 8) {
+		if (!is_Const(init))
+			panic("12/16byte initializers only support Const nodes yet");
+		write_tarval(section, offset, get_Const_tarval(init), size);
+		return;
+	}
+
+	ir_entity const *entity;
+	int64_t          value;
+	eval_init_expression(init, &entity, &value);
+	if (entity == NULL) {
+		write_le(section->data + offset, (uint64_t)value, size);
+		return;
+	}
+
+	unsigned type_nr;
+	switch (size) {
+	case 4: type_nr = target->reloc_abs32; break;
+	case 8: type_nr = target->reloc_abs64; break;
+	default:
+		panic("address in %u byte initializer not supported", size);
+	}
+	be_elf_add_reloc(section, offset, type_nr, entity, value);
+}
+
+static void write_bitfield(be_elf_section_t *const section,
+                           unsigned const offset, unsigned const offset_bits,
+                           unsigned const bitfield_size,
+                           ir_initializer_t const *const initializer)
+{
+	ir_tarval *tv;
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_NULL:
+		return;
+	case IR_INITIALIZER_TARVAL:
+		tv = get_initializer_tarval_value(initializer);
+		goto write;
+	case IR_INITIALIZER_CONST: {
+		ir_node *const node = get_initializer_const_value(initializer);
+		if (!is_Const(node))
+			panic("bitfield initializer not a Const node");
+		tv = get_Const_tarval(node);
+		goto write;
+	}
+	case IR_INITIALIZER_COMPOUND:
+		panic("bitfield initializer is compound");
+	}
+	panic("invalid initializer");
+
+write:;
+	unsigned char *const buffer = section->data + offset;
+	for (unsigned bit = 0; bit < bitfield_size; ++bit) {
+		unsigned char const byte = get_tarval_sub_bits(tv, bit / 8);
+		if ((byte >> (bit % 8)) & 1) {
+			unsigned const dst = offset_bits + bit;
+			buffer[dst / 8] |= 1 << (dst % 8);
+		}
+	}
+}
+
+static void write_initializer(be_elf_section_t *const section,
+                              unsigned const offset,
+                              ir_initializer_t const *const initializer,
+                              ir_type *const type)
+{
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_NULL:
+		return;
+
+	case IR_INITIALIZER_TARVAL:
+		write_tarval(section, offset,
+		             get_initializer_tarval_value(initializer),
+		             get_type_size_bytes(type));
+		return;
+
+	case IR_INITIALIZER_CONST:
+		write_node_data(section, offset,
+		                get_initializer_const_value(initializer), type);
+		return;
+
+	case IR_INITIALIZER_COMPOUND:
+		if (is_Array_type(type)) {
+			ir_type *const element_type = get_array_element_type(type);
+			unsigned       skip         = get_type_size_bytes(element_type);
+			unsigned const alignment
+				= get_type_alignment_bytes(element_type);
+			unsigned const misalign     = skip % alignment;
+			if (misalign != 0)
+				skip += alignment - misalign;
+
+			for (size_t i = 0,
+			     n = get_initializer_compound_n_entries(initializer);
+			     i < n; ++i) {
+				ir_initializer_t const *const sub_initializer
+					= get_initializer_compound_value(initializer, i);
+				write_initializer(section, offset + i * skip,
+				                  sub_initializer, element_type);
+			}
+		} else {
+			assert(is_compound_type(type));
+			for (size_t i = 0, n_members = get_compound_n_members(type);
+			     i < n_members; ++i) {
+				ir_entity *const member        = get_compound_member(type, i);
+				unsigned   const member_offset = get_entity_offset(member);
+
+				assert(i < get_initializer_compound_n_entries(initializer));
+				ir_initializer_t const *const sub_initializer
+					= get_initializer_compound_value(initializer, i);
+
+				unsigned const bitfield_size
+					= get_entity_bitfield_size(member);
+				if (bitfield_size > 0) {
+					write_bitfield(section, offset + member_offset,
+					               get_entity_bitfield_offset(member),
+					               bitfield_size, sub_initializer);
+					continue;
+				}
+				write_initializer(section, offset + member_offset,
+				                  sub_initializer, get_entity_type(member));
+			}
+		}
+		return;
+	}
+	panic("invalid ir_initializer kind found");
+}
+
+static void define_common(ir_entity const *const entity,
+                          unsigned long const size)
+{
+	elf_symbol_t *const symbol = get_symbol(entity);
+	symbol->common = true;
+	symbol->value  = be_gas_get_entity_alignment(entity);
+	symbol->size   = size;
+	symbol->type   = BE_ELF_OBJECT;
+}
+
+static void define_local_common(ir_entity const *const entity,
+                                unsigned long const size)
+{
+	/* gas places local commons into .bss */
+	be_elf_section_t *const bss = be_elf_get_section(GAS_SECTION_BSS);
+	be_elf_align(bss, be_gas_get_entity_alignment(entity), NULL);
+	unsigned const offset = be_elf_get_size(bss);
+	be_elf_grow(bss, size);
+	be_elf_define_entity(entity, bss, offset, size, BE_ELF_OBJECT);
+}
+
+/**
+ * Emits a global entity, this mirrors emit_global() of the gas emitter.
+ */
+static void emit_global(ir_entity const *const entity)
+{
+	ir_entity_kind const kind = get_entity_kind(entity);
+	/* Block labels and functions are defined by the code emitter. */
+	if (kind == IR_ENTITY_LABEL || kind == IR_ENTITY_METHOD)
+		return;
+
+	be_gas_section_t const section_kind
+		= be_gas_determine_section(NULL, entity);
+	ir_visibility const visibility       = get_entity_visibility(entity);
+	ir_linkage    const linkage          = get_entity_linkage(entity);
+	bool          const zero_initializer
+		= be_gas_entity_is_zero_initialized(entity);
+	unsigned long       size             = be_gas_get_entity_size(entity);
+	if (size == 0)
+		size = 1;
+
+	if (((linkage & IR_LINKAGE_MERGE) || zero_initializer)
+	    && !(section_kind & GAS_SECTION_FLAG_TLS)) {
+		switch (visibility) {
+		case ir_visibility_external:
+		case ir_visibility_external_private:
+		case ir_visibility_external_protected:
+			if (linkage & IR_LINKAGE_MERGE) {
+				define_common(entity, size);
+				return;
+			}
+			break;
+		case ir_visibility_local:
+		case ir_visibility_private:
+			if (!(linkage & IR_LINKAGE_CONSTANT)) {
+				define_local_common(entity, size);
+				return;
+			}
+			break;
+		}
+	}
+
+	if (!entity_has_definition(entity))
+		return;
+
+	if (kind == IR_ENTITY_ALIAS) {
+		elf_symbol_t *const symbol = get_symbol(entity);
+		symbol->alias = get_symbol(get_entity_alias(entity));
+		return;
+	}
+
+	be_elf_section_t *const section = be_elf_get_section(section_kind);
+	unsigned          const alignment
+		= be_gas_get_entity_alignment(entity);
+	if (!is_po2(alignment))
+		panic("alignment not a power of 2");
+	be_elf_align(section, alignment, NULL);
+
+	unsigned const offset = be_elf_get_size(section);
+	if (get_entity_ld_name(entity)[0] != '\0') {
+		if (be_gas_emit_types && visibility != ir_visibility_private) {
+			ir_type *const type = get_entity_type(entity);
+			be_elf_define_entity(entity, section, offset,
+			                     get_type_size_bytes(type), BE_ELF_OBJECT);
+		} else {
+			be_elf_define_entity(entity, section, offset, 0, BE_ELF_NOTYPE);
+		}
+	}
+
+	be_elf_grow(section, size);
+	if (!zero_initializer) {
+		write_initializer(section, offset, get_entity_initializer(entity),
+		                  get_entity_type(entity));
+	}
+}
+
+static void emit_globals(ir_type *const type)
+{
+	for (size_t i = 0, n = get_compound_n_members(type); i < n; ++i) {
+		emit_global(get_compound_member(type, i));
+	}
+}
+
+/*
+ * Writing the object file.
+ */
+
+static unsigned char *out_buffer;
+
+/** Appends @p size bytes to the output buffer. */
+static unsigned char *out_grow(size_t const size)
+{
+	ARR_EXTEND(unsigned char, out_buffer, size);
+	return out_buffer + ARR_LEN(out_buffer) - size;
+}
+
+static void put8(unsigned char const value)
+{
+	ARR_APP1(unsigned char, out_buffer, value);
+}
+
+static void put16(uint16_t const value)
+{
+	write_le(out_grow(2), value, 2);
+}
+
+static void put32(uint32_t const value)
+{
+	write_le(out_grow(4), value, 4);
+}
+
+static void put64(uint64_t const value)
+{
+	write_le(out_grow(8), value, 8);
+}
+
+static void put_align(unsigned const alignment)
+{
+	while (ARR_LEN(out_buffer) % alignment != 0)
+		put8(0);
+}
+
+/** A string table under construction. */
+typedef struct strtab_t {
+	char *data;
+} strtab_t;
+
+static unsigned strtab_add(strtab_t *const strtab, char const *const prefix,
+                           char const *const string)
+{
+	unsigned const offset     = ARR_LEN(strtab->data);
+	size_t   const prefix_len = strlen(prefix);
+	size_t   const len        = strlen(string) + 1;
+	ARR_EXTEND(char, strtab->data, prefix_len + len);
+	memcpy(strtab->data + offset, prefix, prefix_len);
+	memcpy(strtab->data + offset + prefix_len, string, len);
+	return offset;
+}
+
+/**
+ * Resolves relocations against local symbols in their own section and
+ * reduces the remaining relocations against local symbols to relocations
+ * against the section symbol, this is what gas does.
+ */
+static void resolve_relocs(be_elf_section_t *const section)
+{
+	size_t n_kept = 0;
+	for (size_t i = 0, n = ARR_LEN(section->relocs); i < n; ++i) {
+		elf_reloc_t               reloc = section->relocs[i];
+		be_elf_reloc_info_t const *info = &target->relocs[reloc.type];
+		if (reloc.symbol != NULL) {
+			elf_symbol_t const *const symbol = get_address_symbol(reloc.symbol);
+			ir_entity    const *const entity = reloc.symbol->entity;
+			if (get_binding(entity) == STB_LOCAL && symbol->section != NULL
+			    && info->local) {
+				reloc.section = symbol->section;
+				reloc.addend += symbol->value;
+				reloc.symbol  = NULL;
+			} else if (is_private(entity)) {
+				if (symbol->section == NULL)
+					panic("private entity %+F is not defined", entity);
+				reloc.symbol->needed = true;
+			}
+		}
+
+		if (reloc.symbol == NULL && reloc.section == section && info->local
+		    && info->pc_relative) {
+			int64_t const value = reloc.addend - (int64_t)reloc.offset;
+			if (info->size == 4 && (value < INT32_MIN || value > INT32_MAX))
+				panic("relocation out of range");
+			write_le(section->data + reloc.offset, (uint64_t)value,
+			         info->size);
+			continue;
+		}
+		section->relocs[n_kept++] = reloc;
+	}
+	ARR_SETLEN(elf_reloc_t, section->relocs, n_kept);
+}
+
+/** Returns true if the symbol goes into the symbol table. */
+static bool is_emitted(elf_symbol_t const *const symbol)
+{
+	ir_entity const *const entity = symbol->entity;
+	if (is_private(entity))
+		return symbol->needed;
+	/* symbols only exist if they are defined or referenced */
+	return get_entity_ld_name(entity)[0] != '\0';
+}
+
+static void put_symbol(strtab_t *const strtab, elf_symbol_t const *const symbol)
+{
+	ir_entity          const *const entity  = symbol->entity;
+	elf_symbol_t       const *const address = get_address_symbol(symbol);
+	be_elf_symbol_type_t      const type
+		= symbol->alias != NULL ? address->type : symbol->type;
+	if (get_entity_kind(entity) == IR_ENTITY_LABEL) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), ".L_%lu", get_entity_label(entity));
+		put32(strtab_add(strtab, "", buf));
+	} else {
+		/* keep the assembler name of private entities */
+		char const *const prefix = is_private(entity) ? ".L" : "";
+		put32(strtab_add(strtab, prefix, get_entity_ld_name(entity)));
+	}
+	put8((get_binding(entity) << 4) | type);
+	put8(get_visibility(entity));
+	if (address->common) {
+		put16(SHN_COMMON);
+	} else if (address->section != NULL) {
+		put16(address->section->index);
+	} else {
+		put16(0);
+	}
+	put64(address->value);
+	put64(address->size);
+}
+
+static void put_section_header(uint32_t const name, uint32_t const type,
+                               uint64_t const flags, uint64_t const offset,
+                               uint64_t const size, uint32_t const link,
+                               uint32_t const info, uint64_t const alignment,
+                               uint64_t const entsize)
+{
+	put32(name);
+	put32(type);
+	put64(flags);
+	put64(0);
+	put64(offset);
+	put64(size);
+	put32(link);
+	put32(info);
+	put64(alignment);
+	put64(entsize);
+}
+
+static void write_object_file(void)
+{
+	size_t const n_sections = ARR_LEN(section_order);
+	for (size_t i = 0; i < n_sections; ++i) {
+		resolve_relocs(section_order[i]);
+	}
+
+	/* number the sections: each section is followed by its relocations */
+	strtab_t shstrtab = { NEW_ARR_F(char, 0) };
+	strtab_add(&shstrtab, "", "");
+	unsigned n_headers = 1;
+	for (size_t i = 0; i < n_sections; ++i) {
+		be_elf_section_t *const section = section_order[i];
+		section->index = n_headers++;
+		if (ARR_LEN(section->relocs) > 0)
+			++n_headers;
+	}
+	unsigned const symtab_index   = n_headers++;
+	unsigned const strtab_index   = n_headers++;
+	unsigned const shstrtab_index = n_headers++;
+
+	/* the symbol table: locals first */
+	strtab_t strtab = { NEW_ARR_F(char, 0) };
+	strtab_add(&strtab, "", "");
+	unsigned char *const saved_buffer = out_buffer;
+	out_buffer = NEW_ARR_F(unsigned char, 0);
+	unsigned n_symbols = 0;
+	unsigned n_locals  = 0;
+	for (unsigned i = 0; i < ELF_SYM_SIZE; ++i)
+		put8(0);
+	++n_symbols;
+
+	put32(strtab_add(&strtab, "", unit_name));
+	put8((STB_LOCAL << 4) | STT_FILE);
+	put8(STV_DEFAULT);
+	put16(SHN_ABS);
+	put64(0);
+	put64(0);
+	++n_symbols;
+
+	for (size_t i = 0; i < n_sections; ++i) {
+		be_elf_section_t *const section = section_order[i];
+		section->symbol = n_symbols++;
+		put32(0);
+		put8((STB_LOCAL << 4) | STT_SECTION);
+		put8(STV_DEFAULT);
+		put16(section->index);
+		put64(0);
+		put64(0);
+	}
+	for (int pass = 0; pass < 2; ++pass) {
+		for (size_t i = 0, n = ARR_LEN(symbols); i < n; ++i) {
+			elf_symbol_t *const symbol = symbols[i];
+			bool const local = get_binding(symbol->entity) == STB_LOCAL;
+			if (local != (pass == 0) || !is_emitted(symbol))
+				continue;
+			symbol->index = n_symbols++;
+			put_symbol(&strtab, symbol);
+		}
+		if (pass == 0)
+			n_locals = n_symbols;
+	}
+	unsigned char *const symtab = out_buffer;
+	out_buffer = saved_buffer;
+
+	/* the file: header, section contents, section headers */
+	out_buffer = NEW_ARR_F(unsigned char, 0);
+	static unsigned char const ident[] = {
+		0x7F, 'E', 'L', 'F', 2 /* 64bit */, 1 /* little endian */,
+		1 /* version */, 0 /* System V ABI */,
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(ident); ++i)
+		put8(ident[i]);
+	while (ARR_LEN(out_buffer) < 16)
+		put8(0);
+	put16(1 /* ET_REL */);
+	put16(target->machine);
+	put32(1 /* EV_CURRENT */);
+	put64(0);
+	put64(0);
+	size_t const shoff_pos = ARR_LEN(out_buffer);
+	put64(0);
+	put32(0);
+	put16(ELF_EHDR_SIZE);
+	put16(0);
+	put16(0);
+	put16(ELF_SHDR_SIZE);
+	put16(n_headers);
+	put16(shstrtab_index);
+
+	uint64_t *const content_offsets = XMALLOCNZ(uint64_t, n_headers);
+	for (size_t i = 0; i < n_sections; ++i) {
+		be_elf_section_t *const section = section_order[i];
+		put_align(section->alignment);
+		content_offsets[section->index] = ARR_LEN(out_buffer);
+		if (section->data != NULL) {
+			unsigned char *const dest
+				= out_grow(section->size);
+			memcpy(dest, section->data, section->size);
+		}
+		if (ARR_LEN(section->relocs) == 0)
+			continue;
+		put_align(8);
+		content_offsets[section->index + 1] = ARR_LEN(out_buffer);
+		for (size_t r = 0, n = ARR_LEN(section->relocs); r < n; ++r) {
+			elf_reloc_t const *const reloc = &section->relocs[r];
+			uint64_t const symbol_index = reloc->symbol != NULL
+				? reloc->symbol->index : reloc->section->symbol;
+			assert(symbol_index != 0);
+			put64(reloc->offset);
+			put64(symbol_index << 32 | reloc->type);
+			put64((uint64_t)reloc->addend);
+		}
+	}
+	put_align(8);
+	content_offsets[symtab_index] = ARR_LEN(out_buffer);
+	memcpy(out_grow(ARR_LEN(symtab)),
+	       symtab, ARR_LEN(symtab));
+	content_offsets[strtab_index] = ARR_LEN(out_buffer);
+	memcpy(out_grow(ARR_LEN(strtab.data)),
+	       strtab.data, ARR_LEN(strtab.data));
+
+	/* the section name table has to contain its own name */
+	unsigned *const names = XMALLOCNZ(unsigned, n_headers);
+	for (size_t i = 0; i < n_sections; ++i) {
+		be_elf_section_t *const section = section_order[i];
+		if (ARR_LEN(section->relocs) > 0) {
+			char buf[64];
+			snprintf(buf, sizeof(buf), ".rela%s", section->name);
+			names[section->index + 1] = strtab_add(&shstrtab, "", buf);
+		}
+		names[section->index] = strtab_add(&shstrtab, "", section->name);
+	}
+	names[symtab_index]   = strtab_add(&shstrtab, "", ".symtab");
+	names[strtab_index]   = strtab_add(&shstrtab, "", ".strtab");
+	names[shstrtab_index] = strtab_add(&shstrtab, "", ".shstrtab");
+	content_offsets[shstrtab_index] = ARR_LEN(out_buffer);
+	memcpy(out_grow(ARR_LEN(shstrtab.data)),
+	       shstrtab.data, ARR_LEN(shstrtab.data));
+
+	put_align(8);
+	write_le(out_buffer + shoff_pos, ARR_LEN(out_buffer), 8);
+	put_section_header(0, 0, 0, 0, 0, 0, 0, 0, 0);
+	for (size_t i = 0; i < n_sections; ++i) {
+		be_elf_section_t *const section = section_order[i];
+		unsigned const index = section->index;
+		put_section_header(names[index], section->type, section->flags,
+		                   content_offsets[index], section->size, 0, 0,
+		                   section->alignment, 0);
+		size_t const n_relocs = ARR_LEN(section->relocs);
+		if (n_relocs == 0)
+			continue;
+		put_section_header(names[index + 1], SHT_RELA, SHF_INFO_LINK,
+		                   content_offsets[index + 1],
+		                   n_relocs * ELF_RELA_SIZE, symtab_index, index, 8,
+		                   ELF_RELA_SIZE);
+	}
+	put_section_header(names[symtab_index], SHT_SYMTAB, 0,
+	                   content_offsets[symtab_index], ARR_LEN(symtab),
+	                   strtab_index, n_locals, 8, ELF_SYM_SIZE);
+	put_section_header(names[strtab_index], SHT_STRTAB, 0,
+	                   content_offsets[strtab_index], ARR_LEN(strtab.data),
+	                   0, 0, 1, 0);
+	put_section_header(names[shstrtab_index], SHT_STRTAB, 0,
+	                   content_offsets[shstrtab_index],
+	                   ARR_LEN(shstrtab.data), 0, 0, 1, 0);
+
+	if (fwrite(out_buffer, 1, ARR_LEN(out_buffer), output)
+	    != ARR_LEN(out_buffer))
+		panic("could not write object file");
+
+	free(names);
+	free(content_offsets);
+	DEL_ARR_F(out_buffer);
+	out_buffer = NULL;
+	DEL_ARR_F(symtab);
+	DEL_ARR_F(strtab.data);
+	DEL_ARR_F(shstrtab.data);
+}
+
+void be_elf_finish(void)
+{
+	emit_globals(get_glob_type());
+	ir_type *const tls_type = get_tls_type();
+	for (size_t i = 0, n = get_compound_n_members(tls_type); i < n; ++i) {
+		if (entity_has_definition(get_compound_member(tls_type, i)))
+			panic("thread local variables not supported in object file output");
+	}
+	emit_globals(get_segment_type(IR_SEGMENT_CONSTRUCTORS));
+	emit_globals(get_segment_type(IR_SEGMENT_DESTRUCTORS));
+	emit_globals(get_segment_type(IR_SEGMENT_JCR));
+
+	write_object_file();
+
+	for (size_t i = 0, n = ARR_LEN(section_order); i < n; ++i) {
+		be_elf_section_t *const section = section_order[i];
+		if (section->data != NULL)
+			DEL_ARR_F(section->data);
+		DEL_ARR_F(section->relocs);
+	}
+	DEL_ARR_F(section_order);
+	DEL_ARR_F(symbols);
+	pmap_destroy(entity_symbols);
+	obstack_free(&obst, NULL);
+}
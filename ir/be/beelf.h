@@ -0,0 +1,116 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes relocatable ELF64 object files.
+ *
+ * Backends which encode their instructions themselves use this instead of
+ * the gas emitter. Code and data are collected per section together with
+ * their relocations, be_elf_finish() adds the global variables and writes
+ * the object file.
+ */
+#ifndef FIRM_BE_BEELF_H
+#define FIRM_BE_BEELF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "begnuas.h"
+#include "firm_types.h"
+
+typedef struct be_elf_section_t be_elf_section_t;
+
+/** Describes a machine specific relocation type. */
+typedef struct be_elf_reloc_info_t {
+	unsigned char size;        /**< size of the relocated field in bytes */
+	bool          pc_relative; /**< the field is relative to its address */
+	bool          local;       /**< may be resolved by the writer if the
+	                                target is a local symbol */
+} be_elf_reloc_info_t;
+
+/** Describes the target machine. */
+typedef struct be_elf_target_t {
+	uint16_t                   machine;     /**< the ELF machine number */
+	unsigned                   n_relocs;
+	be_elf_reloc_info_t const *relocs;      /**< indexed by relocation type */
+	unsigned                   reloc_abs32; /**< absolute 32bit data word */
+	unsigned                   reloc_abs64; /**< absolute 64bit data word */
+} be_elf_target_t;
+
+typedef enum be_elf_symbol_type_t {
+	BE_ELF_NOTYPE = 0,
+	BE_ELF_OBJECT = 1,
+	BE_ELF_FUNC   = 2,
+} be_elf_symbol_type_t;
+
+/** Fills @p size bytes at @p buffer, used for code alignment. */
+typedef void (*be_elf_fill_func)(unsigned char *buffer, unsigned size);
+
+/**
+ * Starts writing an object file for the compilation unit @p cup_name.
+ */
+void be_elf_begin(FILE *output, char const *cup_name,
+                  be_elf_target_t const *target);
+
+/**
+ * Emits the global variables and writes the object file.
+ */
+void be_elf_finish(void);
+
+/**
+ * Returns the section @p kind, creating it if necessary.
+ */
+be_elf_section_t *be_elf_get_section(be_gas_section_t kind);
+
+/**
+ * Returns the section an entity is placed in.
+ */
+be_elf_section_t *be_elf_get_entity_section(ir_entity const *entity);
+
+/**
+ * Returns the current size of a section.
+ */
+unsigned be_elf_get_size(be_elf_section_t const *section);
+
+/**
+ * Appends @p size zero bytes to a section.
+ *
+ * @return a pointer to the new bytes, it stays valid until the next
+ *         be_elf_grow() or be_elf_align() on the section. NULL for sections
+ *         without contents like .bss
+ */
+unsigned char *be_elf_grow(be_elf_section_t *section, unsigned size);
+
+/**
+ * Pads a section to a multiple of @p alignment. The padding is created by
+ * @p fill, zero bytes are used if it is NULL.
+ */
+void be_elf_align(be_elf_section_t *section, unsigned alignment,
+                  be_elf_fill_func fill);
+
+/**
+ * Defines the symbol of @p entity at @p offset of @p section.
+ */
+void be_elf_define_entity(ir_entity const *entity, be_elf_section_t *section,
+                          unsigned offset, unsigned size,
+                          be_elf_symbol_type_t type);
+
+/**
+ * Adds a relocation of type @p type at @p offset of @p section, which refers
+ * to @p entity + @p addend.
+ */
+void be_elf_add_reloc(be_elf_section_t *section, unsigned offset,
+                      unsigned type, ir_entity const *entity, int64_t addend);
+
+/**
+ * Adds a relocation of type @p type at @p offset of @p section, which refers
+ * to the start of section @p target + @p addend.
+ */
+void be_elf_add_section_reloc(be_elf_section_t *section, unsigned offset,
+                              unsigned type, be_elf_section_t *target,
+                              int64_t addend);
+
+#endif
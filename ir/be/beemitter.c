@@ -9,35 +9,310 @@
  * @author      Matthias Braun
  * @date        12.03.2007
  */
+#ifndef _WIN32
+/* fileno() and writev() */
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include "array.h"
 #include "bedwarf.h"
 #include "beemitter.h"
 #include "benode.h"
 #include "be_t.h"
 #include "debug.h"
 #include "panic.h"
+#include "irargs_t.h"
 #include "irnode_t.h"
 #include "irprintf.h"
+#include "lc_appendable.h"
+#include "lc_printf.h"
 #include "tv.h"
 #include "dbginfo.h"
 #include "util.h"
+#include "xmalloc.h"
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#include <unistd.h>
+#define HAVE_WRITEV
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+#endif
+
+/** Size of an output chunk. Longer lines get a chunk of their own. */
+#define EMIT_CHUNK_SIZE    (256 * 1024)
+/** Number of finished chunks which are written out together when the
+ * output is not buffered. */
+#define EMIT_FLUSH_CHUNKS  16
+
+/** A chunk of finished output lines. */
+typedef struct emit_chunk_t {
+	char  *data;
+	size_t len;  /**< number of bytes used */
+	size_t size; /**< number of bytes allocated */
+} emit_chunk_t;
+
+static FILE         *emit_file;
+char                *emit_pos;
+char                *emit_end;
+static char         *emit_begin;   /**< start of the current chunk */
+static char         *emit_line;    /**< start of the current line */
+static emit_chunk_t *emit_pending; /**< finished chunks not yet written */
+static char        **emit_free;    /**< unused chunks of EMIT_CHUNK_SIZE */
+static bool          emit_buffered;
+
+static char *alloc_chunk(size_t const size)
+{
+	if (size == EMIT_CHUNK_SIZE && ARR_LEN(emit_free) > 0) {
+		char *const chunk = emit_free[ARR_LEN(emit_free) - 1];
+		ARR_SHRINKLEN(emit_free, ARR_LEN(emit_free) - 1);
+		return chunk;
+	}
+	return XMALLOCN(char, size);
+}
+
+static void free_chunk(char *const data, size_t const size)
+{
+	if (size == EMIT_CHUNK_SIZE) {
+		ARR_APP1(char*, emit_free, data);
+	} else {
+		free(data);
+	}
+}
+
+static void set_chunk(char *const data, size_t const size)
+{
+	emit_begin = data;
+	emit_line  = data;
+	emit_pos   = data;
+	emit_end   = data + size;
+}
+
+static void write_chunks(emit_chunk_t const *chunks, size_t n)
+{
+#ifdef HAVE_WRITEV
+	int const fd = fileno(emit_file);
+	if (fd >= 0) {
+		/* write everything that went through stdio before */
+		fflush(emit_file);
+
+		struct iovec iov[EMIT_FLUSH_CHUNKS];
+		size_t       n_iov = 0;
+		for (;;) {
+			/* refill the vector */
+			for (; n > 0 && n_iov < ARRAY_SIZE(iov); ++chunks, --n) {
+				iov[n_iov].iov_base = chunks->data;
+				iov[n_iov].iov_len  = chunks->len;
+				++n_iov;
+			}
+			if (n_iov == 0)
+				break;
+
+			ssize_t res = writev(fd, iov, MIN(n_iov, (size_t)IOV_MAX));
+			if (res < 0) {
+				if (errno == EINTR)
+					continue;
+				panic("writing the assembler output failed: %s",
+				      strerror(errno));
+			}
+
+			/* drop what was written, keep the rest of a partial write */
+			size_t first = 0;
+			while (first < n_iov && (size_t)res >= iov[first].iov_len) {
+				res -= iov[first].iov_len;
+				++first;
+			}
+			if (first < n_iov) {
+				iov[first].iov_base = (char*)iov[first].iov_base + res;
+				iov[first].iov_len -= res;
+			}
+			memmove(iov, iov + first, (n_iov - first) * sizeof(*iov));
+			n_iov -= first;
+		}
+		return;
+	}
+#endif
+	for (size_t i = 0; i < n; ++i)
+		fwrite(chunks[i].data, 1, chunks[i].len, emit_file);
+}
+
+/**
+ * Writes all finished lines to the emitter file.
+ */
+static void emit_flush(void)
+{
+	size_t const finished = emit_line - emit_begin;
+	if (finished > 0) {
+		emit_chunk_t const current = { emit_begin, finished, 0 };
+		ARR_APP1(emit_chunk_t, emit_pending, current);
+	}
+	write_chunks(emit_pending, ARR_LEN(emit_pending));
+
+	size_t const n = ARR_LEN(emit_pending) - (finished > 0);
+	for (size_t i = 0; i < n; ++i)
+		free_chunk(emit_pending[i].data, emit_pending[i].size);
+	ARR_SETLEN(emit_chunk_t, emit_pending, 0);
+
+	/* move the unfinished line to the start of the chunk */
+	size_t const line_len = emit_pos - emit_line;
+	memmove(emit_begin, emit_line, line_len);
+	emit_line = emit_begin;
+	emit_pos  = emit_begin + line_len;
+}
+
+void be_emit_reserve(size_t const size)
+{
+	size_t const line_len = emit_pos - emit_line;
+	size_t const finished = emit_line - emit_begin;
+	size_t const chunk    = emit_end - emit_begin;
+	if (finished == 0) {
+		/* the current line fills the whole chunk */
+		size_t const new_size = MAX(2 * chunk, line_len + size);
+		char  *const data     = XMALLOCN(char, new_size);
+		memcpy(data, emit_begin, line_len);
+		free_chunk(emit_begin, chunk);
+		set_chunk(data, new_size);
+		emit_pos = data + line_len;
+		return;
+	}
 
-static FILE    *emit_file;
-struct obstack  emit_obst;
+	/* keep the finished lines, continue the current line in a new chunk */
+	emit_chunk_t const full = { emit_begin, finished, chunk };
+	ARR_APP1(emit_chunk_t, emit_pending, full);
+	size_t const new_size = MAX((size_t)EMIT_CHUNK_SIZE, line_len + size);
+	char  *const data     = alloc_chunk(new_size);
+	memcpy(data, emit_line, line_len);
+	set_chunk(data, new_size);
+	emit_pos = data + line_len;
+
+	if (!emit_buffered && ARR_LEN(emit_pending) >= EMIT_FLUSH_CHUNKS)
+		emit_flush();
+}
 
 void be_emit_init(FILE *file)
 {
-	emit_file = file;
-	obstack_init(&emit_obst);
+	emit_file     = file;
+	emit_buffered = false;
+	emit_pending  = NEW_ARR_F(emit_chunk_t, 0);
+	emit_free     = NEW_ARR_F(char*, 0);
+	set_chunk(XMALLOCN(char, EMIT_CHUNK_SIZE), EMIT_CHUNK_SIZE);
 }
 
 void be_emit_exit(void)
 {
-	obstack_free(&emit_obst, NULL);
+	assert(!emit_buffered);
+	assert(emit_pos == emit_line);
+	emit_flush();
+	free_chunk(emit_begin, emit_end - emit_begin);
+	for (size_t i = 0, n = ARR_LEN(emit_free); i < n; ++i)
+		free(emit_free[i]);
+	DEL_ARR_F(emit_free);
+	DEL_ARR_F(emit_pending);
+	emit_pos = emit_end = NULL;
+}
+
+void be_emit_begin_buffer(void)
+{
+	assert(!emit_buffered);
+	assert(emit_pos == emit_line);
+	/* keep the order with other output of the program */
+	emit_flush();
+	emit_buffered = true;
+}
+
+void be_emit_flush_buffer(void)
+{
+	assert(emit_buffered);
+	assert(emit_pos == emit_line);
+	emit_flush();
+	emit_buffered = false;
+}
+
+void be_emit_walk_buffer(be_emit_buffer_func *func, void *env)
+{
+	assert(emit_buffered);
+	for (size_t i = 0, n = ARR_LEN(emit_pending); i < n; ++i)
+		func(emit_pending[i].data, emit_pending[i].len, env);
+	if (emit_line != emit_begin)
+		func(emit_begin, emit_line - emit_begin, env);
+}
+
+void be_emit_uint(uint64_t value)
+{
+	char  buf[20];
+	char *p = buf + sizeof(buf);
+	do {
+		*--p   = '0' + value % 10;
+		value /= 10;
+	} while (value != 0);
+	be_emit_string_len(p, buf + sizeof(buf) - p);
 }
 
+void be_emit_int(int64_t const value)
+{
+	if (value < 0) {
+		be_emit_char('-');
+		be_emit_uint(-(uint64_t)value);
+	} else {
+		be_emit_uint(value);
+	}
+}
+
+void be_emit_hex(uint64_t value)
+{
+	static const char digits[] = "0123456789ABCDEF";
+	char  buf[16];
+	char *p = buf + sizeof(buf);
+	do {
+		*--p    = digits[value & 0xF];
+		value >>= 4;
+	} while (value != 0);
+	be_emit_string_len(p, buf + sizeof(buf) - p);
+}
+
+static void emit_app_init(lc_appendable_t *app)
+{
+	(void)app;
+}
+
+static void emit_app_finish(lc_appendable_t *app)
+{
+	(void)app;
+}
+
+static int emit_app_snadd(lc_appendable_t *app, const char *str, size_t n)
+{
+	app->written += n;
+	be_emit_string_len(str, n);
+	return n;
+}
+
+static int emit_app_chadd(lc_appendable_t *app, int ch)
+{
+	app->written++;
+	be_emit_char(ch);
+	return 1;
+}
+
+/** Lets ir_printf write directly into the output chunk. */
+static const lc_appendable_funcs_t emit_appendable = {
+	emit_app_init,
+	emit_app_finish,
+	emit_app_snadd,
+	emit_app_chadd
+};
+
 void be_emit_irvprintf(const char *fmt, va_list args)
 {
-	ir_obst_vprintf(&emit_obst, fmt, args);
+	lc_appendable_t app;
+	lc_appendable_init(&app, &emit_appendable, NULL, 0);
+	lc_evpprintf(firm_get_arg_env(), &app, fmt, args);
+	lc_appendable_finish(&app);
 }
 
 void be_emit_irprintf(const char *fmt, ...)
@@ -50,15 +325,12 @@ void be_emit_irprintf(const char *fmt, ...)
 
 void be_emit_write_line(void)
 {
-	size_t const len  = obstack_object_size(&emit_obst);
-	char  *const line = (char*)obstack_finish(&emit_obst);
-	fwrite(line, 1, len, emit_file);
-	obstack_free(&emit_obst, line);
+	emit_line = emit_pos;
 }
 
 void be_emit_pad_comment(void)
 {
-	size_t len = obstack_object_size(&emit_obst);
+	size_t len = emit_pos - emit_line;
 	len = MIN(len, 30);
 	/* 34 spaces */
 	be_emit_string_len("                                  ", 34 - len);
@@ -14,21 +14,31 @@
 #ifndef FIRM_BE_BEEMITTER_H
 #define FIRM_BE_BEEMITTER_H
 
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "firm_types.h"
-#include "obst.h"
 #include "be.h"
 #include "irop_t.h"
 
 /* don't use the following vars directly, they're only here for the inlines */
-extern struct obstack  emit_obst;
+extern char *emit_pos; /**< current position in the output chunk */
+extern char *emit_end; /**< end of the output chunk */
+
+/**
+ * Makes room for at least @p size more bytes in the output chunk.
+ */
+void be_emit_reserve(size_t size);
 
 /**
  * Emit a character to the (assembler) output.
  */
 static inline void be_emit_char(char c)
 {
-	obstack_1grow(&emit_obst, c);
+	if (emit_pos == emit_end)
+		be_emit_reserve(1);
+	*emit_pos++ = c;
 }
 
 /**
@@ -39,7 +49,10 @@ static inline void be_emit_char(char c)
  */
 static inline void be_emit_string_len(const char *str, size_t l)
 {
-	obstack_grow(&emit_obst, str, l);
+	if ((size_t)(emit_end - emit_pos) < l)
+		be_emit_reserve(l);
+	memcpy(emit_pos, str, l);
+	emit_pos += l;
 }
 
 /**
@@ -73,6 +86,22 @@ void be_emit_init(FILE *F);
  */
 void be_emit_exit(void);
 
+/**
+ * Emit a signed decimal number without going through printf.
+ */
+void be_emit_int(int64_t value);
+
+/**
+ * Emit an unsigned decimal number without going through printf.
+ */
+void be_emit_uint(uint64_t value);
+
+/**
+ * Emit a number in upper case hexadecimal digits (without 0x prefix)
+ * without going through printf.
+ */
+void be_emit_hex(uint64_t value);
+
 /**
  * Emit the output of an ir_printf.
  *
@@ -88,10 +117,36 @@ void be_emit_irprintf(const char *fmt, ...);
 void be_emit_irvprintf(const char *fmt, va_list args);
 
 /**
- * Flush the line in the current line buffer to the emitter file.
+ * Finish the current line. Finished lines are collected in large chunks
+ * which are written to the emitter file in batches.
  */
 void be_emit_write_line(void);
 
+/**
+ * Collect all following lines in a buffer instead of writing them to the
+ * emitter file. The code of a single graph is produced between
+ * be_emit_begin_buffer() and be_emit_flush_buffer(), so the output of each
+ * graph is self-contained and written in one piece.
+ */
+void be_emit_begin_buffer(void);
+
+/**
+ * Write the buffered lines to the emitter file and return to unbuffered
+ * output.
+ */
+void be_emit_flush_buffer(void);
+
+/**
+ * The type of a function receiving a piece of the buffered output.
+ */
+typedef void be_emit_buffer_func(const char *data, size_t len, void *env);
+
+/**
+ * Passes the finished lines collected since be_emit_begin_buffer() in order
+ * to @p func.
+ */
+void be_emit_walk_buffer(be_emit_buffer_func *func, void *env);
+
 /**
  * Flush the line in the current line buffer to the emitter file and
  * appends a gas-style comment with the node number and writes the line
@@ -11,17 +11,34 @@
  */
 #include <assert.h>
 #include <limits.h>
+#include <stddef.h>
+#include <string.h>
 
+#include "array.h"
 #include "beemitter_binary.h"
 #include "obst.h"
 #include "panic.h"
 
-static code_fragment_t *first_fragment;
-static code_fragment_t *last_fragment;
+/** A relocation inside a fragment. */
+typedef struct fragment_reloc_t {
+	unsigned         fragment; /**< number of the fragment */
+	unsigned         offset;   /**< offset in the fragment data */
+	unsigned         type;
+	ir_entity const *entity;
+	int64_t          addend;
+} fragment_reloc_t;
+
+static code_fragment_t  *first_fragment;
+static code_fragment_t  *last_fragment;
+static code_fragment_t **fragments;
+static fragment_reloc_t *relocs;
 #ifndef NDEBUG
 static const unsigned CODE_FRAGMENT_MAGIC = 0x4643414d;  /* "CFMA" */
 #endif
 
+/** size of a fragment without its data (the struct may have tail padding) */
+#define FRAGMENT_HEADER_SIZE offsetof(code_fragment_t, data)
+
 struct obstack code_fragment_obst;
 
 /** returns current fragment (the address stays only valid until the next
@@ -29,7 +46,7 @@ struct obstack code_fragment_obst;
 code_fragment_t *be_get_current_fragment(void)
 {
 	code_fragment_t *fragment = (code_fragment_t*)obstack_base(&code_fragment_obst);
-	assert(obstack_object_size(&code_fragment_obst) >= sizeof(code_fragment_t));
+	assert(obstack_object_size(&code_fragment_obst) >= FRAGMENT_HEADER_SIZE);
 	assert(fragment->magic == CODE_FRAGMENT_MAGIC);
 
 	return fragment;
@@ -44,9 +61,9 @@ static void alloc_fragment(void)
 	/* shouldn't have any growing fragments */
 	assert(obstack_object_size(&code_fragment_obst) == 0);
 
-	obstack_blank(&code_fragment_obst, sizeof(*fragment));
+	obstack_blank(&code_fragment_obst, FRAGMENT_HEADER_SIZE);
 	fragment = (code_fragment_t*)obstack_base(&code_fragment_obst);
-	memset(fragment, 0, sizeof(*fragment));
+	memset(fragment, 0, FRAGMENT_HEADER_SIZE);
 #ifndef NDEBUG
 	fragment->magic = CODE_FRAGMENT_MAGIC;
 #endif
@@ -60,13 +77,16 @@ static code_fragment_t *finish_fragment(void)
 {
 	code_fragment_t *fragment = be_get_current_fragment();
 	fragment->len
-		= obstack_object_size(&code_fragment_obst) - sizeof(*fragment);
+		= obstack_object_size(&code_fragment_obst) - FRAGMENT_HEADER_SIZE;
 
 	fragment      = (code_fragment_t*) obstack_finish(&code_fragment_obst);
+	if (last_fragment != NULL)
+		last_fragment->next = fragment;
 	last_fragment = fragment;
 
 	if (first_fragment == NULL)
 		first_fragment = fragment;
+	ARR_APP1(code_fragment_t*, fragments, fragment);
 
 	return fragment;
 }
@@ -75,27 +95,37 @@ void be_start_code_emitter(void)
 {
 	obstack_init(&code_fragment_obst);
 	first_fragment = NULL;
+	last_fragment  = NULL;
+	fragments      = NEW_ARR_F(code_fragment_t*, 0);
+	relocs         = NEW_ARR_F(fragment_reloc_t, 0);
 	alloc_fragment();
 }
 
-void be_start_new_fragment(void)
+void be_end_code_emitter(void)
+{
+	DEL_ARR_F(relocs);
+	DEL_ARR_F(fragments);
+	obstack_free(&code_fragment_obst, NULL);
+}
+
+unsigned be_start_new_fragment(void)
 {
 	finish_fragment();
 	alloc_fragment();
+	return ARR_LEN(fragments);
 }
 
-static void emit(FILE *file, const unsigned char *buffer, size_t len)
+code_fragment_t *be_get_fragment(unsigned nr)
 {
-	size_t i;
-	for (i = 0; i < len; ++i) {
-		size_t i2;
-		fputs("\t.byte ", file);
-		for (i2 = i; i2 < i + 30 && i2 < len; ++i2) {
-			fprintf(file, "0x%02X", (unsigned)buffer[i2]);
-		}
-		i = i2;
-		fputs("\n", file);
-	}
+	assert(nr < ARR_LEN(fragments));
+	return fragments[nr];
+}
+
+static void emit(be_elf_section_t *section, const unsigned char *buffer,
+                 size_t len)
+{
+	if (len > 0)
+		memcpy(be_elf_grow(section, len), buffer, len);
 }
 
 static unsigned align(unsigned offset, unsigned alignment)
@@ -161,17 +191,22 @@ static void determine_offsets(const binary_emiter_interface_t *interface)
 	} while (changed);
 }
 
-void be_emit_entity(ir_entity *entity, bool entity_sign, int offset,
-                    bool is_relative)
+void be_emit_reloc(unsigned offset, unsigned type, ir_entity const *entity,
+                   int64_t addend)
 {
-	(void) entity;
-	(void) entity_sign;
-	(void) offset;
-	(void) is_relative;
-	panic("not implemented yet");
+	fragment_reloc_t const reloc = {
+		.fragment = ARR_LEN(fragments),
+		.offset   = obstack_object_size(&code_fragment_obst)
+		          - FRAGMENT_HEADER_SIZE + offset,
+		.type     = type,
+		.entity   = entity,
+		.addend   = addend,
+	};
+	ARR_APP1(fragment_reloc_t, relocs, reloc);
 }
 
-void be_emit_code(FILE *output, const binary_emiter_interface_t *interface)
+unsigned be_emit_code(be_elf_section_t *section,
+                      const binary_emiter_interface_t *interface)
 {
 	unsigned offset;
 
@@ -183,6 +218,7 @@ void be_emit_code(FILE *output, const binary_emiter_interface_t *interface)
 	determine_offsets(interface);
 
 	/* emit code */
+	unsigned const start = be_elf_get_size(section);
 	offset = 0;
 	for (fragment = first_fragment; fragment != NULL;
 	     fragment = fragment->next) {
@@ -195,20 +231,29 @@ void be_emit_code(FILE *output, const binary_emiter_interface_t *interface)
 	    if (nops > 0) {
 			unsigned char *nopbuffer = (unsigned char*)obstack_alloc(&code_fragment_obst, nops);
 			interface->create_nops(nopbuffer, nops);
-			emit(output, nopbuffer, nops);
+			emit(section, nopbuffer, nops);
 			offset = fragment->offset;
 			obstack_free(&code_fragment_obst, nopbuffer);
 		}
 
 		/* emit the fragment */
-		emit(output, fragment->data, fragment->len);
+		emit(section, fragment->data, fragment->len);
 		offset += fragment->len;
 
 		/* emit the jump */
 		jmpbuffer = (unsigned char*)obstack_alloc(&code_fragment_obst, fragment->jumpsize_min);
 		interface->emit_jump(fragment, jmpbuffer);
-		emit(output, jmpbuffer, fragment->jumpsize_min);
+		emit(section, jmpbuffer, fragment->jumpsize_min);
 		offset += fragment->jumpsize_min;
 		obstack_free(&code_fragment_obst, jmpbuffer);
 	}
+
+	for (size_t i = 0, n = ARR_LEN(relocs); i < n; ++i) {
+		fragment_reloc_t const *const reloc = &relocs[i];
+		unsigned const reloc_offset
+			= start + fragments[reloc->fragment]->offset + reloc->offset;
+		be_elf_add_reloc(section, reloc_offset, reloc->type, reloc->entity,
+		                 reloc->addend);
+	}
+	return start;
 }
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "beelf.h"
 #include "firm_types.h"
 #include "obst.h"
 
@@ -68,21 +69,33 @@ struct binary_emiter_interface_t {
 };
 
 /** Initializes and prepares for emitting a routine with code "fragments".
- * Creates an initial fragment in which you can emit right away.
+ * Creates an initial fragment (number 0) in which you can emit right away.
  */
 void be_start_code_emitter(void);
 
-/** finalizes and emits current procedure */
-void be_emit_code(FILE *output, const binary_emiter_interface_t *interface);
+/**
+ * Finalizes the current procedure: determines the jump sizes and appends
+ * the code and its relocations to @p section.
+ *
+ * @return the offset of the code in the section. The offsets of the
+ *         fragments (relative to this) stay available until
+ *         be_end_code_emitter() is called.
+ */
+unsigned be_emit_code(be_elf_section_t *section,
+                      const binary_emiter_interface_t *interface);
+
+/** Frees the fragments of the current procedure. */
+void be_end_code_emitter(void);
 
-/** finish current fragment and return its final address */
-code_fragment_t *be_finish_fragment(void);
+/** Create a new code fragment (and append it to the previous one)
+ * @return the number of the new fragment */
+unsigned be_start_new_fragment(void);
 
-/** Create a new code fragment (and append it to the previous one) */
-void be_start_new_fragment(void);
+/** returns a finished fragment by its number */
+code_fragment_t *be_get_fragment(unsigned nr);
 
 /** returns current fragment (the address stays only valid until the next
-    be_emit(8/16/32/entity) call!) */
+    be_emit(8/16/32) call!) */
 code_fragment_t *be_get_current_fragment(void);
 
 /** appends a byte to the current fragment */
@@ -105,8 +118,12 @@ static inline void be_emit32(const uint32_t u32)
 	obstack_grow(&code_fragment_obst, &u32, 4);
 }
 
-/** leave space where an entity reference is put at the finish stage */
-void be_emit_entity(ir_entity *entity, bool entity_sign, int offset,
-                    bool is_relative);
+/**
+ * Records a relocation of type @p type for @p entity + @p addend at @p offset
+ * bytes after the current position in the current fragment. The bytes
+ * themselves are emitted as usual.
+ */
+void be_emit_reloc(unsigned offset, unsigned type, ir_entity const *entity,
+                   int64_t addend);
 
 #endif
@@ -0,0 +1,274 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Ordering of functions by call affinity.
+ *
+ * Implements the function placement of Pettis and Hansen: every function
+ * starts as a chain of its own. The call graph edges are visited by
+ * decreasing weight and the chains of caller and callee are concatenated,
+ * oriented so the two functions end up as close as possible. The chains
+ * are emitted hottest first.
+ */
+#include "befuncorder.h"
+
+#include "array.h"
+#include "bemodule.h"
+#include "debug.h"
+#include "entity_t.h"
+#include "execfreq.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irprofile.h"
+#include "irprog_t.h"
+#include "pmap.h"
+#include "util.h"
+#include "xmalloc.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** A call graph edge between two functions, in either direction. */
+typedef struct call_edge_t {
+	unsigned a;      /**< number of the function with the smaller number */
+	unsigned b;      /**< number of the other function */
+	double   weight; /**< number of calls */
+} call_edge_t;
+
+/** A sequence of functions. */
+typedef struct chain_t {
+	unsigned *members; /**< function numbers in order, ARR_F */
+	double    weight;  /**< weight of the edges inside the chain */
+	unsigned  first;   /**< smallest function number, for a stable order */
+} chain_t;
+
+static bool is_codegen_irg(ir_graph const *irg)
+{
+	return !(get_entity_linkage(get_irg_entity(irg)) & IR_LINKAGE_NO_CODEGEN);
+}
+
+/**
+ * Returns the number of executions of @p block, the execution frequency if
+ * there is no profile. The frequencies of the profile are never 0, so calls
+ * which never ran would still join their functions.
+ */
+static double get_block_weight(ir_node const *block, bool have_profile)
+{
+	if (!have_profile)
+		return get_block_execfreq(block);
+	return (double)ir_profile_get_block_execcount(block);
+}
+
+static int cmp_edge_ends(void const *p1, void const *p2)
+{
+	call_edge_t const *const e1 = (call_edge_t const*)p1;
+	call_edge_t const *const e2 = (call_edge_t const*)p2;
+	if (e1->a != e2->a)
+		return QSORT_CMP(e1->a, e2->a);
+	return QSORT_CMP(e1->b, e2->b);
+}
+
+static int cmp_edge_weight(void const *p1, void const *p2)
+{
+	call_edge_t const *const e1 = (call_edge_t const*)p1;
+	call_edge_t const *const e2 = (call_edge_t const*)p2;
+	if (e1->weight != e2->weight)
+		return e1->weight > e2->weight ? -1 : 1;
+	return cmp_edge_ends(p1, p2);
+}
+
+static int cmp_chain(void const *p1, void const *p2)
+{
+	chain_t const *const c1 = *(chain_t const *const*)p1;
+	chain_t const *const c2 = *(chain_t const *const*)p2;
+	if (c1->weight != c2->weight)
+		return c1->weight > c2->weight ? -1 : 1;
+	return QSORT_CMP(c1->first, c2->first);
+}
+
+/** Environment of collect_call(). */
+typedef struct collect_env_t {
+	pmap        *numbers; /**< graph to its number + 1 */
+	unsigned     caller;  /**< number of the walked graph */
+	bool         have_profile;
+	call_edge_t *edges;
+} collect_env_t;
+
+static void collect_call(ir_node *node, void *data)
+{
+	if (!is_Call(node))
+		return;
+	ir_entity const *const callee = get_Call_callee(node);
+	ir_graph  const *const irg    = callee != NULL
+	                              ? get_entity_linktime_irg(callee) : NULL;
+	if (irg == NULL || irg == get_irn_irg(node))
+		return;
+	collect_env_t *const env = (collect_env_t*)data;
+	void          *const nr  = pmap_get(void, env->numbers, irg);
+	if (nr == NULL)
+		return;
+
+	unsigned    const other = PTR_TO_INT(nr) - 1;
+	call_edge_t const edge  = {
+		.a      = MIN(env->caller, other),
+		.b      = MAX(env->caller, other),
+		.weight = get_block_weight(get_nodes_block(node), env->have_profile),
+	};
+	ARR_APP1(call_edge_t, env->edges, edge);
+}
+
+/**
+ * Collects the call graph edges between the functions in @p irgs, with
+ * calls in both directions combined into one edge. Only calls of known
+ * functions are seen, the graphs are not changed to resolve others.
+ */
+static call_edge_t *collect_edges(ir_graph **irgs, pmap *numbers,
+                                  bool have_profile)
+{
+	collect_env_t env = {
+		.numbers      = numbers,
+		.have_profile = have_profile,
+		.edges        = NEW_ARR_F(call_edge_t, 0),
+	};
+	for (size_t i = 0, n = ARR_LEN(irgs); i < n; ++i) {
+		env.caller = i;
+		irg_walk_graph(irgs[i], NULL, collect_call, &env);
+	}
+	call_edge_t *const edges = env.edges;
+
+	/* combine the edges between the same functions */
+	size_t const n_edges = ARR_LEN(edges);
+	QSORT(edges, n_edges, cmp_edge_ends);
+	size_t n_combined = 0;
+	for (size_t i = 0; i < n_edges; ++i) {
+		if (n_combined > 0 && edges[n_combined - 1].a == edges[i].a
+		    && edges[n_combined - 1].b == edges[i].b) {
+			edges[n_combined - 1].weight += edges[i].weight;
+		} else {
+			edges[n_combined++] = edges[i];
+		}
+	}
+	ARR_SHRINKLEN(edges, n_combined);
+	QSORT(edges, n_combined, cmp_edge_weight);
+	return edges;
+}
+
+static size_t find_member(chain_t const *chain, unsigned nr)
+{
+	for (size_t i = 0;; ++i) {
+		if (chain->members[i] == nr)
+			return i;
+	}
+}
+
+static void reverse_chain(chain_t *chain)
+{
+	for (size_t i = 0, j = ARR_LEN(chain->members); i + 1 < j--; ++i) {
+		unsigned const tmp = chain->members[i];
+		chain->members[i] = chain->members[j];
+		chain->members[j] = tmp;
+	}
+}
+
+/**
+ * Appends chain @p cb to chain @p ca, turning both so the functions @p a and
+ * @p b are as close as possible.
+ */
+static void merge_chains(chain_t *ca, unsigned a, chain_t *cb, unsigned b,
+                         double weight, chain_t **chain_of)
+{
+	size_t const len_a = ARR_LEN(ca->members);
+	size_t const len_b = ARR_LEN(cb->members);
+	size_t const pos_a = find_member(ca, a);
+	size_t const pos_b = find_member(cb, b);
+	if (pos_a < len_a - 1 - pos_a)
+		reverse_chain(ca);
+	if (len_b - 1 - pos_b < pos_b)
+		reverse_chain(cb);
+
+	for (size_t i = 0; i < len_b; ++i) {
+		unsigned const nr = cb->members[i];
+		ARR_APP1(unsigned, ca->members, nr);
+		chain_of[nr] = ca;
+	}
+	ca->weight += cb->weight + weight;
+	ca->first   = MIN(ca->first, cb->first);
+	DEL_ARR_F(cb->members);
+	cb->members = NULL;
+}
+
+void be_order_functions(bool have_profile)
+{
+	ir_graph **irgs    = NEW_ARR_F(ir_graph*, 0);
+	ir_graph **no_code = NEW_ARR_F(ir_graph*, 0);
+	pmap      *numbers = pmap_create();
+	foreach_irp_irg(i, irg) {
+		if (!is_codegen_irg(irg)) {
+			ARR_APP1(ir_graph*, no_code, irg);
+			continue;
+		}
+		ARR_APP1(ir_graph*, irgs, irg);
+		pmap_insert(numbers, irg, INT_TO_PTR(ARR_LEN(irgs)));
+	}
+
+	call_edge_t *const edges    = collect_edges(irgs, numbers, have_profile);
+	size_t       const n_irgs   = ARR_LEN(irgs);
+	chain_t     *const chains   = XMALLOCN(chain_t, n_irgs);
+	chain_t    **const chain_of = XMALLOCN(chain_t*, n_irgs);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		chains[i].members    = NEW_ARR_F(unsigned, 1);
+		chains[i].members[0] = i;
+		chains[i].weight     = 0.0;
+		chains[i].first      = i;
+		chain_of[i]          = &chains[i];
+	}
+
+	for (size_t i = 0, n = ARR_LEN(edges); i < n; ++i) {
+		call_edge_t const *const edge = &edges[i];
+		chain_t           *const ca   = chain_of[edge->a];
+		chain_t           *const cb   = chain_of[edge->b];
+		if (ca == cb || edge->weight <= 0.0)
+			continue;
+		DB((dbg, LEVEL_2, "merge %+F and %+F (%.3g)\n", irgs[edge->a],
+		    irgs[edge->b], edge->weight));
+		merge_chains(ca, edge->a, cb, edge->b, edge->weight, chain_of);
+	}
+
+	chain_t **const order   = XMALLOCN(chain_t*, n_irgs);
+	size_t          n_order = 0;
+	for (size_t i = 0; i < n_irgs; ++i) {
+		if (chains[i].members != NULL)
+			order[n_order++] = &chains[i];
+	}
+	QSORT(order, n_order, cmp_chain);
+
+	/* functions without code are put behind the others */
+	size_t pos = 0;
+	for (size_t c = 0; c < n_order; ++c) {
+		unsigned const *const members = order[c]->members;
+		for (size_t i = 0, n = ARR_LEN(members); i < n; ++i) {
+			DB((dbg, LEVEL_1, "%+F\n", irgs[members[i]]));
+			set_irp_irg(pos++, irgs[members[i]]);
+		}
+		DEL_ARR_F(order[c]->members);
+	}
+	for (size_t i = 0, n = ARR_LEN(no_code); i < n; ++i)
+		set_irp_irg(pos++, no_code[i]);
+
+	free(order);
+	free(chain_of);
+	free(chains);
+	DEL_ARR_F(edges);
+	pmap_destroy(numbers);
+	DEL_ARR_F(no_code);
+	DEL_ARR_F(irgs);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_funcorder)
+void be_init_funcorder(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.be.funcorder");
+}
@@ -0,0 +1,26 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Ordering of functions by call affinity.
+ */
+#ifndef FIRM_BE_BEFUNCORDER_H
+#define FIRM_BE_BEFUNCORDER_H
+
+#include <stdbool.h>
+
+/**
+ * Reorders the graphs of the program, so functions calling each other
+ * frequently are emitted next to each other.
+ *
+ * @param have_profile  the block execution counts of the profile are
+ *                      available and weight the calls, else the execution
+ *                      frequencies are used and every function is assumed
+ *                      to be called once
+ */
+void be_order_functions(bool have_profile);
+
+#endif
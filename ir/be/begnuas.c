@@ -25,7 +25,7 @@
 #include "execfreq.h"
 #include "iredges_t.h"
 #include "irnode_t.h"
-#include "irprog.h"
+#include "irprog_t.h"
 #include "irtools.h"
 #include "lc_opts_enum.h"
 #include "obst.h"
@@ -47,9 +47,19 @@ bool                        be_gas_emit_types         = true;
 char                        be_gas_elf_type_char      = '@';
 
 static be_gas_section_t current_section = (be_gas_section_t) -1;
+static bool             in_cold_part;
+/* section of the code of the current function, restored after jump tables */
+static be_gas_section_t function_section;
+static const ir_entity *function_entity;
 static pmap            *block_numbers;
 static unsigned         next_block_nr;
 
+/* state of standalone code, see be_gas_begin_standalone() */
+static const char      *standalone_prefix;
+static long             standalone_first_nr;
+static bool             standalone_ok;
+static unsigned         standalone_next_block_nr;
+
 static void emit_section_macho(be_gas_section_t section)
 {
 	be_gas_section_t base  = section & GAS_SECTION_TYPE_MASK;
@@ -130,6 +140,7 @@ typedef struct {
 
 static const elf_sectioninfo_t elf_sectioninfos[] = {
 	[GAS_SECTION_TEXT]           = { "text",              "progbits", "ax" },
+	[GAS_SECTION_TEXT_UNLIKELY]  = { "text.unlikely",     "progbits", "ax" },
 	[GAS_SECTION_DATA]           = { "data",              "progbits", "aw" },
 	[GAS_SECTION_RODATA]         = { "rodata",            "progbits", "a"  },
 	[GAS_SECTION_REL_RO_LOCAL]   = { "data.rel.ro.local", "progbits", "aw" },
@@ -390,7 +401,7 @@ static bool entity_is_string_const(const ir_entity *ent, bool only_suffix_null)
 	return initializer_is_string_const(init, only_suffix_null);
 }
 
-static bool entity_is_zero_initialized(ir_entity const *entity)
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity)
 {
 	if (is_alias_entity(entity))
 		return false;
@@ -486,13 +497,14 @@ static be_gas_section_t determine_basic_section(const ir_entity *entity)
 			return GAS_SECTION_RODATA;
 		}
 	}
-	if (entity_is_zero_initialized(entity))
+	if (be_gas_entity_is_zero_initialized(entity))
 		return GAS_SECTION_BSS;
 
 	return GAS_SECTION_DATA;
 }
 
-static be_gas_section_t determine_section(be_main_env_t const *const main_env, ir_entity const *const entity)
+be_gas_section_t be_gas_determine_section(be_main_env_t const *const main_env,
+                                          ir_entity const *const entity)
 {
 	ir_type *owner = get_entity_owner(entity);
 
@@ -611,10 +623,18 @@ static void emit_visibility(const ir_entity *entity, bool implicit_globl)
 void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
                                  const parameter_dbg_info_t *parameter_infos)
 {
+	if (be_options.emit_object)
+		panic("object file output not supported by this backend");
+
 	be_dwarf_function_before(entity, parameter_infos);
 
-	be_gas_section_t section = determine_section(NULL, entity);
+	/* Do not rely on the section of preceding output: the code of each
+	 * function is emitted into its own buffer and has to stand alone. */
+	current_section = (be_gas_section_t)-1;
+	be_gas_section_t section = be_gas_determine_section(NULL, entity);
 	emit_section(section, entity);
+	function_section = section;
+	function_entity  = entity;
 
 	/* write the begin line (makes the life easier for scripts parsing the
 	 * assembler) */
@@ -671,18 +691,25 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 	be_dwarf_function_begin();
 }
 
+static void emit_function_size(const ir_entity *entity, const char *suffix)
+{
+	be_emit_cstring("\t.size\t");
+	be_gas_emit_entity(entity);
+	be_emit_string(suffix);
+	be_emit_cstring(", .-");
+	be_gas_emit_entity(entity);
+	be_emit_string(suffix);
+	be_emit_char('\n');
+	be_emit_write_line();
+}
+
 void be_gas_emit_function_epilog(const ir_entity *entity)
 {
 	be_dwarf_function_end();
 
-	if (be_gas_object_file_format == OBJECT_FILE_FORMAT_ELF) {
-		be_emit_cstring("\t.size\t");
-		be_gas_emit_entity(entity);
-		be_emit_cstring(", .-");
-		be_gas_emit_entity(entity);
-		be_emit_char('\n');
-		be_emit_write_line();
-	}
+	if (be_gas_object_file_format == OBJECT_FILE_FORMAT_ELF)
+		emit_function_size(entity, in_cold_part ? ".cold" : "");
+	in_cold_part = false;
 
 	if (be_options.verbose_asm) {
 		be_emit_cstring("# -- End  ");
@@ -693,11 +720,43 @@ void be_gas_emit_function_epilog(const ir_entity *entity)
 
 	be_emit_char('\n');
 	be_emit_write_line();
+	current_section = (be_gas_section_t)-1;
 
 	next_block_nr += 199;
 	next_block_nr -= next_block_nr % 100;
 }
 
+bool be_gas_can_split_function(const ir_entity *entity)
+{
+	/* the cold part is a separate symbol, which debug info and call frame
+	 * information do not describe */
+	return !be_options.emit_object
+	    && be_gas_object_file_format == OBJECT_FILE_FORMAT_ELF
+	    && be_gas_elf_variant == ELF_VARIANT_NORMAL
+	    && !be_dwarf_enabled()
+	    && be_gas_determine_section(NULL, entity) == GAS_SECTION_TEXT;
+}
+
+void be_gas_begin_cold_part(const ir_entity *entity)
+{
+	assert(be_gas_can_split_function(entity));
+	assert(!in_cold_part);
+	emit_function_size(entity, "");
+	emit_section(GAS_SECTION_TEXT_UNLIKELY, entity);
+	function_section = GAS_SECTION_TEXT_UNLIKELY;
+
+	be_emit_cstring("\t.type\t");
+	be_gas_emit_entity(entity);
+	be_emit_cstring(".cold, ");
+	be_emit_char(be_gas_elf_type_char);
+	be_emit_cstring("function\n");
+	be_emit_write_line();
+	be_gas_emit_entity(entity);
+	be_emit_cstring(".cold:\n");
+	be_emit_write_line();
+	in_cold_part = true;
+}
+
 /**
  * Output parts of a tarval.
  *
@@ -718,6 +777,8 @@ static void emit_tv(ir_tarval *const tv, unsigned const offset, unsigned const n
  */
 const char *be_gas_insn_label_prefix(void)
 {
+	/* the labels are numbered throughout the compilation unit */
+	standalone_ok = false;
 	return ".LE";
 }
 
@@ -931,7 +992,7 @@ static size_t get_initializer_size(const ir_initializer_t *initializer,
 	panic("found invalid initializer");
 }
 
-static unsigned long compute_entity_size(ir_entity const *const entity)
+unsigned long be_gas_get_entity_size(ir_entity const *const entity)
 {
 	ir_type *const type = get_entity_type(entity);
 	unsigned long  size = get_type_size_bytes(type);
@@ -1235,7 +1296,7 @@ static void emit_align(unsigned p2alignment)
 	be_emit_write_line();
 }
 
-static unsigned get_effective_entity_alignment(const ir_entity *entity)
+unsigned be_gas_get_entity_alignment(const ir_entity *entity)
 {
 	unsigned alignment = get_entity_alignment(entity);
 	if (alignment == 0) {
@@ -1248,7 +1309,7 @@ static unsigned get_effective_entity_alignment(const ir_entity *entity)
 static void emit_common(const ir_entity *entity, unsigned long size,
                         bool is_local)
 {
-	unsigned const alignment = get_effective_entity_alignment(entity);
+	unsigned const alignment = be_gas_get_entity_alignment(entity);
 
 	switch (be_gas_object_file_format) {
 	case OBJECT_FILE_FORMAT_MACH_O:
@@ -1284,7 +1345,7 @@ static void emit_zerofill(const ir_entity *entity, const char *section_segment,
 	be_emit_char(',');
 	be_gas_emit_entity(entity);
 	unsigned const alignment
-		= get_effective_entity_alignment(entity);
+		= be_gas_get_entity_alignment(entity);
 	be_emit_irprintf(",%lu,%u\n", size, log2_floor(alignment));
 	be_emit_write_line();
 }
@@ -1323,6 +1384,22 @@ static void emit_alias(const ir_entity *entity)
 	be_emit_write_line();
 }
 
+void be_gas_begin_standalone(char const *prefix, long first_backend_nr)
+{
+	assert(standalone_prefix == NULL);
+	standalone_prefix        = prefix;
+	standalone_first_nr      = first_backend_nr;
+	standalone_ok            = true;
+	standalone_next_block_nr = 0;
+}
+
+bool be_gas_end_standalone(void)
+{
+	assert(standalone_prefix != NULL);
+	standalone_prefix = NULL;
+	return standalone_ok;
+}
+
 char const *be_gas_get_private_prefix(void)
 {
 	return be_gas_object_file_format == OBJECT_FILE_FORMAT_MACH_O ? "L" : ".L";
@@ -1341,9 +1418,20 @@ static bool check_needs_quotes(char const *const s)
 
 void be_gas_emit_entity(const ir_entity *entity)
 {
+	/* backend entities of the function get a local name, other entities
+	 * created by the backend are shared with the rest of the unit */
+	bool const local = standalone_prefix != NULL
+	                && entity->owner == irp->dummy_owner;
+	if (standalone_prefix != NULL && !local
+	    && (entity->entity_kind == IR_ENTITY_LABEL
+	        || get_entity_nr(entity) >= standalone_first_nr))
+		standalone_ok = false;
+
 	if (entity->entity_kind == IR_ENTITY_LABEL) {
 		ir_label_t label = get_entity_label(entity);
-		be_emit_irprintf("%s_%lu", be_gas_get_private_prefix(), label);
+		be_emit_string(be_gas_get_private_prefix());
+		be_emit_char('_');
+		be_emit_uint(label);
 		return;
 	}
 
@@ -1353,6 +1441,8 @@ void be_gas_emit_entity(const ir_entity *entity)
 		be_emit_char('"');
 	if (get_entity_visibility(entity) == ir_visibility_private) {
 		be_emit_string(be_gas_get_private_prefix());
+		if (local)
+			be_emit_string(standalone_prefix);
 	}
 	be_emit_string(name);
 	if (needs_quotes)
@@ -1368,12 +1458,16 @@ void be_gas_emit_block_name(const ir_node *block)
 		void *nr_val = pmap_get(void, block_numbers, block);
 		int   nr;
 		if (nr_val == NULL) {
-			nr = next_block_nr++;
+			nr = standalone_prefix != NULL ? standalone_next_block_nr++
+			                               : next_block_nr++;
 			pmap_insert(block_numbers, block, INT_TO_PTR(nr+1));
 		} else {
 			nr = PTR_TO_INT(nr_val)-1;
 		}
-		be_emit_irprintf("%s%d", be_gas_get_private_prefix(), nr);
+		be_emit_string(be_gas_get_private_prefix());
+		if (standalone_prefix != NULL)
+			be_emit_string(standalone_prefix);
+		be_emit_int(nr);
 	}
 }
 
@@ -1426,7 +1520,7 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	/* we already emitted all functions with graphs in other functions like
 	 * be_gas_emit_function_prolog(). All others don't need to be emitted. */
-	be_gas_section_t const section = determine_section(main_env, entity);
+	be_gas_section_t const section = be_gas_determine_section(main_env, entity);
 	if (kind == IR_ENTITY_METHOD && section != GAS_SECTION_PIC_TRAMPOLINES)
 		return;
 
@@ -1441,8 +1535,8 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	ir_visibility const visibility       = get_entity_visibility(entity);
 	ir_linkage    const linkage          = get_entity_linkage(entity);
-	bool          const zero_initializer = entity_is_zero_initialized(entity);
-	unsigned long       size             = compute_entity_size(entity);
+	bool          const zero_initializer = be_gas_entity_is_zero_initialized(entity);
+	unsigned long       size             = be_gas_get_entity_size(entity);
 
 	/* We need to output at least 1 byte, otherwise macho will merge
 	 * the label with the next thing */
@@ -1497,7 +1591,7 @@ static void emit_global(be_main_env_t const *const main_env,
 	}
 
 	/* alignment */
-	unsigned alignment = get_effective_entity_alignment(entity);
+	unsigned alignment = be_gas_get_entity_alignment(entity);
 	if (!is_po2(alignment))
 		panic("alignment not a power of 2");
 	if (alignment > 1) {
@@ -1570,9 +1664,9 @@ static void emit_global_decls(const be_main_env_t *main_env)
 	}
 }
 
-void be_emit_jump_table(const ir_node *node, const ir_switch_table *table,
-                        ir_entity const *const entity, ir_mode *entry_mode,
-                        emit_target_func emit_target)
+ir_node const **be_get_jump_table_targets(ir_node const *const node,
+                                          ir_switch_table const *const table,
+                                          unsigned long *const length_res)
 {
 	/* go over all proj's and collect their jump targets */
 	unsigned        n_outs  = arch_get_irn_n_outs(node);
@@ -1635,6 +1729,22 @@ void be_emit_jump_table(const ir_node *node, const ir_switch_table *table,
 			}
 		}
 	}
+	for (unsigned long i = 0; i < length; ++i) {
+		if (labels[i] == NULL)
+			labels[i] = targets[0];
+	}
+
+	free(targets);
+	*length_res = length;
+	return labels;
+}
+
+void be_emit_jump_table(const ir_node *node, const ir_switch_table *table,
+                        ir_entity const *const entity, ir_mode *entry_mode,
+                        emit_target_func emit_target)
+{
+	unsigned long   length;
+	const ir_node **labels = be_get_jump_table_targets(node, table, &length);
 
 	/* emit table */
 	unsigned pointer_size = get_mode_size_bytes(entry_mode);
@@ -1647,21 +1757,18 @@ void be_emit_jump_table(const ir_node *node, const ir_switch_table *table,
 	}
 
 	for (unsigned long i = 0; i < length; ++i) {
-		const ir_node *target = labels[i];
-		if (target == NULL)
-			target = targets[0];
 		emit_size_type(pointer_size);
-		emit_target(entity, target);
+		emit_target(entity, labels[i]);
 		be_emit_char('\n');
 		be_emit_write_line();
 	}
 
+	/* continue in the section of the function, which may be the cold one */
 	if (entity != NULL
 	 && be_gas_object_file_format != OBJECT_FILE_FORMAT_MACH_O)
-		be_gas_emit_switch_section(GAS_SECTION_TEXT);
+		emit_section(function_section, function_entity);
 
 	free(labels);
-	free(targets);
 }
 
 static void emit_global_asms(void)
@@ -19,6 +19,7 @@
 
 typedef enum {
 	GAS_SECTION_TEXT,            /**< text section - program code */
+	GAS_SECTION_TEXT_UNLIKELY,   /**< rarely executed program code */
 	GAS_SECTION_DATA,            /**< data section - arbitrary data */
 	GAS_SECTION_RODATA,          /**< read only data no relocations */
 	GAS_SECTION_REL_RO,          /**< read only data containing relocations */
@@ -72,8 +73,61 @@ void be_gas_emit_function_prolog(const ir_entity *entity,
 
 void be_gas_emit_function_epilog(const ir_entity *entity);
 
+/**
+ * Returns whether the code of function @p entity may be split into a hot
+ * and a cold part, see be_gas_begin_cold_part().
+ */
+bool be_gas_can_split_function(const ir_entity *entity);
+
+/**
+ * Ends the hot part of the function @p entity and continues its code in the
+ * section for rarely executed code. The cold part ends with
+ * be_gas_emit_function_epilog().
+ */
+void be_gas_begin_cold_part(const ir_entity *entity);
+
+/**
+ * Determine the section an entity is placed in.
+ */
+be_gas_section_t be_gas_determine_section(be_main_env_t const *main_env,
+                                          ir_entity const *entity);
+
+/**
+ * Returns true if the entity is initialized with zeros only.
+ */
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity);
+
+/**
+ * Returns the size of an entity in bytes, this includes the variable sized
+ * parts given by its initializer.
+ */
+unsigned long be_gas_get_entity_size(ir_entity const *entity);
+
+/**
+ * Returns the alignment of an entity in bytes.
+ */
+unsigned be_gas_get_entity_alignment(ir_entity const *entity);
+
 char const *be_gas_get_private_prefix(void);
 
+/**
+ * Starts emitting code which does not depend on the rest of the compilation
+ * unit, so it may be copied into another one. The private labels of the code
+ * get @p prefix, which has to be unique in the compilation unit. Entities
+ * with a number of at least @p first_backend_nr were created by the backend;
+ * they are shared with other functions, so code referencing them is not
+ * standalone.
+ */
+void be_gas_begin_standalone(char const *prefix, long first_backend_nr);
+
+/**
+ * Ends emitting standalone code.
+ *
+ * @return true if the code emitted since be_gas_begin_standalone() is
+ *         standalone
+ */
+bool be_gas_end_standalone(void);
+
 /**
  * emit ld_ident of an entity and performs additional mangling if necessary.
  * (mangling is necessary for ir_visibility_private for example).
@@ -121,6 +175,15 @@ void be_gas_end_compilation_unit(const be_main_env_t *env);
  */
 const char *be_gas_insn_label_prefix(void);
 
+/**
+ * Returns the jump targets of a switch as array indexed by the switch value.
+ * Values not in the table jump to the default target. The array has to be
+ * freed by the caller.
+ */
+ir_node const **be_get_jump_table_targets(ir_node const *node,
+                                          ir_switch_table const *table,
+                                          unsigned long *length);
+
 typedef void (*emit_target_func)(ir_entity const *table, ir_node const *proj_x);
 
 /**
@@ -9,7 +9,9 @@
  * @author      Sebastian Hack
  * @date        18.11.2005
  */
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "bechordal_t.h"
 #include "lc_opts.h"
@@ -24,12 +26,38 @@
 #include "beirg.h"
 #include "bemodule.h"
 #include "belive.h"
+#include "raw_bitset.h"
+#include "array.h"
+#include "util.h"
+
+/** Graphs with at most this many nodes get an interference bit matrix. */
+#define MATRIX_MAX_NODES 4096
+
+/** Marks nodes which are not part of a materialized graph. */
+#define NO_NODE UINT_MAX
 
 void be_ifg_free(be_ifg_t *self)
 {
+	free(self->nodes);
+	free(self->idx_to_node);
+	free(self->adj_begin);
+	free(self->adj);
+	free(self->matrix);
 	free(self);
 }
 
+/**
+ * Returns the position of @p irn in a materialized graph or NO_NODE if the
+ * node is not part of it.
+ */
+static unsigned get_node_pos(const be_ifg_t *ifg, const ir_node *irn)
+{
+	if (ifg->nodes == NULL)
+		return NO_NODE;
+	unsigned const idx = get_irn_idx(irn);
+	return idx < ifg->n_idx ? ifg->idx_to_node[idx] : NO_NODE;
+}
+
 static void nodes_walker(ir_node *bl, void *data)
 {
 	nodes_iter_t     *it   = (nodes_iter_t*)data;
@@ -46,10 +74,18 @@ static void nodes_walker(ir_node *bl, void *data)
 nodes_iter_t be_ifg_nodes_begin(be_ifg_t const *const ifg)
 {
 	nodes_iter_t iter;
-	obstack_init(&iter.obst);
-	iter.n    = 0;
 	iter.curr = 0;
 	iter.env  = ifg->env;
+	if (ifg->nodes != NULL) {
+		iter.own_nodes = false;
+		iter.n         = ifg->n_nodes;
+		iter.nodes     = ifg->nodes;
+		return iter;
+	}
+
+	obstack_init(&iter.obst);
+	iter.own_nodes = true;
+	iter.n         = 0;
 
 	irg_block_walk_graph(ifg->env->irg, nodes_walker, NULL, &iter);
 	obstack_ptr_grow(&iter.obst, NULL);
@@ -62,7 +98,8 @@ ir_node *be_ifg_nodes_next(nodes_iter_t *const it)
 	if (it->curr < it->n) {
 		return it->nodes[it->curr++];
 	} else {
-		obstack_free(&it->obst, NULL);
+		if (it->own_nodes)
+			obstack_free(&it->obst, NULL);
 		return NULL;
 	}
 }
@@ -102,6 +139,16 @@ static void find_neighbours(const be_ifg_t *ifg, neighbours_iter_t *it, const ir
 	it->env         = ifg->env;
 	it->irn         = irn;
 	it->valid       = 1;
+
+	unsigned const pos = get_node_pos(ifg, irn);
+	if (pos != NO_NODE) {
+		it->nodes   = ifg->nodes;
+		it->adj     = &ifg->adj[ifg->adj_begin[pos]];
+		it->adj_end = &ifg->adj[ifg->adj_begin[pos + 1]];
+		return;
+	}
+
+	it->adj_end     = NULL;
 	ir_nodeset_init(&it->neighbours);
 
 	dom_tree_walk(get_nodes_block(irn), find_neighbour_walker, NULL, it);
@@ -113,12 +160,16 @@ static inline void neighbours_break(neighbours_iter_t *it, int force)
 {
 	(void) force;
 	assert(it->valid == 1);
-	ir_nodeset_destroy(&it->neighbours);
+	if (it->adj_end == NULL)
+		ir_nodeset_destroy(&it->neighbours);
 	it->valid = 0;
 }
 
 static ir_node *get_next_neighbour(neighbours_iter_t *it)
 {
+	if (it->adj_end != NULL)
+		return it->adj != it->adj_end ? it->nodes[*it->adj++] : NULL;
+
 	ir_node *res = ir_nodeset_iterator_next(&it->iter);
 
 	if (res == NULL) {
@@ -243,6 +294,10 @@ void be_ifg_cliques_break(cliques_iter_t *iter)
 
 int be_ifg_degree(const be_ifg_t *ifg, const ir_node *irn)
 {
+	unsigned const pos = get_node_pos(ifg, irn);
+	if (pos != NO_NODE)
+		return ifg->adj_begin[pos + 1] - ifg->adj_begin[pos];
+
 	neighbours_iter_t it;
 	int degree;
 	find_neighbours(ifg, &it, irn);
@@ -251,10 +306,190 @@ int be_ifg_degree(const be_ifg_t *ifg, const ir_node *irn)
 	return degree;
 }
 
-be_ifg_t *be_create_ifg(const be_chordal_env_t *env)
+/** Returns the bit of the pair @p a, @p b in the triangular matrix. */
+static size_t matrix_pos(unsigned a, unsigned b)
+{
+	if (a < b) {
+		unsigned const t = a;
+		a = b;
+		b = t;
+	}
+	return (size_t)a * (a - 1) / 2 + b;
+}
+
+static int cmp_unsigned(const void *p1, const void *p2)
+{
+	unsigned const u1 = *(const unsigned*)p1;
+	unsigned const u2 = *(const unsigned*)p2;
+	return (u1 > u2) - (u1 < u2);
+}
+
+bool be_ifg_interferes(const be_ifg_t *ifg, const ir_node *a,
+                       const ir_node *b)
+{
+	unsigned const pos_a = get_node_pos(ifg, a);
+	unsigned const pos_b = get_node_pos(ifg, b);
+	if (pos_a == NO_NODE || pos_b == NO_NODE) {
+		if (a == b)
+			return false;
+		/* the results of one node are defined together, the liveness does
+		 * not order them, but the borders and so the neighbours do */
+		if (skip_Proj_const(a) == skip_Proj_const(b))
+			return true;
+		/* asking the liveness is cheaper than enumerating the neighbours */
+		return be_values_interfere(a, b);
+	}
+	if (pos_a == pos_b)
+		return false;
+	if (ifg->matrix != NULL)
+		return rbitset_is_set(ifg->matrix, matrix_pos(pos_a, pos_b));
+
+	/* search the shorter adjacency array */
+	unsigned const deg_a = ifg->adj_begin[pos_a + 1] - ifg->adj_begin[pos_a];
+	unsigned const deg_b = ifg->adj_begin[pos_b + 1] - ifg->adj_begin[pos_b];
+	unsigned const pos   = deg_a <= deg_b ? pos_a : pos_b;
+	unsigned const other = deg_a <= deg_b ? pos_b : pos_a;
+	return bsearch(&other, &ifg->adj[ifg->adj_begin[pos]],
+	               ifg->adj_begin[pos + 1] - ifg->adj_begin[pos],
+	               sizeof(ifg->adj[0]), cmp_unsigned) != NULL;
+}
+
+typedef struct ifg_edge_t {
+	unsigned src;
+	unsigned dst;
+} ifg_edge_t;
+
+typedef struct materialize_env_t {
+	be_ifg_t   *ifg;
+	ir_node   **nodes;  /**< flexible array of the nodes */
+	unsigned   *living; /**< flexible array of the live nodes */
+	ifg_edge_t *edges;  /**< flexible array of the edges, both directions */
+} materialize_env_t;
+
+static void collect_nodes_walker(ir_node *block, void *data)
+{
+	materialize_env_t *env  = (materialize_env_t*)data;
+	be_ifg_t          *ifg  = env->ifg;
+	struct list_head  *head = get_block_border_head(ifg->env, block);
+
+	foreach_border_head(head, b) {
+		if (b->is_def && b->is_real) {
+			ifg->idx_to_node[get_irn_idx(b->irn)] = ARR_LEN(env->nodes);
+			ARR_APP1(ir_node*, env->nodes, b->irn);
+		}
+	}
+}
+
+/**
+ * A node interferes with all nodes that are live where it is defined. This is
+ * the same relation find_neighbours() computes for a single node. Only the
+ * real definitions add edges: two values live into a block interfere where
+ * the later of them is defined, so the definitions at the start of the
+ * blocks they are live in would only repeat that edge. Every edge is thus
+ * added once.
+ */
+static void collect_edges_walker(ir_node *block, void *data)
+{
+	materialize_env_t *env  = (materialize_env_t*)data;
+	be_ifg_t          *ifg  = env->ifg;
+	struct list_head  *head = get_block_border_head(ifg->env, block);
+
+	ARR_SHRINKLEN(env->living, 0);
+	foreach_border_head(head, b) {
+		unsigned const pos = get_node_pos(ifg, b->irn);
+		if (pos == NO_NODE)
+			continue;
+		if (b->is_def) {
+			if (b->is_real) {
+				for (size_t i = 0, n = ARR_LEN(env->living); i < n; ++i) {
+					unsigned   const other = env->living[i];
+					ifg_edge_t const e0    = { pos, other };
+					ifg_edge_t const e1    = { other, pos };
+					ARR_APP1(ifg_edge_t, env->edges, e0);
+					ARR_APP1(ifg_edge_t, env->edges, e1);
+				}
+			}
+			ARR_APP1(unsigned, env->living, pos);
+		} else {
+			size_t const n = ARR_LEN(env->living);
+			for (size_t i = 0; i < n; ++i) {
+				if (env->living[i] == pos) {
+					env->living[i] = env->living[n - 1];
+					ARR_SHRINKLEN(env->living, n - 1);
+					break;
+				}
+			}
+		}
+	}
+}
+
+static void materialize_ifg(be_ifg_t *ifg)
+{
+	ir_graph *const irg = ifg->env->irg;
+	materialize_env_t env;
+	env.ifg    = ifg;
+	env.nodes  = NEW_ARR_F(ir_node*, 0);
+	env.living = NEW_ARR_F(unsigned, 0);
+	env.edges  = NEW_ARR_F(ifg_edge_t, 0);
+
+	ifg->n_idx       = get_irg_last_idx(irg);
+	ifg->idx_to_node = XMALLOCN(unsigned, ifg->n_idx);
+	memset(ifg->idx_to_node, 0xFF, ifg->n_idx * sizeof(ifg->idx_to_node[0]));
+	irg_block_walk_graph(irg, collect_nodes_walker, NULL, &env);
+
+	unsigned const n_nodes = ARR_LEN(env.nodes);
+	ifg->n_nodes = n_nodes;
+	ifg->nodes   = XMALLOCN(ir_node*, n_nodes);
+	MEMCPY(ifg->nodes, env.nodes, n_nodes);
+	DEL_ARR_F(env.nodes);
+
+	irg_block_walk_graph(irg, collect_edges_walker, NULL, &env);
+
+	unsigned *const adj_begin = XMALLOCNZ(unsigned, n_nodes + 1);
+	size_t    const n_edges   = ARR_LEN(env.edges);
+	for (size_t i = 0; i < n_edges; ++i)
+		++adj_begin[env.edges[i].src + 1];
+	for (unsigned i = 0; i < n_nodes; ++i)
+		adj_begin[i + 1] += adj_begin[i];
+	unsigned *const adj  = XMALLOCN(unsigned, n_edges);
+	unsigned *const fill = XMALLOCN(unsigned, n_nodes);
+	MEMCPY(fill, adj_begin, n_nodes);
+	for (size_t i = 0; i < n_edges; ++i)
+		adj[fill[env.edges[i].src]++] = env.edges[i].dst;
+	free(fill);
+	DEL_ARR_F(env.edges);
+	DEL_ARR_F(env.living);
+
+	/* sort the adjacency arrays for be_ifg_interferes() */
+	for (unsigned i = 0; i < n_nodes; ++i) {
+		unsigned const begin = adj_begin[i];
+		unsigned const end   = adj_begin[i + 1];
+		qsort(&adj[begin], end - begin, sizeof(adj[0]), cmp_unsigned);
+#ifndef NDEBUG
+		for (unsigned e = begin + 1; e < end; ++e)
+			assert(adj[e] != adj[e - 1] && "edge added twice");
+#endif
+	}
+	ifg->adj_begin = adj_begin;
+	ifg->adj       = adj;
+
+	if (n_nodes <= MATRIX_MAX_NODES) {
+		ifg->matrix = rbitset_malloc(matrix_pos(n_nodes, 0));
+		for (unsigned i = 0; i < n_nodes; ++i) {
+			for (unsigned e = adj_begin[i]; e < adj_begin[i + 1]; ++e) {
+				if (adj[e] < i)
+					rbitset_set(ifg->matrix, matrix_pos(i, adj[e]));
+			}
+		}
+	}
+}
+
+be_ifg_t *be_create_ifg(const be_chordal_env_t *env, bool materialize)
 {
-	be_ifg_t *ifg = XMALLOC(be_ifg_t);
+	be_ifg_t *ifg = XMALLOCZ(be_ifg_t);
 	ifg->env = env;
+	if (materialize)
+		materialize_ifg(ifg);
 
 	return ifg;
 }
@@ -17,13 +17,29 @@
 #include "irnodeset.h"
 #include "pset.h"
 
+/**
+ * The interference graph of a register class. By default it only refers to
+ * the chordal borders and every query walks them again. A materialized graph
+ * stores the nodes and their sorted adjacency arrays, small graphs
+ * additionally get a triangular bit matrix for interference tests.
+ */
 struct be_ifg_t {
 	const be_chordal_env_t *env;
+	/* the remaining fields are only set for a materialized graph */
+	unsigned   n_nodes;
+	ir_node  **nodes;       /**< the nodes, NULL if not materialized */
+	unsigned   n_idx;       /**< size of the idx_to_node map */
+	unsigned  *idx_to_node; /**< maps node indices to positions in nodes */
+	unsigned  *adj_begin;   /**< the neighbours of nodes[i] are at adj[
+	                             adj_begin[i]] up to adj[adj_begin[i+1]] */
+	unsigned  *adj;         /**< neighbour positions, sorted per node */
+	unsigned  *matrix;      /**< triangular interference bit matrix */
 };
 
 typedef struct nodes_iter_t {
 	const be_chordal_env_t *env;
 	struct obstack         obst;
+	bool                   own_nodes; /**< nodes were collected into obst */
 	int                    n;
 	int                    curr;
 	ir_node                **nodes;
@@ -35,6 +51,10 @@ typedef struct neighbours_iter_t {
 	int                   valid;
 	ir_nodeset_t          neighbours;
 	ir_nodeset_iterator_t iter;
+	/* used instead of the node set for a materialized graph */
+	ir_node *const       *nodes;
+	const unsigned       *adj;
+	const unsigned       *adj_end;
 } neighbours_iter_t;
 
 typedef struct cliques_iter_t {
@@ -60,6 +80,16 @@ int      be_ifg_cliques_next(cliques_iter_t *iter);
 void     be_ifg_cliques_break(cliques_iter_t *iter);
 int      be_ifg_degree(const be_ifg_t *ifg, const ir_node *irn);
 
+/**
+ * Checks whether @p a and @p b are neighbours in the interference graph. This
+ * is a constant time test for small materialized graphs and a binary search
+ * for large ones. For implicit graphs and nodes outside the graph, the answer
+ * is be_values_interfere(), except that two results of the same node always
+ * interfere, as they do in both graphs.
+ */
+bool     be_ifg_interferes(const be_ifg_t *ifg, const ir_node *a,
+                           const ir_node *b);
+
 #define be_ifg_foreach_neighbour(ifg, iter, irn, pos) \
 	for (ir_node *pos = be_ifg_neighbours_begin(ifg, iter, irn); pos; pos = be_ifg_neighbours_next(iter))
 
@@ -81,6 +111,11 @@ typedef struct {
 
 void be_ifg_stat(ir_graph *irg, be_ifg_t *ifg, be_ifg_stat_t *stat);
 
-be_ifg_t *be_create_ifg(const be_chordal_env_t *env);
+/**
+ * Creates the interference graph for the current register class of @p env.
+ * If @p materialize is set, the graph is built once from the chordal borders,
+ * otherwise every query walks the borders again.
+ */
+be_ifg_t *be_create_ifg(const be_chordal_env_t *env, bool materialize);
 
 #endif
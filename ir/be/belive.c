@@ -18,6 +18,7 @@
 #include "irprintf.h"
 #include "irdump_t.h"
 #include "irnodeset.h"
+#include "irtools.h"
 
 #include "statev_t.h"
 #include "be_t.h"
@@ -25,11 +26,37 @@
 #include "besched.h"
 #include "bemodule.h"
 #include "beirg.h"
+#include "lc_opts.h"
+#include "lc_opts_enum.h"
+#include "util.h"
+#include "xmalloc.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
 #define LV_STD_SIZE             63
 
+typedef enum lv_representation_t {
+	LV_SETS,    /**< sorted arrays of the live values of each block */
+	LV_BITSETS, /**< bitsets over densely numbered values */
+} lv_representation_t;
+
+static int lv_representation = LV_SETS;
+
+static const lc_opt_enum_int_items_t lv_representation_items[] = {
+	{ "sets",    LV_SETS    },
+	{ "bitsets", LV_BITSETS },
+	{ NULL, 0 }
+};
+
+static lc_opt_enum_int_var_t lv_representation_var = {
+	&lv_representation, lv_representation_items
+};
+
+static const lc_opt_table_entry_t be_live_options[] = {
+	LC_OPT_ENT_ENUM_INT("liveness", "representation of the live sets", &lv_representation_var),
+	LC_OPT_LAST
+};
+
 static unsigned _be_liveness_bsearch(be_lv_info_t const *const arr, ir_node const *const node)
 {
 	unsigned const n = arr->n_members;
@@ -160,11 +187,49 @@ static void lv_remove_irn_walker(ir_node *const bl, void *const data)
 }
 
 static struct {
-	be_lv_t *lv;         /**< The liveness object. */
-	ir_node *def;        /**< The node (value). */
-	ir_node *def_block;  /**< The block of def. */
+	be_lv_t       *lv;         /**< The liveness object. */
+	ir_node       *def;        /**< The node (value). */
+	ir_node       *def_block;  /**< The block of def. */
+	be_lv_class_t *cls;        /**< The class of def if the sets are bits. */
+	unsigned       nr;         /**< The number of def in cls. */
 } re;
 
+static unsigned *get_block_sets(be_lv_class_t const *const cls,
+                                unsigned const bl_nr)
+{
+	return &cls->sets[bl_nr * 3 * cls->n_words];
+}
+
+/**
+ * Adds the liveness bits @p state of the value re.def at a block.
+ * @return The liveness bits before.
+ */
+static be_lv_state_t add_live_state(ir_node *const block,
+                                    be_lv_state_t const state)
+{
+	if (re.cls == NULL) {
+		be_lv_info_node_t *const n      = be_lv_get_or_set(re.lv, block, re.def);
+		be_lv_state_t      const before = n->flags;
+		n->flags |= state;
+		return before;
+	}
+
+	/* state bit k lives in set k of the block */
+	be_lv_bits_t  const *const bits   = &re.lv->bits;
+	unsigned             const bl_nr  = be_lv_bits_get_block_nr(bits, block);
+	unsigned            *const sets   = get_block_sets(re.cls, bl_nr) + re.nr / BITS_PER_ELEM;
+	unsigned             const mask   = 1u << re.nr % BITS_PER_ELEM;
+	be_lv_state_t              before = be_lv_state_none;
+	for (unsigned k = 0; k < 3; ++k) {
+		unsigned *const word = &sets[k * re.cls->n_words];
+		if (*word & mask)
+			before |= 1u << k;
+		if (state & (1u << k))
+			*word |= mask;
+	}
+	return before;
+}
+
 /**
  * Mark a node (value) live out at a certain block. Do this also
  * transitively, i.e. if the block is not the block of the value's
@@ -174,13 +239,10 @@ static struct {
  */
 static void live_end_at_block(ir_node *const block, be_lv_state_t const state)
 {
-	be_lv_info_node_t *const n      = be_lv_get_or_set(re.lv, block, re.def);
-	be_lv_state_t      const before = n->flags;
-
 	assert(state == be_lv_state_end || state == (be_lv_state_end | be_lv_state_out));
 	DBG((dbg, LEVEL_2, "marking %+F live %s at %+F\n", re.def,
 	     state & be_lv_state_out ? "end+out" : "end", block));
-	n->flags |= state;
+	be_lv_state_t const before = add_live_state(block, state);
 
 	/* There is no need to recurse further, if we where here before (i.e., any
 	 * live state bits were set before). */
@@ -192,7 +254,7 @@ static void live_end_at_block(ir_node *const block, be_lv_state_t const state)
 		return;
 
 	DBG((dbg, LEVEL_2, "marking %+F live in at %+F\n", re.def, block));
-	n->flags |= be_lv_state_in;
+	add_live_state(block, be_lv_state_in);
 
 	for (unsigned i = get_Block_n_cfgpreds(block); i-- > 0;) {
 		ir_node *const pred_block = get_Block_cfgpred_block(block, i);
@@ -235,9 +297,8 @@ static void liveness_for_node(ir_node *irn)
 		} else if (def_block != use_block) {
 			/* Else, the value is live in at this block. Mark it and call live
 			 * out on the predecessors. */
-			be_lv_info_node_t *const n = be_lv_get_or_set(re.lv, use_block, irn);
 			DBG((dbg, LEVEL_2, "marking %+F live in at %+F\n", irn, use_block));
-			n->flags |= be_lv_state_in;
+			add_live_state(use_block, be_lv_state_in);
 
 			for (unsigned i = get_Block_n_cfgpreds(use_block); i-- > 0; ) {
 				ir_node *pred_block = get_Block_cfgpred_block(use_block, i);
@@ -258,12 +319,347 @@ static void collect_liveness_nodes(ir_node *irn, void *data)
 		nodes[get_irn_idx(irn)] = irn;
 }
 
+/**
+ * Returns the index of the class of the bitsets for values of register class
+ * @p cls. All values without a real register class share the last one.
+ */
+static unsigned get_class_index(be_lv_bits_t const *const bits,
+                                arch_register_class_t const *const cls)
+{
+	unsigned const last = bits->n_classes - 1;
+	return cls != NULL && cls->index < last ? cls->index : last;
+}
+
+/**
+ * Returns the class of the bitsets of @p value and its number in @p nr or NULL
+ * if the value has no number.
+ */
+static be_lv_class_t *find_value(be_lv_bits_t const *const bits,
+                                 ir_node const *const value,
+                                 unsigned *const nr)
+{
+	unsigned const idx = get_irn_idx(value);
+	if (idx >= ARR_LEN(bits->values))
+		return NULL;
+	be_lv_value_t const *const pos = &bits->values[idx];
+	be_lv_class_t       *const cls = &bits->classes[pos->cls];
+	if (pos->nr >= ARR_LEN(cls->values) || cls->values[pos->nr] != value)
+		return NULL;
+	*nr = pos->nr;
+	return cls;
+}
+
+/**
+ * Values only used by non-Phi nodes in their own block are never live in
+ * any set, so they get no number.
+ */
+static bool has_nonlocal_use(ir_node const *const value)
+{
+	ir_node const *const block = get_nodes_block(value);
+	foreach_out_edge(value, edge) {
+		ir_node const *const use = get_edge_src_irn(edge);
+		if (is_liveness_node(use)
+		    && (is_Phi(use) || get_nodes_block(use) != block))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Gives @p value a number in its class without making room for it in the
+ * bitsets.
+ */
+static be_lv_class_t *number_value(be_lv_bits_t *const bits,
+                                   ir_node *const value, unsigned *const nr)
+{
+	be_lv_class_t *cls = find_value(bits, value, nr);
+	if (cls != NULL)
+		return cls;
+
+	unsigned const idx = get_irn_idx(value);
+	size_t   const len = ARR_LEN(bits->values);
+	if (idx >= len) {
+		size_t const new_len = MAX(idx + 1, get_irg_last_idx(get_irn_irg(value)));
+		ARR_RESIZE(be_lv_value_t, bits->values, new_len);
+		memset(&bits->values[len], 0, (new_len - len) * sizeof(*bits->values));
+	}
+
+	arch_register_req_t const *const req = arch_get_irn_register_req(value);
+	unsigned                   const c   = get_class_index(bits, req->cls);
+	cls = &bits->classes[c];
+	size_t const n_free = ARR_LEN(cls->free_nrs);
+	if (n_free > 0) {
+		*nr = cls->free_nrs[n_free - 1];
+		ARR_SHRINKLEN(cls->free_nrs, n_free - 1);
+		cls->values[*nr] = value;
+	} else {
+		*nr = ARR_LEN(cls->values);
+		ARR_APP1(ir_node*, cls->values, value);
+	}
+	bits->values[idx].cls = c;
+	bits->values[idx].nr  = *nr;
+	return cls;
+}
+
+/**
+ * Makes room for the values of @p cls in its bitsets, doubling their size if
+ * they are too small.
+ */
+static void grow_class_sets(be_lv_bits_t const *const bits,
+                            be_lv_class_t *const cls)
+{
+	unsigned const n_words = cls->n_words;
+	size_t   const n_bits  = ARR_LEN(cls->values);
+	if (n_bits <= n_words * BITS_PER_ELEM)
+		return;
+
+	unsigned const new_words = MAX(2 * n_words, (unsigned)BITSET_SIZE_ELEMS(n_bits));
+	size_t   const n_sets    = ARR_LEN(bits->blocks) * 3;
+	unsigned      *new_sets  = XMALLOCNZ(unsigned, n_sets * new_words);
+	for (size_t i = 0; i < n_sets; ++i)
+		memcpy(&new_sets[i * new_words], &cls->sets[i * n_words], n_words * sizeof(*new_sets));
+	free(cls->sets);
+	cls->sets    = new_sets;
+	cls->n_words = new_words;
+}
+
+static void number_block(ir_node *const block, void *const data)
+{
+	be_lv_bits_t *const bits = (be_lv_bits_t*)data;
+	bits->block_nrs[get_irn_idx(block)] = ARR_LEN(bits->blocks);
+	ARR_APP1(ir_node*, bits->blocks, block);
+}
+
+static void collect_nonlocal_values(ir_node *const irn, void *const data)
+{
+	ir_node ***const values = (ir_node***)data;
+	if (is_liveness_node(irn) && has_nonlocal_use(irn))
+		ARR_APP1(ir_node*, *values, irn);
+}
+
+static int cmp_node_address(const void *const a, const void *const b)
+{
+	ir_node const *const na = *(ir_node const**)a;
+	ir_node const *const nb = *(ir_node const**)b;
+	return (na > nb) - (na < nb);
+}
+
+static void set_bit_at(be_lv_class_t const *const cls, unsigned const bl_nr,
+                       unsigned const k, unsigned const nr)
+{
+	rbitset_set(get_block_sets(cls, bl_nr) + k * cls->n_words, nr);
+}
+
+/**
+ * Computes the live sets as bitsets. The uses of the values give the initial
+ * in sets and the Phi operands the initial end sets. Then the usual backward
+ * dataflow problem is solved a word at a time:
+ *   out(B) = union of in(S) over the successors S of B
+ *   end(B) = out(B) + Phi operands of the successors from B
+ *   in(B)  = uses in B + (end(B) - definitions in B)
+ */
+static void compute_sets_bits(be_lv_t *const lv)
+{
+	ir_graph     *const irg   = lv->irg;
+	be_lv_bits_t *const bits  = &lv->bits;
+	unsigned      const n_idx = get_irg_last_idx(irg);
+
+	bits->n_classes = isa_if->n_register_classes + 1;
+	bits->classes   = XMALLOCNZ(be_lv_class_t, bits->n_classes);
+	bits->blocks    = NEW_ARR_F(ir_node*, 0);
+	bits->block_nrs = NEW_ARR_FZ(unsigned, n_idx);
+	bits->values    = NEW_ARR_FZ(be_lv_value_t, n_idx);
+	for (unsigned c = 0; c < bits->n_classes; ++c) {
+		bits->classes[c].values   = NEW_ARR_F(ir_node*, 0);
+		bits->classes[c].free_nrs = NEW_ARR_F(unsigned, 0);
+	}
+
+	/* predecessors get lower numbers than their successors, except along
+	 * back edges */
+	irg_block_walk_graph(irg, NULL, number_block, bits);
+
+	/* number the values by their address, so the iteration visits them in the
+	 * same order as the sorted arrays */
+	ir_node **values = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, NULL, collect_nonlocal_values, &values);
+	QSORT_ARR(values, cmp_node_address);
+	for (size_t i = 0, n = ARR_LEN(values); i < n; ++i) {
+		unsigned nr;
+		number_value(bits, values[i], &nr);
+	}
+
+	size_t     const n_blocks = ARR_LEN(bits->blocks);
+	unsigned **const defs     = XMALLOCN(unsigned*, bits->n_classes);
+	for (unsigned c = 0; c < bits->n_classes; ++c) {
+		be_lv_class_t *const cls = &bits->classes[c];
+		grow_class_sets(bits, cls);
+		defs[c] = XMALLOCNZ(unsigned, n_blocks * cls->n_words);
+	}
+
+	for (size_t i = 0, n = ARR_LEN(values); i < n; ++i) {
+		ir_node       *const value     = values[i];
+		unsigned             nr;
+		be_lv_class_t *const cls       = find_value(bits, value, &nr);
+		unsigned       const c         = (unsigned)(cls - bits->classes);
+		ir_node       *const def_block = get_nodes_block(value);
+		unsigned       const def_nr    = be_lv_bits_get_block_nr(bits, def_block);
+		rbitset_set(&defs[c][def_nr * cls->n_words], nr);
+
+		foreach_out_edge(value, edge) {
+			ir_node *const use = get_edge_src_irn(edge);
+			if (!is_liveness_node(use))
+				continue;
+
+			ir_node *const use_block = get_nodes_block(use);
+			if (is_Phi(use)) {
+				ir_node *const pred_block = get_Block_cfgpred_block(use_block, edge->pos);
+				set_bit_at(cls, be_lv_bits_get_block_nr(bits, pred_block), 1, nr);
+			} else if (use_block != def_block) {
+				set_bit_at(cls, be_lv_bits_get_block_nr(bits, use_block), 0, nr);
+			}
+		}
+	}
+	DEL_ARR_F(values);
+
+	/* The sets only grow, so in(B) can keep its old bits instead of being
+	 * recomputed from the uses. */
+	bool changed;
+	do {
+		changed = false;
+		/* successors before predecessors, except along back edges */
+		for (size_t b = n_blocks; b-- > 0;) {
+			for (unsigned c = 0; c < bits->n_classes; ++c) {
+				be_lv_class_t  const *const cls     = &bits->classes[c];
+				unsigned              const n_words = cls->n_words;
+				unsigned             *const in      = get_block_sets(cls, b);
+				unsigned       const *const end     = in + n_words;
+				unsigned       const *const def     = &defs[c][b * n_words];
+				for (unsigned w = 0; w < n_words; ++w)
+					in[w] |= end[w] & ~def[w];
+			}
+
+			ir_node *const block = bits->blocks[b];
+			for (int i = get_Block_n_cfgpreds(block); i-- > 0;) {
+				ir_node  *const pred_block = get_Block_cfgpred_block(block, i);
+				unsigned  const pred_nr    = be_lv_bits_get_block_nr(bits, pred_block);
+				for (unsigned c = 0; c < bits->n_classes; ++c) {
+					be_lv_class_t  const *const cls      = &bits->classes[c];
+					unsigned              const n_words  = cls->n_words;
+					unsigned       const *const in       = get_block_sets(cls, b);
+					unsigned             *const pred_end = get_block_sets(cls, pred_nr) + n_words;
+					unsigned             *const pred_out = pred_end + n_words;
+					for (unsigned w = 0; w < n_words; ++w) {
+						unsigned const live = in[w];
+						if ((live & ~pred_out[w]) != 0) {
+							pred_out[w] |= live;
+							pred_end[w] |= live;
+							changed = true;
+						}
+					}
+				}
+			}
+		}
+	} while (changed);
+
+	for (unsigned c = 0; c < bits->n_classes; ++c)
+		free(defs[c]);
+	free(defs);
+}
+
+static void free_sets_bits(be_lv_bits_t *const bits)
+{
+	for (unsigned c = 0; c < bits->n_classes; ++c) {
+		be_lv_class_t *const cls = &bits->classes[c];
+		DEL_ARR_F(cls->values);
+		DEL_ARR_F(cls->free_nrs);
+		free(cls->sets);
+	}
+	free(bits->classes);
+	DEL_ARR_F(bits->blocks);
+	DEL_ARR_F(bits->block_nrs);
+	DEL_ARR_F(bits->values);
+	memset(bits, 0, sizeof(*bits));
+}
+
+/**
+ * Removes a value from the bitsets of all blocks and gives its number free.
+ */
+static void remove_value_bits(be_lv_bits_t *const bits,
+                              ir_node const *const value)
+{
+	unsigned             nr;
+	be_lv_class_t *const cls = find_value(bits, value, &nr);
+	if (cls == NULL)
+		return;
+
+	unsigned const n_words = cls->n_words;
+	unsigned const word    = nr / BITS_PER_ELEM;
+	unsigned const mask    = ~(1u << nr % BITS_PER_ELEM);
+	for (size_t i = 0, n = ARR_LEN(bits->blocks) * 3; i < n; ++i)
+		cls->sets[i * n_words + word] &= mask;
+
+	cls->values[nr] = NULL;
+	ARR_APP1(unsigned, cls->free_nrs, nr);
+	DBG((dbg, LEVEL_3, "\tdeleting %+F, freeing number %u\n", value, nr));
+}
+
+ir_node *be_lv_bits_iteration_next(lv_iterator_t *const iterator,
+                                   be_lv_state_t const flags,
+                                   arch_register_class_t const *const cls)
+{
+	be_lv_bits_t const *const bits = iterator->bits;
+	if (iterator->cls == (unsigned)-1) {
+		iterator->cls = cls != NULL ? get_class_index(bits, cls) : 0;
+		iterator->i   = ARR_LEN(bits->classes[iterator->cls].values);
+	}
+
+	for (;;) {
+		be_lv_class_t const *const c       = &bits->classes[iterator->cls];
+		unsigned             const n_words = c->n_words;
+		unsigned       const *const sets   = get_block_sets(c, iterator->bl_nr);
+		for (size_t i = iterator->i; i > 0;) {
+			--i;
+			size_t   const word = i / BITS_PER_ELEM;
+			/* state bit k lives in set k of the block */
+			unsigned       elem = 0;
+			for (unsigned k = 0; k < 3; ++k) {
+				if (flags & (1u << k))
+					elem |= sets[k * n_words + word];
+			}
+			/* only the bits up to i */
+			elem &= (2u << i % BITS_PER_ELEM) - 1;
+			if (elem != 0) {
+				i = word * BITS_PER_ELEM + BITS_PER_ELEM - 1 - nlz(elem);
+				iterator->i = i;
+				assert(c->values[i] != NULL);
+				return c->values[i];
+			}
+			i = word * BITS_PER_ELEM;
+		}
+
+		if (cls != NULL || iterator->cls + 1 >= bits->n_classes) {
+			iterator->i = 0;
+			return NULL;
+		}
+		++iterator->cls;
+		iterator->i = ARR_LEN(bits->classes[iterator->cls].values);
+	}
+}
+
 void be_liveness_compute_sets(be_lv_t *lv)
 {
 	if (lv->sets_valid)
 		return;
 
 	be_timer_push(T_LIVE);
+	lv->use_bits = lv_representation == LV_BITSETS;
+	if (lv->use_bits) {
+		compute_sets_bits(lv);
+		lv->sets_valid = true;
+		be_timer_pop(T_LIVE);
+		return;
+	}
+
 	ir_nodehashmap_init(&lv->map);
 	obstack_init(&lv->obst);
 
@@ -276,7 +672,8 @@ void be_liveness_compute_sets(be_lv_t *lv)
 	 * will not need to move around the data. */
 	irg_walk_graph(irg, NULL, collect_liveness_nodes, nodes);
 
-	re.lv = lv;
+	re.lv  = lv;
+	re.cls = NULL;
 
 	for (unsigned i = 0; i < n; ++i) {
 		if (nodes[i] != NULL)
@@ -299,8 +696,12 @@ void be_liveness_invalidate_sets(be_lv_t *lv)
 {
 	if (!lv->sets_valid)
 		return;
-	obstack_free(&lv->obst, NULL);
-	ir_nodehashmap_destroy(&lv->map);
+	if (lv->use_bits) {
+		free_sets_bits(&lv->bits);
+	} else {
+		obstack_free(&lv->obst, NULL);
+		ir_nodehashmap_destroy(&lv->map);
+	}
 	lv->sets_valid = false;
 }
 
@@ -331,6 +732,10 @@ void be_liveness_free(be_lv_t *lv)
 void be_liveness_remove(be_lv_t *lv, const ir_node *irn)
 {
 	assert(lv->sets_valid);
+	if (lv->use_bits) {
+		remove_value_bits(&lv->bits, irn);
+		return;
+	}
 
 	/* Removes a single irn from the liveness information.
 	 * Since an irn can only be live at blocks dominated by the block of its
@@ -343,10 +748,19 @@ void be_liveness_introduce(be_lv_t *lv, ir_node *irn)
 {
 	assert(lv->sets_valid);
 	/* Don't compute liveness information for non-data nodes. */
-	if (is_liveness_node(irn)) {
-		re.lv = lv;
-		liveness_for_node(irn);
+	if (!is_liveness_node(irn))
+		return;
+
+	re.lv  = lv;
+	re.cls = NULL;
+	if (lv->use_bits) {
+		if (!has_nonlocal_use(irn))
+			return;
+		be_lv_bits_t *const bits = &lv->bits;
+		re.cls = number_value(bits, irn, &re.nr);
+		grow_class_sets(bits, re.cls);
 	}
+	liveness_for_node(irn);
 }
 
 void be_liveness_update(be_lv_t *lv, ir_node *irn)
@@ -564,6 +978,9 @@ static void be_live_chk_compare(be_lv_t *lv, lv_chk_t *lvc)
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_live)
 void be_init_live(void)
 {
+	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_add_table(be_grp, be_live_options);
+
 	(void)be_live_chk_compare;
 	FIRM_DBG_REGISTER(dbg, "firm.be.liveness");
 }
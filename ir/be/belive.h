@@ -12,11 +12,13 @@
 #ifndef FIRM_BE_BELIVE_H
 #define FIRM_BE_BELIVE_H
 
+#include "array.h"
 #include "be_types.h"
 #include "irnodeset.h"
 #include "irnodehashmap.h"
 #include "irlivechk.h"
 #include "bearch.h"
+#include "raw_bitset.h"
 
 typedef enum be_lv_state_t {
 	be_lv_state_none = 0,
@@ -39,6 +41,8 @@ void be_liveness_free(be_lv_t *lv);
 
 /**
  * (Re)compute the liveness information if necessary.
+ * The option be.liveness selects whether the sets are stored as sorted arrays
+ * (sets) or as bitsets over the values of each register class (bitsets).
  */
 void be_liveness_compute_sets(be_lv_t *lv);
 void be_liveness_compute_chk(be_lv_t *lv);
@@ -129,12 +133,41 @@ void be_liveness_nodes_live_before(be_lv_t const *lv,
                                    arch_register_class_t const *cls,
                                    ir_node const *pos, ir_nodeset_t *live);
 
+/**
+ * The live sets of the values of one register class, if the sets are stored
+ * as bitsets. The values are numbered densely, each block has an in, an end
+ * and an out bitset over these numbers. The bitset of state bit k of block
+ * number b starts at sets[(b * 3 + k) * n_words].
+ */
+typedef struct be_lv_class_t {
+	ir_node  **values;   /**< ARR_F, the values by number, NULL if unused */
+	unsigned  *free_nrs; /**< ARR_F, unused numbers below ARR_LEN(values) */
+	unsigned   n_words;  /**< number of words of a single bitset */
+	unsigned  *sets;     /**< the bitsets of all blocks */
+} be_lv_class_t;
+
+/** Where the bits of a value are. */
+typedef struct be_lv_value_t {
+	unsigned cls; /**< index into be_lv_bits_t.classes */
+	unsigned nr;  /**< number of the value in its class */
+} be_lv_value_t;
+
+typedef struct be_lv_bits_t {
+	unsigned        n_classes; /**< register classes + 1 for other values */
+	be_lv_class_t  *classes;
+	ir_node       **blocks;    /**< ARR_F, the blocks by number */
+	unsigned       *block_nrs; /**< ARR_F, block numbers by node index */
+	be_lv_value_t  *values;    /**< ARR_F, value positions by node index */
+} be_lv_bits_t;
+
 struct be_lv_t {
 	ir_nodehashmap_t map;
 	struct obstack   obst;
 	bool             sets_valid;
+	bool             use_bits;   /**< the sets are stored in bits */
 	ir_graph        *irg;
 	lv_chk_t        *lvc;
+	be_lv_bits_t     bits;
 };
 
 typedef struct be_lv_info_node_t be_lv_info_node_t;
@@ -152,9 +185,48 @@ struct be_lv_info_t {
 be_lv_info_node_t *be_lv_get(const be_lv_t *li, const ir_node *block,
                              const ir_node *irn);
 
+/**
+ * Returns the number of @p block in the live bitsets.
+ */
+static inline unsigned be_lv_bits_get_block_nr(be_lv_bits_t const *const bits, ir_node const *const block)
+{
+	unsigned const bl_idx = get_irn_idx(block);
+	assert(bl_idx < ARR_LEN(bits->block_nrs));
+	unsigned const bl_nr = bits->block_nrs[bl_idx];
+	assert(bits->blocks[bl_nr] == block);
+	return bl_nr;
+}
+
+static inline be_lv_state_t be_lv_bits_get_state(be_lv_bits_t const *const bits, ir_node const *const block, ir_node const *const irn)
+{
+	unsigned const irn_idx = get_irn_idx(irn);
+	if (irn_idx >= ARR_LEN(bits->values))
+		return be_lv_state_none;
+	be_lv_value_t const *const value = &bits->values[irn_idx];
+	be_lv_class_t const *const cls   = &bits->classes[value->cls];
+	unsigned             const nr    = value->nr;
+	if (nr >= ARR_LEN(cls->values) || cls->values[nr] != irn)
+		return be_lv_state_none;
+
+	unsigned const  bl_nr   = be_lv_bits_get_block_nr(bits, block);
+	unsigned const  n_words = cls->n_words;
+	unsigned const *sets    = &cls->sets[bl_nr * 3 * n_words + nr / BITS_PER_ELEM];
+	unsigned const  mask    = 1u << (nr % BITS_PER_ELEM);
+	be_lv_state_t   state   = be_lv_state_none;
+	if (sets[0] & mask)
+		state |= be_lv_state_in;
+	if (sets[n_words] & mask)
+		state |= be_lv_state_end;
+	if (sets[2 * n_words] & mask)
+		state |= be_lv_state_out;
+	return state;
+}
+
 static inline be_lv_state_t be_get_live_state(be_lv_t const *const li, ir_node const *const block, ir_node const *const irn)
 {
 	if (li->sets_valid) {
+		if (li->use_bits)
+			return be_lv_bits_get_state(&li->bits, block, irn);
 		be_lv_info_node_t *info = be_lv_get(li, block, irn);
 		return info ? info->flags : be_lv_state_none;
 	} else {
@@ -200,8 +272,11 @@ static inline bool be_is_live_end(const be_lv_t *li, const ir_node *block,
 
 typedef struct lv_iterator_t
 {
-	be_lv_info_t *info;
-	size_t        i;
+	be_lv_info_t       *info;
+	size_t              i;
+	be_lv_bits_t const *bits;  /**< NULL if the sets are sorted arrays */
+	unsigned            bl_nr; /**< number of the block in bits */
+	unsigned            cls;   /**< current class in bits, -1 before the start */
 } lv_iterator_t;
 
 static inline lv_iterator_t be_lv_iteration_begin(const be_lv_t *lv,
@@ -209,14 +284,34 @@ static inline lv_iterator_t be_lv_iteration_begin(const be_lv_t *lv,
 {
 	assert(lv->sets_valid);
 	lv_iterator_t res;
-	res.info  = ir_nodehashmap_get(be_lv_info_t, &lv->map, block);
-	res.i     = res.info ? res.info->n_members : 0;
+	if (lv->use_bits) {
+		res.info  = NULL;
+		res.i     = 0;
+		res.bits  = &lv->bits;
+		res.bl_nr = be_lv_bits_get_block_nr(&lv->bits, block);
+		res.cls   = (unsigned)-1;
+	} else {
+		res.info  = ir_nodehashmap_get(be_lv_info_t, &lv->map, block);
+		res.i     = res.info ? res.info->n_members : 0;
+		res.bits  = NULL;
+	}
 	return res;
 }
 
+/**
+ * Returns the next value of a bitset iteration, only values of class @p cls
+ * if it is not NULL.
+ */
+ir_node *be_lv_bits_iteration_next(lv_iterator_t *iterator,
+                                   be_lv_state_t flags,
+                                   const arch_register_class_t *cls);
+
 static inline ir_node *be_lv_iteration_next(lv_iterator_t *iterator,
                                             be_lv_state_t flags)
 {
+	if (iterator->bits != NULL)
+		return be_lv_bits_iteration_next(iterator, flags, NULL);
+
 	while (iterator->i != 0) {
 		be_lv_info_node_t const *const node = &iterator->info->nodes[--iterator->i];
 		assert(get_irn_mode(node->node) != mode_T);
@@ -230,6 +325,15 @@ static inline ir_node *be_lv_iteration_cls_next(lv_iterator_t *iterator,
                                                 be_lv_state_t flags,
                                                 const arch_register_class_t *cls)
 {
+	if (iterator->bits != NULL) {
+		ir_node *node;
+		while ((node = be_lv_bits_iteration_next(iterator, flags, cls)) != NULL) {
+			if (arch_irn_consider_in_reg_alloc(cls, node))
+				return node;
+		}
+		return NULL;
+	}
+
 	while (iterator->i != 0) {
 		be_lv_info_node_t const *const lnode = &iterator->info->nodes[--iterator->i];
 		assert(get_irn_mode(lnode->node) != mode_T);
@@ -52,6 +52,8 @@
 #include "beirg.h"
 #include "bestack.h"
 #include "beemitter.h"
+#include "becodecache.h"
+#include "befuncorder.h"
 
 static struct obstack obst;
 static be_main_env_t  env;
@@ -62,11 +64,15 @@ be_options_t be_options = {
 	.timing               = false,
 	.opt_profile_generate = false,
 	.opt_profile_use      = false,
+	.opt_profile_atomic   = false,
+	.opt_split_cold       = false,
+	.opt_order_functions  = false,
 	.omit_fp              = false,
 	.pic                  = false,
 	.do_verify            = true,
 	.ilp_solver           = "",
 	.verbose_asm          = true,
+	.emit_object          = false,
 };
 
 /* back end instruction set architecture to use */
@@ -97,7 +103,11 @@ static const lc_opt_table_entry_t be_main_options[] = {
 	LC_OPT_ENT_BOOL     ("time",       "get backend timing statistics",                       &be_options.timing),
 	LC_OPT_ENT_BOOL     ("profilegenerate", "instrument the code for execution count profiling", &be_options.opt_profile_generate),
 	LC_OPT_ENT_BOOL     ("profileuse",      "use existing profile data",                         &be_options.opt_profile_use),
+	LC_OPT_ENT_BOOL     ("profileatomic",   "increment profile counters atomically",             &be_options.opt_profile_atomic),
+	LC_OPT_ENT_BOOL     ("splitcold",  "move rarely executed blocks to .text.unlikely",        &be_options.opt_split_cold),
+	LC_OPT_ENT_BOOL     ("orderfuncs", "order functions by call frequency",                     &be_options.opt_order_functions),
 	LC_OPT_ENT_BOOL     ("verboseasm", "enable verbose assembler output",                        &be_options.verbose_asm),
+	LC_OPT_ENT_BOOL     ("objfile",    "write an object file instead of assembler",             &be_options.emit_object),
 
 	LC_OPT_ENT_STR("ilp.solver", "the ilp solver name", &be_options.ilp_solver),
 	LC_OPT_LAST
@@ -227,7 +237,18 @@ int be_parse_arg(const char *arg)
 		lc_opt_print_help_for_entry(be_grp, '-', stdout);
 		return -1;
 	}
-	return lc_opt_from_single_arg(be_grp, arg);
+	arch_isa_if_t const *const old_isa_if   = isa_if;
+	bool                 const old_emit_obj = be_options.emit_object;
+	int                  const res          = lc_opt_from_single_arg(be_grp, arg);
+	/* reject object files for backends which only write assembler */
+	if (res && be_options.emit_object && !isa_if->can_emit_object) {
+		isa_if                 = old_isa_if;
+		be_options.emit_object = old_emit_obj;
+		return 0;
+	}
+	if (res)
+		be_code_cache_add_option(arg);
+	return res;
 }
 
 void be_check_verify_result(bool fine, ir_graph *irg)
@@ -315,14 +336,14 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 			be_warningf(NULL, "could not read profile data '%s'", prof_filename);
 		} else {
 			ir_create_execfreqs_from_profile();
-			ir_profile_free();
 			have_profile = true;
 		}
 	}
 
 	ir_graph *prof_init_irg = NULL;
 	if (be_options.opt_profile_generate)
-		prof_init_irg = ir_profile_instrument(prof_filename);
+		prof_init_irg = ir_profile_instrument(prof_filename,
+		                                      be_options.opt_profile_atomic);
 
 	if (!have_profile) {
 		be_timer_push(T_EXECFREQ);
@@ -331,6 +352,12 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 		}
 		be_timer_pop(T_EXECFREQ);
 	}
+
+	/* the function order needs the execution counts of the profile */
+	if (be_options.opt_order_functions)
+		be_order_functions(have_profile);
+	if (have_profile)
+		ir_profile_free();
 	return prof_init_irg;
 }
 
@@ -404,7 +431,11 @@ void be_begin(FILE *file_handle, const char *cup_name)
 	if (prof_init_irg != NULL)
 		initialize_birg(&birgs[num_birgs++], prof_init_irg, &env);
 
-	be_gas_begin_compilation_unit(&env);
+	/* the backend writes object files itself, see beelf.h */
+	if (!be_options.emit_object)
+		be_gas_begin_compilation_unit(&env);
+
+	be_code_cache_begin();
 }
 
 void firm_be_finish(void)
@@ -457,7 +488,7 @@ float_int_conversion_overflow_style_t be_get_float_int_overflow(void)
 
 int be_timing;
 
-static const char *get_timer_name(be_timer_id_t id)
+const char *be_get_timer_name(be_timer_id_t id)
 {
 	switch (id) {
 	case T_ABI:            return "abi";
@@ -522,21 +553,27 @@ void be_lower_for_target(void)
 	}
 }
 
-static int cse_setting;
-
 bool be_step_first(ir_graph *irg)
 {
 	ir_entity *const entity = get_irg_entity(irg);
 	if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN)
 		return false;
 
+	/* a hit emits the code of the graph */
+	if (be_code_cache_lookup(irg)) {
+		be_free_birg(irg);
+		return false;
+	}
+
+	ir_pass_begin(irg, "backend");
 	be_timer_push(T_OTHER);
 	if (stat_ev_enabled) {
 		stat_ev_ctx_push_fmt("bemain_irg", "%+F", irg);
 		stat_ev_ull("bemain_insns_start", be_count_insns(irg));
 		stat_ev_ull("bemain_blocks_start", be_count_blocks(irg));
 	}
-	cse_setting = get_opt_cse();
+	be_birg_from_irg(irg)->cse_setting = get_opt_cse();
+	be_emit_begin_buffer();
 	return true;
 }
 
@@ -587,13 +624,14 @@ void be_step_last(ir_graph *irg)
 	be_regalloc_verify(irg);
 
 	be_timer_pop(T_OTHER);
+	ir_pass_end("backend");
 
 	if (be_timing) {
 		if (stat_ev_enabled) {
 			for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
 				char buf[128];
 				snprintf(buf, sizeof(buf), "bemain_time_%s",
-						 get_timer_name(t));
+						 be_get_timer_name(t));
 				stat_ev_dbl(buf, ir_timer_elapsed_usec(be_timers[t]));
 			}
 		} else {
@@ -601,7 +639,7 @@ void be_step_last(ir_graph *irg)
 				   get_entity_name(get_irg_entity(irg)));
 			for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
 				double val = ir_timer_elapsed_usec(be_timers[t]) / 1000.0;
-				printf("%-20s: %10.3f msec\n", get_timer_name(t), val);
+				printf("%-20s: %10.3f msec\n", be_get_timer_name(t), val);
 			}
 		}
 		for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
@@ -609,6 +647,10 @@ void be_step_last(ir_graph *irg)
 		}
 	}
 
+	be_code_cache_store();
+	be_emit_flush_buffer();
+
+	int const cse_setting = be_birg_from_irg(irg)->cse_setting;
 	be_free_birg(irg);
 	stat_ev_ctx_pop("bemain_irg");
 
@@ -617,7 +659,8 @@ void be_step_last(ir_graph *irg)
 
 void be_finish(void)
 {
-	be_gas_end_compilation_unit(&env);
+	if (!be_options.emit_object)
+		be_gas_end_compilation_unit(&env);
 
 	if (be_options.timing) {
 		ir_timer_stop(bemain_timer);
@@ -630,6 +673,8 @@ void be_finish(void)
 		}
 	}
 
+	be_code_cache_end();
+
 	if (stat_ev_enabled) {
 		stat_ev_ctx_pop("bemain_compilation_unit");
 	}
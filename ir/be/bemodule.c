@@ -35,6 +35,7 @@ void be_init_blocksched(void);
 void be_init_chordal(void);
 void be_init_chordal_common(void);
 void be_init_chordal_main(void);
+void be_init_codecache(void);
 void be_init_copyheur4(void);
 void be_init_copyilp(void);
 void be_init_copyilp2(void);
@@ -42,6 +43,7 @@ void be_init_copynone(void);
 void be_init_copyopt(void);
 void be_init_daemelspill(void);
 void be_init_dwarf(void);
+void be_init_funcorder(void);
 void be_init_gas(void);
 void be_init_listsched(void);
 void be_init_live(void);
@@ -62,6 +64,7 @@ void be_init_spillslots(void);
 void be_init_ssaconstr(void);
 void be_init_state(void);
 
+void be_quit_codecache(void);
 void be_quit_pbqp(void);
 
 /**
@@ -78,8 +81,10 @@ void be_init_modules(void)
 	be_init_arch();
 	be_init_blocksched();
 	be_init_chordal_common();
+	be_init_codecache();
 	be_init_copyopt();
 	be_init_dwarf();
+	be_init_funcorder();
 	be_init_gas();
 	be_init_live();
 	be_init_loopana();
@@ -125,6 +130,7 @@ void be_init_modules(void)
 
 void be_quit_modules(void)
 {
+	be_quit_codecache();
 #ifdef FIRM_GRGEN_BE
 	be_quit_pbqp();
 #endif
@@ -212,11 +212,14 @@ static void emit_ia32_immediate(bool const prefix, x86_imm32_t const *const imm)
 	if (entity != NULL) {
 		assert(imm->kind != X86_IMM_VALUE);
 		ia32_emit_relocation(imm);
+		if (offset > 0)
+			be_emit_char('+');
 		if (offset != 0)
-			be_emit_irprintf("%+"PRId32, offset);
+			be_emit_int(offset);
 	} else {
 		assert(imm->kind == X86_IMM_VALUE);
-		be_emit_irprintf("0x%"PRIX32, (uint32_t)offset);
+		be_emit_cstring("0x");
+		be_emit_hex((uint32_t)offset);
 	}
 }
 
@@ -380,12 +383,14 @@ static void ia32_emit_am(ir_node const *const node)
 		assert(attr->am_imm.kind != X86_IMM_VALUE);
 		const ia32_attr_t *attr = get_ia32_attr_const(node);
 		ia32_emit_relocation(&attr->am_imm);
+		if (offset > 0)
+			be_emit_char('+');
 		if (offset != 0)
-			be_emit_irprintf("%+"PRId32, offset);
+			be_emit_int(offset);
 	} else if (offset != 0 || (!base && !idx)) {
 		assert(attr->am_imm.kind == X86_IMM_VALUE);
 		/* also handle special case if nothing is set */
-		be_emit_irprintf("%"PRId32, offset);
+		be_emit_int(offset);
 	}
 
 	if (base || idx) {
@@ -404,8 +409,10 @@ static void ia32_emit_am(ir_node const *const node)
 			emit_register(reg, NULL);
 
 			int const scale = get_ia32_am_scale(node);
-			if (scale > 0)
-				be_emit_irprintf(",%d", 1 << scale);
+			if (scale > 0) {
+				be_emit_char(',');
+				be_emit_int(1 << scale);
+			}
 		}
 		be_emit_char(')');
 	}
@@ -675,20 +682,20 @@ emit_S:
 			case 'u':
 				if (mod & EMIT_LONG) {
 					unsigned long num = va_arg(ap, unsigned long);
-					be_emit_irprintf("%lu", num);
+					be_emit_uint(num);
 				} else {
 					unsigned num = va_arg(ap, unsigned);
-					be_emit_irprintf("%u", num);
+					be_emit_uint(num);
 				}
 				break;
 
 			case 'd':
 				if (mod & EMIT_LONG) {
 					long num = va_arg(ap, long);
-					be_emit_irprintf("%ld", num);
+					be_emit_int(num);
 				} else {
 					int num = va_arg(ap, int);
-					be_emit_irprintf("%d", num);
+					be_emit_int(num);
 				}
 				break;
 
@@ -970,7 +977,9 @@ static void emit_ia32_asm_operand(ir_node const *const node, char const modifier
 
 	case ASM_OP_MEMORY: {
 		arch_register_t const *const reg = arch_get_irn_register_in(node, op->inout_pos);
-		be_emit_irprintf("(%%%s)", reg->name);
+		be_emit_cstring("(%");
+		be_emit_string(reg->name);
+		be_emit_char(')');
 		return;
 	}
 
@@ -1610,7 +1619,17 @@ static void ia32_emit_function_text(ir_graph *const irg, ir_node **const blk_sch
 		set_irn_link(block, prev);
 	}
 
+	/* cold blocks go to a separate section, so the first cold block is not
+	 * reached by falling through */
+	size_t const n_hot = be_get_n_hot_blocks(blk_sched);
+	bool   const split = n_hot > 0 && n_hot < n
+	                  && be_gas_can_split_function(entity);
+	if (split)
+		set_irn_link(blk_sched[n_hot], NULL);
+
 	for (size_t i = 0; i < n; ++i) {
+		if (split && i == n_hot)
+			be_gas_begin_cold_part(entity);
 		ir_node *block = blk_sched[i];
 
 		ia32_gen_block(block);
@@ -0,0 +1,387 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Accumulates the time and hardware counters of passes per function.
+ *
+ * Passes are bracketed by ir_pass_begin() and ir_pass_end() and form a
+ * stack. The time of a pass is recorded twice, including nested passes
+ * (total) and without them (self), the hardware counters only without them.
+ */
+#ifdef __linux__
+#define _DEFAULT_SOURCE
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+#include "entity_t.h"
+#include "hashptr.h"
+#include "irgraph_t.h"
+#include "panic.h"
+#include "set.h"
+#include "timing_t.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAVE_PERF_EVENTS
+#endif
+
+enum {
+	COUNTER_CYCLES,
+	COUNTER_INSTRUCTIONS,
+	COUNTER_CACHE_MISSES,
+	COUNTER_BRANCH_MISSES,
+	N_COUNTERS
+};
+
+static char const *const counter_names[N_COUNTERS] = {
+	"cycles", "instructions", "cache_misses", "branch_misses",
+};
+
+typedef struct pass_record_t {
+	ident      *function;            /**< the function, NULL for the program */
+	char const *pass;                /**< name of the pass */
+	unsigned    nr;                  /**< number in order of appearance */
+	unsigned    calls;               /**< number of runs of the pass */
+	uint64_t    total_ns;            /**< time including nested passes */
+	uint64_t    self_ns;             /**< time without nested passes */
+	uint64_t    counters[N_COUNTERS]; /**< counts without nested passes */
+} pass_record_t;
+
+/** A running pass. */
+typedef struct pass_frame_t {
+	pass_record_t *record;
+	uint64_t       start_ns;
+	uint64_t       nested_ns;
+	uint64_t       start[N_COUNTERS];
+	uint64_t       nested[N_COUNTERS];
+} pass_frame_t;
+
+bool ir_pass_timing_enabled;
+
+static set           *records;
+static unsigned       n_records;
+static pass_frame_t  *frames;  /**< stack of running passes */
+static bool           have_counter[N_COUNTERS]; /**< counter was collected */
+static bool           any_counter;              /**< some counter is open */
+
+#ifdef HAVE_PERF_EVENTS
+
+static int counter_fds[N_COUNTERS] = { -1, -1, -1, -1 };
+/** Position of each counter in the group read, only valid if it is open. */
+static unsigned counter_pos[N_COUNTERS];
+
+static int open_counter(uint64_t config, int group_fd)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size           = sizeof(attr);
+	attr.type           = PERF_TYPE_HARDWARE;
+	attr.config         = config;
+	attr.read_format    = PERF_FORMAT_GROUP;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv     = 1;
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void open_counters(void)
+{
+	static uint64_t const configs[N_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+	if (any_counter)
+		return;
+
+	/* the cycle counter leads the group, so all counters are read at once */
+	int      leader = -1;
+	unsigned n_open = 0;
+	for (unsigned i = 0; i < N_COUNTERS; ++i) {
+		int const fd = open_counter(configs[i], leader);
+		if (fd < 0) {
+			if (leader < 0)
+				break;
+			continue;
+		}
+		if (leader < 0)
+			leader = fd;
+		counter_fds[i]  = fd;
+		counter_pos[i]  = n_open++;
+		have_counter[i] = true;
+		any_counter     = true;
+	}
+	if (!any_counter)
+		fprintf(stderr, "pass timing: hardware counters not available\n");
+}
+
+static void close_counters(void)
+{
+	for (unsigned i = N_COUNTERS; i-- > 0;) {
+		if (counter_fds[i] >= 0)
+			close(counter_fds[i]);
+		counter_fds[i] = -1;
+	}
+	any_counter = false;
+}
+
+static void read_counters(uint64_t *values)
+{
+	uint64_t buf[1 + N_COUNTERS];
+	if (read(counter_fds[COUNTER_CYCLES], buf, sizeof(buf)) < (ssize_t)sizeof(uint64_t)) {
+		memset(values, 0, N_COUNTERS * sizeof(*values));
+		return;
+	}
+	for (unsigned i = 0; i < N_COUNTERS; ++i)
+		values[i] = have_counter[i] ? buf[1 + counter_pos[i]] : 0;
+}
+
+#else
+
+static void open_counters(void)
+{
+	fprintf(stderr, "pass timing: hardware counters not available\n");
+}
+
+static void close_counters(void)
+{
+}
+
+static void read_counters(uint64_t *values)
+{
+	memset(values, 0, N_COUNTERS * sizeof(*values));
+}
+
+#endif
+
+static int cmp_record(void const *elt, void const *key, size_t size)
+{
+	(void)size;
+	pass_record_t const *const r1 = (pass_record_t const*)elt;
+	pass_record_t const *const r2 = (pass_record_t const*)key;
+	return r1->function != r2->function || strcmp(r1->pass, r2->pass) != 0;
+}
+
+static pass_record_t *get_record(ident *function, char const *pass)
+{
+	if (records == NULL)
+		records = new_set(cmp_record, 64);
+
+	pass_record_t key;
+	memset(&key, 0, sizeof(key));
+	key.function = function;
+	key.pass     = pass;
+	key.nr       = n_records;
+	unsigned const hash = hash_combine(hash_ptr(function), hash_str(pass));
+	pass_record_t *const record
+		= set_insert(pass_record_t, records, &key, sizeof(key), hash);
+	if (record->nr == n_records)
+		++n_records;
+	return record;
+}
+
+void ir_pass_timing_enable(int hw_counters)
+{
+	if (frames == NULL)
+		frames = NEW_ARR_F(pass_frame_t, 0);
+	if (hw_counters) {
+		open_counters();
+	} else {
+		close_counters();
+		memset(have_counter, 0, sizeof(have_counter));
+	}
+	ir_pass_timing_enabled = true;
+}
+
+void ir_pass_timing_disable(void)
+{
+	ir_pass_timing_enabled = false;
+	if (frames != NULL) {
+		DEL_ARR_F(frames);
+		frames = NULL;
+	}
+	close_counters();
+}
+
+void ir_pass_timing_reset(void)
+{
+	if (records != NULL) {
+		del_set(records);
+		records = NULL;
+	}
+	n_records = 0;
+	if (frames != NULL)
+		ARR_SHRINKLEN(frames, 0);
+}
+
+void do_ir_pass_begin(ir_graph *irg, char const *name)
+{
+	ident *function;
+	if (irg != NULL) {
+		function = get_entity_ident(get_irg_entity(irg));
+	} else {
+		size_t const n_frames = ARR_LEN(frames);
+		function = n_frames > 0 ? frames[n_frames - 1].record->function : NULL;
+	}
+
+	ARR_EXTEND(pass_frame_t, frames, 1);
+	pass_frame_t *const frame = &frames[ARR_LEN(frames) - 1];
+	memset(frame, 0, sizeof(*frame));
+	frame->record = get_record(function, name);
+	if (any_counter)
+		read_counters(frame->start);
+	/* read the clock last and first, so the bookkeeping is not timed */
+	frame->start_ns = ir_time_now_nsec();
+}
+
+void do_ir_pass_end(char const *name)
+{
+	uint64_t const now = ir_time_now_nsec();
+	uint64_t       counters[N_COUNTERS];
+	if (any_counter)
+		read_counters(counters);
+
+	/* passes begun before the timing was enabled are not on the stack */
+	size_t const n_frames = ARR_LEN(frames);
+	if (n_frames == 0)
+		return;
+	pass_frame_t  *const frame  = &frames[n_frames - 1];
+	pass_record_t *const record = frame->record;
+	if (strcmp(record->pass, name) != 0)
+		panic("pass %s ended while %s is running", name, record->pass);
+
+	uint64_t const total = now - frame->start_ns;
+	++record->calls;
+	record->total_ns += total;
+	record->self_ns  += total - frame->nested_ns;
+	pass_frame_t *const parent = n_frames > 1 ? &frames[n_frames - 2] : NULL;
+	if (parent != NULL)
+		parent->nested_ns += total;
+	if (any_counter) {
+		for (unsigned i = 0; i < N_COUNTERS; ++i) {
+			uint64_t const count = counters[i] - frame->start[i];
+			record->counters[i] += count - frame->nested[i];
+			if (parent != NULL)
+				parent->nested[i] += count;
+		}
+	}
+	ARR_SHRINKLEN(frames, n_frames - 1);
+}
+
+static char const *get_function_name(pass_record_t const *record)
+{
+	return record->function != NULL ? get_id_str(record->function)
+	                                : "<program>";
+}
+
+/** Orders by function, the program first, then by appearance. */
+static int cmp_dump_order(void const *a, void const *b)
+{
+	pass_record_t const *const r1 = *(pass_record_t const *const*)a;
+	pass_record_t const *const r2 = *(pass_record_t const *const*)b;
+	if (r1->function != r2->function) {
+		if (r1->function == NULL)
+			return -1;
+		if (r2->function == NULL)
+			return 1;
+		int const res = strcmp(get_id_str(r1->function),
+		                       get_id_str(r2->function));
+		if (res != 0)
+			return res;
+	}
+	return QSORT_CMP(r1->nr, r2->nr);
+}
+
+static void print_json_string(FILE *out, char const *str)
+{
+	fputc('"', out);
+	for (char const *c = str; *c != '\0'; ++c) {
+		unsigned char const ch = (unsigned char)*c;
+		if (ch == '"' || ch == '\\')
+			fprintf(out, "\\%c", ch);
+		else if (ch < 0x20)
+			fprintf(out, "\\u%04x", ch);
+		else
+			fputc(ch, out);
+	}
+	fputc('"', out);
+}
+
+static void dump_json(FILE *out, pass_record_t **sorted)
+{
+	fputs("[", out);
+	for (unsigned i = 0; i < n_records; ++i) {
+		pass_record_t const *const record = sorted[i];
+		fputs(i > 0 ? ",\n  {\"function\": " : "\n  {\"function\": ", out);
+		print_json_string(out, get_function_name(record));
+		fputs(", \"pass\": ", out);
+		print_json_string(out, record->pass);
+		fprintf(out, ", \"calls\": %u, \"self_ns\": %" PRIu64
+		        ", \"total_ns\": %" PRIu64, record->calls, record->self_ns,
+		        record->total_ns);
+		for (unsigned c = 0; c < N_COUNTERS; ++c) {
+			if (have_counter[c])
+				fprintf(out, ", \"%s\": %" PRIu64, counter_names[c],
+				        record->counters[c]);
+		}
+		fputs("}", out);
+	}
+	fputs("\n]\n", out);
+}
+
+static void dump_table(FILE *out, pass_record_t **sorted)
+{
+	ident const *function = NULL;
+	for (unsigned i = 0; i < n_records; ++i) {
+		pass_record_t const *const record = sorted[i];
+		if (i == 0 || record->function != function) {
+			function = record->function;
+			fprintf(out, "==>> %s <<==\n%-32s %8s %12s %12s",
+			        get_function_name(record), "pass", "calls", "self msec",
+			        "total msec");
+			for (unsigned c = 0; c < N_COUNTERS; ++c) {
+				if (have_counter[c])
+					fprintf(out, " %14s", counter_names[c]);
+			}
+			fputc('\n', out);
+		}
+		fprintf(out, "%-32s %8u %12.3f %12.3f", record->pass, record->calls,
+		        record->self_ns / 1e6, record->total_ns / 1e6);
+		for (unsigned c = 0; c < N_COUNTERS; ++c) {
+			if (have_counter[c])
+				fprintf(out, " %14" PRIu64, record->counters[c]);
+		}
+		fputc('\n', out);
+	}
+}
+
+void ir_pass_timing_dump(FILE *out, int json)
+{
+	pass_record_t **const sorted = XMALLOCN(pass_record_t*, n_records);
+	unsigned              n      = 0;
+	if (records != NULL) {
+		foreach_set(records, pass_record_t, record) {
+			sorted[n++] = record;
+		}
+	}
+	assert(n == n_records);
+	QSORT(sorted, n, cmp_dump_order);
+
+	if (json)
+		dump_json(out, sorted);
+	else
+		dump_table(out, sorted);
+	free(sorted);
+}
@@ -7,10 +7,12 @@
  * @file
  * @brief   platform neutral timing utilities
  */
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <string.h>
 
-#include "timing.h"
+#include "timing_t.h"
 #include "xmalloc.h"
 #include "panic.h"
 
@@ -27,17 +29,12 @@ typedef union {
 
 #else
 
+#include <time.h>
 #include <unistd.h>
-#define HAVE_GETTIMEOFDAY
-
-/*
- * Just, if we have gettimeofday()
- * Someday, we will have a check here.
- */
-#include <sys/time.h>
+#define HAVE_CLOCK_GETTIME
 
-/* Linux timer value. */
-typedef struct timeval ir_timer_val_t;
+/* POSIX timer value, nano seconds of the monotonic clock. */
+typedef uint64_t ir_timer_val_t;
 
 #endif /* _Win32 */
 
@@ -70,57 +67,51 @@ void ir_timer_free(ir_timer_t *timer)
 	free(timer);
 }
 
-#ifdef HAVE_GETTIMEOFDAY
+#ifdef HAVE_CLOCK_GETTIME
 
 static inline void _time_get(ir_timer_val_t *val)
 {
-	gettimeofday(val, NULL);
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	*val = (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
 }
 
 static inline void _time_reset(ir_timer_val_t *val)
 {
-	val->tv_sec  = 0;
-	val->tv_usec = 0;
+	*val = 0;
+}
+
+static inline uint64_t _time_to_nsec(const ir_timer_val_t *elapsed)
+{
+	return *elapsed;
 }
 
 static inline unsigned long _time_to_msec(const ir_timer_val_t *elapsed)
 {
-	return (unsigned long) elapsed->tv_sec * 1000UL
-		+ (unsigned long) elapsed->tv_usec / 1000UL;
+	return (unsigned long)(*elapsed / 1000000U);
 }
 
 static inline unsigned long _time_to_usec(const ir_timer_val_t *elapsed)
 {
-	return (unsigned long) elapsed->tv_sec * 1000000UL
-		+ (unsigned long) elapsed->tv_usec;
+	return (unsigned long)(*elapsed / 1000U);
 }
 
 static inline double _time_to_sec(const ir_timer_val_t *elapsed)
 {
-	return (double)elapsed->tv_sec + (double)elapsed->tv_usec / 1000000.0;
+	return (double)*elapsed / 1000000000.0;
 }
 
 static inline ir_timer_val_t *_time_add(ir_timer_val_t *res,
 		const ir_timer_val_t *lhs, const ir_timer_val_t *rhs)
 {
-	res->tv_sec  = lhs->tv_sec + rhs->tv_sec;
-	res->tv_usec = lhs->tv_usec + rhs->tv_usec;
-	if (res->tv_usec >= 1000000) {
-		res->tv_sec++;
-		res->tv_usec -= 1000000;
-	}
+	*res = *lhs + *rhs;
 	return res;
 }
 
 static inline ir_timer_val_t *_time_sub(ir_timer_val_t *res,
 		const ir_timer_val_t *lhs, const ir_timer_val_t *rhs)
 {
-	res->tv_sec  = lhs->tv_sec - rhs->tv_sec;
-	res->tv_usec = lhs->tv_usec - rhs->tv_usec;
-	if (res->tv_usec < 0) {
-		res->tv_sec--;
-		res->tv_usec += 1000000;
-	}
+	*res = *lhs - *rhs;
 	return res;
 }
 
@@ -137,6 +128,18 @@ static inline void _time_reset(ir_timer_val_t *val)
 	memset(val, 0, sizeof(val[0]));
 }
 
+static inline uint64_t _time_to_nsec(const ir_timer_val_t *elapsed)
+{
+	LARGE_INTEGER freq;
+
+	if (!QueryPerformanceFrequency(&freq))
+		return (uint64_t) elapsed->lo_prec * 1000000;
+
+	uint64_t const ticks = elapsed->hi_prec.QuadPart;
+	return ticks / freq.QuadPart * 1000000000
+		+ ticks % freq.QuadPart * 1000000000 / freq.QuadPart;
+}
+
 static inline unsigned long _time_to_msec(const ir_timer_val_t *elapsed)
 {
 	LARGE_INTEGER freq;
@@ -415,3 +418,23 @@ double ir_timer_elapsed_sec(const ir_timer_t *timer)
 	}
 	return _time_to_sec(elapsed);
 }
+
+unsigned long long ir_timer_elapsed_nsec(const ir_timer_t *timer)
+{
+	ir_timer_val_t v;
+	const ir_timer_val_t *elapsed = &timer->elapsed;
+
+	if (timer->running) {
+		elapsed = &v;
+		_time_get(&v);
+		_time_add(&v, &timer->elapsed, _time_sub(&v, &v, &timer->start));
+	}
+	return _time_to_nsec(elapsed);
+}
+
+uint64_t ir_time_now_nsec(void)
+{
+	ir_timer_val_t v;
+	_time_get(&v);
+	return _time_to_nsec(&v);
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief    Timing internals and the timing of passes.
+ */
+#ifndef FIRM_COMMON_TIMING_T_H
+#define FIRM_COMMON_TIMING_T_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "firm_types.h"
+#include "timing.h"
+
+/** Returns the current value of the monotonic clock in nanoseconds. */
+uint64_t ir_time_now_nsec(void);
+
+/** Set while ir_pass_timing_enable() is active. */
+extern bool ir_pass_timing_enabled;
+
+void do_ir_pass_begin(ir_graph *irg, char const *name);
+void do_ir_pass_end(char const *name);
+
+/**
+ * Marks the begin of the pass @p name. Passes nest, a pass running on
+ * @p irg NULL belongs to the function of the enclosing pass or to the whole
+ * program.
+ * @param name  the name of the pass, must stay valid until the pass timing
+ *              is reset
+ */
+static inline void ir_pass_begin(ir_graph *irg, char const *name)
+{
+	if (ir_pass_timing_enabled)
+		do_ir_pass_begin(irg, name);
+}
+
+/** Marks the end of the innermost pass, which must be @p name. */
+static inline void ir_pass_end(char const *name)
+{
+	if (ir_pass_timing_enabled)
+		do_ir_pass_end(name);
+}
+
+#endif
@@ -8,6 +8,7 @@
  * @brief     Hash table to store names.
  * @author    Goetz Lindenmaier
  */
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -15,23 +16,42 @@
 #include "ident_t.h"
 #include "obst.h"
 #include "set.h"
+#include "spinlock.h"
 
-static set *id_set;
+/** log2 of the number of ident table shards. */
+#define ID_SHARD_BITS 4
+#define N_ID_SHARDS   (1u << ID_SHARD_BITS)
 
-/** An obstack used for temporary space */
-static struct obstack id_obst;
+/**
+ * The ident table is split into independent shards selected by the upper bits
+ * of the string hash (the lower bits select the bucket inside a shard). Each
+ * shard keeps the strings in its own storage, so interning a string touches
+ * exactly one shard and shards never share mutable state. Each shard has its
+ * own lock, so threads only wait for each other when they intern strings of
+ * the same shard. The strings never move, so reading them needs no lock.
+ */
+static set        *id_shards[N_ID_SHARDS];
+static spinlock_t  id_locks[N_ID_SHARDS];
+
+/** Counter for id_unique(), incremented atomically. */
+static unsigned id_unique_nr;
 
 void init_ident(void)
 {
-	/* it's ok to use memcmp here, we check only strings */
-	id_set = new_set(memcmp, 128);
-	obstack_init(&id_obst);
+	for (size_t i = 0; i < N_ID_SHARDS; ++i) {
+		/* it's ok to use memcmp here, we check only strings */
+		id_shards[i] = new_set(memcmp, 32);
+	}
 }
 
 ident *new_id_from_chars(const char *str, size_t len)
 {
-	unsigned   hash   = hash_data((const unsigned char*)str, len);
-	set_entry *result = set_hinsert0(id_set, str, len, hash);
+	unsigned    hash = hash_data((const unsigned char*)str, len);
+	unsigned    nr   = hash >> (sizeof(hash) * 8 - ID_SHARD_BITS);
+	spinlock_t *lock = &id_locks[nr];
+	spinlock_lock(lock);
+	set_entry *result = set_hinsert0(id_shards[nr], str, len, hash);
+	spinlock_unlock(lock);
 	return (ident*)result->dptr;
 }
 
@@ -51,11 +71,24 @@ static ident *new_ident_from_obst(struct obstack *const obst)
 
 ident *new_id_fmt(char const *const fmt, ...)
 {
+	/* Most idents are short: format them on the stack and only fall back to a
+	 * local obstack for long ones. */
+	char    buf[128];
 	va_list ap;
 	va_start(ap, fmt);
-	obstack_vprintf(&id_obst, fmt, ap);
+	int const len = vsnprintf(buf, sizeof(buf), fmt, ap);
 	va_end(ap);
-	return new_ident_from_obst(&id_obst);
+	if (len >= 0 && (size_t)len < sizeof(buf))
+		return new_id_from_chars(buf, len);
+
+	struct obstack obst;
+	obstack_init(&obst);
+	va_start(ap, fmt);
+	obstack_vprintf(&obst, fmt, ap);
+	va_end(ap);
+	ident *const res = new_ident_from_obst(&obst);
+	obstack_free(&obst, NULL);
+	return res;
 }
 
 const char *(get_id_str)(ident *id)
@@ -65,13 +98,13 @@ const char *(get_id_str)(ident *id)
 
 void finish_ident(void)
 {
-	obstack_free(&id_obst, NULL);
-	del_set(id_set);
-	id_set = NULL;
+	for (size_t i = 0; i < N_ID_SHARDS; ++i) {
+		del_set(id_shards[i]);
+		id_shards[i] = NULL;
+	}
 }
 
 ident *id_unique(const char *tag)
 {
-	static unsigned unique_id = 0;
-	return new_id_fmt(tag, unique_id++);
+	return new_id_fmt(tag, atomic_post_inc(&id_unique_nr));
 }
@@ -173,7 +173,7 @@ static inline void verify_list_head(ir_node *irn, ir_edge_kind_t kind)
 {
 	int                     num    = 0;
 	pset                   *lh_set = pset_new_ptr(16);
-	const struct list_head *head   = &get_irn_edge_info(irn, kind)->outs_head;
+	const struct list_head *head   = get_irn_outs_head(irn, kind);
 	const struct list_head *pos;
 
 	list_for_each(pos, head) {
@@ -217,7 +217,7 @@ static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
 	ir_edgeset_t    *edges = &info->edges;
 
 	irn_edge_info_t  *tgt_info = get_irn_edge_info(tgt, kind);
-	struct list_head *head     = &tgt_info->outs_head;
+	struct list_head *head     = get_irn_outs_head(tgt, kind);
 	assert(head->next && head->prev &&
 		   "target list head must have been initialized");
 
@@ -297,7 +297,7 @@ static void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt, ir_node
 	 * old target was != NULL) or added (if the old target was
 	 * NULL). */
 	irn_edge_info_t  *tgt_info = get_irn_edge_info(tgt, kind);
-	struct list_head *head     = &tgt_info->outs_head;
+	struct list_head *head     = get_irn_outs_head(tgt, kind);
 	assert(head->next && head->prev &&
 			"target list head must have been initialized");
 
@@ -445,7 +445,7 @@ static void init_lh_walker(ir_node *irn, void *data)
 {
 	build_walker   *w    = (build_walker*)data;
 	ir_edge_kind_t  kind = w->kind;
-	list_head      *head = &get_irn_edge_info(irn, kind)->outs_head;
+	list_head      *head = get_irn_outs_head(irn, kind);
 	INIT_LIST_HEAD(head);
 	get_irn_edge_info(irn, kind)->edges_built = 0;
 	get_irn_edge_info(irn, kind)->out_count   = 0;
@@ -520,7 +520,7 @@ void edges_reroute_kind(ir_node *from, ir_node *to, ir_edge_kind_t kind)
 	set_edge_func_t *set_edge = edge_kind_info[kind].set_edge;
 
 	if (set_edge && edges_activated_kind(irg, kind)) {
-		struct list_head *head = &get_irn_edge_info(from, kind)->outs_head;
+		struct list_head *head = get_irn_outs_head(from, kind);
 
 		DBG((dbg, LEVEL_5, "reroute from %+F to %+F\n", from, to));
 
@@ -675,7 +675,7 @@ static void verify_edge_counter(ir_node *irn, void *env)
 	int       list_cnt = 0;
 	int       edge_cnt = get_irn_edge_info(irn, EDGE_KIND_NORMAL)->out_count;
 	const struct list_head *head
-		= &get_irn_edge_info(irn, EDGE_KIND_NORMAL)->outs_head;
+		= get_irn_outs_head(irn, EDGE_KIND_NORMAL);
 
 	/* We can iterate safely here, list heads have already been verified. */
 	const struct list_head *pos;
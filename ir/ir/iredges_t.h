@@ -49,14 +49,29 @@ static inline irn_edge_info_t *get_irn_edge_info(ir_node *node,
                                                  ir_edge_kind_t kind)
 {
 	assert(edges_activated_kind(get_irn_irg(node), kind));
-	return &node->edge_info[kind];
+	return &node->edge_info.info[kind];
 }
 
 static inline const irn_edge_info_t *get_irn_edge_info_const(
 		const ir_node *node, ir_edge_kind_t kind)
 {
 	assert(edges_activated_kind(get_irn_irg(node), kind));
-	return &node->edge_info[kind];
+	return &node->edge_info.info[kind];
+}
+
+/** Returns the head of the list of out edges of a node. */
+static inline struct list_head *get_irn_outs_head(ir_node *node,
+                                                  ir_edge_kind_t kind)
+{
+	assert(edges_activated_kind(get_irn_irg(node), kind));
+	return &node->edge_info.outs_head[kind];
+}
+
+static inline const struct list_head *get_irn_outs_head_const(
+		const ir_node *node, ir_edge_kind_t kind)
+{
+	assert(edges_activated_kind(get_irn_irg(node), kind));
+	return &node->edge_info.outs_head[kind];
 }
 
 /** Accessor for private irg info. */
@@ -82,7 +97,7 @@ static inline const irg_edge_info_t *get_irg_edge_info_const(
  */
 static inline const ir_edge_t *get_irn_out_edge_first_kind_(const ir_node *irn, ir_edge_kind_t kind)
 {
-	struct list_head const *const head = &get_irn_edge_info_const(irn, kind)->outs_head;
+	struct list_head const *const head = get_irn_outs_head_const(irn, kind);
 	return list_empty(head) ? NULL : list_entry(head->next, ir_edge_t, list);
 }
 
@@ -95,8 +110,7 @@ static inline const ir_edge_t *get_irn_out_edge_first_kind_(const ir_node *irn,
 static inline const ir_edge_t *get_irn_out_edge_next_(const ir_node *irn, const ir_edge_t *last, ir_edge_kind_t kind)
 {
 	struct list_head *next = last->list.next;
-	const struct list_head *head
-		= &get_irn_edge_info_const(irn, kind)->outs_head;
+	const struct list_head *head = get_irn_outs_head_const(irn, kind);
 	return next == head ? NULL : list_entry(next, ir_edge_t, list);
 }
 
@@ -29,6 +29,7 @@
 #include "irmemory.h"
 #include "iroptimize.h"
 #include "irgopt.h"
+#include "timing_t.h"
 
 #define INITIAL_IDX_IRN_MAP_SIZE 1024
 
@@ -77,6 +78,8 @@ static void free_graph(ir_graph *irg)
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i)
 		edges_deactivate_kind(irg, i);
 	DEL_ARR_F(irg->idx_irn_map);
+	if (irg->walk_stack != NULL)
+		DEL_ARR_F(irg->walk_stack);
 	free(irg);
 }
 
@@ -567,25 +570,29 @@ void assure_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 	static struct {
 		ir_graph_properties_t property;
 		assure_property_func  func;
+		char const           *name;
 	} property_functions[] = {
-		{ IR_GRAPH_PROPERTY_ONE_RETURN,               normalize_one_return },
-		{ IR_GRAPH_PROPERTY_MANY_RETURNS,             normalize_n_returns },
-		{ IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES,        remove_critical_cf_edges },
-		{ IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE,      remove_unreachable_code },
-		{ IR_GRAPH_PROPERTY_NO_BADS,                  remove_bads },
-		{ IR_GRAPH_PROPERTY_NO_TUPLES,                remove_tuples },
-		{ IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE,     compute_doms },
-		{ IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE, compute_postdoms },
-		{ IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES,     assure_edges },
-		{ IR_GRAPH_PROPERTY_CONSISTENT_OUTS,          assure_irg_outs },
-		{ IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO,      assure_loopinfo },
-		{ IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE,  assure_irg_entity_usage_computed },
-		{ IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS, ir_compute_dominance_frontiers },
+		{ IR_GRAPH_PROPERTY_ONE_RETURN,               normalize_one_return,             "normalize_one_return" },
+		{ IR_GRAPH_PROPERTY_MANY_RETURNS,             normalize_n_returns,              "normalize_n_returns" },
+		{ IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES,        remove_critical_cf_edges,         "remove_critical_cf_edges" },
+		{ IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE,      remove_unreachable_code,          "remove_unreachable_code" },
+		{ IR_GRAPH_PROPERTY_NO_BADS,                  remove_bads,                      "remove_bads" },
+		{ IR_GRAPH_PROPERTY_NO_TUPLES,                remove_tuples,                    "remove_tuples" },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE,     compute_doms,                     "compute_doms" },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE, compute_postdoms,                 "compute_postdoms" },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES,     assure_edges,                     "assure_edges" },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_OUTS,          assure_irg_outs,                  "assure_irg_outs" },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO,      assure_loopinfo,                  "assure_loopinfo" },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE,  assure_irg_entity_usage_computed, "assure_irg_entity_usage_computed" },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS, ir_compute_dominance_frontiers, "ir_compute_dominance_frontiers" },
 	};
 	for (size_t i = 0; i < ARRAY_SIZE(property_functions); ++i) {
 		ir_graph_properties_t missing = props & ~irg->properties;
-		if (missing & property_functions[i].property)
+		if (missing & property_functions[i].property) {
+			ir_pass_begin(irg, property_functions[i].name);
 			property_functions[i].func(irg);
+			ir_pass_end(property_functions[i].name);
+		}
 	}
 	assert((props & ~irg->properties) == IR_GRAPH_PROPERTIES_NONE);
 }
@@ -20,6 +20,7 @@
 #include "irloop.h"
 #include "irnodemap.h"
 #include "irprog.h"
+#include "irvaluetable.h"
 #include "list.h"
 #include "obst.h"
 #include "pset.h"
@@ -99,6 +100,9 @@ typedef struct ir_vrp_info {
 	struct obstack    obst;
 } ir_vrp_info;
 
+/** A frame on the explicit stack of the graph walkers, see irgwalk.c. */
+typedef struct irg_walk_frame irg_walk_frame;
+
 /**
  * An ir_graph represents the code of a function as a graph of nodes.
  */
@@ -123,6 +127,8 @@ struct ir_graph {
 	ir_visited_t     visited;
 	ir_visited_t     block_visited; /**< Visited flag for block nodes. */
 	ir_visited_t     self_visited;  /**< Visited flag of the irg */
+	irg_walk_frame  *walk_stack;    /**< Explicit stack of the walkers. */
+	size_t           walk_stack_top; /**< First free frame on walk_stack. */
 	ir_node        **idx_irn_map;   /**< Map of node indexes to nodes. */
 	size_t           index;         /**< a unique number for each graph */
 	/** A void* field to link any information to the graph. */
@@ -138,8 +144,11 @@ struct ir_graph {
 	ir_node *current_block;    /**< Block for new_*()ly created nodes. */
 
 	/** Hash table for global value numbering (CSE) */
-	pset               *value_table;
+	ir_valuetable_t    *value_table;
 	struct obstack      out_obst;    /**< Space for the Def-Use arrays. */
+	/** The Def-Use arrays of the nodes indexed by node index, NULL if the outs
+	 * were not computed. */
+	ir_def_use_edges  **outs;
 	bool                out_obst_allocated;
 	ir_bitinfo          bitinfo;     /**< bit info */
 	ir_vrp_info         vrp;         /**< vrp info */
@@ -27,75 +27,35 @@
 #include "array.h"
 
 /**
- * specialized version of irg_walk_2, called if only pre callback exists
+ * A node whose predecessors are being walked. The walkers keep these on an
+ * explicit stack instead of recursing, so deep graphs cannot overflow the C
+ * stack.
  */
-static void irg_walk_2_pre(ir_node *node, irg_walk_func *pre, void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_pre(pred, pre, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_pre(pred, pre, env);
-	}
-}
-
-/**
- * specialized version of irg_walk_2, called if only post callback exists
- */
-static void irg_walk_2_post(ir_node *node, irg_walk_func *post, void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
+struct irg_walk_frame {
+	ir_node *node;
+	int      pos;  /**< the next predecessor to walk is pos-1 */
+};
 
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_post(pred, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_post(pred, post, env);
-	}
-
-	post(node, env);
-}
+/** pos of a frame whose block has not been walked yet */
+#define POS_BLOCK -1
+/** pos of a frame whose arity has not been queried yet */
+#define POS_ARITY -2
 
 /**
- * specialized version of irg_walk_2, called if pre and post callbacks exist
+ * Makes room for one more frame on the walker stack of @p irg and returns the
+ * (possibly moved) stack.
+ *
+ * The stack is kept in the graph and reused by all walks. A walk started from
+ * a callback continues above irg->walk_stack_top, so the walkers publish
+ * their top before each callback and reload the stack afterwards.
  */
-static void irg_walk_2_both(ir_node *node, irg_walk_func *pre,
-                                irg_walk_func *post, void *env)
+static irg_walk_frame *grow_walk_stack(ir_graph *irg, size_t top)
 {
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_both(pred, pre, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_both(pred, pre, post, env);
-	}
-
-	post(node, env);
+	if (irg->walk_stack == NULL)
+		irg->walk_stack = NEW_ARR_F(irg_walk_frame, 0);
+	if (top == ARR_LEN(irg->walk_stack))
+		ARR_RESIZE(irg_walk_frame, irg->walk_stack, 2 * top + 16);
+	return irg->walk_stack;
 }
 
 void irg_walk_2(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
@@ -104,9 +64,53 @@ void irg_walk_2(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
 	if (irn_visited(node))
 		return;
 
-	if      (post == NULL) irg_walk_2_pre (node, pre, env);
-	else if (pre  == NULL) irg_walk_2_post(node, post, env);
-	else                   irg_walk_2_both(node, pre, post, env);
+	ir_graph       *const irg     = get_irn_irg(node);
+	ir_visited_t    const visited = irg->visited;
+	size_t          const base    = irg->walk_stack_top;
+	size_t                top     = base;
+	irg_walk_frame       *stack;
+
+	/* the block of a node is walked first, then its inputs from the last to
+	 * the first, just like the recursive walker did */
+	for (;;) {
+		if (node != NULL) {
+			set_irn_visited(node, visited);
+			if (pre != NULL) {
+				irg->walk_stack_top = top;
+				pre(node, env);
+			}
+			stack = grow_walk_stack(irg, top);
+			stack[top].node = node;
+			stack[top].pos  = is_Block(node) ? POS_ARITY : POS_BLOCK;
+			++top;
+		}
+		if (top == base)
+			break;
+
+		irg_walk_frame *const frame = &stack[top - 1];
+		ir_node        *const cur   = frame->node;
+		ir_node              *pred;
+		if (frame->pos == POS_BLOCK) {
+			frame->pos = POS_ARITY;
+			pred       = get_nodes_block(cur);
+		} else {
+			if (frame->pos == POS_ARITY)
+				frame->pos = get_irn_arity(cur);
+			if (frame->pos == 0) {
+				--top;
+				if (post != NULL) {
+					irg->walk_stack_top = top;
+					post(cur, env);
+					stack = irg->walk_stack;
+				}
+				node = NULL;
+				continue;
+			}
+			pred = get_irn_n(cur, --frame->pos);
+		}
+		node = pred->visited < visited ? pred : NULL;
+	}
+	irg->walk_stack_top = base;
 }
 
 void irg_walk_core(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
@@ -139,94 +143,6 @@ void all_irg_walk(irg_walk_func *pre, irg_walk_func *post, void *env)
 	}
 }
 
-/**
- * specialized version of irg_walk_in_or_dep_2, called if only pre callback exists
- */
-static void irg_walk_in_or_dep_2_pre(ir_node *node, irg_walk_func *pre,
-                                     void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_pre(pred, pre, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_pre(pred, pre, env);
-	}
-}
-
-/**
- * specialized version of irg_walk_in_or_dep_2, called if only post callback exists
- */
-static void irg_walk_in_or_dep_2_post(ir_node *node, irg_walk_func *post,
-                                      void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_post(pred, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_post(pred, post, env);
-	}
-
-	post(node, env);
-}
-
-/**
- * specialized version of irg_walk_in_or_dep_2, called if pre and post callbacks exist
- */
-static void irg_walk_in_or_dep_2_both(ir_node *node, irg_walk_func *pre,
-                                      irg_walk_func *post, void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_both(pred, pre, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_both(pred, pre, post, env);
-	}
-
-	post(node, env);
-}
-
-/**
- * Intraprozedural graph walker. Follows dependency edges as well.
- */
-static void irg_walk_in_or_dep_2(ir_node *node, irg_walk_func *pre,
-                                 irg_walk_func *post, void *env)
-{
-	if (irn_visited(node))
-		return;
-
-	if      (post == NULL) irg_walk_in_or_dep_2_pre (node, pre, env);
-	else if (pre == NULL)  irg_walk_in_or_dep_2_post(node, post, env);
-	else                   irg_walk_in_or_dep_2_both(node, pre, post, env);
-}
-
 void irg_walk_in_or_dep(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
                         void *env)
 {
@@ -235,7 +151,7 @@ void irg_walk_in_or_dep(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
 	ir_graph *const irg = get_irn_irg(node);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
 	inc_irg_visited(irg);
-	irg_walk_in_or_dep_2(node, pre, post, env);
+	irg_walk_2(node, pre, post, env);
 	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 }
 
@@ -260,23 +176,48 @@ static void irg_block_walk_2(ir_node *node, irg_walk_func *pre,
 {
 	if (Block_block_visited(node))
 		return;
-	mark_Block_block_visited(node);
-
-	if (pre != NULL)
-		pre(node, env);
 
-	for (int i = get_Block_n_cfgpreds(node); i-- > 0; ) {
+	ir_graph       *const irg  = get_irn_irg(node);
+	size_t          const base = irg->walk_stack_top;
+	size_t                top  = base;
+	irg_walk_frame       *stack;
+
+	for (;;) {
+		if (node != NULL) {
+			mark_Block_block_visited(node);
+			if (pre != NULL) {
+				irg->walk_stack_top = top;
+				pre(node, env);
+			}
+			stack = grow_walk_stack(irg, top);
+			stack[top].node = node;
+			stack[top].pos  = get_Block_n_cfgpreds(node);
+			++top;
+		}
+		if (top == base)
+			break;
+
+		irg_walk_frame *const frame = &stack[top - 1];
+		ir_node        *const cur   = frame->node;
+		node = NULL;
+		if (frame->pos == 0) {
+			--top;
+			if (post != NULL) {
+				irg->walk_stack_top = top;
+				post(cur, env);
+				stack = irg->walk_stack;
+			}
+			continue;
+		}
 		/* find the corresponding predecessor block. */
-		ir_node *pred_cfop  = get_cf_op(get_Block_cfgpred(node, i));
+		ir_node *pred_cfop = get_cf_op(get_Block_cfgpred(cur, --frame->pos));
 		if (is_Bad(pred_cfop))
 			continue;
 		ir_node *pred_block = get_nodes_block(pred_cfop);
-		/* recursion */
-		irg_block_walk_2(pred_block, pre, post, env);
+		if (!Block_block_visited(pred_block))
+			node = pred_block;
 	}
-
-	if (post != NULL)
-		post(node, env);
+	irg->walk_stack_top = base;
 }
 
 void irg_block_walk(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
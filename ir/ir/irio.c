@@ -5,15 +5,29 @@
 
 /**
  * @file
- * @brief   Write textual representation of firm to file.
+ * @brief   Write textual or binary representation of firm to file.
  * @author  Moritz Kroll, Matthias Braun
+ *
+ * Both formats share the readers and writers below. The binary format
+ * replaces each token of the text format by a varint: symbols and strings
+ * become indices into a string table, types, entities and nodes are numbered
+ * densely. The file is split into sections and the bodies of the graphs are
+ * only read when they are requested, see ir_binary_open().
  */
+#ifndef _WIN32
+/* open(), fstat() and mmap() */
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
 
-#include "irio.h"
+#include "irio_t.h"
 
 #include "irnode_t.h"
 #include "irprog_t.h"
@@ -32,9 +46,25 @@
 #include "pmap.h"
 #include "pdeq.h"
 #include "util.h"
+#include "xmalloc.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HAVE_MMAP
+#endif
 
 #define SYMERROR ((unsigned) ~0)
 
+/** Version of the binary format, increase it on incompatible changes. */
+#define BINARY_VERSION     1
+/** Magic bytes at the start of a binary file. */
+#define BINARY_MAGIC       "\177FIRMIR\n"
+#define BINARY_MAGIC_SIZE  8
+#define BINARY_HEADER_SIZE (BINARY_MAGIC_SIZE + 8 + 16 * bs_count)
+
 static void register_generated_node_readers(void);
 static void register_generated_node_writers(void);
 
@@ -49,12 +79,42 @@ typedef struct delayed_pred_t {
 	long     preds[];
 } delayed_pred_t;
 
+/** The sections of a binary file. */
+typedef enum binary_section_t {
+	bs_strings,
+	bs_modes,
+	bs_typegraph,
+	bs_constirg,
+	bs_program,
+	bs_irgs,
+	bs_count
+} binary_section_t;
+
+/** A string table entry of a binary file along with its decoded forms. */
+typedef struct binary_string_t {
+	const char *str;
+	ident      *id;         /**< the ident for str, created on demand */
+	ir_mode    *mode;       /**< the mode named str, looked up on demand */
+	unsigned    code;       /**< symbol code of str for code_tag */
+	int         code_tag;   /**< typetag of code, -1 if not looked up */
+} binary_string_t;
+
 typedef struct read_env_t {
 	int            c;           /**< currently read char */
 	FILE          *file;
 	const char    *inputname;
 	unsigned       line;
 
+	bool                 binary;   /**< reading the binary format */
+	const unsigned char *data;     /**< start of the binary file */
+	const unsigned char *pos;      /**< read position in the binary file */
+	const unsigned char *end;      /**< end of the current section */
+	binary_string_t     *strings;  /**< string table of the binary file */
+	ir_type            **types;    /**< types of the binary file by number */
+	ir_entity          **entities; /**< entities of the binary file by number */
+	ir_node            **nodes;    /**< nodes of the current graph by number */
+	size_t               list_len; /**< remaining entries of the current list */
+
 	ir_graph      *irg;
 	set           *idset;       /**< id_entry set, which maps from file ids to
 	                                 new Firm elements */
@@ -70,6 +130,19 @@ typedef struct write_env_t {
 	FILE *file;
 	pdeq *write_queue;
 	pdeq *entity_queue;
+
+	bool            binary;      /**< writing the binary format */
+	bool            canonical;   /**< writing the canonical form of a graph */
+	struct obstack  out;         /**< the binary file */
+	ident         **strings;     /**< string table of the binary file */
+	pmap           *string_nrs;  /**< ident -> string number + 1 */
+	pmap           *symbol_nrs;  /**< string constant -> string number + 1 */
+	pmap           *type_nrs;    /**< type -> type number + 1 */
+	pmap           *entity_nrs;  /**< entity -> entity number + 1 */
+	size_t          n_types;
+	size_t          n_entities;
+	unsigned       *node_nrs;    /**< node index -> node number + 1 */
+	unsigned        n_nodes;     /**< node numbers used in the current graph */
 } write_env_t;
 
 typedef enum typetag_t {
@@ -103,6 +176,7 @@ typedef enum keyword_t {
 	kw_label,
 	kw_method,
 	kw_modes,
+	kw_name,
 	kw_parameter,
 	kw_program,
 	kw_reference_mode,
@@ -151,14 +225,19 @@ static int id_cmp(const void *elt, const void *key, size_t size)
 static void FIRM_PRINTF(2, 3)
 parse_error(read_env_t *env, const char *fmt, ...)
 {
-	/* workaround read_c "feature" that a '\n' triggers the line++
-	 * instead of the character after the '\n' */
-	unsigned line = env->line;
-	if (env->c == '\n') {
-		line--;
-	}
+	if (env->binary) {
+		ir_fprintf(stderr, "%s:@%zu: error ", env->inputname,
+		           (size_t)(env->pos - env->data));
+	} else {
+		/* workaround read_c "feature" that a '\n' triggers the line++
+		 * instead of the character after the '\n' */
+		unsigned line = env->line;
+		if (env->c == '\n') {
+			line--;
+		}
 
-	fprintf(stderr, "%s:%u: error ", env->inputname, line);
+		fprintf(stderr, "%s:%u: error ", env->inputname, line);
+	}
 	env->read_errors = true;
 
 	va_list ap;
@@ -231,6 +310,7 @@ static void symtbl_init(void)
 	INSERTKEYWORD(label);
 	INSERTKEYWORD(method);
 	INSERTKEYWORD(modes);
+	INSERTKEYWORD(name);
 	INSERTKEYWORD(parameter);
 	INSERTKEYWORD(program);
 	INSERTKEYWORD(reference_mode);
@@ -334,39 +414,138 @@ static unsigned symbol(const char *str, typetag_t typetag)
 	return entry ? entry->code : SYMERROR;
 }
 
+static void write_varint(write_env_t *env, uint64_t value)
+{
+	while (value >= 0x80) {
+		obstack_1grow(&env->out, (char)(value | 0x80));
+		value >>= 7;
+	}
+	obstack_1grow(&env->out, (char)value);
+}
+
+/** Returns the string table number (plus one) of an ident. */
+static size_t get_string_nr(write_env_t *env, ident *id)
+{
+	size_t nr = (size_t)pmap_get(void, env->string_nrs, id);
+	if (nr == 0) {
+		ARR_APP1(ident*, env->strings, id);
+		nr = ARR_LEN(env->strings);
+		pmap_insert(env->string_nrs, id, (void*)nr);
+	}
+	return nr;
+}
+
+/** Writes a signed number, zigzag encoding keeps small negative numbers
+ * short. */
+static void write_svarint(write_env_t *env, int64_t value)
+{
+	write_varint(env, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
 static void write_long(write_env_t *env, long value)
 {
+	if (env->binary) {
+		write_svarint(env, value);
+		return;
+	}
 	fprintf(env->file, "%ld ", value);
 }
 
 static void write_int(write_env_t *env, int value)
 {
+	if (env->binary) {
+		write_long(env, value);
+		return;
+	}
 	fprintf(env->file, "%d ", value);
 }
 
 static void write_unsigned(write_env_t *env, unsigned value)
 {
+	if (env->binary) {
+		write_varint(env, value);
+		return;
+	}
 	fprintf(env->file, "%u ", value);
 }
 
 static void write_size_t(write_env_t *env, size_t value)
 {
+	if (env->binary) {
+		write_varint(env, value);
+		return;
+	}
 	ir_fprintf(env->file, "%zu ", value);
 }
 
+/**
+ * Writes a symbol. In the binary format symbols are cached by their address,
+ * so @p symbol must be a string constant.
+ */
 static void write_symbol(write_env_t *env, const char *symbol)
 {
+	if (env->binary) {
+		size_t nr = (size_t)pmap_get(void, env->symbol_nrs, symbol);
+		if (nr == 0) {
+			nr = get_string_nr(env, new_id_from_str(symbol));
+			pmap_insert(env->symbol_nrs, symbol, (void*)nr);
+		}
+		write_varint(env, nr);
+		return;
+	}
 	fputs(symbol, env->file);
 	fputc(' ', env->file);
 }
 
+static void write_canonical_entity(write_env_t *env, ir_entity *entity);
+
 static void write_entity_ref(write_env_t *env, ir_entity *entity)
 {
+	if (env->canonical) {
+		write_canonical_entity(env, entity);
+		return;
+	}
+	if (env->binary) {
+		size_t const nr = (size_t)pmap_get(void, env->entity_nrs, entity);
+		if (nr == 0)
+			panic("entity %+F was not exported", entity);
+		write_varint(env, nr - 1);
+		return;
+	}
 	write_long(env, get_entity_nr(entity));
 }
 
+static void write_canonical_type(write_env_t *env, ir_type *type,
+                                 bool shallow);
+
 static void write_type_ref(write_env_t *env, ir_type *type)
 {
+	if (env->canonical) {
+		write_canonical_type(env, type, false);
+		return;
+	}
+	if (env->binary) {
+		/* 0 is NULL, 1 the unknown and 2 the code type */
+		size_t nr = 0;
+		if (type != NULL) {
+			switch (get_type_opcode(type)) {
+			case tpo_unknown: nr = 1; break;
+			case tpo_code:    nr = 2; break;
+			default:
+				nr = (size_t)pmap_get(void, env->type_nrs, type);
+				if (nr == 0)
+					panic("type %+F was not exported", type);
+				nr += 2;
+				break;
+			}
+		}
+		write_varint(env, nr);
+		return;
+	}
+	if (type == NULL) {
+		write_symbol(env, "NULL");
+		return;
+	}
 	switch (get_type_opcode(type)) {
 	case tpo_unknown:
 		write_symbol(env, "unknown");
@@ -380,8 +559,35 @@ static void write_type_ref(write_env_t *env, ir_type *type)
 	write_long(env, get_type_nr(type));
 }
 
+/** Writes the number of a type at its definition. */
+static void write_type_nr(write_env_t *env, ir_type *type)
+{
+	if (env->binary) {
+		/* types are numbered in the order of their definition */
+		size_t const nr = ++env->n_types;
+		pmap_insert(env->type_nrs, type, (void*)nr);
+		return;
+	}
+	write_long(env, get_type_nr(type));
+}
+
+/** Writes the number of an entity at its definition. */
+static void write_entity_nr(write_env_t *env, ir_entity *entity)
+{
+	if (env->binary) {
+		size_t const nr = ++env->n_entities;
+		pmap_insert(env->entity_nrs, entity, (void*)nr);
+		return;
+	}
+	write_long(env, get_entity_nr(entity));
+}
+
 static void write_string(write_env_t *env, const char *string)
 {
+	if (env->binary) {
+		write_varint(env, get_string_nr(env, new_id_from_str(string)));
+		return;
+	}
 	fputc('"', env->file);
 	for (const char *c = string; *c != '\0'; ++c) {
 		switch (*c) {
@@ -404,13 +610,20 @@ static void write_string(write_env_t *env, const char *string)
 
 static void write_ident(write_env_t *env, ident *id)
 {
+	if (env->binary) {
+		write_varint(env, get_string_nr(env, id));
+		return;
+	}
 	write_string(env, get_id_str(id));
 }
 
 static void write_ident_null(write_env_t *env, ident *id)
 {
 	if (id == NULL) {
-		fputs("NULL ", env->file);
+		if (env->binary)
+			write_varint(env, 0);
+		else
+			fputs("NULL ", env->file);
 	} else {
 		write_ident(env, id);
 	}
@@ -418,13 +631,134 @@ static void write_ident_null(write_env_t *env, ident *id)
 
 static void write_mode_ref(write_env_t *env, ir_mode *mode)
 {
+	if (env->binary) {
+		write_symbol(env, get_mode_name(mode));
+		return;
+	}
 	write_string(env, get_mode_name(mode));
 }
 
+/**
+ * Writes the properties of a type which matter for the code of a graph
+ * referencing it. The types referenced by a type are only described
+ * shallowly, which keeps recursive types finite.
+ */
+static void write_canonical_type(write_env_t *env, ir_type *type, bool shallow)
+{
+	if (type == NULL) {
+		write_varint(env, 0);
+		return;
+	}
+	tp_opcode const opcode = get_type_opcode(type);
+	write_varint(env, opcode + 1);
+	if (opcode == tpo_unknown || opcode == tpo_code)
+		return;
+	write_unsigned(env, get_type_size_bytes(type));
+	write_unsigned(env, get_type_alignment_bytes(type));
+	ir_mode *const mode = get_type_mode(type);
+	write_ident_null(env, mode != NULL ? new_id_from_str(get_mode_name(mode))
+	                                   : NULL);
+	if (shallow)
+		return;
+
+	switch (opcode) {
+	case tpo_method: {
+		size_t const n_params = get_method_n_params(type);
+		size_t const n_ress   = get_method_n_ress(type);
+		write_unsigned(env, get_method_calling_convention(type));
+		write_unsigned(env, get_method_additional_properties(type));
+		write_int(env, is_method_variadic(type));
+		write_size_t(env, n_params);
+		for (size_t i = 0; i < n_params; ++i)
+			write_canonical_type(env, get_method_param_type(type, i), true);
+		write_size_t(env, n_ress);
+		for (size_t i = 0; i < n_ress; ++i)
+			write_canonical_type(env, get_method_res_type(type, i), true);
+		break;
+	}
+	case tpo_pointer:
+		write_canonical_type(env, get_pointer_points_to_type(type), true);
+		break;
+	case tpo_array:
+		write_canonical_type(env, get_array_element_type(type), true);
+		write_unsigned(env, get_array_size_int(type));
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Writes an entity by its name and the properties which matter for the code
+ * of a graph referencing it.
+ */
+static void write_canonical_entity(write_env_t *env, ir_entity *entity)
+{
+	ir_entity_kind const kind = get_entity_kind(entity);
+	write_varint(env, kind);
+	write_ident_null(env, get_entity_ident(entity));
+	if (kind != IR_ENTITY_LABEL)
+		write_ident_null(env, get_entity_ld_ident(entity));
+	write_unsigned(env, get_entity_visibility(entity));
+	write_unsigned(env, get_entity_linkage(entity));
+	write_unsigned(env, get_entity_alignment(entity));
+	write_unsigned(env, get_entity_volatility(entity));
+	switch (kind) {
+	case IR_ENTITY_LABEL:
+		write_unsigned(env, get_entity_label(entity));
+		break;
+	case IR_ENTITY_PARAMETER:
+		write_size_t(env, get_entity_parameter_number(entity));
+		/* FALLTHROUGH */
+	case IR_ENTITY_COMPOUND_MEMBER:
+		write_int(env, get_entity_offset(entity));
+		write_unsigned(env, get_entity_bitfield_offset(entity));
+		write_unsigned(env, get_entity_bitfield_size(entity));
+		break;
+	default:
+		break;
+	}
+	write_canonical_type(env, get_entity_type(entity), false);
+}
+
 static void write_tarval_ref(write_env_t *env, ir_tarval *tv)
 {
 	ir_mode *mode = get_tarval_mode(tv);
 	write_mode_ref(env, mode);
+	if (env->binary) {
+		unsigned char bytes[32];
+		unsigned      n_bytes = get_mode_size_bytes(mode);
+		switch (get_mode_arithmetic(mode)) {
+		case irma_twos_complement: {
+			unsigned const bits = get_mode_size_bits(mode);
+			n_bytes = bits / CHAR_BIT + (bits % CHAR_BIT != 0);
+			if (bits > 64)
+				break;
+			/* store the sign extended bit pattern as a signed varint */
+			tarval_to_bytes(bytes, tv);
+			uint64_t value = 0;
+			for (unsigned i = n_bytes; i-- > 0;)
+				value = value << CHAR_BIT | bytes[i];
+			if (bits < 64 && value >> (bits - 1) & 1)
+				value |= ~(uint64_t)0 << bits;
+			write_svarint(env, (int64_t)value);
+			return;
+		}
+		case irma_ieee754:
+		case irma_x86_extended_float:
+			break;
+		case irma_none: {
+			char        buf[128];
+			char const *ascii = ir_tarval_to_ascii(buf, sizeof(buf), tv);
+			write_string(env, ascii);
+			return;
+		}
+		}
+		assert(n_bytes <= sizeof(bytes));
+		tarval_to_bytes(bytes, tv);
+		obstack_grow(&env->out, bytes, n_bytes);
+		return;
+	}
 	char buf[128];
 	const char *ascii = ir_tarval_to_ascii(buf, sizeof(buf), tv);
 	fputs(ascii, env->file);
@@ -433,20 +767,17 @@ static void write_tarval_ref(write_env_t *env, ir_tarval *tv)
 
 static void write_align(write_env_t *env, ir_align align)
 {
-	fputs(get_align_name(align), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_align_name(align));
 }
 
 static void write_builtin_kind(write_env_t *env, ir_builtin_kind kind)
 {
-	fputs(get_builtin_kind_name(kind), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_builtin_kind_name(kind));
 }
 
 static void write_cond_jmp_predicate(write_env_t *env, cond_jmp_predicate pred)
 {
-	fputs(get_cond_jmp_predicate_name(pred), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_cond_jmp_predicate_name(pred));
 }
 
 static void write_relation(write_env_t *env, ir_relation relation)
@@ -464,38 +795,92 @@ static void write_loop(write_env_t *env, bool loop)
 	write_symbol(env, loop ? "loop" : "noloop");
 }
 
-static void write_list_begin(write_env_t *env)
+/**
+ * Starts a list of @p n_entries entries. Only the binary format stores the
+ * length, the text format marks the end of the list.
+ */
+static void write_list_begin(write_env_t *env, size_t n_entries)
 {
+	if (env->binary) {
+		write_varint(env, n_entries);
+		return;
+	}
 	fputs("[", env->file);
 }
 
 static void write_list_end(write_env_t *env)
 {
+	if (env->binary)
+		return;
 	fputs("] ", env->file);
 }
 
 static void write_scope_begin(write_env_t *env)
 {
+	if (env->binary)
+		return;
 	fputs("{\n", env->file);
 }
 
 static void write_scope_end(write_env_t *env)
 {
+	if (env->binary)
+		return;
 	fputs("}\n\n", env->file);
 }
 
+/** Starts a line of the text format. */
+static void write_line_begin(write_env_t *env)
+{
+	if (env->binary)
+		return;
+	fputc('\t', env->file);
+}
+
+/** Ends a line of the text format. */
+static void write_line_end(write_env_t *env)
+{
+	if (env->binary)
+		return;
+	fputc('\n', env->file);
+}
+
+/**
+ * Writes a node reference. The binary format numbers the nodes of a graph
+ * densely in the order they are first mentioned, so a reader never sees a
+ * number larger than the count of the numbers it has seen before.
+ */
 static void write_node_ref(write_env_t *env, const ir_node *node)
 {
+	if (env->binary) {
+		unsigned *const nr = &env->node_nrs[get_irn_idx(node)];
+		if (*nr == 0)
+			*nr = ++env->n_nodes;
+		write_varint(env, *nr - 1);
+		return;
+	}
 	write_long(env, get_irn_node_nr(node));
 }
 
+static void init_node_nrs(write_env_t *env, ir_graph *irg)
+{
+	if (!env->binary)
+		return;
+	env->node_nrs = XMALLOCNZ(unsigned, get_irg_last_idx(irg));
+	env->n_nodes  = 0;
+}
+
+static void free_node_nrs(write_env_t *env)
+{
+	free(env->node_nrs);
+	env->node_nrs = NULL;
+}
+
 static void write_initializer(write_env_t *const env, ir_initializer_t const *const ini)
 {
-	FILE *f = env->file;
 	ir_initializer_kind_t ini_kind = get_initializer_kind(ini);
 
-	fputs(get_initializer_kind_name(ini_kind), f);
-	fputc(' ', f);
+	write_symbol(env, get_initializer_kind_name(ini_kind));
 
 	switch (ini_kind) {
 	case IR_INITIALIZER_CONST:
@@ -522,39 +907,34 @@ static void write_initializer(write_env_t *const env, ir_initializer_t const *co
 
 static void write_pin_state(write_env_t *env, op_pin_state state)
 {
-	fputs(get_op_pin_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_op_pin_state_name(state));
 }
 
 static void write_volatility(write_env_t *env, ir_volatility vol)
 {
-	fputs(get_volatility_name(vol), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_volatility_name(vol));
 }
 
 static void write_type_state(write_env_t *env, ir_type_state state)
 {
-	fputs(get_type_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_type_state_name(state));
 }
 
 static void write_visibility(write_env_t *env, ir_visibility visibility)
 {
-	fputs(get_visibility_name(visibility), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_visibility_name(visibility));
 }
 
 static void write_mode_arithmetic(write_env_t *env, ir_mode_arithmetic arithmetic)
 {
-	fputs(get_mode_arithmetic_name(arithmetic), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_mode_arithmetic_name(arithmetic));
 }
 
 static void write_type_common(write_env_t *env, ir_type *tp)
 {
-	fputc('\t', env->file);
+	write_line_begin(env);
 	write_symbol(env, "type");
-	write_long(env, get_type_nr(tp));
+	write_type_nr(env, tp);
 	write_symbol(env, get_type_opcode_name(get_type_opcode(tp)));
 	write_unsigned(env, get_type_size_bytes(tp));
 	write_unsigned(env, get_type_alignment_bytes(tp));
@@ -586,7 +966,7 @@ static void write_type_primitive(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_mode_ref(env, mode);
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_type_compound(write_env_t *env, ir_type *tp)
@@ -600,7 +980,7 @@ static void write_type_compound(write_env_t *env, ir_type *tp)
 	}
 	write_type_common(env, tp);
 	write_ident_null(env, get_compound_ident(tp));
-	fputc('\n', env->file);
+	write_line_end(env);
 
 	for (size_t i = 0, n = get_compound_n_members(tp); i < n; ++i) {
 		ir_entity *member = get_compound_member(tp, i);
@@ -616,13 +996,19 @@ static void write_type_array(write_env_t *env, ir_type *tp)
 	write_type_common(env, tp);
 	write_type_ref(env, element_type);
 	ir_node *size = get_array_size(tp);
-	if (is_Const(size))
+	if (is_Const(size)) {
+		if (env->binary)
+			write_unsigned(env, true);
 		write_long(env, get_Const_long(size));
-	else if (is_Unknown(size))
-		write_symbol(env, "unknown");
-	else
+	} else if (is_Unknown(size)) {
+		if (env->binary)
+			write_unsigned(env, false);
+		else
+			write_symbol(env, "unknown");
+	} else {
 		panic("upper array bound is not constant");
-	fputc('\n', env->file);
+	}
+	write_line_end(env);
 }
 
 static void write_type_method(write_env_t *env, ir_type *tp)
@@ -644,7 +1030,7 @@ static void write_type_method(write_env_t *env, ir_type *tp)
 	for (size_t i = 0; i < nresults; i++)
 		write_type_ref(env, get_method_res_type(tp, i));
 	write_unsigned(env, is_method_variadic(tp));
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_type_pointer(write_env_t *env, ir_type *tp)
@@ -655,7 +1041,7 @@ static void write_type_pointer(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_type_ref(env, points_to);
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_type(write_env_t *env, ir_type *tp)
@@ -703,7 +1089,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 		write_entity(env, aliased);
 	}
 
-	fputc('\t', env->file);
+	write_line_begin(env);
 	switch ((ir_entity_kind)ent->entity_kind) {
 	case IR_ENTITY_ALIAS:           write_symbol(env, "alias");           break;
 	case IR_ENTITY_NORMAL:          write_symbol(env, "entity");          break;
@@ -713,10 +1099,10 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 	case IR_ENTITY_PARAMETER:       write_symbol(env, "parameter");       break;
 	case IR_ENTITY_UNKNOWN:
 		write_symbol(env, "unknown");
-		write_long(env, get_entity_nr(ent));
+		write_entity_nr(env, ent);
 		return;
 	}
-	write_long(env, get_entity_nr(ent));
+	write_entity_nr(env, ent);
 
 	if (ent->entity_kind != IR_ENTITY_LABEL
 	 && ent->entity_kind != IR_ENTITY_PARAMETER) {
@@ -729,17 +1115,26 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 	}
 
 	write_visibility(env, visibility);
-	write_list_begin(env);
-	if (linkage & IR_LINKAGE_CONSTANT)
-		write_symbol(env, "constant");
-	if (linkage & IR_LINKAGE_WEAK)
-		write_symbol(env, "weak");
-	if (linkage & IR_LINKAGE_GARBAGE_COLLECT)
-		write_symbol(env, "garbage_collect");
-	if (linkage & IR_LINKAGE_MERGE)
-		write_symbol(env, "merge");
-	if (linkage & IR_LINKAGE_HIDDEN_USER)
-		write_symbol(env, "hidden_user");
+	static const struct {
+		ir_linkage  linkage;
+		const char *name;
+	} linkage_names[] = {
+		{ IR_LINKAGE_CONSTANT,        "constant"        },
+		{ IR_LINKAGE_WEAK,            "weak"            },
+		{ IR_LINKAGE_GARBAGE_COLLECT, "garbage_collect" },
+		{ IR_LINKAGE_MERGE,           "merge"           },
+		{ IR_LINKAGE_HIDDEN_USER,     "hidden_user"     },
+	};
+	size_t n_linkages = 0;
+	for (size_t i = 0; i < ARRAY_SIZE(linkage_names); ++i) {
+		if (linkage & linkage_names[i].linkage)
+			++n_linkages;
+	}
+	write_list_begin(env, n_linkages);
+	for (size_t i = 0; i < ARRAY_SIZE(linkage_names); ++i) {
+		if (linkage & linkage_names[i].linkage)
+			write_symbol(env, linkage_names[i].name);
+	}
 	write_list_end(env);
 
 	write_type_ref(env, type);
@@ -770,7 +1165,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 		break;
 	case IR_ENTITY_PARAMETER: {
 		size_t num = get_entity_parameter_number(ent);
-		if (num == IR_VA_START_PARAMETER_NUMBER) {
+		if (num == IR_VA_START_PARAMETER_NUMBER && !env->binary) {
 			write_symbol(env, "va_start");
 		} else {
 			write_size_t(env, num);
@@ -788,7 +1183,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 		break;
 	}
 
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_switch_table_ref(write_env_t *env,
@@ -808,9 +1203,9 @@ static void write_switch_table_ref(write_env_t *env,
 
 static void write_pred_refs(write_env_t *env, const ir_node *node, int from)
 {
-	write_list_begin(env);
 	int arity = get_irn_arity(node);
 	assert(from <= arity);
+	write_list_begin(env, arity - from);
 	for (int i = from; i < arity; ++i) {
 		ir_node *pred = get_irn_n(node, i);
 		write_node_ref(env, pred);
@@ -820,7 +1215,7 @@ static void write_pred_refs(write_env_t *env, const ir_node *node, int from)
 
 static void write_node_nr(write_env_t *env, const ir_node *node)
 {
-	write_long(env, get_irn_node_nr(node));
+	write_node_ref(env, node);
 }
 
 static void write_ASM(write_env_t *env, const ir_node *node)
@@ -831,9 +1226,9 @@ static void write_ASM(write_env_t *env, const ir_node *node)
 	write_node_nr(env, get_ASM_mem(node));
 
 	write_ident(env, get_ASM_text(node));
-	write_list_begin(env);
 	ir_asm_constraint *input_constraints = get_ASM_input_constraints(node);
 	int                n_inputs          = get_ASM_n_inputs(node);
+	write_list_begin(env, n_inputs);
 	for (int i = 0; i < n_inputs; ++i) {
 		const ir_asm_constraint *constraint = &input_constraints[i];
 		write_unsigned(env, constraint->pos);
@@ -842,9 +1237,9 @@ static void write_ASM(write_env_t *env, const ir_node *node)
 	}
 	write_list_end(env);
 
-	write_list_begin(env);
 	ir_asm_constraint *output_constraints  = get_ASM_output_constraints(node);
 	size_t            n_output_constraints = get_ASM_n_output_constraints(node);
+	write_list_begin(env, n_output_constraints);
 	for (size_t i = 0; i < n_output_constraints; ++i) {
 		const ir_asm_constraint *constraint = &output_constraints[i];
 		write_unsigned(env, constraint->pos);
@@ -853,9 +1248,9 @@ static void write_ASM(write_env_t *env, const ir_node *node)
 	}
 	write_list_end(env);
 
-	write_list_begin(env);
 	ident **clobbers   = get_ASM_clobbers(node);
 	size_t  n_clobbers = get_ASM_n_clobbers(node);
+	write_list_begin(env, n_clobbers);
 	for (size_t i = 0; i < n_clobbers; ++i) {
 		ident *clobber = clobbers[i];
 		write_ident(env, clobber);
@@ -920,11 +1315,11 @@ static void write_node(const ir_node *node, write_env_t *env)
 	ir_op           *const op   = get_irn_op(node);
 	write_node_func *const func = get_generic_function_ptr(write_node_func, op);
 
-	fputc('\t', env->file);
+	write_line_begin(env);
 	if (func == NULL)
 		panic("no write_node_func for %+F", node);
 	func(env, node);
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_node_recursive(ir_node *node, write_env_t *env);
@@ -995,18 +1390,18 @@ static void write_mode(write_env_t *env, ir_mode *mode)
 static void write_modes(write_env_t *env)
 {
 	write_symbol(env, "modes");
-	fputs("{\n", env->file);
+	write_scope_begin(env);
 
 	for (size_t i = 0, n_modes = ir_get_n_modes(); i < n_modes; i++) {
 		ir_mode *mode = ir_get_mode(i);
 		if (is_internal_mode(mode))
 			continue;
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_mode(env, mode);
-		fputc('\n', env->file);
+		write_line_end(env);
 	}
 
-	fputs("}\n\n", env->file);
+	write_scope_end(env);
 }
 
 static void write_program(write_env_t *env)
@@ -1014,31 +1409,26 @@ static void write_program(write_env_t *env)
 	write_symbol(env, "program");
 	write_scope_begin(env);
 	if (irp_prog_name_is_set()) {
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_symbol(env, "name");
-		write_string(env, get_irp_name());
-		fputc('\n', env->file);
+		write_ident(env, get_irp_ident());
+		write_line_end(env);
 	}
 
 	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
-		ir_type *segment_type = get_segment_type(s);
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_symbol(env, "segment_type");
 		write_symbol(env, get_segment_name(s));
-		if (segment_type == NULL) {
-			write_symbol(env, "NULL");
-		} else {
-			write_type_ref(env, segment_type);
-		}
-		fputc('\n', env->file);
+		write_type_ref(env, get_segment_type(s));
+		write_line_end(env);
 	}
 
 	for (size_t i = 0, n_asms = get_irp_n_asms(); i < n_asms; ++i) {
 		ident *asm_text = get_irp_asm(i);
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_symbol(env, "asm");
 		write_ident(env, asm_text);
-		fputc('\n', env->file);
+		write_line_end(env);
 	}
 	write_scope_end(env);
 }
@@ -1084,11 +1474,9 @@ static void write_typegraph(write_env_t *env)
 	write_scope_end(env);
 }
 
-static void write_irg(write_env_t *env, ir_graph *irg)
+static void write_irg_body(write_env_t *env, ir_graph *irg)
 {
-	write_symbol(env, "irg");
-	write_entity_ref(env, get_irg_entity(irg));
-	write_type_ref(env, get_irg_frame_type(irg));
+	init_node_nrs(env, irg);
 	write_scope_begin(env);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
 	inc_irg_visited(irg);
@@ -1100,6 +1488,25 @@ static void write_irg(write_env_t *env, ir_graph *irg)
 	} while (!pdeq_empty(env->write_queue));
 	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 	write_scope_end(env);
+	free_node_nrs(env);
+}
+
+static void write_irg(write_env_t *env, ir_graph *irg)
+{
+	write_symbol(env, "irg");
+	write_entity_ref(env, get_irg_entity(irg));
+	write_type_ref(env, get_irg_frame_type(irg));
+	write_irg_body(env, irg);
+}
+
+static void write_constirg(write_env_t *env)
+{
+	ir_graph *const constirg = get_const_code_irg();
+	write_symbol(env, "constirg");
+	write_node_ref(env, constirg->current_block);
+	write_scope_begin(env);
+	walk_const_code(NULL, write_node_cb, env);
+	write_scope_end(env);
 }
 
 /* Exports the whole irp to the given file in a textual form. */
@@ -1122,18 +1529,170 @@ void ir_export_file(FILE *file)
 		write_irg(env, irg);
 	}
 
-	write_symbol(env, "constirg");
-	write_node_ref(env, get_const_code_irg()->current_block);
-	write_scope_begin(env);
-	walk_const_code(NULL, write_node_cb, env);
-	write_scope_end(env);
-
+	write_constirg(env);
 	write_program(env);
 
 	del_pdeq(env->entity_queue);
 	del_pdeq(env->write_queue);
 }
 
+int ir_export_binary(const char *filename)
+{
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL) {
+		perror(filename);
+		return 1;
+	}
+
+	ir_export_binary_file(file);
+	int res = ferror(file);
+	fclose(file);
+	return res;
+}
+
+static void put_u32(unsigned char *buf, uint32_t value)
+{
+	for (unsigned i = 0; i < 4; ++i)
+		buf[i] = (unsigned char)(value >> (8 * i));
+}
+
+static void put_u64(unsigned char *buf, uint64_t value)
+{
+	put_u32(buf,     (uint32_t)value);
+	put_u32(buf + 4, (uint32_t)(value >> 32));
+}
+
+static void write_strings(write_env_t *env)
+{
+	size_t const n = ARR_LEN(env->strings);
+	write_size_t(env, n);
+	for (size_t i = 0; i < n; ++i) {
+		const char *str = get_id_str(env->strings[i]);
+		size_t      len = strlen(str);
+		write_size_t(env, len);
+		/* keep the '\0', so the reader can use the strings in place */
+		obstack_grow(&env->out, str, len + 1);
+	}
+}
+
+void ir_write_canonical_irg(struct obstack *obst, ir_graph *irg)
+{
+	write_env_t my_env;
+	write_env_t *env = &my_env;
+
+	memset(env, 0, sizeof(*env));
+	env->binary      = true;
+	env->canonical   = true;
+	env->write_queue = new_pdeq();
+	env->strings     = NEW_ARR_F(ident*, 0);
+	env->string_nrs  = pmap_create();
+	env->symbol_nrs  = pmap_create();
+	obstack_init(&env->out);
+
+	writers_init();
+
+	write_entity_ref(env, get_irg_entity(irg));
+	ir_type *const frame = get_irg_frame_type(irg);
+	size_t   const n     = get_compound_n_members(frame);
+	write_size_t(env, n);
+	for (size_t i = 0; i < n; ++i)
+		write_entity_ref(env, get_compound_member(frame, i));
+	write_irg_body(env, irg);
+	/* the numbers of the strings are only meaningful with their table */
+	write_strings(env);
+
+	size_t const size = obstack_object_size(&env->out);
+	obstack_grow(obst, obstack_finish(&env->out), size);
+
+	obstack_free(&env->out, NULL);
+	pmap_destroy(env->symbol_nrs);
+	pmap_destroy(env->string_nrs);
+	DEL_ARR_F(env->strings);
+	del_pdeq(env->write_queue);
+}
+
+/* Exports the whole irp to the given file in the binary form. */
+void ir_export_binary_file(FILE *file)
+{
+	write_env_t my_env;
+	write_env_t *env = &my_env;
+
+	memset(env, 0, sizeof(*env));
+	env->binary       = true;
+	env->write_queue  = new_pdeq();
+	env->entity_queue = new_pdeq();
+	env->strings      = NEW_ARR_F(ident*, 0);
+	env->string_nrs   = pmap_create();
+	env->symbol_nrs   = pmap_create();
+	env->type_nrs     = pmap_create();
+	env->entity_nrs   = pmap_create();
+	obstack_init(&env->out);
+
+	writers_init();
+
+	/* the header is filled in at the end */
+	obstack_blank(&env->out, BINARY_HEADER_SIZE);
+	uint64_t offsets[bs_count];
+	uint64_t sizes[bs_count];
+#define WRITE_SECTION(section, write) do { \
+		offsets[section] = obstack_object_size(&env->out); \
+		write; \
+		sizes[section] = obstack_object_size(&env->out) - offsets[section]; \
+	} while (0)
+
+	WRITE_SECTION(bs_modes,     write_modes(env));
+	/* initializers of the type graph reference nodes of the constirg */
+	init_node_nrs(env, get_const_code_irg());
+	WRITE_SECTION(bs_typegraph, write_typegraph(env));
+	WRITE_SECTION(bs_constirg,  write_constirg(env));
+	free_node_nrs(env);
+	WRITE_SECTION(bs_program,   write_program(env));
+
+	/* the graph bodies are referenced by the graph directory */
+	size_t    n_irgs      = get_irp_n_irgs();
+	uint64_t *body_ranges = XMALLOCN(uint64_t, 2 * n_irgs);
+	foreach_irp_irg(i, irg) {
+		body_ranges[2 * i] = obstack_object_size(&env->out);
+		write_irg_body(env, irg);
+		body_ranges[2 * i + 1]
+			= obstack_object_size(&env->out) - body_ranges[2 * i];
+	}
+	offsets[bs_irgs] = obstack_object_size(&env->out);
+	write_size_t(env, n_irgs);
+	foreach_irp_irg(i, irg) {
+		write_entity_ref(env, get_irg_entity(irg));
+		write_type_ref(env, get_irg_frame_type(irg));
+		write_varint(env, body_ranges[2 * i]);
+		write_varint(env, body_ranges[2 * i + 1]);
+	}
+	sizes[bs_irgs] = obstack_object_size(&env->out) - offsets[bs_irgs];
+	free(body_ranges);
+
+	WRITE_SECTION(bs_strings, write_strings(env));
+#undef WRITE_SECTION
+
+	size_t         size = obstack_object_size(&env->out);
+	unsigned char *data = (unsigned char*)obstack_finish(&env->out);
+	memcpy(data, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+	put_u32(data + BINARY_MAGIC_SIZE,     BINARY_VERSION);
+	put_u32(data + BINARY_MAGIC_SIZE + 4, bs_count);
+	for (size_t s = 0; s < bs_count; ++s) {
+		unsigned char *entry = data + BINARY_MAGIC_SIZE + 8 + 16 * s;
+		put_u64(entry,     offsets[s]);
+		put_u64(entry + 8, sizes[s]);
+	}
+	fwrite(data, 1, size, file);
+
+	obstack_free(&env->out, NULL);
+	pmap_destroy(env->entity_nrs);
+	pmap_destroy(env->type_nrs);
+	pmap_destroy(env->symbol_nrs);
+	pmap_destroy(env->string_nrs);
+	DEL_ARR_F(env->strings);
+	del_pdeq(env->entity_queue);
+	del_pdeq(env->write_queue);
+}
+
 
 
 static void read_c(read_env_t *env)
@@ -1164,27 +1723,121 @@ static void skip_ws(read_env_t *env)
 
 static void skip_to(read_env_t *env, char to_ch)
 {
+	if (env->binary) {
+		/* no way to resynchronize, give up on the section */
+		env->pos = env->end;
+		return;
+	}
 	while (env->c != to_ch && env->c != EOF) {
 		read_c(env);
 	}
 }
 
-static bool expect_char(read_env_t *env, char ch)
+static uint64_t read_varint(read_env_t *env)
 {
-	skip_ws(env);
-	if (env->c != ch) {
-		parse_error(env, "Unexpected char '%c', expected '%c'\n",
-		            env->c, ch);
-		return false;
+	const unsigned char *pos = env->pos;
+	if (pos < env->end && *pos < 0x80) {
+		env->pos = pos + 1;
+		return *pos;
 	}
-	read_c(env);
-	return true;
-}
 
-#define EXPECT(c) if (expect_char(env, (c))) {} else return
+	uint64_t res = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7) {
+		if (pos == env->end) {
+			env->pos = pos;
+			parse_error(env, "Unexpected end of section\n");
+			return 0;
+		}
+		unsigned char const c = *pos++;
+		res |= (uint64_t)(c & 0x7F) << shift;
+		if ((c & 0x80) == 0) {
+			env->pos = pos;
+			return res;
+		}
+	}
+	env->pos = pos;
+	parse_error(env, "Number too large\n");
+	return 0;
+}
+
+static int64_t read_svarint(read_env_t *env)
+{
+	uint64_t const value = read_varint(env);
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/** Reads a string reference of the binary format, NULL stands for 0. */
+static binary_string_t *read_string_ref(read_env_t *env)
+{
+	uint64_t const nr = read_varint(env);
+	if (nr == 0)
+		return NULL;
+	if (nr > ARR_LEN(env->strings)) {
+		parse_error(env, "Invalid string number %lu\n", (unsigned long)nr);
+		return NULL;
+	}
+	return &env->strings[nr - 1];
+}
+
+static ident *get_string_ident(binary_string_t *string)
+{
+	if (string->id == NULL)
+		string->id = new_id_from_str(string->str);
+	return string->id;
+}
+
+/** Reads a string reference of the binary format which must not be NULL. */
+static binary_string_t *read_string_ref_nonnull(read_env_t *env)
+{
+	static binary_string_t empty = { "", NULL, NULL, 0, -1 };
+	binary_string_t *res = read_string_ref(env);
+	if (res == NULL) {
+		parse_error(env, "Expected string\n");
+		return &empty;
+	}
+	return res;
+}
+
+static bool expect_char(read_env_t *env, char ch)
+{
+	/* the binary format has no delimiters */
+	if (env->binary)
+		return true;
+
+	skip_ws(env);
+	if (env->c != ch) {
+		parse_error(env, "Unexpected char '%c', expected '%c'\n",
+		            env->c, ch);
+		return false;
+	}
+	read_c(env);
+	return true;
+}
+
+#define EXPECT(c) if (expect_char(env, (c))) {} else return
+
+/**
+ * Returns whether there are more entries in the current scope, or leaves the
+ * scope otherwise. In the binary format a scope ends with its section.
+ */
+static bool scope_has_next(read_env_t *env)
+{
+	if (env->binary)
+		return env->pos < env->end;
+
+	skip_ws(env);
+	if (env->c == '}' || env->c == EOF) {
+		read_c(env);
+		return false;
+	}
+	return true;
+}
 
 static char *read_word(read_env_t *env)
 {
+	if (env->binary)
+		return (char*)read_string_ref_nonnull(env)->str;
+
 	skip_ws(env);
 
 	assert(obstack_object_size(&env->obst) == 0);
@@ -1212,6 +1865,9 @@ endofword:
 
 static char *read_string(read_env_t *env)
 {
+	if (env->binary)
+		return (char*)read_string_ref_nonnull(env)->str;
+
 	skip_ws(env);
 	if (env->c != '"') {
 		parse_error(env, "Expected string, got '%c'\n", env->c);
@@ -1253,6 +1909,9 @@ static char *read_string(read_env_t *env)
 
 static ident *read_ident(read_env_t *env)
 {
+	if (env->binary)
+		return get_string_ident(read_string_ref_nonnull(env));
+
 	char  *str = read_string(env);
 	ident *res = new_id_from_str(str);
 	obstack_free(&env->obst, str);
@@ -1261,6 +1920,9 @@ static ident *read_ident(read_env_t *env)
 
 static ident *read_symbol(read_env_t *env)
 {
+	if (env->binary)
+		return get_string_ident(read_string_ref_nonnull(env));
+
 	char  *str = read_word(env);
 	ident *res = new_id_from_str(str);
 	obstack_free(&env->obst, str);
@@ -1272,6 +1934,11 @@ static ident *read_symbol(read_env_t *env)
  */
 static char *read_string_null(read_env_t *env)
 {
+	if (env->binary) {
+		binary_string_t *const string = read_string_ref(env);
+		return string != NULL ? (char*)string->str : NULL;
+	}
+
 	skip_ws(env);
 	if (env->c == 'N') {
 		char *str = read_word(env);
@@ -1289,6 +1956,11 @@ static char *read_string_null(read_env_t *env)
 
 static ident *read_ident_null(read_env_t *env)
 {
+	if (env->binary) {
+		binary_string_t *const string = read_string_ref(env);
+		return string != NULL ? get_string_ident(string) : NULL;
+	}
+
 	char *str = read_string_null(env);
 	if (str == NULL)
 		return NULL;
@@ -1300,6 +1972,9 @@ static ident *read_ident_null(read_env_t *env)
 
 static long read_long(read_env_t *env)
 {
+	if (env->binary)
+		return (long)read_svarint(env);
+
 	skip_ws(env);
 	if (!isdigit(env->c) && env->c != '-') {
 		parse_error(env, "Expected number, got '%c'\n", env->c);
@@ -1327,17 +2002,27 @@ static int read_int(read_env_t *env)
 
 static unsigned read_unsigned(read_env_t *env)
 {
+	if (env->binary)
+		return (unsigned)read_varint(env);
 	return (unsigned) read_long(env);
 }
 
 static size_t read_size_t(read_env_t *env)
 {
+	if (env->binary)
+		return (size_t)read_varint(env);
 	/* FIXME */
 	return (size_t) read_unsigned(env);
 }
 
 static void expect_list_begin(read_env_t *env)
 {
+	if (env->binary) {
+		/* lists do not nest, so a single counter suffices */
+		env->list_len = read_size_t(env);
+		return;
+	}
+
 	skip_ws(env);
 	if (env->c != '[') {
 		parse_error(env, "Expected list, got '%c'\n", env->c);
@@ -1348,6 +2033,18 @@ static void expect_list_begin(read_env_t *env)
 
 static bool list_has_next(read_env_t *env)
 {
+	if (env->binary) {
+		if (env->list_len == 0)
+			return false;
+		if (env->pos == env->end) {
+			parse_error(env, "Unexpected end of section while reading list\n");
+			env->list_len = 0;
+			return false;
+		}
+		--env->list_len;
+		return true;
+	}
+
 	if (feof(env->file)) {
 		parse_error(env, "Unexpected EOF while reading list");
 		exit(1);
@@ -1379,8 +2076,90 @@ static void set_id(read_env_t *env, long id, void *elem)
 	(void)set_insert(id_entry, env->idset, &key, sizeof(key), (unsigned) id);
 }
 
+/** Reads the number of a type at its definition. */
+static long read_type_nr(read_env_t *env)
+{
+	if (env->binary) {
+		/* types are numbered in the order of their definition */
+		ARR_APP1(ir_type*, env->types, NULL);
+		return ARR_LEN(env->types) - 1;
+	}
+	return read_long(env);
+}
+
+static void set_type_id(read_env_t *env, long typenr, ir_type *type)
+{
+	if (env->binary)
+		env->types[typenr] = type;
+	else
+		set_id(env, typenr, type);
+}
+
+/** Reads the number of an entity at its definition. */
+static long read_entity_nr(read_env_t *env)
+{
+	if (env->binary) {
+		ARR_APP1(ir_entity*, env->entities, NULL);
+		return ARR_LEN(env->entities) - 1;
+	}
+	return read_long(env);
+}
+
+static void set_entity_id(read_env_t *env, long entnr, ir_entity *entity)
+{
+	if (env->binary)
+		env->entities[entnr] = entity;
+	else
+		set_id(env, entnr, entity);
+}
+
+static long read_node_nr(read_env_t *env)
+{
+	if (env->binary) {
+		uint64_t const nr = read_varint(env);
+		size_t   const n  = ARR_LEN(env->nodes);
+		if (nr == n)
+			ARR_APP1(ir_node*, env->nodes, NULL);
+		else if (nr > n)
+			return -1;
+		return (long)nr;
+	}
+	return read_long(env);
+}
+
+static void set_node_id(read_env_t *env, long nodenr, ir_node *node)
+{
+	if (!env->binary) {
+		set_id(env, nodenr, node);
+	} else if (nodenr >= 0) {
+		env->nodes[nodenr] = node;
+	} else {
+		parse_error(env, "Invalid node index\n");
+	}
+}
+
+static void init_nodes(read_env_t *env)
+{
+	if (!env->binary)
+		return;
+	assert(env->nodes == NULL);
+	env->nodes = NEW_ARR_F(ir_node*, 0);
+}
+
+static void free_nodes(read_env_t *env)
+{
+	if (env->nodes == NULL)
+		return;
+	DEL_ARR_F(env->nodes);
+	env->nodes = NULL;
+}
+
 static ir_node *get_node_or_null(read_env_t *env, long nodenr)
 {
+	if (env->binary)
+		return nodenr >= 0 && (size_t)nodenr < ARR_LEN(env->nodes)
+		     ? env->nodes[nodenr] : NULL;
+
 	ir_node *node = (ir_node *) get_id(env, nodenr);
 	if (node && node->kind != k_ir_node) {
 		parse_error(env, "Irn ID %ld collides with something else\n",
@@ -1392,7 +2171,13 @@ static ir_node *get_node_or_null(read_env_t *env, long nodenr)
 
 static ir_type *get_type(read_env_t *env, long typenr)
 {
-	ir_type *type = (ir_type *) get_id(env, typenr);
+	ir_type *type;
+	if (env->binary) {
+		type = typenr >= 0 && (size_t)typenr < ARR_LEN(env->types)
+		     ? env->types[typenr] : NULL;
+	} else {
+		type = (ir_type *) get_id(env, typenr);
+	}
 	if (type == NULL) {
 		parse_error(env, "Type %ld not defined (yet?)\n", typenr);
 		return get_unknown_type();
@@ -1406,6 +2191,16 @@ static ir_type *get_type(read_env_t *env, long typenr)
 
 static ir_type *read_type_ref(read_env_t *env)
 {
+	if (env->binary) {
+		uint64_t const nr = read_varint(env);
+		switch (nr) {
+		case 0: return NULL;
+		case 1: return get_unknown_type();
+		case 2: return get_code_type();
+		}
+		return get_type(env, nr - 3 < ARR_LEN(env->types) ? (long)(nr - 3) : -1);
+	}
+
 	char *str = read_word(env);
 	if (streq(str, "unknown")) {
 		obstack_free(&env->obst, str);
@@ -1429,7 +2224,13 @@ static ir_entity *create_error_entity(void)
 
 static ir_entity *get_entity(read_env_t *env, long entnr)
 {
-	ir_entity *entity = (ir_entity *) get_id(env, entnr);
+	ir_entity *entity;
+	if (env->binary) {
+		entity = entnr >= 0 && (size_t)entnr < ARR_LEN(env->entities)
+		       ? env->entities[entnr] : NULL;
+	} else {
+		entity = (ir_entity *) get_id(env, entnr);
+	}
 	if (entity == NULL) {
 		parse_error(env, "unknown entity: %ld\n", entnr);
 		return create_error_entity();
@@ -1445,23 +2246,46 @@ static ir_entity *get_entity(read_env_t *env, long entnr)
 
 static ir_entity *read_entity_ref(read_env_t *env)
 {
+	if (env->binary) {
+		uint64_t const nr = read_varint(env);
+		return get_entity(env, nr < ARR_LEN(env->entities) ? (long)nr : -1);
+	}
 	long nr = read_long(env);
 	return get_entity(env, nr);
 }
 
-static ir_mode *read_mode_ref(read_env_t *env)
+static ir_mode *find_mode(const char *name)
 {
-	char *str = read_string(env);
 	for (size_t i = 0, n = ir_get_n_modes(); i < n; i++) {
 		ir_mode *mode = ir_get_mode(i);
-		if (streq(str, get_mode_name(mode))) {
-			obstack_free(&env->obst, str);
+		if (streq(name, get_mode_name(mode)))
 			return mode;
+	}
+	return NULL;
+}
+
+static ir_mode *read_mode_ref(read_env_t *env)
+{
+	if (env->binary) {
+		binary_string_t *const string = read_string_ref_nonnull(env);
+		if (string->mode == NULL) {
+			string->mode = find_mode(string->str);
+			if (string->mode == NULL) {
+				parse_error(env, "unknown mode \"%s\"\n", string->str);
+				return mode_ANY;
+			}
 		}
+		return string->mode;
 	}
 
-	parse_error(env, "unknown mode \"%s\"\n", str);
-	return mode_ANY;
+	char    *str  = read_string(env);
+	ir_mode *mode = find_mode(str);
+	if (mode == NULL) {
+		parse_error(env, "unknown mode \"%s\"\n", str);
+		return mode_ANY;
+	}
+	obstack_free(&env->obst, str);
+	return mode;
 }
 
 static const char *get_typetag_name(typetag_t typetag)
@@ -1491,6 +2315,23 @@ static const char *get_typetag_name(typetag_t typetag)
  */
 static unsigned read_enum(read_env_t *env, typetag_t typetag)
 {
+	if (env->binary) {
+		/* remember the code of the last lookup for each string */
+		binary_string_t *const string = read_string_ref_nonnull(env);
+		if (string->code_tag == (int)typetag)
+			return string->code;
+
+		unsigned const code = symbol(string->str, typetag);
+		if (code == SYMERROR) {
+			parse_error(env, "invalid %s: \"%s\"\n",
+			            get_typetag_name(typetag), string->str);
+			return 0;
+		}
+		string->code     = code;
+		string->code_tag = typetag;
+		return code;
+	}
+
 	char    *str  = read_word(env);
 	unsigned code = symbol(str, typetag);
 
@@ -1576,6 +2417,38 @@ static ir_relation read_relation(read_env_t *env)
 static ir_tarval *read_tarval_ref(read_env_t *env)
 {
 	ir_mode   *tvmode = read_mode_ref(env);
+	if (env->binary) {
+		unsigned char bytes[32];
+		unsigned      n_bytes = get_mode_size_bytes(tvmode);
+		switch (get_mode_arithmetic(tvmode)) {
+		case irma_twos_complement: {
+			unsigned const bits = get_mode_size_bits(tvmode);
+			n_bytes = bits / CHAR_BIT + (bits % CHAR_BIT != 0);
+			if (bits > 64)
+				break;
+			uint64_t value = (uint64_t)read_svarint(env);
+			for (unsigned i = 0; i < n_bytes; ++i) {
+				bytes[i] = (unsigned char)value;
+				value  >>= CHAR_BIT;
+			}
+			return new_tarval_from_bytes(bytes, tvmode);
+		}
+		case irma_ieee754:
+		case irma_x86_extended_float:
+			break;
+		case irma_none:
+			return ir_tarval_from_ascii(read_string(env), tvmode);
+		}
+		if (n_bytes > sizeof(bytes) || n_bytes > (size_t)(env->end - env->pos)) {
+			parse_error(env, "Invalid tarval\n");
+			env->pos = env->end;
+			return tarval_bad;
+		}
+		memcpy(bytes, env->pos, n_bytes);
+		env->pos += n_bytes;
+		return new_tarval_from_bytes(bytes, tvmode);
+	}
+
 	char      *str    = read_word(env);
 	ir_tarval *tv     = ir_tarval_from_ascii(str, tvmode);
 	obstack_free(&env->obst, str);
@@ -1603,7 +2476,7 @@ static ir_initializer_t *read_initializer(read_env_t *env)
 
 	switch (ini_kind) {
 	case IR_INITIALIZER_CONST: {
-		long nr = read_long(env);
+		long nr = read_node_nr(env);
 		ir_node *node = get_node_or_null(env, nr);
 		ir_initializer_t *initializer = create_initializer_const(node);
 		if (node == NULL) {
@@ -1638,24 +2511,29 @@ static ir_initializer_t *read_initializer(read_env_t *env)
 /** Reads a type description and remembers it by its id. */
 static void read_type(read_env_t *env)
 {
-	long           typenr = read_long(env);
+	long           typenr = read_type_nr(env);
 	tp_opcode      opcode = (tp_opcode) read_enum(env, tt_tpo);
-	unsigned       size   = (unsigned) read_long(env);
-	unsigned       align  = (unsigned) read_long(env);
+	unsigned       size   = read_unsigned(env);
+	unsigned       align  = read_unsigned(env);
 	ir_type_state  state  = read_type_state(env);
-	unsigned       flags  = (unsigned) read_long(env);
+	unsigned       flags  = read_unsigned(env);
 	ir_type       *type;
 
 	switch (opcode) {
 	case tpo_array: {
 		ir_type *elemtype = read_type_ref(env);
 		type = new_type_array(elemtype);
-		char *str = read_word(env);
-		if (!streq(str, "unknown")) {
-			long size = atol(str);
-			set_array_size_int(type, size);
+		if (env->binary) {
+			if (read_unsigned(env))
+				set_array_size_int(type, read_long(env));
+		} else {
+			char *str = read_word(env);
+			if (!streq(str, "unknown")) {
+				long size = atol(str);
+				set_array_size_int(type, size);
+			}
+			obstack_free(&env->obst, str);
 		}
-		obstack_free(&env->obst, str);
 		set_type_size_bytes(type, size);
 		goto finish_type;
 	}
@@ -1663,7 +2541,7 @@ static void read_type(read_env_t *env)
 	case tpo_class: {
 		ident *id = read_ident_null(env);
 
-		if (typenr == (long) IR_SEGMENT_GLOBAL)
+		if (flags & tf_global_type)
 			type = get_glob_type();
 		else
 			type = new_type_class(id);
@@ -1674,26 +2552,22 @@ static void read_type(read_env_t *env)
 	case tpo_method: {
 		unsigned                  callingconv = read_unsigned(env);
 		mtp_additional_properties addprops
-			= (mtp_additional_properties) read_long(env);
+			= (mtp_additional_properties) read_unsigned(env);
 		size_t nparams  = read_size_t(env);
 		size_t nresults = read_size_t(env);
 
 		type = new_type_method(nparams, nresults);
 
 		for (size_t i = 0; i < nparams; i++) {
-			long ptypenr = read_long(env);
-			ir_type *paramtype = get_type(env, ptypenr);
-
+			ir_type *paramtype = read_type_ref(env);
 			set_method_param_type(type, i, paramtype);
 		}
 		for (size_t i = 0; i < nresults; i++) {
-			long ptypenr = read_long(env);
-			ir_type *restype = get_type(env, ptypenr);
-
+			ir_type *restype = read_type_ref(env);
 			set_method_res_type(type, i, restype);
 		}
 
-		int const variadic = read_long(env);
+		int const variadic = read_unsigned(env);
 		set_method_variadic(type, variadic);
 
 		set_method_calling_convention(type, callingconv);
@@ -1702,7 +2576,7 @@ static void read_type(read_env_t *env)
 	}
 
 	case tpo_pointer: {
-		ir_type *pointsto = get_type(env, read_long(env));
+		ir_type *pointsto = read_type_ref(env);
 		type = new_type_pointer(pointsto);
 		goto finish_type;
 	}
@@ -1746,20 +2620,20 @@ finish_type:
 	if (state == layout_fixed)
 		ARR_APP1(ir_type *, env->fixedtypes, type);
 
-	set_id(env, typenr, type);
+	set_type_id(env, typenr, type);
 }
 
 static void read_unknown_entity(read_env_t *env)
 {
-	long       entnr  = read_long(env);
+	long       entnr  = read_entity_nr(env);
 	ir_entity *entity = get_unknown_entity();
-	set_id(env, entnr, entity);
+	set_entity_id(env, entnr, entity);
 }
 
 /** Reads an entity description and remembers it by its id. */
 static void read_entity(read_env_t *env, ir_entity_kind kind)
 {
-	long           entnr      = read_long(env);
+	long           entnr      = read_entity_nr(env);
 	ident         *name       = NULL;
 	ident         *ld_name    = NULL;
 	ir_visibility  visibility = ir_visibility_external;
@@ -1821,14 +2695,18 @@ static void read_entity(read_env_t *env, ir_entity_kind kind)
 			entity, (mtp_additional_properties) read_long(env));
 		break;
 	case IR_ENTITY_PARAMETER: {
-		char  *str = read_word(env);
 		size_t parameter_number;
-		if (streq(str, "va_start")) {
-			parameter_number = IR_VA_START_PARAMETER_NUMBER;
+		if (env->binary) {
+			parameter_number = read_size_t(env);
 		} else {
-			parameter_number = atol(str);
+			char *str = read_word(env);
+			if (streq(str, "va_start")) {
+				parameter_number = IR_VA_START_PARAMETER_NUMBER;
+			} else {
+				parameter_number = atol(str);
+			}
+			obstack_free(&env->obst, str);
 		}
-		obstack_free(&env->obst, str);
 		entity = new_parameter_entity(owner, parameter_number, type);
 		set_entity_offset(entity, read_int(env));
 		set_entity_bitfield_offset(entity, read_unsigned(env));
@@ -1848,7 +2726,7 @@ static void read_entity(read_env_t *env, ir_entity_kind kind)
 	set_entity_visibility(entity, visibility);
 	set_entity_linkage(entity, linkage);
 
-	set_id(env, entnr, entity);
+	set_entity_id(env, entnr, entity);
 }
 
 /** Parses the whole type graph. */
@@ -1861,15 +2739,8 @@ static void read_typegraph(read_env_t *env)
 	env->irg = get_const_code_irg();
 
 	/* parse all types first */
-	while (true) {
-		keyword_t kwkind;
-		skip_ws(env);
-		if (env->c == '}') {
-			read_c(env);
-			break;
-		}
-
-		kwkind = read_keyword(env);
+	while (scope_has_next(env)) {
+		keyword_t kwkind = read_keyword(env);
 		switch (kwkind) {
 		case kw_type:
 			read_type(env);
@@ -1914,7 +2785,7 @@ static void read_typegraph(read_env_t *env)
  */
 static ir_node *read_node_ref(read_env_t *env)
 {
-	long     nr   = read_long(env);
+	long     nr   = read_node_nr(env);
 	ir_node *node = get_node_or_null(env, nr);
 	if (node == NULL) {
 		parse_error(env, "node %ld not defined (yet?)\n", nr);
@@ -1941,7 +2812,7 @@ static void read_preds_delayed(read_env_t *env, ir_node *node)
 	obstack_blank(&env->preds_obst, sizeof(delayed_pred_t));
 	int n_preds = 0;
 	while (list_has_next(env)) {
-		long pred_nr = read_long(env);
+		long pred_nr = read_node_nr(env);
 		obstack_grow(&env->preds_obst, &pred_nr, sizeof(pred_nr));
 		++n_preds;
 	}
@@ -2054,7 +2925,7 @@ static ir_node *read_node(read_env_t *env)
 {
 	ident          *id   = read_symbol(env);
 	read_node_func *func = pmap_get(read_node_func, node_readers, id);
-	long            nr   = read_long(env);
+	long            nr   = read_node_nr(env);
 	ir_node        *res;
 	if (func == NULL) {
 		parse_error(env, "Unknown nodetype '%s'", get_id_str(id));
@@ -2063,13 +2934,16 @@ static ir_node *read_node(read_env_t *env)
 	} else {
 		res = func(env);
 	}
-	set_id(env, nr, res);
+	set_node_id(env, nr, res);
 	return res;
 }
 
+/** Initializes the node readers. May be called more than once without
+ * problems. */
 static void readers_init(void)
 {
-	assert(node_readers == NULL);
+	if (node_readers != NULL)
+		return;
 	node_readers = pmap_create();
 	register_node_reader("Anchor", read_Anchor);
 	register_node_reader("ASM",    read_ASM);
@@ -2085,13 +2959,7 @@ static void read_graph(read_env_t *env, ir_graph *irg)
 	env->delayed_preds = NEW_ARR_F(const delayed_pred_t*, 0);
 
 	EXPECT('{');
-	while (true) {
-		skip_ws(env);
-		if (env->c == '}' || env->c == EOF) {
-			read_c(env);
-			break;
-		}
-
+	while (scope_has_next(env)) {
 		read_node(env);
 	}
 
@@ -2121,46 +2989,46 @@ next_delayed_pred: ;
 	env->delayed_preds = NULL;
 }
 
-static ir_graph *read_irg(read_env_t *env)
+static ir_graph *read_irg_body(read_env_t *env, ir_entity *irgent,
+                               ir_type *frame)
 {
-	ir_entity *irgent = get_entity(env, read_long(env));
-	ir_graph  *irg    = new_ir_graph(irgent, 0);
-	ir_type   *frame  = read_type_ref(env);
+	ir_graph *irg = new_ir_graph(irgent, 0);
 	set_irg_frame_type(irg, frame);
+	init_nodes(env);
 	read_graph(env, irg);
+	free_nodes(env);
 	irg_finalize_cons(irg);
 	return irg;
 }
 
+static ir_graph *read_irg(read_env_t *env)
+{
+	ir_entity *irgent = read_entity_ref(env);
+	ir_type   *frame  = read_type_ref(env);
+	return read_irg_body(env, irgent, frame);
+}
+
 static void read_modes(read_env_t *env)
 {
 	EXPECT('{');
 
-	while (true) {
-		keyword_t kwkind;
-
-		skip_ws(env);
-		if (env->c == '}' || env->c == EOF) {
-			read_c(env);
-			break;
-		}
-
-		kwkind = read_keyword(env);
+	while (scope_has_next(env)) {
+		keyword_t kwkind = read_keyword(env);
 		switch (kwkind) {
 		case kw_int_mode: {
 			const char *name = read_string(env);
 			ir_mode_arithmetic arith = read_mode_arithmetic(env);
-			int size = read_long(env);
-			int sign = read_long(env);
-			unsigned modulo_shift = read_long(env);
+			int size = read_unsigned(env);
+			int sign = read_int(env);
+			unsigned modulo_shift = read_unsigned(env);
 			new_int_mode(name, arith, size, sign, modulo_shift);
 			break;
 		}
 		case kw_reference_mode: {
 			const char *name = read_string(env);
 			ir_mode_arithmetic arith = read_mode_arithmetic(env);
-			int size = read_long(env);
-			unsigned modulo_shift = read_long(env);
+			int size = read_unsigned(env);
+			unsigned modulo_shift = read_unsigned(env);
 			ir_mode *mode = new_reference_mode(name, arith, size, modulo_shift);
 			set_reference_offset_mode(mode, read_mode_ref(env));
 			int is_mode_P = read_int(env);
@@ -2171,10 +3039,10 @@ static void read_modes(read_env_t *env)
 		case kw_float_mode: {
 			const char *name = read_string(env);
 			ir_mode_arithmetic arith = read_mode_arithmetic(env);
-			int exponent_size = read_long(env);
-			int mantissa_size = read_long(env);
+			int exponent_size = read_unsigned(env);
+			int mantissa_size = read_unsigned(env);
 			float_int_conversion_overflow_style_t overflow =
-				(float_int_conversion_overflow_style_t)read_long(env);
+				(float_int_conversion_overflow_style_t)read_unsigned(env);
 			new_float_mode(name, arith, exponent_size, mantissa_size,
 			               overflow);
 			break;
@@ -2191,15 +3059,12 @@ static void read_program(read_env_t *env)
 {
 	EXPECT('{');
 
-	while (true) {
-		skip_ws(env);
-		if (env->c == '}') {
-			read_c(env);
-			break;
-		}
-
+	while (scope_has_next(env)) {
 		keyword_t kwkind = read_keyword(env);
 		switch (kwkind) {
+		case kw_name:
+			set_irp_prog_name(read_ident(env));
+			break;
 		case kw_segment_type: {
 			ir_segment_t  segment = (ir_segment_t) read_enum(env, tt_segment);
 			ir_type      *type    = read_type_ref(env);
@@ -2218,6 +3083,58 @@ static void read_program(read_env_t *env)
 	}
 }
 
+static void read_constirg(read_env_t *env)
+{
+	ir_graph *constirg = get_const_code_irg();
+	long bodyblockid = read_node_nr(env);
+	set_node_id(env, bodyblockid, constirg->current_block);
+	read_graph(env, constirg);
+}
+
+static void resolve_delayed_initializers(read_env_t *env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->delayed_initializers); i < n; ++i) {
+		const delayed_initializer_t *di   = &env->delayed_initializers[i];
+		ir_node                     *node = get_node_or_null(env, di->node_nr);
+		if (node == NULL) {
+			parse_error(env, "node %ld mentioned in an initializer was never defined\n",
+			            di->node_nr);
+			continue;
+		}
+		assert(di->initializer->kind == IR_INITIALIZER_CONST);
+		di->initializer->consti.value = node;
+	}
+	ARR_SHRINKLEN(env->delayed_initializers, 0);
+}
+
+static void fix_type_layouts(read_env_t *env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->fixedtypes); i < n; i++)
+		set_type_state(env->fixedtypes[i], layout_fixed);
+	ARR_SHRINKLEN(env->fixedtypes, 0);
+}
+
+static void init_read_env(read_env_t *env, const char *inputname)
+{
+	readers_init();
+	symtbl_init();
+
+	memset(env, 0, sizeof(*env));
+	obstack_init(&env->obst);
+	obstack_init(&env->preds_obst);
+	env->fixedtypes = NEW_ARR_F(ir_type *, 0);
+	env->inputname  = inputname;
+	env->delayed_initializers = NEW_ARR_F(delayed_initializer_t, 0);
+}
+
+static void free_read_env(read_env_t *env)
+{
+	DEL_ARR_F(env->delayed_initializers);
+	DEL_ARR_F(env->fixedtypes);
+	obstack_free(&env->preds_obst, NULL);
+	obstack_free(&env->obst, NULL);
+}
+
 int ir_import(const char *filename)
 {
 	FILE *file = fopen(filename, "rt");
@@ -2237,18 +3154,10 @@ int ir_import_file(FILE *input, const char *inputname)
 	int                 oldoptimize = get_optimize();
 	read_env_t         *env         = &myenv;
 
-	readers_init();
-	symtbl_init();
-
-	memset(env, 0, sizeof(*env));
-	obstack_init(&env->obst);
-	obstack_init(&env->preds_obst);
+	init_read_env(env, inputname);
 	env->idset      = new_set(id_cmp, 128);
-	env->fixedtypes = NEW_ARR_F(ir_type *, 0);
-	env->inputname  = inputname;
 	env->file       = input;
 	env->line       = 1;
-	env->delayed_initializers = NEW_ARR_F(delayed_initializer_t, 0);
 
 	/* read first character */
 	read_c(env);
@@ -2280,13 +3189,9 @@ int ir_import_file(FILE *input, const char *inputname)
 			read_irg(env);
 			break;
 
-		case kw_constirg: {
-			ir_graph *constirg = get_const_code_irg();
-			long bodyblockid = read_long(env);
-			set_id(env, bodyblockid, constirg->current_block);
-			read_graph(env, constirg);
+		case kw_constirg:
+			read_constirg(env);
 			break;
-		}
 
 		case kw_program:
 			read_program(env);
@@ -2299,37 +3204,312 @@ int ir_import_file(FILE *input, const char *inputname)
 		}
 	}
 
-	for (size_t i = 0, n = ARR_LEN(env->fixedtypes); i < n; i++)
-		set_type_state(env->fixedtypes[i], layout_fixed);
+	fix_type_layouts(env);
+	resolve_delayed_initializers(env);
 
-	DEL_ARR_F(env->fixedtypes);
+	del_set(env->idset);
 
-	/* resolve delayed initializers */
-	for (size_t i = 0, n = ARR_LEN(env->delayed_initializers); i < n; ++i) {
-		const delayed_initializer_t *di   = &env->delayed_initializers[i];
-		ir_node                     *node = get_node_or_null(env, di->node_nr);
-		if (node == NULL) {
-			parse_error(env, "node %ld mentioned in an initializer was never defined\n",
-			            di->node_nr);
-			continue;
+	set_optimize(oldoptimize);
+
+	free_read_env(env);
+
+	return env->read_errors;
+}
+
+/** A graph of a binary file. */
+typedef struct binary_irg_t {
+	ir_entity *entity;
+	ir_type   *frame;
+	size_t     offset;  /**< file offset of the graph body */
+	size_t     size;    /**< size of the graph body */
+	ir_graph  *irg;     /**< the graph once its body was read */
+} binary_irg_t;
+
+struct ir_binary_file_t {
+	read_env_t     env;
+	char          *name;
+	unsigned char *data;
+	size_t         size;
+	bool           mapped;  /**< data is mapped instead of allocated */
+	size_t         offsets[bs_count];
+	size_t         sizes[bs_count];
+	binary_irg_t  *irgs;
+	size_t         n_irgs;
+};
+
+static uint32_t get_u32(const unsigned char *buf)
+{
+	uint32_t res = 0;
+	for (unsigned i = 4; i-- > 0;)
+		res = res << 8 | buf[i];
+	return res;
+}
+
+static uint64_t get_u64(const unsigned char *buf)
+{
+	return get_u32(buf) | (uint64_t)get_u32(buf + 4) << 32;
+}
+
+static bool load_file(ir_binary_file_t *file)
+{
+#ifdef HAVE_MMAP
+	int const fd = open(file->name, O_RDONLY);
+	if (fd < 0) {
+		perror(file->name);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		perror(file->name);
+		close(fd);
+		return false;
+	}
+	file->size = st.st_size;
+	if (file->size > 0) {
+		void *const data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd,
+		                        0);
+		if (data == MAP_FAILED) {
+			perror(file->name);
+			close(fd);
+			return false;
 		}
-		assert(di->initializer->kind == IR_INITIALIZER_CONST);
-		di->initializer->consti.value = node;
+		file->data   = (unsigned char*)data;
+		file->mapped = true;
 	}
-	DEL_ARR_F(env->delayed_initializers);
-	env->delayed_initializers = NULL;
+	close(fd);
+	return true;
+#else
+	FILE *const f = fopen(file->name, "rb");
+	if (f == NULL) {
+		perror(file->name);
+		return false;
+	}
+	size_t capacity = 64 * 1024;
+	file->data = XMALLOCN(unsigned char, capacity);
+	for (;;) {
+		file->size += fread(file->data + file->size, 1,
+		                    capacity - file->size, f);
+		if (file->size < capacity)
+			break;
+		capacity  *= 2;
+		file->data = XREALLOC(file->data, unsigned char, capacity);
+	}
+	bool const ok = !ferror(f);
+	if (!ok)
+		perror(file->name);
+	fclose(f);
+	return ok;
+#endif
+}
 
-	del_set(env->idset);
+static void unload_file(ir_binary_file_t *file)
+{
+#ifdef HAVE_MMAP
+	if (file->mapped) {
+		munmap(file->data, file->size);
+		return;
+	}
+#endif
+	free(file->data);
+}
+
+static bool read_header(ir_binary_file_t *file)
+{
+	const unsigned char *data = file->data;
+	if (file->size < BINARY_HEADER_SIZE
+	    || memcmp(data, BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0) {
+		fprintf(stderr, "%s: error: not a binary firm file\n", file->name);
+		return false;
+	}
+	uint32_t const version = get_u32(data + BINARY_MAGIC_SIZE);
+	if (version != BINARY_VERSION) {
+		fprintf(stderr, "%s: error: unsupported format version %u\n",
+		        file->name, (unsigned)version);
+		return false;
+	}
+	if (get_u32(data + BINARY_MAGIC_SIZE + 4) != bs_count)
+		goto corrupt;
+	for (size_t s = 0; s < bs_count; ++s) {
+		const unsigned char *entry  = data + BINARY_MAGIC_SIZE + 8 + 16 * s;
+		uint64_t const       offset = get_u64(entry);
+		uint64_t const       size   = get_u64(entry + 8);
+		if (offset > file->size || size > file->size - offset)
+			goto corrupt;
+		file->offsets[s] = offset;
+		file->sizes[s]   = size;
+	}
+	return true;
+
+corrupt:
+	fprintf(stderr, "%s: error: corrupt header\n", file->name);
+	return false;
+}
+
+static void enter_range(read_env_t *env, size_t offset, size_t size)
+{
+	env->pos = env->data + offset;
+	env->end = env->pos + size;
+}
+
+/** Enters a section and checks the keyword at its start. */
+static bool enter_section(ir_binary_file_t *file, binary_section_t section,
+                          keyword_t keyword)
+{
+	read_env_t *const env = &file->env;
+	enter_range(env, file->offsets[section], file->sizes[section]);
+	if (read_keyword(env) != keyword) {
+		parse_error(env, "Section %d starts with the wrong keyword\n",
+		            (int)section);
+		return false;
+	}
+	return true;
+}
+
+static void read_strings(ir_binary_file_t *file)
+{
+	read_env_t *const env = &file->env;
+	enter_range(env, file->offsets[bs_strings], file->sizes[bs_strings]);
+	size_t const n = read_size_t(env);
+	/* each string needs at least two bytes */
+	size_t const max = (env->end - env->pos) / 2;
+	env->strings = NEW_ARR_F(binary_string_t, MIN(n, max));
+	for (size_t i = 0; i < ARR_LEN(env->strings); ++i) {
+		size_t const len = read_size_t(env);
+		if (len >= (size_t)(env->end - env->pos) || env->pos[len] != '\0') {
+			parse_error(env, "Invalid string table entry\n");
+			ARR_SHRINKLEN(env->strings, i);
+			return;
+		}
+		binary_string_t *const string = &env->strings[i];
+		string->str      = (const char*)env->pos;
+		string->id       = NULL;
+		string->mode     = NULL;
+		string->code_tag = -1;
+		env->pos += len + 1;
+	}
+	if (n > max)
+		parse_error(env, "Invalid string table size\n");
+}
+
+static void read_irg_directory(ir_binary_file_t *file)
+{
+	read_env_t *const env = &file->env;
+	enter_range(env, file->offsets[bs_irgs], file->sizes[bs_irgs]);
+	size_t const n = read_size_t(env);
+	/* each entry needs at least four bytes */
+	file->n_irgs = MIN(n, (size_t)(env->end - env->pos) / 4);
+	file->irgs   = XMALLOCNZ(binary_irg_t, file->n_irgs);
+	for (size_t i = 0; i < file->n_irgs; ++i) {
+		binary_irg_t *const entry = &file->irgs[i];
+		entry->entity = read_entity_ref(env);
+		entry->frame  = read_type_ref(env);
+		entry->offset = read_size_t(env);
+		entry->size   = read_size_t(env);
+		if (entry->offset > file->size
+		    || entry->size > file->size - entry->offset) {
+			parse_error(env, "Invalid graph body\n");
+			entry->offset = 0;
+			entry->size   = 0;
+		}
+	}
+	if (file->n_irgs != n)
+		parse_error(env, "Invalid number of graphs\n");
+}
+
+ir_binary_file_t *ir_binary_open(const char *filename)
+{
+	ir_binary_file_t *const file = XMALLOCZ(ir_binary_file_t);
+	file->name = xstrdup(filename);
+	if (!load_file(file)) {
+		free(file->name);
+		free(file);
+		return NULL;
+	}
+	if (!read_header(file)) {
+		unload_file(file);
+		free(file->name);
+		free(file);
+		return NULL;
+	}
+
+	read_env_t *const env = &file->env;
+	init_read_env(env, file->name);
+	env->binary   = true;
+	env->data     = file->data;
+	env->types    = NEW_ARR_F(ir_type*, 0);
+	env->entities = NEW_ARR_F(ir_entity*, 0);
+	read_strings(file);
+
+	int const oldoptimize = get_optimize();
+	set_optimize(0);
+
+	if (enter_section(file, bs_modes, kw_modes))
+		read_modes(env);
+	init_nodes(env);
+	if (enter_section(file, bs_typegraph, kw_typegraph))
+		read_typegraph(env);
+	if (enter_section(file, bs_constirg, kw_constirg))
+		read_constirg(env);
+	resolve_delayed_initializers(env);
+	free_nodes(env);
+	if (enter_section(file, bs_program, kw_program))
+		read_program(env);
+	fix_type_layouts(env);
+	read_irg_directory(file);
 
 	set_optimize(oldoptimize);
+	return file;
+}
 
-	obstack_free(&env->preds_obst, NULL);
-	obstack_free(&env->obst, NULL);
+size_t ir_binary_get_n_irgs(const ir_binary_file_t *file)
+{
+	return file->n_irgs;
+}
 
-	pmap_destroy(node_readers);
-	node_readers = NULL;
+ir_entity *ir_binary_get_irg_entity(const ir_binary_file_t *file, size_t pos)
+{
+	assert(pos < file->n_irgs);
+	return file->irgs[pos].entity;
+}
 
-	return env->read_errors;
+ir_graph *ir_binary_load_irg(ir_binary_file_t *file, size_t pos)
+{
+	assert(pos < file->n_irgs);
+	binary_irg_t *const entry = &file->irgs[pos];
+	if (entry->irg == NULL) {
+		read_env_t *const env         = &file->env;
+		int const         oldoptimize = get_optimize();
+		set_optimize(0);
+		enter_range(env, entry->offset, entry->size);
+		entry->irg = read_irg_body(env, entry->entity, entry->frame);
+		set_optimize(oldoptimize);
+	}
+	return entry->irg;
+}
+
+int ir_binary_close(ir_binary_file_t *file)
+{
+	read_env_t *const env = &file->env;
+	int const         res = env->read_errors;
+	free(file->irgs);
+	DEL_ARR_F(env->entities);
+	DEL_ARR_F(env->types);
+	DEL_ARR_F(env->strings);
+	free_read_env(env);
+	unload_file(file);
+	free(file->name);
+	free(file);
+	return res;
+}
+
+int ir_import_binary(const char *filename)
+{
+	ir_binary_file_t *const file = ir_binary_open(filename);
+	if (file == NULL)
+		return 1;
+	for (size_t i = 0, n = ir_binary_get_n_irgs(file); i < n; ++i)
+		ir_binary_load_irg(file, i);
+	return ir_binary_close(file);
 }
 
 #include "gen_irio.c.inl"
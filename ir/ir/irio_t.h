@@ -0,0 +1,26 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Input/Output of firm -- private header.
+ */
+#ifndef FIRM_IR_IRIO_T_H
+#define FIRM_IR_IRIO_T_H
+
+#include "irio.h"
+
+#include "obst.h"
+
+/**
+ * Appends a canonical form of @p irg to @p obst. The canonical form does not
+ * depend on node numbers or the order of node creation: nodes are numbered
+ * in the order of the walk used for exporting, entities are described by
+ * their names and types by their layout. So two graphs with the same
+ * canonical form get the same code from the backend.
+ */
+void ir_write_canonical_irg(struct obstack *obst, ir_graph *irg);
+
+#endif
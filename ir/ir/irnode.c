@@ -105,10 +105,10 @@ ir_node *new_ir_node(dbg_info *db, ir_graph *irg, ir_node *block, ir_op *op,
 	res->node_nr = get_irp_new_node_nr();
 
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i) {
-		INIT_LIST_HEAD(&res->edge_info[i].outs_head);
+		INIT_LIST_HEAD(&res->edge_info.outs_head[i]);
 		/* Edges will be built immediately. */
-		res->edge_info[i].edges_built = 1;
-		res->edge_info[i].out_count = 0;
+		res->edge_info.info[i].edges_built = 1;
+		res->edge_info.info[i].out_count   = 0;
 	}
 
 	/* don't put this into the for loop, arity is -1 for some nodes! */
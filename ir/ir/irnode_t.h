@@ -97,6 +97,7 @@ typedef struct block_attr {
 	bitset_t   *backedge;       /**< Bit n set to true if pred n is backedge.*/
 	ir_entity  *entity;         /**< entity representing this block */
 	ir_node    *phis;           /**< The list of Phi nodes in this block. */
+	ir_loop    *loop;           /**< The innermost loop of this block. */
 	double      execfreq;       /**< block execution frequency */
 } block_attr;
 
@@ -267,12 +268,18 @@ typedef union ir_attr {
  * Edge info to put into an irn.
  */
 typedef struct irn_edge_kind_info_t {
-	struct list_head outs_head;  /**< The list of all outs. */
 	unsigned edges_built : 1;    /**< Set edges where built for this node. */
 	unsigned out_count   : 31;   /**< Number of outs in the list. */
 } irn_edge_info_t;
 
-typedef irn_edge_info_t irn_edges_info_t[EDGE_KIND_LAST+1];
+/**
+ * Edge infos of all kinds. The list heads are kept apart from the counters,
+ * so they need no padding.
+ */
+typedef struct irn_edges_info_t {
+	struct list_head outs_head[EDGE_KIND_LAST+1]; /**< The lists of all outs. */
+	irn_edge_info_t  info[EDGE_KIND_LAST+1];
+} irn_edges_info_t;
 
 /**
  * A Def-Use edge.
@@ -303,13 +310,6 @@ struct ir_node {
 	                                to nodes that shall replace a node. */
 	dbg_info        *dbi;      /**< Information for debug support. */
 	long             node_nr;  /**< Globally unique node number. */
-
-	union {
-		ir_def_use_edges *out;    /**< array of def-use edges. */
-		unsigned          n_outs; /**< number of def-use edges (temporarily used
-		                               during construction of data structure) */
-	} o;
-	ir_loop         *loop;         /**< Loop information. */
 	void            *backend_info;
 	irn_edges_info_t edge_info;    /**< Everlasting out edges. */
 
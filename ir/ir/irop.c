@@ -467,6 +467,7 @@ static void block_copy_attr(ir_graph *irg, const ir_node *old_node,
 	new_node->attr.block.phis          = NULL;
 	new_node->attr.block.backedge      = new_backedge_arr(get_irg_obstack(irg), get_irn_arity(new_node));
 	new_node->attr.block.block_visited = 0;
+	new_node->attr.block.loop          = NULL;
 	memset(&new_node->attr.block.dom, 0, sizeof(new_node->attr.block.dom));
 	memset(&new_node->attr.block.pdom, 0, sizeof(new_node->attr.block.pdom));
 	/* It should be safe to copy the entity here, as it has no back-link to the
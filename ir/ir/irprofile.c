@@ -8,9 +8,30 @@
  * @brief       Code instrumentation and execution count profiling.
  * @author      Adam M. Szalkowski, Steven Schaefer
  * @date        06.04.2006, 11.11.2010
+ *
+ * The profile counts control flow edges. The end block is merged with the
+ * start block, so the edges of a function form a circulation and the counts
+ * of a spanning tree of edges follow from the counts of all other edges
+ * (Knuth, Ball and Larus). Only the edges outside of a maximum spanning tree
+ * are instrumented, with edges inside loops preferred for the tree.
+ *
+ * Counters are 64 bit. They are stored per function together with a
+ * checksum of the control flow graph and the edge selection, so a changed
+ * function is detected instead of getting the counts of another one.
+ *
+ * The profile also describes the edges and the calls of each function, so
+ * the entry and call counts of the functions can be read by their names
+ * before the graphs are optimized, when the block counts do not fit them.
+ * A call is told apart from the other calls of its caller by its callee and
+ * its source position, which survive the optimizations.
  */
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
 
 #include "util.h"
+#include "be.h"
+#include "dbginfo_t.h"
 #include "debug.h"
 #include "execfreq_t.h"
 #include "hashptr.h"
@@ -18,29 +39,135 @@
 #include "ircons_t.h"
 #include "irdump_t.h"
 #include "irgwalk.h"
+#include "irloop.h"
 #include "irnode_t.h"
 #include "irprofile.h"
 #include "irprog_t.h"
 #include "obst.h"
+#include "panic.h"
 #include "set.h"
 #include "typerep.h"
 #include "xmalloc.h"
 
-/* Instrument blocks walker. */
-typedef struct block_id_walker_data_t {
-	unsigned int  id;       /**< current block id number */
-	ir_node      *counters; /**< the node representing the counter array */
-} block_id_walker_data_t;
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-/* Associate counters with blocks. */
-typedef struct block_assoc_t {
-	unsigned int i;          /**< current block id number */
-	unsigned int *counters;  /**< block execution counts */
-} block_assoc_t;
+/*
+ * The instrumented code describes its counters in a constant, the layout,
+ * all numbers are little endian:
+ *   u32 version (LAYOUT_VERSION)
+ *   u32 number of functions
+ *   for every function:
+ *     u32 length of the name, name without '\0'
+ *     u64 checksum of the control flow graph
+ *     u32 number of counters
+ *     u32 size of the call sites, call sites
+ * The call sites of a function are:
+ *   u32 number of blocks, u32 index of the start block
+ *   u32 number of edges, per edge: u32 source block, u32 target block,
+ *     u32 counter number, EDGE_IN_TREE or EDGE_NOT_TAKEN
+ *   u32 number of calls, per call: u32 block, u32 source line, u32 source
+ *     column, u32 length of the callee name, callee name without '\0'
+ * At exit, libfirmprof turns the layout and the counters into a profile file
+ * with an index of the functions, see support/libfirmprof/firmprof.h:
+ *   "firmprof", u32 version (PROFILE_VERSION), u32 number of functions,
+ *   u32 number of buckets, u32 size of the names, u64 number of counters
+ *   40 byte records: u64 name hash, u64 checksum, u64 first counter,
+ *                    u32 name offset, u32 number of counters,
+ *                    u32 call sites offset, u32 size of the call sites
+ *   u32 buckets: record number + 1, 0 if empty, probed linearly
+ *   names, each terminated by '\0' and followed by the call sites, padded
+ *   to 8 bytes
+ *   u64 counters
+ */
+#define LAYOUT_VERSION  4
+#define PROFILE_MAGIC   "firmprof"
+#define PROFILE_VERSION 5
+#define HEADER_SIZE     32
+#define RECORD_SIZE     40
+#define EDGE_IN_TREE    UINT32_MAX
+#define EDGE_NOT_TAKEN  (UINT32_MAX - 1)
 
 /* minimal execution frequency (an execfreq of 0 confuses algos) */
 #define MIN_EXECFREQ 0.00001
 
+typedef enum edge_place_t {
+	PLACE_SRC,   /**< counter in the source block, it has one successor */
+	PLACE_DST,   /**< counter in the target block, it has one predecessor */
+	PLACE_SPLIT, /**< counter in a new block on the edge */
+	PLACE_NONE,  /**< edge cannot be instrumented */
+} edge_place_t;
+
+/** A control flow edge. */
+typedef struct cfg_edge_t {
+	unsigned     src;     /**< index of the source block */
+	unsigned     dst;     /**< index of the target, the end block counts as
+	                           the start block */
+	ir_node     *block;   /**< target block, NULL for the fake exit edge of a
+	                           block without successors */
+	int          pos;     /**< predecessor position in the target block */
+	unsigned     weight;  /**< loop depth of the edge */
+	edge_place_t place;
+	bool         in_tree; /**< edge is in the spanning tree */
+	int          counter; /**< counter number, -1 if not instrumented */
+} cfg_edge_t;
+
+/** A call of a known function. */
+typedef struct call_site_t {
+	unsigned         block;  /**< index of the block of the call */
+	unsigned         line;   /**< source line, 0 if unknown */
+	unsigned         column; /**< source column, 0 if unknown */
+	ir_entity const *callee;
+} call_site_t;
+
+/** Per block data, kept in the block link. */
+typedef struct block_info_t {
+	unsigned  index;    /**< index in the walk order */
+	unsigned  n_succs;  /**< number of control flow successors */
+	ir_node  *first;    /**< first node of the counter code */
+	ir_node  *last_mem; /**< memory after the counter code */
+	ir_node  *mem;      /**< counter memory at the block entry */
+} block_info_t;
+
+/** The control flow graph of a function as seen by the profile. */
+typedef struct profile_cfg_t {
+	struct obstack  obst;
+	ir_node       **blocks;     /**< blocks in walk order */
+	cfg_edge_t     *edges;      /**< edges in a fixed order */
+	call_site_t    *calls;      /**< calls in walk order */
+	unsigned        n_counters;
+	uint64_t        checksum;
+} profile_cfg_t;
+
+/** A function of a read profile. */
+typedef struct profile_function_t {
+	uint64_t             checksum;
+	unsigned             n_counters;
+	unsigned char const *counts;     /**< the little endian counters */
+} profile_function_t;
+
+/** Instrumentation state of a compilation unit. */
+typedef struct instrument_env_t {
+	ir_entity      *counters;   /**< the counter array */
+	ir_entity      *atomic_inc; /**< runtime function for atomic increments */
+	ir_type        *counter_type;
+	ir_type        *word_type;
+	bool            atomic;
+	unsigned        n_counters;
+	unsigned        n_functions;
+	struct obstack  layout;
+} instrument_env_t;
+
+/* Associates execution counts with blocks. */
+typedef struct execcount_t {
+	long     block; /**< block node number */
+	uint64_t count; /**< execution count */
+} execcount_t;
+
 /* keep the execcounts here because they are only read once per compiler run */
 static set *profile = NULL;
 
@@ -50,16 +177,6 @@ static hook_entry_t *hook;
 /* The debug module handle. */
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
-/**
- * Since the backend creates a new firm graph we cannot associate counts with
- * blocks directly. Instead we associate them with the block ids, which are
- * maintained.
- */
-typedef struct execcount_t {
-	unsigned long block; /**< block id */
-	uint32_t      count; /**< execution count */
-} execcount_t;
-
 /**
  * Compare two execcount_t entries.
  */
@@ -71,8 +188,11 @@ static int cmp_execcount(const void *a, const void *b, size_t size)
 	return ea->block != eb->block;
 }
 
-uint32_t ir_profile_get_block_execcount(const ir_node *block)
+uint64_t ir_profile_get_block_execcount(const ir_node *block)
 {
+	if (profile == NULL)
+		return 0;
+
 	execcount_t  const query = { .block = get_irn_node_nr(block), .count = 0 };
 	execcount_t *const ec    = set_find(execcount_t, profile, &query, sizeof(query), query.block);
 
@@ -84,46 +204,245 @@ uint32_t ir_profile_get_block_execcount(const ir_node *block)
 	}
 }
 
-/**
- * Block walker, count number of blocks.
- */
-static void block_counter(ir_node *bb, void *data)
+/* vcg helper */
+static void dump_profile_node_info(void *ctx, FILE *f, const ir_node *irn)
 {
-	unsigned *const count = (unsigned*)data;
-	(void)bb;
-	++*count;
+	(void)ctx;
+	if (is_Block(irn)) {
+		uint64_t execcount = ir_profile_get_block_execcount(irn);
+		fprintf(f, "profiled execution count: %llu\n",
+		        (unsigned long long)execcount);
+	}
+}
+
+static bool is_profiled_irg(ir_graph const *irg)
+{
+	return !(get_entity_linkage(get_irg_entity(irg)) & IR_LINKAGE_NO_CODEGEN);
+}
+
+static block_info_t *get_block_info(ir_node const *block)
+{
+	return (block_info_t*)get_irn_link(block);
+}
+
+static void collect_block(ir_node *block, void *data)
+{
+	profile_cfg_t *const cfg  = (profile_cfg_t*)data;
+	block_info_t  *const info = OALLOCZ(&cfg->obst, block_info_t);
+	info->index = ARR_LEN(cfg->blocks);
+	set_irn_link(block, info);
+	ARR_APP1(ir_node*, cfg->blocks, block);
+}
+
+static unsigned get_block_weight(ir_node const *block)
+{
+	ir_loop const *const loop = get_irn_loop(block);
+	return loop != NULL ? get_loop_depth(loop) : 0;
+}
+
+static void add_edge(profile_cfg_t *cfg, unsigned src, unsigned dst,
+                     ir_node *block, int pos, unsigned weight)
+{
+	cfg_edge_t const edge = {
+		.src     = src,
+		.dst     = dst,
+		.block   = block,
+		.pos     = pos,
+		.weight  = weight,
+		.counter = -1,
+	};
+	ARR_APP1(cfg_edge_t, cfg->edges, edge);
+}
+
+static edge_place_t get_edge_place(ir_graph *irg, cfg_edge_t const *edge,
+                                   ir_node *const *blocks)
+{
+	if (edge->block == NULL)
+		return PLACE_SRC;
+	unsigned const n_succs = get_block_info(blocks[edge->src])->n_succs;
+	if (edge->block == get_irg_end_block(irg))
+		return n_succs == 1 ? PLACE_SRC : PLACE_NONE;
+	if (get_Block_n_cfgpreds(edge->block) == 1)
+		return PLACE_DST;
+	if (n_succs == 1)
+		return PLACE_SRC;
+	/* we can't add blocks in between ijmp and its destinations */
+	if (is_unknown_jump(get_Block_cfgpred(edge->block, edge->pos)))
+		return PLACE_NONE;
+	return PLACE_SPLIT;
+}
+
+static unsigned find_root(unsigned *parent, unsigned x)
+{
+	while (parent[x] != x) {
+		parent[x] = parent[parent[x]];
+		x         = parent[x];
+	}
+	return x;
 }
 
 /**
- * Returns the number of blocks the given graph.
+ * Orders the edges for the spanning tree: edges without a place for a
+ * counter first, then edges in deeper loops, then in the original order.
  */
-static unsigned int get_irg_n_blocks(ir_graph *irg)
+static int cmp_tree_order(void const *a, void const *b)
+{
+	cfg_edge_t const *const e1 = *(cfg_edge_t const *const*)a;
+	cfg_edge_t const *const e2 = *(cfg_edge_t const *const*)b;
+	bool const none1 = e1->place == PLACE_NONE;
+	bool const none2 = e2->place == PLACE_NONE;
+	if (none1 != none2)
+		return none1 ? -1 : 1;
+	if (e1->weight != e2->weight)
+		return e1->weight > e2->weight ? -1 : 1;
+	return (e1 > e2) - (e1 < e2);
+}
+
+static void choose_spanning_tree(profile_cfg_t *cfg)
+{
+	size_t      const n_blocks = ARR_LEN(cfg->blocks);
+	size_t      const n_edges  = ARR_LEN(cfg->edges);
+	unsigned   *const parent   = XMALLOCN(unsigned, n_blocks);
+	cfg_edge_t **const order   = XMALLOCN(cfg_edge_t*, n_edges);
+	for (size_t i = 0; i < n_blocks; ++i)
+		parent[i] = i;
+	for (size_t i = 0; i < n_edges; ++i)
+		order[i] = &cfg->edges[i];
+	QSORT(order, n_edges, cmp_tree_order);
+
+	for (size_t i = 0; i < n_edges; ++i) {
+		cfg_edge_t    *const edge = order[i];
+		unsigned const src  = find_root(parent, edge->src);
+		unsigned const dst  = find_root(parent, edge->dst);
+		if (src != dst) {
+			parent[src]   = dst;
+			edge->in_tree = true;
+		}
+	}
+	free(order);
+	free(parent);
+
+	for (size_t i = 0; i < n_edges; ++i) {
+		cfg_edge_t *const edge = &cfg->edges[i];
+		if (!edge->in_tree && edge->place != PLACE_NONE)
+			edge->counter = cfg->n_counters++;
+	}
+}
+
+static uint64_t hash_u32(uint64_t hash, uint32_t value)
 {
-	unsigned int count = 0;
-	irg_block_walk_graph(irg, block_counter, NULL, &count);
-	return count;
+	for (unsigned i = 0; i < 4; ++i) {
+		hash  ^= (value >> (i * 8)) & 0xFF;
+		hash  *= UINT64_C(0x100000001B3);
+	}
+	return hash;
+}
+
+static uint64_t compute_checksum(profile_cfg_t const *cfg)
+{
+	uint64_t hash = UINT64_C(0xCBF29CE484222325);
+	hash = hash_u32(hash, ARR_LEN(cfg->blocks));
+	for (size_t i = 0, n = ARR_LEN(cfg->edges); i < n; ++i) {
+		cfg_edge_t const *const edge = &cfg->edges[i];
+		hash = hash_u32(hash, edge->src);
+		hash = hash_u32(hash, edge->dst);
+		hash = hash_u32(hash, edge->pos);
+		hash = hash_u32(hash, edge->counter);
+	}
+	for (size_t i = 0, n = ARR_LEN(cfg->calls); i < n; ++i) {
+		call_site_t const *const call = &cfg->calls[i];
+		char        const *const name = get_entity_ld_name(call->callee);
+		hash = hash_u32(hash, call->block);
+		hash = hash_u32(hash, call->line);
+		hash = hash_u32(hash, call->column);
+		for (char const *c = name; *c != '\0'; ++c)
+			hash = hash_u32(hash, (unsigned char)*c);
+	}
+	return hash;
+}
+
+static void collect_call(ir_node *node, void *data)
+{
+	if (!is_Call(node))
+		return;
+	ir_entity const *const callee = get_Call_callee(node);
+	ir_node         *const block  = get_nodes_block(node);
+	/* the start block is collected even if it is not reached by the walk */
+	if (callee == NULL || (!Block_block_visited(block)
+	                       && block != get_irg_start_block(get_irn_irg(node))))
+		return;
+	profile_cfg_t *const cfg  = (profile_cfg_t*)data;
+	src_loc_t      const loc  = ir_retrieve_dbg_info(get_irn_dbg_info(node));
+	call_site_t    const call = {
+		.block  = get_block_info(block)->index,
+		.line   = loc.line,
+		.column = loc.column,
+		.callee = callee,
+	};
+	ARR_APP1(call_site_t, cfg->calls, call);
 }
 
 /**
- * Returns the number of basic blocks in the current ir program.
+ * Collects the blocks and edges of @p irg and selects the edges to
+ * instrument. The block links point to block_info_t until free_cfg().
  */
-static unsigned int get_irp_n_blocks(void)
+static void build_cfg(ir_graph *irg, profile_cfg_t *cfg)
 {
-	unsigned int count = 0;
-	foreach_irp_irg(i, irg) {
-		count += get_irg_n_blocks(irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+
+	obstack_init(&cfg->obst);
+	cfg->blocks     = NEW_ARR_F(ir_node*, 0);
+	cfg->edges      = NEW_ARR_F(cfg_edge_t, 0);
+	cfg->calls      = NEW_ARR_F(call_site_t, 0);
+	cfg->n_counters = 0;
+
+	ir_node *const start_block = get_irg_start_block(irg);
+	ir_node *const end_block   = get_irg_end_block(irg);
+	irg_block_walk_graph(irg, collect_block, NULL, cfg);
+	/* the start block is missing if the function never returns */
+	if (!Block_block_visited(start_block))
+		collect_block(start_block, cfg);
+
+	unsigned const root = get_block_info(start_block)->index;
+	for (size_t i = 0, n = ARR_LEN(cfg->blocks); i < n; ++i) {
+		ir_node  *const block  = cfg->blocks[i];
+		unsigned  const weight = get_block_weight(block);
+		unsigned  const dst    = block == end_block ? root : i;
+		for (int p = 0, n_preds = get_Block_n_cfgpreds(block); p < n_preds; ++p) {
+			ir_node *const pred = get_Block_cfgpred_block(block, p);
+			if (pred == NULL)
+				continue;
+			block_info_t *const src = get_block_info(pred);
+			++src->n_succs;
+			add_edge(cfg, src->index, dst, block, p,
+			         MIN(weight, get_block_weight(pred)));
+		}
 	}
-	return count;
+	/* Blocks without successors end in a call that does not return, give
+	 * them an edge to the end, so their flow is balanced. */
+	for (size_t i = 0, n = ARR_LEN(cfg->blocks); i < n; ++i) {
+		ir_node *const block = cfg->blocks[i];
+		if (block != end_block && get_block_info(block)->n_succs == 0)
+			add_edge(cfg, i, root, NULL, -1, get_block_weight(block));
+	}
+
+	for (size_t i = 0, n = ARR_LEN(cfg->edges); i < n; ++i) {
+		cfg_edge_t *const edge = &cfg->edges[i];
+		edge->place = get_edge_place(irg, edge, cfg->blocks);
+	}
+	choose_spanning_tree(cfg);
+	irg_walk_graph(irg, NULL, collect_call, cfg);
+	cfg->checksum = compute_checksum(cfg);
 }
 
-/* vcg helper */
-static void dump_profile_node_info(void *ctx, FILE *f, const ir_node *irn)
+static void free_cfg(ir_graph *irg, profile_cfg_t *cfg)
 {
-	(void)ctx;
-	if (is_Block(irn)) {
-		unsigned int execcount = ir_profile_get_block_execcount(irn);
-		fprintf(f, "profiled execution count: %u\n", execcount);
-	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	DEL_ARR_F(cfg->calls);
+	DEL_ARR_F(cfg->edges);
+	DEL_ARR_F(cfg->blocks);
+	obstack_free(&cfg->obst, NULL);
 }
 
 /**
@@ -148,19 +467,24 @@ static void add_constructor(ir_entity *method)
 /**
  * Returns an entity representing the __init_firmprof function from libfirmprof
  * This is the equivalent of:
- * extern void __init_firmprof(char *filename, uint *counters, uint size)
+ * extern void __init_firmprof(char const *filename,
+ *                             unsigned char const *layout, uint layout_size,
+ *                             uint64_t *counters, uint n_counters)
  */
 static ir_entity *get_init_firmprof_ref(void)
 {
 	ident   *const init_name = new_id_from_str("__init_firmprof");
-	ir_type *const init_type = new_type_method(3, 0);
+	ir_type *const init_type = new_type_method(5, 0);
 	ir_type *const uint      = new_type_primitive(mode_Iu);
-	ir_type *const uintptr   = new_type_pointer(uint);
+	ir_type *const u64ptr    = new_type_pointer(new_type_primitive(mode_Lu));
 	ir_type *const string    = new_type_pointer(new_type_primitive(mode_Bs));
+	ir_type *const bytes     = new_type_pointer(new_type_primitive(mode_Bu));
 
 	set_method_param_type(init_type, 0, string);
-	set_method_param_type(init_type, 1, uintptr);
+	set_method_param_type(init_type, 1, bytes);
 	set_method_param_type(init_type, 2, uint);
+	set_method_param_type(init_type, 3, u64ptr);
+	set_method_param_type(init_type, 4, uint);
 
 	ir_entity *const result = new_entity(get_glob_type(), init_name, init_type);
 	set_entity_visibility(result, ir_visibility_external);
@@ -168,16 +492,37 @@ static ir_entity *get_init_firmprof_ref(void)
 	return result;
 }
 
+/**
+ * Returns an entity representing the __firmprof_atomic_inc function from
+ * libfirmprof: extern void __firmprof_atomic_inc(uint64_t *counter)
+ */
+static ir_entity *get_atomic_inc_ref(void)
+{
+	ident   *const name   = new_id_from_str("__firmprof_atomic_inc");
+	ir_type *const type   = new_type_method(1, 0);
+	ir_type *const u64ptr = new_type_pointer(new_type_primitive(mode_Lu));
+	set_method_param_type(type, 0, u64ptr);
+
+	ir_entity *const result = new_entity(get_glob_type(), name, type);
+	set_entity_visibility(result, ir_visibility_external);
+	return result;
+}
+
 /**
  * Generates a new irg which calls the initializer
  *
  * Pseudocode:
  *    static void __firmprof_initializer(void) __attribute__ ((constructor))
  *    {
- *        __init_firmprof(ent_filename, bblock_counts, n_blocks);
+ *        __init_firmprof(ent_filename, layout, layout_size, counters,
+ *                        n_counters);
  *    }
  */
-static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_counts, int n_blocks)
+static ir_graph *gen_initializer_irg(ir_entity *ent_filename,
+                                     ir_entity *ent_layout,
+                                     unsigned layout_size,
+                                     ir_entity *ent_counters,
+                                     unsigned n_counters)
 {
 	ident     *const name = new_id_from_str("__firmprof_initializer");
 	ir_entity *const ent  = new_entity(get_glob_type(), name, new_type_method(0, 0));
@@ -194,9 +539,11 @@ static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_
 	ir_entity *const init_ent  = get_init_firmprof_ref();
 	ir_node   *const callee    = new_r_Address(irg, init_ent);
 	ir_node   *const filename  = new_r_Address(irg, ent_filename);
-	ir_node   *const counters  = new_r_Address(irg, bblock_counts);
-	ir_node   *const size      = new_r_Const_long(irg, mode_Iu, n_blocks);
-	ir_node   *const ins[]     = { filename, counters, size };
+	ir_node   *const layout    = new_r_Address(irg, ent_layout);
+	ir_node   *const lsize     = new_r_Const_long(irg, mode_Iu, layout_size);
+	ir_node   *const counters  = new_r_Address(irg, ent_counters);
+	ir_node   *const size      = new_r_Const_long(irg, mode_Iu, n_counters);
+	ir_node   *const ins[]     = { filename, layout, lsize, counters, size };
 	ir_type   *const call_type = get_entity_type(init_ent);
 	ir_node   *const call      = new_r_Call(bb, init_mem, callee, ARRAY_SIZE(ins), ins, call_type);
 	ir_node   *const call_mem  = new_r_Proj(call, mode_M, pn_Call_M);
@@ -209,108 +556,293 @@ static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_
 	return irg;
 }
 
+static ir_node *new_counter_address(ir_node *block, ir_node *counters,
+                                    unsigned offset)
+{
+	ir_graph *const irg  = get_irn_irg(block);
+	ir_mode  *const mode = get_reference_offset_mode(mode_P);
+	ir_node  *const cnst = new_r_Const_long(irg, mode, offset);
+	return new_r_Add(block, counters, cnst, mode_P);
+}
+
 /**
- * Instrument a block with code needed for profiling.
- * This just inserts the instruction nodes, it doesn't connect the memory
- * nodes in a meaningful way.
+ * Appends the increment of counter @p nr to the counter code of @p block.
+ * The counter code forms its own memory chain, the memory at the begin of
+ * the chain is set by fix_memory().
  */
-static void instrument_block(ir_node *const bb, ir_node *const address, unsigned int const id)
+static void add_counter_code(instrument_env_t *env, ir_node *block,
+                             ir_node *counters, unsigned nr)
 {
-	ir_graph *const irg = get_irn_irg(bb);
-
-	/* We can't instrument the end block */
-	if (bb == get_irg_end_block(irg))
-		return;
+	ir_graph     *const irg  = get_irn_irg(block);
+	block_info_t *const info = get_block_info(block);
+	ir_node      *const mem  = info->last_mem != NULL ? info->last_mem
+	                                                  : new_r_NoMem(irg);
+	unsigned      const offset = nr * 8;
+	ir_node *first;
+	ir_node *last_mem;
+	if (env->atomic) {
+		ir_node *const addr   = new_counter_address(block, counters, offset);
+		ir_node *const callee = new_r_Address(irg, env->atomic_inc);
+		ir_type *const type   = get_entity_type(env->atomic_inc);
+		first    = new_r_Call(block, mem, callee, 1, &addr, type);
+		last_mem = new_r_Proj(first, mode_M, pn_Call_M);
+	} else if (be_get_machine_size() >= 64) {
+		ir_type *const type  = env->counter_type;
+		ir_node *const addr  = new_counter_address(block, counters, offset);
+		ir_node *const load  = new_r_Load(block, mem, addr, mode_Lu, type, cons_none);
+		ir_node *const lmem  = new_r_Proj(load, mode_M, pn_Load_M);
+		ir_node *const value = new_r_Proj(load, mode_Lu, pn_Load_res);
+		ir_node *const one   = new_r_Const_one(irg, mode_Lu);
+		ir_node *const add   = new_r_Add(block, value, one, mode_Lu);
+		ir_node *const store = new_r_Store(block, lmem, addr, add, type, cons_none);
+		first    = load;
+		last_mem = new_r_Proj(store, mode_M, pn_Store_M);
+	} else {
+		/* Increment the low word and add the carry to the high word. The
+		 * carry is set iff the new low word is 0, which is the sign bit of
+		 * ~lo & (lo - 1). */
+		bool     const big_endian = be_is_big_endian();
+		ir_type *const type   = env->word_type;
+		ir_node *const lo_adr = new_counter_address(block, counters, offset + (big_endian ? 4 : 0));
+		ir_node *const hi_adr = new_counter_address(block, counters, offset + (big_endian ? 0 : 4));
+		ir_node *const one    = new_r_Const_one(irg, mode_Iu);
+		ir_node *const lo_ld  = new_r_Load(block, mem, lo_adr, mode_Iu, type, cons_none);
+		ir_node *const lo_mem = new_r_Proj(lo_ld, mode_M, pn_Load_M);
+		ir_node *const lo     = new_r_Proj(lo_ld, mode_Iu, pn_Load_res);
+		ir_node *const lo1    = new_r_Add(block, lo, one, mode_Iu);
+		ir_node *const lo_st  = new_r_Store(block, lo_mem, lo_adr, lo1, type, cons_none);
+		ir_node *const st_mem = new_r_Proj(lo_st, mode_M, pn_Store_M);
+		ir_node *const notlo  = new_r_Not(block, lo1, mode_Iu);
+		ir_node *const lo1m1  = new_r_Sub(block, lo1, one, mode_Iu);
+		ir_node *const zeros  = new_r_And(block, notlo, lo1m1, mode_Iu);
+		ir_node *const c31    = new_r_Const_long(irg, mode_Iu, 31);
+		ir_node *const carry  = new_r_Shr(block, zeros, c31, mode_Iu);
+		ir_node *const hi_ld  = new_r_Load(block, st_mem, hi_adr, mode_Iu, type, cons_none);
+		ir_node *const hi_mem = new_r_Proj(hi_ld, mode_M, pn_Load_M);
+		ir_node *const hi     = new_r_Proj(hi_ld, mode_Iu, pn_Load_res);
+		ir_node *const hi1    = new_r_Add(block, hi, carry, mode_Iu);
+		ir_node *const hi_st  = new_r_Store(block, hi_mem, hi_adr, hi1, type, cons_none);
+		first    = lo_ld;
+		last_mem = new_r_Proj(hi_st, mode_M, pn_Store_M);
+	}
+	if (info->last_mem == NULL)
+		info->first = first;
+	info->last_mem = last_mem;
+}
 
-	ir_type *const type_Iu = get_entity_type(get_irn_entity_attr(address));
-	ir_node *const unknown = new_r_Unknown(irg, mode_M);
-	ir_node *const cnst    = new_r_Const_long(irg, mode_Iu, get_mode_size_bytes(mode_Iu) * id);
-	ir_node *const offset  = new_r_Add(bb, address, cnst, mode_P);
-	ir_node *const load    = new_r_Load(bb, unknown, offset, mode_Iu, type_Iu, cons_none);
-	ir_node *const lmem    = new_r_Proj(load, mode_M, pn_Load_M);
-	ir_node *const proji   = new_r_Proj(load, mode_Iu, pn_Load_res);
-	ir_node *const one     = new_r_Const_one(irg, mode_Iu);
-	ir_node *const add     = new_r_Add(bb, proji, one, mode_Iu);
-	ir_node *const store   = new_r_Store(bb, lmem, offset, add, type_Iu, cons_none);
-	ir_node *const smem    = new_r_Proj(store, mode_M, pn_Store_M);
+/**
+ * Places a new block on the control flow edge @p edge and returns it.
+ */
+static ir_node *split_edge(profile_cfg_t *cfg, cfg_edge_t const *edge)
+{
+	ir_graph *const irg   = get_irn_irg(edge->block);
+	ir_node  *const pred  = get_Block_cfgpred(edge->block, edge->pos);
+	ir_node  *const block = new_r_Block(irg, 1, &pred);
+	ir_node  *const jmp   = new_r_Jmp(block);
+	set_Block_cfgpred(edge->block, edge->pos, jmp);
+	collect_block(block, cfg);
+	return block;
+}
 
-	set_irn_link(bb, smem);
-	set_irn_link(smem, load);
+static ir_node *get_block_exit_mem(ir_node const *block)
+{
+	block_info_t const *const info = get_block_info(block);
+	return info->last_mem != NULL ? info->last_mem : info->mem;
 }
 
 /**
- * SSA Construction for instrumentation code memory.
+ * SSA construction for the counter memory.
  *
- * This introduces a new memory node and connects it to the instrumentation
- * codes, inserting phiM nodes as necessary. Note that afterwards, the new
- * memory is not connected to any return nodes and thus still dead.
+ * The counter code of all blocks forms a memory chain of its own, starting
+ * at the initial memory. Joins get a memory Phi, blocks without counters
+ * pass the memory on. Note that afterwards, the new memory is not connected
+ * to any return nodes and thus still dead.
  */
-static void fix_ssa(ir_node *const bb, void *const data)
+static void fix_memory(ir_graph *irg, profile_cfg_t *cfg)
 {
-	(void)data;
-
-	ir_graph *const irg = get_irn_irg(bb);
+	ir_node *const start_block = get_irg_start_block(irg);
+	ir_node *const end_block   = get_irg_end_block(irg);
+	ir_node *const no_mem      = new_r_NoMem(irg);
+	size_t   const n_blocks    = ARR_LEN(cfg->blocks);
+
+	/* Phis are created before their operands exist, don't let them be
+	 * optimized away meanwhile. */
+	int const rem_opt = get_optimize();
+	set_optimize(0);
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node      *const block = cfg->blocks[i];
+		block_info_t *const info  = get_block_info(block);
+		int           const arity = get_Block_n_cfgpreds(block);
+		if (block == start_block) {
+			info->mem = get_irg_initial_mem(irg);
+		} else if (arity > 1 && block != end_block) {
+			ir_node **const ins = ALLOCAN(ir_node*, arity);
+			for (int p = 0; p < arity; ++p)
+				ins[p] = no_mem;
+			info->mem = new_r_Phi(block, arity, ins, mode_M);
+			/* the counters of endless loops do not reach a return */
+			add_End_keepalive(get_irg_end(irg), info->mem);
+		}
+	}
+	set_optimize(rem_opt);
+
+	/* Blocks with a single predecessor take the memory of the first block
+	 * up the chain which has counters or a known entry memory. */
+	ir_node **path = NEW_ARR_F(ir_node*, 0);
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node *const block = cfg->blocks[i];
+		if (block == end_block || get_block_info(block)->mem != NULL)
+			continue;
 
-	/* end blocks are not instrumented, skip! */
-	if (bb == get_irg_end_block(irg))
-		return;
+		ir_node *mem;
+		for (ir_node *cur = block;;) {
+			block_info_t const *const cur_info = get_block_info(cur);
+			if (cur_info->mem != NULL) {
+				mem = cur_info->mem;
+				break;
+			}
+			/* unreachable blocks may have no predecessor or form a cycle */
+			ARR_APP1(ir_node*, path, cur);
+			ir_node *const pred = get_Block_n_cfgpreds(cur) > 0
+				? get_Block_cfgpred_block(cur, 0) : NULL;
+			if (pred == NULL || ARR_LEN(path) > n_blocks) {
+				mem = no_mem;
+				break;
+			}
+			block_info_t const *const pred_info = get_block_info(pred);
+			if (pred_info->last_mem != NULL) {
+				mem = pred_info->last_mem;
+				break;
+			}
+			cur = pred;
+		}
+		for (size_t p = 0, n = ARR_LEN(path); p < n; ++p)
+			get_block_info(path[p])->mem = mem;
+		ARR_SHRINKLEN(path, 0);
+	}
+	DEL_ARR_F(path);
 
-	ir_node  *mem;
-	int const arity = get_Block_n_cfgpreds(bb);
-	if (bb == get_irg_start_block(irg)) {
-		mem = get_irg_initial_mem(irg);
-	} else if (arity == 1) {
-		ir_node *const pred = get_Block_cfgpred_block(bb, 0);
-		mem = pred ? (ir_node*)get_irn_link(pred) : new_r_NoMem(irg);
-	} else {
-		ir_node **ins = ALLOCAN(ir_node*, arity);
-		for (int n = arity; n-- != 0;) {
-			ir_node *const pred = get_Block_cfgpred_block(bb, n);
-			ins[n] = pred ? (ir_node*)get_irn_link(pred) : new_r_NoMem(irg);
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node      *const block = cfg->blocks[i];
+		block_info_t *const info  = get_block_info(block);
+		if (block == end_block)
+			continue;
+		if (is_Phi(info->mem) && get_nodes_block(info->mem) == block) {
+			for (int p = 0, n = get_Block_n_cfgpreds(block); p < n; ++p) {
+				ir_node *const pred = get_Block_cfgpred_block(block, p);
+				set_Phi_pred(info->mem, p,
+				             pred != NULL ? get_block_exit_mem(pred) : no_mem);
+			}
 		}
-		mem = new_r_Phi(bb, arity, ins, mode_M);
+		if (info->first == NULL)
+			continue;
+		if (is_Call(info->first))
+			set_Call_mem(info->first, info->mem);
+		else
+			set_Load_mem(info->first, info->mem);
 	}
+}
 
-	/* The block link fields point to the projm from the instrumentation code,
-	 * the projm in turn links to the initial load which lacks a memory
-	 * argument at this point. */
-	ir_node *const proj = (ir_node*)get_irn_link(bb);
-	ir_node *const load = (ir_node*)get_irn_link(proj);
-	set_Load_mem(load, mem);
+/**
+ * Synchronize the original memory input of node with the additional operand
+ * from the profiling code.
+ */
+static ir_node *sync_mem(ir_node *bb, ir_node *mem)
+{
+	ir_node *const ins[] = { get_block_exit_mem(bb), mem };
+	return new_r_Sync(bb, ARRAY_SIZE(ins), ins);
 }
 
 /**
- * Instrument a single block.
+ * Appends a little endian number to the layout.
  */
-static void block_instrument_walker(ir_node *bb, void *data)
+static void add_layout_u32(struct obstack *obst, uint32_t value)
+{
+	for (unsigned i = 0; i < 4; ++i)
+		obstack_1grow(obst, (char)(value >> (i * 8)));
+}
+
+static void add_layout_u64(struct obstack *obst, uint64_t value)
 {
-	block_id_walker_data_t *wd = (block_id_walker_data_t*)data;
-	instrument_block(bb, wd->counters, wd->id);
-	++wd->id;
+	add_layout_u32(obst, (uint32_t)value);
+	add_layout_u32(obst, (uint32_t)(value >> 32));
 }
 
 /**
- * Synchronize the original memory input of node with the additional operand
- * from the profiling code.
+ * Appends the size and the description of the edges and calls of @p irg to
+ * the layout.
  */
-static ir_node *sync_mem(ir_node *bb, ir_node *mem)
+static void add_layout_call_sites(struct obstack *obst, ir_graph *irg,
+                                  profile_cfg_t const *cfg)
 {
-	ir_node *const ins[] = { (ir_node*)get_irn_link(bb), mem };
-	return new_r_Sync(bb, ARRAY_SIZE(ins), ins);
+	size_t const n_edges = ARR_LEN(cfg->edges);
+	size_t const n_calls = ARR_LEN(cfg->calls);
+	size_t       size    = 16 + 12 * n_edges + 16 * n_calls;
+	for (size_t i = 0; i < n_calls; ++i)
+		size += strlen(get_entity_ld_name(cfg->calls[i].callee));
+	add_layout_u32(obst, size);
+
+	add_layout_u32(obst, ARR_LEN(cfg->blocks));
+	add_layout_u32(obst, get_block_info(get_irg_start_block(irg))->index);
+	add_layout_u32(obst, n_edges);
+	for (size_t i = 0; i < n_edges; ++i) {
+		cfg_edge_t const *const edge = &cfg->edges[i];
+		add_layout_u32(obst, edge->src);
+		add_layout_u32(obst, edge->dst);
+		add_layout_u32(obst, edge->counter >= 0 ? (uint32_t)edge->counter
+		                     : edge->in_tree    ? EDGE_IN_TREE
+		                                        : EDGE_NOT_TAKEN);
+	}
+	add_layout_u32(obst, n_calls);
+	for (size_t i = 0; i < n_calls; ++i) {
+		char const *const name = get_entity_ld_name(cfg->calls[i].callee);
+		size_t      const len  = strlen(name);
+		add_layout_u32(obst, cfg->calls[i].block);
+		add_layout_u32(obst, cfg->calls[i].line);
+		add_layout_u32(obst, cfg->calls[i].column);
+		add_layout_u32(obst, len);
+		obstack_grow(obst, name, len);
+	}
 }
 
 /**
- * Instrument a single ir_graph, counters should point to the bblock
- * counters array.
+ * Instrument a single ir_graph.
  */
-static void instrument_irg(ir_graph *irg, ir_entity *counters, block_id_walker_data_t *wd)
+static void instrument_irg(ir_graph *irg, instrument_env_t *env)
 {
-	/* generate a node pointing to the count array */
-	wd->counters = new_r_Address(irg, counters);
+	profile_cfg_t cfg;
+	build_cfg(irg, &cfg);
+
+	char const *const name = get_entity_ld_name(get_irg_entity(irg));
+	size_t      const len  = strlen(name);
+	add_layout_u32(&env->layout, len);
+	obstack_grow(&env->layout, name, len);
+	add_layout_u64(&env->layout, cfg.checksum);
+	add_layout_u32(&env->layout, cfg.n_counters);
+	add_layout_call_sites(&env->layout, irg, &cfg);
+	++env->n_functions;
+
+	unsigned const base     = env->n_counters;
+	ir_node *const counters = new_r_Address(irg, env->counters);
+	bool           split    = false;
+	env->n_counters += cfg.n_counters;
+	for (size_t i = 0, n = ARR_LEN(cfg.edges); i < n; ++i) {
+		cfg_edge_t const *const edge = &cfg.edges[i];
+		if (edge->counter < 0)
+			continue;
+		ir_node *block;
+		switch (edge->place) {
+		case PLACE_SRC:   block = cfg.blocks[edge->src]; break;
+		case PLACE_DST:   block = edge->block;           break;
+		case PLACE_SPLIT: block = split_edge(&cfg, edge); split = true; break;
+		default:          panic("edge without counter place");
+		}
+		add_counter_code(env, block, counters, base + edge->counter);
+	}
+	DB((dbg, LEVEL_2, "%+F: %zu edges, %u counters\n", irg,
+	    ARR_LEN(cfg.edges), cfg.n_counters));
 
-	/* instrument each block in the current irg */
-	irg_block_walk_graph(irg, block_instrument_walker, NULL, wd);
-	irg_block_walk_graph(irg, fix_ssa, NULL, NULL);
+	fix_memory(irg, &cfg);
 
 	/* connect the new memory nodes to the return nodes */
 	ir_node *const endbb = get_irg_end_block(irg);
@@ -349,42 +881,29 @@ static void instrument_irg(ir_graph *irg, ir_entity *counters, block_id_walker_d
 			set_Call_mem(node, sync_mem(bb, mem));
 		}
 	}
-}
-
-/**
- * Creates a new entity representing the equivalent of
- * static unsigned int name[size]
- */
-static ir_entity *new_array_entity(ident *name, int size)
-{
-	ir_type *const uint_type = new_type_primitive(mode_Iu);
-	set_type_alignment_bytes(uint_type, get_type_size_bytes(uint_type));
-
-	ir_type *const array_type = new_type_array(uint_type);
-	set_array_size_int(array_type, size);
-	set_type_size_bytes(array_type, size * get_mode_size_bytes(mode_Iu));
-	set_type_alignment_bytes(array_type, get_mode_size_bytes(mode_Iu));
-	set_type_state(array_type, layout_fixed);
-
-	ir_entity *const result = new_entity(get_glob_type(), name, array_type);
-	set_entity_visibility(result, ir_visibility_private);
 
-	return result;
+	free_cfg(irg, &cfg);
+	if (split) {
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		                        | IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE
+		                        | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS
+		                        | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	}
 }
 
 /**
  * Creates a new entity representing the equivalent of
- * static const char name[strlen(string)+1] = string
+ * static const char name[size] = data
  */
-static ir_entity *new_static_string_entity(ident *name, const char *string)
+static ir_entity *new_static_data_entity(ident *name, ir_mode *mode,
+                                         const char *data, size_t size)
 {
-	ir_type *const char_type   = new_type_primitive(mode_Bs);
+	ir_type *const char_type   = new_type_primitive(mode);
 	ir_type *const string_type = new_type_array(char_type);
-	size_t   const length      = strlen(string) + 1;
 
 	/* Create the type for a fixed-length string */
-	set_array_size_int(string_type, length);
-	set_type_size_bytes(string_type, length);
+	set_array_size_int(string_type, size);
+	set_type_size_bytes(string_type, size);
 	set_type_alignment_bytes(string_type, 1);
 	set_type_state(string_type, layout_fixed);
 
@@ -394,9 +913,9 @@ static ir_entity *new_static_string_entity(ident *name, const char *string)
 
 	/* There seems to be no simpler way to do this. Or at least, cparser
 	 * does exactly the same thing... */
-	ir_initializer_t *const contents = create_initializer_compound(length);
-	for (size_t i = 0; i < length; i++) {
-		ir_tarval        *const c    = new_tarval_from_long(string[i], mode_Bs);
+	ir_initializer_t *const contents = create_initializer_compound(size);
+	for (size_t i = 0; i < size; i++) {
+		ir_tarval        *const c    = new_tarval_from_long(data[i], mode);
 		ir_initializer_t *const init = create_initializer_tarval(c);
 		set_initializer_compound_value(contents, i, init);
 	}
@@ -405,7 +924,7 @@ static ir_entity *new_static_string_entity(ident *name, const char *string)
 	return result;
 }
 
-ir_graph *ir_profile_instrument(const char *filename)
+ir_graph *ir_profile_instrument(const char *filename, bool atomic)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.ir.profile");
 
@@ -414,88 +933,365 @@ ir_graph *ir_profile_instrument(const char *filename)
 	if (get_irp_n_irgs() == 0)
 		return NULL;
 
-	/* count the number of block first */
-	unsigned const n_blocks = get_irp_n_blocks();
-
 	/* create all the necessary types and entities. Note that the
 	 * types must have a fixed layout, because we are already running in the
 	 * backend */
-	ident     *const counter_id    = new_id_from_str("__FIRMPROF__BLOCK_COUNTS");
-	ir_entity *const bblock_counts = new_array_entity(counter_id, n_blocks);
-
-	ident     *const filename_id  = new_id_from_str("__FIRMPROF__FILE_NAME");
-	ir_entity *const ent_filename = new_static_string_entity(filename_id, filename);
+	instrument_env_t env = { .atomic = atomic };
+	env.counter_type = new_type_primitive(mode_Lu);
+	env.word_type    = new_type_primitive(mode_Iu);
+	set_type_alignment_bytes(env.counter_type, 8);
+	if (atomic)
+		env.atomic_inc = get_atomic_inc_ref();
+	ir_type *const counters_type = new_type_array(env.counter_type);
+	env.counters = new_entity(get_glob_type(),
+	                          new_id_from_str("__FIRMPROF__COUNTERS"),
+	                          counters_type);
+	set_entity_visibility(env.counters, ir_visibility_private);
+	set_entity_initializer(env.counters, get_initializer_null());
+	obstack_init(&env.layout);
+	add_layout_u32(&env.layout, LAYOUT_VERSION);
+	add_layout_u32(&env.layout, 0);
 
-	/* initialize block id array and instrument blocks */
-	block_id_walker_data_t wd = { .id = 0 };
 	foreach_irp_irg_r(i, irg) {
-		instrument_irg(irg, bblock_counts, &wd);
+		if (is_profiled_irg(irg))
+			instrument_irg(irg, &env);
 	}
 
-	return gen_initializer_irg(ent_filename, bblock_counts, n_blocks);
+	/* the size of the counter array is known once all graphs are
+	 * instrumented */
+	unsigned const n_elems = MAX(env.n_counters, 1u);
+	set_array_size_int(counters_type, n_elems);
+	set_type_size_bytes(counters_type, n_elems * 8);
+	set_type_alignment_bytes(counters_type, 8);
+	set_type_state(counters_type, layout_fixed);
+
+	size_t const layout_size = obstack_object_size(&env.layout);
+	char  *const layout      = (char*)obstack_finish(&env.layout);
+	for (unsigned i = 0; i < 4; ++i)
+		layout[4 + i] = (char)(env.n_functions >> (i * 8));
+
+	ident     *const layout_id  = new_id_from_str("__FIRMPROF__LAYOUT");
+	ir_entity *const ent_layout = new_static_data_entity(layout_id, mode_Bu,
+	                                                     layout, layout_size);
+	obstack_free(&env.layout, NULL);
+
+	ident     *const filename_id  = new_id_from_str("__FIRMPROF__FILE_NAME");
+	ir_entity *const ent_filename = new_static_data_entity(
+		filename_id, mode_Bs, filename, strlen(filename) + 1);
+
+	return gen_initializer_irg(ent_filename, ent_layout, layout_size,
+	                           env.counters, env.n_counters);
 }
 
-static unsigned int *parse_profile(const char *filename, unsigned int num_blocks)
+static uint32_t read_u32(unsigned char const *p)
 {
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16
+	     | (uint32_t)p[3] << 24;
+}
+
+static uint64_t read_u64(unsigned char const *p)
+{
+	return read_u32(p) | (uint64_t)read_u32(p + 4) << 32;
+}
+
+/** A mapped profile file. */
+typedef struct profile_file_t {
+	unsigned char const *data;
+	size_t               size;
+	unsigned             n_functions;
+	unsigned             n_buckets;
+	unsigned             names_size;
+	uint64_t             n_counters;
+	unsigned char const *records;
+	unsigned char const *buckets;
+	unsigned char const *names;
+	unsigned char const *counters;
+} profile_file_t;
+
+/**
+ * Maps the file @p filename into memory, returns NULL on failure.
+ */
+static unsigned char const *map_file(const char *filename, size_t *size)
+{
+#ifndef _WIN32
+	int const fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		DBG((dbg, LEVEL_2, "Failed to open profile file (%s)\n", filename));
+		return NULL;
+	}
+	void       *result = NULL;
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		result = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (result == MAP_FAILED)
+			result = NULL;
+		*size = st.st_size;
+	}
+	close(fd);
+	return (unsigned char const*)result;
+#else
 	FILE *const f = fopen(filename, "rb");
 	if (!f) {
 		DBG((dbg, LEVEL_2, "Failed to open profile file (%s)\n", filename));
 		return NULL;
 	}
 
-	/* check header */
-	uint32_t *result = NULL;
-	char      buf[8];
-	size_t    ret = fread(buf, 8, 1, f);
-	if (ret == 0 || strncmp(buf, "firmprof", 8) != 0) {
-		DBG((dbg, LEVEL_2, "Broken fileheader in profile\n"));
-		goto end;
-	}
-
-	result = XMALLOCN(unsigned int, num_blocks);
-
-	/* The profiling output format is defined to be a sequence of integer
-	 * values stored little endian format. */
-	for (unsigned i = 0; i < num_blocks; ++i) {
-		unsigned char bytes[4];
-		if ((ret = fread(bytes, 1, 4, f)) < 1)
+	size_t         len    = 0;
+	size_t         cap    = 4096;
+	unsigned char *result = XMALLOCN(unsigned char, cap);
+	for (;;) {
+		len += fread(result + len, 1, cap - len, f);
+		if (len < cap)
 			break;
-
-		result[i] = (bytes[0] <<  0) | (bytes[1] <<  8)
-		          | (bytes[2] << 16) | (bytes[3] << 24);
+		cap *= 2;
+		result = XREALLOC(result, unsigned char, cap);
 	}
-
-	if (ret < 1) {
-		DBG((dbg, LEVEL_4, "Failed to read counters... (size: %u)\n",
-			sizeof(unsigned int) * num_blocks));
+	if (ferror(f)) {
 		free(result);
 		result = NULL;
 	}
-
-end:
 	fclose(f);
+	*size = len;
 	return result;
+#endif
+}
+
+static void unmap_file(unsigned char const *data, size_t size)
+{
+#ifndef _WIN32
+	munmap((void*)data, size);
+#else
+	(void)size;
+	free((void*)data);
+#endif
 }
 
 /**
- * Reads the corresponding profile info file if it exists.
+ * Checks the header of the profile and locates its parts. The records are
+ * checked when they are looked up, so opening a profile does not depend on
+ * its size.
  */
-static void block_associate_walker(ir_node *bb, void *env)
+static bool open_profile(profile_file_t *file)
 {
-	block_assoc_t *b = (block_assoc_t*)env;
-	execcount_t query;
+	unsigned char const *const data   = file->data;
+	size_t               const header = sizeof(PROFILE_MAGIC) - 1;
+	if (file->size < HEADER_SIZE || memcmp(data, PROFILE_MAGIC, header) != 0) {
+		DBG((dbg, LEVEL_2, "Broken fileheader in profile\n"));
+		return false;
+	}
+	if (read_u32(data + header) != PROFILE_VERSION) {
+		DBG((dbg, LEVEL_2, "Unsupported profile version\n"));
+		return false;
+	}
 
-	query.block = get_irn_node_nr(bb);
-	query.count = b->counters[b->i++];
-	DBG((dbg, LEVEL_4, "execcount(%+F, %u): %u\n", bb, query.block, query.count));
+	file->n_functions = read_u32(data + 12);
+	file->n_buckets   = read_u32(data + 16);
+	file->names_size  = read_u32(data + 20);
+	file->n_counters  = read_u64(data + 24);
+	uint64_t const names_offset = HEADER_SIZE
+		+ (uint64_t)file->n_functions * RECORD_SIZE
+		+ (uint64_t)file->n_buckets * 4;
+	uint64_t const counters_offset
+		= (names_offset + file->names_size + 7) & ~(uint64_t)7;
+	if (!is_po2(file->n_buckets) || file->n_buckets < file->n_functions
+	    || counters_offset > file->size
+	    || (file->size - counters_offset) / 8 < file->n_counters) {
+		DBG((dbg, LEVEL_4, "Failed to read counters... (size: %zu)\n",
+		     file->size));
+		return false;
+	}
+	file->records  = data + HEADER_SIZE;
+	file->buckets  = file->records + file->n_functions * RECORD_SIZE;
+	file->names    = data + names_offset;
+	file->counters = data + counters_offset;
+	return true;
+}
+
+static uint64_t hash_name(char const *name, size_t len)
+{
+	uint64_t hash = UINT64_C(0xCBF29CE484222325);
+	for (size_t i = 0; i < len; ++i) {
+		hash ^= (unsigned char)name[i];
+		hash *= UINT64_C(0x100000001B3);
+	}
+	return hash;
+}
+
+/**
+ * Finds the function @p name in the profile by probing the bucket of its
+ * hash.
+ */
+static bool find_function(profile_file_t const *file, char const *name,
+                          profile_function_t *function)
+{
+	if (file->n_buckets == 0)
+		return false;
+	size_t   const len  = strlen(name);
+	uint64_t const hash = hash_name(name, len);
+	unsigned const mask = file->n_buckets - 1;
+	/* every probe either finds a record or a free bucket, so there are at
+	 * most n_functions + 1 of them */
+	for (unsigned b = hash & mask, n = 0; n <= file->n_functions;
+	     b = (b + 1) & mask, ++n) {
+		uint32_t const nr = read_u32(file->buckets + 4 * b);
+		if (nr == 0 || nr > file->n_functions)
+			return false;
+		unsigned char const *const record
+			= file->records + (nr - 1) * RECORD_SIZE;
+		uint32_t const name_offset = read_u32(record + 24);
+		if (read_u64(record) != hash || name_offset > file->names_size
+		    || file->names_size - name_offset <= len
+		    || memcmp(file->names + name_offset, name, len + 1) != 0)
+			continue;
+
+		uint64_t const first      = read_u64(record + 16);
+		uint32_t const n_counters = read_u32(record + 28);
+		if (first > file->n_counters || file->n_counters - first < n_counters)
+			return false;
+		function->checksum   = read_u64(record + 8);
+		function->n_counters = n_counters;
+		function->counts     = file->counters + 8 * first;
+		return true;
+	}
+	return false;
+}
+
+static void set_execcount(ir_node const *block, uint64_t count)
+{
+	execcount_t const query = { .block = get_irn_node_nr(block), .count = count };
+	DBG((dbg, LEVEL_4, "execcount(%+F): %llu\n", block,
+	     (unsigned long long)count));
 	(void)set_insert(execcount_t, profile, &query, sizeof(query), query.block);
 }
 
-static void irp_associate_blocks(block_assoc_t *env)
+/**
+ * Computes the counts of the uninstrumented edges: the flow into each block
+ * equals the flow out of it, so an edge is known once all other edges of
+ * one of its blocks are.
+ */
+static void solve_edge_counts(size_t n_blocks, cfg_edge_t const *edges,
+                              uint64_t *counts, bool *known)
 {
-	foreach_irp_irg_r(i, irg) {
-		irg_block_walk_graph(irg, block_associate_walker, NULL, env);
+	size_t const n_edges = ARR_LEN(edges);
+
+	/* the edges incident to each block */
+	unsigned *const start    = XMALLOCNZ(unsigned, n_blocks + 1);
+	unsigned *const incident = XMALLOCN(unsigned, 2 * n_edges);
+	unsigned *const n_unknown = XMALLOCNZ(unsigned, n_blocks);
+	for (size_t i = 0; i < n_edges; ++i) {
+		cfg_edge_t const *const edge = &edges[i];
+		++start[edge->src + 1];
+		++start[edge->dst + 1];
+		if (!known[i]) {
+			++n_unknown[edge->src];
+			++n_unknown[edge->dst];
+		}
+	}
+	for (size_t b = 0; b < n_blocks; ++b)
+		start[b + 1] += start[b];
+	unsigned *const fill = XMALLOCN(unsigned, n_blocks);
+	memcpy(fill, start, n_blocks * sizeof(*fill));
+	for (size_t i = 0; i < n_edges; ++i) {
+		cfg_edge_t const *const edge = &edges[i];
+		incident[fill[edge->src]++] = i;
+		incident[fill[edge->dst]++] = i;
+	}
+	free(fill);
+
+	unsigned *worklist = NEW_ARR_F(unsigned, 0);
+	for (size_t b = 0; b < n_blocks; ++b) {
+		if (n_unknown[b] == 1)
+			ARR_APP1(unsigned, worklist, b);
+	}
+	while (ARR_LEN(worklist) > 0) {
+		unsigned const b = worklist[ARR_LEN(worklist) - 1];
+		ARR_SHRINKLEN(worklist, ARR_LEN(worklist) - 1);
+		if (n_unknown[b] != 1)
+			continue;
+
+		/* balance = flow in - flow out over the known edges */
+		int64_t  balance = 0;
+		unsigned missing = 0;
+		for (unsigned e = start[b]; e < start[b + 1]; ++e) {
+			unsigned          const nr   = incident[e];
+			cfg_edge_t const *const edge = &edges[nr];
+			if (edge->src == edge->dst)
+				continue;
+			if (!known[nr]) {
+				missing = nr;
+			} else if (edge->dst == b) {
+				balance += counts[nr];
+			} else {
+				balance -= counts[nr];
+			}
+		}
+		cfg_edge_t const *const edge  = &edges[missing];
+		int64_t           const count = edge->dst == b ? -balance : balance;
+		counts[missing] = count > 0 ? (uint64_t)count : 0;
+		known[missing]  = true;
+		unsigned const other = edge->dst == b ? edge->src : edge->dst;
+		--n_unknown[b];
+		if (--n_unknown[other] == 1)
+			ARR_APP1(unsigned, worklist, other);
 	}
+	DEL_ARR_F(worklist);
+	free(n_unknown);
+	free(incident);
+	free(start);
+}
+
+/**
+ * Associates the execution counts of @p function with the blocks of @p irg.
+ */
+static void associate_counts(ir_graph *irg, profile_function_t const *function)
+{
+	profile_cfg_t cfg;
+	build_cfg(irg, &cfg);
+	if (cfg.checksum != function->checksum
+	    || cfg.n_counters != function->n_counters) {
+		DBG((dbg, LEVEL_2, "%+F changed since profiling, ignoring profile\n",
+		     irg));
+		free_cfg(irg, &cfg);
+		return;
+	}
+
+	size_t    const n_edges = ARR_LEN(cfg.edges);
+	uint64_t *const counts  = XMALLOCNZ(uint64_t, n_edges);
+	bool     *const known   = XMALLOCNZ(bool, n_edges);
+	for (size_t i = 0; i < n_edges; ++i) {
+		cfg_edge_t const *const edge = &cfg.edges[i];
+		if (edge->counter >= 0) {
+			counts[i] = read_u64(function->counts + 8 * edge->counter);
+			known[i]  = true;
+		} else if (!edge->in_tree) {
+			/* edges without a place for a counter are assumed to be
+			 * never taken */
+			known[i] = true;
+		}
+	}
+	solve_edge_counts(ARR_LEN(cfg.blocks), cfg.edges, counts, known);
+
+	size_t    const n_blocks   = ARR_LEN(cfg.blocks);
+	uint64_t *const block_in   = XMALLOCNZ(uint64_t, n_blocks);
+	ir_node  *const end_block  = get_irg_end_block(irg);
+	unsigned  const root       = get_block_info(get_irg_start_block(irg))->index;
+	uint64_t        root_out   = 0;
+	for (size_t i = 0; i < n_edges; ++i) {
+		cfg_edge_t const *const edge = &cfg.edges[i];
+		if (edge->src == root)
+			root_out += counts[i];
+		if (edge->dst != root)
+			block_in[edge->dst] += counts[i];
+	}
+	for (size_t b = 0; b < n_blocks; ++b) {
+		ir_node *const block = cfg.blocks[b];
+		set_execcount(block, b == root || block == end_block ? root_out
+		                                                     : block_in[b]);
+	}
+	free(block_in);
+	free(known);
+	free(counts);
+	free_cfg(irg, &cfg);
 }
 
 void ir_profile_free(void)
@@ -515,23 +1311,276 @@ bool ir_profile_read(const char *filename)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.ir.profile");
 
-	unsigned n_blocks = get_irp_n_blocks();
-	block_assoc_t env = {
-		.i        = 0,
-		.counters = parse_profile(filename, n_blocks)
+	size_t                     size;
+	unsigned char const *const data = map_file(filename, &size);
+	if (data == NULL)
+		return false;
+
+	profile_file_t file = { .data = data, .size = size };
+
+	bool const res = open_profile(&file);
+	if (res) {
+		ir_profile_free();
+		profile = new_set(cmp_execcount, 16);
+
+		foreach_irp_irg_r(i, irg) {
+			if (!is_profiled_irg(irg))
+				continue;
+			char const *const name = get_entity_ld_name(get_irg_entity(irg));
+			profile_function_t function;
+			if (find_function(&file, name, &function))
+				associate_counts(irg, &function);
+		}
+
+		/* register the vcg hook */
+		hook = dump_add_node_info_callback(dump_profile_node_info, NULL);
+	}
+	unmap_file(data, size);
+	return res;
+}
+
+/**
+ * The entry count of a function or the count of its calls to another at one
+ * source position.
+ */
+typedef struct call_count_t {
+	ident    *caller;
+	ident    *callee;  /**< NULL for the entry count of the caller */
+	unsigned  line;
+	unsigned  column;
+	uint64_t  count;   /**< summed over the calls at the position */
+	unsigned  n_calls; /**< calls at the position in the profiled graph */
+} call_count_t;
+
+/* the call counts by the names of the functions, kept until
+ * ir_profile_free_calls() as the inliner needs them */
+static set *call_counts = NULL;
+
+static int cmp_call_count(const void *a, const void *b, size_t size)
+{
+	const call_count_t *ca = (const call_count_t*)a;
+	const call_count_t *cb = (const call_count_t*)b;
+	(void)size;
+	return ca->caller != cb->caller || ca->callee != cb->callee
+	    || ca->line != cb->line || ca->column != cb->column;
+}
+
+static unsigned hash_call_count(call_count_t const *query)
+{
+	unsigned const pos = query->line * 0x9E3779B1u ^ query->column;
+	return hash_combine(hash_combine(hash_ptr(query->caller),
+	                                 hash_ptr(query->callee)), pos);
+}
+
+static void add_call_count(ident *caller, ident *callee, unsigned line,
+                           unsigned column, uint64_t count)
+{
+	call_count_t const query = {
+		.caller  = caller,
+		.callee  = callee,
+		.line    = line,
+		.column  = column,
+		.count   = 0,
+		.n_calls = 0,
+	};
+	call_count_t *const entry = set_insert(call_count_t, call_counts, &query,
+	                                       sizeof(query),
+	                                       hash_call_count(&query));
+	entry->count += count;
+	++entry->n_calls;
+}
+
+/** Returns the count of one of the calls described by @p query. */
+static uint64_t get_call_count(call_count_t const *query)
+{
+	if (call_counts == NULL)
+		return 0;
+	call_count_t const *const entry
+		= set_find(call_count_t, call_counts, query, sizeof(*query),
+		           hash_call_count(query));
+	return entry != NULL ? entry->count / entry->n_calls : 0;
+}
+
+/** Reads the call sites of a function, see the layout. */
+typedef struct call_reader_t {
+	unsigned char const *pos;
+	unsigned char const *end;
+	bool                 broken;
+} call_reader_t;
+
+static uint32_t read_call_u32(call_reader_t *reader)
+{
+	if (reader->end - reader->pos < 4) {
+		reader->broken = true;
+		return 0;
+	}
+	uint32_t const value = read_u32(reader->pos);
+	reader->pos += 4;
+	return value;
+}
+
+/**
+ * Derives the entry count of @p caller and the counts of its calls from its
+ * call sites and counters, the same way as the block counts of a graph.
+ */
+static bool read_function_calls(ident *caller, call_reader_t *reader,
+                                profile_function_t const *function)
+{
+	uint32_t const n_blocks = read_call_u32(reader);
+	uint32_t const root     = read_call_u32(reader);
+	uint32_t const n_edges  = read_call_u32(reader);
+	if (reader->broken || root >= n_blocks
+	    || n_edges > (size_t)(reader->end - reader->pos) / 12)
+		return false;
+
+	cfg_edge_t *const edges  = NEW_ARR_FZ(cfg_edge_t, n_edges);
+	uint64_t   *const counts = XMALLOCNZ(uint64_t, n_edges);
+	bool       *const known  = XMALLOCNZ(bool, n_edges);
+	bool              ok     = true;
+	for (uint32_t i = 0; i < n_edges && ok; ++i) {
+		cfg_edge_t *const edge    = &edges[i];
+		edge->src                 = read_call_u32(reader);
+		edge->dst                 = read_call_u32(reader);
+		uint32_t    const counter = read_call_u32(reader);
+		if (edge->src >= n_blocks || edge->dst >= n_blocks) {
+			ok = false;
+		} else if (counter == EDGE_NOT_TAKEN) {
+			known[i] = true;
+		} else if (counter != EDGE_IN_TREE) {
+			ok        = counter < function->n_counters;
+			counts[i] = ok ? read_u64(function->counts + 8 * counter) : 0;
+			known[i]  = true;
+		}
+	}
+
+	if (ok) {
+		solve_edge_counts(n_blocks, edges, counts, known);
+		uint64_t *const block_in = XMALLOCNZ(uint64_t, n_blocks);
+		uint64_t        root_out = 0;
+		for (size_t i = 0; i < n_edges; ++i) {
+			if (edges[i].src == root)
+				root_out += counts[i];
+			if (edges[i].dst != root)
+				block_in[edges[i].dst] += counts[i];
+		}
+		block_in[root] = root_out;
+		add_call_count(caller, NULL, 0, 0, root_out);
+
+		uint32_t const n_calls = read_call_u32(reader);
+		for (uint32_t i = 0; i < n_calls && ok; ++i) {
+			uint32_t const block  = read_call_u32(reader);
+			uint32_t const line   = read_call_u32(reader);
+			uint32_t const column = read_call_u32(reader);
+			uint32_t const len    = read_call_u32(reader);
+			ok = !reader->broken && block < n_blocks
+			  && len <= (size_t)(reader->end - reader->pos);
+			if (ok) {
+				ident *const callee
+					= new_id_from_chars((char const*)reader->pos, len);
+				reader->pos += len;
+				add_call_count(caller, callee, line, column,
+				               block_in[block]);
+			}
+		}
+		ok = ok && !reader->broken;
+		free(block_in);
+	}
+	free(known);
+	free(counts);
+	DEL_ARR_F(edges);
+	return ok;
+}
+
+/** Reads the entry and call counts of the function in record @p nr. */
+static bool read_record_calls(profile_file_t const *file, unsigned nr)
+{
+	unsigned char const *const record = file->records + nr * RECORD_SIZE;
+	uint32_t const name_offset = read_u32(record + 24);
+	uint64_t const first       = read_u64(record + 16);
+	uint32_t const n_counters  = read_u32(record + 28);
+	uint32_t const calls       = read_u32(record + 32);
+	uint32_t const calls_size  = read_u32(record + 36);
+	if (name_offset >= file->names_size || first > file->n_counters
+	    || file->n_counters - first < n_counters
+	    || calls > file->names_size || file->names_size - calls < calls_size)
+		return false;
+	char const *const name = (char const*)file->names + name_offset;
+	char const *const end  = (char const*)memchr(name, '\0',
+	                                             file->names_size - name_offset);
+	if (end == NULL)
+		return false;
+
+	profile_function_t const function = {
+		.checksum   = read_u64(record + 8),
+		.n_counters = n_counters,
+		.counts     = file->counters + 8 * first,
 	};
-	if (!env.counters)
+	call_reader_t reader = {
+		.pos    = file->names + calls,
+		.end    = file->names + calls + calls_size,
+		.broken = false,
+	};
+	ident *const caller = new_id_from_chars(name, end - name);
+	return read_function_calls(caller, &reader, &function);
+}
+
+int ir_profile_read_calls(const char *filename)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.ir.profile");
+
+	size_t                     size;
+	unsigned char const *const data = map_file(filename, &size);
+	if (data == NULL)
 		return false;
 
-	ir_profile_free();
-	profile = new_set(cmp_execcount, 16);
+	profile_file_t file = { .data = data, .size = size };
+
+	bool res = open_profile(&file);
+	if (res) {
+		ir_profile_free_calls();
+		call_counts = new_set(cmp_call_count, 16);
+		for (unsigned nr = 0; nr < file.n_functions && res; ++nr)
+			res = read_record_calls(&file, nr);
+		if (!res) {
+			DBG((dbg, LEVEL_2, "Broken call sites in profile\n"));
+			ir_profile_free_calls();
+		}
+	}
+	unmap_file(data, size);
+	return res;
+}
+
+void ir_profile_free_calls(void)
+{
+	if (call_counts != NULL) {
+		del_set(call_counts);
+		call_counts = NULL;
+	}
+}
 
-	irp_associate_blocks(&env);
-	free(env.counters);
+unsigned long long ir_profile_get_entry_count(const ir_entity *function)
+{
+	call_count_t const query = {
+		.caller = get_entity_ld_ident(function),
+		.callee = NULL,
+	};
+	return get_call_count(&query);
+}
 
-	/* register the vcg hook */
-	hook = dump_add_node_info_callback(dump_profile_node_info, NULL);
-	return 1;
+unsigned long long ir_profile_get_call_count(const ir_entity *caller,
+                                             const ir_node *call)
+{
+	ir_entity const *const callee = get_Call_callee(call);
+	if (callee == NULL)
+		return 0;
+	src_loc_t    const loc   = ir_retrieve_dbg_info(get_irn_dbg_info(call));
+	call_count_t const query = {
+		.caller = get_entity_ld_ident(caller),
+		.callee = get_entity_ld_ident(callee),
+		.line   = loc.line,
+		.column = loc.column,
+	};
+	return get_call_count(&query);
 }
 
 typedef struct initialize_execfreq_env_t {
@@ -559,8 +1608,8 @@ static void initialize_execfreq(ir_node *block, void *data)
 static void ir_set_execfreqs_from_profile(ir_graph *irg)
 {
 	/* Find the first block containing instructions */
-	ir_node *const start_block = get_irg_start_block(irg);
-	unsigned const count       = ir_profile_get_block_execcount(start_block);
+	ir_node  *const start_block = get_irg_start_block(irg);
+	uint64_t  const count       = ir_profile_get_block_execcount(start_block);
 	if (count == 0) {
 		/* the function was never executed, so fallback to estimated freqs */
 		ir_estimate_execfreq(irg);
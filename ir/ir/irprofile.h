@@ -19,15 +19,18 @@
 
 /**
  * Instruments all irgs in the program with profile code.
- * The final code will have a counter for each basic block which is
- * incremented in that block. After the program has run the info is written
- * to @p filename.
+ * The final code has a 64 bit counter for each control flow edge outside of
+ * a spanning tree of the control flow graph, the counts of the remaining
+ * edges and of the blocks are derived when the profile is read. After the
+ * program has run the info is written to @p filename.
+ * @param atomic  increment the counters atomically, for threaded programs
  */
-ir_graph *ir_profile_instrument(const char *filename);
+ir_graph *ir_profile_instrument(const char *filename, bool atomic);
 
 /**
  * Reads the corresponding profile info file if it exists and returns a
- * profile info struct
+ * profile info struct. Functions whose control flow graph differs from the
+ * profiled one get no counts.
  * @param filename The name of the file containing profile information
  */
 bool ir_profile_read(const char *filename);
@@ -38,9 +41,10 @@ bool ir_profile_read(const char *filename);
 void ir_profile_free(void);
 
 /**
- * Get block execution count as determined be profiling
+ * Get block execution count as determined be profiling, 0 if no profile was
+ * read or it has no data for the block
  */
-uint32_t ir_profile_get_block_execcount(const ir_node *block);
+uint64_t ir_profile_get_block_execcount(const ir_node *block);
 
 /**
  * Initializes exec_freq structure for an irg based on profile data
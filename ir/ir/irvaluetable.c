@@ -0,0 +1,186 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief     Value table for the identities of the CSE.
+ */
+#include <stdint.h>
+
+#include "irvaluetable.h"
+
+#include "bitfiddle.h"
+#include "util.h"
+#include "xmalloc.h"
+
+/** Minimal number of slots of a table. */
+#define MIN_SLOTS     64
+/** Number of old slots moved to the new table by each insertion. The table
+ * is at most half full before it grows, so the old slots are gone long before
+ * the new table has to grow again. */
+#define MIGRATE_SLOTS 8
+
+typedef struct valuetable_entry_t {
+	unsigned  hash;
+	ir_node  *node; /**< NULL for free slots */
+} valuetable_entry_t;
+
+struct ir_valuetable_t {
+	valuetable_entry_t      *entries;
+	unsigned                 log_slots;   /**< log2 of the number of slots */
+	size_t                   n_entries;   /**< used slots of entries */
+	size_t                   n_nodes;     /**< nodes in the whole table */
+	valuetable_entry_t      *old_entries; /**< slots before the last resize,
+	                                           NULL if all were moved */
+	unsigned                 old_log_slots;
+	size_t                   old_pos;     /**< next old slot to move */
+	ir_valuetable_equal_func equal;
+};
+
+/**
+ * Returns the first slot to probe for a hash. The node hashes are often badly
+ * distributed in the low bits, so use the upper bits of a multiplicative hash.
+ */
+static inline size_t first_slot(unsigned hash, unsigned log_slots)
+{
+	return (uint32_t)(hash * UINT32_C(0x9E3779B9)) >> (32 - log_slots);
+}
+
+static valuetable_entry_t *alloc_entries(unsigned log_slots)
+{
+	return XMALLOCNZ(valuetable_entry_t, (size_t)1 << log_slots);
+}
+
+/**
+ * Puts a node into a free slot, the node must not be in the slots yet.
+ */
+static void put_entry(valuetable_entry_t *entries, unsigned log_slots,
+                      valuetable_entry_t const *entry)
+{
+	size_t const mask = ((size_t)1 << log_slots) - 1;
+	size_t       pos  = first_slot(entry->hash, log_slots);
+	while (entries[pos].node != NULL)
+		pos = (pos + 1) & mask;
+	entries[pos] = *entry;
+}
+
+/**
+ * Moves up to @p n_slots old slots into the current slots.
+ */
+static void migrate(ir_valuetable_t *table, size_t n_slots)
+{
+	valuetable_entry_t const *const old   = table->old_entries;
+	size_t                    const n_old = (size_t)1 << table->old_log_slots;
+	size_t                    const end   = table->old_pos
+	                                      + MIN(n_old - table->old_pos, n_slots);
+	for (size_t i = table->old_pos; i < end; ++i) {
+		if (old[i].node == NULL)
+			continue;
+		put_entry(table->entries, table->log_slots, &old[i]);
+		++table->n_entries;
+	}
+	table->old_pos = end;
+	if (end == n_old) {
+		free(table->old_entries);
+		table->old_entries = NULL;
+	}
+}
+
+static void grow(ir_valuetable_t *table)
+{
+	/* finish the last resize first, should not happen with MIGRATE_SLOTS
+	 * large enough */
+	if (table->old_entries != NULL)
+		migrate(table, SIZE_MAX);
+
+	table->old_entries   = table->entries;
+	table->old_log_slots = table->log_slots;
+	table->old_pos       = 0;
+	table->log_slots    += 1;
+	table->entries       = alloc_entries(table->log_slots);
+	table->n_entries     = 0;
+}
+
+ir_valuetable_t *ir_valuetable_new(ir_valuetable_equal_func equal,
+                                   size_t expected_elements)
+{
+	size_t           const n_slots = MAX((size_t)MIN_SLOTS, 2 * expected_elements);
+	ir_valuetable_t *const table   = XMALLOCZ(ir_valuetable_t);
+	table->log_slots = log2_ceil((uint32_t)n_slots);
+	table->entries   = alloc_entries(table->log_slots);
+	table->equal     = equal;
+	return table;
+}
+
+void ir_valuetable_free(ir_valuetable_t *table)
+{
+	free(table->old_entries);
+	free(table->entries);
+	free(table);
+}
+
+ir_node *ir_valuetable_insert(ir_valuetable_t *table, ir_node *node,
+                              unsigned hash)
+{
+	if (table->old_entries != NULL)
+		migrate(table, MIGRATE_SLOTS);
+
+	ir_valuetable_equal_func const equal   = table->equal;
+	valuetable_entry_t      *const entries = table->entries;
+	size_t                   const mask    = ((size_t)1 << table->log_slots) - 1;
+	size_t                         pos     = first_slot(hash, table->log_slots);
+	for (; entries[pos].node != NULL; pos = (pos + 1) & mask) {
+		ir_node *const other = entries[pos].node;
+		if (entries[pos].hash == hash && equal(other, node))
+			return other;
+	}
+
+	/* the old slots are not changed while they are moved, so their probe
+	 * sequences are still intact */
+	valuetable_entry_t const *const old = table->old_entries;
+	if (old != NULL) {
+		size_t const old_mask = ((size_t)1 << table->old_log_slots) - 1;
+		size_t       old_pos  = first_slot(hash, table->old_log_slots);
+		for (; old[old_pos].node != NULL; old_pos = (old_pos + 1) & old_mask) {
+			ir_node *const other = old[old_pos].node;
+			if (old[old_pos].hash == hash && equal(other, node))
+				return other;
+		}
+	}
+
+	entries[pos].hash = hash;
+	entries[pos].node = node;
+	++table->n_nodes;
+	/* keep the table at most half full */
+	if (++table->n_entries > (mask + 1) / 2)
+		grow(table);
+	return node;
+}
+
+size_t ir_valuetable_size(const ir_valuetable_t *table)
+{
+	return table->n_nodes;
+}
+
+void ir_valuetable_walk(const ir_valuetable_t *table, irg_walk_func *visit,
+                        void *env)
+{
+	size_t const n_slots = (size_t)1 << table->log_slots;
+	for (size_t i = 0; i < n_slots; ++i) {
+		ir_node *const node = table->entries[i].node;
+		if (node != NULL)
+			visit(node, env);
+	}
+
+	/* the slots before old_pos are in the current slots already */
+	valuetable_entry_t const *const old = table->old_entries;
+	if (old != NULL) {
+		size_t const n_old = (size_t)1 << table->old_log_slots;
+		for (size_t i = table->old_pos; i < n_old; ++i) {
+			if (old[i].node != NULL)
+				visit(old[i].node, env);
+		}
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief     Value table for the identities of the CSE.
+ *
+ * An open addressing hash table of nodes. The hash of each node is stored
+ * next to it, so probing only compares nodes with an equal hash. The table
+ * grows incrementally: after a resize the slots of the old table are moved
+ * over a few at a time by the following insertions, so no single insertion
+ * has to rehash the whole table.
+ */
+#ifndef FIRM_IR_IRVALUETABLE_H
+#define FIRM_IR_IRVALUETABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "firm_types.h"
+
+typedef struct ir_valuetable_t ir_valuetable_t;
+
+/**
+ * Returns true if node @p a computes the same value as node @p b.
+ */
+typedef bool (*ir_valuetable_equal_func)(const ir_node *a, const ir_node *b);
+
+/**
+ * Creates a new value table.
+ *
+ * @param equal              the function deciding if two nodes are the same
+ * @param expected_elements  number of nodes expected in the table (roughly)
+ */
+ir_valuetable_t *ir_valuetable_new(ir_valuetable_equal_func equal,
+                                   size_t expected_elements);
+
+/**
+ * Frees a value table.
+ */
+void ir_valuetable_free(ir_valuetable_t *table);
+
+/**
+ * Looks up a node in a value table and inserts it if no equal node is in the
+ * table yet.
+ *
+ * @param table  the value table
+ * @param node   the node to look up
+ * @param hash   the hash of the node
+ * @return the equal node found in the table or @p node if it was inserted
+ */
+ir_node *ir_valuetable_insert(ir_valuetable_t *table, ir_node *node,
+                              unsigned hash);
+
+/**
+ * Returns the number of nodes in a value table.
+ */
+size_t ir_valuetable_size(const ir_valuetable_t *table);
+
+/**
+ * Calls @p visit for each node in a value table. The table must not be
+ * changed while walking it.
+ */
+void ir_valuetable_walk(const ir_valuetable_t *table, irg_walk_func *visit,
+                        void *env);
+
+#endif
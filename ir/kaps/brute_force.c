@@ -28,23 +28,19 @@
 #include "pbqp_node_t.h"
 #include "vector.h"
 
-#if KAPS_STATISTIC
-static int dump = 0;
-#endif
-
 /* Forward declarations. */
 static void apply_Brute_Force(pbqp_t *pbqp);
 
 static void apply_brute_force_reductions(pbqp_t *pbqp)
 {
 	for (;;) {
-		if (edge_bucket_get_length(edge_bucket) > 0) {
+		if (edge_bucket_get_length(pbqp->edge_bucket) > 0) {
 			apply_edge(pbqp);
-		} else if (node_bucket_get_length(node_buckets[1]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[1]) > 0) {
 			apply_RI(pbqp);
-		} else if (node_bucket_get_length(node_buckets[2]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[2]) > 0) {
 			apply_RII(pbqp);
-		} else if (node_bucket_get_length(node_buckets[3]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[3]) > 0) {
 			apply_Brute_Force(pbqp);
 		} else {
 			return;
@@ -71,22 +67,22 @@ static unsigned get_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node)
 		node_bucket_init(&bucket_deg3);
 
 		/* Some node buckets and the edge bucket should be empty. */
-		assert(node_bucket_get_length(node_buckets[1]) == 0);
-		assert(node_bucket_get_length(node_buckets[2]) == 0);
-		assert(edge_bucket_get_length(edge_bucket)     == 0);
+		assert(node_bucket_get_length(pbqp->node_buckets[1]) == 0);
+		assert(node_bucket_get_length(pbqp->node_buckets[2]) == 0);
+		assert(edge_bucket_get_length(pbqp->edge_bucket)     == 0);
 
 		/* char *tmp = obstack_finish(&pbqp->obstack); */
 
 		/* Save current PBQP state. */
-		node_bucket_copy(&bucket_deg3, node_buckets[3]);
-		node_bucket_shrink(&node_buckets[3], 0);
-		node_bucket_deep_copy(pbqp, &node_buckets[3], bucket_deg3);
-		node_bucket_update(pbqp, node_buckets[3]);
-		bucket_0_length   = node_bucket_get_length(node_buckets[0]);
-		bucket_red_length = node_bucket_get_length(reduced_bucket);
+		node_bucket_copy(&bucket_deg3, pbqp->node_buckets[3]);
+		node_bucket_shrink(&pbqp->node_buckets[3], 0);
+		node_bucket_deep_copy(pbqp, &pbqp->node_buckets[3], bucket_deg3);
+		node_bucket_update(pbqp, pbqp->node_buckets[3]);
+		bucket_0_length   = node_bucket_get_length(pbqp->node_buckets[0]);
+		bucket_red_length = node_bucket_get_length(pbqp->reduced_bucket);
 
 		/* Select alternative and solve PBQP recursively. */
-		select_alternative(node_buckets[3][bucket_index], node_index);
+		select_alternative(pbqp, pbqp->node_buckets[3][bucket_index], node_index);
 		apply_brute_force_reductions(pbqp);
 
 		value = determine_solution(pbqp);
@@ -97,18 +93,18 @@ static unsigned get_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node)
 		}
 
 		/* Some node buckets and the edge bucket should still be empty. */
-		assert(node_bucket_get_length(node_buckets[1]) == 0);
-		assert(node_bucket_get_length(node_buckets[2]) == 0);
-		assert(edge_bucket_get_length(edge_bucket)     == 0);
+		assert(node_bucket_get_length(pbqp->node_buckets[1]) == 0);
+		assert(node_bucket_get_length(pbqp->node_buckets[2]) == 0);
+		assert(edge_bucket_get_length(pbqp->edge_bucket)     == 0);
 
 		/* Clear modified buckets... */
-		node_bucket_shrink(&node_buckets[3], 0);
+		node_bucket_shrink(&pbqp->node_buckets[3], 0);
 
 		/* ... and restore old PBQP state. */
-		node_bucket_shrink(&node_buckets[0], bucket_0_length);
-		node_bucket_shrink(&reduced_bucket, bucket_red_length);
-		node_bucket_copy(&node_buckets[3], bucket_deg3);
-		node_bucket_update(pbqp, node_buckets[3]);
+		node_bucket_shrink(&pbqp->node_buckets[0], bucket_0_length);
+		node_bucket_shrink(&pbqp->reduced_bucket, bucket_red_length);
+		node_bucket_copy(&pbqp->node_buckets[3], bucket_deg3);
+		node_bucket_update(pbqp, pbqp->node_buckets[3]);
 
 		/* Free copies. */
 		/* obstack_free(&pbqp->obstack, tmp); */
@@ -123,7 +119,7 @@ static unsigned get_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node)
 static void apply_Brute_Force(pbqp_t *pbqp)
 {
 	/* We want to reduce a node with maximum degree. */
-	pbqp_node_t *node = get_node_with_max_degree();
+	pbqp_node_t *node = get_node_with_max_degree(pbqp);
 	assert(pbqp_node_get_degree(node) > 2);
 
 #if KAPS_DUMP
@@ -136,7 +132,7 @@ static void apply_Brute_Force(pbqp_t *pbqp)
 #endif
 
 #if KAPS_STATISTIC
-	dump++;
+	pbqp->bf_depth++;
 #endif
 
 	unsigned min_index = get_minimal_alternative(pbqp, node);
@@ -149,8 +145,8 @@ static void apply_Brute_Force(pbqp_t *pbqp)
 #endif
 
 #if KAPS_STATISTIC
-	dump--;
-	if (dump == 0) {
+	pbqp->bf_depth--;
+	if (pbqp->bf_depth == 0) {
 		FILE *fh = fopen("solutions.pb", "a");
 		fprintf(fh, "[%u]", min_index);
 		fclose(fh);
@@ -159,7 +155,7 @@ static void apply_Brute_Force(pbqp_t *pbqp)
 #endif
 
 	/* Now that we found the minimum set all other costs to infinity. */
-	select_alternative(node, min_index);
+	select_alternative(pbqp, node, min_index);
 }
 
 static void back_propagate_RI(pbqp_t *pbqp, pbqp_node_t *node)
@@ -270,10 +266,10 @@ static void back_propagate_brute_force(pbqp_t *pbqp)
 	}
 #endif
 
-	unsigned node_len = node_bucket_get_length(reduced_bucket);
+	unsigned node_len = node_bucket_get_length(pbqp->reduced_bucket);
 
 	for (unsigned node_index = node_len; node_index-- != 0;) {
-		pbqp_node_t *node = reduced_bucket[node_index];
+		pbqp_node_t *node = pbqp->reduced_bucket[node_index];
 
 		switch (pbqp_node_get_degree(node)) {
 			case 1:
@@ -329,5 +325,5 @@ void solve_pbqp_brute_force(pbqp_t *pbqp)
 	/* Solve reduced nodes. */
 	back_propagate_brute_force(pbqp);
 
-	free_buckets();
+	free_buckets(pbqp);
 }
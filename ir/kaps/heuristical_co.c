@@ -42,7 +42,7 @@ static void merge_into_RN_node(pbqp_t *pbqp, plist_t *rpeo)
 		plist_erase(rpeo, plist_first(rpeo));
 		/* insert node at the end of rpeo so the rpeo already exits after pbqp solving */
 		plist_insert_back(rpeo, node);
-	} while (node_is_reduced(node));
+	} while (node_is_reduced(pbqp, node));
 
 	assert(pbqp_node_get_degree(node) > 2);
 
@@ -52,10 +52,10 @@ static void merge_into_RN_node(pbqp_t *pbqp, plist_t *rpeo)
 
 static void apply_RN_co(pbqp_t *pbqp)
 {
-	pbqp_node_t *node = merged_node;
-	merged_node = NULL;
+	pbqp_node_t *node = pbqp->merged_node;
+	pbqp->merged_node = NULL;
 
-	if (node_is_reduced(node))
+	if (node_is_reduced(pbqp, node))
 		return;
 
 #if KAPS_DUMP
@@ -83,7 +83,7 @@ static void apply_RN_co(pbqp_t *pbqp)
 #endif
 
 	/* Now that we found the local minimum set all other costs to infinity. */
-	select_alternative(node, min_index);
+	select_alternative(pbqp, node, min_index);
 }
 
 static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
@@ -97,7 +97,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 	#endif
 
 	for (;;) {
-		if (edge_bucket_get_length(edge_bucket) > 0) {
+		if (edge_bucket_get_length(pbqp->edge_bucket) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_edge);
 			#endif
@@ -107,7 +107,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_edge);
 			#endif
-		} else if (node_bucket_get_length(node_buckets[1]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[1]) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_r1);
 			#endif
@@ -117,7 +117,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_r1);
 			#endif
-		} else if (node_bucket_get_length(node_buckets[2]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[2]) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_r2);
 			#endif
@@ -127,7 +127,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_r2);
 			#endif
-		} else if (merged_node != NULL) {
+		} else if (pbqp->merged_node != NULL) {
 			#if KAPS_TIMING
 				ir_timer_start(t_rn);
 			#endif
@@ -137,7 +137,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_rn);
 			#endif
-		} else if (node_bucket_get_length(node_buckets[3]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[3]) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_rn);
 			#endif
@@ -202,5 +202,5 @@ void solve_pbqp_heuristical_co(pbqp_t *pbqp, plist_t *rpeo)
 	/* Solve reduced nodes. */
 	back_propagate(pbqp);
 
-	free_buckets();
+	free_buckets(pbqp);
 }
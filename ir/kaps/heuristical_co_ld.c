@@ -151,10 +151,10 @@ static void back_propagate_ld(pbqp_t *pbqp)
 	}
 #endif
 
-	unsigned node_len = node_bucket_get_length(reduced_bucket);
+	unsigned node_len = node_bucket_get_length(pbqp->reduced_bucket);
 
 	for (unsigned node_index = node_len; node_index-- != 0;) {
-		pbqp_node_t *node = reduced_bucket[node_index];
+		pbqp_node_t *node = pbqp->reduced_bucket[node_index];
 
 		switch (pbqp_node_get_degree(node)) {
 			case 1:
@@ -181,7 +181,7 @@ static void merge_into_RN_node(pbqp_t *pbqp, plist_t *rpeo)
 		plist_erase(rpeo, plist_last(rpeo));
 		/* insert node at the beginning of rpeo so the rpeo already exits after pbqp solving */
 		plist_insert_front(rpeo, node);
-	} while (node_is_reduced(node));
+	} while (node_is_reduced(pbqp, node));
 
 	assert(pbqp_node_get_degree(node) > 2);
 
@@ -193,10 +193,10 @@ static void apply_RN_co_without_selection(pbqp_t *pbqp)
 {
 	(void)pbqp;
 
-	pbqp_node_t *node = merged_node;
-	merged_node = NULL;
+	pbqp_node_t *node = pbqp->merged_node;
+	pbqp->merged_node = NULL;
 
-	if (node_is_reduced(node))
+	if (node_is_reduced(pbqp, node))
 		return;
 
 #if KAPS_DUMP
@@ -224,14 +224,14 @@ static void apply_RN_co_without_selection(pbqp_t *pbqp)
 			continue;
 
 		disconnect_edge(neighbor, edge);
-		reorder_node_after_edge_deletion(neighbor);
+		reorder_node_after_edge_deletion(pbqp, neighbor);
 	}
 
 	/* Remove node from old bucket */
-	node_bucket_remove(&node_buckets[3], node);
+	node_bucket_remove(&pbqp->node_buckets[3], node);
 
 	/* Add node to back propagation list. */
-	node_bucket_insert(&reduced_bucket, node);
+	node_bucket_insert(&pbqp->reduced_bucket, node);
 }
 
 static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
@@ -245,7 +245,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 	#endif
 
 	for (;;) {
-		if (edge_bucket_get_length(edge_bucket) > 0) {
+		if (edge_bucket_get_length(pbqp->edge_bucket) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_edge);
 			#endif
@@ -255,7 +255,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_edge);
 			#endif
-		} else if (node_bucket_get_length(node_buckets[1]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[1]) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_r1);
 			#endif
@@ -265,7 +265,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_r1);
 			#endif
-		} else if (node_bucket_get_length(node_buckets[2]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[2]) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_r2);
 			#endif
@@ -275,7 +275,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_r2);
 			#endif
-		} else if (merged_node != NULL) {
+		} else if (pbqp->merged_node != NULL) {
 			#if KAPS_TIMING
 				ir_timer_start(t_rn);
 			#endif
@@ -285,7 +285,7 @@ static void apply_heuristic_reductions_co(pbqp_t *pbqp, plist_t *rpeo)
 			#if KAPS_TIMING
 				ir_timer_stop(t_rn);
 			#endif
-		} else if (node_bucket_get_length(node_buckets[3]) > 0) {
+		} else if (node_bucket_get_length(pbqp->node_buckets[3]) > 0) {
 			#if KAPS_TIMING
 				ir_timer_start(t_rn);
 			#endif
@@ -350,5 +350,5 @@ void solve_pbqp_heuristical_co_ld(pbqp_t *pbqp, plist_t *rpeo)
 	/* Solve reduced nodes. */
 	back_propagate_ld(pbqp);
 
-	free_buckets();
+	free_buckets(pbqp);
 }
@@ -19,14 +19,12 @@
 #include "html_dumper.h"
 #include "kaps.h"
 
-/* Caution: Due to static buffer use only once per statement */
-static const char *cost2a(num const cost)
+/* Formats a cost into buf, which must hold at least 24 characters. */
+static const char *cost2a(num const cost, char *buf)
 {
 	if (cost == INF_COSTS)
 		return "inf";
 
-	static char buf[10];
-
 #if KAPS_USE_UNSIGNED
 	sprintf(buf, "%u", cost);
 #else
@@ -42,14 +40,15 @@ static void dump_vector(FILE *f, vector_t *vec)
 	unsigned len = vec->len;
 	assert(len > 0);
 
+	char buf[24];
 	fprintf(f, "<span class=\"vector\">( ");
 
 	for (unsigned index = 0; index < len; ++index) {
 #if KAPS_ENABLE_VECTOR_NAMES
 		fprintf(f, "<span title=\"%s\">%s</span> ",
-				vec->entries[index].name, cost2a(vec->entries[index].data));
+				vec->entries[index].name, cost2a(vec->entries[index].data, buf));
 #else
-		fprintf(f, "%s ", cost2a(vec->entries[index].data));
+		fprintf(f, "%s ", cost2a(vec->entries[index].data, buf));
 #endif
 	}
 
@@ -62,14 +61,15 @@ static void dump_matrix(FILE *f, pbqp_matrix_t *mat)
 	assert(mat->rows > 0);
 
 	num *p = mat->entries;
+	char buf[24];
 
 	fprintf(f, "\t\\begin{pmatrix}\n");
 
 	for (unsigned row = 0; row < mat->rows; ++row) {
-		fprintf(f, "\t %s", cost2a(*p++));
+		fprintf(f, "\t %s", cost2a(*p++, buf));
 
 		for (unsigned col = 1; col < mat->cols; ++col) {
-			fprintf(f, "& %s", cost2a(*p++));
+			fprintf(f, "& %s", cost2a(*p++, buf));
 		}
 
 		fprintf(f, "\\\\\n");
@@ -145,7 +145,7 @@ void pbqp_dump_graph(pbqp_t *pbqp)
 	for (unsigned src_index = 0; src_index < pbqp->num_nodes; ++src_index) {
 		pbqp_node_t *node = get_node(pbqp, src_index);
 
-		if (node && !node_is_reduced(node)) {
+		if (node && !node_is_reduced(pbqp, node)) {
 			fprintf(pbqp->dump_file, "\t n%u;\n", src_index);
 		}
 	}
@@ -156,7 +156,7 @@ void pbqp_dump_graph(pbqp_t *pbqp)
 		if (!node)
 			continue;
 
-		if (node_is_reduced(node))
+		if (node_is_reduced(pbqp, node))
 			continue;
 
 		unsigned len = ARR_LEN(node->edges);
@@ -165,7 +165,7 @@ void pbqp_dump_graph(pbqp_t *pbqp)
 			pbqp_node_t *tgt_node  = node->edges[edge_index]->tgt;
 			unsigned     tgt_index = tgt_node->index;
 
-			if (node_is_reduced(tgt_node))
+			if (node_is_reduced(pbqp, tgt_node))
 				continue;
 
 			if (src_index < tgt_index) {
@@ -66,8 +66,16 @@ pbqp_t *alloc_pbqp(unsigned number_nodes)
 	pbqp->dump_file    = NULL;
 #endif
 	pbqp->nodes        = OALLOCNZ(&pbqp->obstack, pbqp_node_t*, number_nodes);
+	pbqp->edge_bucket    = NULL;
+	pbqp->rm_bucket      = NULL;
+	for (int i = 0; i < 4; ++i)
+		pbqp->node_buckets[i] = NULL;
+	pbqp->reduced_bucket = NULL;
+	pbqp->merged_node    = NULL;
+	pbqp->buckets_filled = 0;
 #if KAPS_STATISTIC
 	pbqp->num_bf       = 0;
+	pbqp->bf_depth     = 0;
 	pbqp->num_edges    = 0;
 	pbqp->num_r0       = 0;
 	pbqp->num_r1       = 0;
@@ -69,7 +69,7 @@ void pbqp_matrix_transpose(pbqp_t *pbqp, pbqp_matrix_t *mat)
 	obstack_free(&pbqp->obstack, tmp);
 }
 
-void pbqp_matrix_add(pbqp_matrix_t *sum, pbqp_matrix_t *summand)
+KAPS_KERNEL void pbqp_matrix_add(pbqp_matrix_t *sum, pbqp_matrix_t *summand)
 {
 	assert(sum->cols == summand->cols);
 	assert(sum->rows == summand->rows);
@@ -157,6 +157,34 @@ unsigned pbqp_matrix_get_col_min_index(pbqp_matrix_t *matrix, unsigned col_index
 	return min_index;
 }
 
+KAPS_KERNEL void pbqp_matrix_get_col_mins(pbqp_matrix_t *matrix, vector_t *flags, vector_t *mins)
+{
+	unsigned col_len = matrix->cols;
+	unsigned row_len = matrix->rows;
+
+	assert(row_len == flags->len);
+	assert(col_len == mins->len);
+
+	for (unsigned col_index = 0; col_index < col_len; ++col_index)
+		mins->entries[col_index].data = INF_COSTS;
+
+	/* Walk the rows instead of the columns, so the entries are accessed
+	 * sequentially. */
+	for (unsigned row_index = 0; row_index < row_len; ++row_index) {
+		/* Ignore virtual deleted rows. */
+		if (flags->entries[row_index].data == INF_COSTS) continue;
+
+		num const *row = &matrix->entries[row_index * col_len];
+
+		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
+			num min  = mins->entries[col_index].data;
+			num elem = row[col_index];
+
+			mins->entries[col_index].data = elem < min ? elem : min;
+		}
+	}
+}
+
 void pbqp_matrix_sub_col_value(pbqp_matrix_t *matrix, unsigned col_index,
 		vector_t *flags, num value)
 {
@@ -178,22 +206,22 @@ void pbqp_matrix_sub_col_value(pbqp_matrix_t *matrix, unsigned col_index,
 	}
 }
 
-num pbqp_matrix_get_row_min(pbqp_matrix_t *matrix, unsigned row_index, vector_t *flags)
+KAPS_KERNEL num pbqp_matrix_get_row_min(pbqp_matrix_t *matrix, unsigned row_index, vector_t *flags)
 {
-	num      min = INF_COSTS;
-	unsigned len = flags->len;
+	num        min = INF_COSTS;
+	unsigned   len = flags->len;
+	num const *row = &matrix->entries[row_index * len];
 
 	assert(matrix->cols == len);
 
+	/* No branches, so the compiler vectorizes the loop. */
 	for (unsigned col_index = 0; col_index < len; ++col_index) {
-		/* Ignore virtual deleted columns. */
-		if (flags->entries[col_index].data == INF_COSTS) continue;
-
-		num elem = matrix->entries[row_index * len + col_index];
+		/* Ignore virtual deleted columns by raising them to infinity. */
+		num floor = flags->entries[col_index].data == INF_COSTS ? INF_COSTS : MIN_COSTS;
+		num elem  = row[col_index];
 
-		if (elem < min) {
-			min = elem;
-		}
+		elem = elem > floor ? elem : floor;
+		min  = elem < min ? elem : min;
 	}
 
 	return min;
@@ -201,44 +229,35 @@ num pbqp_matrix_get_row_min(pbqp_matrix_t *matrix, unsigned row_index, vector_t
 
 unsigned pbqp_matrix_get_row_min_index(pbqp_matrix_t *matrix, unsigned row_index, vector_t *flags)
 {
-	unsigned min_index = 0;
-	num      min       = INF_COSTS;
-	unsigned len       = flags->len;
-
-	assert(matrix->cols == len);
+	num        min = pbqp_matrix_get_row_min(matrix, row_index, flags);
+	num const *row = &matrix->entries[row_index * flags->len];
 
-	for (unsigned col_index = 0; col_index < len; ++col_index) {
-		/* Ignore virtual deleted columns. */
-		if (flags->entries[col_index].data == INF_COSTS) continue;
+	/* The first minimum, or 0 if all entries are infinite. */
+	if (min == INF_COSTS)
+		return 0;
 
-		num elem = matrix->entries[row_index * len + col_index];
-
-		if (elem < min) {
-			min = elem;
-			min_index = col_index;
-		}
-	}
+	unsigned min_index = 0;
+	while (flags->entries[min_index].data == INF_COSTS || row[min_index] != min)
+		++min_index;
+	assert(min_index < flags->len);
 
 	return min_index;
 }
 
-void pbqp_matrix_sub_row_value(pbqp_matrix_t *matrix, unsigned row_index,
+KAPS_KERNEL void pbqp_matrix_sub_row_value(pbqp_matrix_t *matrix, unsigned row_index,
 		vector_t *flags, num value)
 {
 	unsigned col_len = matrix->cols;
+	num     *row     = &matrix->entries[row_index * col_len];
 
 	assert(col_len == flags->len);
 
 	for (unsigned col_index = 0; col_index < col_len; ++col_index) {
-		if (flags->entries[col_index].data == INF_COSTS) {
-			matrix->entries[row_index * col_len + col_index] = 0;
-			continue;
-		}
+		num elem = row[col_index];
 		/* inf - x = inf if x < inf */
-		if (matrix->entries[row_index * col_len + col_index] == INF_COSTS && value
-				!= INF_COSTS)
-			continue;
-		matrix->entries[row_index * col_len + col_index] -= value;
+		num diff = elem == INF_COSTS && value != INF_COSTS ? INF_COSTS : elem - value;
+
+		row[col_index] = flags->entries[col_index].data == INF_COSTS ? 0 : diff;
 	}
 }
 
@@ -267,7 +286,7 @@ int pbqp_matrix_is_zero(pbqp_matrix_t *mat, vector_t *src_vec, vector_t *tgt_vec
 	return 1;
 }
 
-void pbqp_matrix_add_to_all_cols(pbqp_matrix_t *mat, vector_t *vec)
+KAPS_KERNEL void pbqp_matrix_add_to_all_cols(pbqp_matrix_t *mat, vector_t *vec)
 {
 	unsigned col_len = mat->cols;
 	unsigned row_len = mat->rows;
@@ -275,16 +294,16 @@ void pbqp_matrix_add_to_all_cols(pbqp_matrix_t *mat, vector_t *vec)
 	assert(row_len == vec->len);
 
 	for (unsigned row_index = 0; row_index < row_len; ++row_index) {
-		num value = vec->entries[row_index].data;
+		num  value = vec->entries[row_index].data;
+		num *row   = &mat->entries[row_index * col_len];
 
 		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
-			mat->entries[row_index * col_len + col_index] = pbqp_add(
-					mat->entries[row_index * col_len + col_index], value);
+			row[col_index] = pbqp_add(row[col_index], value);
 		}
 	}
 }
 
-void pbqp_matrix_add_to_all_rows(pbqp_matrix_t *mat, vector_t *vec)
+KAPS_KERNEL void pbqp_matrix_add_to_all_rows(pbqp_matrix_t *mat, vector_t *vec)
 {
 	unsigned col_len = mat->cols;
 	unsigned row_len = mat->rows;
@@ -292,10 +311,10 @@ void pbqp_matrix_add_to_all_rows(pbqp_matrix_t *mat, vector_t *vec)
 	assert(col_len == vec->len);
 
 	for (unsigned row_index = 0; row_index < row_len; ++row_index) {
-		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
-			num value = vec->entries[col_index].data;
+		num *row = &mat->entries[row_index * col_len];
 
-			mat->entries[row_index * col_len + col_index] = pbqp_add(mat->entries[row_index * col_len + col_index], value);
+		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
+			row[col_index] = pbqp_add(row[col_index], vec->entries[col_index].data);
 		}
 	}
 }
@@ -34,6 +34,8 @@ num pbqp_matrix_get_row_min(pbqp_matrix_t *matrix, unsigned row_index, vector_t
 unsigned pbqp_matrix_get_col_min_index(pbqp_matrix_t *matrix, unsigned col_index, vector_t *flags);
 unsigned pbqp_matrix_get_row_min_index(pbqp_matrix_t *matrix, unsigned row_index, vector_t *flags);
 
+void pbqp_matrix_get_col_mins(pbqp_matrix_t *matrix, vector_t *flags, vector_t *mins);
+
 void pbqp_matrix_set_col_value(pbqp_matrix_t *mat, unsigned col, num value);
 void pbqp_matrix_set_row_value(pbqp_matrix_t *mat, unsigned row, num value);
 
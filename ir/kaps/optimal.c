@@ -30,55 +30,48 @@
 
 #include "timing.h"
 
-pbqp_edge_t **edge_bucket;
-static pbqp_edge_t **rm_bucket;
-pbqp_node_t **node_buckets[4];
-pbqp_node_t **reduced_bucket = NULL;
-pbqp_node_t  *merged_node = NULL;
-static int  buckets_filled = 0;
-
-static void insert_into_edge_bucket(pbqp_edge_t *edge)
+static void insert_into_edge_bucket(pbqp_t *pbqp, pbqp_edge_t *edge)
 {
-	if (edge_bucket_contains(edge_bucket, edge)) {
+	if (edge_bucket_contains(pbqp->edge_bucket, edge)) {
 		/* Edge is already inserted. */
 		return;
 	}
 
-	edge_bucket_insert(&edge_bucket, edge);
+	edge_bucket_insert(&pbqp->edge_bucket, edge);
 }
 
-static void insert_into_rm_bucket(pbqp_edge_t *edge)
+static void insert_into_rm_bucket(pbqp_t *pbqp, pbqp_edge_t *edge)
 {
-	if (edge_bucket_contains(rm_bucket, edge)) {
+	if (edge_bucket_contains(pbqp->rm_bucket, edge)) {
 		/* Edge is already inserted. */
 		return;
 	}
 
-	edge_bucket_insert(&rm_bucket, edge);
+	edge_bucket_insert(&pbqp->rm_bucket, edge);
 }
 
-static void init_buckets(void)
+static void init_buckets(pbqp_t *pbqp)
 {
-	edge_bucket_init(&edge_bucket);
-	edge_bucket_init(&rm_bucket);
-	node_bucket_init(&reduced_bucket);
+	edge_bucket_init(&pbqp->edge_bucket);
+	edge_bucket_init(&pbqp->rm_bucket);
+	node_bucket_init(&pbqp->reduced_bucket);
 
 	for (int i = 0; i < 4; ++i) {
-		node_bucket_init(&node_buckets[i]);
+		node_bucket_init(&pbqp->node_buckets[i]);
 	}
 }
 
-void free_buckets(void)
+void free_buckets(pbqp_t *pbqp)
 {
 	for (int i = 0; i < 4; ++i) {
-		node_bucket_free(&node_buckets[i]);
+		node_bucket_free(&pbqp->node_buckets[i]);
 	}
 
-	edge_bucket_free(&edge_bucket);
-	edge_bucket_free(&rm_bucket);
-	node_bucket_free(&reduced_bucket);
+	edge_bucket_free(&pbqp->edge_bucket);
+	edge_bucket_free(&pbqp->rm_bucket);
+	node_bucket_free(&pbqp->reduced_bucket);
 
-	buckets_filled = 0;
+	pbqp->buckets_filled = 0;
 }
 
 void fill_node_buckets(pbqp_t *pbqp)
@@ -103,10 +96,10 @@ void fill_node_buckets(pbqp_t *pbqp)
 			degree = 3;
 		}
 
-		node_bucket_insert(&node_buckets[degree], node);
+		node_bucket_insert(&pbqp->node_buckets[degree], node);
 	}
 
-	buckets_filled = 1;
+	pbqp->buckets_filled = 1;
 
 	#if KAPS_TIMING
 		ir_timer_stop(t_fill_buckets);
@@ -114,7 +107,7 @@ void fill_node_buckets(pbqp_t *pbqp)
 	#endif
 }
 
-static void normalize_towards_source(pbqp_edge_t *edge)
+static void normalize_towards_source(pbqp_t *pbqp, pbqp_edge_t *edge)
 {
 	pbqp_matrix_t *mat          = edge->costs;
 	pbqp_node_t   *src_node     = edge->src;
@@ -154,13 +147,13 @@ static void normalize_towards_source(pbqp_edge_t *edge)
 			pbqp_edge_t *edge_candidate = src_node->edges[edge_index];
 
 			if (edge_candidate != edge) {
-				insert_into_edge_bucket(edge_candidate);
+				insert_into_edge_bucket(pbqp, edge_candidate);
 			}
 		}
 	}
 }
 
-static void normalize_towards_target(pbqp_edge_t *edge)
+static void normalize_towards_target(pbqp_t *pbqp, pbqp_edge_t *edge)
 {
 	pbqp_matrix_t *mat          = edge->costs;
 	pbqp_node_t   *src_node     = edge->src;
@@ -175,8 +168,11 @@ static void normalize_towards_target(pbqp_edge_t *edge)
 
 
 	/* Normalize towards target node. */
+	vector_t *mins = vector_alloc(pbqp, tgt_len);
+	pbqp_matrix_get_col_mins(mat, src_vec, mins);
+
 	for (unsigned tgt_index = 0; tgt_index < tgt_len; ++tgt_index) {
-		num min = pbqp_matrix_get_col_min(mat, tgt_index, src_vec);
+		num min = mins->entries[tgt_index].data;
 
 		if (min != 0) {
 			if (tgt_vec->entries[tgt_index].data == INF_COSTS) {
@@ -194,6 +190,8 @@ static void normalize_towards_target(pbqp_edge_t *edge)
 		}
 	}
 
+	obstack_free(&pbqp->obstack, mins);
+
 	if (new_infinity) {
 		unsigned edge_len = pbqp_node_get_degree(tgt_node);
 
@@ -201,7 +199,7 @@ static void normalize_towards_target(pbqp_edge_t *edge)
 			pbqp_edge_t *edge_candidate = tgt_node->edges[edge_index];
 
 			if (edge_candidate != edge) {
-				insert_into_edge_bucket(edge_candidate);
+				insert_into_edge_bucket(pbqp, edge_candidate);
 			}
 		}
 	}
@@ -329,16 +327,16 @@ static void merge_source_into_target(pbqp_t *pbqp, pbqp_edge_t *edge)
 		add_edge_costs(pbqp, tgt_node->index, other_node->index, new_matrix);
 
 		if (new_edge == NULL) {
-			reorder_node_after_edge_insertion(tgt_node);
-			reorder_node_after_edge_insertion(other_node);
+			reorder_node_after_edge_insertion(pbqp, tgt_node);
+			reorder_node_after_edge_insertion(pbqp, other_node);
 		}
 
-		delete_edge(old_edge);
+		delete_edge(pbqp, old_edge);
 
 		new_edge = get_edge(pbqp, tgt_node->index, other_node->index);
 		simplify_edge(pbqp, new_edge);
 
-		insert_into_rm_bucket(new_edge);
+		insert_into_rm_bucket(pbqp, new_edge);
 	}
 
 #if KAPS_STATISTIC
@@ -469,16 +467,16 @@ static void merge_target_into_source(pbqp_t *pbqp, pbqp_edge_t *edge)
 		add_edge_costs(pbqp, src_node->index, other_node->index, new_matrix);
 
 		if (new_edge == NULL) {
-			reorder_node_after_edge_insertion(src_node);
-			reorder_node_after_edge_insertion(other_node);
+			reorder_node_after_edge_insertion(pbqp, src_node);
+			reorder_node_after_edge_insertion(pbqp, other_node);
 		}
 
-		delete_edge(old_edge);
+		delete_edge(pbqp, old_edge);
 
 		new_edge = get_edge(pbqp, src_node->index, other_node->index);
 		simplify_edge(pbqp, new_edge);
 
-		insert_into_rm_bucket(new_edge);
+		insert_into_rm_bucket(pbqp, new_edge);
 	}
 
 #if KAPS_STATISTIC
@@ -499,12 +497,12 @@ void apply_RM(pbqp_t *pbqp, pbqp_node_t *node)
 	for (unsigned edge_index = 0; edge_index < edge_len; ++edge_index) {
 		pbqp_edge_t *edge = edges[edge_index];
 
-		insert_into_rm_bucket(edge);
+		insert_into_rm_bucket(pbqp, edge);
 	}
 
 	/* ALAP: Merge neighbors into given node. */
-	while (edge_bucket_get_length(rm_bucket) > 0) {
-		pbqp_edge_t *edge = edge_bucket_pop(&rm_bucket);
+	while (edge_bucket_get_length(pbqp->rm_bucket) > 0) {
+		pbqp_edge_t *edge = edge_bucket_pop(&pbqp->rm_bucket);
 
 		/* If the edge is not deleted: Try a merge. */
 		if (edge->src == node)
@@ -513,16 +511,16 @@ void apply_RM(pbqp_t *pbqp, pbqp_node_t *node)
 			merge_source_into_target(pbqp, edge);
 	}
 
-	merged_node = node;
+	pbqp->merged_node = node;
 }
 
-void reorder_node_after_edge_deletion(pbqp_node_t *node)
+void reorder_node_after_edge_deletion(pbqp_t *pbqp, pbqp_node_t *node)
 {
 	unsigned    degree     = pbqp_node_get_degree(node);
 	/* Assume node lost one incident edge. */
 	unsigned    old_degree = degree + 1;
 
-	if (!buckets_filled)
+	if (!pbqp->buckets_filled)
 		return;
 
 	/* Same bucket as before */
@@ -530,19 +528,19 @@ void reorder_node_after_edge_deletion(pbqp_node_t *node)
 		return;
 
 	/* Delete node from old bucket... */
-	node_bucket_remove(&node_buckets[old_degree], node);
+	node_bucket_remove(&pbqp->node_buckets[old_degree], node);
 
 	/* ..and add to new one. */
-	node_bucket_insert(&node_buckets[degree], node);
+	node_bucket_insert(&pbqp->node_buckets[degree], node);
 }
 
-void reorder_node_after_edge_insertion(pbqp_node_t *node)
+void reorder_node_after_edge_insertion(pbqp_t *pbqp, pbqp_node_t *node)
 {
 	unsigned    degree     = pbqp_node_get_degree(node);
 	/* Assume node lost one incident edge. */
 	unsigned    old_degree = degree - 1;
 
-	if (!buckets_filled)
+	if (!pbqp->buckets_filled)
 		return;
 
 	/* Same bucket as before */
@@ -550,10 +548,10 @@ void reorder_node_after_edge_insertion(pbqp_node_t *node)
 		return;
 
 	/* Delete node from old bucket... */
-	node_bucket_remove(&node_buckets[old_degree], node);
+	node_bucket_remove(&pbqp->node_buckets[old_degree], node);
 
 	/* ..and add to new one. */
-	node_bucket_insert(&node_buckets[degree], node);
+	node_bucket_insert(&pbqp->node_buckets[degree], node);
 }
 
 void simplify_edge(pbqp_t *pbqp, pbqp_edge_t *edge)
@@ -590,8 +588,8 @@ void simplify_edge(pbqp_t *pbqp, pbqp_edge_t *edge)
 	}
 #endif
 
-	normalize_towards_source(edge);
-	normalize_towards_target(edge);
+	normalize_towards_source(pbqp, edge);
+	normalize_towards_target(pbqp, edge);
 
 #if KAPS_DUMP
 	if (pbqp->dump_file) {
@@ -613,7 +611,7 @@ void simplify_edge(pbqp_t *pbqp, pbqp_edge_t *edge)
 		pbqp->num_edges++;
 #endif
 
-		delete_edge(edge);
+		delete_edge(pbqp, edge);
 	}
 }
 
@@ -633,7 +631,7 @@ void initial_simplify_edges(pbqp_t *pbqp)
 
 	unsigned node_len = pbqp->num_nodes;
 
-	init_buckets();
+	init_buckets(pbqp);
 
 	/* First simplify all edges. */
 	for (unsigned node_index = 0; node_index < node_len; ++node_index) {
@@ -681,7 +679,7 @@ num determine_solution(pbqp_t *pbqp)
 #endif
 
 	/* Solve trivial nodes and calculate solution. */
-	unsigned node_len = node_bucket_get_length(node_buckets[0]);
+	unsigned node_len = node_bucket_get_length(pbqp->node_buckets[0]);
 
 #if KAPS_STATISTIC
 	pbqp->num_r0 = node_len;
@@ -690,7 +688,7 @@ num determine_solution(pbqp_t *pbqp)
 	num solution = 0;
 
 	for (unsigned node_index = 0; node_index < node_len; ++node_index) {
-		pbqp_node_t *node = node_buckets[0][node_index];
+		pbqp_node_t *node = pbqp->node_buckets[0][node_index];
 
 		node->solution = vector_get_min_index(node->costs);
 		solution       = pbqp_add(solution, node->costs->entries[node->solution].data);
@@ -821,10 +819,10 @@ void back_propagate(pbqp_t *pbqp)
 	}
 #endif
 
-	unsigned node_len = node_bucket_get_length(reduced_bucket);
+	unsigned node_len = node_bucket_get_length(pbqp->reduced_bucket);
 
 	for (unsigned node_index = node_len; node_index > 0; --node_index) {
-		pbqp_node_t *node = reduced_bucket[node_index - 1];
+		pbqp_node_t *node = pbqp->reduced_bucket[node_index - 1];
 
 		switch (pbqp_node_get_degree(node)) {
 			case 1:
@@ -841,7 +839,7 @@ void back_propagate(pbqp_t *pbqp)
 
 void apply_edge(pbqp_t *pbqp)
 {
-	pbqp_edge_t *edge = edge_bucket_pop(&edge_bucket);
+	pbqp_edge_t *edge = edge_bucket_pop(&pbqp->edge_bucket);
 
 	simplify_edge(pbqp, edge);
 }
@@ -850,7 +848,7 @@ void apply_RI(pbqp_t *pbqp)
 {
 	(void)pbqp;
 
-	pbqp_node_t *node       = node_bucket_pop(&node_buckets[1]);
+	pbqp_node_t *node       = node_bucket_pop(&pbqp->node_buckets[1]);
 	pbqp_edge_t *edge       = node->edges[0];
 	bool         is_src     = edge->src == node;
 	pbqp_node_t *other_node;
@@ -880,10 +878,10 @@ void apply_RI(pbqp_t *pbqp)
 
 	if (is_src) {
 		pbqp_matrix_add_to_all_cols(mat, node->costs);
-		normalize_towards_target(edge);
+		normalize_towards_target(pbqp, edge);
 	} else {
 		pbqp_matrix_add_to_all_rows(mat, node->costs);
-		normalize_towards_source(edge);
+		normalize_towards_source(pbqp, edge);
 	}
 
 	disconnect_edge(other_node, edge);
@@ -895,19 +893,19 @@ void apply_RI(pbqp_t *pbqp)
 	}
 #endif
 
-	reorder_node_after_edge_deletion(other_node);
+	reorder_node_after_edge_deletion(pbqp, other_node);
 
 #if KAPS_STATISTIC
 	pbqp->num_r1++;
 #endif
 
 	/* Add node to back propagation list. */
-	node_bucket_insert(&reduced_bucket, node);
+	node_bucket_insert(&pbqp->reduced_bucket, node);
 }
 
 void apply_RII(pbqp_t *pbqp)
 {
-	pbqp_node_t *node       = node_bucket_pop(&node_buckets[2]);
+	pbqp_node_t *node       = node_bucket_pop(&pbqp->node_buckets[2]);
 	pbqp_edge_t *src_edge   = node->edges[0];
 	bool         src_is_src = src_edge->src == node;
 	pbqp_node_t *src_node;
@@ -969,26 +967,28 @@ void apply_RII(pbqp_t *pbqp)
 	unsigned       row_len  = src_vec->len;
 	pbqp_matrix_t *mat      = pbqp_matrix_alloc(pbqp, row_len, col_len);
 
+	/* Transpose the matrices if needed, so that the costs for the
+	 * alternatives of node are rows and thus sequential in memory. */
+	pbqp_matrix_t *src_rows = src_is_src ? pbqp_matrix_copy_and_transpose(pbqp, src_mat) : src_mat;
+	pbqp_matrix_t *tgt_rows = tgt_is_src ? pbqp_matrix_copy_and_transpose(pbqp, tgt_mat) : tgt_mat;
+
 	for (unsigned row_index = 0; row_index < row_len; ++row_index) {
-		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
-			vector_t *vec = vector_copy(pbqp, node_vec);
+		vector_t *vec = vector_copy(pbqp, node_vec);
 
-			if (src_is_src) {
-				vector_add_matrix_col(vec, src_mat, row_index);
-			} else {
-				vector_add_matrix_row(vec, src_mat, row_index);
-			}
+		vector_add_matrix_row(vec, src_rows, row_index);
 
-			if (tgt_is_src) {
-				vector_add_matrix_col(vec, tgt_mat, col_index);
-			} else {
-				vector_add_matrix_row(vec, tgt_mat, col_index);
-			}
+		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
+			mat->entries[row_index * col_len + col_index] = vector_get_min_sum_matrix_row(vec, tgt_rows, col_index);
+		}
 
-			mat->entries[row_index * col_len + col_index] = vector_get_min(vec);
+		obstack_free(&pbqp->obstack, vec);
+	}
 
-			obstack_free(&pbqp->obstack, vec);
-		}
+	/* Free the transposed matrices. */
+	if (src_is_src) {
+		obstack_free(&pbqp->obstack, src_rows);
+	} else if (tgt_is_src) {
+		obstack_free(&pbqp->obstack, tgt_rows);
 	}
 
 	pbqp_edge_t *edge = get_edge(pbqp, src_node->index, tgt_node->index);
@@ -1002,7 +1002,7 @@ void apply_RII(pbqp_t *pbqp)
 #endif
 
 	/* Add node to back propagation list. */
-	node_bucket_insert(&reduced_bucket, node);
+	node_bucket_insert(&pbqp->reduced_bucket, node);
 
 	if (edge == NULL) {
 		edge = alloc_edge(pbqp, src_node->index, tgt_node->index, mat);
@@ -1013,8 +1013,8 @@ void apply_RII(pbqp_t *pbqp)
 		/* Free local matrix. */
 		obstack_free(&pbqp->obstack, mat);
 
-		reorder_node_after_edge_deletion(src_node);
-		reorder_node_after_edge_deletion(tgt_node);
+		reorder_node_after_edge_deletion(pbqp, src_node);
+		reorder_node_after_edge_deletion(pbqp, tgt_node);
 	}
 
 #if KAPS_DUMP
@@ -1028,7 +1028,7 @@ void apply_RII(pbqp_t *pbqp)
 	simplify_edge(pbqp, edge);
 }
 
-static void select_column(pbqp_edge_t *edge, unsigned col_index)
+static void select_column(pbqp_t *pbqp, pbqp_edge_t *edge, unsigned col_index)
 {
 	pbqp_node_t *src_node = edge->src;
 	pbqp_node_t *tgt_node = edge->tgt;
@@ -1061,15 +1061,15 @@ static void select_column(pbqp_edge_t *edge, unsigned col_index)
 			pbqp_edge_t *edge_candidate = src_node->edges[edge_index];
 
 			if (edge_candidate != edge) {
-				insert_into_edge_bucket(edge_candidate);
+				insert_into_edge_bucket(pbqp, edge_candidate);
 			}
 		}
 	}
 
-	delete_edge(edge);
+	delete_edge(pbqp, edge);
 }
 
-static void select_row(pbqp_edge_t *edge, unsigned row_index)
+static void select_row(pbqp_t *pbqp, pbqp_edge_t *edge, unsigned row_index)
 {
 	pbqp_matrix_t *mat          = edge->costs;
 	pbqp_node_t   *tgt_node     = edge->tgt;
@@ -1097,15 +1097,15 @@ static void select_row(pbqp_edge_t *edge, unsigned row_index)
 			pbqp_edge_t *edge_candidate = tgt_node->edges[edge_index];
 
 			if (edge_candidate != edge) {
-				insert_into_edge_bucket(edge_candidate);
+				insert_into_edge_bucket(pbqp, edge_candidate);
 			}
 		}
 	}
 
-	delete_edge(edge);
+	delete_edge(pbqp, edge);
 }
 
-void select_alternative(pbqp_node_t *node, unsigned selected_index)
+void select_alternative(pbqp_t *pbqp, pbqp_node_t *node, unsigned selected_index)
 {
 	unsigned  max_degree = pbqp_node_get_degree(node);
 	vector_t *node_vec   = node->costs;
@@ -1126,15 +1126,15 @@ void select_alternative(pbqp_node_t *node, unsigned selected_index)
 		pbqp_edge_t *edge = node->edges[edge_index];
 
 		if (edge->src == node)
-			select_row(edge, selected_index);
+			select_row(pbqp, edge, selected_index);
 		else
-			select_column(edge, selected_index);
+			select_column(pbqp, edge, selected_index);
 	}
 }
 
-pbqp_node_t *get_node_with_max_degree(void)
+pbqp_node_t *get_node_with_max_degree(pbqp_t *pbqp)
 {
-	pbqp_node_t **bucket     = node_buckets[3];
+	pbqp_node_t **bucket     = pbqp->node_buckets[3];
 	unsigned      bucket_len = node_bucket_get_length(bucket);
 	unsigned      max_degree = 0;
 	pbqp_node_t  *result     = NULL;
@@ -1191,13 +1191,13 @@ unsigned get_local_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node)
 	return min_index;
 }
 
-int node_is_reduced(pbqp_node_t *node)
+int node_is_reduced(pbqp_t *pbqp, pbqp_node_t *node)
 {
-	if (!reduced_bucket)
+	if (!pbqp->reduced_bucket)
 		return 0;
 
 	if (pbqp_node_get_degree(node) == 0)
 		return 1;
 
-	return node_bucket_contains(reduced_bucket, node);
+	return node_bucket_contains(pbqp->reduced_bucket, node);
 }
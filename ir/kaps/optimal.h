@@ -14,11 +14,6 @@
 
 #include "pbqp_t.h"
 
-extern pbqp_edge_t **edge_bucket;
-extern pbqp_node_t **node_buckets[4];
-extern pbqp_node_t **reduced_bucket;
-extern pbqp_node_t  *merged_node;
-
 void apply_edge(pbqp_t *pbqp);
 
 void apply_RI(pbqp_t *pbqp);
@@ -28,15 +23,15 @@ void apply_RM(pbqp_t *pbqp, pbqp_node_t *node);
 void back_propagate(pbqp_t *pbqp);
 num determine_solution(pbqp_t *pbqp);
 void fill_node_buckets(pbqp_t *pbqp);
-void free_buckets(void);
+void free_buckets(pbqp_t *pbqp);
 unsigned get_local_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node);
-pbqp_node_t *get_node_with_max_degree(void);
+pbqp_node_t *get_node_with_max_degree(pbqp_t *pbqp);
 void initial_simplify_edges(pbqp_t *pbqp);
-void select_alternative(pbqp_node_t *node, unsigned selected_index);
+void select_alternative(pbqp_t *pbqp, pbqp_node_t *node, unsigned selected_index);
 void simplify_edge(pbqp_t *pbqp, pbqp_edge_t *edge);
-void reorder_node_after_edge_deletion(pbqp_node_t *node);
-void reorder_node_after_edge_insertion(pbqp_node_t *node);
+void reorder_node_after_edge_deletion(pbqp_t *pbqp, pbqp_node_t *node);
+void reorder_node_after_edge_insertion(pbqp_t *pbqp, pbqp_node_t *node);
 
-int node_is_reduced(pbqp_node_t *node);
+int node_is_reduced(pbqp_t *pbqp, pbqp_node_t *node);
 
 #endif
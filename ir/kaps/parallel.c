@@ -0,0 +1,101 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Solving independent PBQP instances in parallel.
+ */
+#ifdef FIRM_THREADS
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#endif
+
+#include "util.h"
+#include "xmalloc.h"
+
+#include "parallel.h"
+
+typedef struct solve_env_t {
+	size_t                 n_pbqps;
+	pbqp_t         *const *pbqps;
+	void           *const *data;
+	pbqp_solve_func        solve;
+	size_t                 next;  /**< next instance to solve */
+#ifdef FIRM_THREADS
+	pthread_mutex_t        lock;  /**< protects next */
+#endif
+} solve_env_t;
+
+static void solve_one(solve_env_t *env, size_t index)
+{
+	env->solve(env->pbqps[index], env->data != NULL ? env->data[index] : NULL);
+}
+
+#ifdef FIRM_THREADS
+/**
+ * Takes the next unsolved instance, returns false if there is none.
+ */
+static bool take_pbqp(solve_env_t *env, size_t *index)
+{
+	pthread_mutex_lock(&env->lock);
+	size_t const next  = env->next;
+	bool   const found = next < env->n_pbqps;
+	if (found)
+		env->next = next + 1;
+	pthread_mutex_unlock(&env->lock);
+	*index = next;
+	return found;
+}
+
+static void *solve_worker(void *ptr)
+{
+	solve_env_t *const env = (solve_env_t*)ptr;
+	size_t             index;
+	while (take_pbqp(env, &index))
+		solve_one(env, index);
+	return NULL;
+}
+#endif
+
+void solve_pbqps_parallel(size_t n_pbqps, pbqp_t *const *pbqps,
+                          void *const *data, pbqp_solve_func solve,
+                          unsigned n_threads)
+{
+	solve_env_t env = {
+		.n_pbqps = n_pbqps,
+		.pbqps   = pbqps,
+		.data    = data,
+		.solve   = solve,
+		.next    = 0,
+	};
+
+#ifdef FIRM_THREADS
+	size_t const n_workers = MIN((size_t)n_threads, n_pbqps);
+	if (n_workers > 1) {
+		pthread_mutex_init(&env.lock, NULL);
+
+		/* the calling thread is a worker, too */
+		pthread_t *const threads   = XMALLOCN(pthread_t, n_workers - 1);
+		size_t           n_started = 0;
+		for (; n_started < n_workers - 1; ++n_started) {
+			/* the other workers take over if a thread cannot be created */
+			if (pthread_create(&threads[n_started], NULL, solve_worker, &env) != 0)
+				break;
+		}
+		solve_worker(&env);
+		for (size_t i = 0; i < n_started; ++i)
+			pthread_join(threads[i], NULL);
+		free(threads);
+
+		pthread_mutex_destroy(&env.lock);
+		return;
+	}
+#else
+	(void)n_threads;
+#endif
+
+	for (size_t i = 0; i < n_pbqps; ++i)
+		solve_one(&env, i);
+}
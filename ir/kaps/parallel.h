@@ -0,0 +1,45 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Solving independent PBQP instances in parallel.
+ *
+ * All state of the solvers lives in the pbqp_t, so instances which share no
+ * nodes can be solved at the same time. Each instance is solved by exactly
+ * one thread, so the solutions do not depend on the number of threads.
+ */
+#ifndef KAPS_PARALLEL_H
+#define KAPS_PARALLEL_H
+
+#include <stddef.h>
+
+#include "pbqp_t.h"
+
+/**
+ * Solves a single PBQP instance.
+ *
+ * @param pbqp  the instance
+ * @param data  the data given for the instance
+ */
+typedef void (*pbqp_solve_func)(pbqp_t *pbqp, void *data);
+
+/**
+ * Solves PBQP instances with up to @p n_threads threads, the calling thread
+ * is one of them. Returns after all instances are solved.
+ *
+ * @param n_pbqps    number of instances
+ * @param pbqps      the instances
+ * @param data       data passed to @p solve for each instance, may be NULL
+ * @param solve      the solver
+ * @param n_threads  maximal number of threads, 0 and 1 solve the instances
+ *                   one after another in the calling thread. Without
+ *                   FIRM_THREADS the instances are always solved this way.
+ */
+void solve_pbqps_parallel(size_t n_pbqps, pbqp_t *const *pbqps,
+                          void *const *data, pbqp_solve_func solve,
+                          unsigned n_threads);
+
+#endif
@@ -58,7 +58,7 @@ pbqp_edge_t *alloc_edge(pbqp_t *pbqp, unsigned src_index, unsigned tgt_index,
 	return edge;
 }
 
-void delete_edge(pbqp_edge_t *edge)
+void delete_edge(pbqp_t *pbqp, pbqp_edge_t *edge)
 {
 	pbqp_node_t *src_node = edge->src;
 	pbqp_node_t *tgt_node = edge->tgt;
@@ -69,8 +69,8 @@ void delete_edge(pbqp_edge_t *edge)
 	edge->src = NULL;
 	edge->tgt = NULL;
 
-	reorder_node_after_edge_deletion(src_node);
-	reorder_node_after_edge_deletion(tgt_node);
+	reorder_node_after_edge_deletion(pbqp, src_node);
+	reorder_node_after_edge_deletion(pbqp, tgt_node);
 }
 
 unsigned is_deleted(pbqp_edge_t *edge)
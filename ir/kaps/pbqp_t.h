@@ -27,9 +27,21 @@
 #if KAPS_USE_UNSIGNED
 	typedef unsigned num;
 	#define INF_COSTS UINT_MAX
+	#define MIN_COSTS 0
 #else
 	typedef intmax_t num;
 	#define INF_COSTS INTMAX_MAX
+	#define MIN_COSTS INTMAX_MIN
+#endif
+
+/* The loops over costs are written so that the compiler vectorizes them. Where
+ * the target supports it, the functions with these loops are compiled for
+ * AVX2, too, and the variant is selected when the program is loaded. */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 6 \
+	&& defined(__x86_64__) && defined(__GLIBC__)
+	#define KAPS_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+	#define KAPS_KERNEL
 #endif
 
 #include "matrix_t.h"
@@ -45,8 +57,15 @@ struct pbqp_t {
 	size_t         num_nodes;          /* Number of PBQP nodes. */
 	pbqp_node_t  **nodes;              /* Nodes of PBQP. */
 	FILE          *dump_file;          /* File to dump in. */
+	pbqp_edge_t  **edge_bucket;        /* Edges to simplify. */
+	pbqp_edge_t  **rm_bucket;          /* Edges to merge by RM. */
+	pbqp_node_t  **node_buckets[4];    /* Unreduced nodes by degree (>= 3 in the last). */
+	pbqp_node_t  **reduced_bucket;     /* Reduced nodes in reduction order. */
+	pbqp_node_t   *merged_node;        /* Node of the last RM reduction. */
+	int            buckets_filled;     /* Are the node buckets filled? */
 #if KAPS_STATISTIC
 	unsigned       num_bf;             /* Number of brute force reductions. */
+	unsigned       bf_depth;           /* Nesting of brute force reductions. */
 	unsigned       num_edges;          /* Number of independent edges. */
 	unsigned       num_r0;             /* Number of trivial solved nodes. */
 	unsigned       num_r1;             /* Number of R1 reductions. */
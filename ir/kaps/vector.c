@@ -15,29 +15,6 @@
 
 #include "vector.h"
 
-num pbqp_add(num x, num y)
-{
-	if (x == INF_COSTS || y == INF_COSTS)
-		return INF_COSTS;
-
-	num res = x + y;
-
-#if !KAPS_USE_UNSIGNED
-	/* No positive overflow. */
-	assert(x < 0 || y < 0 || res >= x);
-	assert(x < 0 || y < 0 || res >= y);
-#endif
-
-	/* No negative overflow. */
-	assert(x > 0 || y > 0 || res <= x);
-	assert(x > 0 || y > 0 || res <= y);
-
-	/* Result is not infinity.*/
-	assert(res < INF_COSTS);
-
-	return res;
-}
-
 vector_t *vector_alloc(pbqp_t *pbqp, unsigned length)
 {
 	vector_t *vec = (vector_t *)obstack_alloc(&pbqp->obstack, sizeof(*vec) + sizeof(*vec->entries) * length);
@@ -58,7 +35,7 @@ vector_t *vector_copy(pbqp_t *pbqp, vector_t *v)
 	return copy;
 }
 
-void vector_add(vector_t *sum, vector_t *summand)
+KAPS_KERNEL void vector_add(vector_t *sum, vector_t *summand)
 {
 	unsigned len = sum->len;
 
@@ -104,53 +81,69 @@ void vector_add_matrix_col(vector_t *vec, pbqp_matrix_t *mat, unsigned col_index
 	}
 }
 
-void vector_add_matrix_row(vector_t *vec, pbqp_matrix_t *mat, unsigned row_index)
+KAPS_KERNEL void vector_add_matrix_row(vector_t *vec, pbqp_matrix_t *mat, unsigned row_index)
 {
 	unsigned len = vec->len;
 
 	assert(len == mat->cols);
 	assert(row_index < mat->rows);
 
+	num const *row = &mat->entries[row_index * len];
 
 	for (unsigned index = 0; index < len; ++index) {
-		vec->entries[index].data = pbqp_add(vec->entries[index].data, mat->entries[row_index * mat->cols + index]);
+		vec->entries[index].data = pbqp_add(vec->entries[index].data, row[index]);
 	}
 }
 
-num vector_get_min(vector_t *vec)
+KAPS_KERNEL num vector_get_min(vector_t *vec)
 {
 	unsigned len = vec->len;
 	num      min = INF_COSTS;
 
 	assert(len > 0);
 
+	/* No branches, so the compiler vectorizes the loop. */
 	for (unsigned index = 0; index < len; ++index) {
 		num elem = vec->entries[index].data;
 
-		if (elem < min) {
-			min = elem;
-		}
+		min = elem < min ? elem : min;
 	}
 
 	return min;
 }
 
-unsigned vector_get_min_index(vector_t *vec)
+KAPS_KERNEL num vector_get_min_sum_matrix_row(vector_t *vec, pbqp_matrix_t *mat, unsigned row_index)
 {
-	unsigned len       = vec->len;
-	unsigned min_index = 0;
-	num      min       = INF_COSTS;
+	unsigned   len = vec->len;
+	num const *row = &mat->entries[row_index * mat->cols];
+	num        min = INF_COSTS;
 
-	assert(len > 0);
+	assert(len == mat->cols);
+	assert(row_index < mat->rows);
 
 	for (unsigned index = 0; index < len; ++index) {
-		num elem = vec->entries[index].data;
+		num elem = pbqp_add(vec->entries[index].data, row[index]);
 
-		if (elem < min) {
-			min = elem;
-			min_index = index;
-		}
+		min = elem < min ? elem : min;
 	}
 
+	return min;
+}
+
+unsigned vector_get_min_index(vector_t *vec)
+{
+	unsigned len = vec->len;
+	num      min = vector_get_min(vec);
+
+	/* The first minimum, or 0 if all entries are infinite. */
+	if (min == INF_COSTS)
+		return 0;
+
+	unsigned min_index = 0;
+	while (vec->entries[min_index].data != min)
+		++min_index;
+	assert(min_index < len);
+	(void)len;
+
 	return min_index;
 }
@@ -12,9 +12,39 @@
 #ifndef KAPS_VECTOR_H
 #define KAPS_VECTOR_H
 
+#include <assert.h>
+
 #include "vector_t.h"
 
-num pbqp_add(num x, num y);
+static inline num pbqp_add(num x, num y)
+{
+#if KAPS_USE_UNSIGNED
+	/* Finite sums stay below INF_COSTS, so the sum wraps around (or is
+	 * INF_COSTS) exactly if one of the costs is infinite. Without a branch the
+	 * loops adding costs are vectorized. */
+	num res = x + y;
+	assert((x == INF_COSTS || y == INF_COSTS) == (res < x || res == INF_COSTS));
+	return res | -(num)(res < x);
+#else
+	if (x == INF_COSTS || y == INF_COSTS)
+		return INF_COSTS;
+
+	num res = x + y;
+
+	/* No positive overflow. */
+	assert(x < 0 || y < 0 || res >= x);
+	assert(x < 0 || y < 0 || res >= y);
+
+	/* No negative overflow. */
+	assert(x > 0 || y > 0 || res <= x);
+	assert(x > 0 || y > 0 || res <= y);
+
+	/* Result is not infinity.*/
+	assert(res < INF_COSTS);
+
+	return res;
+#endif
+}
 
 vector_t *vector_alloc(pbqp_t *pbqp, unsigned length);
 
@@ -36,6 +66,7 @@ void vector_add_matrix_col(vector_t *vec, pbqp_matrix_t *mat, unsigned col_index
 void vector_add_matrix_row(vector_t *vec, pbqp_matrix_t *mat, unsigned row_index);
 
 num vector_get_min(vector_t *vec);
+num vector_get_min_sum_matrix_row(vector_t *vec, pbqp_matrix_t *mat, unsigned row_index);
 unsigned vector_get_min_index(vector_t *vec);
 
 #endif
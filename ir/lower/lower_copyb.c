@@ -19,6 +19,7 @@
 #include "panic.h"
 #include "be.h"
 #include "util.h"
+#include "timing_t.h"
 
 static unsigned max_small_size; /**< The maximum size of a CopyB node
                                      so that it is regarded as 'small'. */
@@ -177,6 +178,7 @@ static void find_copyb_nodes(ir_node *irn, void *ctx)
 void lower_CopyB(ir_graph *irg, unsigned max_small_sz, unsigned min_large_sz,
                  int allow_misaligns)
 {
+	ir_pass_begin(irg, "lower_CopyB");
 	const backend_params *bparams = be_get_backend_param();
 
 	assert(max_small_sz < min_large_sz && "CopyB size ranges must not overlap");
@@ -198,4 +200,5 @@ void lower_CopyB(ir_graph *irg, unsigned max_small_sz, unsigned min_large_sz,
 	                                    : IR_GRAPH_PROPERTIES_ALL);
 
 	DEL_ARR_F(env.copybs);
+	ir_pass_end("lower_CopyB");
 }
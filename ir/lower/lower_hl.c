@@ -18,6 +18,7 @@
 #include "irhooks.h"
 #include "irgmod.h"
 #include "irgwalk.h"
+#include "timing_t.h"
 
 /**
  * Lower a Sel node. Do not touch Sels accessing entities on the frame type.
@@ -151,10 +152,12 @@ static void lower_irnode(ir_node *irn, void *env)
 
 void lower_highlevel_graph(ir_graph *irg)
 {
+	ir_pass_begin(irg, "lower_highlevel_graph");
 	/* Finally: lower Offset/TypeConst-size and Sel nodes, unaligned Load/Stores. */
 	irg_walk_graph(irg, NULL, lower_irnode, NULL);
 
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_end("lower_highlevel_graph");
 }
 
 /*
@@ -162,13 +165,17 @@ void lower_highlevel_graph(ir_graph *irg)
  */
 void lower_const_code(void)
 {
+	ir_pass_begin(NULL, "lower_const_code");
 	walk_const_code(NULL, lower_irnode, NULL);
+	ir_pass_end("lower_const_code");
 }
 
 void lower_highlevel()
 {
+	ir_pass_begin(NULL, "lower_highlevel");
 	foreach_irp_irg(i, irg) {
 		lower_highlevel_graph(irg);
 	}
 	lower_const_code();
+	ir_pass_end("lower_highlevel");
 }
@@ -27,6 +27,7 @@
 #include "be.h"
 #include "util.h"
 #include "tv_t.h"
+#include "timing_t.h"
 
 /** Walker environment. */
 struct ir_intrinsics_map {
@@ -101,6 +102,7 @@ static void call_mapper(ir_node *node, void *data)
 
 void ir_lower_intrinsics(ir_graph *irg, ir_intrinsics_map *map)
 {
+	ir_pass_begin(irg, "ir_lower_intrinsics");
 	if (map->part_block_used) {
 		ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_PHI_LIST);
 		collect_phiprojs_and_start_block_nodes(irg);
@@ -112,6 +114,7 @@ void ir_lower_intrinsics(ir_graph *irg, ir_intrinsics_map *map)
 	if (map->n_intrinsics > 0) {
 		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 	}
+	ir_pass_end("ir_lower_intrinsics");
 }
 
 /**
@@ -18,6 +18,7 @@
 #include "irgmod.h"
 #include "ircons.h"
 #include "util.h"
+#include "timing_t.h"
 
 typedef struct walk_env {
 	lower_mux_callback *cb_func;
@@ -83,6 +84,7 @@ static void lower_mux_node(ir_node* mux)
 
 void lower_mux(ir_graph *irg, lower_mux_callback *cb_func)
 {
+	ir_pass_begin(irg, "lower_mux");
 	/* Scan the graph for mux nodes to lower. */
 	walk_env_t env;
 	env.cb_func = cb_func;
@@ -107,4 +109,5 @@ void lower_mux(ir_graph *irg, lower_mux_callback *cb_func)
 		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 	}
 	DEL_ARR_F(env.muxes);
+	ir_pass_end("lower_mux");
 }
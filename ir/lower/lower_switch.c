@@ -7,10 +7,24 @@
  * @file
  * @brief   Lowering of Switches if necessary or advantageous.
  * @author  Moritz Kroll
+ *
+ * A lowered switch is split into clusters of cases: dense ranges become
+ * smaller jump tables, cases with few different targets in a range smaller
+ * than a machine word are tested with a shifted bit mask, the remaining cases
+ * are compared one by one. The clusters are arranged in a binary search
+ * tree. It is balanced by the execution frequencies of the cases instead of
+ * their number and a case taken in most executions of the switch is tested
+ * first. Graphs without frequencies are balanced by the number of cases.
+ * This is the case in the backends: they lower switches before they
+ * estimate the frequencies or read the profile, so a profile does not
+ * weight the tree there.
  */
+#include <math.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "array.h"
+#include "execfreq.h"
 #include "ircons.h"
 #include "irgopt.h"
 #include "irgwalk.h"
@@ -20,6 +34,7 @@
 #include "lowering.h"
 #include "panic.h"
 #include "util.h"
+#include "timing_t.h"
 
 typedef struct walk_env_t {
 	ir_nodeset_t  processed;
@@ -29,10 +44,17 @@ typedef struct walk_env_t {
 	bool          changed;    /**< indicates whether a change was performed */
 } walk_env_t;
 
+/** Cases taken in at least this fraction of the executions of a switch are
+ * tested before all others. */
+#define DOMINANT_CASE_PROB   0.5
+/** Maximum number of different targets of a bit test cluster. */
+#define BIT_TEST_MAX_TARGETS 3
+
 typedef struct target_t {
-	ir_node *block;     /**< block that is targetted */
-	uint16_t n_entries; /**< number of table entries targetting this block */
-	uint16_t i;
+	ir_node  *block;     /**< block that is targetted */
+	uint16_t  n_entries; /**< number of table entries targetting this block */
+	double    freq;      /**< execution frequency of the edge to the block */
+	ir_node **preds;     /**< new control flow into the block, ARR_F */
 } target_t;
 
 typedef struct switch_info_t {
@@ -41,10 +63,29 @@ typedef struct switch_info_t {
 	ir_tarval   *switch_max;
 	ir_node     *default_block;
 	unsigned     num_cases;
+	unsigned     n_targets;
 	target_t    *targets;
 	ir_node    **defusers;    /**< the Projs pointing to the default case */
+	double       switch_freq; /**< execution frequency of the switch, 0 if
+	                               the graph has no frequencies */
 } switch_info_t;
 
+typedef enum cluster_kind_t {
+	CLUSTER_CASE,     /**< a single table entry compared directly */
+	CLUSTER_BIT_TEST, /**< entries tested with a shifted bit mask */
+	CLUSTER_TABLE,    /**< entries dispatched by a jump table */
+} cluster_kind_t;
+
+/** Consecutive table entries lowered together. */
+typedef struct case_cluster_t {
+	cluster_kind_t               kind;
+	const ir_switch_table_entry *entries;   /**< the first entry */
+	size_t                       n_entries;
+	ir_tarval                   *min;       /**< smallest value */
+	ir_tarval                   *max;       /**< largest value */
+	double                       weight;    /**< summed frequencies */
+} case_cluster_t;
+
 /**
  * analyze enough to decide if we should lower the switch
  */
@@ -77,14 +118,34 @@ static void analyse_switch0(switch_info_t *info, ir_node *switchn)
 	info->num_cases  = num_cases;
 }
 
+/**
+ * Returns the execution frequency of the edge from a switch to @p block.
+ * Blocks created by splitting critical edges have no frequency yet, so the
+ * one of their successor is used.
+ */
+static double get_target_freq(const ir_node *block, double switch_freq)
+{
+	double freq = get_block_execfreq(block);
+	if (freq == 0.0) {
+		foreach_irn_out_r(block, i, node) {
+			if (is_Jmp(node)) {
+				freq = get_block_execfreq(get_irn_out(node, 0));
+				break;
+			}
+		}
+	}
+	return MIN(freq, switch_freq);
+}
+
 /**
  * Analyse the stuff that anayse_switch0() left out
  */
 static void analyse_switch1(switch_info_t *info)
 {
-	const ir_node  *switchn   = info->switchn;
-	unsigned        n_outs    = get_Switch_n_outs(switchn);
-	target_t       *targets   = XMALLOCNZ(target_t, n_outs);
+	const ir_node  *switchn     = info->switchn;
+	unsigned        n_outs      = get_Switch_n_outs(switchn);
+	target_t       *targets     = XMALLOCNZ(target_t, n_outs);
+	double          switch_freq = get_block_execfreq(get_nodes_block(switchn));
 	foreach_irn_out_r(switchn, i, proj) {
 		unsigned pn     = get_Proj_num(proj);
 		ir_node *target = get_irn_out(proj, 0);
@@ -92,6 +153,8 @@ static void analyse_switch1(switch_info_t *info)
 		assert((unsigned)pn < n_outs);
 		assert(targets[(unsigned)pn].block == NULL);
 		targets[(unsigned)pn].block = target;
+		targets[(unsigned)pn].freq  = get_target_freq(target, switch_freq);
+		targets[(unsigned)pn].preds = NEW_ARR_F(ir_node*, 0);
 	}
 
 	const ir_switch_table *table = get_Switch_table(switchn);
@@ -107,7 +170,9 @@ static void analyse_switch1(switch_info_t *info)
 	}
 
 	info->default_block = targets[pn_Switch_default].block;
+	info->n_targets     = n_outs;
 	info->targets       = targets;
+	info->switch_freq   = switch_freq;
 }
 
 static int compare_entries(const void *a, const void *b)
@@ -270,6 +335,49 @@ static bool normalize_switch(switch_info_t *info, ir_mode *selector_mode)
 	return true;
 }
 
+/**
+ * Returns the difference of @p max and @p min as an unsigned value.
+ */
+static ir_tarval *get_span(ir_tarval *min, ir_tarval *max)
+{
+	ir_mode *const mode = find_unsigned_mode(get_tarval_mode(min));
+	return tarval_sub(tarval_convert_to(max, mode),
+	                  tarval_convert_to(min, mode));
+}
+
+static bool span_less(ir_tarval *span, unsigned long limit)
+{
+	ir_mode   *const mode = get_tarval_mode(span);
+	ir_tarval *const tv   = new_tarval_from_long(limit, mode);
+	return tarval_cmp(span, tv) == ir_relation_less;
+}
+
+/**
+ * Create an if (min <= selector && selector <= max) Cond node. The unsigned
+ * value of selector - min is returned in @p index.
+ */
+static ir_node *create_range_cond(ir_tarval *min, ir_tarval *max,
+                                  dbg_info *dbgi, ir_node *block,
+                                  ir_node *selector, ir_node **index)
+{
+	ir_graph *irg  = get_irn_irg(block);
+	ir_mode  *mode = find_unsigned_mode(get_irn_mode(selector));
+	if (get_irn_mode(selector) != mode)
+		selector = new_rd_Conv(dbgi, block, selector, mode);
+
+	ir_tarval *umin = tarval_convert_to(min, mode);
+	if (!tarval_is_null(umin)) {
+		ir_node *minconst = new_r_Const(irg, umin);
+		selector = new_rd_Sub(dbgi, block, selector, minconst, mode);
+	}
+	ir_node *maxconst = new_r_Const(irg, get_span(min, max));
+	ir_node *cmp      = new_rd_Cmp(dbgi, block, selector, maxconst,
+	                               ir_relation_less_equal);
+	if (index != NULL)
+		*index = selector;
+	return new_rd_Cond(dbgi, block, cmp);
+}
+
 /**
  * Create an if (selector == caseval) Cond node (and handle the special case
  * of ranged cases)
@@ -278,88 +386,354 @@ static ir_node *create_case_cond(const ir_switch_table_entry *entry,
                                  dbg_info *dbgi, ir_node *block,
                                  ir_node *selector)
 {
+	if (entry->min != entry->max)
+		return create_range_cond(entry->min, entry->max, dbgi, block,
+		                         selector, NULL);
+
 	ir_graph *irg      = get_irn_irg(block);
 	ir_node  *minconst = new_r_Const(irg, entry->min);
+	ir_node  *cmp      = new_rd_Cmp(dbgi, block, selector, minconst,
+	                                ir_relation_equal);
+	return new_rd_Cond(dbgi, block, cmp);
+}
+
+static void connect_to_target(target_t *target, ir_node *cf)
+{
+	ARR_APP1(ir_node*, target->preds, cf);
+}
 
-	ir_node  *cmp;
-	if (entry->min == entry->max) {
-		cmp = new_rd_Cmp(dbgi, block, selector, minconst, ir_relation_equal);
+/**
+ * Connects @p cf to @p target through a new block, so the edge is not
+ * critical.
+ */
+static void connect_to_target_split(target_t *target, ir_node *cf)
+{
+	ir_node *in[]  = { cf };
+	ir_node *block = new_r_Block(get_irn_irg(cf), ARRAY_SIZE(in), in);
+	connect_to_target(target, new_r_Jmp(block));
+}
+
+static double get_entry_weight(const switch_info_t *info,
+                               const ir_switch_table_entry *entry)
+{
+	if (info->switch_freq == 0.0)
+		return 1.0;
+	const target_t *target = &info->targets[entry->pn];
+	return target->freq / target->n_entries;
+}
+
+/**
+ * Returns the number of entries starting at @p entries, which are dense
+ * enough for a jump table, or 0 if there are too few of them.
+ */
+static size_t find_table_cluster(const walk_env_t *env,
+                                 const ir_switch_table_entry *entries,
+                                 size_t n_entries)
+{
+	size_t len = 1;
+	for (; len < n_entries; ++len) {
+		ir_tarval *span  = get_span(entries[0].min, entries[len].max);
+		ir_mode   *mode  = get_tarval_mode(span);
+		ir_tarval *spare = tarval_sub(span, new_tarval_from_long(len, mode));
+		if (!span_less(spare, env->spare_size))
+			break;
+	}
+	return len > env->small_switch ? len : 0;
+}
+
+/**
+ * Returns the number of entries starting at @p entries, which can be tested
+ * with a shifted bit mask, or 0 if this needs more operations than comparing
+ * them.
+ */
+static size_t find_bit_test_cluster(const walk_env_t *env,
+                                    const ir_switch_table_entry *entries,
+                                    size_t n_entries)
+{
+	unsigned const bits = get_mode_size_bits(env->selector_mode);
+	unsigned       pns[BIT_TEST_MAX_TARGETS];
+	unsigned       n_pns = 0;
+	size_t         len   = 0;
+	for (; len < n_entries; ++len) {
+		if (!span_less(get_span(entries[0].min, entries[len].max), bits))
+			break;
+
+		unsigned const pn = entries[len].pn;
+		unsigned       p  = 0;
+		while (p < n_pns && pns[p] != pn)
+			++p;
+		if (p == n_pns) {
+			if (n_pns == BIT_TEST_MAX_TARGETS)
+				break;
+			pns[n_pns++] = pn;
+		}
+	}
+
+	/* a bit test costs about as much as comparing 2 entries per target */
+	static const size_t min_entries[] = { 1, 3, 5, 6 };
+	return len >= min_entries[n_pns] ? len : 0;
+}
+
+/**
+ * Groups the sorted @p entries into clusters.
+ */
+static case_cluster_t *create_clusters(const switch_info_t *info,
+                                       const walk_env_t *env,
+                                       const ir_switch_table_entry *entries,
+                                       size_t n_entries)
+{
+	case_cluster_t *clusters = NEW_ARR_F(case_cluster_t, 0);
+	for (size_t i = 0; i < n_entries;) {
+		/* prefer bit tests, they need no indirect jump */
+		cluster_kind_t kind      = CLUSTER_BIT_TEST;
+		size_t         len       = find_bit_test_cluster(env, &entries[i],
+		                                                 n_entries - i);
+		size_t const   table_len = find_table_cluster(env, &entries[i],
+		                                              n_entries - i);
+		if (table_len > len) {
+			kind = CLUSTER_TABLE;
+			len  = table_len;
+		}
+		if (len == 0) {
+			kind = CLUSTER_CASE;
+			len  = 1;
+		}
+
+		double weight = 0.0;
+		for (size_t e = i; e < i + len; ++e)
+			weight += get_entry_weight(info, &entries[e]);
+
+		case_cluster_t const cluster = {
+			.kind      = kind,
+			.entries   = &entries[i],
+			.n_entries = len,
+			.min       = entries[i].min,
+			.max       = entries[i + len - 1].max,
+			.weight    = weight,
+		};
+		ARR_APP1(case_cluster_t, clusters, cluster);
+		i += len;
+	}
+	return clusters;
+}
+
+typedef struct bit_test_t {
+	unsigned   pn;
+	ir_tarval *mask;
+	double     weight;
+} bit_test_t;
+
+static int compare_bit_tests(const void *a, const void *b)
+{
+	const bit_test_t *test0 = (const bit_test_t*)a;
+	const bit_test_t *test1 = (const bit_test_t*)b;
+	if (test0->weight != test1->weight)
+		return test0->weight > test1->weight ? -1 : 1;
+	return QSORT_CMP(test0->pn, test1->pn);
+}
+
+/**
+ * Creates "if ((1 << index) & mask) goto target;" for each target of the
+ * cluster, the most frequent first.
+ */
+static void create_bit_tests(switch_info_t *info, const walk_env_t *env,
+                             const case_cluster_t *cluster, ir_node *block,
+                             ir_node *index)
+{
+	ir_graph *irg  = get_irn_irg(block);
+	dbg_info *dbgi = get_irn_dbg_info(info->switchn);
+	ir_mode  *mode = env->selector_mode;
+
+	bit_test_t tests[BIT_TEST_MAX_TARGETS];
+	size_t     n_tests = 0;
+	ir_tarval *one     = get_mode_one(mode);
+	for (size_t e = 0; e < cluster->n_entries; ++e) {
+		const ir_switch_table_entry *entry = &cluster->entries[e];
+		size_t t = 0;
+		while (t < n_tests && tests[t].pn != (unsigned)entry->pn)
+			++t;
+		if (t == n_tests) {
+			assert(n_tests < BIT_TEST_MAX_TARGETS);
+			tests[t].pn     = entry->pn;
+			tests[t].mask   = get_mode_null(mode);
+			tests[t].weight = 0.0;
+			++n_tests;
+		}
+
+		ir_tarval *first = get_span(cluster->min, entry->min);
+		ir_tarval *last  = get_span(cluster->min, entry->max);
+		for (long bit = get_tarval_long(first), end = get_tarval_long(last);
+		     bit <= end; ++bit) {
+			ir_tarval *tv = tarval_shl_unsigned(one, bit);
+			tests[t].mask = tarval_or(tests[t].mask, tv);
+		}
+		tests[t].weight += get_entry_weight(info, entry);
+	}
+	if (info->switch_freq != 0.0)
+		QSORT(tests, n_tests, compare_bit_tests);
+
+	if (get_irn_mode(index) != mode)
+		index = new_rd_Conv(dbgi, block, index, mode);
+	ir_node *bit = new_rd_Shl(dbgi, block, new_r_Const(irg, one), index, mode);
+	for (size_t t = 0; t < n_tests; ++t) {
+		ir_node *mask   = new_r_Const(irg, tests[t].mask);
+		ir_node *masked = new_rd_And(dbgi, block, bit, mask, mode);
+		ir_node *zero   = new_r_Const(irg, get_mode_null(mode));
+		ir_node *cmp    = new_rd_Cmp(dbgi, block, masked, zero,
+		                             ir_relation_less_greater);
+		ir_node *cond  = new_rd_Cond(dbgi, block, cmp);
+		ir_node *projt = new_r_Proj(cond, mode_X, pn_Cond_true);
+		ir_node *projf = new_r_Proj(cond, mode_X, pn_Cond_false);
+		connect_to_target(&info->targets[tests[t].pn], projt);
+
+		ir_node *in[] = { projf };
+		block = new_r_Block(irg, ARRAY_SIZE(in), in);
+	}
+	ARR_APP1(ir_node*, info->defusers, new_r_Jmp(block));
+}
+
+/**
+ * Creates a Switch for the entries of the cluster, which are already known
+ * to be in its range.
+ */
+static void create_table_switch(switch_info_t *info, walk_env_t *env,
+                                const case_cluster_t *cluster, ir_node *block,
+                                ir_node *index)
+{
+	ir_graph *irg   = get_irn_irg(block);
+	dbg_info *dbgi  = get_irn_dbg_info(info->switchn);
+	ir_mode  *mode  = env->selector_mode;
+
+	/* number the targets of the cluster, 0 is the default */
+	unsigned *new_pns = XMALLOCNZ(unsigned, info->n_targets);
+	unsigned  n_outs  = 1;
+	ir_switch_table *table = ir_new_switch_table(irg, cluster->n_entries);
+	for (size_t e = 0; e < cluster->n_entries; ++e) {
+		const ir_switch_table_entry *entry = &cluster->entries[e];
+		if (new_pns[entry->pn] == 0)
+			new_pns[entry->pn] = n_outs++;
+		ir_tarval *min = tarval_convert_to(get_span(cluster->min, entry->min),
+		                                   mode);
+		ir_tarval *max = tarval_convert_to(get_span(cluster->min, entry->max),
+		                                   mode);
+		ir_switch_table_set(table, e, min, max, new_pns[entry->pn]);
+	}
+
+	if (get_irn_mode(index) != mode)
+		index = new_rd_Conv(dbgi, block, index, mode);
+	ir_node *switchn = new_rd_Switch(dbgi, block, index, n_outs, table);
+	/* the new Switch is normalized and must not be lowered again */
+	ir_nodeset_insert(&env->processed, switchn);
+
+	ir_node *defproj = new_r_Proj(switchn, mode_X, pn_Switch_default);
+	ir_node *in[]    = { defproj };
+	ir_node *defbl   = new_r_Block(irg, ARRAY_SIZE(in), in);
+	ARR_APP1(ir_node*, info->defusers, new_r_Jmp(defbl));
+	for (unsigned pn = 0; pn < info->n_targets; ++pn) {
+		if (new_pns[pn] == 0)
+			continue;
+		ir_node *proj = new_r_Proj(switchn, mode_X, new_pns[pn]);
+		connect_to_target_split(&info->targets[pn], proj);
+	}
+	free(new_pns);
+}
+
+/**
+ * Creates the test for a cluster in @p block and returns the control flow
+ * for selector values outside of the cluster.
+ */
+static ir_node *create_cluster(switch_info_t *info, walk_env_t *env,
+                               const case_cluster_t *cluster, ir_node *block)
+{
+	ir_graph *irg      = get_irn_irg(block);
+	dbg_info *dbgi     = get_irn_dbg_info(info->switchn);
+	ir_node  *selector = get_Switch_selector(info->switchn);
+
+	if (cluster->kind == CLUSTER_CASE) {
+		const ir_switch_table_entry *entry = cluster->entries;
+		ir_node *cond     = create_case_cond(entry, dbgi, block, selector);
+		ir_node *trueproj = new_r_Proj(cond, mode_X, pn_Cond_true);
+		connect_to_target(&info->targets[entry->pn], trueproj);
+		return new_r_Proj(cond, mode_X, pn_Cond_false);
+	}
+
+	ir_node *index;
+	ir_node *cond   = create_range_cond(cluster->min, cluster->max, dbgi, block,
+	                                    selector, &index);
+	ir_node *in[]   = { new_r_Proj(cond, mode_X, pn_Cond_true) };
+	ir_node *inside = new_r_Block(irg, ARRAY_SIZE(in), in);
+	if (cluster->kind == CLUSTER_BIT_TEST) {
+		create_bit_tests(info, env, cluster, inside, index);
 	} else {
-		ir_tarval *adjusted_max = tarval_sub(entry->max, entry->min);
-		ir_node   *sub          = new_rd_Sub(dbgi, block, selector, minconst,
-		                                     get_tarval_mode(adjusted_max));
-		ir_node   *maxconst     = new_r_Const(irg, adjusted_max);
-		cmp = new_rd_Cmp(dbgi, block, sub, maxconst, ir_relation_less_equal);
+		create_table_switch(info, env, cluster, inside, index);
 	}
-	return new_rd_Cond(dbgi, block, cmp);
+	return new_r_Proj(cond, mode_X, pn_Cond_false);
 }
 
-static void connect_to_target(target_t *target, ir_node *cf)
+/**
+ * Returns the index of the cluster where the clusters are split, so both
+ * parts are executed about equally often.
+ */
+static size_t find_split(const switch_info_t *info,
+                         const case_cluster_t *clusters, size_t n_clusters)
 {
-	ir_node *block     = target->block;
-	unsigned n_entries = target->n_entries;
-	if (get_Block_n_cfgpreds(block) != (int)n_entries) {
-		ir_node **new_in = ALLOCAN(ir_node*, n_entries);
-		ir_graph *irg    = get_irn_irg(block);
-		ir_node  *dummy  = new_r_Dummy(irg, mode_X);
-		for (unsigned i = 0; i < n_entries; ++i) {
-			new_in[i] = dummy;
+	if (info->switch_freq == 0.0)
+		return n_clusters / 2;
+
+	double total = 0.0;
+	for (size_t c = 0; c < n_clusters; ++c)
+		total += clusters[c].weight;
+
+	size_t best      = n_clusters / 2;
+	double best_diff = total;
+	double left      = 0.0;
+	for (size_t c = 1; c < n_clusters; ++c) {
+		left += clusters[c - 1].weight;
+		double const diff = fabs(2 * left - total);
+		if (diff < best_diff) {
+			best      = c;
+			best_diff = diff;
 		}
-		set_irn_in(block, n_entries, new_in);
-		assert(target->i == 0);
 	}
-	assert(target->i < n_entries);
-	set_Block_cfgpred(target->block, target->i++, cf);
+	return best;
 }
 
 /**
- * Creates an if cascade realizing binary search.
+ * Creates a binary search tree over the clusters.
  */
-static void create_if_cascade(switch_info_t *info, ir_node *block,
-                              ir_switch_table_entry *curcases,
-                              unsigned numcases)
+static void create_cluster_tree(switch_info_t *info, walk_env_t *env,
+                                ir_node *block, const case_cluster_t *clusters,
+                                size_t n_clusters)
 {
 	ir_graph      *irg      = get_irn_irg(block);
 	const ir_node *switchn  = info->switchn;
 	dbg_info      *dbgi     = get_irn_dbg_info(switchn);
 	ir_node       *selector = get_Switch_selector(switchn);
 
-	if (numcases == 0) {
+	if (n_clusters == 0) {
 		/* zero cases: "goto default;" */
 		ARR_APP1(ir_node*, info->defusers, new_r_Jmp(block));
-	} else if (numcases == 1) {
-		/*only one case: "if (sel == val) goto target else goto default;"*/
-		const ir_switch_table_entry *entry = &curcases[0];
-		ir_node *cond      = create_case_cond(entry, dbgi, block, selector);
-		ir_node *trueproj  = new_r_Proj(cond, mode_X, pn_Cond_true);
-		ir_node *falseproj = new_r_Proj(cond, mode_X, pn_Cond_false);
-
-		connect_to_target(&info->targets[entry->pn], trueproj);
-		ARR_APP1(ir_node*, info->defusers, falseproj);
-	} else if (numcases == 2) {
-		/* only two cases: "if (sel == val[0]) goto target[0];" */
-		const ir_switch_table_entry *entry0 = &curcases[0];
-		const ir_switch_table_entry *entry1 = &curcases[1];
-		ir_node *cond      = create_case_cond(entry0, dbgi, block, selector);
-		ir_node *trueproj  = new_r_Proj(cond, mode_X, pn_Cond_true);
-		ir_node *falseproj = new_r_Proj(cond, mode_X, pn_Cond_false);
-		connect_to_target(&info->targets[entry0->pn], trueproj);
-
-		ir_node *in[]    = { falseproj };
-		ir_node *neblock = new_r_Block(irg, ARRAY_SIZE(in), in);
-
-		/* second part: "else if (sel == val[1]) goto target[1] else goto default;" */
-		ir_node *cond1      = create_case_cond(entry1, dbgi, neblock, selector);
-		ir_node *trueproj1  = new_r_Proj(cond1, mode_X, pn_Cond_true);
-		ir_node *falseproj1 = new_r_Proj(cond1, mode_X, pn_Cond_false);
-		connect_to_target(&info->targets[entry1->pn], trueproj1);
-		ARR_APP1(ir_node*, info->defusers, falseproj1);
+	} else if (n_clusters <= 2) {
+		/* test the clusters one after the other, the more frequent first */
+		const case_cluster_t *first  = &clusters[0];
+		const case_cluster_t *second = &clusters[n_clusters - 1];
+		if (info->switch_freq != 0.0 && second->weight > first->weight) {
+			const case_cluster_t *tmp = first;
+			first  = second;
+			second = tmp;
+		}
+		ir_node *cf = create_cluster(info, env, first, block);
+		if (n_clusters == 2) {
+			ir_node *in[]    = { cf };
+			ir_node *neblock = new_r_Block(irg, ARRAY_SIZE(in), in);
+			cf = create_cluster(info, env, second, neblock);
+		}
+		ARR_APP1(ir_node*, info->defusers, cf);
 	} else {
-		/* recursive case: split cases in the middle */
-		unsigned midcase = numcases / 2;
-		const ir_switch_table_entry *entry = &curcases[midcase];
-		ir_node *val = new_r_Const(irg, entry->min);
-		ir_node *cmp = new_rd_Cmp(dbgi, block, selector, val, ir_relation_less);
+		/* recursive case: split clusters so both sides are similarly likely */
+		size_t   mid  = find_split(info, clusters, n_clusters);
+		ir_node *val  = new_r_Const(irg, clusters[mid].min);
+		ir_node *cmp  = new_rd_Cmp(dbgi, block, selector, val, ir_relation_less);
 		ir_node *cond = new_rd_Cond(dbgi, block, cmp);
 
 		ir_node *ltin[]  = { new_r_Proj(cond, mode_X, pn_Cond_true) };
@@ -368,9 +742,62 @@ static void create_if_cascade(switch_info_t *info, ir_node *block,
 		ir_node *gein[]  = { new_r_Proj(cond, mode_X, pn_Cond_false) };
 		ir_node *geblock = new_r_Block(irg, ARRAY_SIZE(gein), gein);
 
-		create_if_cascade(info, ltblock, curcases, midcase);
-		create_if_cascade(info, geblock, curcases + midcase, numcases - midcase);
+		create_cluster_tree(info, env, ltblock, clusters, mid);
+		create_cluster_tree(info, env, geblock, clusters + mid,
+		                    n_clusters - mid);
+	}
+}
+
+/**
+ * Returns the index of an entry taken in most executions of the switch, or
+ * @p n_entries if there is none.
+ */
+static size_t find_dominant_entry(const switch_info_t *info,
+                                  const ir_switch_table_entry *entries,
+                                  size_t n_entries)
+{
+	if (info->switch_freq == 0.0)
+		return n_entries;
+	for (size_t e = 0; e < n_entries; ++e) {
+		double const weight = get_entry_weight(info, &entries[e]);
+		if (weight >= DOMINANT_CASE_PROB * info->switch_freq)
+			return e;
 	}
+	return n_entries;
+}
+
+/**
+ * Replaces the switch by tests of the clusters of its entries.
+ */
+static void create_if_cascade(switch_info_t *info, walk_env_t *env,
+                              ir_node *block)
+{
+	ir_graph              *irg       = get_irn_irg(block);
+	ir_node               *switchn   = info->switchn;
+	dbg_info              *dbgi      = get_irn_dbg_info(switchn);
+	ir_switch_table       *table     = get_Switch_table(switchn);
+	ir_switch_table_entry *entries   = table->entries;
+	size_t                 n_entries = table->n_entries;
+
+	/* peel a dominant case, unless it is tested first anyway */
+	size_t const dominant = find_dominant_entry(info, entries, n_entries);
+	if (n_entries > 2 && dominant < n_entries) {
+		ir_node *selector = get_Switch_selector(switchn);
+		ir_node *cond     = create_case_cond(&entries[dominant], dbgi, block,
+		                                     selector);
+		ir_node *trueproj = new_r_Proj(cond, mode_X, pn_Cond_true);
+		connect_to_target(&info->targets[entries[dominant].pn], trueproj);
+
+		ir_node *in[] = { new_r_Proj(cond, mode_X, pn_Cond_false) };
+		block = new_r_Block(irg, ARRAY_SIZE(in), in);
+		memmove(&entries[dominant], &entries[dominant + 1],
+		        (n_entries - dominant - 1) * sizeof(*entries));
+		--n_entries;
+	}
+
+	case_cluster_t *clusters = create_clusters(info, env, entries, n_entries);
+	create_cluster_tree(info, env, block, clusters, ARR_LEN(clusters));
+	DEL_ARR_F(clusters);
 }
 
 /**
@@ -428,11 +855,18 @@ static void find_switch_nodes(ir_node *block, void *ctx)
 	env->changed  = true;
 	info.defusers = NEW_ARR_F(ir_node*, 0);
 	block         = get_nodes_block(switchn);
-	ir_switch_table *table = get_Switch_table(switchn);
-	create_if_cascade(&info, block, table->entries, table->n_entries);
+	create_if_cascade(&info, env, block);
 
 	/* Connect new default case users */
 	set_irn_in(info.default_block, ARR_LEN(info.defusers), info.defusers);
+	for (unsigned pn = 0; pn < info.n_targets; ++pn) {
+		target_t *target = &info.targets[pn];
+		if (target->preds == NULL)
+			continue;
+		if (pn != pn_Switch_default && ARR_LEN(target->preds) > 0)
+			set_irn_in(target->block, ARR_LEN(target->preds), target->preds);
+		DEL_ARR_F(target->preds);
+	}
 
 	DEL_ARR_F(info.defusers);
 	free(info.targets);
@@ -441,6 +875,7 @@ static void find_switch_nodes(ir_node *block, void *ctx)
 void lower_switch(ir_graph *irg, unsigned small_switch, unsigned spare_size,
                   ir_mode *selector_mode)
 {
+	ir_pass_begin(irg, "lower_switch");
 	if (mode_is_signed(selector_mode))
 		panic("expected unsigned mode for switch selector");
 
@@ -459,4 +894,5 @@ void lower_switch(ir_graph *irg, unsigned small_switch, unsigned spare_size,
 
 	confirm_irg_properties(irg, env.changed ? IR_GRAPH_PROPERTIES_NONE
 	                                        : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_end("lower_switch");
 }
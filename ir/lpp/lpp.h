@@ -11,6 +11,7 @@
 #ifndef LPP_LPP_H
 #define LPP_LPP_H
 
+#include <math.h>
 #include <stdio.h>
 #include <obstack.h>
 #include <stdbool.h>
@@ -286,6 +287,16 @@ static inline double lpp_get_sol_time(const lpp_t *lpp)
 	return lpp->sol_time;
 }
 
+/**
+ * @return The relative gap between the objective value of the solution and
+ *         the best bound, 0 for a solution proven optimal.
+ */
+static inline double lpp_get_mip_gap(const lpp_t *lpp)
+{
+	double const objval = fabs(lpp->objval);
+	return fabs(lpp->objval - lpp->best_bound) / (objval > 1e-10 ? objval : 1e-10);
+}
+
 static inline lpp_sol_state_t lpp_get_sol_state(const lpp_t *lpp)
 {
 	return lpp->sol_state;
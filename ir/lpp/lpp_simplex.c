@@ -0,0 +1,709 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Embedded simplex and branch-and-bound solver for lpp problems.
+ *
+ * The LP relaxations are solved with a bounded dual simplex on a dense
+ * tableau. Every constraint gets a slack column, so the slacks form the
+ * initial basis and the tableau starts as [A | I]. The search branches on
+ * fractional binary variables depth first. A node only changes variable
+ * bounds, which keeps the current basis dual feasible, so each node
+ * continues from the basis of the node solved before it.
+ */
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lpp_simplex.h"
+#include "array.h"
+#include "obst.h"
+#include "panic.h"
+#include "timing.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#define EPS_FEAS  1e-7 /**< tolerance for primal feasibility */
+#define EPS_DUAL  1e-9 /**< tolerance for dual feasibility */
+#define EPS_PIVOT 1e-9 /**< smallest pivot element accepted */
+#define EPS_ZERO  1e-12 /**< tableau entries below this are dropped */
+#define EPS_INT   1e-6 /**< tolerance for integrality */
+#define BIG_BOUND 1e9  /**< artificial bound of unbounded improving variables */
+
+/** Problems with more tableau entries are not attempted (1 GiB). */
+#define MAX_TABLEAU_ENTRIES ((size_t)1 << 27)
+
+typedef enum lp_result_t {
+	lp_optimal,
+	lp_infeasible,
+	lp_cutoff,
+	lp_timeout,
+} lp_result_t;
+
+typedef struct simplex_t {
+	int         n_rows;     /**< number of constraints */
+	int         n_cols;     /**< number of columns, slacks included */
+	int         n_struct;   /**< number of variables of the lpp */
+	double     *tab;        /**< n_rows x n_cols tableau B^-1 A, row major */
+	double     *d;          /**< reduced costs */
+	double     *lo;         /**< current lower bounds */
+	double     *up;         /**< current upper bounds */
+	double     *x;          /**< current values of all columns */
+	int        *basis;      /**< column basic in each row */
+	int        *row_of;     /**< row of a basic column, -1 if nonbasic */
+	int        *nz;         /**< nonzero columns of the pivot row */
+	double      z;          /**< objective value of the current basis */
+	unsigned    iterations; /**< number of pivots so far */
+	ir_timer_t *timer;      /**< started when solving began */
+	double      time_limit; /**< seconds, 0.0 for no limit */
+} simplex_t;
+
+/** A node of the branch-and-bound tree. */
+typedef struct bb_node_t bb_node_t;
+struct bb_node_t {
+	bb_node_t const *parent; /**< the node this one was branched from */
+	int              col;    /**< the fixed variable, -1 for the root */
+	double           value;  /**< the value the variable is fixed to */
+	double           bound;  /**< objective of the parent relaxation */
+};
+
+static bool time_exceeded(simplex_t const *const s)
+{
+	return s->time_limit > 0.0
+	    && ir_timer_elapsed_sec(s->timer) >= s->time_limit;
+}
+
+static double get_sign(lpp_t const *const lpp)
+{
+	return lpp->opt_type == lpp_minimize ? 1.0 : -1.0;
+}
+
+/**
+ * Checks the values @p x of the variables against the constraints of the
+ * lpp matrix and returns the (minimized) objective in @p obj.
+ */
+static bool check_solution(lpp_t *const lpp, double const *const x,
+                           double *const obj)
+{
+	int     const n_rows = lpp->cst_next - 1;
+	double *const act    = XMALLOCNZ(double, n_rows);
+	double *const rhs    = XMALLOCNZ(double, n_rows);
+	double        sum    = 0.0;
+	matrix_foreach(lpp->m, elem) {
+		if (elem->row == 0) {
+			if (elem->col > 0)
+				sum += elem->val * x[elem->col - 1];
+		} else if (elem->col == 0) {
+			rhs[elem->row - 1] = elem->val;
+		} else {
+			act[elem->row - 1] += elem->val * x[elem->col - 1];
+		}
+	}
+
+	bool ok = true;
+	for (int i = 0; i < n_rows && ok; ++i) {
+		double const tol = EPS_INT * (1.0 + fabs(rhs[i]));
+		switch (lpp->csts[1 + i]->type.cst_type) {
+		case lpp_equal:         ok = fabs(act[i] - rhs[i]) <= tol; break;
+		case lpp_less_equal:    ok = act[i] <= rhs[i] + tol;        break;
+		case lpp_greater_equal: ok = act[i] >= rhs[i] - tol;        break;
+		default:                panic("invalid constraint type");
+		}
+	}
+	free(rhs);
+	free(act);
+
+	*obj = get_sign(lpp) * sum;
+	return ok;
+}
+
+/**
+ * Rounds the binary variables of @p x. Returns false if one of them is not
+ * integral.
+ */
+static bool round_binaries(lpp_t const *const lpp, double *const x)
+{
+	for (int j = 0, n = lpp->var_next - 1; j < n; ++j) {
+		if (lpp->vars[1 + j]->type.var_type != lpp_binary)
+			continue;
+		double const r = x[j] < 0.5 ? 0.0 : 1.0;
+		if (fabs(x[j] - r) > EPS_INT)
+			return false;
+		x[j] = r;
+	}
+	return true;
+}
+
+/**
+ * Uses the start values as first incumbent if they form a feasible solution.
+ * Variables without a start value are 0.
+ */
+static bool start_solution(lpp_t *const lpp, double *const x,
+                           double *const obj)
+{
+	bool has_start = false;
+	for (int j = 0, n = lpp->var_next - 1; j < n; ++j) {
+		lpp_name_t const *const var = lpp->vars[1 + j];
+		if (var->value_kind == lpp_value_start) {
+			x[j]      = var->value;
+			has_start = true;
+		} else {
+			x[j] = 0.0;
+		}
+	}
+	return has_start && round_binaries(lpp, x) && check_solution(lpp, x, obj);
+}
+
+/**
+ * Returns true if every feasible solution has an integral objective value.
+ * A better solution then has to improve by at least 1.
+ */
+static bool is_objective_integral(lpp_t *const lpp)
+{
+	matrix_foreach_in_row(lpp->m, 0, elem) {
+		if (elem->col == 0)
+			continue;
+		if (lpp->vars[elem->col]->type.var_type != lpp_binary
+		    || elem->val != floor(elem->val))
+			return false;
+	}
+	return true;
+}
+
+static simplex_t *new_simplex(lpp_t *const lpp, ir_timer_t *const timer)
+{
+	int const n_struct = lpp->var_next - 1;
+	int const n_rows   = lpp->cst_next - 1;
+	int const n_cols   = n_struct + n_rows;
+	if ((size_t)n_rows * (size_t)n_cols > MAX_TABLEAU_ENTRIES)
+		return NULL;
+
+	simplex_t *const s = XMALLOCZ(simplex_t);
+	s->n_rows     = n_rows;
+	s->n_cols     = n_cols;
+	s->n_struct   = n_struct;
+	s->tab        = XMALLOCNZ(double, (size_t)n_rows * (size_t)n_cols);
+	s->d          = XMALLOCNZ(double, n_cols);
+	s->lo         = XMALLOCNZ(double, n_cols);
+	s->up         = XMALLOCNZ(double, n_cols);
+	s->x          = XMALLOCNZ(double, n_cols);
+	s->basis      = XMALLOCN(int, n_rows);
+	s->row_of     = XMALLOCN(int, n_cols);
+	s->nz         = XMALLOCN(int, n_cols);
+	s->timer      = timer;
+	s->time_limit = lpp->time_limit_secs;
+
+	/* The slacks temporarily hold the right hand sides. */
+	double const sign = get_sign(lpp);
+	matrix_foreach(lpp->m, elem) {
+		if (elem->row == 0) {
+			if (elem->col > 0)
+				s->d[elem->col - 1] = sign * elem->val;
+		} else if (elem->col == 0) {
+			s->x[n_struct + elem->row - 1] = elem->val;
+		} else {
+			s->tab[(size_t)(elem->row - 1) * n_cols + elem->col - 1] = elem->val;
+		}
+	}
+
+	/* Nonbasic variables start at the bound their costs prefer, which makes
+	 * the slack basis dual feasible. Ties are broken by the start values. */
+	for (int j = 0; j < n_struct; ++j) {
+		lpp_name_t const *const var = lpp->vars[1 + j];
+		double            const c   = s->d[j];
+		s->row_of[j] = -1;
+		s->lo[j]     = 0.0;
+		if (var->type.var_type == lpp_binary) {
+			s->up[j] = 1.0;
+		} else {
+			s->up[j] = c < 0.0 ? BIG_BOUND : HUGE_VAL;
+		}
+		if (c < 0.0) {
+			s->x[j] = s->up[j];
+		} else if (c == 0.0 && var->value_kind == lpp_value_start
+		           && var->type.var_type == lpp_binary && var->value > 0.5) {
+			s->x[j] = 1.0;
+		}
+		s->z += c * s->x[j];
+	}
+
+	for (int i = 0; i < n_rows; ++i) {
+		int     const slack = n_struct + i;
+		double *const row   = &s->tab[(size_t)i * n_cols];
+		row[slack]       = 1.0;
+		s->basis[i]      = i + n_struct;
+		s->row_of[slack] = i;
+		switch (lpp->csts[1 + i]->type.cst_type) {
+		case lpp_equal:
+			s->lo[slack] = 0.0;
+			s->up[slack] = 0.0;
+			break;
+		case lpp_less_equal:
+			s->lo[slack] = 0.0;
+			s->up[slack] = HUGE_VAL;
+			break;
+		case lpp_greater_equal:
+			s->lo[slack] = -HUGE_VAL;
+			s->up[slack] = 0.0;
+			break;
+		default:
+			panic("invalid constraint type");
+		}
+		for (int j = 0; j < n_struct; ++j)
+			s->x[slack] -= row[j] * s->x[j];
+	}
+	return s;
+}
+
+static void free_simplex(simplex_t *const s)
+{
+	free(s->nz);
+	free(s->row_of);
+	free(s->basis);
+	free(s->x);
+	free(s->up);
+	free(s->lo);
+	free(s->d);
+	free(s->tab);
+	free(s);
+}
+
+/**
+ * Moves the nonbasic column @p col to @p value and updates the basic
+ * variables accordingly.
+ */
+static void move_nonbasic(simplex_t *const s, int const col, double const value)
+{
+	double const delta = value - s->x[col];
+	if (delta == 0.0)
+		return;
+	s->x[col]  = value;
+	s->z      += s->d[col] * delta;
+	int const n_cols = s->n_cols;
+	for (int i = 0; i < s->n_rows; ++i) {
+		double const a = s->tab[(size_t)i * n_cols + col];
+		if (a != 0.0)
+			s->x[s->basis[i]] -= a * delta;
+	}
+}
+
+/**
+ * Changes the bounds of @p col. A nonbasic column goes to the bound its
+ * reduced cost prefers, so the basis stays dual feasible. A basic column may
+ * become primal infeasible, which the next dual simplex run repairs.
+ */
+static void simplex_set_bounds(simplex_t *const s, int const col,
+                               double const lo, double const up)
+{
+	s->lo[col] = lo;
+	s->up[col] = up;
+	if (s->row_of[col] >= 0)
+		return;
+
+	double value;
+	if (lo == up || s->d[col] > EPS_DUAL) {
+		value = lo;
+	} else if (s->d[col] < -EPS_DUAL) {
+		value = up;
+	} else {
+		value = s->x[col] >= up ? up : lo;
+	}
+	move_nonbasic(s, col, value);
+}
+
+/**
+ * Selects the basic variable with the largest bound violation.
+ * @return its row or -1 if the basis is primal feasible
+ */
+static int select_leaving(simplex_t const *const s, bool *const below)
+{
+	int    best       = -1;
+	double best_viol  = EPS_FEAS;
+	for (int r = 0; r < s->n_rows; ++r) {
+		int    const col = s->basis[r];
+		double const val = s->x[col];
+		if (s->lo[col] - val > best_viol) {
+			best      = r;
+			best_viol = s->lo[col] - val;
+			*below    = true;
+		} else if (val - s->up[col] > best_viol) {
+			best      = r;
+			best_viol = val - s->up[col];
+			*below    = false;
+		}
+	}
+	return best;
+}
+
+/**
+ * Dual ratio test with Harris' two passes: The first pass computes the step
+ * length with slightly relaxed dual feasibility, the second picks the
+ * largest pivot element among the columns reaching their bound within it.
+ * @return the entering column or -1 if the problem is infeasible
+ */
+static int select_entering(simplex_t const *const s, int const r,
+                           bool const below)
+{
+	int           const n_cols = s->n_cols;
+	double const *const row    = &s->tab[(size_t)r * n_cols];
+
+	double theta = HUGE_VAL;
+	for (int j = 0; j < n_cols; ++j) {
+		if (s->row_of[j] >= 0 || s->lo[j] == s->up[j])
+			continue;
+		bool   const at_upper = s->x[j] == s->up[j];
+		double       a        = below ? -row[j] : row[j];
+		if (at_upper)
+			a = -a;
+		if (a <= EPS_PIVOT)
+			continue;
+		double const dj    = MAX(at_upper ? -s->d[j] : s->d[j], 0.0);
+		double const ratio = (dj + EPS_DUAL) / a;
+		if (ratio < theta)
+			theta = ratio;
+	}
+	if (theta == HUGE_VAL)
+		return -1;
+
+	int    best   = -1;
+	double best_a = 0.0;
+	for (int j = 0; j < n_cols; ++j) {
+		if (s->row_of[j] >= 0 || s->lo[j] == s->up[j])
+			continue;
+		bool   const at_upper = s->x[j] == s->up[j];
+		double       a        = below ? -row[j] : row[j];
+		if (at_upper)
+			a = -a;
+		if (a <= EPS_PIVOT)
+			continue;
+		double const dj = MAX(at_upper ? -s->d[j] : s->d[j], 0.0);
+		if (dj / a <= theta && a > best_a) {
+			best   = j;
+			best_a = a;
+		}
+	}
+	return best;
+}
+
+/**
+ * Exchanges the basic variable of row @p r, which leaves at @p target, with
+ * column @p q.
+ */
+static void pivot(simplex_t *const s, int const r, int const q,
+                  double const target)
+{
+	int     const n_cols  = s->n_cols;
+	int     const n_rows  = s->n_rows;
+	double *const prow    = &s->tab[(size_t)r * n_cols];
+	int     const leaving = s->basis[r];
+	double  const alpha   = prow[q];
+
+	/* primal step */
+	double const t = (s->x[leaving] - target) / alpha;
+	s->x[q] += t;
+	s->z    += s->d[q] * t;
+	for (int i = 0; i < n_rows; ++i) {
+		if (i != r)
+			s->x[s->basis[i]] -= s->tab[(size_t)i * n_cols + q] * t;
+	}
+	s->x[leaving] = target;
+
+	/* normalize the pivot row and remember its nonzeros */
+	int          n_nz = 0;
+	double const inv  = 1.0 / alpha;
+	for (int j = 0; j < n_cols; ++j) {
+		if (fabs(prow[j]) < EPS_ZERO) {
+			prow[j] = 0.0;
+			continue;
+		}
+		prow[j]      *= inv;
+		s->nz[n_nz++] = j;
+	}
+	prow[q] = 1.0;
+
+	for (int i = 0; i < n_rows; ++i) {
+		double *const row = &s->tab[(size_t)i * n_cols];
+		double  const f   = row[q];
+		if (i == r || f == 0.0)
+			continue;
+		for (int k = 0; k < n_nz; ++k) {
+			int const j = s->nz[k];
+			row[j] -= f * prow[j];
+		}
+		row[q] = 0.0;
+	}
+
+	double const f = s->d[q];
+	if (f != 0.0) {
+		for (int k = 0; k < n_nz; ++k) {
+			int const j = s->nz[k];
+			s->d[j] -= f * prow[j];
+		}
+		s->d[q] = 0.0;
+	}
+
+	s->basis[r]         = q;
+	s->row_of[q]        = r;
+	s->row_of[leaving]  = -1;
+	++s->iterations;
+}
+
+/**
+ * Runs the dual simplex from the current basis. As the objective of a dual
+ * feasible basis is a lower bound, the run stops as soon as it exceeds
+ * @p cutoff.
+ */
+static lp_result_t simplex_solve(simplex_t *const s, double const cutoff)
+{
+	for (;;) {
+		if (s->z > cutoff)
+			return lp_cutoff;
+		bool      below;
+		int const r = select_leaving(s, &below);
+		if (r < 0)
+			return lp_optimal;
+		int const q = select_entering(s, r, below);
+		if (q < 0)
+			return lp_infeasible;
+		int const leaving = s->basis[r];
+		pivot(s, r, q, below ? s->lo[leaving] : s->up[leaving]);
+		if ((s->iterations & 63) == 0 && time_exceeded(s))
+			return lp_timeout;
+	}
+}
+
+/**
+ * Sets the bounds of the binary variables to the fixings of @p node.
+ * @p fixed holds the current fixings (-1 for none), @p want is scratch.
+ */
+static void apply_fixings(lpp_t const *const lpp, simplex_t *const s,
+                          bb_node_t const *const node,
+                          signed char *const fixed, signed char *const want)
+{
+	int const n_struct = s->n_struct;
+	memset(want, -1, n_struct);
+	for (bb_node_t const *n = node; n->col >= 0; n = n->parent)
+		want[n->col] = (signed char)n->value;
+
+	for (int j = 0; j < n_struct; ++j) {
+		if (want[j] == fixed[j])
+			continue;
+		assert(lpp->vars[1 + j]->type.var_type == lpp_binary);
+		(void)lpp;
+		if (want[j] < 0) {
+			simplex_set_bounds(s, j, 0.0, 1.0);
+		} else {
+			simplex_set_bounds(s, j, want[j], want[j]);
+		}
+		fixed[j] = want[j];
+	}
+}
+
+/**
+ * Selects the most fractional binary variable.
+ * @return its column or -1 if all binaries are integral
+ */
+static int select_branching(lpp_t const *const lpp, simplex_t const *const s)
+{
+	int    best      = -1;
+	double best_frac = EPS_INT;
+	for (int j = 0; j < s->n_struct; ++j) {
+		if (lpp->vars[1 + j]->type.var_type != lpp_binary)
+			continue;
+		double const frac = MIN(s->x[j], 1.0 - s->x[j]);
+		if (frac > best_frac) {
+			best      = j;
+			best_frac = frac;
+		}
+	}
+	return best;
+}
+
+static bool hits_artificial_bound(simplex_t const *const s)
+{
+	for (int j = 0; j < s->n_struct; ++j) {
+		if (s->up[j] == BIG_BOUND && s->x[j] >= 0.5 * BIG_BOUND)
+			return true;
+	}
+	return false;
+}
+
+static double open_bound(bb_node_t *const *const stack, double const best_obj)
+{
+	double bound = best_obj;
+	for (size_t i = 0, n = ARR_LEN(stack); i < n; ++i)
+		bound = MIN(bound, stack[i]->bound);
+	return bound;
+}
+
+/**
+ * Searches the binary variables depth first. @p best and @p best_obj hold the
+ * incumbent, which may already be set from the start values.
+ */
+static void branch_and_bound(lpp_t *const lpp, simplex_t *const s,
+                             double *const best, double *const best_obj,
+                             bool *const has_sol)
+{
+	int    const n_struct = s->n_struct;
+	double const sign     = get_sign(lpp);
+	/* A set bound is a lower bound in the minimized sense: reaching it
+	 * proves optimality. */
+	double const target   = lpp->set_bound ? sign * lpp->bound : -HUGE_VAL;
+	bool   const integral = is_objective_integral(lpp);
+
+	struct obstack obst;
+	obstack_init(&obst);
+	bb_node_t **stack = NEW_ARR_F(bb_node_t*, 0);
+	bb_node_t  *root  = OALLOCZ(&obst, bb_node_t);
+	root->col   = -1;
+	root->bound = -HUGE_VAL;
+	ARR_APP1(bb_node_t*, stack, root);
+
+	signed char *const fixed = XMALLOCN(signed char, n_struct);
+	signed char *const want  = XMALLOCN(signed char, n_struct);
+	memset(fixed, -1, n_struct);
+
+	unsigned n_nodes   = 0;
+	bool     timeout   = false;
+	bool     unbounded = false;
+	while (ARR_LEN(stack) > 0 && *best_obj > target + EPS_INT) {
+		double const cutoff = integral
+			? *best_obj - 1.0 + EPS_INT
+			: *best_obj - EPS_INT * MAX(1.0, fabs(*best_obj));
+
+		bb_node_t *const node = stack[ARR_LEN(stack) - 1];
+		if (node->bound > cutoff) {
+			ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+			continue;
+		}
+		if (time_exceeded(s)) {
+			timeout = true;
+			break;
+		}
+		ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+
+		apply_fixings(lpp, s, node, fixed, want);
+		lp_result_t const res = simplex_solve(s, cutoff);
+		++n_nodes;
+		if (res == lp_timeout) {
+			ARR_APP1(bb_node_t*, stack, node);
+			timeout = true;
+			break;
+		}
+		if (res != lp_optimal)
+			continue;
+
+		int const col = select_branching(lpp, s);
+		if (col < 0) {
+			if (hits_artificial_bound(s)) {
+				unbounded = true;
+				break;
+			}
+			double *const x = XMALLOCN(double, n_struct);
+			memcpy(x, s->x, n_struct * sizeof(*x));
+			double obj;
+			if (round_binaries(lpp, x) && check_solution(lpp, x, &obj)
+			    && obj < *best_obj) {
+				memcpy(best, x, n_struct * sizeof(*x));
+				*best_obj = obj;
+				*has_sol  = true;
+				if (lpp->log != NULL)
+					fprintf(lpp->log, "simplex: objective %g after %u nodes, %u iterations, bound %g\n",
+					        sign * obj, n_nodes, s->iterations,
+					        sign * open_bound(stack, obj));
+			}
+			free(x);
+			continue;
+		}
+
+		/* explore the start value (or the nearer value) first */
+		lpp_name_t const *const var    = lpp->vars[1 + col];
+		double            const prefer = var->value_kind == lpp_value_start
+			? (var->value > 0.5 ? 1.0 : 0.0)
+			: (s->x[col] > 0.5 ? 1.0 : 0.0);
+		for (int i = 0; i < 2; ++i) {
+			bb_node_t *const child = OALLOC(&obst, bb_node_t);
+			child->parent = node;
+			child->col    = col;
+			child->value  = i == 0 ? 1.0 - prefer : prefer;
+			child->bound  = s->z;
+			ARR_APP1(bb_node_t*, stack, child);
+		}
+	}
+
+	double bound = open_bound(stack, *best_obj);
+	if (*best_obj <= target + EPS_INT) {
+		bound = *best_obj;
+	} else {
+		bound = MAX(bound, target);
+	}
+	lpp->best_bound = sign * bound;
+
+	if (unbounded) {
+		lpp->sol_state = lpp_unbounded;
+		*has_sol       = false;
+	} else if (*has_sol) {
+		lpp->sol_state = timeout ? lpp_feasible : lpp_optimal;
+	} else {
+		lpp->sol_state = timeout ? lpp_unknown : lpp_infeasible;
+	}
+
+	if (lpp->log != NULL) {
+		double const gap = *has_sol
+			? (*best_obj - bound) / MAX(fabs(*best_obj), 1e-10) : 1.0;
+		fprintf(lpp->log, "simplex: %u nodes, %u iterations, gap %.2f%%%s\n",
+		        n_nodes, s->iterations, 100.0 * gap,
+		        timeout ? ", time limit reached" : "");
+	}
+
+	free(want);
+	free(fixed);
+	DEL_ARR_F(stack);
+	obstack_free(&obst, NULL);
+}
+
+void lpp_solve_simplex(lpp_t *const lpp)
+{
+	ir_timer_t *const timer = ir_timer_new();
+	ir_timer_start(timer);
+
+	int     const n_struct = lpp->var_next - 1;
+	double  const sign     = get_sign(lpp);
+	double *const best     = XMALLOCNZ(double, n_struct);
+	double        best_obj = HUGE_VAL;
+	bool          has_sol  = start_solution(lpp, best, &best_obj);
+	if (has_sol && lpp->log != NULL)
+		fprintf(lpp->log, "simplex: start values are feasible, objective %g\n",
+		        sign * best_obj);
+
+	simplex_t *const s = new_simplex(lpp, timer);
+	if (s != NULL) {
+		branch_and_bound(lpp, s, best, &best_obj, &has_sol);
+		lpp->iterations = s->iterations;
+		free_simplex(s);
+	} else {
+		if (lpp->log != NULL)
+			fprintf(lpp->log, "simplex: %d x %d problem is too large\n",
+			        lpp->cst_next - 1, n_struct);
+		lpp->sol_state  = has_sol ? lpp_feasible : lpp_unknown;
+		lpp->best_bound = sign * -HUGE_VAL;
+		lpp->iterations = 0;
+	}
+
+	if (has_sol) {
+		for (int j = 0; j < n_struct; ++j) {
+			lpp->vars[1 + j]->value      = best[j];
+			lpp->vars[1 + j]->value_kind = lpp_value_solution;
+		}
+		lpp->objval = sign * best_obj;
+	}
+	free(best);
+
+	ir_timer_stop(timer);
+	lpp->sol_time = ir_timer_elapsed_sec(timer);
+	ir_timer_free(timer);
+}
@@ -0,0 +1,17 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Embedded simplex and branch-and-bound solver for lpp problems.
+ */
+#ifndef LPP_SIMPLEX_H
+#define LPP_SIMPLEX_H
+
+#include "lpp.h"
+
+void lpp_solve_simplex(lpp_t *lpp);
+
+#endif
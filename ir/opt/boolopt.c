@@ -19,6 +19,7 @@
 #include "irnode_t.h"
 #include "tv.h"
 #include "debug.h"
+#include "timing_t.h"
 
 /** Describes a pair of relative conditions lo < hi, lo rel_lo x, hi rel_hi x */
 typedef struct cond_pair {
@@ -697,6 +698,7 @@ restart:
 
 void opt_bool(ir_graph *const irg)
 {
+	ir_pass_begin(irg, "opt_bool");
 	bool_opt_env_t env;
 
 	/* register a debug mask */
@@ -715,4 +717,5 @@ void opt_bool(ir_graph *const irg)
 
 	confirm_irg_properties(irg,
 		env.changed ? IR_GRAPH_PROPERTIES_NONE : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_end("opt_bool");
 }
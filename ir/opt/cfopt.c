@@ -25,6 +25,7 @@
 #include "irverify.h"
 #include "util.h"
 #include "xmalloc.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -544,6 +545,7 @@ again:;
 
 void optimize_cf(ir_graph *irg)
 {
+	ir_pass_begin(irg, "optimize_cf");
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 	                         | IR_GRAPH_PROPERTY_ONE_RETURN);
 	/* we have some hacky is_Id() checks here so exchange must not use Deleted
@@ -585,4 +587,5 @@ void optimize_cf(ir_graph *irg)
 	                     | IR_RESOURCE_IRN_LINK);
 	confirm_irg_properties(irg, global_changed ? IR_GRAPH_PROPERTIES_NONE
 	                                           : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_end("optimize_cf");
 }
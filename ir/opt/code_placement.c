@@ -21,6 +21,7 @@
 #include "irnode_t.h"
 #include "iredges_t.h"
 #include "irgopt.h"
+#include "timing_t.h"
 
 #ifndef NDEBUG
 static bool is_block_reachable(ir_node *block)
@@ -329,6 +330,7 @@ static void place_late(ir_graph *irg, pdeq *worklist)
 /* Code Placement. */
 void place_code(ir_graph *irg)
 {
+	ir_pass_begin(irg, "place_code");
 	/* Handle graph state */
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES |
@@ -354,4 +356,5 @@ void place_code(ir_graph *irg)
 
 	del_pdeq(worklist);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_end("place_code");
 }
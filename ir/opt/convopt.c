@@ -36,6 +36,7 @@
 #include "irgwalk.h"
 #include "tv.h"
 #include "vrp.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -277,6 +278,7 @@ static void conv_opt_walker(ir_node *node, void *data)
 
 void conv_opt(ir_graph *irg)
 {
+	ir_pass_begin(irg, "conv_opt");
 	FIRM_DBG_REGISTER(dbg, "firm.opt.conv");
 
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
@@ -295,4 +297,5 @@ void conv_opt(ir_graph *irg)
 
 	confirm_irg_properties(irg,
 		global_changed ? IR_GRAPH_PROPERTIES_NONE : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_end("conv_opt");
 }
@@ -26,6 +26,7 @@
 #include "iropt_t.h"
 #include "pmap.h"
 #include "vrp.h"
+#include "timing_t.h"
 
 /**
  * Reroute the inputs of a node from nodes in the old graph to copied nodes in
@@ -74,6 +75,7 @@ static void copy_graph_env(ir_graph *irg)
  */
 void dead_node_elimination(ir_graph *irg)
 {
+	ir_pass_begin(irg, "dead_node_elimination");
 	edges_deactivate(irg);
 
 	/* Handle graph state */
@@ -101,4 +103,5 @@ void dead_node_elimination(ir_graph *irg)
 
 	/* Free memory from old unoptimized obstack */
 	obstack_free(&graveyard_obst, 0);  /* First empty the obstack ... */
+	ir_pass_end("dead_node_elimination");
 }
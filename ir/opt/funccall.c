@@ -30,6 +30,7 @@
 #include "raw_bitset.h"
 #include "debug.h"
 #include "panic.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -859,6 +860,7 @@ static mtp_additional_properties check_nothrow_or_malloc(ir_graph *irg, bool top
 
 void optimize_funccalls(void)
 {
+	ir_pass_begin(NULL, "optimize_funccalls");
 	/* prepare: mark all graphs as not analyzed */
 	size_t last_idx = get_irp_last_idx();
 	ready_set = rbitset_malloc(last_idx);
@@ -891,6 +893,7 @@ void optimize_funccalls(void)
 
 	free(busy_set);
 	free(ready_set);
+	ir_pass_end("optimize_funccalls");
 }
 
 void firm_init_funccalls(void)
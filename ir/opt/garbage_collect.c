@@ -17,6 +17,7 @@
 #include "irgwalk.h"
 #include "panic.h"
 #include "debug.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -120,6 +121,7 @@ static void garbage_collect_in_segment(ir_type *segment)
 
 void garbage_collect_entities(void)
 {
+	ir_pass_begin(NULL, "garbage_collect_entities");
 	FIRM_DBG_REGISTER(dbg, "firm.opt.garbagecollect");
 
 	/* start a type walk for all externally visible entities */
@@ -153,4 +155,5 @@ void garbage_collect_entities(void)
 		garbage_collect_in_segment(type);
 	}
 	irp_free_resources(irp, IRP_RESOURCE_TYPE_VISITED);
+	ir_pass_end("garbage_collect_entities");
 }
@@ -22,6 +22,7 @@
 #include "irnode_t.h"
 #include "iroptimize.h"
 #include "irtools.h"
+#include "timing_t.h"
 
 /**
  * Environment for if-conversion.
@@ -433,6 +434,7 @@ static void fill_waitq(ir_node *node, void *env) {
 
 void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback)
 {
+	ir_pass_begin(irg, "opt_if_conv_cb");
 	walker_env  env   = { .allow_ifconv = callback, .changed = false };
 	pdeq       *waitq = new_pdeq();
 
@@ -470,6 +472,7 @@ void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback)
 	confirm_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
 		| IR_GRAPH_PROPERTY_ONE_RETURN);
+	ir_pass_end("opt_if_conv_cb");
 }
 
 void opt_if_conv(ir_graph *irg)
@@ -26,6 +26,7 @@
 #include "irloop_t.h"
 #include "irprog_t.h"
 #include "irtools.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -53,6 +54,8 @@ void gc_irgs(size_t n_keep, ir_entity ** keep_arr)
 		return;
 	}
 
+	ir_pass_begin(NULL, "gc_irgs");
+
 	DB((dbg, LEVEL_1, "dead method elimination\n"));
 
 	/* Mark entities that are alive.  */
@@ -103,4 +106,5 @@ void gc_irgs(size_t n_keep, ir_entity ** keep_arr)
 		DB((dbg, LEVEL_1, "  freeing method %+F\n", ent));
 		free_ir_graph(irg);
 	}
+	ir_pass_end("gc_irgs");
 }
@@ -27,6 +27,7 @@
 #include "irflag_t.h"
 #include "iredges_t.h"
 #include "irtools.h"
+#include "timing_t.h"
 
 /**
  * A wrapper around optimize_inplace_2() to be called from a walker.
@@ -119,7 +120,9 @@ static void find_unreachable_blocks(ir_node *block, void *env)
 
 void local_optimize_graph(ir_graph *irg)
 {
+	ir_pass_begin(irg, "local_optimize_graph");
 	local_optimize_node(get_irg_end(irg));
+	ir_pass_end("local_optimize_graph");
 }
 
 /**
@@ -152,6 +155,7 @@ static void opt_walker(ir_node *n, void *env)
 
 void optimize_graph_df(ir_graph *irg)
 {
+	ir_pass_begin(irg, "optimize_graph_df");
 	pdeq *waitq = new_pdeq();
 
 	if (get_opt_global_cse())
@@ -209,6 +213,7 @@ void optimize_graph_df(ir_graph *irg)
 	 * Doing this AFTER edges where deactivated saves cycles */
 	ir_node *end = get_irg_end(irg);
 	remove_End_Bads_and_doublets(end);
+	ir_pass_end("optimize_graph_df");
 }
 
 void local_opts_const_code(void)
@@ -7657,48 +7657,39 @@ void ir_register_opt_node_ops(void)
  * in a graph. */
 #define N_IR_NODES 512
 
-static int identities_cmp(const void *elt, const void *key)
+static bool identities_equal(const ir_node *a, const ir_node *b)
 {
-	ir_node *a = (ir_node *)elt;
-	ir_node *b = (ir_node *)key;
-
 	if (a == b)
-		return 0;
+		return true;
 
-	if ((get_irn_op(a) != get_irn_op(b)) ||
-	    (get_irn_mode(a) != get_irn_mode(b)))
-	    return 1;
+	ir_op *const op = get_irn_op(a);
+	if (op != get_irn_op(b) || get_irn_mode(a) != get_irn_mode(b))
+		return false;
 
 	/* compare if a's in and b's in are of equal length */
 	int irn_arity_a = get_irn_arity(a);
 	if (irn_arity_a != get_irn_arity(b))
-		return 1;
+		return false;
 
 	/* blocks are never the same */
-	if (is_Block(a))
-		return 1;
+	if (op == op_Block)
+		return false;
 
-	if (get_irn_pinned(a)) {
-		/* for pinned nodes, the block inputs must be equal */
-		if (get_nodes_block(a) != get_nodes_block(b))
-			return 1;
-	} else {
-		ir_node *block_a = get_nodes_block(a);
-		ir_node *block_b = get_nodes_block(b);
-		if (!get_opt_global_cse()) {
-			/* for block-local CSE both nodes must be in the same Block */
-			if (block_a != block_b)
-				return 1;
-		} else {
-			/* The optimistic approach would be to do nothing here.
-			 * However doing GCSE optimistically produces a lot of partially dead code which appears
-			 * to be worse in practice than the missed opportunities.
-			 * So we use a very conservative variant here and only CSE if 1 value dominates the
-			 * other. */
-			if (!block_dominates(block_a, block_b)
-			 && !block_dominates(block_b, block_a))
-			    return 1;
-		}
+	ir_node *block_a = get_nodes_block(a);
+	ir_node *block_b = get_nodes_block(b);
+	if (block_a != block_b) {
+		/* for pinned nodes and block-local CSE both nodes must be in the
+		 * same Block */
+		if (get_irn_pinned(a) || !get_opt_global_cse())
+			return false;
+		/* The optimistic approach would be to do nothing here.
+		 * However doing GCSE optimistically produces a lot of partially dead code which appears
+		 * to be worse in practice than the missed opportunities.
+		 * So we use a very conservative variant here and only CSE if 1 value dominates the
+		 * other. */
+		if (!block_dominates(block_a, block_b)
+		 && !block_dominates(block_b, block_a))
+			return false;
 	}
 
 	/* compare a->in[0..ins] with b->in[0..ins] */
@@ -7706,12 +7697,12 @@ static int identities_cmp(const void *elt, const void *key)
 		ir_node *pred_a = get_irn_n(a, i);
 		ir_node *pred_b = get_irn_n(b, i);
 		if (pred_a != pred_b)
-			return 1;
+			return false;
 	}
 
 	/* here, we already know that the nodes are identical except their
 	 * attributes */
-	return !a->op->ops.attrs_equal(a, b);
+	return op->ops.attrs_equal(a, b);
 }
 
 unsigned ir_node_hash(const ir_node *node)
@@ -7722,14 +7713,14 @@ unsigned ir_node_hash(const ir_node *node)
 void new_identities(ir_graph *irg)
 {
 	if (irg->value_table != NULL)
-		del_pset(irg->value_table);
-	irg->value_table = new_pset(identities_cmp, N_IR_NODES);
+		ir_valuetable_free(irg->value_table);
+	irg->value_table = ir_valuetable_new(identities_equal, N_IR_NODES);
 }
 
 void del_identities(ir_graph *irg)
 {
 	if (irg->value_table != NULL)
-		del_pset(irg->value_table);
+		ir_valuetable_free(irg->value_table);
 }
 
 static int cmp_node_nr(const void *a, const void *b)
@@ -7783,15 +7774,15 @@ void ir_normalize_node(ir_node *n)
 
 ir_node *identify_remember(ir_node *n)
 {
-	ir_graph *irg         = get_irn_irg(n);
-	pset     *value_table = irg->value_table;
+	ir_graph        *irg         = get_irn_irg(n);
+	ir_valuetable_t *value_table = irg->value_table;
 
 	if (value_table == NULL)
 		return n;
 
 	ir_normalize_node(n);
 	/* lookup or insert in hash table with given hash key. */
-	ir_node *nn = (ir_node *)pset_insert(value_table, n, ir_node_hash(n));
+	ir_node *nn = ir_valuetable_insert(value_table, n, ir_node_hash(n));
 
 	/* nn is reachable again */
 	if (nn != n)
@@ -7831,9 +7822,7 @@ void add_identities(ir_node *node)
 
 void visit_all_identities(ir_graph *irg, irg_walk_func visit, void *env)
 {
-	foreach_pset(irg->value_table, ir_node, node) {
-		visit(node, env);
-	}
+	ir_valuetable_walk(irg->value_table, visit, env);
 }
 
 ir_node *optimize_node(ir_node *n)
@@ -26,6 +26,7 @@
 #include "iroptimize.h"
 #include "iropt_dbg.h"
 #include "vrp.h"
+#include "timing_t.h"
 
 #undef AVOID_PHIB
 
@@ -634,6 +635,7 @@ static void thread_jumps(ir_node* block, void* data)
 
 void opt_jumpthreading(ir_graph* irg)
 {
+	ir_pass_begin(irg, "opt_jumpthreading");
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
@@ -662,4 +664,5 @@ void opt_jumpthreading(ir_graph* irg)
 	} else {
 		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
 	}
+	ir_pass_end("opt_jumpthreading");
 }
@@ -36,6 +36,7 @@
 #include "tv_t.h"
 #include "type_t.h"
 #include "util.h"
+#include "timing_t.h"
 
 /** The debug handle. */
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
@@ -2251,11 +2252,14 @@ void combine_memops(ir_graph *irg)
 	if (!be_get_backend_param()->unaligned_memaccess_supported)
 		return;
 
+	ir_pass_begin(irg, "combine_memops");
 	irg_walk_graph(irg, combine_memop, NULL, NULL);
+	ir_pass_end("combine_memops");
 }
 
 void optimize_load_store(ir_graph *irg)
 {
+	ir_pass_begin(irg, "optimize_load_store");
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 	                         | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
 	                         | IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
@@ -2303,4 +2307,5 @@ void optimize_load_store(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_NO_BADS | IR_GRAPH_PROPERTY_NO_TUPLES
 		| IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
 		| IR_GRAPH_PROPERTY_MANY_RETURNS);
+	ir_pass_end("optimize_load_store");
 }
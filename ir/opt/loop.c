@@ -31,6 +31,7 @@
 #include "irouts.h"
 #include "irtools.h"
 #include "opt_init.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -2359,17 +2360,23 @@ static void loop_optimization(ir_graph *const irg, loop_op_t const loop_op)
 
 void do_loop_unrolling(ir_graph *const irg)
 {
+	ir_pass_begin(irg, "do_loop_unrolling");
 	loop_optimization(irg, loop_op_unrolling);
+	ir_pass_end("do_loop_unrolling");
 }
 
 void do_loop_inversion(ir_graph *const irg)
 {
+	ir_pass_begin(irg, "do_loop_inversion");
 	loop_optimization(irg, loop_op_inversion);
+	ir_pass_end("do_loop_inversion");
 }
 
 void do_loop_peeling(ir_graph *const irg)
 {
+	ir_pass_begin(irg, "do_loop_peeling");
 	loop_optimization(irg, loop_op_peeling);
+	ir_pass_end("do_loop_peeling");
 }
 
 void firm_init_loop_opt(void)
@@ -26,6 +26,7 @@
 #include "irnodemap.h"
 #include "dca.h"
 #include "constbits.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -76,6 +77,7 @@ static void fill_nodemap(ir_node *node, void *data) {
 
 void occult_consts(ir_graph *irg)
 {
+	ir_pass_begin(irg, "occult_consts");
 	FIRM_DBG_REGISTER(dbg, "firm.opt.occults");
 
 	constbits_analyze(irg);
@@ -96,4 +98,5 @@ void occult_consts(ir_graph *irg)
 	constbits_clear(irg);
 	confirm_irg_properties(irg,
 			env.changed ? IR_GRAPH_PROPERTIES_NONE : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_end("occult_consts");
 }
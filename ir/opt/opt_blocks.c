@@ -22,6 +22,7 @@
 #include "set.h"
 #include "debug.h"
 #include "util.h"
+#include "timing_t.h"
 
 /* define this for general block shaping: congruent blocks
    are found not only before the end block but anywhere in the graph */
@@ -1163,6 +1164,7 @@ static void add_roots(ir_graph *irg, environment_t *env)
 /* Combines congruent end blocks into one. */
 void shape_blocks(ir_graph *irg)
 {
+	ir_pass_begin(irg, "shape_blocks");
 	environment_t env;
 	block_t       *bl;
 	int           res, n;
@@ -1237,4 +1239,5 @@ void shape_blocks(ir_graph *irg)
 	DEL_ARR_F(env.live_outs);
 	del_set(env.opcode2id_map);
 	obstack_free(&env.obst, NULL);
+	ir_pass_end("shape_blocks");
 }
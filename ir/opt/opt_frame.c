@@ -16,6 +16,7 @@
 #include "type_t.h"
 #include "irouts_t.h"
 #include "iredges_t.h"
+#include "timing_t.h"
 
 /*
  * Optimize the frame type of an irg by removing
@@ -28,6 +29,7 @@ void opt_frame_irg(ir_graph *irg)
 	if (n <= 0)
 		return;
 
+	ir_pass_begin(irg, "opt_frame_irg");
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 	irp_reserve_resources(irp, IRP_RESOURCE_ENTITY_LINK);
 
@@ -80,4 +82,5 @@ void opt_frame_irg(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 		| IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
 		| IR_GRAPH_PROPERTY_MANY_RETURNS);
+	ir_pass_end("opt_frame_irg");
 }
@@ -9,6 +9,7 @@
  * @author   Michael Beck, Goetz Lindenmaier
  */
 #include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <assert.h>
 
@@ -45,9 +46,17 @@
 #include "irtools.h"
 #include "iropt_dbg.h"
 #include "irnodemap.h"
+#include "execfreq.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
+/** Profiled calls executed less often per caller invocation are cold. */
+#define COLD_CALL_FREQ 0.01
+/** Profiled calls executed at least this often per caller invocation are
+ * hot. */
+#define HOT_CALL_FREQ  1.0
+
 /**
  * Remember the new node in the old node by using a field all nodes have.
  */
@@ -121,7 +130,7 @@ static void find_addr(ir_node *node, void *env)
 		 */
 		*allow_inline = false;
 	} else if (is_Member(node)) {
-		ir_graph *irg = current_ir_graph;
+		ir_graph *irg = get_irn_irg(node);
 		if (get_Member_ptr(node) == get_irg_frame(irg)) {
 			/* access to frame */
 			ir_entity *ent = get_Member_entity(node);
@@ -326,9 +335,6 @@ static bool inline_method(ir_node *const call, ir_graph *called_graph)
 	if (called_graph == irg)
 		return false;
 
-	ir_graph *rem = current_ir_graph;
-	current_ir_graph = irg;
-
 	DB((dbg, LEVEL_1, "Inlining %+F(%+F) into %+F\n", call, called_graph, irg));
 
 	/* optimizations can cause problems when allocating new nodes */
@@ -617,7 +623,6 @@ static bool inline_method(ir_node *const call, ir_graph *called_graph)
 
 	/* --  Turn CSE back on. -- */
 	set_optimize(rem_opt);
-	current_ir_graph = rem;
 
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 
@@ -632,6 +637,9 @@ typedef struct call_entry {
 	ir_graph   *callee;     /**< The callee IR-graph. */
 	list_head  list;        /**< List head for linking the next one. */
 	int        loop_depth;  /**< The loop depth of this call. */
+	double     freq;        /**< Profiled executions of this call per
+	                             execution of the caller, negative if
+	                             unknown. */
 	int        benefice;    /**< The calculated benefice of this call. */
 	bool       all_const:1; /**< Set if this call has only constant parameters. */
 } call_entry;
@@ -643,6 +651,7 @@ typedef struct {
 	list_head calls;             /**< List of of all call nodes in this graph. */
 	unsigned  *local_weights;    /**< Once allocated, the beneficial weight for transmitting local addresses. */
 	unsigned  n_nodes;           /**< Number of nodes in graph except Id, Tuple, Proj, Start, End. */
+	unsigned  n_hot_nodes;       /**< Number of nodes added by inlining hot calls. */
 	unsigned  n_blocks;          /**< Number of Blocks in graph without Start and End block. */
 	unsigned  n_nodes_orig;      /**< for statistics */
 	unsigned  n_call_nodes;      /**< Number of Call nodes in the graph. */
@@ -662,6 +671,7 @@ static inline_irg_env *alloc_inline_irg_env(void)
 	INIT_LIST_HEAD(&env->calls);
 	env->local_weights     = NULL;
 	env->n_nodes           = 0;
+	env->n_hot_nodes       = 0;
 	env->n_blocks          = -1; /* do not count count End Block */
 	env->n_nodes_orig      = 0;
 	env->n_call_nodes      = 0;
@@ -741,7 +751,7 @@ static void collect_calls2(ir_node *node, void *ctx)
 			++callee_env->n_callers;
 			++callee_env->n_callers_orig;
 		}
-		if (callee == current_ir_graph)
+		if (callee == get_irn_irg(node))
 			x->recursive = 1;
 
 		/* link it in the list of possible inlinable entries */
@@ -749,6 +759,7 @@ static void collect_calls2(ir_node *node, void *ctx)
 		entry->call       = node;
 		entry->callee     = callee;
 		entry->loop_depth = get_irn_loop(get_nodes_block(node))->depth;
+		entry->freq       = -1.0;
 		entry->benefice   = 0;
 		entry->all_const  = false;
 
@@ -756,6 +767,24 @@ static void collect_calls2(ir_node *node, void *ctx)
 	}
 }
 
+/**
+ * Sets the profiled frequencies of the calls collected for the graph of
+ * @p caller.
+ */
+static void set_call_freqs(inline_irg_env *env, ir_entity const *caller)
+{
+	unsigned long long const entry_count = ir_profile_get_entry_count(caller);
+	if (entry_count == 0)
+		return;
+
+	list_for_each_entry(call_entry, entry, &env->calls, list) {
+		unsigned long long const count
+			= ir_profile_get_call_count(caller, entry->call);
+		entry->freq = (double)count / entry_count;
+		DB((dbg, LEVEL_3, "%+F: freq %.3g\n", entry->call, entry->freq));
+	}
+}
+
 /**
  * Duplicate a call entry.
  *
@@ -763,15 +792,20 @@ static void collect_calls2(ir_node *node, void *ctx)
  * @param new_call  the new call node
  * @param loop_depth_delta
  *                  delta value for the loop depth
+ * @param freq_factor
+ *                  profiled frequency of the inlined call, negative if unknown
  */
 static call_entry *duplicate_call_entry(const call_entry *entry,
-                                        ir_node *new_call, int loop_depth_delta)
+                                        ir_node *new_call, int loop_depth_delta,
+                                        double freq_factor)
 {
 	call_entry *nentry = OALLOC(&temp_obst, call_entry);
 	nentry->call       = new_call;
 	nentry->callee     = entry->callee;
 	nentry->benefice   = entry->benefice;
 	nentry->loop_depth = entry->loop_depth + loop_depth_delta;
+	nentry->freq       = entry->freq < 0 || freq_factor < 0
+	                   ? -1.0 : entry->freq * freq_factor;
 	nentry->all_const  = entry->all_const;
 
 	return nentry;
@@ -875,6 +909,9 @@ static unsigned get_method_local_adress_weight(ir_graph *callee, size_t pos)
 /**
  * Calculate a benefice value for inlining the given call.
  *
+ * If the caller was profiled, the frequency of the call replaces its loop
+ * depth, and rarely executed calls are not inlined at all.
+ *
  * @param call       the call node we have to inspect
  * @param callee     the called graph
  */
@@ -914,7 +951,8 @@ static int calc_inline_benefice(call_entry *entry, ir_graph *callee)
 	}
 
 	/* constant parameters improve the benefice */
-	ir_node *frame_ptr = get_irg_frame(current_ir_graph);
+	ir_graph *caller    = get_irn_irg(call);
+	ir_node  *frame_ptr = get_irg_frame(caller);
 	bool     all_const = true;
 	for (size_t i = 0; i < n_params; ++i) {
 		ir_node *param = get_Call_param(call, i);
@@ -940,9 +978,14 @@ static int calc_inline_benefice(call_entry *entry, ir_graph *callee)
 
 	inline_irg_env *callee_env = (inline_irg_env*)get_irg_link(callee);
 	if (callee_env->n_callers == 1 &&
-	    callee != current_ir_graph &&
+	    callee != caller &&
 	    !entity_is_externally_visible(ent)) {
 		weight += 700;
+	} else if (entry->freq >= 0 && entry->freq < COLD_CALL_FREQ) {
+		/* inlining a function with other callers only grows cold code */
+		DB((dbg, LEVEL_2, "In %+F Call to %+F: cold (%.3g)\n", call, callee,
+		    entry->freq));
+		return entry->benefice = INT_MIN;
 	}
 
 	/* give a bonus for functions with one block */
@@ -959,10 +1002,15 @@ static int calc_inline_benefice(call_entry *entry, ir_graph *callee)
 		weight += 400;
 
 	/** it's important to inline inner loops first */
-	if (entry->loop_depth > 30)
+	if (entry->freq >= 0) {
+		/* a call executed 2^n times per caller execution counts like one in
+		 * a loop of depth n */
+		weight += (int64_t)(MIN(log2(1.0 + entry->freq), 30.0) * 1024);
+	} else if (entry->loop_depth > 30) {
 		weight += 30 * 1024;
-	else
+	} else {
 		weight += entry->loop_depth * 1024;
+	}
 
 	/*
 	 * All arguments constant is probably a good sign, give an extra bonus
@@ -1055,12 +1103,26 @@ static void maybe_push_call(pqueue_t *pqueue, call_entry *call,
 	pqueue_put(pqueue, call, benefice);
 }
 
+/**
+ * Checks whether inlining @p call_entry into the graph with environment
+ * @p env stays within the size budget. Hot calls get a separate budget, so
+ * they are not crowded out by other calls and vice versa.
+ */
+static bool fits_budget(inline_irg_env const *env, call_entry const *call,
+                        inline_irg_env const *callee_env, unsigned maxsize)
+{
+	if (call->freq >= HOT_CALL_FREQ)
+		return env->n_hot_nodes + callee_env->n_nodes <= maxsize;
+	return env->n_nodes - env->n_hot_nodes + callee_env->n_nodes <= maxsize;
+}
+
 /**
  * Try to inline calls into a graph.
  *
  * @param irg      the graph into which we inline
  * @param maxsize  do NOT inline if the size of irg gets
- *                 bigger than this amount
+ *                 bigger than this amount, hot calls have a budget of
+ *                 the same size
  * @param inline_threshold
  *                 threshold value for inline decision
  * @param copied_graphs
@@ -1078,7 +1140,6 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 		return;
 	}
 
-	current_ir_graph = irg;
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
 
 	/* put irgs into the pqueue */
@@ -1099,7 +1160,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 		mtp_additional_properties props
 			= get_entity_additional_properties(ent);
 		if (!(props & mtp_property_always_inline)
-		    && env->n_nodes + callee_env->n_nodes > maxsize) {
+		    && !fits_budget(env, curr_call, callee_env, maxsize)) {
 			DB((dbg, LEVEL_2, "%+F: too big (%d) + %+F (%d)\n", irg,
 			    env->n_nodes, callee, callee_env->n_nodes));
 			continue;
@@ -1124,7 +1185,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 			callee_env = (inline_irg_env*)get_irg_link(callee);
 		}
 
-		if (current_ir_graph == callee) {
+		if (irg == callee) {
 			/*
 			 * Recursive call: we cannot directly inline because we cannot
 			 * walk the graph and change it. So we have to make a copy of
@@ -1162,6 +1223,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 			assure_irg_properties(copy, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 			wenv_t wenv = { .x = callee_env, .ignore_callers = true };
 			irg_walk_graph(copy, NULL, collect_calls2, &wenv);
+			set_call_freqs(callee_env, get_irg_entity(callee));
 
 			/*
 			 * Enter the entity of the original graph. This is needed
@@ -1179,7 +1241,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 		}
 		if (!phiproj_computed) {
 			phiproj_computed = true;
-			collect_phiprojs_and_start_block_nodes(current_ir_graph);
+			collect_phiprojs_and_start_block_nodes(irg);
 		}
 		ir_reserve_resources(callee, IR_RESOURCE_IRN_LINK);
 		bool did_inline = inline_method(curr_call->call, callee);
@@ -1221,7 +1283,8 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 			assert(is_Call(new_call));
 
 			call_entry *new_entry
-				= duplicate_call_entry(centry, new_call, loop_depth);
+				= duplicate_call_entry(centry, new_call, loop_depth,
+				                       curr_call->freq);
 			list_add_tail(&new_entry->list, &env->calls);
 			maybe_push_call(pqueue, new_entry, inline_threshold);
 		}
@@ -1229,6 +1292,8 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 
 		env->n_call_nodes += callee_env->n_call_nodes;
 		env->n_nodes += callee_env->n_nodes;
+		if (curr_call->freq >= HOT_CALL_FREQ)
+			env->n_hot_nodes += callee_env->n_nodes;
 		--callee_env->n_callers;
 	}
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
@@ -1242,7 +1307,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 void inline_functions(unsigned maxsize, int inline_threshold,
                       opt_ptr after_inline_opt)
 {
-	ir_graph *rem = current_ir_graph;
+	ir_pass_begin(NULL, "inline_functions");
 	obstack_init(&temp_obst);
 
 	ir_graph **irgs = create_irg_list();
@@ -1266,6 +1331,7 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 		wenv.x = (inline_irg_env*)get_irg_link(irg);
 		assure_loopinfo(irg);
 		irg_walk_graph(irg, NULL, collect_calls2, &wenv);
+		set_call_freqs(wenv.x, get_irg_entity(irg));
 	}
 
 	/* -- and now inline. -- */
@@ -1303,7 +1369,7 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 	free(irgs);
 
 	obstack_free(&temp_obst, NULL);
-	current_ir_graph = rem;
+	ir_pass_end("inline_functions");
 }
 
 void firm_init_inline(void)
@@ -28,6 +28,7 @@
 #include "debug.h"
 #include "panic.h"
 #include "type_t.h"
+#include "timing_t.h"
 
 /* maximum number of output Proj's */
 #define MAX_PROJ MAX((unsigned)pn_Load_max, (unsigned)pn_Store_max)
@@ -1432,7 +1433,7 @@ static void reroute_all_mem_users(ir_node *omem, ir_node *nmem)
 	}
 
 	/* all edges previously point to omem now point to nmem */
-	nmem->o.out = omem->o.out;
+	set_irn_outs(nmem, get_irn_outs(omem));
 }
 
 /**
@@ -1473,7 +1474,7 @@ static void reroute_mem_through(ir_node *omem, ir_node *nmem, ir_node *pass_bl)
 	   temporary obstack here. This should be no problem, as we invalidate the
 	   edges at the end either. */
 	/* first entry is used for the length */
-	nmem->o.out = new_out;
+	set_irn_outs(nmem, new_out);
 }
 
 /**
@@ -1753,6 +1754,7 @@ static void insert_Loads_upwards(void)
 
 void opt_ldst(ir_graph *irg)
 {
+	ir_pass_begin(irg, "opt_ldst");
 	block_t *bl;
 
 	FIRM_DBG_REGISTER(dbg, "firm.opt.ldst");
@@ -1885,4 +1887,5 @@ no_changes:
 #ifdef DEBUG_libfirm
 	DEL_ARR_F(env.id_2_address);
 #endif
+	ir_pass_end("opt_ldst");
 }
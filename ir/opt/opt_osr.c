@@ -36,6 +36,7 @@
 #include "set.h"
 #include "tv.h"
 #include "util.h"
+#include "timing_t.h"
 
 /** The debug handle. */
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
@@ -1186,6 +1187,7 @@ static void lftr(ir_graph *irg, iv_env *env)
 /* Remove any Phi cycles with only one real input. */
 void remove_phi_cycles(ir_graph *irg)
 {
+	ir_pass_begin(irg, "remove_phi_cycles");
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
@@ -1232,6 +1234,7 @@ void remove_phi_cycles(ir_graph *irg)
 	obstack_free(&env.obst, NULL);
 
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_end("remove_phi_cycles");
 }
 
 /**
@@ -1303,6 +1306,7 @@ static void fix_adds_and_subs(ir_node *irn, void *ctx)
 /* Performs Operator Strength Reduction for the passed graph. */
 void opt_osr(ir_graph *irg, unsigned flags)
 {
+	ir_pass_begin(irg, "opt_osr");
 	FIRM_DBG_REGISTER(dbg, "firm.opt.osr");
 
 	assure_irg_properties(irg,
@@ -1357,4 +1361,5 @@ void opt_osr(ir_graph *irg, unsigned flags)
 	obstack_free(&env.obst, NULL);
 
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+	ir_pass_end("opt_osr");
 }
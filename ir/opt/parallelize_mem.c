@@ -24,6 +24,7 @@
 #include "irflag_t.h"
 #include "iredges_t.h"
 #include "type_t.h"
+#include "timing_t.h"
 
 typedef struct parallelize_info
 {
@@ -495,6 +496,7 @@ static void eliminate_sync_edges(ir_graph *irg)
 
 void opt_parallelize_mem(ir_graph *irg)
 {
+	ir_pass_begin(irg, "opt_parallelize_mem");
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
 	                           | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 	irg_walk_blkwise_dom_top_down(irg, NULL, walker, NULL);
@@ -502,4 +504,5 @@ void opt_parallelize_mem(ir_graph *irg)
 	eliminate_sync_edges(irg);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_end("opt_parallelize_mem");
 }
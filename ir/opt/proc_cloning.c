@@ -32,6 +32,7 @@
 #include "irgmod.h"
 #include "array.h"
 #include "panic.h"
+#include "timing_t.h"
 
 /**
  * This struct contains the information quadruple for a Call, which we need to
@@ -573,6 +574,7 @@ restart:
 
 void proc_cloning(float threshold)
 {
+	ir_pass_begin(NULL, "proc_cloning");
 	DEBUG_ONLY(firm_dbg_module_t *dbg;)
 
 	/* register a debug mask */
@@ -651,4 +653,5 @@ void proc_cloning(float threshold)
 		}
 	}
 	obstack_free(&hmap.obst, NULL);
+	ir_pass_end("proc_cloning");
 }
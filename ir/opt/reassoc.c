@@ -31,6 +31,7 @@
 
 #include "unionfind.h"
 #include "plist.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -2075,6 +2076,7 @@ static void do_chaining(ir_graph *irg)
  */
 void optimize_reassociation(ir_graph *irg)
 {
+	ir_pass_begin(irg, "optimize_reassociation");
 	assert(get_irg_pinned(irg) != op_pin_state_floats &&
 	       "Reassociation needs pinned graph to work properly");
 
@@ -2116,6 +2118,7 @@ void optimize_reassociation(ir_graph *irg)
 	del_pdeq(wq);
 
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_end("optimize_reassociation");
 }
 
 void ir_register_reassoc_node_ops(void)
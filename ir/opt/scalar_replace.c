@@ -30,6 +30,7 @@
 #include "tv.h"
 #include "util.h"
 #include "xmalloc.h"
+#include "timing_t.h"
 
 static unsigned get_vnum(const ir_node *node)
 {
@@ -562,6 +563,7 @@ static void do_scalar_replacements(ir_graph *irg, pset *members, unsigned nvals,
  */
 void scalar_replacement_opt(ir_graph *irg)
 {
+	ir_pass_begin(irg, "scalar_replacement_opt");
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 	                         | IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 	                         | IR_GRAPH_PROPERTY_NO_TUPLES);
@@ -640,6 +642,7 @@ void scalar_replacement_opt(ir_graph *irg)
 
 	confirm_irg_properties(irg, changed ? IR_GRAPH_PROPERTIES_NONE
 	                                    : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_end("scalar_replacement_opt");
 }
 
 void firm_init_scalar_replace(void)
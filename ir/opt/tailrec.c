@@ -27,6 +27,7 @@
 #include "irhooks.h"
 #include "ircons_t.h"
 #include "util.h"
+#include "timing_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -584,6 +585,7 @@ static unsigned find_tail_rec_possibilities(tr_env *env, ir_graph *irg)
 
 void opt_tail_rec_irg(ir_graph *irg)
 {
+	ir_pass_begin(irg, "opt_tail_rec_irg");
 	FIRM_DBG_REGISTER(dbg, "firm.opt.tailrec");
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_MANY_RETURNS
@@ -610,4 +612,5 @@ void opt_tail_rec_irg(ir_graph *irg)
 	free(env.variants);
 	free(env.parameter_projs);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_pass_end("opt_tail_rec_irg");
 }
@@ -9,23 +9,37 @@
  * @author      Sebastian Hack
  * @date        17.06.2007
  */
+#define _POSIX_C_SOURCE 200809L
 #include <assert.h>
+#ifdef FIRM_THREADS
+#include <pthread.h>
+#endif
 #include <regex.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "stat_timing.h"
+#include "hashptr.h"
 #include "irprintf.h"
 #include "statev_t.h"
 #include "util.h"
+#include "xmalloc.h"
 
 #define MAX_TIMER 256
 
+/** Number of records in a buffer of the binary log. */
+#define BUFFER_RECORDS 4096
+/** Context values longer than this are truncated in the binary log. */
+#define MAX_VALUE_LEN  1024
+
 int (stat_ev_enabled) = 0;
 
 static FILE          *stat_ev_file;
+static bool           stat_ev_binary;
 static int            stat_ev_timer_sp;
 static timing_ticks_t stat_ev_timer_elapsed[MAX_TIMER];
 static timing_ticks_t stat_ev_timer_start[MAX_TIMER];
@@ -33,17 +47,355 @@ static timing_ticks_t stat_ev_timer_start[MAX_TIMER];
 static regex_t  regex;
 static regex_t *filter;
 
-static bool key_matches(const char *key)
+/**
+ * An interned key. The filter is evaluated once per key, the binary log
+ * refers to keys by their number.
+ */
+typedef struct statev_key_t {
+	char const *name;
+	unsigned    hash;
+	uint32_t    nr;
+	bool        matches;
+	bool        written; /**< key record written to the binary log */
+} statev_key_t;
+
+static statev_key_t *keys;      /**< open addressing table of keys */
+static size_t        keys_size; /**< size of the table, a power of 2 */
+static uint32_t      n_keys;
+
+/**
+ * A record of the binary log. Records are 16 bytes; keys and context values
+ * are followed by their characters, padded to whole records.
+ */
+typedef struct statev_record_t {
+	uint8_t  kind;
+	uint8_t  pad[3];
+	uint32_t key;
+	uint64_t value;
+} statev_record_t;
+
+/** Kinds of the binary log records, see support/statev_decode.py. */
+enum {
+	REC_THREAD = 'T', /**< key: thread, value: number of following records */
+	REC_KEY    = 'K', /**< key: number, value: length, followed by the name */
+	REC_PUSH   = 'P', /**< value: length, followed by the context value */
+	REC_POP    = 'O',
+	REC_INT    = 'I', /**< value: signed 64 bit integer */
+	REC_ULL    = 'U', /**< value: unsigned 64 bit integer */
+	REC_DBL    = 'D', /**< value: bits of a double */
+	REC_NONE   = 'N', /**< event without a value */
+};
+
+typedef struct ev_buffer_t ev_buffer_t;
+struct ev_buffer_t {
+	ev_buffer_t    *next;   /**< next buffer in the write queue/free list */
+	uint32_t        thread; /**< number of the thread filling this buffer */
+	size_t          n_records;
+	statev_record_t records[BUFFER_RECORDS];
+};
+
+/** Per thread state of the binary log. */
+typedef struct ev_thread_t ev_thread_t;
+struct ev_thread_t {
+	ev_thread_t *next;
+	uint32_t     nr;
+	ev_buffer_t *buffer;
+};
+
+#ifdef FIRM_THREADS
+static pthread_mutex_t key_lock        = PTHREAD_MUTEX_INITIALIZER;
+/** Created for each binary log, so no thread keeps the state of an older
+ * one. */
+static pthread_key_t   thread_key;
+/** Protects everything below. */
+static pthread_mutex_t writer_lock     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  writer_cond     = PTHREAD_COND_INITIALIZER;
+static pthread_t       writer;
+static bool            writer_stop;
+static ev_buffer_t    *write_queue;
+static ev_buffer_t   **write_queue_tail = &write_queue;
+#else
+/** Without threads the buffers are written by the only thread. */
+static ev_thread_t    *the_thread;
+#endif
+static ev_buffer_t    *free_buffers;
+static ev_thread_t    *threads;
+static uint32_t        n_threads;
+
+static void lock_keys(void)
+{
+#ifdef FIRM_THREADS
+	pthread_mutex_lock(&key_lock);
+#endif
+}
+
+static void unlock_keys(void)
+{
+#ifdef FIRM_THREADS
+	pthread_mutex_unlock(&key_lock);
+#endif
+}
+
+static void lock_writer(void)
+{
+#ifdef FIRM_THREADS
+	pthread_mutex_lock(&writer_lock);
+#endif
+}
+
+static void unlock_writer(void)
+{
+#ifdef FIRM_THREADS
+	pthread_mutex_unlock(&writer_lock);
+#endif
+}
+
+static statev_key_t *find_key_slot(statev_key_t *table, size_t size,
+                                   char const *name, unsigned hash)
+{
+	for (size_t i = hash & (size - 1);; i = (i + 1) & (size - 1)) {
+		statev_key_t *const slot = &table[i];
+		if (slot->name == NULL
+		    || (slot->hash == hash && strcmp(slot->name, name) == 0))
+			return slot;
+	}
+}
+
+/**
+ * Returns a copy of the interned key for @p name. Its written flag is only
+ * false for the first lookup.
+ */
+static statev_key_t get_key(char const *const name)
+{
+	unsigned const hash = hash_str(name);
+	lock_keys();
+	if (2 * (n_keys + 1) > keys_size) {
+		size_t        const new_size = keys_size == 0 ? 64 : 2 * keys_size;
+		statev_key_t *const new_keys = XMALLOCNZ(statev_key_t, new_size);
+		for (size_t i = 0; i < keys_size; ++i) {
+			statev_key_t const *const key = &keys[i];
+			if (key->name != NULL)
+				*find_key_slot(new_keys, new_size, key->name, key->hash) = *key;
+		}
+		free(keys);
+		keys      = new_keys;
+		keys_size = new_size;
+	}
+
+	statev_key_t *const slot = find_key_slot(keys, keys_size, name, hash);
+	if (slot->name == NULL) {
+		slot->name    = xstrdup(name);
+		slot->hash    = hash;
+		slot->nr      = n_keys++;
+		slot->matches = filter == NULL
+		             || regexec(filter, name, 0, NULL, 0) == 0;
+	}
+	statev_key_t const result = *slot;
+	slot->written = true;
+	unlock_keys();
+	return result;
+}
+
+static void free_keys(void)
+{
+	for (size_t i = 0; i < keys_size; ++i)
+		free((char*)keys[i].name);
+	free(keys);
+	keys      = NULL;
+	keys_size = 0;
+	n_keys    = 0;
+}
+
+static void write_buffer(ev_buffer_t const *const buffer)
+{
+	statev_record_t const header = {
+		.kind  = REC_THREAD,
+		.key   = buffer->thread,
+		.value = buffer->n_records,
+	};
+	fwrite(&header, sizeof(header), 1, stat_ev_file);
+	fwrite(buffer->records, sizeof(buffer->records[0]), buffer->n_records,
+	       stat_ev_file);
+}
+
+#ifdef FIRM_THREADS
+static void *writer_main(void *arg)
+{
+	(void)arg;
+	pthread_mutex_lock(&writer_lock);
+	for (;;) {
+		while (write_queue == NULL && !writer_stop)
+			pthread_cond_wait(&writer_cond, &writer_lock);
+		ev_buffer_t *const buffer = write_queue;
+		if (buffer == NULL)
+			break;
+		write_queue = buffer->next;
+		if (write_queue == NULL)
+			write_queue_tail = &write_queue;
+		pthread_mutex_unlock(&writer_lock);
+
+		write_buffer(buffer);
+
+		pthread_mutex_lock(&writer_lock);
+		buffer->next = free_buffers;
+		free_buffers = buffer;
+	}
+	pthread_mutex_unlock(&writer_lock);
+	return NULL;
+}
+#endif
+
+/** Takes a free buffer. Must be called with writer_lock held. */
+static ev_buffer_t *new_buffer(uint32_t const thread)
+{
+	ev_buffer_t *buffer = free_buffers;
+	if (buffer != NULL) {
+		free_buffers = buffer->next;
+	} else {
+		buffer = XMALLOC(ev_buffer_t);
+	}
+	buffer->next      = NULL;
+	buffer->thread    = thread;
+	buffer->n_records = 0;
+	return buffer;
+}
+
+/**
+ * Queues a buffer for writing, without threads it is written right away.
+ * Must be called with writer_lock held.
+ */
+static void queue_buffer(ev_buffer_t *const buffer)
+{
+#ifdef FIRM_THREADS
+	if (buffer->n_records != 0) {
+		buffer->next      = NULL;
+		*write_queue_tail = buffer;
+		write_queue_tail  = &buffer->next;
+		pthread_cond_signal(&writer_cond);
+		return;
+	}
+#else
+	if (buffer->n_records != 0)
+		write_buffer(buffer);
+#endif
+	buffer->next = free_buffers;
+	free_buffers = buffer;
+}
+
+/** Frees the buffers which are neither filled nor queued. */
+static void free_buffer_list(void)
+{
+	for (ev_buffer_t *buffer = free_buffers, *next; buffer != NULL;
+	     buffer = next) {
+		next = buffer->next;
+		free(buffer);
+	}
+	free_buffers = NULL;
+}
+
+#ifdef FIRM_THREADS
+static void thread_exit(void *ptr)
+{
+	ev_thread_t *const thread = (ev_thread_t*)ptr;
+	pthread_mutex_lock(&writer_lock);
+	for (ev_thread_t **anchor = &threads; *anchor != NULL;
+	     anchor = &(*anchor)->next) {
+		if (*anchor == thread) {
+			*anchor = thread->next;
+			break;
+		}
+	}
+	queue_buffer(thread->buffer);
+	pthread_mutex_unlock(&writer_lock);
+	free(thread);
+}
+#endif
+
+/**
+ * Returns @p n consecutive records in the buffer of the calling thread. A
+ * full buffer is handed to the writer thread.
+ */
+static statev_record_t *reserve_records(size_t const n)
+{
+	assert(n <= BUFFER_RECORDS);
+#ifdef FIRM_THREADS
+	ev_thread_t *thread = (ev_thread_t*)pthread_getspecific(thread_key);
+#else
+	ev_thread_t *thread = the_thread;
+#endif
+	if (thread == NULL) {
+		thread = XMALLOC(ev_thread_t);
+		lock_writer();
+		thread->nr     = n_threads++;
+		thread->buffer = new_buffer(thread->nr);
+		thread->next   = threads;
+		threads        = thread;
+		unlock_writer();
+#ifdef FIRM_THREADS
+		pthread_setspecific(thread_key, thread);
+#else
+		the_thread = thread;
+#endif
+	}
+
+	ev_buffer_t *buffer = thread->buffer;
+	if (buffer->n_records + n > BUFFER_RECORDS) {
+		lock_writer();
+		queue_buffer(buffer);
+		buffer = thread->buffer = new_buffer(thread->nr);
+		unlock_writer();
+	}
+	statev_record_t *const res = &buffer->records[buffer->n_records];
+	buffer->n_records += n;
+	return res;
+}
+
+/** Appends a record followed by the @p len characters of @p str. */
+static void write_record_str(uint8_t const kind, uint32_t const key,
+                             char const *const str, size_t const len)
+{
+	size_t           const n_str = (len + sizeof(statev_record_t) - 1)
+	                             / sizeof(statev_record_t);
+	statev_record_t *const rec   = reserve_records(1 + n_str);
+	memset(rec, 0, (1 + n_str) * sizeof(*rec));
+	rec->kind  = kind;
+	rec->key   = key;
+	rec->value = len;
+	memcpy(rec + 1, str, len);
+}
+
+/**
+ * Interns @p name and checks it against the filter. The first use of a key
+ * writes its name to the binary log.
+ */
+static bool lookup_key(char const *const name, uint32_t *const nr)
 {
-	if (filter == NULL)
-		return true;
+	statev_key_t const key = get_key(name);
+	if (!key.matches)
+		return false;
+	if (stat_ev_binary && !key.written)
+		write_record_str(REC_KEY, key.nr, name, strlen(name));
+	*nr = key.nr;
+	return true;
+}
 
-	return regexec(filter, key, 0, NULL, 0) == 0;
+static void write_record(uint8_t const kind, char const *const name,
+                         uint64_t const value)
+{
+	uint32_t key;
+	if (!lookup_key(name, &key))
+		return;
+	statev_record_t *const rec = reserve_records(1);
+	memset(rec, 0, sizeof(*rec));
+	rec->kind  = kind;
+	rec->key   = key;
+	rec->value = value;
 }
 
 static void stat_ev_vprintf(char ev, const char *key, const char *fmt, va_list ap)
 {
-	if (!key_matches(key))
+	uint32_t nr;
+	if (!lookup_key(key, &nr))
 		return;
 
 	putc(ev, stat_ev_file);
@@ -96,11 +448,40 @@ void stat_ev_tim_pop(const char *name)
 	}
 }
 
-void do_stat_ev_ctx_push_vfmt(const char *key, const char *fmt, va_list ap)
+/**
+ * Stops the running timers while an event is written, so they do not count
+ * the time spent in statev. Without a running timer there is nothing to do,
+ * which avoids switching the scheduling priority for every event.
+ */
+static bool pause_timers(void)
 {
+	if (stat_ev_timer_sp == 0)
+		return false;
 	stat_ev_tim_push();
-	stat_ev_vprintf('P', key, fmt, ap);
-	stat_ev_tim_pop(NULL);
+	return true;
+}
+
+static void resume_timers(bool const paused)
+{
+	if (paused)
+		stat_ev_tim_pop(NULL);
+}
+
+void do_stat_ev_ctx_push_vfmt(const char *key, const char *fmt, va_list ap)
+{
+	bool const paused = pause_timers();
+	if (stat_ev_binary) {
+		uint32_t nr;
+		if (lookup_key(key, &nr)) {
+			char      buf[MAX_VALUE_LEN];
+			int const len = ir_vsnprintf(buf, sizeof(buf), fmt, ap);
+			write_record_str(REC_PUSH, nr, buf,
+			                 MIN((size_t)MAX(len, 0), sizeof(buf) - 1));
+		}
+	} else {
+		stat_ev_vprintf('P', key, fmt, ap);
+	}
+	resume_timers(paused);
 }
 
 void (stat_ev_ctx_push_fmt)(const char *key, const char *fmt, ...)
@@ -121,9 +502,13 @@ void (stat_ev_ctx_push_str)(const char *key, const char *str)
 
 void do_stat_ev_ctx_pop(const char *key)
 {
-	stat_ev_tim_push();
-	stat_ev_printf('O', key, NULL);
-	stat_ev_tim_pop(NULL);
+	bool const paused = pause_timers();
+	if (stat_ev_binary) {
+		write_record(REC_POP, key, 0);
+	} else {
+		stat_ev_printf('O', key, NULL);
+	}
+	resume_timers(paused);
 }
 
 void (stat_ev_ctx_pop)(const char *key)
@@ -133,9 +518,15 @@ void (stat_ev_ctx_pop)(const char *key)
 
 void do_stat_ev_dbl(const char *name, double value)
 {
-	stat_ev_tim_push();
-	stat_ev_printf('E', name, "%g", value);
-	stat_ev_tim_pop(NULL);
+	bool const paused = pause_timers();
+	if (stat_ev_binary) {
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		write_record(REC_DBL, name, bits);
+	} else {
+		stat_ev_printf('E', name, "%g", value);
+	}
+	resume_timers(paused);
 }
 
 void (stat_ev_dbl)(const char *name, double value)
@@ -145,9 +536,13 @@ void (stat_ev_dbl)(const char *name, double value)
 
 void do_stat_ev_int(const char *name, int value)
 {
-	stat_ev_tim_push();
-	stat_ev_printf('E', name, "%d", value);
-	stat_ev_tim_pop(NULL);
+	bool const paused = pause_timers();
+	if (stat_ev_binary) {
+		write_record(REC_INT, name, (uint64_t)(int64_t)value);
+	} else {
+		stat_ev_printf('E', name, "%d", value);
+	}
+	resume_timers(paused);
 }
 
 void (stat_ev_int)(const char *name, int value)
@@ -157,9 +552,13 @@ void (stat_ev_int)(const char *name, int value)
 
 void do_stat_ev_ull(const char *name, unsigned long long value)
 {
-	stat_ev_tim_push();
-	stat_ev_printf('E', name, "%llu", value);
-	stat_ev_tim_pop(NULL);
+	bool const paused = pause_timers();
+	if (stat_ev_binary) {
+		write_record(REC_ULL, name, value);
+	} else {
+		stat_ev_printf('E', name, "%llu", value);
+	}
+	resume_timers(paused);
 }
 
 void (stat_ev_ull)(const char *name, unsigned long long value)
@@ -169,9 +568,13 @@ void (stat_ev_ull)(const char *name, unsigned long long value)
 
 void do_stat_ev(const char *name)
 {
-	stat_ev_tim_push();
-	stat_ev_printf('E', name, "0.0");
-	stat_ev_tim_pop(NULL);
+	bool const paused = pause_timers();
+	if (stat_ev_binary) {
+		write_record(REC_NONE, name, 0);
+	} else {
+		stat_ev_printf('E', name, "0.0");
+	}
+	resume_timers(paused);
 }
 
 void (stat_ev)(const char *name)
@@ -179,12 +582,12 @@ void (stat_ev)(const char *name)
 	stat_ev_(name);
 }
 
-void stat_ev_begin(const char *prefix, const char *filt)
+static void begin(const char *prefix, const char *filt, bool binary)
 {
 	char buf[512];
 
-	snprintf(buf, sizeof(buf), "%s.ev", prefix);
-	stat_ev_file = fopen(buf, "wt");
+	snprintf(buf, sizeof(buf), binary ? "%s.evb" : "%s.ev", prefix);
+	stat_ev_file = fopen(buf, binary ? "wb" : "wt");
 	if (stat_ev_file == NULL) {
 		fprintf(stderr, "Warning: Couldn't create statev output '%s'\n", buf);
 	}
@@ -200,12 +603,64 @@ void stat_ev_begin(const char *prefix, const char *filt)
 		}
 	}
 
+	stat_ev_binary = binary;
+	if (binary && stat_ev_file != NULL) {
+		static char const magic[8] = "firmev\0\1";
+		fwrite(magic, sizeof(magic), 1, stat_ev_file);
+#ifdef FIRM_THREADS
+		writer_stop = false;
+		if (pthread_key_create(&thread_key, thread_exit) != 0) {
+			fprintf(stderr, "Warning: Couldn't create statev thread key\n");
+			fclose(stat_ev_file);
+			stat_ev_file = NULL;
+		} else if (pthread_create(&writer, NULL, writer_main, NULL) != 0) {
+			fprintf(stderr, "Warning: Couldn't start statev writer thread\n");
+			pthread_key_delete(thread_key);
+			fclose(stat_ev_file);
+			stat_ev_file = NULL;
+		}
+#endif
+	}
+
 	stat_ev_enabled = stat_ev_file != NULL;
 }
 
+void stat_ev_begin(const char *prefix, const char *filt)
+{
+	begin(prefix, filt, false);
+}
+
+void stat_ev_begin_binary(const char *prefix, const char *filt)
+{
+	begin(prefix, filt, true);
+}
+
 void stat_ev_end(void)
 {
 	if (stat_ev_file != NULL) {
+		if (stat_ev_binary) {
+			lock_writer();
+			for (ev_thread_t *thread = threads, *next; thread != NULL;
+			     thread = next) {
+				next = thread->next;
+				queue_buffer(thread->buffer);
+				free(thread);
+			}
+			threads   = NULL;
+			n_threads = 0;
+#ifdef FIRM_THREADS
+			writer_stop = true;
+			pthread_cond_signal(&writer_cond);
+			pthread_mutex_unlock(&writer_lock);
+			pthread_join(writer, NULL);
+			/* forget the freed state of all threads */
+			pthread_key_delete(thread_key);
+#else
+			unlock_writer();
+			the_thread = NULL;
+#endif
+			free_buffer_list();
+		}
 		fclose(stat_ev_file);
 		stat_ev_file    = NULL;
 		stat_ev_enabled = 0;
@@ -214,4 +669,5 @@ void stat_ev_end(void)
 		regfree(filter);
 		filter = NULL;
 	}
+	free_keys();
 }
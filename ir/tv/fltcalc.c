@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "xmalloc.h"
 
@@ -132,7 +133,7 @@ static bool normalize(fp_value *val, bool sticky)
 
 	/* check for exponent underflow */
 	if (sc_is_negative(_exp(val))
-	 || sc_is_zero(_exp(val), value_size)) {
+	 || sc_is_zero(_exp(val), value_size*SC_BITS)) {
 		/* exponent underflow */
 		/* shift the mantissa right to have a zero exponent */
 		sc_val_from_ulong(1, temp);
@@ -191,7 +192,7 @@ static bool normalize(fp_value *val, bool sticky)
 	}
 
 	/* could have rounded down to zero */
-	if (sc_is_zero(_mant(val), value_size)
+	if (sc_is_zero(_mant(val), value_size*SC_BITS)
 	    && (val->clss == FC_SUBNORMAL))
 		val->clss = FC_ZERO;
 
@@ -385,7 +386,7 @@ static void _fadd(const fp_value *a, const fp_value *b, fp_value *result)
 	}
 
 	/* resulting exponent is the bigger one */
-	memmove(_exp(result), _exp(a), value_size);
+	memmove(_exp(result), _exp(a), value_size * sizeof(sc_word));
 
 	fc_exact &= normalize(result, sticky);
 }
@@ -594,7 +595,7 @@ void fc_int(const fp_value *a, fp_value *result)
 	sc_and(_mant(a), temp, _mant(result));
 
 	if (a != result) {
-		memcpy(_exp(result), _exp(a), value_size);
+		memcpy(_exp(result), _exp(a), value_size * sizeof(sc_word));
 		result->sign = a->sign;
 	}
 }
@@ -604,6 +605,15 @@ unsigned fc_get_value_size(void)
 	return fp_value_size;
 }
 
+void fc_copy(fp_value *result, const fp_value *value)
+{
+	memset(result, 0, offsetof(fp_value, value));
+	result->desc = value->desc;
+	result->clss = value->clss;
+	result->sign = value->sign;
+	memcpy(result->value, value->value, 2 * value_size * sizeof(sc_word));
+}
+
 void fc_val_from_str(const char *str, size_t len, fp_value *result)
 {
 	char *buffer = alloca(len + 1);
@@ -632,8 +642,8 @@ void fc_val_from_bytes(fp_value *result, const unsigned char *buffer,
 	sc_shlI(_mant(result), ROUNDING_BITS, _mant(result));
 
 	/* check for special values */
-	if (sc_is_zero(_exp(result), value_size)) {
-		if (sc_is_zero(_mant(result), value_size)) {
+	if (sc_is_zero(_exp(result), value_size*SC_BITS)) {
+		if (sc_is_zero(_mant(result), value_size*SC_BITS)) {
 			result->clss = FC_ZERO;
 		} else {
 			result->clss = FC_SUBNORMAL;
@@ -770,7 +780,7 @@ void fc_cast(const fp_value *value, const float_descriptor_t *dest,
 		if (value->clss == FC_SUBNORMAL) {
 			sc_shlI(_mant(value), 1, _mant(result));
 		} else if (value != result) {
-			memcpy(_mant(result), _mant(value), value_size);
+			memcpy(_mant(result), _mant(value), value_size * sizeof(sc_word));
 		}
 
 		/* set the descriptor of the new value */
@@ -842,7 +852,7 @@ void fc_get_nan(const float_descriptor_t *desc, fp_value *result,
 	bool     explicit_one  = desc->explicit_one;
 	if (payload != NULL) {
 		if (payload != _mant(result))
-			memcpy(_mant(result), payload, value_size);
+			memcpy(_mant(result), payload, value_size * sizeof(sc_word));
 		/* Limit payload to mantissa size. The "explicit_one" on 80bit x86 must
 		 * be 0 for NaNs. */
 		sc_zero_extend(_mant(result), mantissa_size - explicit_one);
@@ -1067,7 +1077,7 @@ void init_fltcalc(unsigned precision)
 
 	rounding_mode = FC_TONEAREST;
 	value_size    = sc_get_value_length();
-	fp_value_size = sizeof(fp_value) + 2*value_size;
+	fp_value_size = sizeof(fp_value) + 2*value_size*sizeof(sc_word);
 
 #if LDBL_MANT_DIG == 64
 	assert(sizeof(long double) == 12 || sizeof(long double) == 16);
@@ -1181,19 +1191,22 @@ bool fc_is_exact(void)
 void fc_debug(fp_value *value);
 void __attribute__((used)) fc_debug(fp_value *value)
 {
+	unsigned const bits    = sc_get_precision();
+	size_t   const buf_len = bits + 1;
+	char    *const buf     = ALLOCAN(char, buf_len);
 	printf("Class: %d\n", value->clss);
 	printf("Sign: %d\n", value->sign);
 	printf("Exponent: %s\n",
-	       sc_print(_exp(value), sc_get_precision(), SC_HEX, false));
+	       sc_print_buf(buf, buf_len, _exp(value), bits, SC_HEX, false));
 	printf("Unbiased Exponent: %d\n", fc_get_exponent(value));
 	printf("Mantissa: %s\n",
-	       sc_print(_mant(value), sc_get_precision(), SC_HEX, false));
+	       sc_print_buf(buf, buf_len, _mant(value), bits, SC_HEX, false));
 	printf("Mantissa w/o round: ");
 	sc_word *temp = ALLOCAN(sc_word, value_size);
 	sc_shrI(_mant(value), ROUNDING_BITS, temp);
-	printf("%s\n", sc_print(temp, sc_get_precision(), SC_HEX, false));
+	printf("%s\n", sc_print_buf(buf, buf_len, temp, bits, SC_HEX, false));
 	printf("Mantissa w/o round implicit one: ");
 	sc_clear_bit_at(temp, value->desc.mantissa_size);
-	printf("%s\n", sc_print(temp, sc_get_precision(), SC_HEX, false));
+	printf("%s\n", sc_print_buf(buf, buf_len, temp, bits, SC_HEX, false));
 }
 #endif
@@ -46,6 +46,12 @@ typedef struct fp_value fp_value;
 /** Returns the size in bytes of an fp_value */
 unsigned fc_get_value_size(void);
 
+/**
+ * Copies @p value to @p result and clears the padding between the header and
+ * the digits, so the copy can be hashed and compared bytewise.
+ */
+void fc_copy(fp_value *result, const fp_value *value);
+
 void fc_val_from_str(const char *str, size_t len, fp_value *result);
 
 /** get the representation of a floating point value
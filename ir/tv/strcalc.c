@@ -21,11 +21,10 @@
 #include "tv_t.h"
 #include "util.h"
 
-#define SC_MASK      ((sc_word)0xFF)
-#define SC_RESULT(x) ((x) & SC_MASK)
-#define SC_CARRY(x)  ((unsigned)(x) >> SC_BITS)
+#define SC_MASK      (~(sc_word)0)
+#define SC_RESULT(x) ((sc_word)(x))
+#define SC_CARRY(x)  ((sc_word)((sc_dword)(x) >> SC_BITS))
 
-static char *output_buffer = NULL;  /**< buffer for output */
 static unsigned bit_pattern_size;   /**< maximum number of bits */
 static unsigned calc_buffer_size;   /**< size of internally stored values */
 static unsigned max_value_size;     /**< maximum size of values */
@@ -37,12 +36,56 @@ void sc_zero(sc_word *buffer)
 
 static sc_word sex_digit(unsigned x)
 {
-	return (SC_MASK << (x+1)) & SC_MASK;
+	return x+1 < SC_BITS ? SC_MASK << (x+1) : 0;
 }
 
 static sc_word max_digit(unsigned x)
 {
-	return (1u << x) - 1;
+	return x < SC_BITS ? ((sc_word)1 << x) - 1 : SC_MASK;
+}
+
+/** Number of leading zeros in a (non-zero) word. */
+static unsigned word_nlz(sc_word x)
+{
+#if SC_BITS == 64
+	uint32_t const high = (uint32_t)(x >> 32);
+	return high != 0 ? nlz(high) : 32 + nlz((uint32_t)x);
+#else
+	return nlz(x);
+#endif
+}
+
+/** Number of trailing zeros in a (non-zero) word. */
+static unsigned word_ntz(sc_word x)
+{
+#if SC_BITS == 64
+	uint32_t const low = (uint32_t)x;
+	return low != 0 ? ntz(low) : 32 + ntz((uint32_t)(x >> 32));
+#else
+	return ntz(x);
+#endif
+}
+
+static unsigned word_popcount(sc_word x)
+{
+#if SC_BITS == 64
+	return popcount((uint32_t)x) + popcount((uint32_t)(x >> 32));
+#else
+	return popcount(x);
+#endif
+}
+
+/** Shift left by a full word; works for types as wide as sc_word, too. */
+#define SHL_WORD(x) ((x) << (SC_BITS/2) << (SC_BITS/2))
+/** Shift right by a full word; works for types as wide as sc_word, too. */
+#define SHR_WORD(x) ((x) >> (SC_BITS/2) >> (SC_BITS/2))
+
+/** Returns the number of words up to and including the highest non-zero one. */
+static unsigned n_used_words(const sc_word *value, unsigned n_words)
+{
+	while (n_words > 0 && value[n_words-1] == 0)
+		--n_words;
+	return n_words;
 }
 
 static sc_word min_digit(unsigned x)
@@ -108,7 +151,7 @@ void sc_add(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 {
 	sc_word carry = 0;
 	for (unsigned counter = 0; counter < calc_buffer_size; ++counter) {
-		unsigned const sum = val1[counter] + val2[counter] + carry;
+		sc_dword const sum = (sc_dword)val1[counter] + val2[counter] + carry;
 		buffer[counter] = SC_RESULT(sum);
 		carry           = SC_CARRY(sum);
 	}
@@ -143,12 +186,15 @@ void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 		sign = !sign;
 	}
 
-	for (unsigned c_outer = 0; c_outer < max_value_size; c_outer++) {
+	/* leading zero words do not contribute to the product */
+	unsigned const n_inner = n_used_words(val1, max_value_size);
+	unsigned const n_outer = n_used_words(val2, max_value_size);
+	for (unsigned c_outer = 0; c_outer < n_outer; c_outer++) {
 		sc_word outer = val2[c_outer];
 		if (outer == 0)
 			continue;
-		unsigned carry = 0; /* container for carries */
-		for (unsigned c_inner = 0; c_inner < max_value_size; c_inner++) {
+		sc_word carry = 0; /* container for carries */
+		for (unsigned c_inner = 0; c_inner < n_inner; c_inner++) {
 			sc_word inner = val1[c_inner];
 			/* do the following calculation:
 			 * Add the current carry, the value at position c_outer+c_inner
@@ -157,9 +203,9 @@ void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 			 */
 
 			/* multiplicate the two digits */
-			unsigned const mul = inner*outer;
+			sc_dword const mul = (sc_dword)inner*outer;
 			/* add old value to result of multiplication and the carry */
-			unsigned const sum = temp_buffer[c_inner+c_outer] + mul + carry;
+			sc_dword const sum = temp_buffer[c_inner+c_outer] + mul + carry;
 
 			/* all carries together result in new carry. This is always
 			 * smaller than the base b:
@@ -178,24 +224,114 @@ void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 
 		/* A carry may hang over */
 		/* c_outer is always smaller than max_value_size! */
-		temp_buffer[max_value_size + c_outer] = carry;
+		temp_buffer[n_inner + c_outer] = carry;
 	}
 
 	if (sign)
 		sc_neg(temp_buffer, buffer);
 	else
-		memcpy(buffer, temp_buffer, calc_buffer_size);
+		memcpy(buffer, temp_buffer, calc_buffer_size * sizeof(buffer[0]));
 }
 
 /**
- * Shift the buffer to left and add an sc digit
+ * Unsigned division of the @p n_u words at @p u by the @p n_v words at @p v
+ * with n_u >= n_v > 0 and v[n_v-1] != 0. This is Algorithm D from Knuth, The
+ * Art of Computer Programming, Vol. 2, 4.3.1. @p quot and @p rem must be
+ * cleared by the caller.
  */
-static void sc_push(sc_word digit, sc_word *buffer)
+static void divmod_words(const sc_word *u, unsigned n_u, const sc_word *v,
+                         unsigned n_v, sc_word *quot, sc_word *rem)
 {
-	for (unsigned counter = calc_buffer_size - 1; counter-- > 0; ) {
-		buffer[counter+1] = buffer[counter];
+	assert(n_u >= n_v && n_v > 0 && v[n_v-1] != 0);
+	if (n_v == 1) {
+		/* short division */
+		sc_word const divisor = v[0];
+		if (n_u == 1) {
+			quot[0] = u[0] / divisor;
+			rem[0]  = u[0] % divisor;
+			return;
+		}
+		sc_word r = 0;
+		for (unsigned j = n_u; j-- > 0; ) {
+			sc_dword const num = ((sc_dword)r << SC_BITS) | u[j];
+			quot[j] = (sc_word)(num / divisor);
+			r       = (sc_word)(num % divisor);
+		}
+		rem[0] = r;
+		return;
+	}
+
+	/* normalize so the highest divisor word has its top bit set */
+	unsigned const shift = word_nlz(v[n_v-1]);
+	sc_word *const vn    = ALLOCAN(sc_word, n_v);
+	sc_word *const un    = ALLOCAN(sc_word, n_u + 1);
+	if (shift == 0) {
+		memcpy(vn, v, n_v * sizeof(vn[0]));
+		memcpy(un, u, n_u * sizeof(un[0]));
+		un[n_u] = 0;
+	} else {
+		for (unsigned i = n_v; i-- > 1; )
+			vn[i] = (v[i] << shift) | (v[i-1] >> (SC_BITS - shift));
+		vn[0] = v[0] << shift;
+		un[n_u] = u[n_u-1] >> (SC_BITS - shift);
+		for (unsigned i = n_u; i-- > 1; )
+			un[i] = (u[i] << shift) | (u[i-1] >> (SC_BITS - shift));
+		un[0] = u[0] << shift;
+	}
+
+	sc_word const v_high = vn[n_v-1];
+	sc_word const v_next = vn[n_v-2];
+	for (unsigned j = n_u - n_v + 1; j-- > 0; ) {
+		/* estimate the quotient word, it is at most 2 too large */
+		sc_dword const num  = ((sc_dword)un[j+n_v] << SC_BITS) | un[j+n_v-1];
+		sc_dword       qhat = num / v_high;
+		sc_dword       rhat = num % v_high;
+		while ((qhat >> SC_BITS) != 0
+		       || qhat * v_next > ((rhat << SC_BITS) | un[j+n_v-2])) {
+			--qhat;
+			rhat += v_high;
+			if ((rhat >> SC_BITS) != 0)
+				break;
+		}
+
+		/* multiply and subtract */
+		sc_word mul_carry = 0;
+		sc_word borrow    = 0;
+		for (unsigned i = 0; i < n_v; ++i) {
+			sc_dword const p    = qhat * vn[i] + mul_carry;
+			sc_word  const low  = (sc_word)p;
+			sc_word  const d    = un[i+j] - low;
+			sc_word  const diff = d - borrow;
+			borrow    = (un[i+j] < low) | (d < borrow);
+			mul_carry = (sc_word)(p >> SC_BITS);
+			un[i+j]   = diff;
+		}
+		sc_word const d    = un[j+n_v] - mul_carry;
+		sc_word const diff = d - borrow;
+		borrow       = (un[j+n_v] < mul_carry) | (d < borrow);
+		un[j+n_v]    = diff;
+		quot[j]      = (sc_word)qhat;
+
+		if (borrow) {
+			/* subtracted one time too much, add back */
+			--quot[j];
+			sc_word carry = 0;
+			for (unsigned i = 0; i < n_v; ++i) {
+				sc_dword const sum = (sc_dword)un[i+j] + vn[i] + carry;
+				un[i+j] = SC_RESULT(sum);
+				carry   = SC_CARRY(sum);
+			}
+			un[j+n_v] += carry;
+		}
+	}
+
+	/* denormalize the remainder */
+	if (shift == 0) {
+		memcpy(rem, un, n_v * sizeof(rem[0]));
+	} else {
+		for (unsigned i = 0; i < n_v; ++i)
+			rem[i] = (un[i] >> shift) | (un[i+1] << (SC_BITS - shift));
 	}
-	buffer[0] = digit;
 }
 
 bool sc_divmod(const sc_word *dividend, const sc_word *divisor,
@@ -225,52 +361,22 @@ bool sc_divmod(const sc_word *dividend, const sc_word *divisor,
 	}
 
 	sc_word *neg_val2 = ALLOCAN(sc_word, calc_buffer_size);
-	sc_neg(divisor, neg_val2);
-	const sc_word *minus_divisor;
 	if (sc_is_negative(divisor)) {
+		sc_neg(divisor, neg_val2);
 		div_sign = !div_sign;
-		minus_divisor = divisor;
 		divisor = neg_val2;
-	} else {
-		minus_divisor = neg_val2;
 	}
 
 	/* if divisor >= dividend division is easy
 	 * (remember these are absolute values) */
-	switch (sc_comp(dividend, divisor)) {
-	case ir_relation_equal: /* dividend == divisor */
-		quot[0] = 1;
-		goto end;
-
-	case ir_relation_less: /* dividend < divisor */
-		memcpy(rem, dividend, calc_buffer_size);
-		goto end;
-
-	default: /* unluckily division is necessary :( */
-		break;
+	unsigned const n_dividend = n_used_words(dividend, calc_buffer_size);
+	unsigned const n_divisor  = n_used_words(divisor, calc_buffer_size);
+	if (n_dividend < n_divisor) {
+		memcpy(rem, dividend, calc_buffer_size * sizeof(rem[0]));
+	} else {
+		divmod_words(dividend, n_dividend, divisor, n_divisor, quot, rem);
 	}
 
-	for (unsigned c_dividend = calc_buffer_size; c_dividend-- > 0; ) {
-		sc_push(dividend[c_dividend], rem);
-		sc_push(0, quot);
-
-		if (sc_comp(rem, divisor) != ir_relation_less) {
-			/* remainder >= divisor */
-			/* subtract until the remainder becomes negative, this should
-			 * be faster than comparing remainder with divisor  */
-			sc_add(rem, minus_divisor, rem);
-
-			while (!sc_is_negative(rem)) {
-				/* TODO can this generate carry or is masking redundant? */
-				quot[0] = SC_RESULT(quot[0] + 1);
-				sc_add(rem, minus_divisor, rem);
-			}
-
-			/* subtracted one too much */
-			sc_add(rem, divisor, rem);
-		}
-	}
-end:
 	if (div_sign)
 		sc_neg(quot, quot);
 
@@ -292,10 +398,11 @@ void sc_zero_extend(sc_word *buffer, unsigned from_bits)
 	unsigned bit  = from_bits % SC_BITS;
 	unsigned word = from_bits / SC_BITS;
 	if (bit > 0) {
-		memset(&buffer[word+1], 0, calc_buffer_size-(word+1));
+		memset(&buffer[word+1], 0,
+		       (calc_buffer_size-(word+1)) * sizeof(buffer[0]));
 		buffer[word] &= max_digit(bit);
 	} else {
-		memset(&buffer[word], 0, calc_buffer_size-word);
+		memset(&buffer[word], 0, (calc_buffer_size-word) * sizeof(buffer[0]));
 	}
 }
 
@@ -392,7 +499,7 @@ void sc_val_from_long(long value, sc_word *buffer)
 	sc_word *pos = buffer;
 	while ((value != 0) && (pos < buffer + calc_buffer_size)) {
 		*pos++ = value & SC_MASK;
-		value >>= SC_BITS;
+		value = SHR_WORD(value);
 	}
 
 	if (sign) {
@@ -409,17 +516,16 @@ void sc_val_from_ulong(unsigned long value, sc_word *buffer)
 
 	while (pos < buffer + calc_buffer_size) {
 		*pos++ = value & SC_MASK;
-		value >>= SC_BITS;
+		value = SHR_WORD(value);
 	}
 }
 
 long sc_val_to_long(const sc_word *val)
 {
 	unsigned long l = 0;
-	unsigned max_buffer_index = (sizeof(long)*8)/SC_BITS;
+	unsigned max_buffer_index = (sizeof(long)*8 + SC_BITS-1)/SC_BITS;
 	for (unsigned i = max_buffer_index; i-- > 0; ) {
-		assert(l <= (ULONG_MAX>>SC_BITS) && "signed shift overflow");
-		l = (l << SC_BITS) + val[i];
+		l = SHL_WORD(l) + (unsigned long)val[i];
 	}
 	return l;
 }
@@ -427,8 +533,8 @@ long sc_val_to_long(const sc_word *val)
 uint64_t sc_val_to_uint64(const sc_word *val)
 {
 	uint64_t res = 0;
-	for (unsigned i = calc_buffer_size; i-- > 0; ) {
-		res = (res << SC_BITS) + val[i];
+	for (unsigned i = (64 + SC_BITS-1)/SC_BITS; i-- > 0; ) {
+		res = SHL_WORD(res) + (uint64_t)val[i];
 	}
 	return res;
 }
@@ -498,7 +604,7 @@ int sc_get_highest_set_bit(const sc_word *value)
 	for (unsigned counter = calc_buffer_size; counter-- > 0; ) {
 		sc_word word = value[counter];
 		if (word != 0)
-			return counter*SC_BITS + (31 - nlz(word));
+			return counter*SC_BITS + (SC_BITS-1 - word_nlz(word));
 	}
 	return -1;
 }
@@ -508,7 +614,7 @@ int sc_get_highest_clear_bit(const sc_word *value)
 	for (unsigned counter = calc_buffer_size; counter-- > 0; ) {
 		sc_word word = value[counter] ^ SC_MASK;
 		if (word != 0)
-			return counter*SC_BITS + (31 - nlz(word));
+			return counter*SC_BITS + (SC_BITS-1 - word_nlz(word));
 	}
 	return -1;
 }
@@ -519,21 +625,21 @@ int sc_get_lowest_set_bit(const sc_word *value)
 	     ++counter) {
 		sc_word word = value[counter];
 		if (word != 0)
-			return (counter * SC_BITS) + ntz(word);
+			return (counter * SC_BITS) + word_ntz(word);
 	}
 	return -1;
 }
 
 void sc_set_bit_at(sc_word *value, unsigned pos)
 {
-	unsigned nibble = pos / SC_BITS;
-	value[nibble] |= 1 << (pos % SC_BITS);
+	unsigned word = pos / SC_BITS;
+	value[word] |= (sc_word)1 << (pos % SC_BITS);
 }
 
 void sc_clear_bit_at(sc_word *value, unsigned pos)
 {
-	unsigned nibble = pos / SC_BITS;
-	value[nibble] &= ~(1 << (pos % SC_BITS));
+	unsigned word = pos / SC_BITS;
+	value[word] &= ~((sc_word)1 << (pos % SC_BITS));
 }
 
 bool sc_is_zero(const sc_word *value, unsigned bits)
@@ -563,19 +669,23 @@ bool sc_is_negative(const sc_word *value)
 	return sc_get_bit_at(value, calc_buffer_size*SC_BITS-1);
 }
 
+/** Returns the byte at offset @p byte_ofs of a value. */
+static unsigned char get_byte(const sc_word *value, unsigned byte_ofs)
+{
+	unsigned const bit_ofs = byte_ofs * CHAR_BIT;
+	return (unsigned char)(value[bit_ofs / SC_BITS] >> (bit_ofs % SC_BITS));
+}
+
 unsigned char sc_sub_bits(const sc_word *value, unsigned len, unsigned byte_ofs)
 {
-	if (byte_ofs*SC_BITS >= len)
+	if (byte_ofs*CHAR_BIT >= len)
 		return 0;
 
-	assert(SC_BITS == CHAR_BIT);
-	sc_word val = value[byte_ofs];
+	unsigned char val = get_byte(value, byte_ofs);
 	// Mask out if we are at the end
-	if (byte_ofs == (len/SC_BITS)-1) {
-		unsigned bit = len % SC_BITS;
-		if (bit != 0)
-			val &= max_digit(bit);
-	}
+	unsigned bits_left = len - byte_ofs*CHAR_BIT;
+	if (bits_left < CHAR_BIT)
+		val &= (1u << bits_left) - 1;
 	return val;
 }
 
@@ -584,12 +694,12 @@ unsigned sc_popcount(const sc_word *value, unsigned bits)
 	unsigned res = 0;
 	unsigned full_words = bits/SC_BITS;
 	for (unsigned i = 0; i < full_words; ++i) {
-		res += popcount(value[i]);
+		res += word_popcount(value[i]);
 	}
 	unsigned remaining_bits = bits%SC_BITS;
 	if (remaining_bits != 0) {
 		sc_word mask = max_digit(remaining_bits);
-		res += popcount(value[full_words] & mask);
+		res += word_popcount(value[full_words] & mask);
 	}
 
 	return res;
@@ -600,10 +710,11 @@ void sc_val_from_bytes(unsigned char const *const bytes, size_t n_bytes,
 {
 	assert(n_bytes*CHAR_BIT <= (size_t)calc_buffer_size*SC_BITS);
 
-	sc_word *p = buffer;
-	assert(SC_BITS == CHAR_BIT);
-	memcpy(p, bytes, n_bytes);
-	memset(p+n_bytes, 0, buffer+calc_buffer_size-p);
+	sc_zero(buffer);
+	for (size_t i = 0; i < n_bytes; ++i) {
+		size_t const bit_ofs = i * CHAR_BIT;
+		buffer[bit_ofs / SC_BITS] |= (sc_word)bytes[i] << (bit_ofs % SC_BITS);
+	}
 }
 
 void sc_val_to_bytes(const sc_word *buffer, unsigned char *const dest,
@@ -611,62 +722,31 @@ void sc_val_to_bytes(const sc_word *buffer, unsigned char *const dest,
 {
 	assert(dest_len*CHAR_BIT <= (size_t)calc_buffer_size*SC_BITS);
 
-	assert(SC_BITS == CHAR_BIT);
-	memcpy(dest, buffer, dest_len);
+	for (size_t i = 0; i < dest_len; ++i)
+		dest[i] = get_byte(buffer, i);
 }
 
 void sc_val_from_bits(unsigned char const *const bytes, unsigned from,
                       unsigned to, sc_word *buffer)
 {
 	assert(from < to);
-	assert((to - from) / CHAR_BIT <= calc_buffer_size);
-	assert(CHAR_BIT == 8);
-	assert(SC_BITS == CHAR_BIT);
-
-	sc_word *p = buffer;
-
-	/* see which is the lowest and highest byte, special case if they are
-	 * the same. */
-	const unsigned char *const low      = &bytes[from/CHAR_BIT];
-	const unsigned char *const high     = &bytes[(to-1)/CHAR_BIT];
-	const unsigned             low_bit  = from%CHAR_BIT;
-	const unsigned             high_bit = (to-1)%CHAR_BIT + 1;
-	if (low == high) {
-		uint32_t val
-			= ((uint32_t)*low << (32-high_bit)) >> (32-high_bit+low_bit);
-		*p++ = val & SC_MASK;
-		goto clear_rest;
-	}
-
-	/* lowest byte gets applied partially */
-	uint32_t val = ((uint32_t)*low) >> low_bit;
-	*p     = val & SC_MASK;
-	*(p+1) = 0;
-	unsigned bit = (CHAR_BIT-low_bit)%SC_BITS;
-	p += (CHAR_BIT-low_bit)/SC_BITS;
-	/* fully apply bytes in the middle (but note that they may affect up to 2
-	 * units of the destination number) */
-	for (const unsigned char *mid = low+1; mid < high; ++mid) {
-		uint32_t mval = ((uint32_t)*mid) << bit;
-		*p++   |= (mval >> 0)       & SC_MASK;
-		*p      = (mval >> SC_BITS) & SC_MASK;
-	}
-	/* partially apply the highest byte */
-	uint32_t hval = ((uint32_t)(*high) << (32-high_bit)) >> (32-high_bit-bit);
-	*p++ |= (hval >> 0)       & SC_MASK;
-	if ((hval >> SC_BITS) != 0)
-		*p++ = (hval >> SC_BITS) & SC_MASK;
-
-clear_rest:
-	assert(p <= buffer + calc_buffer_size);
-	memset(p, 0, buffer+calc_buffer_size - p);
-}
-
-const char *sc_print(const sc_word *value, unsigned bits, enum base_t base,
-                     bool is_signed)
-{
-	return sc_print_buf(output_buffer, bit_pattern_size+1, value, bits,
-	                    base, is_signed);
+	assert(to - from <= calc_buffer_size * SC_BITS);
+
+	sc_zero(buffer);
+	/* copy the range in chunks which do not cross a byte boundary in the
+	 * source, a chunk may still cross a word boundary in the destination */
+	for (unsigned done = 0, n_bits = to - from; done < n_bits; ) {
+		unsigned const src   = from + done;
+		unsigned const bit   = src % CHAR_BIT;
+		unsigned const take  = MIN(CHAR_BIT - bit, n_bits - done);
+		sc_word  const chunk = (bytes[src / CHAR_BIT] >> bit) & ((1u << take) - 1);
+		unsigned const word  = done / SC_BITS;
+		unsigned const shift = done % SC_BITS;
+		buffer[word] |= chunk << shift;
+		if (shift + take > SC_BITS)
+			buffer[word+1] |= chunk >> (SC_BITS - shift);
+		done += take;
+	}
 }
 
 char *sc_print_buf(char *buf, size_t buf_len, const sc_word *value,
@@ -683,20 +763,23 @@ char *sc_print_buf(char *buf, size_t buf_len, const sc_word *value,
 	unsigned remaining_bits = bits % SC_BITS;
 	switch (base) {
 	case SC_HEX: {
-		assert(SC_BITS == 8);
 		unsigned counter = 0;
 		for ( ; counter < n_full_words; ++counter) {
 			sc_word x = value[counter];
-			*(--pos) = digits[(x >> 0) & 0xf];
-			*(--pos) = digits[(x >> 4) & 0xf];
+			for (unsigned nibble = 0; nibble < SC_BITS/4; ++nibble) {
+				*(--pos) = digits[x & 0xf];
+				x >>= 4;
+			}
 		}
 
 		/* last nibble must be masked */
 		if (remaining_bits != 0) {
 			sc_word mask = max_digit(remaining_bits);
 			sc_word x    = value[counter++] & mask;
-			*(--pos) = digits[(x >> 0) & 0xf];
-			*(--pos) = digits[(x >> 4) & 0xf];
+			for (unsigned nibble = 0; nibble < (remaining_bits+3)/4; ++nibble) {
+				*(--pos) = digits[x & 0xf];
+				x >>= 4;
+			}
 			assert(pos >= buf);
 		}
 
@@ -767,23 +850,20 @@ char *sc_print_buf(char *buf, size_t buf_len, const sc_word *value,
 
 void init_strcalc(unsigned precision)
 {
-	if (output_buffer == NULL) {
-		/* round up to multiple of SC_BITS */
-		assert(is_po2(SC_BITS));
-		precision = (precision + (SC_BITS-1)) & ~(SC_BITS-1);
+	if (bit_pattern_size == 0) {
+		/* round up to multiple of 8 bits, the storage is rounded up to
+		 * full words */
+		precision = (precision + 7) & ~7u;
 
 		bit_pattern_size = precision;
-		calc_buffer_size = precision / (SC_BITS/2);
-		max_value_size   = precision / SC_BITS;
-
-		output_buffer = XMALLOCN(char, bit_pattern_size + 1);
+		max_value_size   = (precision + (SC_BITS-1)) / SC_BITS;
+		calc_buffer_size = 2 * max_value_size;
 	}
 }
 
 void finish_strcalc(void)
 {
-	free(output_buffer);
-	output_buffer = NULL;
+	bit_pattern_size = 0;
 }
 
 unsigned sc_get_precision(void)
@@ -829,7 +909,7 @@ void sc_shlI(const sc_word *value, unsigned shift_count, sc_word *buffer)
 	}
 
 	/* fill up with zeros */
-	memset(buffer, 0, shift_words);
+	memset(buffer, 0, shift_words * sizeof(buffer[0]));
 }
 
 void sc_shl(const sc_word *val1, const sc_word *val2, sc_word *buffer)
@@ -878,7 +958,8 @@ bool sc_shrI(const sc_word *value, unsigned shift_count, sc_word *buffer)
 	}
 
 	/* fill upper words with zero */
-	memset(&buffer[calc_buffer_size-shift_words], 0, shift_words);
+	memset(&buffer[calc_buffer_size-shift_words], 0,
+	       shift_words * sizeof(buffer[0]));
 	return carry_flag;
 }
 
@@ -897,39 +978,33 @@ bool sc_shrsI(const sc_word *value, unsigned shift_count, unsigned bitsize,
 	/* if shifting far enough the result is either 0 or -1 */
 	if (shift_count >= bitsize) {
 		bool carry_flag = !sc_is_zero(value, calc_buffer_size*SC_BITS);
-		assert(SC_BITS <= CHAR_BIT);
-		memset(buffer, sign, calc_buffer_size);
+		for (unsigned i = 0; i < calc_buffer_size; ++i)
+			buffer[i] = sign;
 		return carry_flag;
 	}
 
-	unsigned shift_words = shift_count / SC_BITS;
-	unsigned shift_bits  = shift_count % SC_BITS;
+	/* the carry flag is set if any bit is shifted out */
+	bool carry_flag = !sc_is_zero(value, shift_count);
 
-	/* determine carry flag */
-	bool carry_flag = false;
-	for (unsigned i = 0; i < shift_words; ++i) {
-		if (value[i] != 0) {
-			carry_flag = true;
-			break;
-		}
-	}
-
-	/* TODO: bitsize % SC_BITS != 0 not implemented yet */
-	assert(bitsize % SC_BITS == 0);
-	unsigned limit = bitsize / SC_BITS;
+	/* shift the value sign extended from bitsize to the right, so the
+	 * upper bits are filled with the sign */
+	sc_word *temp = ALLOCAN(sc_word, calc_buffer_size);
+	memcpy(temp, value, calc_buffer_size * sizeof(temp[0]));
+	sc_sign_extend(temp, bitsize);
 
-	/* shift to the right */
+	unsigned shift_words = shift_count / SC_BITS;
+	unsigned shift_bits  = shift_count % SC_BITS;
+	unsigned limit       = calc_buffer_size - shift_words;
 	if (shift_bits == 0) {
 		/* fast path */
-		for (unsigned i = 0; i < limit-shift_words; ++i) {
-			buffer[i] = value[i+shift_words];
+		for (unsigned i = 0; i < limit; ++i) {
+			buffer[i] = temp[i+shift_words];
 		}
 	} else {
-		sc_word val = value[shift_words];
-		carry_flag |= val & max_digit(shift_bits);
-		for (unsigned i = 0; i < limit-shift_words; ++i) {
+		sc_word val = temp[shift_words];
+		for (unsigned i = 0; i < limit; ++i) {
 			unsigned next_pos = i+shift_words+1;
-			sc_word next = next_pos<limit ? value[next_pos] : sign;
+			sc_word next = next_pos < calc_buffer_size ? temp[next_pos] : sign;
 			buffer[i] = SC_RESULT(val >> shift_bits)
 			          | SC_RESULT(next << (SC_BITS - shift_bits));
 			val = next;
@@ -937,9 +1012,8 @@ bool sc_shrsI(const sc_word *value, unsigned shift_count, unsigned bitsize,
 	}
 
 	/* fill upper words with extended sign */
-	assert(SC_BITS <= CHAR_BIT);
-	memset(&buffer[limit-shift_words], sign,
-	       calc_buffer_size-(limit-shift_words));
+	for (unsigned i = limit; i < calc_buffer_size; ++i)
+		buffer[i] = sign;
 	return carry_flag;
 }
 
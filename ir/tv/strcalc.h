@@ -16,9 +16,21 @@
 #include <stdlib.h>
 #include "firm_types.h"
 
-#define SC_BITS 8
-
-typedef uint8_t sc_word;
+/**
+ * Values are stored as little endian arrays of sc_word limbs. Where the
+ * compiler provides a 128 bit integer type we use 64 bit limbs, otherwise 32
+ * bit limbs; in both cases sc_dword is wide enough to hold the full result of
+ * multiplying two limbs.
+ */
+#if defined(__SIZEOF_INT128__)
+#define SC_BITS 64
+typedef uint64_t          sc_word;
+typedef unsigned __int128 sc_dword;
+#else
+#define SC_BITS 32
+typedef uint32_t sc_word;
+typedef uint64_t sc_dword;
+#endif
 
 /**
  * The output mode for integer values.
@@ -217,20 +229,10 @@ bool sc_is_all_one(const sc_word *value, unsigned num_bits);
 unsigned char sc_sub_bits(const sc_word *value, unsigned len,
                           unsigned byte_ofs);
 
-/**
- * Converts a tarval into a string.
- *
- * @param val1        the value pointer
- * @param bits        number of valid bits in this value
- * @param base        output base
- * @param signed_mode print it signed (only decimal mode supported
- */
-const char *sc_print(const sc_word *val1, unsigned bits, enum base_t base,
-                     bool signed_mode);
-
 /**
  * Write value into string. The buffer is filled from the end, use the return
  * value to get the real start position of the string!
+ * A buffer of sc_get_precision() + 1 chars is large enough for every value.
  * If the buffer is too small for the value, the behavior is undefined!
  */
 char *sc_print_buf(char *buf, size_t buf_len, const sc_word *val, unsigned bits,
@@ -247,8 +249,8 @@ unsigned sc_get_precision(void);
 /** Return the bit at a given position. */
 static inline bool sc_get_bit_at(const sc_word *value, unsigned pos)
 {
-	unsigned nibble = pos / SC_BITS;
-	return (value[nibble] >> (pos % SC_BITS)) & 1;
+	unsigned word = pos / SC_BITS;
+	return (value[word] >> (pos % SC_BITS)) & 1;
 }
 
 /** Set the bit at the specified position. */
@@ -26,6 +26,7 @@
 #include "hashptr.h"
 #include "tv_t.h"
 #include "set.h"
+#include "spinlock.h"
 #include "entity_t.h"
 #include "hashptr.h"
 #include "irmode_t.h"
@@ -42,8 +43,18 @@
  * constant target values */
 #define N_CONSTANTS 2048
 
-/** A set containing all existing tarvals. */
-static struct set *tarvals = NULL;
+/** log2 of the number of tarval table shards. */
+#define TV_SHARD_BITS 3
+#define N_TV_SHARDS   (1u << TV_SHARD_BITS)
+
+/**
+ * The sets containing all existing tarvals. Like the ident table, the tarval
+ * table is split into independent shards selected by the upper hash bits, so
+ * interning a value touches only one of them. Each shard has its own lock;
+ * interned tarvals are never modified, so reading them needs no lock.
+ */
+static struct set *tarvals[N_TV_SHARDS];
+static spinlock_t  tarval_locks[N_TV_SHARDS];
 
 static unsigned sc_value_length;
 static unsigned fp_value_size;
@@ -54,7 +65,8 @@ static bool wrap_on_overflow = true;
 /** Hash a tarval. */
 static unsigned hash_tv(const ir_tarval *tv)
 {
-	return hash_combine(hash_ptr(tv->mode), hash_data(tv->value, tv->length));
+	unsigned char const *const data = (unsigned char const*)tv->value;
+	return hash_combine(hash_ptr(tv->mode), hash_data(data, tv->length));
 }
 
 static int cmp_tv(const void *p1, const void *p2, size_t n)
@@ -70,25 +82,31 @@ static int cmp_tv(const void *p1, const void *p2, size_t n)
 
 static ir_tarval *identify_tarval(const ir_tarval *tv)
 {
-	unsigned hash = hash_tv(tv);
-	return set_insert(ir_tarval, tarvals, tv, sizeof(ir_tarval) + tv->length,
-	                  hash);
+	unsigned    hash = hash_tv(tv);
+	unsigned    nr   = hash >> (sizeof(hash) * 8 - TV_SHARD_BITS);
+	spinlock_t *lock = &tarval_locks[nr];
+	spinlock_lock(lock);
+	ir_tarval *res = set_insert(ir_tarval, tarvals[nr], tv,
+	                            sizeof(ir_tarval) + tv->length, hash);
+	spinlock_unlock(lock);
+	return res;
 }
 
 static ir_tarval *get_fp_tarval(const fp_value *value, ir_mode *mode)
 {
-	ir_tarval *const tv = ALLOCAF(ir_tarval, value, fp_value_size);
+	unsigned   const n_words = (fp_value_size + sizeof(sc_word) - 1) / sizeof(sc_word);
+	ir_tarval *const tv      = ALLOCAF(ir_tarval, value, n_words);
 	tv->kind   = k_tarval;
 	tv->mode   = mode;
 	tv->length = fp_value_size;
-	memcpy(tv->value, value, fp_value_size);
+	fc_copy((fp_value*)tv->value, value);
 	return identify_tarval(tv);
 }
 
 static ir_tarval *get_int_tarval(const sc_word *value, ir_mode *mode)
 {
 	unsigned size = sc_value_length * sizeof(sc_word);
-	ir_tarval *const tv = ALLOCAF(ir_tarval, value, size);
+	ir_tarval *const tv = ALLOCAF(ir_tarval, value, sc_value_length);
 	tv->kind   = k_tarval;
 	tv->mode   = mode;
 	tv->length = size;
@@ -620,7 +638,7 @@ ir_tarval *tarval_convert_to(ir_tarval *src, ir_mode *dst_mode)
 		case irms_reference:
 		case irms_int_number: {
 			sc_word *buffer = ALLOCAN(sc_word, sc_value_length);
-			memcpy(buffer, src->value, sc_value_length);
+			memcpy(buffer, src->value, sc_value_length * sizeof(sc_word));
 			return get_int_tarval_overflow(buffer, dst_mode);
 		}
 
@@ -628,14 +646,15 @@ ir_tarval *tarval_convert_to(ir_tarval *src, ir_mode *dst_mode)
 			/* XXX floating point unit does not understand internal integer
 			 * representation, convert to string first, then create float from
 			 * string */
-			char *buffer = ALLOCAN(char, 100);
+			size_t const buf_len = sc_get_precision() + 1;
+			char  *const buffer  = ALLOCAN(char, buf_len);
 			/* decimal string representation because hexadecimal output is
 			 * interpreted unsigned by fc_val_from_str, so this is a HACK */
-			int len = snprintf(buffer, 100, "%s",
-				sc_print(src->value, get_mode_size_bits(src->mode), SC_DEC, mode_is_signed(src->mode)));
+			char const *const str = sc_print_buf(buffer, buf_len, src->value,
+				get_mode_size_bits(src->mode), SC_DEC, mode_is_signed(src->mode));
 
 			fp_value *fpval = (fp_value*)ALLOCAN(char, fp_value_size);
-			fc_val_from_str(buffer, len, fpval);
+			fc_val_from_str(str, strlen(str), fpval);
 			fc_cast(fpval, get_descriptor(dst_mode), fpval);
 			return get_fp_tarval(fpval, dst_mode);
 		}
@@ -649,7 +668,7 @@ ir_tarval *tarval_convert_to(ir_tarval *src, ir_mode *dst_mode)
 	case irms_reference:
 		if (mode_is_int(dst_mode)) {
 			sc_word *buffer = ALLOCAN(sc_word, sc_value_length);
-			memcpy(buffer, src->value, sc_value_length);
+			memcpy(buffer, src->value, sc_value_length * sizeof(sc_word));
 			unsigned bits = get_mode_size_bits(src->mode);
 			if (mode_is_signed(src->mode)) {
 				sc_sign_extend(buffer, bits);
@@ -1093,7 +1112,7 @@ ir_tarval *tarval_shr(ir_tarval *a, ir_tarval *b)
 
 	sc_word *temp = ALLOCAN(sc_word, sc_value_length);
 	/* workaround for unnecessary internal higher precision */
-	memcpy(temp, a->value, sc_value_length);
+	memcpy(temp, a->value, sc_value_length * sizeof(sc_word));
 	sc_zero_extend(temp, get_mode_size_bits(a_mode));
 	sc_shr(temp, temp_val, temp);
 	return get_int_tarval(temp, a_mode);
@@ -1110,7 +1129,7 @@ ir_tarval *tarval_shr_unsigned(ir_tarval *a, unsigned b)
 
 	sc_word *temp = ALLOCAN(sc_word, sc_value_length);
 	/* workaround for unnecessary internal higher precision */
-	memcpy(temp, a->value, sc_value_length);
+	memcpy(temp, a->value, sc_value_length * sizeof(sc_word));
 	sc_zero_extend(temp, get_mode_size_bits(a->mode));
 	sc_shrI(temp, (long)b, temp);
 	return get_int_tarval(temp, mode);
@@ -1158,8 +1177,11 @@ int tarval_snprintf(char *buf, size_t len, ir_tarval *tv)
 			return snprintf(buf, len, "NULL");
 		/* FALLTHROUGH */
 	case irms_int_number: {
-		unsigned    bits = get_mode_size_bits(tv->mode);
-		const char *str  = sc_print(tv->value, bits, SC_HEX, 0);
+		unsigned    bits    = get_mode_size_bits(tv->mode);
+		size_t      str_len = sc_get_precision() + 1;
+		char       *str_buf = ALLOCAN(char, str_len);
+		const char *str     = sc_print_buf(str_buf, str_len, tv->value, bits,
+		                                   SC_HEX, false);
 		return snprintf(buf, len, "0x%s", str);
 	}
 
@@ -1374,7 +1396,7 @@ static ir_tarval *make_b_tarval(unsigned char const val)
 {
 	ir_tarval *const tv = XMALLOCFZ(ir_tarval, value, sc_value_length);
 	tv->kind     = k_tarval;
-	tv->length   = sc_value_length;
+	tv->length   = sc_value_length * sizeof(sc_word);
 	tv->value[0] = val;
 	/* mode will be set later */
 	return tv;
@@ -1384,7 +1406,8 @@ void init_tarval_1(void)
 {
 	/* initialize the sets holding the tarvals with a comparison function and
 	 * an initial size, which is the expected number of constants */
-	tarvals = new_set(cmp_tv, N_CONSTANTS);
+	for (size_t i = 0; i < N_TV_SHARDS; ++i)
+		tarvals[i] = new_set(cmp_tv, N_CONSTANTS / N_TV_SHARDS);
 	/* calls init_strcalc() with needed size */
 	init_fltcalc(128);
 
@@ -1412,7 +1435,10 @@ void init_tarval_2(void)
 void finish_tarval(void)
 {
 	finish_strcalc();
-	del_set(tarvals); tarvals = NULL;
+	for (size_t i = 0; i < N_TV_SHARDS; ++i) {
+		del_set(tarvals[i]);
+		tarvals[i] = NULL;
+	}
 }
 
 bool tarval_in_range(ir_tarval const *const min, ir_tarval const *const val, ir_tarval const *const max)
@@ -58,9 +58,9 @@ void finish_tarval(void);
  */
 struct ir_tarval {
 	firm_kind     kind;    /**< must be k_tarval */
-	uint16_t      length;  /**< the length of the stored value */
+	uint16_t      length;  /**< the length of the stored value in bytes */
 	ir_mode      *mode;    /**< the mode of the stored value */
-	unsigned char value[]; /**< the value stored in an internal way */
+	sc_word       value[]; /**< the value stored in an internal way */
 };
 
 /* inline functions */
@@ -0,0 +1,19 @@
+/**
+ * Sums libFirm profiles of several runs into one profile.
+ * This file is a supplement to libFirm. It is public domain.
+ *
+ * usage: firmprof-merge OUTPUT INPUT...
+ */
+#include <stdio.h>
+
+#include "firmprof.h"
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s OUTPUT INPUT...\n", argv[0]);
+		return 2;
+	}
+	return firmprof_merge(argv[1], (const char *const*)argv + 2,
+	                      (unsigned)(argc - 2)) == 0 ? 0 : 1;
+}
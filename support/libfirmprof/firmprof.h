@@ -0,0 +1,83 @@
+/**
+ * Reading, writing and merging of libFirm profiles.
+ * This file is a supplement to libFirm. It is public domain.
+ *
+ * A profile file consists of the following parts, all numbers are little
+ * endian:
+ *
+ *   header     "firmprof", u32 version (FIRMPROF_VERSION),
+ *              u32 number of functions, u32 number of buckets (a power of
+ *              two), u32 size of the names, u64 number of counters
+ *   records    per function: u64 hash of the name, u64 checksum of the
+ *              control flow graph, u64 index of the first counter,
+ *              u32 offset of the name, u32 number of counters,
+ *              u32 offset of the call sites, u32 size of the call sites
+ *   buckets    u32 record number + 1 or 0 for an empty bucket; a function
+ *              is found by linear probing from hash & (buckets - 1)
+ *   names      the function names, each terminated by '\0' and followed
+ *              by the call sites of the function
+ *   padding    to a multiple of 8 bytes
+ *   counters   u64 counters of all functions
+ *
+ * The hash of a name is the 64 bit FNV-1a hash of its bytes. The call sites
+ * describe the control flow graph and the calls of a function for the
+ * compiler, so it can tell how often a function was entered and called
+ * others without the graph. They are covered by the checksum.
+ */
+#ifndef FIRMPROF_H
+#define FIRMPROF_H
+
+#include <stdint.h>
+
+#define FIRMPROF_MAGIC   "firmprof"
+#define FIRMPROF_VERSION 5
+
+/** Size of the header in bytes. */
+#define FIRMPROF_HEADER_SIZE 32
+/** Size of a function record in bytes. */
+#define FIRMPROF_RECORD_SIZE 40
+
+typedef struct firmprof_t firmprof_t;
+
+/** Creates an empty profile. */
+firmprof_t *firmprof_new(void);
+
+/** Frees a profile. */
+void firmprof_free(firmprof_t *profile);
+
+/**
+ * Adds the counters of a function to a profile. The counters are summed
+ * with those of an earlier function with the same name and checksum, the
+ * call sites are kept from the first one.
+ * @return 0 on success, -1 if the function is already in the profile with
+ *         another checksum or number of counters; the counters are dropped
+ */
+int firmprof_add_function(firmprof_t *profile, const char *name,
+                          unsigned name_len, uint64_t checksum,
+                          const uint64_t *counters, unsigned n_counters,
+                          const unsigned char *calls, unsigned calls_size);
+
+/**
+ * Adds all functions of the profile file @p filename to a profile.
+ * Functions which do not match the profile are reported and skipped.
+ * @return 0 on success, -1 if the file cannot be read or is broken
+ */
+int firmprof_add_file(firmprof_t *profile, const char *filename);
+
+/**
+ * Writes a profile to @p filename. The profile is written to a temporary
+ * file next to it first, which then replaces @p filename.
+ * @return 0 on success, -1 on failure
+ */
+int firmprof_write(const firmprof_t *profile, const char *filename);
+
+/**
+ * Sums the profile files @p inputs into the profile file @p output. The
+ * output may be one of the inputs.
+ * @return 0 on success, -1 if an input could not be read or the output
+ *         could not be written
+ */
+int firmprof_merge(const char *output, const char *const *inputs,
+                   unsigned n_inputs);
+
+#endif
@@ -3,59 +3,166 @@
  * This file is a supplement to libFirm. It is public domain.
  *  @author Matthias Braun, Steven Schaefer
  */
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
-/* Prevent the compiler from mangling the name of this function. */
-void __init_firmprof(const char*, unsigned int*, size_t)
+#include "firmprof.h"
+
+/* version of the layout emitted by the compiler */
+#define LAYOUT_VERSION 4
+
+/* Prevent the compiler from mangling the name of these functions. */
+void __init_firmprof(const char*, const unsigned char*, unsigned int,
+                     uint64_t*, unsigned int)
      asm("__init_firmprof");
+void __firmprof_atomic_inc(uint64_t*) asm("__firmprof_atomic_inc");
 
 typedef struct _profile_counter_t {
-	const char *filename;
-	unsigned   *counters;
-	unsigned    len;
+	const char          *filename;
+	char                *output;     /**< name of the written profile */
+	const unsigned char *layout;
+	unsigned             layout_size;
+	uint64_t            *counters;
+	unsigned             len;
 	struct _profile_counter_t *next;
 } profile_counter_t;
 
 static profile_counter_t *counters = NULL;
 
+static uint32_t layout_u32(const unsigned char *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16
+	     | (uint32_t)p[3] << 24;
+}
+
 /**
- * Write counter values to profiling output file.
- * We define our output format to be a sequence of 32-bit unsigned integer
- * values stored in little endian format.
+ * Collects the counters of a translation unit in a profile. The layout
+ * lists the functions, the number of counters they own and their call
+ * sites, see irprofile.c.
  */
-void write_little_endian(unsigned *counter, unsigned len, FILE *f)
+static int add_counters(firmprof_t *profile, const profile_counter_t *counter)
 {
-	unsigned i;
+	const unsigned char *layout = counter->layout;
+	const unsigned char *end    = layout + counter->layout_size;
+	const uint64_t      *counts = counter->counters;
+	unsigned             n_functions;
+	unsigned             i;
 
-	for (i = 0; i < len; ++i) {
-		unsigned      v = counter[i];
-		unsigned char bytes[4];
+	if (counter->layout_size < 8 || layout_u32(layout) != LAYOUT_VERSION)
+		return -1;
+	n_functions = layout_u32(layout + 4);
+	layout += 8;
+	for (i = 0; i < n_functions; ++i) {
+		uint32_t name_len;
+		uint64_t checksum;
+		uint32_t n_counters;
+		uint32_t calls_size;
+		if (end - layout < 4)
+			return -1;
+		name_len = layout_u32(layout);
+		if ((uint64_t)(end - layout) < (uint64_t)name_len + 20)
+			return -1;
+		checksum   = layout_u32(layout + 4 + name_len)
+		           | (uint64_t)layout_u32(layout + 8 + name_len) << 32;
+		n_counters = layout_u32(layout + 12 + name_len);
+		calls_size = layout_u32(layout + 16 + name_len);
+		if (counts + n_counters > counter->counters + counter->len
+		    || (uint64_t)(end - layout) < (uint64_t)name_len + 20 + calls_size)
+			return -1;
+		/* a function is in a translation unit only once */
+		firmprof_add_function(profile, (const char*)layout + 4, name_len,
+		                      checksum, counts, n_counters,
+		                      layout + 20 + name_len, calls_size);
+		counts += n_counters;
+		layout += 20 + name_len + calls_size;
+	}
+	return 0;
+}
 
-		bytes[0] = ((v >>  0) & 0xff);
-		bytes[1] = ((v >>  8) & 0xff);
-		bytes[2] = ((v >> 16) & 0xff);
-		bytes[3] = ((v >> 24) & 0xff);
+/**
+ * Returns the name of the profile for a translation unit whose compiler
+ * chose @p filename. The environment variable FIRMPROF_FILE overrides the
+ * name, "%f" in it stands for @p filename and "%p" for the process id, so
+ * runs in parallel write profiles of their own with FIRMPROF_FILE=%f.%p.
+ */
+static char *get_output_name(const char *filename)
+{
+	const char *pattern = getenv("FIRMPROF_FILE");
+	const char *p;
+	char       *name;
+	char       *out;
+	size_t      len = 1;
+	if (pattern == NULL || pattern[0] == '\0')
+		pattern = "%f";
 
-		fwrite(bytes, 1, 4, f);
+	for (p = pattern; *p != '\0'; ++p)
+		len += p[0] == '%' && p[1] == 'f' ? strlen(filename) : 24;
+	name = (char*) malloc(len);
+	if (name == NULL)
+		return NULL;
+	for (p = pattern, out = name; *p != '\0'; ++p) {
+		if (p[0] == '%' && p[1] == 'f') {
+			out += sprintf(out, "%s", filename);
+			++p;
+		} else if (p[0] == '%' && p[1] == 'p') {
+			out += sprintf(out, "%ld", (long)getpid());
+			++p;
+		} else {
+			*out++ = *p;
+		}
 	}
+	*out = '\0';
+	return name;
 }
 
+/**
+ * Write the counters of the translation units to their profiling output
+ * files. Translation units with the same output file share one profile.
+ * The format is described in firmprof.h.
+ */
 static void write_profiles(void)
 {
-	profile_counter_t *counter = counters;
-	while (counter != NULL) {
-		profile_counter_t *next = counter->next;
-		FILE *f = fopen(counter->filename, "wb");
-		if (f == NULL) {
-			perror("Warning: couldn't open file for writing profiling data");
-		} else {
-			fputs("firmprof", f);
-			write_little_endian(counter->counters, counter->len, f);
-			fclose(f);
+	profile_counter_t *counter;
+	for (counter = counters; counter != NULL; counter = counter->next)
+		counter->output = get_output_name(counter->filename);
+
+	for (counter = counters; counter != NULL; counter = counter->next) {
+		firmprof_t        *profile;
+		profile_counter_t *other;
+		int                broken;
+		if (counter->output == NULL)
+			continue;
+
+		profile = firmprof_new();
+		broken  = profile == NULL;
+		for (other = counter; other != NULL; other = other->next) {
+			if (other->output == NULL
+			    || strcmp(other->output, counter->output) != 0)
+				continue;
+			if (!broken)
+				broken = add_counters(profile, other) != 0;
+			if (other != counter) {
+				free(other->output);
+				other->output = NULL;
+			}
+		}
+		if (broken) {
+			fprintf(stderr, "Warning: broken profile layout for '%s'\n",
+			        counter->output);
+		} else if (firmprof_write(profile, counter->output) != 0) {
+			perror("Warning: couldn't write profiling data");
 		}
-		free(counter);
-		counter = next;
+		firmprof_free(profile);
+	}
+
+	while (counters != NULL) {
+		counter = counters->next;
+		free(counters->output);
+		free(counters);
+		counters = counter;
 	}
 }
 
@@ -63,9 +170,12 @@ static void write_profiles(void)
  * Register a new profile counter. This is called by separate constructors
  * for each translation unit. Incidentally, referring to this function as
  * "__init_firmprof" is perfectly linker friendly.
+ * The layout describes the functions and the counters they own, it is
+ * written unchanged in front of the counters.
  */
 void __init_firmprof(const char *filename,
-                      unsigned int *counts, size_t len)
+                     const unsigned char *layout, unsigned int layout_size,
+                     uint64_t *counts, unsigned int len)
 {
 	static int initialized = 0;
 	profile_counter_t *counter;
@@ -79,10 +189,21 @@ void __init_firmprof(const char *filename,
 	if (counter == NULL)
 		return;
 
-	counter->filename = filename;
-	counter->counters = counts;
-	counter->next     = counters;
-	counter->len      = len;
+	counter->filename    = filename;
+	counter->output      = NULL;
+	counter->layout      = layout;
+	counter->layout_size = layout_size;
+	counter->counters    = counts;
+	counter->next        = counters;
+	counter->len         = len;
 
 	counters = counter;
 }
+
+/**
+ * Increments a counter of a program compiled with atomic profile counters.
+ */
+void __firmprof_atomic_inc(uint64_t *counter)
+{
+	__atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,429 @@
+/**
+ * Reading, writing and merging of libFirm profiles, see firmprof.h for the
+ * file format.
+ * This file is a supplement to libFirm. It is public domain.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "firmprof.h"
+
+typedef struct firmprof_function_t {
+	char          *name;
+	unsigned       name_len;
+	uint64_t       hash;
+	uint64_t       checksum;
+	uint64_t      *counters;
+	unsigned       n_counters;
+	unsigned char *calls;
+	unsigned       calls_size;
+} firmprof_function_t;
+
+struct firmprof_t {
+	firmprof_function_t *functions;
+	unsigned             n_functions;
+	unsigned             capacity;
+	unsigned            *buckets;    /**< function number + 1, 0 if empty */
+	unsigned             n_buckets;  /**< a power of two */
+};
+
+static uint64_t hash_name(const char *name, unsigned len)
+{
+	uint64_t hash = UINT64_C(0xCBF29CE484222325);
+	unsigned i;
+	for (i = 0; i < len; ++i) {
+		hash ^= (unsigned char)name[i];
+		hash *= UINT64_C(0x100000001B3);
+	}
+	return hash;
+}
+
+static uint32_t get_u32(const unsigned char *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16
+	     | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_u64(const unsigned char *p)
+{
+	return get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+static void put_u32(unsigned char *p, uint32_t value)
+{
+	unsigned i;
+	for (i = 0; i < 4; ++i)
+		p[i] = (value >> (i * 8)) & 0xff;
+}
+
+static void put_u64(unsigned char *p, uint64_t value)
+{
+	put_u32(p, (uint32_t)value);
+	put_u32(p + 4, (uint32_t)(value >> 32));
+}
+
+firmprof_t *firmprof_new(void)
+{
+	return (firmprof_t*) calloc(1, sizeof(firmprof_t));
+}
+
+void firmprof_free(firmprof_t *profile)
+{
+	unsigned i;
+	if (profile == NULL)
+		return;
+	for (i = 0; i < profile->n_functions; ++i) {
+		free(profile->functions[i].name);
+		free(profile->functions[i].counters);
+		free(profile->functions[i].calls);
+	}
+	free(profile->functions);
+	free(profile->buckets);
+	free(profile);
+}
+
+static void insert_bucket(unsigned *buckets, unsigned n_buckets,
+                          uint64_t hash, unsigned nr)
+{
+	unsigned b = (unsigned)hash & (n_buckets - 1);
+	while (buckets[b] != 0)
+		b = (b + 1) & (n_buckets - 1);
+	buckets[b] = nr + 1;
+}
+
+/** Keeps the buckets at most half full. */
+static int grow_buckets(firmprof_t *profile)
+{
+	unsigned  n_buckets = profile->n_buckets != 0 ? profile->n_buckets * 2 : 16;
+	unsigned *buckets;
+	unsigned  i;
+	if (profile->n_functions * 2 < profile->n_buckets)
+		return 0;
+
+	buckets = (unsigned*) calloc(n_buckets, sizeof(*buckets));
+	if (buckets == NULL)
+		return -1;
+	for (i = 0; i < profile->n_functions; ++i)
+		insert_bucket(buckets, n_buckets, profile->functions[i].hash, i);
+	free(profile->buckets);
+	profile->buckets   = buckets;
+	profile->n_buckets = n_buckets;
+	return 0;
+}
+
+static firmprof_function_t *find_function(const firmprof_t *profile,
+                                          const char *name, unsigned name_len,
+                                          uint64_t hash)
+{
+	unsigned b;
+	if (profile->n_buckets == 0)
+		return NULL;
+	for (b = (unsigned)hash & (profile->n_buckets - 1);
+	     profile->buckets[b] != 0; b = (b + 1) & (profile->n_buckets - 1)) {
+		firmprof_function_t *function
+			= &profile->functions[profile->buckets[b] - 1];
+		if (function->hash == hash && function->name_len == name_len
+		    && memcmp(function->name, name, name_len) == 0)
+			return function;
+	}
+	return NULL;
+}
+
+int firmprof_add_function(firmprof_t *profile, const char *name,
+                          unsigned name_len, uint64_t checksum,
+                          const uint64_t *counters, unsigned n_counters,
+                          const unsigned char *calls, unsigned calls_size)
+{
+	uint64_t             hash     = hash_name(name, name_len);
+	firmprof_function_t *function = find_function(profile, name, name_len,
+	                                              hash);
+	unsigned             i;
+
+	if (function != NULL) {
+		if (function->checksum != checksum
+		    || function->n_counters != n_counters)
+			return -1;
+		for (i = 0; i < n_counters; ++i) {
+			uint64_t sum = function->counters[i] + counters[i];
+			/* saturate instead of wrapping around */
+			function->counters[i] = sum < counters[i] ? UINT64_MAX : sum;
+		}
+		return 0;
+	}
+
+	if (grow_buckets(profile) != 0)
+		return -1;
+	if (profile->n_functions == profile->capacity) {
+		unsigned capacity = profile->capacity != 0 ? profile->capacity * 2 : 16;
+		firmprof_function_t *functions = (firmprof_function_t*)
+			realloc(profile->functions, capacity * sizeof(*functions));
+		if (functions == NULL)
+			return -1;
+		profile->functions = functions;
+		profile->capacity  = capacity;
+	}
+
+	function = &profile->functions[profile->n_functions];
+	function->name     = (char*) malloc(name_len + 1);
+	function->counters = (uint64_t*) malloc(n_counters * sizeof(uint64_t) + 1);
+	function->calls    = (unsigned char*) malloc(calls_size + 1);
+	if (function->name == NULL || function->counters == NULL
+	    || function->calls == NULL) {
+		free(function->name);
+		free(function->counters);
+		free(function->calls);
+		return -1;
+	}
+	memcpy(function->name, name, name_len);
+	function->name[name_len] = '\0';
+	memcpy(function->counters, counters, n_counters * sizeof(uint64_t));
+	memcpy(function->calls, calls, calls_size);
+	function->name_len   = name_len;
+	function->hash       = hash;
+	function->checksum   = checksum;
+	function->n_counters = n_counters;
+	function->calls_size = calls_size;
+	insert_bucket(profile->buckets, profile->n_buckets, hash,
+	              profile->n_functions++);
+	return 0;
+}
+
+static unsigned char *read_file(const char *filename, size_t *size)
+{
+	FILE          *f = fopen(filename, "rb");
+	size_t         len = 0;
+	size_t         cap = 4096;
+	unsigned char *result;
+	if (f == NULL)
+		return NULL;
+
+	result = (unsigned char*) malloc(cap);
+	while (result != NULL) {
+		unsigned char *grown;
+		len += fread(result + len, 1, cap - len, f);
+		if (len < cap)
+			break;
+		cap  *= 2;
+		grown = (unsigned char*) realloc(result, cap);
+		if (grown == NULL)
+			free(result);
+		result = grown;
+	}
+	if (result != NULL && ferror(f)) {
+		free(result);
+		result = NULL;
+	}
+	fclose(f);
+	*size = len;
+	return result;
+}
+
+int firmprof_add_file(firmprof_t *profile, const char *filename)
+{
+	size_t               size;
+	unsigned char       *data = read_file(filename, &size);
+	const unsigned char *records;
+	const unsigned char *names;
+	const unsigned char *counters;
+	uint64_t            *values = NULL;
+	uint64_t             n_counters;
+	uint64_t             names_offset;
+	uint64_t             counters_offset;
+	unsigned             n_functions;
+	unsigned             n_buckets;
+	unsigned             names_size;
+	unsigned             i;
+	int                  res = -1;
+
+	if (data == NULL) {
+		fprintf(stderr, "firmprof: couldn't read '%s'\n", filename);
+		return -1;
+	}
+	if (size < FIRMPROF_HEADER_SIZE
+	    || memcmp(data, FIRMPROF_MAGIC, 8) != 0
+	    || get_u32(data + 8) != FIRMPROF_VERSION)
+		goto broken;
+
+	n_functions     = get_u32(data + 12);
+	n_buckets       = get_u32(data + 16);
+	names_size      = get_u32(data + 20);
+	n_counters      = get_u64(data + 24);
+	names_offset    = FIRMPROF_HEADER_SIZE
+	                + (uint64_t)n_functions * FIRMPROF_RECORD_SIZE
+	                + (uint64_t)n_buckets * 4;
+	counters_offset = (names_offset + names_size + 7) & ~(uint64_t)7;
+	if (counters_offset > size || (size - counters_offset) / 8 < n_counters)
+		goto broken;
+	records  = data + FIRMPROF_HEADER_SIZE;
+	names    = data + names_offset;
+	counters = data + counters_offset;
+
+	for (i = 0; i < n_functions; ++i) {
+		const unsigned char *record      = records + i * FIRMPROF_RECORD_SIZE;
+		uint64_t             checksum    = get_u64(record + 8);
+		uint64_t             first       = get_u64(record + 16);
+		uint32_t             name_offset = get_u32(record + 24);
+		uint32_t             n_values    = get_u32(record + 28);
+		uint32_t             calls       = get_u32(record + 32);
+		uint32_t             calls_size  = get_u32(record + 36);
+		const char          *name        = (const char*)names + name_offset;
+		const void          *end;
+		uint32_t             c;
+
+		if (name_offset >= names_size || first > n_counters
+		    || n_counters - first < n_values
+		    || calls > names_size || names_size - calls < calls_size)
+			goto broken;
+		end = memchr(name, '\0', names_size - name_offset);
+		if (end == NULL)
+			goto broken;
+
+		free(values);
+		values = (uint64_t*) malloc(n_values * sizeof(*values) + 1);
+		if (values == NULL)
+			goto end;
+		for (c = 0; c < n_values; ++c)
+			values[c] = get_u64(counters + (first + c) * 8);
+		if (firmprof_add_function(profile, name,
+		                          (unsigned)((const char*)end - name),
+		                          checksum, values, n_values,
+		                          names + calls, calls_size) != 0)
+			fprintf(stderr, "firmprof: skipping '%s' from '%s', it does not match the other profiles\n",
+			        name, filename);
+	}
+	res = 0;
+	goto end;
+
+broken:
+	fprintf(stderr, "firmprof: '%s' is not a valid profile\n", filename);
+end:
+	free(values);
+	free(data);
+	return res;
+}
+
+int firmprof_write(const firmprof_t *profile, const char *filename)
+{
+	unsigned       n_functions = profile->n_functions;
+	unsigned       n_buckets   = 1;
+	uint64_t       n_counters  = 0;
+	size_t         names_size  = 0;
+	size_t         names_offset;
+	size_t         counters_offset;
+	size_t         size;
+	size_t         written;
+	unsigned char *data;
+	unsigned char *names;
+	unsigned      *buckets;
+	unsigned       i;
+	char          *temp;
+	FILE          *f;
+	int            res;
+
+	/* at most half of the buckets are used */
+	while (n_buckets < 2 * n_functions)
+		n_buckets *= 2;
+	for (i = 0; i < n_functions; ++i) {
+		names_size += profile->functions[i].name_len + 1
+		            + profile->functions[i].calls_size;
+		n_counters += profile->functions[i].n_counters;
+	}
+	names_offset    = FIRMPROF_HEADER_SIZE
+	                + (size_t)n_functions * FIRMPROF_RECORD_SIZE
+	                + (size_t)n_buckets * 4;
+	counters_offset = (names_offset + names_size + 7) & ~(size_t)7;
+	size            = counters_offset + n_counters * 8;
+
+	data    = (unsigned char*) calloc(size, 1);
+	buckets = (unsigned*) calloc(n_buckets, sizeof(*buckets));
+	if (data == NULL || buckets == NULL) {
+		free(data);
+		free(buckets);
+		return -1;
+	}
+
+	memcpy(data, FIRMPROF_MAGIC, 8);
+	put_u32(data + 8, FIRMPROF_VERSION);
+	put_u32(data + 12, n_functions);
+	put_u32(data + 16, n_buckets);
+	put_u32(data + 20, (uint32_t)names_size);
+	put_u64(data + 24, n_counters);
+
+	names      = data + names_offset;
+	names_size = 0;
+	n_counters = 0;
+	for (i = 0; i < n_functions; ++i) {
+		const firmprof_function_t *function = &profile->functions[i];
+		unsigned char *record = data + FIRMPROF_HEADER_SIZE
+		                      + i * FIRMPROF_RECORD_SIZE;
+		unsigned       c;
+
+		put_u64(record, function->hash);
+		put_u64(record + 8, function->checksum);
+		put_u64(record + 16, n_counters);
+		put_u32(record + 24, (uint32_t)names_size);
+		put_u32(record + 28, function->n_counters);
+		memcpy(names + names_size, function->name, function->name_len + 1);
+		names_size += function->name_len + 1;
+		put_u32(record + 32, (uint32_t)names_size);
+		put_u32(record + 36, function->calls_size);
+		memcpy(names + names_size, function->calls, function->calls_size);
+		names_size += function->calls_size;
+		for (c = 0; c < function->n_counters; ++c)
+			put_u64(data + counters_offset + (n_counters + c) * 8,
+			        function->counters[c]);
+		n_counters += function->n_counters;
+		insert_bucket(buckets, n_buckets, function->hash, i);
+	}
+	for (i = 0; i < n_buckets; ++i)
+		put_u32(data + FIRMPROF_HEADER_SIZE
+		        + (size_t)n_functions * FIRMPROF_RECORD_SIZE + i * 4,
+		        buckets[i]);
+	free(buckets);
+
+	/* readers and concurrent writers see the old or the new file whole */
+	temp = (char*) malloc(strlen(filename) + 32);
+	if (temp == NULL) {
+		free(data);
+		return -1;
+	}
+	sprintf(temp, "%s.tmp%ld", filename, (long)getpid());
+	f = fopen(temp, "wb");
+	if (f == NULL) {
+		free(data);
+		free(temp);
+		return -1;
+	}
+	written = fwrite(data, 1, size, f);
+	free(data);
+	res = fclose(f) != 0 || written != size ? -1 : 0;
+	if (res == 0 && rename(temp, filename) != 0)
+		res = -1;
+	if (res != 0)
+		remove(temp);
+	free(temp);
+	return res;
+}
+
+int firmprof_merge(const char *output, const char *const *inputs,
+                   unsigned n_inputs)
+{
+	firmprof_t *profile = firmprof_new();
+	int         res     = 0;
+	unsigned    i;
+	if (profile == NULL)
+		return -1;
+
+	for (i = 0; i < n_inputs; ++i) {
+		if (firmprof_add_file(profile, inputs[i]) != 0)
+			res = -1;
+	}
+	if (firmprof_write(profile, output) != 0) {
+		fprintf(stderr, "firmprof: couldn't write '%s'\n", output);
+		res = -1;
+	}
+	firmprof_free(profile);
+	return res;
+}
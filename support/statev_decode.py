@@ -0,0 +1,88 @@
+#! /usr/bin/env python
+#
+# This file is part of libFirm.
+# Copyright (C) 2012 Karlsruhe Institute of Technology.
+#
+# Decodes the binary event logs written by stat_ev_begin_binary() into the
+# text format of stat_ev_begin(), which statev_sql.py reads.
+import struct
+import sys
+
+MAGIC  = b"firmev\0\1"
+RECORD = struct.Struct("<B3xIQ")
+
+def padded_length(length):
+	return (length + RECORD.size - 1) // RECORD.size * RECORD.size
+
+def read_chunks(data):
+	"""Yields (thread, records) for every buffer written to the log."""
+	if data[:len(MAGIC)] != MAGIC:
+		raise ValueError("not a binary statev log")
+	pos = len(MAGIC)
+	while pos < len(data):
+		kind, thread, n_records = RECORD.unpack_from(data, pos)
+		if kind != ord('T'):
+			raise ValueError("expected thread record at offset %d" % pos)
+		pos += RECORD.size
+		yield thread, data[pos:pos + n_records * RECORD.size]
+		pos += n_records * RECORD.size
+
+def iter_records(records):
+	"""Yields (kind, key, value, string) for the records of a chunk."""
+	pos = 0
+	while pos < len(records):
+		kind, key, value = RECORD.unpack_from(records, pos)
+		pos += RECORD.size
+		kind = chr(kind)
+		string = None
+		if kind in "KP":
+			string = records[pos:pos + value].decode("utf-8", "replace")
+			pos += padded_length(value)
+		yield kind, key, value, string
+
+def format_value(kind, value):
+	if kind == 'I':
+		return "%d" % struct.unpack("<q", struct.pack("<Q", value))[0]
+	elif kind == 'U':
+		return "%d" % value
+	elif kind == 'D':
+		return "%g" % struct.unpack("<d", struct.pack("<Q", value))[0]
+	return "0.0"
+
+def decode(data):
+	"""Yields the lines of the text format. Each thread forms a contiguous
+	sequence of lines, so context pushes and pops stay balanced."""
+	chunks = list(read_chunks(data))
+
+	# Keys are written to the chunk of the thread using them first, so
+	# collect them all before translating events of any thread.
+	keys = dict()
+	for thread, records in chunks:
+		for kind, key, value, string in iter_records(records):
+			if kind == 'K':
+				keys[key] = string
+
+	threads = sorted(set(thread for thread, records in chunks))
+	for current in threads:
+		for thread, records in chunks:
+			if thread != current:
+				continue
+			for kind, key, value, string in iter_records(records):
+				if kind == 'P':
+					yield "P;%s;%s\n" % (keys[key], string)
+				elif kind == 'O':
+					yield "O;%s\n" % keys[key]
+				elif kind in "IUDN":
+					yield "E;%s;%s\n" % (keys[key], format_value(kind, value))
+
+def decode_file(filename):
+	with open(filename, "rb") as f:
+		data = f.read()
+	return decode(data)
+
+if __name__ == "__main__":
+	if len(sys.argv) != 2:
+		sys.stderr.write("usage: %s <file.evb>\n" % sys.argv[0])
+		sys.exit(1)
+	for line in decode_file(sys.argv[1]):
+		sys.stdout.write(line)
@@ -11,6 +11,9 @@ import fileinput
 import tempfile
 import optparse
 
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import statev_decode
+
 class DummyFilter:
 	def match(self, dummy):
 		return True
@@ -293,7 +296,13 @@ class Conv:
 		return (ctxlist, evlist)
 
 	def input(self):
-		return fileinput.FileInput(files=self.files, openhook=fileinput.hook_compressed)
+		for file in self.files:
+			if file.endswith(".evb"):
+				for line in statev_decode.decode_file(file):
+					yield line
+			else:
+				for line in fileinput.FileInput(files=[file], openhook=fileinput.hook_compressed):
+					yield line
 
 	def flush_events(self, id):
 		isnull = True
@@ -0,0 +1,257 @@
+/*
+ * Test the amd64 instruction encoder against the encodings of GNU as.
+ */
+
+#include "amd64_encode.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* the encoder never looks at entities, any non-NULL pointer will do */
+static char              dummy;
+static ir_entity const  *const ent = (ir_entity const*)&dummy;
+
+static amd64_fixup_t fixups[2];
+static unsigned      n_fixups;
+
+static void check(amd64_insn_t const *insn, char const *name,
+                  unsigned len, uint8_t const *expected)
+{
+	uint8_t buffer[AMD64_MAX_INSN_SIZE];
+	unsigned const res_len = amd64_insn_encode(insn, buffer, fixups, &n_fixups);
+	if (res_len != len || memcmp(buffer, expected, len) != 0) {
+		fprintf(stderr, "%s: got", name);
+		for (unsigned i = 0; i < res_len; ++i)
+			fprintf(stderr, " %02x", buffer[i]);
+		fprintf(stderr, "\n");
+		assert(false);
+	}
+}
+
+#define CHECK(insn, name, ...) do { \
+		static const uint8_t expected[] = { __VA_ARGS__ }; \
+		check(insn, name, sizeof(expected), expected); \
+	} while (0)
+
+static amd64_enc_addr_t reg_addr(unsigned base, unsigned index,
+                                 unsigned log_scale, int32_t disp)
+{
+	amd64_enc_addr_t addr = {
+		.base      = (uint8_t)base,
+		.index     = (uint8_t)index,
+		.log_scale = (uint8_t)log_scale,
+		.disp      = disp,
+	};
+	return addr;
+}
+
+static void test_registers(void)
+{
+	amd64_insn_t insn;
+
+	/* movl %esi, %eax */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x89);
+	amd64_insn_modrm_reg(&insn, 6, 0);
+	CHECK(&insn, "movl %esi,%eax", 0x89, 0xF0);
+
+	/* movq %rsi, %r9 */
+	amd64_insn_init(&insn);
+	amd64_insn_rex_w(&insn);
+	amd64_insn_opcode(&insn, 0x89);
+	amd64_insn_modrm_reg(&insn, 6, 9);
+	CHECK(&insn, "movq %rsi,%r9", 0x49, 0x89, 0xF1);
+
+	/* movq %rax, %xmm3 */
+	amd64_insn_init(&insn);
+	amd64_insn_prefix(&insn, 0x66);
+	amd64_insn_rex_w(&insn);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, 0x6E);
+	amd64_insn_modrm_reg(&insn, 3, 0);
+	CHECK(&insn, "movq %rax,%xmm3", 0x66, 0x48, 0x0F, 0x6E, 0xD8);
+
+	/* sete %sil needs a REX prefix */
+	amd64_insn_init(&insn);
+	amd64_insn_byte_reg(&insn, 6);
+	amd64_insn_opcode(&insn, 0x0F);
+	amd64_insn_opcode(&insn, 0x94);
+	amd64_insn_modrm_reg(&insn, 0, 6);
+	CHECK(&insn, "sete %sil", 0x40, 0x0F, 0x94, 0xC6);
+
+	/* pushq %r12 */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x50);
+	amd64_insn_opcode_reg(&insn, 12);
+	CHECK(&insn, "pushq %r12", 0x41, 0x54);
+
+	/* movabsq $0x123456789, %r10 */
+	amd64_insn_init(&insn);
+	amd64_insn_rex_w(&insn);
+	amd64_insn_opcode(&insn, 0xB8);
+	amd64_insn_opcode_reg(&insn, 10);
+	amd64_insn_imm(&insn, 8, 0x123456789, NULL, AMD64_RELOC_NONE);
+	CHECK(&insn, "movabsq $0x123456789,%r10", 0x49, 0xBA, 0x89, 0x67, 0x45,
+	      0x23, 0x01, 0x00, 0x00, 0x00);
+}
+
+static void test_addresses(void)
+{
+	amd64_insn_t     insn;
+	amd64_enc_addr_t addr;
+
+	/* movl (%rax), %ecx */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(0, AMD64_NO_REG, 0, 0);
+	amd64_insn_modrm_mem(&insn, 1, &addr);
+	CHECK(&insn, "movl (%rax),%ecx", 0x8B, 0x08);
+
+	/* movl (%rbp), %ecx needs a displacement */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(5, AMD64_NO_REG, 0, 0);
+	amd64_insn_modrm_mem(&insn, 1, &addr);
+	CHECK(&insn, "movl (%rbp),%ecx", 0x8B, 0x4D, 0x00);
+
+	/* movl (%r13), %ecx */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(13, AMD64_NO_REG, 0, 0);
+	amd64_insn_modrm_mem(&insn, 1, &addr);
+	CHECK(&insn, "movl (%r13),%ecx", 0x41, 0x8B, 0x4D, 0x00);
+
+	/* movl 8(%rsp), %ecx needs a SIB byte */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(4, AMD64_NO_REG, 0, 8);
+	amd64_insn_modrm_mem(&insn, 1, &addr);
+	CHECK(&insn, "movl 8(%rsp),%ecx", 0x8B, 0x4C, 0x24, 0x08);
+
+	/* movl 0x1000(%r12), %ecx */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(12, AMD64_NO_REG, 0, 0x1000);
+	amd64_insn_modrm_mem(&insn, 1, &addr);
+	CHECK(&insn, "movl 0x1000(%r12),%ecx", 0x41, 0x8B, 0x8C, 0x24, 0x00,
+	      0x10, 0x00, 0x00);
+
+	/* leaq -8(%rbx,%r9,4), %r8 */
+	amd64_insn_init(&insn);
+	amd64_insn_rex_w(&insn);
+	amd64_insn_opcode(&insn, 0x8D);
+	addr = reg_addr(3, 9, 2, -8);
+	amd64_insn_modrm_mem(&insn, 8, &addr);
+	CHECK(&insn, "leaq -8(%rbx,%r9,4),%r8", 0x4E, 0x8D, 0x44, 0x8B, 0xF8);
+
+	/* movl 16, %eax: absolute without base uses a SIB byte */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(AMD64_NO_REG, AMD64_NO_REG, 0, 16);
+	amd64_insn_modrm_mem(&insn, 0, &addr);
+	CHECK(&insn, "movl 16,%eax", 0x8B, 0x04, 0x25, 0x10, 0x00, 0x00, 0x00);
+
+	/* movl %fs:0, %eax */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(AMD64_NO_REG, AMD64_NO_REG, 0, 0);
+	addr.segment = 0x64;
+	amd64_insn_modrm_mem(&insn, 0, &addr);
+	CHECK(&insn, "movl %fs:0,%eax", 0x64, 0x8B, 0x04, 0x25, 0x00, 0x00,
+	      0x00, 0x00);
+}
+
+static void test_relocations(void)
+{
+	amd64_insn_t     insn;
+	amd64_enc_addr_t addr;
+
+	/* call foo */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0xE8);
+	amd64_insn_imm(&insn, 4, 0, ent, AMD64_RELOC_PLT32);
+	CHECK(&insn, "call foo", 0xE8, 0x00, 0x00, 0x00, 0x00);
+	assert(n_fixups == 1);
+	assert(fixups[0].offset == 1);
+	assert(fixups[0].type == AMD64_RELOC_PLT32);
+	assert(fixups[0].addend == -4);
+
+	/* movl $5, foo+8(%rip): the addend includes the immediate */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0xC7);
+	amd64_insn_imm(&insn, 4, 5, NULL, AMD64_RELOC_NONE);
+	addr = reg_addr(AMD64_NO_REG, AMD64_NO_REG, 0, 8);
+	addr.rip    = true;
+	addr.entity = ent;
+	addr.reloc  = AMD64_RELOC_PC32;
+	amd64_insn_modrm_mem(&insn, 0, &addr);
+	CHECK(&insn, "movl $5,foo+8(%rip)", 0xC7, 0x05, 0x00, 0x00, 0x00, 0x00,
+	      0x05, 0x00, 0x00, 0x00);
+	assert(n_fixups == 1);
+	assert(fixups[0].offset == 2);
+	assert(fixups[0].type == AMD64_RELOC_PC32);
+	assert(fixups[0].addend == 8 - 8);
+
+	/* movq foo@GOTPCREL(%rip), %rax is relaxable */
+	amd64_insn_init(&insn);
+	amd64_insn_rex_w(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(AMD64_NO_REG, AMD64_NO_REG, 0, 0);
+	addr.rip    = true;
+	addr.entity = ent;
+	addr.reloc  = AMD64_RELOC_GOTPCREL;
+	amd64_insn_modrm_mem(&insn, 0, &addr);
+	CHECK(&insn, "movq foo@GOTPCREL(%rip),%rax", 0x48, 0x8B, 0x05, 0x00,
+	      0x00, 0x00, 0x00);
+	assert(n_fixups == 1);
+	assert(fixups[0].type == AMD64_RELOC_REX_GOTPCRELX);
+	assert(fixups[0].addend == -4);
+
+	/* call *foo@GOTPCREL(%rip) */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0xFF);
+	amd64_insn_modrm_mem(&insn, 2, &addr);
+	CHECK(&insn, "call *foo@GOTPCREL(%rip)", 0xFF, 0x15, 0x00, 0x00, 0x00,
+	      0x00);
+	assert(fixups[0].type == AMD64_RELOC_GOTPCRELX);
+
+	/* pushq foo@GOTPCREL(%rip) is not relaxable */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0xFF);
+	amd64_insn_modrm_mem(&insn, 6, &addr);
+	CHECK(&insn, "pushq foo@GOTPCREL(%rip)", 0xFF, 0x35, 0x00, 0x00, 0x00,
+	      0x00);
+	assert(fixups[0].type == AMD64_RELOC_GOTPCREL);
+
+	/* movl foo(%rax), %ecx: entities always get a disp32 */
+	amd64_insn_init(&insn);
+	amd64_insn_opcode(&insn, 0x8B);
+	addr = reg_addr(0, AMD64_NO_REG, 0, 4);
+	addr.entity = ent;
+	addr.reloc  = AMD64_RELOC_32S;
+	amd64_insn_modrm_mem(&insn, 1, &addr);
+	CHECK(&insn, "movl foo+4(%rax),%ecx", 0x8B, 0x88, 0x00, 0x00, 0x00, 0x00);
+	assert(n_fixups == 1);
+	assert(fixups[0].type == AMD64_RELOC_32S);
+	assert(fixups[0].addend == 4);
+}
+
+static void test_nops(void)
+{
+	unsigned char buffer[16];
+	amd64_create_nops(buffer, 1);
+	assert(buffer[0] == 0x90);
+	amd64_create_nops(buffer, 14);
+	assert(buffer[0] == 0x66 && buffer[1] == 0x66 && buffer[2] == 0x2E);
+	assert(buffer[11] == 0x0F && buffer[12] == 0x1F && buffer[13] == 0x00);
+}
+
+int main(void)
+{
+	test_registers();
+	test_addresses();
+	test_relocations();
+	test_nops();
+	return 0;
+}
@@ -0,0 +1,339 @@
+/*
+ * Test the object files of the amd64 backend against GNU as.
+ *
+ * A small program with loops, a jump table, calls, global data with
+ * relocations and floating point constants is compiled once to assembler and
+ * once to an object file, with and without PIC. The assembler output is
+ * assembled with as and both objects are disassembled with objdump; the
+ * listings of code, relocations and data must be the same. Each compilation
+ * runs in its own process, as libfirm is initialized only once. The test is
+ * skipped if as or objdump cannot be run.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "firm.h"
+
+#define N_CASES 6
+
+static ir_type *int_type;
+static ir_type *ptr_type;
+
+static ir_graph *begin_function(char const *const name, ir_type *const type,
+                                int const n_locals)
+{
+	ir_entity *const entity = new_entity(get_glob_type(), new_id_from_str(name),
+	                                     type);
+	ir_graph  *const irg    = new_ir_graph(entity, n_locals);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void end_function(ir_graph *const irg, ir_node *const res)
+{
+	ir_node *const ret = new_Return(get_store(), 1, (ir_node**)&res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static ir_node *param(unsigned const n, ir_mode *const mode)
+{
+	return new_Proj(get_irg_args(current_ir_graph), mode, n);
+}
+
+static ir_type *method_type(ir_type *const res, size_t const n_params,
+                            ir_type *const param_type)
+{
+	ir_type *const type = new_type_method(n_params, 1);
+	for (size_t i = 0; i < n_params; ++i)
+		set_method_param_type(type, i, param_type);
+	set_method_res_type(type, 0, res);
+	return type;
+}
+
+/** int sum(int *p, int n): a counting loop over an array */
+static void build_sum(void)
+{
+	ir_type  *const type = new_type_method(2, 1);
+	set_method_param_type(type, 0, ptr_type);
+	set_method_param_type(type, 1, int_type);
+	set_method_res_type(type, 0, int_type);
+	ir_graph *const irg = begin_function("sum", type, 2);
+
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const cmp  = new_Cmp(get_value(1, mode_Is), param(1, mode_Is),
+	                              ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+
+	ir_node *const index = new_Conv(get_value(1, mode_Is), mode_Ls);
+	ir_node *const offs  = new_Mul(index, new_Const_long(mode_Ls, 4), mode_Ls);
+	ir_node *const addr  = new_Add(param(0, mode_P), offs, mode_P);
+	ir_node *const load  = new_Load(get_store(), addr, mode_Is, int_type,
+	                                cons_none);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	ir_node *const value = new_Proj(load, mode_Is, pn_Load_res);
+	set_value(0, new_Add(get_value(0, mode_Is), value, mode_Is));
+	set_value(1, new_Add(get_value(1, mode_Is), new_Const_long(mode_Is, 1),
+	                     mode_Is));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	end_function(irg, get_value(0, mode_Is));
+}
+
+/** int select(unsigned x): a dense switch, which becomes a jump table */
+static void build_select(ir_entity *const callee)
+{
+	ir_type  *const utype = new_type_primitive(mode_Iu);
+	ir_graph *const irg   = begin_function("select",
+	                                       method_type(int_type, 1, utype), 0);
+
+	ir_switch_table *const table = ir_new_switch_table(irg, N_CASES);
+	for (unsigned i = 0; i < N_CASES; ++i) {
+		ir_tarval *const value = new_tarval_from_long(i, mode_Iu);
+		ir_switch_table_set(table, i, value, value, i + 1);
+	}
+	ir_node *const switchn = new_Switch(param(0, mode_Iu), N_CASES + 1, table);
+	ir_node *const join    = new_immBlock();
+	ir_node       *results[N_CASES + 1];
+	for (unsigned pn = 0; pn <= N_CASES; ++pn) {
+		ir_node *const block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(switchn, mode_X, pn));
+		mature_immBlock(block);
+		set_cur_block(block);
+		if (pn % 2 == 1) {
+			/* calls in the cases keep the optimizer from building a table of
+			 * constants instead */
+			ir_node *const in[] = { new_Const_long(mode_Is, pn) };
+			ir_type *const type = get_entity_type(callee);
+			ir_node *const call = new_Call(get_store(), new_Address(callee), 1,
+			                               in, type);
+			set_store(new_Proj(call, mode_M, pn_Call_M));
+			ir_node *const res  = new_Proj(call, mode_T, pn_Call_T_result);
+			results[pn] = new_Proj(res, mode_Is, 0);
+		} else {
+			results[pn] = new_Const_long(mode_Is, pn * 3 + 1);
+		}
+		add_immBlock_pred(join, new_Jmp());
+	}
+	mature_immBlock(join);
+	set_cur_block(join);
+	end_function(irg, new_Phi(N_CASES + 1, results, mode_Is));
+}
+
+/** int bump(int x): calls an external function and updates a global */
+static void build_bump(ir_entity *const callee, ir_entity *const counter)
+{
+	ir_graph *const irg = begin_function("bump",
+	                                     method_type(int_type, 1, int_type), 0);
+
+	ir_node *const in[] = { param(0, mode_Is) };
+	ir_type *const type = get_entity_type(callee);
+	ir_node *const call = new_Call(get_store(), new_Address(callee), 1, in,
+	                               type);
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node *const res  = new_Proj(new_Proj(call, mode_T, pn_Call_T_result),
+	                               mode_Is, 0);
+
+	ir_node *const addr  = new_Address(counter);
+	ir_node *const load  = new_Load(get_store(), addr, mode_Is, int_type,
+	                                cons_none);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	ir_node *const value = new_Add(new_Proj(load, mode_Is, pn_Load_res), res,
+	                               mode_Is);
+	ir_node *const store = new_Store(get_store(), addr, value, int_type,
+	                                 cons_none);
+	set_store(new_Proj(store, mode_M, pn_Store_M));
+	end_function(irg, value);
+}
+
+/** double scale(double x, double y): needs floating point constants */
+static void build_scale(void)
+{
+	ir_type  *const dtype = new_type_primitive(mode_D);
+	ir_graph *const irg   = begin_function("scale",
+	                                       method_type(dtype, 2, dtype), 0);
+
+	ir_node *const x   = param(0, mode_D);
+	ir_node *const y   = param(1, mode_D);
+	ir_node *const mul = new_Mul(x, new_Const(new_tarval_from_double(2.5, mode_D)),
+	                             mode_D);
+	ir_node *const div = new_Div(get_store(), mul, y, mode_D, op_pin_state_floats);
+	set_store(new_Proj(div, mode_M, pn_Div_M));
+	ir_node *const quo = new_Proj(div, mode_D, pn_Div_res);
+	ir_node *const sub = new_Sub(quo,
+	                             new_Const(new_tarval_from_double(0.75, mode_D)),
+	                             mode_D);
+	end_function(irg, sub);
+}
+
+static void build_program(void)
+{
+	int_type = new_type_primitive(mode_Is);
+	ptr_type = new_type_pointer(int_type);
+
+	ir_entity *const callee = new_entity(get_glob_type(), new_id_from_str("g"),
+	                                     method_type(int_type, 1, int_type));
+	set_entity_visibility(callee, ir_visibility_external);
+
+	ir_entity *const counter = new_entity(get_glob_type(),
+	                                      new_id_from_str("counter"), int_type);
+	set_entity_initializer(counter, create_initializer_tarval(
+		new_tarval_from_long(42, mode_Is)));
+
+	ir_type   *const array_type = new_type_array(int_type);
+	set_array_size_int(array_type, 3);
+	set_type_size_bytes(array_type, 3 * 4);
+	set_type_alignment_bytes(array_type, 4);
+	set_type_state(array_type, layout_fixed);
+	ir_entity *const table      = new_entity(get_glob_type(),
+	                                         new_id_from_str("table"),
+	                                         array_type);
+	ir_initializer_t *const init = create_initializer_compound(3);
+	for (size_t i = 0; i < 3; ++i) {
+		ir_tarval *const value = new_tarval_from_long(i * 100 - 1, mode_Is);
+		set_initializer_compound_value(init, i,
+		                               create_initializer_tarval(value));
+	}
+	set_entity_initializer(table, init);
+	set_entity_linkage(table, IR_LINKAGE_CONSTANT);
+
+	/* a pointer to the counter needs a data relocation */
+	ir_entity *const ptr = new_entity(get_glob_type(), new_id_from_str("ptr"),
+	                                  ptr_type);
+	ir_node   *const addr = new_r_Address(get_const_code_irg(), counter);
+	set_entity_initializer(ptr, create_initializer_const(addr));
+
+	build_sum();
+	build_select(callee);
+	build_bump(callee, counter);
+	build_scale();
+}
+
+static void compile(char const *const file, bool const pic, bool const object)
+{
+	pid_t const pid = fork();
+	assert(pid >= 0);
+	if (pid != 0) {
+		int status;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr, "compiling %s failed\n", file);
+			abort();
+		}
+		return;
+	}
+
+	ir_init();
+	int res = be_parse_arg("isa=amd64");
+	res    &= be_parse_arg(pic ? "pic=1" : "pic=0");
+	res    &= be_parse_arg(object ? "objfile=1" : "objfile=0");
+	assert(res);
+	(void)res;
+	/* sets up the pointer mode of the target */
+	be_get_backend_param();
+
+	build_program();
+	FILE *const out = fopen(file, "wb");
+	assert(out != NULL);
+	be_main(out, "amd64_objfile.c");
+	fclose(out);
+	ir_finish();
+	exit(0);
+}
+
+static char *read_file(char const *const file)
+{
+	FILE *const in = fopen(file, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long const size = ftell(in);
+	rewind(in);
+	char *const text = (char*)malloc(size + 1);
+	size_t const n_read = fread(text, 1, size, in);
+	assert(n_read == (size_t)size);
+	(void)n_read;
+	text[size] = '\0';
+	fclose(in);
+	return text;
+}
+
+/** Disassembles @p object, without the line naming the file. */
+static char *disassemble(char const *const dir, char const *const object)
+{
+	char command[1024];
+	snprintf(command, sizeof(command),
+	         "cd %s && objdump -d -r -s -j .text -j .data -j .rodata %s"
+	         " | grep -v 'file format' > %s.dis", dir, object, object);
+	int const res = system(command);
+	assert(res == 0);
+	(void)res;
+	snprintf(command, sizeof(command), "%s/%s.dis", dir, object);
+	return read_file(command);
+}
+
+static void check(char const *const dir, bool const pic)
+{
+	char asm_file[256];
+	char obj_file[256];
+	snprintf(asm_file, sizeof(asm_file), "%s/%s.s", dir, pic ? "pic" : "nopic");
+	snprintf(obj_file, sizeof(obj_file), "%s/%s.o", dir, pic ? "pic" : "nopic");
+	compile(asm_file, pic, false);
+	compile(obj_file, pic, true);
+
+	char command[1024];
+	snprintf(command, sizeof(command), "as --64 -o %s/%s_as.o %s", dir,
+	         pic ? "pic" : "nopic", asm_file);
+	int const res = system(command);
+	assert(res == 0);
+	(void)res;
+
+	char *const expected = disassemble(dir, pic ? "pic_as.o" : "nopic_as.o");
+	char *const actual   = disassemble(dir, pic ? "pic.o" : "nopic.o");
+	if (strcmp(expected, actual) != 0) {
+		fprintf(stderr, "objdump output differs, see %s\n", dir);
+		abort();
+	}
+	free(actual);
+	free(expected);
+}
+
+int main(void)
+{
+	if (system("as --version > /dev/null 2>&1") != 0
+	 || system("objdump --version > /dev/null 2>&1") != 0) {
+		fprintf(stderr, "as or objdump not found, skipping\n");
+		return 0;
+	}
+
+	char dir[] = "/tmp/amd64_objfile.XXXXXX";
+	if (mkdtemp(dir) == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	check(dir, false);
+	check(dir, true);
+
+	char command[256];
+	snprintf(command, sizeof(command), "rm -rf %s", dir);
+	return system(command) != 0;
+}
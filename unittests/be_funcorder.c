@@ -0,0 +1,293 @@
+/*
+ * Test the function order and the split of cold blocks.
+ *
+ * A program calls one function in a loop, one once and one in a branch in
+ * front of the loop which is never taken. It is compiled with profile
+ * instrumentation for amd64, linked with libfirmprof and run, and then
+ * compiled again with the profile, the function order and the split of cold
+ * blocks. The functions
+ * must be emitted in the order of Pettis and Hansen, and the never taken
+ * branch of main must be in .text.unlikely, while the rest of main is not.
+ * The program must still work when it takes the branch. Without a profile
+ * the order must follow the estimated frequencies. Each compilation runs in
+ * its own process, as libfirm is initialized only once. The test is skipped
+ * if no C compiler for the host is found or the host is not amd64.
+ */
+#define _XOPEN_SOURCE 700
+#include "firm.h"
+#include "testutil.h"
+
+#define N_LOOP 100
+
+/**
+ * The functions in the order of the program, and in the order of the
+ * compilations with and without the profile: main and hot are called most
+ * often, so they are merged first, then warm is put next to main. rare is
+ * never called with the profile, but comes next to warm without it.
+ */
+static char const *const functions[]       = { "rare", "warm", "hot", "main" };
+static char const *const profiled_order[]  = { "warm", "main", "hot", "rare" };
+static char const *const estimated_order[] = { "rare", "warm", "main", "hot" };
+
+#define N_FUNCTIONS (sizeof(functions) / sizeof(functions[0]))
+
+/** int name(int x) { return x * factor + 1; } */
+static ir_entity *build_callee(ir_type *const type, char const *const name,
+                               long const factor)
+{
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+	ir_node *const param = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const mul   = new_Mul(param, new_Const_long(mode_Is, factor),
+	                               mode_Is);
+	ir_node *res = new_Add(mul, new_Const_long(mode_Is, 1), mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return entity;
+}
+
+static ir_node *build_call(ir_type *const type, ir_entity *const callee,
+                           ir_node *const arg)
+{
+	ir_node *const in[] = { arg };
+	ir_node *const call = new_Call(get_store(), new_Address(callee), 1, in,
+	                               type);
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node *const results = new_Proj(call, mode_T, pn_Call_T_result);
+	return new_Proj(results, mode_Is, 0);
+}
+
+/**
+ * int main(int argc)
+ * {
+ *     int s = 0;
+ *     if (argc > 5)
+ *         s = rare(s);
+ *     for (int i = 0; i < N_LOOP; ++i)
+ *         s += hot(i);
+ *     return warm(s) & 0;
+ * }
+ * The block scheduler puts the call of rare between the loop and its exit,
+ * unless it is moved to the cold blocks.
+ */
+static void build_main(ir_type *const type, ir_entity *const *const callees)
+{
+	ir_type   *const main_type = new_type_method(1, 1);
+	set_method_param_type(main_type, 0, get_method_param_type(type, 0));
+	set_method_res_type(main_type, 0, get_method_res_type(type, 0));
+	ir_entity *const entity    = new_entity(get_glob_type(),
+	                                        new_id_from_str("main"),
+	                                        main_type);
+	ir_graph  *const irg       = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+
+	ir_node *const argc = new_Proj(get_irg_args(irg), mode_Is, 0);
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const many  = new_Cmp(argc, new_Const_long(mode_Is, 5),
+	                               ir_relation_greater);
+	ir_node *const cond5 = new_Cond(many);
+	ir_node *const join  = new_immBlock();
+
+	ir_node *const then = new_immBlock();
+	add_immBlock_pred(then, new_Proj(cond5, mode_X, pn_Cond_true));
+	mature_immBlock(then);
+	set_cur_block(then);
+	set_value(0, build_call(type, callees[0], get_value(0, mode_Is)));
+	add_immBlock_pred(join, new_Jmp());
+	add_immBlock_pred(join, new_Proj(cond5, mode_X, pn_Cond_false));
+	mature_immBlock(join);
+	set_cur_block(join);
+
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const cmp  = new_Cmp(get_value(1, mode_Is),
+	                              new_Const_long(mode_Is, N_LOOP),
+	                              ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const i = get_value(1, mode_Is);
+	set_value(0, new_Add(get_value(0, mode_Is),
+	                     build_call(type, callees[2], i), mode_Is));
+	set_value(1, new_Add(i, new_Const_long(mode_Is, 1), mode_Is));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *const warm = build_call(type, callees[1], get_value(0, mode_Is));
+	ir_node *res = new_And(warm, new_Const_long(mode_Is, 0), mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static void build_program(void)
+{
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const type     = new_type_method(1, 1);
+	set_method_param_type(type, 0, int_type);
+	set_method_res_type(type, 0, int_type);
+
+	ir_entity *callees[N_FUNCTIONS - 1];
+	for (size_t f = 0; f + 1 < N_FUNCTIONS; ++f)
+		callees[f] = build_callee(type, functions[f], 2 * f + 3);
+	build_main(type, callees);
+}
+
+/** The steps of the test, each compiles the program once. */
+enum {
+	INSTRUMENT,
+	USE_PROFILE,
+	ESTIMATE,
+};
+
+static int compile(int const step)
+{
+	static char const *const options[][2] = {
+		[INSTRUMENT]  = { "profilegenerate=1", NULL },
+		[USE_PROFILE] = { "profileuse=1",      "splitcold=1" },
+		[ESTIMATE]    = { "splitcold=1",       NULL },
+	};
+	static char const *const outputs[] = {
+		[INSTRUMENT]  = "prog.s",
+		[USE_PROFILE] = "profiled.s",
+		[ESTIMATE]    = "estimated.s",
+	};
+
+	ir_init();
+	int res = be_parse_arg("isa=amd64");
+	res    &= be_parse_arg(step == INSTRUMENT ? "orderfuncs=0"
+	                                          : "orderfuncs=1");
+	for (size_t o = 0; o < 2; ++o) {
+		if (options[step][o] != NULL)
+			res &= be_parse_arg(options[step][o]);
+	}
+	assert(res);
+	(void)res;
+
+	build_program();
+	FILE *const out = fopen(outputs[step], "w");
+	assert(out != NULL);
+	be_main(out, "prog");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+static char *read_file(char const *const name)
+{
+	FILE *const in = fopen(name, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long const size = ftell(in);
+	rewind(in);
+	char *const text = (char*)malloc(size + 1);
+	size_t const n_read = fread(text, 1, size, in);
+	assert(n_read == (size_t)size);
+	(void)n_read;
+	text[size] = '\0';
+	fclose(in);
+	return text;
+}
+
+/** Returns the position of the label of @p function in @p text. */
+static char const *find_label(char const *const text,
+                              char const *const function)
+{
+	char label[32];
+	snprintf(label, sizeof(label), "\n%s:", function);
+	return strstr(text, label);
+}
+
+static bool check_order(char const *const file,
+                        char const *const *const order)
+{
+	char *const text = read_file(file);
+	bool        ok   = true;
+	char const *prev = text;
+	for (size_t f = 0; f < N_FUNCTIONS; ++f) {
+		char const *const label = find_label(text, order[f]);
+		if (label == NULL || label < prev) {
+			fprintf(stderr, "%s: %s is not at position %zu\n", file,
+			        order[f], f);
+			ok = false;
+		}
+		if (label != NULL)
+			prev = label;
+	}
+	free(text);
+	return ok;
+}
+
+/**
+ * Checks that the call of rare is the only code of main in .text.unlikely,
+ * which comes after the hot code of main, including the exit of the loop.
+ */
+static bool check_split(char const *const file)
+{
+	char *const text = read_file(file);
+	bool        ok   = true;
+	char const *const main_label = find_label(text, "main");
+	char const *const hot_label  = find_label(text, "hot");
+	char const *const unlikely   = strstr(text, ".text.unlikely");
+	assert(main_label != NULL && hot_label != NULL);
+	if (unlikely == NULL || unlikely < main_label || unlikely > hot_label) {
+		fprintf(stderr, "%s: no cold part of main\n", file);
+		ok = false;
+	} else {
+		char const *const call_hot  = strstr(main_label, "call hot");
+		char const *const call_warm = strstr(main_label, "call warm");
+		char const *const call_rare = strstr(main_label, "call rare");
+		if (call_hot == NULL || call_hot > unlikely
+		    || call_warm == NULL || call_warm > unlikely
+		    || call_rare == NULL || call_rare < unlikely
+		    || call_rare > hot_label) {
+			fprintf(stderr, "%s: wrong calls in the cold part of main\n",
+			        file);
+			ok = false;
+		}
+		if (strstr(unlikely + 1, ".text.unlikely") != NULL) {
+			fprintf(stderr, "%s: more than one cold part\n", file);
+			ok = false;
+		}
+	}
+	free(text);
+	return ok;
+}
+
+int main(void)
+{
+	if (!test_have_amd64_host())
+		return 0;
+
+	test_enter_dir("be_funcorder");
+	test_fork(compile, INSTRUMENT);
+	test_link_profiled("prog");
+	test_shell("./prog");
+	test_fork(compile, USE_PROFILE);
+	test_fork(compile, ESTIMATE);
+	/* the program jumps to the cold code and back */
+	test_shell("cc -no-pie -Wl,-z,noexecstack -o profiled profiled.s");
+	test_shell("./profiled && ./profiled 1 2 3 4 5 6");
+
+	bool ok = check_order("profiled.s", profiled_order);
+	ok     &= check_split("profiled.s");
+	ok     &= check_order("estimated.s", estimated_order);
+	if (test_leave_dir("prog prog.s prog.prof profiled profiled.s "
+	                   "estimated.s") != 0)
+		return 1;
+	return !ok;
+}
@@ -0,0 +1,42 @@
+/*
+ * Test that be_parse_arg() refuses to write object files with a backend
+ * which only produces assembler, in whichever order the options come.
+ */
+#include <assert.h>
+
+#include "be_t.h"
+#include "firm.h"
+
+int main(void)
+{
+	ir_init();
+
+	int res = be_parse_arg("isa=ia32");
+	assert(res == 1);
+	res = be_parse_arg("objfile");
+	assert(res == 0);
+	assert(!be_options.emit_object);
+
+	res = be_parse_arg("isa=amd64");
+	assert(res == 1);
+	arch_isa_if_t const *const amd64_isa_if = isa_if;
+	res = be_parse_arg("objfile");
+	assert(res == 1);
+	assert(be_options.emit_object);
+
+	/* switching to a backend without an object writer keeps amd64 */
+	res = be_parse_arg("isa=sparc");
+	assert(res == 0);
+	assert(be_options.emit_object);
+	assert(isa_if == amd64_isa_if);
+
+	res = be_parse_arg("objfile=0");
+	assert(res == 1);
+	res = be_parse_arg("isa=sparc");
+	assert(res == 1);
+	assert(isa_if != amd64_isa_if);
+	(void)res;
+
+	ir_finish();
+	return 0;
+}
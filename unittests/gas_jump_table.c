@@ -0,0 +1,122 @@
+/*
+ * Test that the code after a jump table stays in the section of the
+ * function, which is the cold one after be_gas_begin_cold_part().
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "beemitter.h"
+#include "begnuas.h"
+#include "beinfo.h"
+#include "firm.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "obst.h"
+
+#define N_OUTS 3
+
+static void init_backend_info(ir_node *node, void *env)
+{
+	struct obstack *obst = (struct obstack*)env;
+	if (is_Proj(node))
+		return;
+	node->backend_info = OALLOCZ(obst, backend_info_t);
+	be_info_init_irn(node, arch_irn_flags_none, NULL,
+	                 is_Switch(node) ? N_OUTS : 1);
+}
+
+static void emit_target(ir_entity const *table, ir_node const *proj_x)
+{
+	(void)table;
+	be_emit_irprintf("%u", get_Proj_num(proj_x));
+}
+
+static ir_node *build_switch(ir_entity *entity)
+{
+	ir_type  *type = get_entity_type(entity);
+	ir_graph *irg  = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_switch_table *table = ir_new_switch_table(irg, N_OUTS - 1);
+	for (unsigned pn = 1; pn < N_OUTS; ++pn) {
+		ir_tarval *value = new_tarval_from_long(pn - 1, mode_Iu);
+		ir_switch_table_set(table, pn - 1, value, value, pn);
+	}
+	ir_node *selector = new_Proj(get_irg_args(irg), mode_Iu, 0);
+	ir_node *switchn  = new_Switch(selector, N_OUTS, table);
+	for (unsigned pn = 0; pn < N_OUTS; ++pn) {
+		ir_node *block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(switchn, mode_X, pn));
+		mature_immBlock(block);
+		set_cur_block(block);
+		ir_node *res = new_Const_long(get_type_mode(get_method_res_type(type, 0)), pn);
+		ir_node *ret = new_Return(get_store(), 1, &res);
+		add_immBlock_pred(get_irg_end_block(irg), ret);
+	}
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	assure_edges(irg);
+	return switchn;
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the Switch as built */
+	set_optimize(0);
+
+	ir_type *int_type    = new_type_primitive(mode_Iu);
+	ir_type *method_type = new_type_method(1, 1);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_res_type(method_type, 0, int_type);
+	ir_entity *entity = new_entity(get_glob_type(), new_id_from_str("f"),
+	                               method_type);
+	ir_entity *table  = new_entity(get_glob_type(), new_id_from_str("f.table"),
+	                               int_type);
+	ir_node   *switchn = build_switch(entity);
+
+	struct obstack obst;
+	obstack_init(&obst);
+	irg_walk_graph(get_irn_irg(switchn), NULL, init_backend_info, &obst);
+
+	FILE *out = tmpfile();
+	assert(out != NULL);
+	be_emit_init(out);
+	assert(be_gas_can_split_function(entity));
+	be_gas_emit_function_prolog(entity, 4, NULL);
+	be_gas_begin_cold_part(entity);
+	be_emit_jump_table(switchn, get_Switch_table(switchn), table, mode_Iu,
+	                   emit_target);
+	be_emit_cstring("\tret\n");
+	be_emit_write_line();
+	be_gas_emit_function_epilog(entity);
+	be_emit_exit();
+
+	long const size = ftell(out);
+	char *const text = (char*)malloc(size + 1);
+	rewind(out);
+	size_t const n_read = fread(text, 1, size, out);
+	assert(n_read == (size_t)size);
+	(void)n_read;
+	text[size] = '\0';
+	fclose(out);
+
+	/* the table goes to .rodata, the rest of the cold part follows it in
+	 * .text.unlikely and the size of f.cold covers only that section */
+	char const *const cold   = strstr(text, ".text.unlikely");
+	char const *const rodata = strstr(text, ".rodata");
+	char const *const ret    = strstr(text, "\tret\n");
+	char const *const size_f = strstr(text, "\t.size\tf.cold, .-f.cold\n");
+	assert(cold != NULL && rodata != NULL && ret != NULL && size_f != NULL);
+	assert(cold < rodata && rodata < ret && ret < size_f);
+	char const *const back = strstr(rodata, ".text.unlikely");
+	assert(back != NULL && back < ret);
+	assert(strstr(rodata, "\t.text\n") == NULL);
+
+	free(text);
+	obstack_free(&obst, NULL);
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * Test that idents interned concurrently by several threads keep pointer
+ * equality and that id_unique() never hands out a name twice.
+ */
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "firm.h"
+
+#define N_THREADS 4
+#define N_NAMES   20000
+#define N_UNIQUE  5000
+
+typedef struct thread_data_t {
+	unsigned  nr;
+	ident    *names[N_NAMES];
+	ident    *unique[N_UNIQUE];
+} thread_data_t;
+
+static void *intern_names(void *data)
+{
+	thread_data_t *const thread = (thread_data_t*)data;
+	for (unsigned i = 0; i < N_NAMES; ++i) {
+		/* every thread starts at a different name, so inserts collide */
+		unsigned const n = (i + thread->nr * N_NAMES / N_THREADS) % N_NAMES;
+		char buf[32];
+		snprintf(buf, sizeof(buf), "name%u", n);
+		thread->names[n] = new_id_from_str(buf);
+		if (i < N_UNIQUE)
+			thread->unique[i] = id_unique("unique.%u");
+	}
+	return NULL;
+}
+
+static int cmp_ptr(const void *a, const void *b)
+{
+	const ident *const id0 = *(const ident *const*)a;
+	const ident *const id1 = *(const ident *const*)b;
+	return id0 < id1 ? -1 : id0 > id1;
+}
+
+int main(void)
+{
+	ir_init();
+
+	static thread_data_t threads[N_THREADS];
+	pthread_t            ids[N_THREADS];
+	for (unsigned t = 0; t < N_THREADS; ++t) {
+		threads[t].nr = t;
+		int const res = pthread_create(&ids[t], NULL, intern_names, &threads[t]);
+		assert(res == 0);
+		(void)res;
+	}
+	for (unsigned t = 0; t < N_THREADS; ++t)
+		pthread_join(ids[t], NULL);
+
+	for (unsigned n = 0; n < N_NAMES; ++n) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "name%u", n);
+		ident *const id = new_id_from_str(buf);
+		assert(strcmp(get_id_str(id), buf) == 0);
+		for (unsigned t = 0; t < N_THREADS; ++t)
+			assert(threads[t].names[n] == id);
+	}
+
+	ident **const unique = (ident**)malloc(N_THREADS * N_UNIQUE * sizeof(*unique));
+	for (unsigned t = 0; t < N_THREADS; ++t)
+		memcpy(&unique[t * N_UNIQUE], threads[t].unique, sizeof(threads[t].unique));
+	qsort(unique, N_THREADS * N_UNIQUE, sizeof(*unique), cmp_ptr);
+	for (unsigned i = 1; i < N_THREADS * N_UNIQUE; ++i)
+		assert(unique[i - 1] != unique[i]);
+	free(unique);
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * Test be_ifg_interferes() against the neighbours of the interference graph.
+ * A function with many values live across a loop, calls and multiplications
+ * is compiled with a copy minimizer which asks the interference graph about
+ * every pair of its nodes. This is done for both flavors of the graph, and for
+ * a small graph (bit matrix) and a large one (adjacency arrays). The implicit
+ * graph must have the same neighbours as a materialized one, which must list
+ * each of them once. Each compilation runs in its own process, as libfirm is
+ * initialized only once.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "becopyopt_t.h"
+#include "beifg.h"
+#include "bitset.h"
+#include "firm.h"
+#include "irnode_t.h"
+#include "xmalloc.h"
+
+static bool     explicit_ifg;
+static unsigned max_nodes;
+
+/** Collects the neighbours of @p node, each must be listed once. */
+static void collect_neighbours(be_ifg_t const *const ifg, ir_node *const node,
+                               bitset_t *const neighbours)
+{
+	bitset_clear_all(neighbours);
+	unsigned          n_neighbours = 0;
+	neighbours_iter_t iter;
+	be_ifg_foreach_neighbour(ifg, &iter, node, neighbour) {
+		assert(!bitset_is_set(neighbours, get_irn_idx(neighbour)));
+		bitset_set(neighbours, get_irn_idx(neighbour));
+		++n_neighbours;
+	}
+	assert(be_ifg_degree(ifg, node) == (int)n_neighbours);
+	(void)n_neighbours;
+}
+
+static int check_interferes(copy_opt_t *const co)
+{
+	be_ifg_t const *const ifg   = co->cenv->ifg;
+	ir_node       **nodes       = NEW_ARR_F(ir_node*, 0);
+	be_ifg_foreach_node(ifg, node) {
+		ARR_APP1(ir_node*, nodes, node);
+	}
+
+	/* compare the implicit graph with a materialized one */
+	be_ifg_t *const other = explicit_ifg ? NULL
+	                                     : be_create_ifg(co->cenv, true);
+
+	size_t    const n_nodes    = ARR_LEN(nodes);
+	unsigned  const n_idx      = get_irg_last_idx(co->irg);
+	bitset_t *const neighbours = bitset_malloc(n_idx);
+	bitset_t *const expected   = bitset_malloc(n_idx);
+	for (size_t i = 0; i < n_nodes; ++i) {
+		ir_node *const a = nodes[i];
+		collect_neighbours(ifg, a, neighbours);
+		if (other != NULL) {
+			collect_neighbours(other, a, expected);
+			bitset_xor(expected, neighbours);
+			assert(bitset_is_empty(expected));
+		}
+		for (size_t j = 0; j < n_nodes; ++j) {
+			ir_node *const b         = nodes[j];
+			bool     const interfere = bitset_is_set(neighbours,
+			                                         get_irn_idx(b));
+			assert(be_ifg_interferes(ifg, a, b) == interfere);
+			(void)interfere;
+		}
+	}
+	free(expected);
+	free(neighbours);
+	DEL_ARR_F(nodes);
+	if (other != NULL)
+		be_ifg_free(other);
+
+	if (n_nodes > max_nodes)
+		max_nodes = n_nodes;
+	return 0;
+}
+
+static void build_function(unsigned const n_vars, unsigned const n_diamonds)
+{
+	ir_type *int_type    = new_type_primitive(mode_Is);
+	ir_type *method_type = new_type_method(2, 1);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_param_type(method_type, 1, int_type);
+	set_method_res_type(method_type, 0, int_type);
+	ir_entity *callee = new_entity(get_glob_type(), new_id_from_str("g"),
+	                               method_type);
+	set_entity_visibility(callee, ir_visibility_external);
+	ir_entity *entity = new_entity(get_glob_type(), new_id_from_str("f"),
+	                               method_type);
+	ir_graph  *irg    = new_ir_graph(entity, n_vars);
+	set_current_ir_graph(irg);
+
+	ir_node *args = get_irg_args(irg);
+	for (unsigned v = 0; v < n_vars; ++v) {
+		ir_node *param = new_Proj(args, mode_Is, v & 1);
+		set_value(v, new_Add(param, new_Const_long(mode_Is, v), mode_Is));
+	}
+
+	ir_node *header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	for (unsigned d = 0; d < n_diamonds; ++d) {
+		ir_node *cmp  = new_Cmp(get_value(d % n_vars, mode_Is),
+		                        new_Const_long(mode_Is, d), ir_relation_less);
+		ir_node *cond = new_Cond(cmp);
+		ir_node *then = new_immBlock();
+		add_immBlock_pred(then, new_Proj(cond, mode_X, pn_Cond_true));
+		mature_immBlock(then);
+		ir_node *join = new_immBlock();
+		add_immBlock_pred(join, new_Proj(cond, mode_X, pn_Cond_false));
+
+		set_cur_block(then);
+		unsigned const v   = d * 7 % n_vars;
+		unsigned const w   = (d * 13 + 5) % n_vars;
+		ir_node *const a   = get_value(v, mode_Is);
+		ir_node *const b   = get_value(w, mode_Is);
+		ir_node       *res;
+		switch (d % 3) {
+		case 0:
+			res = new_Mul(a, b, mode_Is);
+			break;
+		case 1: {
+			ir_node *in[]   = { a, b };
+			ir_node *call   = new_Call(get_store(), new_Address(callee), 2, in,
+			                           method_type);
+			ir_node *result = new_Proj(call, mode_T, pn_Call_T_result);
+			set_store(new_Proj(call, mode_M, pn_Call_M));
+			res = new_Proj(result, mode_Is, 0);
+			break;
+		}
+		default:
+			res = new_Eor(a, b, mode_Is);
+			break;
+		}
+		set_value(v, res);
+		set_value(w, new_Sub(b, res, mode_Is));
+		add_immBlock_pred(join, new_Jmp());
+		mature_immBlock(join);
+		set_cur_block(join);
+	}
+
+	/* loop back while the first variable is positive */
+	ir_node *cmp  = new_Cmp(get_value(0, mode_Is), new_Const_long(mode_Is, 0),
+	                        ir_relation_greater);
+	ir_node *cond = new_Cond(cmp);
+	add_immBlock_pred(header, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(header);
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+
+	ir_node *sum = get_value(0, mode_Is);
+	for (unsigned v = 1; v < n_vars; ++v)
+		sum = new_Add(sum, get_value(v, mode_Is), mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &sum);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static void compile(char const *const isa, bool const explicit,
+                    unsigned const n_vars, unsigned const n_diamonds,
+                    unsigned const min_nodes)
+{
+	pid_t const pid = fork();
+	assert(pid >= 0);
+	if (pid != 0) {
+		int status;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr, "%s %s failed\n", isa,
+			        explicit ? "explicit" : "implicit");
+			abort();
+		}
+		return;
+	}
+
+	ir_init();
+	static co_algo_info check_info = { check_interferes };
+	be_register_copyopt("check", &check_info);
+	explicit_ifg = explicit;
+	int res = be_parse_arg(isa);
+	res    &= be_parse_arg(explicit ? "ra-chordal-ifg=explicit"
+	                                : "ra-chordal-ifg=implicit");
+	res    &= be_parse_arg("ra-chordal-co-algo=check");
+	assert(res);
+	(void)res;
+
+	build_function(n_vars, n_diamonds);
+	FILE *out = tmpfile();
+	assert(out != NULL);
+	be_main(out, "ifg_interferes.c");
+	fclose(out);
+	/* make sure the graph was as large as intended */
+	assert(max_nodes >= min_nodes);
+	ir_finish();
+	exit(0);
+}
+
+int main(void)
+{
+	static char const *const isas[] = { "isa=amd64", "isa=ia32" };
+	for (unsigned i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+		for (unsigned e = 0; e < 2; ++e)
+			compile(isas[i], e, 12, 24, 0);
+	}
+	/* more nodes than fit into the bit matrix */
+	compile("isa=amd64", true, 64, 600, 4097);
+	return 0;
+}
@@ -0,0 +1,271 @@
+/*
+ * Test the profile driven inlining.
+ *
+ * A program calls a function in a loop and again in a branch which is never
+ * taken, and calls another function once. The calls have source positions.
+ * It is compiled with profile instrumentation for amd64, linked with
+ * libfirmprof and run. The call counts of the profile are then read for the
+ * program as built, before anything is optimized, and must be what each
+ * call did. The inliner must inline the executed calls but not the one which
+ * never ran, although it inlines the same callee in the loop, and it inlines
+ * all calls without the profile. Each compilation runs in its own process,
+ * as libfirm is initialized only once. The test is skipped if no C compiler
+ * for the host is found or the host is not amd64.
+ */
+#define _XOPEN_SOURCE 700
+#include "firm.h"
+#include "testutil.h"
+
+#define N_LOOP 100
+
+typedef struct program_t {
+	ir_entity *main;
+	ir_entity *hot;
+	ir_entity *once;
+	ir_node   *loop_call;
+	ir_node   *cold_call;
+	ir_node   *once_call;
+} program_t;
+
+/** The source positions of the calls, used as their debug info. */
+static src_loc_t const positions[] = {
+	{ "prog.c", 4, 14 },
+	{ "prog.c", 6, 13 },
+	{ "prog.c", 7, 12 },
+};
+
+static src_loc_t retrieve_position(dbg_info const *const dbg)
+{
+	if (dbg == NULL)
+		return (src_loc_t) { NULL, 0, 0 };
+	return *(src_loc_t const*)dbg;
+}
+
+/** int name(int x) { return x * factor + 1; } */
+static ir_entity *build_callee(ir_type *const type, char const *const name,
+                               long const factor)
+{
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+	ir_node *const param = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const mul   = new_Mul(param, new_Const_long(mode_Is, factor),
+	                               mode_Is);
+	ir_node *res = new_Add(mul, new_Const_long(mode_Is, 1), mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return entity;
+}
+
+static ir_node *build_call(ir_type *const type, ir_entity *const callee,
+                           ir_node *const arg, src_loc_t const *const pos,
+                           ir_node **const call_out)
+{
+	ir_node *const in[] = { arg };
+	ir_node *const call = new_d_Call((dbg_info*)pos, get_store(),
+	                                 new_Address(callee), 1, in, type);
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	*call_out = call;
+	ir_node *const results = new_Proj(call, mode_T, pn_Call_T_result);
+	return new_Proj(results, mode_Is, 0);
+}
+
+/**
+ * int main(int argc)
+ * {
+ *     int s = 0;
+ *     for (int i = 0; i < N_LOOP; ++i)
+ *         s += hot(i);
+ *     if (argc > 5)
+ *         s = hot(s);
+ *     return once(s) & 0;
+ * }
+ */
+static void build_main(ir_type *const type, program_t *const program)
+{
+	ir_type *const main_type = new_type_method(1, 1);
+	set_method_param_type(main_type, 0, get_method_param_type(type, 0));
+	set_method_res_type(main_type, 0, get_method_res_type(type, 0));
+	program->main = new_entity(get_glob_type(), new_id_from_str("main"),
+	                           main_type);
+	ir_graph *const irg = new_ir_graph(program->main, 2);
+	set_current_ir_graph(irg);
+
+	ir_node *const argc = new_Proj(get_irg_args(irg), mode_Is, 0);
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const cmp  = new_Cmp(get_value(1, mode_Is),
+	                              new_Const_long(mode_Is, N_LOOP),
+	                              ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const i = get_value(1, mode_Is);
+	set_value(0, new_Add(get_value(0, mode_Is),
+	                     build_call(type, program->hot, i, &positions[0],
+	                                &program->loop_call), mode_Is));
+	set_value(1, new_Add(i, new_Const_long(mode_Is, 1), mode_Is));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *const many  = new_Cmp(argc, new_Const_long(mode_Is, 5),
+	                               ir_relation_greater);
+	ir_node *const cond5 = new_Cond(many);
+	ir_node *const join  = new_immBlock();
+
+	ir_node *const then = new_immBlock();
+	add_immBlock_pred(then, new_Proj(cond5, mode_X, pn_Cond_true));
+	mature_immBlock(then);
+	set_cur_block(then);
+	set_value(0, build_call(type, program->hot, get_value(0, mode_Is),
+	                        &positions[1], &program->cold_call));
+	add_immBlock_pred(join, new_Jmp());
+	add_immBlock_pred(join, new_Proj(cond5, mode_X, pn_Cond_false));
+	mature_immBlock(join);
+	set_cur_block(join);
+
+	ir_node *const once = build_call(type, program->once,
+	                                 get_value(0, mode_Is), &positions[2],
+	                                 &program->once_call);
+	ir_node *res = new_And(once, new_Const_long(mode_Is, 0), mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static void build_program(program_t *const program)
+{
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const type     = new_type_method(1, 1);
+	set_method_param_type(type, 0, int_type);
+	set_method_res_type(type, 0, int_type);
+
+	/* keep the calls as built */
+	set_optimize(0);
+	program->hot  = build_callee(type, "hot", 3);
+	program->once = build_callee(type, "once", 7);
+	build_main(type, program);
+	set_optimize(1);
+}
+
+static int compile(int const unused)
+{
+	(void)unused;
+	ir_init();
+	ir_set_debug_retrieve(retrieve_position);
+	int res = be_parse_arg("isa=amd64");
+	res    &= be_parse_arg("profilegenerate=1");
+	assert(res);
+	(void)res;
+
+	program_t program;
+	build_program(&program);
+	FILE *const out = fopen("prog.s", "w");
+	assert(out != NULL);
+	be_main(out, "prog");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+static bool check_count(char const *const what, unsigned long long const count,
+                        unsigned long long const expected)
+{
+	if (count == expected)
+		return true;
+	fprintf(stderr, "%s: %llu instead of %llu\n", what, count, expected);
+	return false;
+}
+
+typedef struct calls_t {
+	unsigned  n;
+	ir_node  *last;
+} calls_t;
+
+static void find_calls(ir_node *const node, void *const data)
+{
+	if (!is_Call(node))
+		return;
+	calls_t *const calls = (calls_t*)data;
+	++calls->n;
+	calls->last = node;
+}
+
+/**
+ * Inlines into main, with the call counts of the profile if @p profiled,
+ * and checks which calls are left.
+ */
+static int check_inline(int const profiled)
+{
+	ir_init();
+	ir_set_debug_retrieve(retrieve_position);
+	program_t program;
+	build_program(&program);
+
+	bool ok = true;
+	if (profiled) {
+		if (!ir_profile_read_calls("prog.prof"))
+			return 1;
+		ok &= check_count("main entries",
+		                  ir_profile_get_entry_count(program.main), 1);
+		ok &= check_count("hot entries",
+		                  ir_profile_get_entry_count(program.hot), N_LOOP);
+		ok &= check_count("once entries",
+		                  ir_profile_get_entry_count(program.once), 1);
+		ok &= check_count("loop call",
+		                  ir_profile_get_call_count(program.main,
+		                                            program.loop_call),
+		                  N_LOOP);
+		ok &= check_count("cold call",
+		                  ir_profile_get_call_count(program.main,
+		                                            program.cold_call), 0);
+		ok &= check_count("once call",
+		                  ir_profile_get_call_count(program.main,
+		                                            program.once_call), 1);
+	}
+
+	inline_functions(750, 0, NULL);
+	/* only the cold call may be left */
+	calls_t calls = { 0, NULL };
+	irg_walk_graph(get_entity_irg(program.main), find_calls, NULL, &calls);
+	if (profiled) {
+		ok &= calls.n == 1 && calls.last == program.cold_call;
+	} else {
+		ok &= calls.n == 0;
+	}
+	if (!ok)
+		fprintf(stderr, "wrong calls left in main, profiled: %d\n", profiled);
+
+	ir_profile_free_calls();
+	ir_finish();
+	return !ok;
+}
+
+int main(void)
+{
+	if (!test_have_amd64_host())
+		return 0;
+
+	test_enter_dir("inline_profile");
+	test_fork(compile, false);
+	test_link_profiled("prog");
+	test_shell("./prog");
+	test_fork(check_inline, false);
+	test_fork(check_inline, true);
+
+	return test_leave_dir("prog prog.s prog.prof");
+}
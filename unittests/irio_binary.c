@@ -0,0 +1,341 @@
+/*
+ * Test the binary IR format against the textual one.
+ *
+ * A program with loops, a switch, calls, memory operations and initialized
+ * global data is written in both formats. Reading the text and writing it
+ * again must give the same text as reading the binary file and writing it as
+ * text, up to the numbers of types, entities and nodes: the binary reader
+ * constructs the constant graph before the graph bodies, so its numbers are
+ * shifted. The graphs of the binary file are also loaded one at a time, which
+ * must not construct the others, and must give the same text once all of them
+ * are loaded. Every step runs in its own process, so that each reader starts
+ * with an empty program.
+ */
+#define _XOPEN_SOURCE 700
+#include <ctype.h>
+
+#include "firm.h"
+#include "testutil.h"
+
+#define N_IRGS 3
+#define MAX_NR 1024
+
+static char const *const names[N_IRGS] = { "loop", "branch", "caller" };
+
+static ir_type *int_type;
+static ir_type *method_type;
+
+static ir_graph *new_function(char const *const name)
+{
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), method_type);
+	ir_graph  *const irg    = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void finish_function(ir_graph *const irg, ir_node *res)
+{
+	ir_node *const ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+/** Multiplies the global counter until it exceeds the parameter. */
+static void build_loop(ir_entity *const counter)
+{
+	ir_graph *const irg  = new_function(names[0]);
+	ir_node  *const addr = new_Address(counter);
+	ir_node  *const load = new_Load(get_store(), addr, mode_Is, int_type,
+	                                cons_volatile);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	set_value(0, new_Proj(load, mode_Is, pn_Load_res));
+
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const param = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const cmp   = new_Cmp(get_value(0, mode_Is), param,
+	                               ir_relation_less_equal);
+	ir_node *const cond  = new_Cond(cmp);
+	ir_node *const body  = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	set_value(0, new_Mul(get_value(0, mode_Is), new_Const_long(mode_Is, 3),
+	                     mode_Is));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *const store = new_Store(get_store(), addr, get_value(0, mode_Is),
+	                                 int_type, cons_none);
+	set_store(new_Proj(store, mode_M, pn_Store_M));
+	finish_function(irg, get_value(0, mode_Is));
+}
+
+/** Picks a value of the constant table with a switch. */
+static void build_branch(ir_entity *const table)
+{
+	ir_graph *const irg   = new_function(names[1]);
+	ir_node  *const param = new_Proj(get_irg_args(irg), mode_Is, 0);
+
+	ir_switch_table *const cases = ir_new_switch_table(irg, 2);
+	ir_switch_table_set(cases, 0, new_tarval_from_long(1, mode_Is),
+	                    new_tarval_from_long(3, mode_Is), 1);
+	ir_switch_table_set(cases, 1, new_tarval_from_long(-5, mode_Is),
+	                    new_tarval_from_long(-5, mode_Is), 2);
+	ir_node *const switchn = new_Switch(param, 3, cases);
+	ir_node *const join    = new_immBlock();
+	ir_node       *results[3];
+	for (unsigned pn = 0; pn < 3; ++pn) {
+		ir_node *const block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(switchn, mode_X, pn));
+		mature_immBlock(block);
+		set_cur_block(block);
+		ir_node *const index = new_Const_long(mode_Iu, pn);
+		ir_node *const addr  = new_Sel(new_Address(table), index,
+		                               get_entity_type(table));
+		ir_node *const load  = new_Load(get_store(), addr, mode_Is, int_type,
+		                                cons_floats);
+		set_store(new_Proj(load, mode_M, pn_Load_M));
+		results[pn] = new_Proj(load, mode_Is, pn_Load_res);
+		add_immBlock_pred(join, new_Jmp());
+	}
+	mature_immBlock(join);
+	set_cur_block(join);
+	finish_function(irg, new_Phi(3, results, mode_Is));
+}
+
+/** Calls the other functions and an external one. */
+static void build_caller(ir_entity *const external)
+{
+	ir_graph *const irg   = new_function(names[2]);
+	ir_node        *value = new_Proj(get_irg_args(irg), mode_Is, 0);
+	for (size_t i = 0; i < N_IRGS; ++i) {
+		ir_entity *const callee = i + 1 < N_IRGS
+			? get_irg_entity(get_irp_irg(i)) : external;
+		ir_node   *const call   = new_Call(get_store(), new_Address(callee), 1,
+		                                   &value, method_type);
+		set_store(new_Proj(call, mode_M, pn_Call_M));
+		ir_node   *const res    = new_Proj(call, mode_T, pn_Call_T_result);
+		value = new_Eor(value, new_Proj(res, mode_Is, 0), mode_Is);
+	}
+	finish_function(irg, value);
+}
+
+static void build_program(void)
+{
+	int_type    = new_type_primitive(mode_Is);
+	method_type = new_type_method(1, 1);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_res_type(method_type, 0, int_type);
+
+	ir_entity *const counter = new_entity(get_glob_type(),
+	                                      new_id_from_str("counter"), int_type);
+	set_entity_initializer(counter, create_initializer_tarval(
+		new_tarval_from_long(7, mode_Is)));
+
+	ir_type *const array_type = new_type_array(int_type);
+	set_array_size_int(array_type, 3);
+	set_type_size_bytes(array_type, 3 * get_type_size_bytes(int_type));
+	set_type_alignment_bytes(array_type, get_type_alignment_bytes(int_type));
+	set_type_state(array_type, layout_fixed);
+	ir_entity *const table = new_entity(get_glob_type(),
+	                                    new_id_from_str("table"), array_type);
+	ir_initializer_t *const init = create_initializer_compound(3);
+	for (size_t i = 0; i < 3; ++i) {
+		ir_tarval *const value = new_tarval_from_long(i * 11 - 4, mode_Is);
+		set_initializer_compound_value(init, i,
+		                               create_initializer_tarval(value));
+	}
+	set_entity_initializer(table, init);
+	set_entity_linkage(table, IR_LINKAGE_CONSTANT);
+
+	ir_entity *const external = new_entity(get_glob_type(),
+	                                       new_id_from_str("external"),
+	                                       method_type);
+	set_entity_visibility(external, ir_visibility_external);
+
+	build_loop(counter);
+	build_branch(table);
+	build_caller(external);
+}
+
+/** Writes the program as built in both formats. */
+static int write_program(void)
+{
+	build_program();
+	for (size_t i = 0; i < N_IRGS; ++i)
+		assert(irg_verify(get_irp_irg(i)));
+	if (ir_export("program.ir") != 0)
+		return 1;
+	return ir_export_binary("program.irb");
+}
+
+static int reread_text(void)
+{
+	if (ir_import("program.ir") != 0)
+		return 1;
+	return ir_export("text.ir");
+}
+
+static int reread_binary(void)
+{
+	if (ir_import_binary("program.irb") != 0)
+		return 1;
+	return ir_export("binary.ir");
+}
+
+/** Loads the graphs of the binary file one after the other. */
+static int load_lazily(void)
+{
+	ir_binary_file_t *const file = ir_binary_open("program.irb");
+	if (file == NULL)
+		return 1;
+	assert(ir_binary_get_n_irgs(file) == N_IRGS);
+	for (size_t i = 0; i < N_IRGS; ++i) {
+		/* the entities are there, only the graphs are missing */
+		ir_entity *const entity = ir_binary_get_irg_entity(file, i);
+		assert(strcmp(get_entity_name(entity), names[i]) == 0);
+		assert(get_entity_irg(entity) == NULL);
+		assert(get_irp_n_irgs() == i);
+
+		ir_graph *const irg = ir_binary_load_irg(file, i);
+		assert(get_entity_irg(entity) == irg);
+		assert(ir_binary_load_irg(file, i) == irg);
+		assert(get_irp_n_irgs() == i + 1);
+		assert(irg_verify(irg));
+		(void)irg;
+	}
+	if (ir_binary_close(file) != 0)
+		return 1;
+	return ir_export("lazy.ir");
+}
+
+/** Loads only the last graph, the others are dropped with the file. */
+static int load_one(void)
+{
+	ir_binary_file_t *const file = ir_binary_open("program.irb");
+	if (file == NULL)
+		return 1;
+	ir_graph *const irg = ir_binary_load_irg(file, N_IRGS - 1);
+	if (ir_binary_close(file) != 0)
+		return 1;
+
+	assert(get_irp_n_irgs() == 1);
+	assert(get_irp_irg(0) == irg);
+	assert(irg_verify(irg));
+	/* the callees are known, but without graphs */
+	unsigned       n_found = 0;
+	ir_type *const glob    = get_glob_type();
+	for (size_t i = 0, n = get_compound_n_members(glob); i < n; ++i) {
+		ir_entity *const entity = get_compound_member(glob, i);
+		for (size_t j = 0; j + 1 < N_IRGS; ++j) {
+			if (strcmp(get_entity_name(entity), names[j]) == 0) {
+				assert(get_entity_irg(entity) == NULL);
+				++n_found;
+			}
+		}
+	}
+	return n_found != N_IRGS - 1;
+}
+
+static int (*const steps[])(void) = {
+	write_program, reread_text, reread_binary, load_lazily, load_one,
+};
+
+static int run_step(int const nr)
+{
+	ir_init();
+	/* keep the graphs as built */
+	set_optimize(0);
+	int const res = steps[nr]();
+	ir_finish();
+	return res;
+}
+
+static char *read_file(char const *const name)
+{
+	FILE *const in = fopen(name, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long const size = ftell(in);
+	rewind(in);
+	char *const text = (char*)malloc(size + 1);
+	size_t const n_read = fread(text, 1, size, in);
+	assert(n_read == (size_t)size);
+	(void)n_read;
+	text[size] = '\0';
+	fclose(in);
+	return text;
+}
+
+static bool is_number(char const *const start, char const *const end)
+{
+	for (char const *c = start; c != end; ++c) {
+		if (!isdigit((unsigned char)*c))
+			return false;
+	}
+	return start != end;
+}
+
+/**
+ * Compares two files written by ir_export(). Numbers may differ, if each
+ * number of @p a always corresponds to the same number of @p b and the other
+ * way round.
+ */
+static bool same_but_numbers(char const *a, char const *b)
+{
+	static long a_to_b[MAX_NR];
+	static long b_to_a[MAX_NR];
+	memset(a_to_b, -1, sizeof(a_to_b));
+	memset(b_to_a, -1, sizeof(b_to_a));
+	for (;;) {
+		size_t const a_len = strcspn(a, " \t\n[]");
+		size_t const b_len = strcspn(b, " \t\n[]");
+		if (a_len != b_len || strncmp(a, b, a_len) != 0) {
+			if (!is_number(a, a + a_len) || !is_number(b, b + b_len))
+				return false;
+			long const a_nr = atol(a);
+			long const b_nr = atol(b);
+			assert(a_nr < MAX_NR && b_nr < MAX_NR);
+			if ((a_to_b[a_nr] != -1 && a_to_b[a_nr] != b_nr)
+			 || (b_to_a[b_nr] != -1 && b_to_a[b_nr] != a_nr))
+				return false;
+			a_to_b[a_nr] = b_nr;
+			b_to_a[b_nr] = a_nr;
+		}
+		a += a_len;
+		b += b_len;
+		if (*a != *b)
+			return false;
+		if (*a == '\0')
+			return true;
+		++a;
+		++b;
+	}
+}
+
+int main(void)
+{
+	test_enter_dir("irio_binary");
+	for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); ++i)
+		test_fork(run_step, i);
+
+	char *const text   = read_file("text.ir");
+	char *const binary = read_file("binary.ir");
+	char *const lazy   = read_file("lazy.ir");
+	assert(strstr(text, "caller") != NULL);
+	assert(same_but_numbers(text, binary));
+	assert(strcmp(binary, lazy) == 0);
+	free(lazy);
+	free(binary);
+	free(text);
+
+	return test_leave_dir("text.ir binary.ir lazy.ir program.ir program.irb");
+}
@@ -0,0 +1,219 @@
+/*
+ * Test the execution count profiling from instrumentation to reading.
+ *
+ * A program with a loop and a branch in it is compiled with profile
+ * instrumentation for amd64, linked with libfirmprof and run. The profile
+ * is then read for the same program, and the execution counts of the blocks
+ * must be exactly what the program did. This is done with plain and with
+ * atomic counters. Each compilation runs in its own process, as libfirm is
+ * initialized only once. The test is skipped if no C compiler for the host
+ * is found or the host is not amd64.
+ */
+#define _XOPEN_SOURCE 700
+#include "firm.h"
+#include "irprofile.h"
+#include "testutil.h"
+
+/** The blocks of f in the order of block_counts. */
+typedef struct program_t {
+	ir_node *start;
+	ir_node *header;
+	ir_node *body;
+	ir_node *then;
+	ir_node *otherwise;
+	ir_node *join;
+	ir_node *exit;
+} program_t;
+
+/**
+ * The execution counts of the blocks of f, which main calls with 10 and 5.
+ * The then block runs for the multiples of 4.
+ */
+static uint64_t const block_counts[] = { 2, 17, 15, 5, 10, 15, 2 };
+
+/**
+ * int f(int n)
+ * {
+ *     int s = 0;
+ *     for (int i = 0; i < n; ++i) {
+ *         if ((i & 3) == 0) s += i; else s ^= i;
+ *     }
+ *     return s;
+ * }
+ */
+static ir_entity *build_f(ir_type *const type, program_t *const program)
+{
+	ir_entity *const entity = new_entity(get_glob_type(), new_id_from_str("f"),
+	                                     type);
+	ir_graph  *const irg    = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+	program->start = get_cur_block();
+
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const param = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const cmp   = new_Cmp(get_value(1, mode_Is), param,
+	                               ir_relation_less);
+	ir_node *const cond  = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const i     = get_value(1, mode_Is);
+	ir_node *const low   = new_And(i, new_Const_long(mode_Is, 3), mode_Is);
+	ir_node *const cmp4  = new_Cmp(low, new_Const_long(mode_Is, 0),
+	                               ir_relation_equal);
+	ir_node *const cond4 = new_Cond(cmp4);
+
+	ir_node *const join = new_immBlock();
+	ir_node *const then = new_immBlock();
+	add_immBlock_pred(then, new_Proj(cond4, mode_X, pn_Cond_true));
+	mature_immBlock(then);
+	set_cur_block(then);
+	set_value(0, new_Add(get_value(0, mode_Is), i, mode_Is));
+	add_immBlock_pred(join, new_Jmp());
+
+	ir_node *const otherwise = new_immBlock();
+	add_immBlock_pred(otherwise, new_Proj(cond4, mode_X, pn_Cond_false));
+	mature_immBlock(otherwise);
+	set_cur_block(otherwise);
+	set_value(0, new_Eor(get_value(0, mode_Is), i, mode_Is));
+	add_immBlock_pred(join, new_Jmp());
+
+	mature_immBlock(join);
+	set_cur_block(join);
+	set_value(1, new_Add(i, new_Const_long(mode_Is, 1), mode_Is));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *res = get_value(0, mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+
+	program->header    = header;
+	program->body      = body;
+	program->then      = then;
+	program->otherwise = otherwise;
+	program->join      = join;
+	program->exit      = exit;
+	return entity;
+}
+
+/** int main(void) { f(10); f(5); return 0; } */
+static void build_main(ir_type *const type, ir_entity *const f)
+{
+	ir_type   *const main_type = new_type_method(0, 1);
+	set_method_res_type(main_type, 0, get_method_res_type(type, 0));
+	ir_entity *const entity    = new_entity(get_glob_type(),
+	                                        new_id_from_str("main"),
+	                                        main_type);
+	ir_graph  *const irg       = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	static long const args[] = { 10, 5 };
+	for (size_t a = 0; a < sizeof(args) / sizeof(args[0]); ++a) {
+		ir_node *const in[] = { new_Const_long(mode_Is, args[a]) };
+		ir_node *const call = new_Call(get_store(), new_Address(f), 1, in,
+		                               type);
+		set_store(new_Proj(call, mode_M, pn_Call_M));
+	}
+	ir_node *res = new_Const_long(mode_Is, 0);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static void build_program(program_t *const program)
+{
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const type     = new_type_method(1, 1);
+	set_method_param_type(type, 0, int_type);
+	set_method_res_type(type, 0, int_type);
+
+	/* keep the blocks as built */
+	set_optimize(0);
+	ir_entity *const f = build_f(type, program);
+	build_main(type, f);
+	set_optimize(1);
+}
+
+static void init_backend(bool const atomic)
+{
+	ir_init();
+	int res = be_parse_arg("isa=amd64");
+	res    &= be_parse_arg(atomic ? "profileatomic=1" : "profileatomic=0");
+	assert(res);
+	(void)res;
+}
+
+static int compile(int const atomic)
+{
+	init_backend(atomic);
+	int const res = be_parse_arg("profilegenerate=1");
+	assert(res);
+	(void)res;
+
+	program_t program;
+	build_program(&program);
+	FILE *const out = fopen("prog.s", "w");
+	assert(out != NULL);
+	be_main(out, "prog");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+static int check_profile(int const atomic)
+{
+	init_backend(atomic);
+	program_t program;
+	build_program(&program);
+	/* the instrumentation sees the graphs after the target lowering */
+	be_lower_for_target();
+	if (!ir_profile_read("prog.prof"))
+		return 1;
+
+	ir_node *const blocks[] = {
+		program.start, program.header, program.body, program.then,
+		program.otherwise, program.join, program.exit
+	};
+	for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); ++b) {
+		uint64_t const count = ir_profile_get_block_execcount(blocks[b]);
+		if (count != block_counts[b]) {
+			fprintf(stderr, "block %zu: %llu instead of %llu\n", b,
+			        (unsigned long long)count,
+			        (unsigned long long)block_counts[b]);
+			return 1;
+		}
+	}
+	ir_profile_free();
+	ir_finish();
+	return 0;
+}
+
+int main(void)
+{
+	if (!test_have_amd64_host())
+		return 0;
+
+	test_enter_dir("irprofile");
+	for (int atomic = 0; atomic < 2; ++atomic) {
+		test_fork(compile, atomic);
+		test_link_profiled("prog");
+		remove("prog.prof");
+		test_shell("./prog");
+		test_fork(check_profile, atomic);
+	}
+	return test_leave_dir("prog prog.s prog.prof");
+}
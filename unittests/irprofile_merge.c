@@ -0,0 +1,302 @@
+/*
+ * Test merging profiles and finding the functions of a merged profile.
+ *
+ * A program with many functions is compiled with profile instrumentation
+ * for amd64 and run four times with two different inputs, a variant of it
+ * in which one function has another control flow graph is run once. All
+ * runs are started at once and write their own profiles, named after their
+ * process ids by FIRMPROF_FILE. The profiles are merged with libfirmprof,
+ * which must drop the changed function of the last run. Reading the merged profile for the program must find every function by
+ * its name and give the summed counts, a function which is not in the profile
+ * and a function whose graph changed since profiling must get no counts.
+ * Each compilation runs in its own process, as libfirm is initialized only
+ * once. The test is skipped if no C compiler for the host is found or the
+ * host is not amd64.
+ */
+#define _XOPEN_SOURCE 700
+#include <glob.h>
+
+#include "firm.h"
+#include "irprofile.h"
+#include "testutil.h"
+#include "../support/libfirmprof/profdata.c"
+
+/** Enough functions for the names to collide in the buckets. */
+#define N_FUNCS   40
+/** The function which has a branch in its loop in the changed program. */
+#define CHANGED   3
+
+/** The blocks of a function fK. */
+typedef struct function_t {
+	ir_node *start;
+	ir_node *body;
+} function_t;
+
+typedef struct program_t {
+	function_t funcs[N_FUNCS];
+	function_t missing;
+} program_t;
+
+/**
+ * int name(int n)
+ * {
+ *     int s = 0;
+ *     for (int i = 0; i < n; ++i) {
+ *         if (branch && (i & 1)) s ^= i; else s += i;
+ *     }
+ *     return s;
+ * }
+ */
+static ir_entity *build_function(ir_type *const type, char const *const name,
+                                 bool const branch, function_t *const func)
+{
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+	func->start = get_cur_block();
+
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const param = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const cmp   = new_Cmp(get_value(1, mode_Is), param,
+	                               ir_relation_less);
+	ir_node *const cond  = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const i = get_value(1, mode_Is);
+	if (branch) {
+		ir_node *const low   = new_And(i, new_Const_long(mode_Is, 1), mode_Is);
+		ir_node *const cmp1  = new_Cmp(low, new_Const_long(mode_Is, 0),
+		                               ir_relation_equal);
+		ir_node *const cond1 = new_Cond(cmp1);
+		ir_node *const join  = new_immBlock();
+
+		ir_node *const even = new_immBlock();
+		add_immBlock_pred(even, new_Proj(cond1, mode_X, pn_Cond_true));
+		mature_immBlock(even);
+		set_cur_block(even);
+		set_value(0, new_Add(get_value(0, mode_Is), i, mode_Is));
+		add_immBlock_pred(join, new_Jmp());
+
+		ir_node *const odd = new_immBlock();
+		add_immBlock_pred(odd, new_Proj(cond1, mode_X, pn_Cond_false));
+		mature_immBlock(odd);
+		set_cur_block(odd);
+		set_value(0, new_Eor(get_value(0, mode_Is), i, mode_Is));
+		add_immBlock_pred(join, new_Jmp());
+
+		mature_immBlock(join);
+		set_cur_block(join);
+	} else {
+		set_value(0, new_Add(get_value(0, mode_Is), i, mode_Is));
+	}
+	set_value(1, new_Add(i, new_Const_long(mode_Is, 1), mode_Is));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *res = get_value(0, mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+
+	func->body = body;
+	return entity;
+}
+
+/** int main(int argc) { f0(argc + 0); f1(argc + 1); ... return 0; } */
+static void build_main(ir_type *const type, ir_entity *const *const funcs)
+{
+	ir_type   *const int_type  = get_method_res_type(type, 0);
+	ir_type   *const main_type = new_type_method(1, 1);
+	set_method_param_type(main_type, 0, int_type);
+	set_method_res_type(main_type, 0, int_type);
+	ir_entity *const entity    = new_entity(get_glob_type(),
+	                                        new_id_from_str("main"),
+	                                        main_type);
+	ir_graph  *const irg       = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *const argc = new_Proj(get_irg_args(irg), mode_Is, 0);
+	for (int f = 0; f < N_FUNCS; ++f) {
+		ir_node *const in[] = {
+			new_Add(argc, new_Const_long(mode_Is, f), mode_Is)
+		};
+		ir_node *const call = new_Call(get_store(), new_Address(funcs[f]), 1,
+		                               in, type);
+		set_store(new_Proj(call, mode_M, pn_Call_M));
+	}
+	ir_node *res = new_Const_long(mode_Is, 0);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+/**
+ * Builds the program, with a branch in f3 if @p changed and with a function
+ * which main does not call if @p missing.
+ */
+static void build_program(bool const changed, bool const missing,
+                          program_t *const program)
+{
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const type     = new_type_method(1, 1);
+	set_method_param_type(type, 0, int_type);
+	set_method_res_type(type, 0, int_type);
+
+	/* keep the blocks as built */
+	set_optimize(0);
+	ir_entity *funcs[N_FUNCS];
+	for (int f = 0; f < N_FUNCS; ++f) {
+		char name[16];
+		snprintf(name, sizeof(name), "f%d", f);
+		funcs[f] = build_function(type, name, changed && f == CHANGED,
+		                          &program->funcs[f]);
+	}
+	if (missing)
+		build_function(type, "missing", false, &program->missing);
+	build_main(type, funcs);
+	set_optimize(1);
+}
+
+static void init_backend(void)
+{
+	ir_init();
+	int const res = be_parse_arg("isa=amd64");
+	assert(res);
+	(void)res;
+}
+
+static int compile(int const changed)
+{
+	init_backend();
+	int const res = be_parse_arg("profilegenerate=1");
+	assert(res);
+	(void)res;
+
+	program_t program;
+	build_program(changed, false, &program);
+	FILE *const out = fopen(changed ? "changed.s" : "prog.s", "w");
+	assert(out != NULL);
+	be_main(out, "prog");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+static bool check_count(char const *const what, int const f,
+                        ir_node const *const block, uint64_t const expected)
+{
+	uint64_t const count = ir_profile_get_block_execcount(block);
+	if (count == expected)
+		return true;
+	fprintf(stderr, "%s of f%d: %llu instead of %llu\n", what, f,
+	        (unsigned long long)count, (unsigned long long)expected);
+	return false;
+}
+
+/** Reads merged.prof for the program, or for the changed one. */
+static int check_profile(int const changed)
+{
+	init_backend();
+	program_t program;
+	build_program(changed, true, &program);
+	/* the instrumentation sees the graphs after the target lowering */
+	be_lower_for_target();
+	if (!ir_profile_read("merged.prof"))
+		return 1;
+
+	bool ok = true;
+	for (int f = 0; f < N_FUNCS; ++f) {
+		function_t const *const func = &program.funcs[f];
+		/* two runs each with argc 1 and 2, the changed program with argc 1 */
+		uint64_t calls = 4;
+		uint64_t iters = 2 * ((1 + f) + (2 + f));
+		if (f != CHANGED) {
+			calls += 1;
+			iters += 1 + f;
+		} else if (changed) {
+			calls = 0;
+			iters = 0;
+		}
+		ok &= check_count("start", f, func->start, calls);
+		ok &= check_count("body", f, func->body, iters);
+	}
+	ok &= check_count("start", -1, program.missing.start, 0);
+	ok &= check_count("body", -1, program.missing.body, 0);
+	ir_profile_free();
+	ir_finish();
+	return !ok;
+}
+
+/**
+ * Sums the profiles of the runs, the changed f3 of the last run is dropped.
+ * Each run must have left exactly its own profile.
+ */
+static int merge(int const unused)
+{
+	(void)unused;
+	glob_t runs;
+	if (glob("prog.prof.*", 0, NULL, &runs) != 0
+	    || glob("changed.prof.*", GLOB_APPEND, NULL, &runs) != 0)
+		return 1;
+	if (runs.gl_pathc != 5) {
+		fprintf(stderr, "%zu profiles instead of 5\n", runs.gl_pathc);
+		return 1;
+	}
+	int const merged = firmprof_merge("merged.prof",
+	                                  (char const *const*)runs.gl_pathv, 5);
+	globfree(&runs);
+	if (merged != 0)
+		return 1;
+
+	/* a function is refused if it comes with another checksum */
+	firmprof_t    *const profile = firmprof_new();
+	uint64_t       const counter = 1;
+	unsigned char  const calls[] = { 0 };
+	int res = firmprof_add_file(profile, "merged.prof");
+	if (res != 0
+	    || firmprof_add_function(profile, "f0", 2, 0, &counter, 1, calls, 0) == 0
+	    || firmprof_add_function(profile, "unknown", 7, 0, &counter, 1, calls, 0) != 0
+	    || firmprof_write(profile, "merged.prof") != 0)
+		res = 1;
+	firmprof_free(profile);
+	return res;
+}
+
+int main(void)
+{
+	if (!test_have_amd64_host())
+		return 0;
+
+	test_enter_dir("irprofile_merge");
+	test_fork(compile, false);
+	test_fork(compile, true);
+	test_link_profiled("prog");
+	test_link_profiled("changed");
+	/* the changed program still names its profile prog.prof */
+	test_shell("FIRMPROF_FILE=%%f.%%p ./prog & p1=$!; "
+	           "FIRMPROF_FILE=%%f.%%p ./prog x & p2=$!; "
+	           "FIRMPROF_FILE=%%f.%%p ./prog & p3=$!; "
+	           "FIRMPROF_FILE=%%f.%%p ./prog x & p4=$!; "
+	           "FIRMPROF_FILE=changed.prof.%%p ./changed & p5=$!; "
+	           "wait $p1 && wait $p2 && wait $p3 && wait $p4 && wait $p5");
+	test_fork(merge, false);
+	test_fork(check_profile, false);
+	test_fork(check_profile, true);
+
+	return test_leave_dir("prog prog.s changed changed.s prog.prof.* "
+	                      "changed.prof.* merged.prof");
+}
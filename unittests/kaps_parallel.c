@@ -0,0 +1,97 @@
+/*
+ * Test that solving PBQP instances in parallel gives the same solutions as
+ * solving them one after another.
+ */
+#include <assert.h>
+#include <stdio.h>
+
+#include "brute_force.h"
+#include "heuristical.h"
+#include "kaps.h"
+#include "matrix.h"
+#include "parallel.h"
+#include "vector.h"
+
+#define N_PBQPS   64
+#define N_NODES   40
+#define N_ALTS    4
+#define N_THREADS 4
+
+static unsigned next_random(unsigned *state)
+{
+	*state = *state * 1103515245 + 12345;
+	return *state >> 8;
+}
+
+static num random_cost(unsigned *state)
+{
+	unsigned r = next_random(state) % 16;
+	return r == 0 ? INF_COSTS : r;
+}
+
+static pbqp_t *build_pbqp(unsigned seed, unsigned n_nodes)
+{
+	pbqp_t  *pbqp  = alloc_pbqp(n_nodes);
+	unsigned state = seed;
+	for (unsigned n = 0; n < n_nodes; ++n) {
+		vector_t *costs = vector_alloc(pbqp, N_ALTS);
+		for (unsigned a = 0; a < N_ALTS; ++a)
+			vector_set(costs, a, next_random(&state) % 8);
+		add_node_costs(pbqp, n, costs);
+	}
+	for (unsigned e = 0; e < 2 * n_nodes; ++e) {
+		unsigned src = next_random(&state) % n_nodes;
+		unsigned tgt = next_random(&state) % n_nodes;
+		if (src == tgt)
+			continue;
+		pbqp_matrix_t *costs = pbqp_matrix_alloc(pbqp, N_ALTS, N_ALTS);
+		for (unsigned r = 0; r < N_ALTS; ++r) {
+			for (unsigned c = 0; c < N_ALTS; ++c)
+				pbqp_matrix_set(costs, r, c, random_cost(&state));
+		}
+		add_edge_costs(pbqp, src, tgt, costs);
+	}
+	return pbqp;
+}
+
+static void solve_heuristical(pbqp_t *pbqp, void *data)
+{
+	(void)data;
+	solve_pbqp_heuristical(pbqp);
+}
+
+static void solve_brute_force(pbqp_t *pbqp, void *data)
+{
+	(void)data;
+	solve_pbqp_brute_force(pbqp);
+}
+
+static void test_solver(pbqp_solve_func solve, unsigned n_nodes)
+{
+	pbqp_t *serial[N_PBQPS];
+	pbqp_t *parallel[N_PBQPS];
+	for (unsigned i = 0; i < N_PBQPS; ++i) {
+		serial[i]   = build_pbqp(i, n_nodes);
+		parallel[i] = build_pbqp(i, n_nodes);
+	}
+
+	solve_pbqps_parallel(N_PBQPS, serial, NULL, solve, 1);
+	solve_pbqps_parallel(N_PBQPS, parallel, NULL, solve, N_THREADS);
+
+	for (unsigned i = 0; i < N_PBQPS; ++i) {
+		assert(get_solution(serial[i]) == get_solution(parallel[i]));
+		for (unsigned n = 0; n < n_nodes; ++n) {
+			assert(get_node_solution(serial[i], n)
+			       == get_node_solution(parallel[i], n));
+		}
+		free_pbqp(serial[i]);
+		free_pbqp(parallel[i]);
+	}
+}
+
+int main(void)
+{
+	test_solver(solve_heuristical, N_NODES);
+	test_solver(solve_brute_force, N_NODES / 4);
+	return 0;
+}
@@ -0,0 +1,323 @@
+/*
+ * Test the lowering of Switch nodes.
+ *
+ * Functions which only return the number of the switch target taken are
+ * lowered and the lowered control flow graph is interpreted for selector
+ * values in and around every case and at the ends of the selector mode. It
+ * must reach the same target as the switch. This is done for cases which
+ * become a bit test, cases which become a smaller jump table and cases of a
+ * signed selector. A case taken in most executions must be tested first if
+ * the graph has frequencies.
+ */
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "firm.h"
+#include "execfreq_t.h"
+#include "irouts.h"
+
+typedef struct case_t {
+	long     min;
+	long     max;
+	unsigned pn;
+} case_t;
+
+typedef struct node_count_t {
+	unsigned n_switches;
+	unsigned n_shls;
+} node_count_t;
+
+/** int f(x) { switch (x) { case min ... max: return pn; } return 0; } */
+static ir_graph *build_switch(ir_mode *const mode, case_t const *const cases,
+                              size_t const n_cases, unsigned const n_outs,
+                              char const *const name)
+{
+	ir_type *const param_type = new_type_primitive(mode);
+	ir_type *const res_type   = new_type_primitive(mode_Is);
+	ir_type *const type       = new_type_method(1, 1);
+	set_method_param_type(type, 0, param_type);
+	set_method_res_type(type, 0, res_type);
+	ir_entity *const entity = new_entity(get_glob_type(), new_id_from_str(name),
+	                                     type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node         *const selector = new_Proj(get_irg_args(irg), mode, 0);
+	ir_switch_table *const table    = ir_new_switch_table(irg, n_cases);
+	for (size_t c = 0; c < n_cases; ++c) {
+		ir_switch_table_set(table, c, new_tarval_from_long(cases[c].min, mode),
+		                    new_tarval_from_long(cases[c].max, mode),
+		                    cases[c].pn);
+	}
+	ir_node *const switchn = new_Switch(selector, n_outs, table);
+
+	ir_node *const end_block = get_irg_end_block(irg);
+	for (unsigned pn = 0; pn < n_outs; ++pn) {
+		ir_node *const block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(switchn, mode_X, pn));
+		mature_immBlock(block);
+		set_cur_block(block);
+		ir_node *res = new_Const_long(mode_Is, pn);
+		ir_node *ret = new_Return(get_store(), 1, &res);
+		add_immBlock_pred(end_block, ret);
+	}
+	mature_immBlock(end_block);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static ir_tarval *eval_value(ir_node *const node, ir_tarval *const arg)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Const:
+		return get_Const_tarval(node);
+	case iro_Proj:
+		/* the only argument */
+		return arg;
+	case iro_Conv:
+		return tarval_convert_to(eval_value(get_Conv_op(node), arg),
+		                         get_irn_mode(node));
+	case iro_Add:
+		return tarval_add(eval_value(get_Add_left(node), arg),
+		                  eval_value(get_Add_right(node), arg));
+	case iro_Sub:
+		return tarval_sub(eval_value(get_Sub_left(node), arg),
+		                  eval_value(get_Sub_right(node), arg));
+	case iro_And:
+		return tarval_and(eval_value(get_And_left(node), arg),
+		                  eval_value(get_And_right(node), arg));
+	case iro_Shl:
+		return tarval_shl(eval_value(get_Shl_left(node), arg),
+		                  eval_value(get_Shl_right(node), arg));
+	default:
+		ir_fprintf(stderr, "cannot evaluate %+F\n", node);
+		return NULL;
+	}
+}
+
+/** Returns the control flow node at the end of @p block. */
+static ir_node *get_block_cf(ir_node const *const block)
+{
+	for (unsigned i = 0, n = get_irn_n_outs(block); i < n; ++i) {
+		ir_node *const node = get_irn_out(block, i);
+		if (is_Jmp(node) || is_Cond(node) || is_Switch(node)
+		    || is_Return(node))
+			return node;
+	}
+	return NULL;
+}
+
+static ir_node *get_cf_target(ir_node const *const node, unsigned const pn)
+{
+	for (unsigned i = 0, n = get_irn_n_outs(node); i < n; ++i) {
+		ir_node *const proj = get_irn_out(node, i);
+		if (get_Proj_num(proj) == pn)
+			return get_irn_out(proj, 0);
+	}
+	return NULL;
+}
+
+/**
+ * Interprets the lowered graph for the argument @p arg and returns the
+ * number of the target it reaches, or -1 if it cannot be interpreted.
+ */
+static long interpret(ir_graph *const irg, ir_tarval *const arg)
+{
+	ir_node *block = get_irg_start_block(irg);
+	for (unsigned steps = 0; block != NULL && steps < 1000; ++steps) {
+		ir_node *const cf = get_block_cf(block);
+		if (cf == NULL)
+			return -1;
+		if (is_Return(cf)) {
+			ir_tarval *const res = eval_value(get_Return_res(cf, 0), arg);
+			return res != NULL ? get_tarval_long(res) : -1;
+		} else if (is_Jmp(cf)) {
+			block = get_irn_out(cf, 0);
+		} else if (is_Cond(cf)) {
+			ir_node   *const cmp   = get_Cond_selector(cf);
+			ir_tarval *const left  = eval_value(get_Cmp_left(cmp), arg);
+			ir_tarval *const right = eval_value(get_Cmp_right(cmp), arg);
+			if (left == NULL || right == NULL)
+				return -1;
+			bool const taken = tarval_cmp(left, right) & get_Cmp_relation(cmp);
+			block = get_cf_target(cf, taken ? pn_Cond_true : pn_Cond_false);
+		} else {
+			ir_tarval *const selector = eval_value(get_Switch_selector(cf), arg);
+			if (selector == NULL)
+				return -1;
+			ir_switch_table const *const table = get_Switch_table(cf);
+			unsigned pn = pn_Switch_default;
+			for (size_t e = 0, n = ir_switch_table_get_n_entries(table);
+			     e < n; ++e) {
+				ir_tarval *const min = ir_switch_table_get_min(table, e);
+				ir_tarval *const max = ir_switch_table_get_max(table, e);
+				if (!(tarval_cmp(selector, min) & ir_relation_less)
+				    && !(tarval_cmp(selector, max) & ir_relation_greater))
+					pn = ir_switch_table_get_pn(table, e);
+			}
+			block = get_cf_target(cf, pn);
+		}
+	}
+	return -1;
+}
+
+static bool check_value(ir_graph *const irg, ir_mode *const mode,
+                        case_t const *const cases, size_t const n_cases,
+                        long const value)
+{
+	ir_tarval *const arg      = new_tarval_from_long(value, mode);
+	long             expected = pn_Switch_default;
+	for (size_t c = 0; c < n_cases; ++c) {
+		ir_tarval *const min = new_tarval_from_long(cases[c].min, mode);
+		ir_tarval *const max = new_tarval_from_long(cases[c].max, mode);
+		if (!(tarval_cmp(arg, min) & ir_relation_less)
+		    && !(tarval_cmp(arg, max) & ir_relation_greater))
+			expected = cases[c].pn;
+	}
+	long const target = interpret(irg, arg);
+	if (target == expected)
+		return true;
+	ir_fprintf(stderr, "%F: %ld goes to %ld instead of %ld\n", irg, value,
+	           target, expected);
+	return false;
+}
+
+/** Checks that the lowered graph reaches the right target for all cases. */
+static bool check_targets(ir_graph *const irg, ir_mode *const mode,
+                          case_t const *const cases, size_t const n_cases)
+{
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	bool ok = true;
+	ok &= check_value(irg, mode, cases, n_cases,
+	                  get_tarval_long(get_mode_min(mode)));
+	ok &= check_value(irg, mode, cases, n_cases,
+	                  get_tarval_long(get_mode_max(mode)));
+	ok &= check_value(irg, mode, cases, n_cases, 0);
+	for (size_t c = 0; c < n_cases; ++c) {
+		for (long value = cases[c].min - 2; value <= cases[c].max + 2; ++value)
+			ok &= check_value(irg, mode, cases, n_cases, value);
+	}
+	return ok;
+}
+
+static void count_node(ir_node *const node, void *const data)
+{
+	node_count_t *const count = (node_count_t*)data;
+	if (is_Switch(node))
+		++count->n_switches;
+	else if (is_Shl(node))
+		++count->n_shls;
+}
+
+static bool check_nodes(ir_graph *const irg, unsigned const n_switches,
+                        unsigned const n_shls)
+{
+	node_count_t count = { 0, 0 };
+	irg_walk_graph(irg, count_node, NULL, &count);
+	if (count.n_switches == n_switches && count.n_shls == n_shls)
+		return true;
+	ir_fprintf(stderr, "%F: %u Switch and %u Shl instead of %u and %u\n", irg,
+	           count.n_switches, count.n_shls, n_switches, n_shls);
+	return false;
+}
+
+/** The odd and even small cases become a bit test for two targets. */
+static bool test_bit_test(void)
+{
+	static case_t const cases[] = {
+		{ 1, 1, 1 }, { 3, 3, 1 }, { 5, 5, 1 }, { 7, 7, 1 }, { 9, 9, 1 },
+		{ 11, 11, 1 }, { 2, 2, 2 }, { 4, 4, 2 }, { 6, 6, 2 },
+		{ 1000, 1000, 3 },
+	};
+	size_t const    n_cases = sizeof(cases) / sizeof(cases[0]);
+	ir_graph *const irg     = build_switch(mode_Iu, cases, n_cases, 4,
+	                                       "bit_test");
+	lower_switch(irg, 4, 256, mode_Iu);
+
+	bool ok = check_targets(irg, mode_Iu, cases, n_cases);
+	ok &= check_nodes(irg, 0, 1);
+	return ok;
+}
+
+/** The dense cases become a jump table, the others are compared. */
+static bool test_table(void)
+{
+	case_t cases[22];
+	size_t n_cases = 0;
+	for (unsigned c = 0; c < 20; ++c)
+		cases[n_cases++] = (case_t){ 100 + c, 100 + c, 1 + c };
+	cases[n_cases++] = (case_t){ 5000, 5000, 21 };
+	cases[n_cases++] = (case_t){ 9000, 9000, 22 };
+	ir_graph *const irg = build_switch(mode_Iu, cases, n_cases, 23, "table");
+	lower_switch(irg, 4, 256, mode_Iu);
+
+	bool ok = check_targets(irg, mode_Iu, cases, n_cases);
+	ok &= check_nodes(irg, 1, 0);
+	return ok;
+}
+
+/**
+ * Values of a signed selector below the lowest range must not be in it, no
+ * comparison in the search tree excludes them before.
+ */
+static bool test_signed(void)
+{
+	static case_t const cases[] = {
+		{ -5, -2, 1 }, { 3, 3, 2 }, { 7, 7, 3 }, { 1000, 1000, 4 },
+	};
+	size_t const    n_cases = sizeof(cases) / sizeof(cases[0]);
+	ir_graph *const irg     = build_switch(mode_Is, cases, n_cases, 5,
+	                                       "signed");
+	lower_switch(irg, 4, 256, mode_Iu);
+
+	bool ok = check_targets(irg, mode_Is, cases, n_cases);
+	ok &= check_value(irg, mode_Is, cases, n_cases, INT_MIN + 3);
+	ok &= check_value(irg, mode_Is, cases, n_cases, -100);
+	ok &= check_nodes(irg, 0, 0);
+	return ok;
+}
+
+/** The case taken in most executions is tested first. */
+static bool test_dominant(void)
+{
+	static case_t const cases[] = {
+		{ 1, 1, 1 }, { 5, 5, 2 }, { 9, 9, 3 }, { 13, 13, 4 }, { 17, 17, 5 },
+		{ 1000, 1000, 6 },
+	};
+	size_t const    n_cases = sizeof(cases) / sizeof(cases[0]);
+	ir_graph *const irg     = build_switch(mode_Iu, cases, n_cases, 7,
+	                                       "dominant");
+	ir_node  *const start   = get_irg_start_block(irg);
+	set_block_execfreq(start, 100.0);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	ir_node *const switchn = get_block_cf(start);
+	for (unsigned pn = 0; pn < 7; ++pn) {
+		ir_node *const target = get_cf_target(switchn, pn);
+		set_block_execfreq(target, pn == 2 ? 90.0 : 1.0);
+	}
+	lower_switch(irg, 4, 256, mode_Iu);
+
+	bool ok = check_targets(irg, mode_Iu, cases, n_cases);
+	ir_node *const cond = get_block_cf(start);
+	ir_node *const cmp  = is_Cond(cond) ? get_Cond_selector(cond) : NULL;
+	if (cmp == NULL || get_Cmp_relation(cmp) != ir_relation_equal
+	    || !is_Const(get_Cmp_right(cmp))
+	    || get_tarval_long(get_Const_tarval(get_Cmp_right(cmp))) != 5) {
+		ir_fprintf(stderr, "%F: the dominant case is not tested first\n", irg);
+		ok = false;
+	}
+	return ok;
+}
+
+int main(void)
+{
+	ir_init();
+	bool ok = true;
+	ok &= test_bit_test();
+	ok &= test_table();
+	ok &= test_signed();
+	ok &= test_dominant();
+	ir_finish();
+	return !ok;
+}
@@ -0,0 +1,185 @@
+/*
+ * Test the embedded simplex solver of lpp against enumerating all
+ * assignments of small random binary programs.
+ */
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "lpp.h"
+#include "lpp_simplex.h"
+
+#define N_PROBLEMS 200
+#define N_VARS     10
+#define N_CSTS     6
+
+static unsigned next_random(unsigned *state)
+{
+	*state = *state * 1103515245 + 12345;
+	return *state >> 8;
+}
+
+typedef struct problem_t {
+	lpp_opt_t opt;
+	lpp_cst_t cst_type[N_CSTS];
+	int       rhs[N_CSTS];
+	int       factor[N_CSTS][N_VARS];
+	int       obj[N_VARS];
+} problem_t;
+
+/* Most problems are built around a hidden feasible assignment, every 8th
+ * gets random right hand sides and is mostly infeasible. */
+static void random_problem(problem_t *p, unsigned seed)
+{
+	unsigned       state  = seed;
+	unsigned const hidden = next_random(&state) % (1u << N_VARS);
+	p->opt = next_random(&state) % 2 ? lpp_minimize : lpp_maximize;
+	for (int v = 0; v < N_VARS; ++v)
+		p->obj[v] = (int)(next_random(&state) % 21) - 10;
+	for (int c = 0; c < N_CSTS; ++c) {
+		int act = 0;
+		for (int v = 0; v < N_VARS; ++v) {
+			int const f = next_random(&state) % 3 == 0
+				? (int)(next_random(&state) % 9) - 4 : 0;
+			p->factor[c][v] = f;
+			if (hidden & (1u << v))
+				act += f;
+		}
+		static lpp_cst_t const types[] = {
+			lpp_less_equal, lpp_less_equal, lpp_greater_equal, lpp_equal
+		};
+		int const slack = (int)(next_random(&state) % 3);
+		p->cst_type[c] = types[next_random(&state) % 4];
+		switch (p->cst_type[c]) {
+		case lpp_less_equal:    p->rhs[c] = act + slack; break;
+		case lpp_greater_equal: p->rhs[c] = act - slack; break;
+		default:                p->rhs[c] = act;         break;
+		}
+		if (seed % 8 == 0)
+			p->rhs[c] = (int)(next_random(&state) % 9) - 4;
+	}
+}
+
+static bool is_feasible(problem_t const *p, unsigned assignment)
+{
+	for (int c = 0; c < N_CSTS; ++c) {
+		int act = 0;
+		for (int v = 0; v < N_VARS; ++v) {
+			if (assignment & (1u << v))
+				act += p->factor[c][v];
+		}
+		switch (p->cst_type[c]) {
+		case lpp_equal:         if (act != p->rhs[c]) return false; break;
+		case lpp_less_equal:    if (act >  p->rhs[c]) return false; break;
+		case lpp_greater_equal: if (act <  p->rhs[c]) return false; break;
+		default:                assert(false);
+		}
+	}
+	return true;
+}
+
+/** @return the optimal objective or NAN if infeasible */
+static double enumerate(problem_t const *p)
+{
+	double best = NAN;
+	for (unsigned a = 0; a < 1u << N_VARS; ++a) {
+		if (!is_feasible(p, a))
+			continue;
+		int obj = 0;
+		for (int v = 0; v < N_VARS; ++v) {
+			if (a & (1u << v))
+				obj += p->obj[v];
+		}
+		if (isnan(best) || (p->opt == lpp_minimize ? obj < best : obj > best))
+			best = obj;
+	}
+	return best;
+}
+
+static lpp_t *build_lpp(problem_t const *p)
+{
+	lpp_t *lpp = lpp_new("test", p->opt);
+	int    vars[N_VARS];
+	for (int v = 0; v < N_VARS; ++v) {
+		char name[16];
+		snprintf(name, sizeof(name), "x%d", v);
+		vars[v] = lpp_add_var(lpp, name, lpp_binary, p->obj[v]);
+	}
+	for (int c = 0; c < N_CSTS; ++c) {
+		int const cst = lpp_add_cst(lpp, NULL, p->cst_type[c], p->rhs[c]);
+		for (int v = 0; v < N_VARS; ++v) {
+			if (p->factor[c][v] != 0)
+				lpp_set_factor_fast(lpp, cst, vars[v], p->factor[c][v]);
+		}
+	}
+	return lpp;
+}
+
+static void check_problem(problem_t const *p, unsigned seed)
+{
+	double const expected = enumerate(p);
+	lpp_t *const lpp      = build_lpp(p);
+	lpp_solve_simplex(lpp);
+
+	if (isnan(expected)) {
+		if (lpp->sol_state != lpp_infeasible) {
+			fprintf(stderr, "problem %u: expected infeasible\n", seed);
+			assert(false);
+		}
+	} else {
+		unsigned assignment = 0;
+		for (int v = 0; v < N_VARS; ++v) {
+			double const val = lpp_get_var_sol(lpp, 1 + v);
+			assert(val == 0.0 || val == 1.0);
+			if (val == 1.0)
+				assignment |= 1u << v;
+		}
+		if (lpp->sol_state != lpp_optimal || lpp->objval != expected
+		    || !is_feasible(p, assignment)) {
+			fprintf(stderr, "problem %u: expected %g, got %g (state %d)\n",
+			        seed, expected, lpp->objval, (int)lpp->sol_state);
+			assert(false);
+		}
+		assert(lpp_get_mip_gap(lpp) < 1e-9);
+	}
+	lpp_free(lpp);
+}
+
+/* The start values of an assignment problem are used as the first solution. */
+static void check_start_values(void)
+{
+	enum { N = 5 };
+	lpp_t *lpp = lpp_new("assign", lpp_minimize);
+	int    x[N][N];
+	for (int i = 0; i < N; ++i) {
+		for (int j = 0; j < N; ++j) {
+			char name[16];
+			snprintf(name, sizeof(name), "x%d_%d", i, j);
+			x[i][j] = lpp_add_var_default(lpp, name, lpp_binary,
+			                              (i * 7 + j * 3) % N + 1, i + j == N - 1);
+		}
+	}
+	for (int i = 0; i < N; ++i) {
+		int const row = lpp_add_cst(lpp, NULL, lpp_equal, 1);
+		int const col = lpp_add_cst(lpp, NULL, lpp_equal, 1);
+		for (int j = 0; j < N; ++j) {
+			lpp_set_factor_fast(lpp, row, x[i][j], 1);
+			lpp_set_factor_fast(lpp, col, x[j][i], 1);
+		}
+	}
+	lpp_solve_simplex(lpp);
+	assert(lpp->sol_state == lpp_optimal);
+	assert(lpp->objval == N);
+	lpp_free(lpp);
+}
+
+int main(void)
+{
+	for (unsigned seed = 0; seed < N_PROBLEMS; ++seed) {
+		problem_t p;
+		random_problem(&p, seed);
+		check_problem(&p, seed);
+	}
+	check_start_values();
+	return 0;
+}
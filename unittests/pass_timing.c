@@ -0,0 +1,196 @@
+/*
+ * Test the pass timing.
+ *
+ * Passes of two functions and of the whole program are nested and each
+ * waits for a known time. The JSON dump must list every pass of every
+ * function with its number of calls, and the self time of a pass must be
+ * its total time without the total time of the passes nested in it. A pass
+ * of the library must be recorded for the function it runs on, and the
+ * table dump must list the same passes.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "firm.h"
+#include "timing_t.h"
+
+#define MAX_RECORDS 64
+
+typedef struct record_t {
+	char     function[32];
+	char     pass[32];
+	unsigned calls;
+	uint64_t self_ns;
+	uint64_t total_ns;
+} record_t;
+
+static record_t records[MAX_RECORDS];
+static unsigned n_records;
+
+/** Waits for @p ms milliseconds. */
+static void spin(unsigned const ms)
+{
+	uint64_t const end = ir_time_now_nsec() + ms * UINT64_C(1000000);
+	while (ir_time_now_nsec() < end) {
+	}
+}
+
+/** int name(int x) { return x; } */
+static ir_graph *build_function(char const *const name)
+{
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const type     = new_type_method(1, 1);
+	set_method_param_type(type, 0, int_type);
+	set_method_res_type(type, 0, int_type);
+	ir_entity *const entity = new_entity(get_glob_type(), new_id_from_str(name),
+	                                     type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+	ir_node *res = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static void run_passes(ir_graph *const irg)
+{
+	ir_pass_begin(irg, "outer");
+	spin(10);
+	for (unsigned i = 0; i < 2; ++i) {
+		/* without a graph the pass belongs to the function of outer */
+		ir_pass_begin(NULL, "inner");
+		spin(5);
+		ir_pass_end("inner");
+	}
+	optimize_graph_df(irg);
+	ir_pass_end("outer");
+}
+
+static void read_records(FILE *const in)
+{
+	char line[512];
+	while (fgets(line, sizeof(line), in) != NULL) {
+		record_t *const record = &records[n_records];
+		if (sscanf(line, " {\"function\": \"%31[^\"]\", \"pass\": \"%31[^\"]\", "
+		           "\"calls\": %u, \"self_ns\": %" SCNu64 ", \"total_ns\": %"
+		           SCNu64, record->function, record->pass, &record->calls,
+		           &record->self_ns, &record->total_ns) == 5) {
+			assert(n_records < MAX_RECORDS - 1);
+			++n_records;
+		}
+	}
+}
+
+static record_t const *find_record(char const *const function,
+                                   char const *const pass,
+                                   unsigned const calls)
+{
+	for (unsigned i = 0; i < n_records; ++i) {
+		record_t const *const record = &records[i];
+		if (strcmp(record->function, function) == 0
+		    && strcmp(record->pass, pass) == 0) {
+			if (record->calls == calls)
+				return record;
+			fprintf(stderr, "%s %s: %u calls instead of %u\n", function, pass,
+			        record->calls, calls);
+			return NULL;
+		}
+	}
+	fprintf(stderr, "%s %s: not dumped\n", function, pass);
+	return NULL;
+}
+
+static bool check_self(record_t const *const record, uint64_t const nested,
+                       unsigned const min_ms)
+{
+	if (record->self_ns + nested == record->total_ns
+	    && record->self_ns >= min_ms * UINT64_C(1000000))
+		return true;
+	fprintf(stderr, "%s %s: self %" PRIu64 " ns, total %" PRIu64
+	        " ns, nested %" PRIu64 " ns\n", record->function, record->pass,
+	        record->self_ns, record->total_ns, nested);
+	return false;
+}
+
+static bool check_function(char const *const name, record_t const **outer)
+{
+	record_t const *const inner = find_record(name, "inner", 2);
+	record_t const *const opt   = find_record(name, "optimize_graph_df", 1);
+	*outer = find_record(name, "outer", 1);
+	if (inner == NULL || opt == NULL || *outer == NULL)
+		return false;
+	return check_self(inner, 0, 10)
+	    && check_self(*outer, inner->total_ns + opt->total_ns, 10);
+}
+
+int main(void)
+{
+	ir_init();
+	ir_graph *const f = build_function("f");
+	ir_graph *const g = build_function("g");
+
+	ir_pass_timing_enable(0);
+	ir_pass_begin(NULL, "program");
+	spin(10);
+	run_passes(f);
+	run_passes(g);
+	ir_pass_end("program");
+	ir_pass_timing_disable();
+
+	FILE *const json = tmpfile();
+	assert(json != NULL);
+	ir_pass_timing_dump(json, 1);
+	rewind(json);
+	read_records(json);
+	fclose(json);
+
+	/* optimize_graph_df() runs further passes nested in it */
+	bool ok = true;
+	for (unsigned i = 0; i < n_records; ++i) {
+		char const *const function = records[i].function;
+		if (strcmp(function, "f") != 0 && strcmp(function, "g") != 0
+		    && strcmp(function, "<program>") != 0) {
+			fprintf(stderr, "%s %s: unknown function\n", function,
+			        records[i].pass);
+			ok = false;
+		}
+	}
+	record_t const *f_outer;
+	record_t const *g_outer;
+	ok &= check_function("f", &f_outer);
+	ok &= check_function("g", &g_outer);
+	record_t const *const program = find_record("<program>", "program", 1);
+	ok &= program != NULL && f_outer != NULL && g_outer != NULL
+	   && check_self(program, f_outer->total_ns + g_outer->total_ns, 10);
+
+	/* the table lists the same passes */
+	FILE *const table = tmpfile();
+	assert(table != NULL);
+	ir_pass_timing_dump(table, 0);
+	rewind(table);
+	unsigned n_lines = 0;
+	char     line[512];
+	while (fgets(line, sizeof(line), table) != NULL) {
+		char     pass[32];
+		unsigned calls;
+		if (strncmp(line, "==>> ", 5) != 0
+		    && sscanf(line, "%31s %u", pass, &calls) == 2)
+			++n_lines;
+	}
+	fclose(table);
+	if (n_lines != n_records) {
+		fprintf(stderr, "%u passes in the table instead of %u\n", n_lines,
+		        n_records);
+		ok = false;
+	}
+
+	ir_pass_timing_reset();
+	ir_finish();
+	return !ok;
+}
@@ -0,0 +1,106 @@
+/*
+ * Test the binary statistic event log against the text log.
+ *
+ * The same context pushes, pops and events of every kind are written to a
+ * text log and to a binary log, once without and once with a filter. There
+ * are more events than fit into one buffer of the binary log. The binary log
+ * is decoded with support/statev_decode.py, which must give the text log,
+ * and the text of the first events is also checked directly. Each log is
+ * written by a new statev session in the same process. The test is skipped
+ * if no python interpreter is found.
+ */
+#define _XOPEN_SOURCE 700
+#include "firm.h"
+#include "statev.h"
+#include "testutil.h"
+
+/** More than one buffer of the binary log holds. */
+#define N_EVENTS 5000
+
+/** The text of the events before the loop of emit_events(). */
+static char const first_events[] =
+	"P;bench;x y\n"
+	"E;a;-5\n"
+	"E;b;1099511627776\n"
+	"E;c;0.5\n"
+	"E;d;0.0\n"
+	"P;irg;f_3\n";
+
+static void emit_events(void)
+{
+	stat_ev_ctx_push_str("bench", "x y");
+	stat_ev_int("a", -5);
+	stat_ev_ull("b", 1ULL << 40);
+	stat_ev_dbl("c", 0.5);
+	stat_ev("d");
+	stat_ev_ctx_push_fmt("irg", "%s_%d", "f", 3);
+	for (int i = 0; i < N_EVENTS; ++i) {
+		stat_ev_int("n", i);
+		stat_ev_dbl("c", i * 0.25);
+	}
+	stat_ev_ctx_pop("irg");
+	stat_ev_ctx_pop("bench");
+}
+
+static char *read_file(char const *const name)
+{
+	FILE *const in = fopen(name, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long const size = ftell(in);
+	rewind(in);
+	char *const text = (char*)malloc(size + 1);
+	size_t const n_read = fread(text, 1, size, in);
+	assert(n_read == (size_t)size);
+	(void)n_read;
+	text[size] = '\0';
+	fclose(in);
+	return text;
+}
+
+static bool check_logs(char const *const filter)
+{
+	stat_ev_begin("text", filter);
+	emit_events();
+	stat_ev_end();
+	stat_ev_begin_binary("binary", filter);
+	emit_events();
+	stat_ev_end();
+
+	test_shell("python3 %s binary.evb > decoded.ev",
+	           test_source_path("support/statev_decode.py"));
+	char *const text    = read_file("text.ev");
+	char *const decoded = read_file("decoded.ev");
+	bool        ok      = strcmp(text, decoded) == 0;
+	if (!ok)
+		fprintf(stderr, "decoded binary log differs from text log\n");
+	if (filter == NULL
+	    && strncmp(text, first_events, sizeof(first_events) - 1) != 0) {
+		fprintf(stderr, "unexpected text log\n");
+		ok = false;
+	}
+	if (filter != NULL && strstr(text, "E;n;") != NULL) {
+		fprintf(stderr, "filter ignored\n");
+		ok = false;
+	}
+	free(decoded);
+	free(text);
+	return ok;
+}
+
+int main(void)
+{
+	if (system("python3 --version > /dev/null 2>&1") != 0) {
+		fprintf(stderr, "SKIPPED: no python interpreter found\n");
+		return 0;
+	}
+
+	ir_init();
+	test_enter_dir("statev_binary");
+	bool ok = check_logs(NULL);
+	ok     &= check_logs("^(bench|c|irg)$");
+	ir_finish();
+	if (test_leave_dir("text.ev binary.evb decoded.ev") != 0)
+		return 1;
+	return !ok;
+}
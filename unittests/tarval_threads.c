@@ -0,0 +1,56 @@
+/*
+ * Test that tarvals created concurrently by several threads are interned
+ * once, so equal values are the same tarval in every thread.
+ */
+#include <assert.h>
+#include <pthread.h>
+
+#include "firm.h"
+#include "tv.h"
+
+#define N_THREADS 4
+#define N_VALUES  20000
+
+typedef struct thread_data_t {
+	unsigned   nr;
+	ir_tarval *values[N_VALUES];
+} thread_data_t;
+
+static void *create_values(void *data)
+{
+	thread_data_t *const thread = (thread_data_t*)data;
+	ir_tarval     *const three  = new_tarval_from_long(3, mode_Ls);
+	for (unsigned i = 0; i < N_VALUES; ++i) {
+		/* every thread starts at a different value, so inserts collide */
+		unsigned   const n   = (i + thread->nr * N_VALUES / N_THREADS) % N_VALUES;
+		ir_tarval *const tv  = new_tarval_from_long(n, mode_Ls);
+		/* n * 3 + n goes through the calculation routines */
+		thread->values[n] = tarval_add(tarval_mul(tv, three), tv);
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	ir_init();
+
+	static thread_data_t threads[N_THREADS];
+	pthread_t            ids[N_THREADS];
+	for (unsigned t = 0; t < N_THREADS; ++t) {
+		threads[t].nr = t;
+		int const res = pthread_create(&ids[t], NULL, create_values, &threads[t]);
+		assert(res == 0);
+		(void)res;
+	}
+	for (unsigned t = 0; t < N_THREADS; ++t)
+		pthread_join(ids[t], NULL);
+
+	for (unsigned n = 0; n < N_VALUES; ++n) {
+		ir_tarval *const tv = new_tarval_from_long(4 * (long)n, mode_Ls);
+		for (unsigned t = 0; t < N_THREADS; ++t)
+			assert(threads[t].values[n] == tv);
+	}
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Helpers for unittests which run steps in their own processes, as
+ *          libfirm is initialized only once per process, or which build and
+ *          run programs with the host toolchain.
+ */
+#ifndef FIRM_UNITTESTS_TESTUTIL_H
+#define FIRM_UNITTESTS_TESTUTIL_H
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static char test_dir[64];
+static char test_srcdir[1024];
+
+/**
+ * Creates a temporary directory for the test @p name and changes into it.
+ * Files of the source tree are found with test_source_path() afterwards.
+ */
+static inline void test_enter_dir(char const *const name)
+{
+	/* this header is in the unittests directory of the source tree */
+	if (realpath(__FILE__, test_srcdir) == NULL) {
+		perror(__FILE__);
+		exit(1);
+	}
+	*strrchr(test_srcdir, '/') = '\0';
+	*strrchr(test_srcdir, '/') = '\0';
+
+	snprintf(test_dir, sizeof(test_dir), "/tmp/%s.XXXXXX", name);
+	if (mkdtemp(test_dir) == NULL || chdir(test_dir) != 0) {
+		perror(test_dir);
+		exit(1);
+	}
+}
+
+/** Removes the files matching @p files and the temporary directory. */
+static inline int test_leave_dir(char const *const files)
+{
+	char command[1024];
+	snprintf(command, sizeof(command), "rm -f %s", files);
+	if (system(command) != 0)
+		return 1;
+	return rmdir(test_dir) != 0;
+}
+
+/** Returns the path of @p file, relative to the root of the source tree. */
+static inline char const *test_source_path(char const *const file)
+{
+	static char path[2048];
+	snprintf(path, sizeof(path), "%s/%s", test_srcdir, file);
+	return path;
+}
+
+/**
+ * Runs @p step with @p arg in a child process and aborts if it does not
+ * return 0.
+ */
+static inline void test_fork(int (*const step)(int), int const arg)
+{
+	fflush(NULL);
+	pid_t const pid = fork();
+	assert(pid >= 0);
+	if (pid != 0) {
+		int status;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr, "step %d failed, see %s\n", arg, test_dir);
+			abort();
+		}
+		return;
+	}
+	exit(step(arg));
+}
+
+/** Runs the shell command @p fmt and aborts if it fails. */
+static inline void test_shell(char const *const fmt, ...)
+{
+	char    command[4096];
+	va_list ap;
+	va_start(ap, fmt);
+	vsnprintf(command, sizeof(command), fmt, ap);
+	va_end(ap);
+	fflush(NULL);
+	if (system(command) != 0) {
+		fprintf(stderr, "'%s' failed, see %s\n", command, test_dir);
+		abort();
+	}
+}
+
+/**
+ * Returns whether amd64 programs can be linked and run on the host, and
+ * explains why not on stderr.
+ */
+static inline bool test_have_amd64_host(void)
+{
+#if !defined(__x86_64__)
+	fprintf(stderr, "SKIPPED: host is not amd64\n");
+	return false;
+#else
+	if (system("cc --version > /dev/null 2>&1") != 0) {
+		fprintf(stderr, "SKIPPED: no C compiler found\n");
+		return false;
+	}
+	return true;
+#endif
+}
+
+/**
+ * Links the amd64 assembler file @p name.s with libfirmprof into the
+ * program @p name.
+ */
+static inline void test_link_profiled(char const *const name)
+{
+	char const *const support = test_source_path("support/libfirmprof");
+	test_shell("cc -no-pie -Wl,-z,noexecstack -o %s %s.s %s/instrument.c "
+	           "%s/profdata.c", name, name, support, support);
+}
+
+#endif